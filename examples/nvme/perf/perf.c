@@ -748,12 +748,22 @@ static void
 nvme_check_io(struct ns_worker_ctx *ns_ctx)
 {
 	int64_t rc;
+	int i;
+
+	/* The I/O resubmitted from io_complete() are sent to each qpair in a single batch. */
+	for (i = 0; i < ns_ctx->u.nvme.num_active_qpairs; i++) {
+		spdk_nvme_qpair_batch_begin(ns_ctx->u.nvme.qpair[i]);
+	}
 
 	rc = spdk_nvme_poll_group_process_completions(ns_ctx->u.nvme.group, 0, perf_disconnect_cb);
 	if (rc < 0) {
 		fprintf(stderr, "NVMe io qpair process completion error\n");
 		exit(1);
 	}
+
+	for (i = 0; i < ns_ctx->u.nvme.num_active_qpairs; i++) {
+		spdk_nvme_qpair_batch_submit(ns_ctx->u.nvme.qpair[i]);
+	}
 }
 
 static void
@@ -131,6 +131,22 @@ bool spdk_bit_pool_is_allocated(const struct spdk_bit_pool *pool, uint32_t bit_i
  */
 uint32_t spdk_bit_pool_allocate_bit(struct spdk_bit_pool *pool);
 
+/**
+ * Allocate a run of contiguous bits from the bit pool.
+ *
+ * The run starts at the lowest free bit and ends at the first allocated bit
+ * after it, so fewer than max_bits bits are allocated when the free bits are
+ * fragmented.
+ *
+ * \param pool Bit pool to allocate the bits from
+ * \param max_bits Maximum number of bits to allocate
+ * \param num_bits Number of bits allocated, 0 if no free bits exist
+ *
+ * \return index of the first allocated bit, UINT32_MAX if no free bits exist
+ */
+uint32_t spdk_bit_pool_allocate_bits(struct spdk_bit_pool *pool, uint32_t max_bits,
+				     uint32_t *num_bits);
+
 /**
  * Free a bit back to the bit pool.
  *
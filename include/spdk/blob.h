@@ -201,6 +201,27 @@ struct spdk_bs_type {
 	char bstype[SPDK_BLOBSTORE_TYPE_LENGTH];
 };
 
+/**
+ * Callback used to open the external snapshot device of an esnap clone.
+ *
+ * The returned device is only read from. The blobstore destroys it when the
+ * blob is closed.
+ *
+ * \param bs_ctx The esnap_ctx passed in spdk_bs_opts.
+ * \param blob The esnap clone being opened.
+ * \param esnap_id Identifier the blob was created with.
+ * \param id_len Length of esnap_id in bytes.
+ * \param bs_dev Will be set to the external snapshot device. It may be left NULL
+ * if the external snapshot is not available yet. The blob is then opened degraded:
+ * reads of its unallocated clusters fail until a device is set with
+ * spdk_blob_set_esnap_bs_dev().
+ *
+ * \return 0 on success, negative errno on failure. A failure fails the blob open.
+ */
+typedef int (*spdk_bs_esnap_dev_create)(void *bs_ctx, struct spdk_blob *blob,
+					const void *esnap_id, uint32_t id_len,
+					struct spdk_bs_dev **bs_dev);
+
 struct spdk_bs_opts {
 	/** Size of cluster in bytes. Must be multiple of 4KiB page size. */
 	uint32_t cluster_sz;
@@ -225,6 +246,22 @@ struct spdk_bs_opts {
 
 	/** Argument passed to iter_cb_fn for each blob. */
 	void *iter_cb_arg;
+
+	/**
+	 * Callback used to open the external snapshot device of an esnap clone.
+	 * Blobs created with an external snapshot cannot be created or opened
+	 * unless this is set.
+	 */
+	spdk_bs_esnap_dev_create esnap_bs_dev_create;
+
+	/** Context passed to esnap_bs_dev_create. */
+	void *esnap_ctx;
+
+	/**
+	 * Size in bytes up to which the blobstore can be grown by spdk_bs_grow().
+	 * 0 to only leave room for what fits in the metadata sized for the device.
+	 */
+	uint64_t max_size;
 };
 
 /**
@@ -293,6 +330,21 @@ void spdk_bs_destroy(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn,
  */
 void spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg);
 
+/**
+ * Grow a loaded blobstore to the current size of its device.
+ *
+ * The blockcnt of the blobstore device must already reflect the new size. The
+ * clusters added at the end of the device become free clusters. The number of
+ * clusters the blobstore can track is fixed when it is initialized, see
+ * spdk_bs_opts.max_size. Growing beyond that fails with -ENOSPC. A device
+ * that did not grow is not an error.
+ *
+ * \param bs blobstore to grow.
+ * \param cb_fn Called when the new size is persisted.
+ * \param cb_arg Argument passed to function cb_fn.
+ */
+void spdk_bs_grow(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg);
+
 /**
  * Set a super blob on the given blobstore.
  *
@@ -417,6 +469,17 @@ struct spdk_blob_opts {
 
 	/** Enable separate extent pages in metadata */
 	bool use_extent_table;
+
+	/**
+	 * Identifier of an external snapshot. When set, the blob is created as a
+	 * thin provisioned clone whose unallocated clusters are read from the
+	 * device returned by the blobstore's esnap_bs_dev_create callback.
+	 * The identifier is opaque to the blobstore and is stored with the blob.
+	 */
+	const void *esnap_id;
+
+	/** Length of esnap_id in bytes. */
+	uint64_t esnap_id_len;
 };
 
 /**
@@ -550,6 +613,49 @@ bool spdk_blob_is_clone(struct spdk_blob *blob);
  */
 bool spdk_blob_is_thin_provisioned(struct spdk_blob *blob);
 
+/**
+ * Check if blob is a clone of an external snapshot.
+ *
+ * \param blob Blob.
+ *
+ * \return true if blob is backed by an external snapshot device.
+ */
+bool spdk_blob_is_esnap_clone(const struct spdk_blob *blob);
+
+/**
+ * Get the external snapshot identifier of an esnap clone.
+ *
+ * \param blob Blob.
+ * \param id Will be set to the identifier passed at blob creation.
+ * \param len Will be set to the length of the identifier.
+ *
+ * \return 0 on success, -EINVAL if blob is not an esnap clone.
+ */
+int spdk_blob_get_esnap_id(struct spdk_blob *blob, const void **id, size_t *len);
+
+/**
+ * Check if an esnap clone was opened without its external snapshot.
+ *
+ * \param blob Blob.
+ *
+ * \return true if the external snapshot of the blob is missing.
+ */
+bool spdk_blob_is_degraded(const struct spdk_blob *blob);
+
+/**
+ * Set the external snapshot device of a degraded esnap clone, once the external
+ * snapshot became available. I/O to the blob is frozen while the device is set.
+ *
+ * \param blob Degraded esnap clone.
+ * \param esnap_dev External snapshot device. The blobstore takes ownership of it,
+ * it is destroyed on failure.
+ * \param cb_fn Called when the operation is complete. -EINVAL if the blob is not an
+ * esnap clone, -EEXIST if it already has its external snapshot.
+ * \param cb_arg Argument passed to function cb_fn.
+ */
+void spdk_blob_set_esnap_bs_dev(struct spdk_blob *blob, struct spdk_bs_dev *esnap_dev,
+				spdk_blob_op_complete cb_fn, void *cb_arg);
+
 /**
  * Delete an existing blob from the given blobstore.
  *
@@ -594,6 +700,128 @@ void spdk_bs_inflate_blob(struct spdk_blob_store *bs, struct spdk_io_channel *ch
 void spdk_bs_blob_decouple_parent(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
 				  spdk_blob_id blobid, spdk_blob_op_complete cb_fn, void *cb_arg);
 
+/**
+ * A background inflate or decouple started by spdk_bs_inflate_blob_start().
+ */
+struct spdk_blob_inflate_job;
+
+struct spdk_blob_inflate_opts {
+	/**
+	 * Only copy the clusters allocated in the parent and keep the blob thin
+	 * provisioned, as spdk_bs_blob_decouple_parent() does. Default false.
+	 */
+	bool decouple_parent;
+
+	/** Number of clusters copied at the same time. Default 4. */
+	uint32_t max_inflight;
+
+	/** Maximum number of bytes copied per second, 0 for no limit. Default 0. */
+	uint64_t max_bytes_per_sec;
+};
+
+struct spdk_blob_inflate_progress {
+	/** Clusters that needed to be copied when the job started */
+	uint64_t clusters_total;
+
+	/** Clusters copied so far */
+	uint64_t clusters_done;
+
+	/** Time the job has been copying, not counting the time it was paused */
+	uint64_t elapsed_usec;
+
+	/** Estimated time to copy the remaining clusters, UINT64_MAX while unknown */
+	uint64_t eta_usec;
+
+	bool paused;
+	bool cancelled;
+};
+
+/**
+ * Initialize a spdk_blob_inflate_opts structure to the default values.
+ *
+ * \param opts spdk_blob_inflate_opts structure to initialize.
+ */
+void spdk_blob_inflate_opts_init(struct spdk_blob_inflate_opts *opts);
+
+/**
+ * Start inflating or decoupling the parent of a blob in the background.
+ *
+ * Clusters are copied on the given channel, up to opts->max_inflight at a time
+ * and no faster than opts->max_bytes_per_sec. The job can be paused, resumed
+ * and cancelled; a cancelled job leaves the blob a valid, partially inflated
+ * clone. The job and the functions controlling it must be used on the thread
+ * that started it, and the job is freed once cb_fn has been called.
+ *
+ * \param bs blobstore.
+ * \param channel IO channel used to inflate the blob.
+ * \param blobid The id of the blob.
+ * \param opts Inflate options, NULL for the defaults.
+ * \param cb_fn Called when the job has finished, with -ECANCELED if it was
+ * cancelled.
+ * \param cb_arg Argument passed to function cb_fn.
+ * \param job Set to the started job.
+ *
+ * \return 0 if the job was started, cb_fn is called when it finishes.
+ * \return -EINVAL if the options are invalid, -ENOMEM if the job could not be
+ * allocated. cb_fn is not called.
+ */
+int spdk_bs_inflate_blob_start(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+			       spdk_blob_id blobid, const struct spdk_blob_inflate_opts *opts,
+			       spdk_blob_op_complete cb_fn, void *cb_arg,
+			       struct spdk_blob_inflate_job **job);
+
+/**
+ * Stop copying clusters after the ones in flight complete.
+ *
+ * \param job Inflate job.
+ */
+void spdk_blob_inflate_job_pause(struct spdk_blob_inflate_job *job);
+
+/**
+ * Continue copying clusters of a paused job.
+ *
+ * \param job Inflate job.
+ */
+void spdk_blob_inflate_job_resume(struct spdk_blob_inflate_job *job);
+
+/**
+ * Stop a job. Its completion callback is called with -ECANCELED once the
+ * clusters in flight are copied.
+ *
+ * \param job Inflate job.
+ */
+void spdk_blob_inflate_job_cancel(struct spdk_blob_inflate_job *job);
+
+/**
+ * Get the progress of a job.
+ *
+ * \param job Inflate job.
+ * \param progress Filled with the progress of the job.
+ */
+void spdk_blob_inflate_job_get_progress(const struct spdk_blob_inflate_job *job,
+					struct spdk_blob_inflate_progress *progress);
+
+/**
+ * Copy the clusters allocated in a blob to another device.
+ *
+ * Only the clusters allocated in the blob itself are copied, each to the same
+ * offset on ext_dev. Ranges of clusters that are unallocated or come from a
+ * parent are not written to ext_dev. Up to 16 clusters are copied at a time.
+ *
+ * The blob must be read-only, e.g. a snapshot, and ext_dev at least as large
+ * as the blob.
+ *
+ * \param bs blobstore.
+ * \param channel IO channel used to read the blob.
+ * \param blobid The id of the blob to copy.
+ * \param ext_dev Device to copy the clusters to.
+ * \param cb_fn Called when the operation is complete.
+ * \param cb_arg Argument passed to function cb_fn.
+ */
+void spdk_bs_blob_shallow_copy(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+			       spdk_blob_id blobid, struct spdk_bs_dev *ext_dev,
+			       spdk_blob_op_complete cb_fn, void *cb_arg);
+
 struct spdk_blob_open_opts {
 	enum blob_clear_method  clear_method;
 };
@@ -642,6 +870,86 @@ void spdk_bs_open_blob_ext(struct spdk_blob_store *bs, spdk_blob_id blobid,
 void spdk_blob_resize(struct spdk_blob *blob, uint64_t sz, spdk_blob_op_complete cb_fn,
 		      void *cb_arg);
 
+/**
+ * Set the copy-on-read threshold of a clone. Once a cluster that is not
+ * allocated in the blob has been read 'threshold' times, it is allocated and
+ * populated from the parent snapshot or external snapshot in the background, so
+ * later reads of it no longer go to the parent. The setting is not persisted.
+ *
+ * \param blob Blob to change.
+ * \param threshold Number of reads of an unallocated cluster after which it is
+ * copied, at most UINT16_MAX. 0 disables copy-on-read.
+ * \param cb_fn Called when the operation is complete.
+ * \param cb_arg Argument passed to function cb_fn.
+ */
+void spdk_blob_set_copy_on_read(struct spdk_blob *blob, uint32_t threshold,
+				spdk_blob_op_complete cb_fn, void *cb_arg);
+
+/**
+ * I/O statistics of a blob. Requests that span a cluster boundary are counted
+ * once for each cluster they touch.
+ */
+struct spdk_blob_io_stat {
+	uint64_t num_read_ops;
+	uint64_t bytes_read;
+	uint64_t num_write_ops;
+	uint64_t bytes_written;
+	uint64_t num_unmap_ops;
+	uint64_t num_write_zeroes_ops;
+
+	/** Clusters allocated by writes to thin provisioned clusters. */
+	uint64_t num_clusters_allocated;
+
+	/** Allocated clusters that were first copied from the parent. */
+	uint64_t num_cow_copies;
+
+	/** Reads of unallocated clusters served by the parent snapshot or external snapshot. */
+	uint64_t num_backing_dev_reads;
+	uint64_t bytes_backing_dev_read;
+};
+
+/**
+ * Enable or disable the I/O statistics of a blob. Enabling them again resets
+ * all counters. The statistics are kept in memory only and are lost when the
+ * blob is closed.
+ *
+ * With a non-zero heatmap_sample_rate, every heatmap_sample_rate-th read, write,
+ * unmap and write zeroes of the blob is also counted for the cluster it
+ * accesses, see spdk_blob_get_io_heatmap().
+ *
+ * \param blob Blob to change.
+ * \param enable True to enable and reset the statistics, false to disable them.
+ * \param heatmap_sample_rate Sampling rate of the cluster heatmap, 0 for no heatmap.
+ * \param cb_fn Called when the operation is complete.
+ * \param cb_arg Argument passed to function cb_fn.
+ */
+void spdk_blob_set_io_stat(struct spdk_blob *blob, bool enable, uint32_t heatmap_sample_rate,
+			   spdk_blob_op_complete cb_fn, void *cb_arg);
+
+/**
+ * Get the I/O statistics of a blob.
+ *
+ * \param blob Blob to query.
+ * \param stat Filled with the statistics collected since they were enabled.
+ *
+ * \return 0 on success, -ENOENT if the statistics are not enabled.
+ */
+int spdk_blob_get_io_stat(struct spdk_blob *blob, struct spdk_blob_io_stat *stat);
+
+/**
+ * Get the sampled number of accesses of a range of clusters of a blob.
+ *
+ * \param blob Blob to query.
+ * \param start_cluster First cluster to get.
+ * \param counts Filled with the number of sampled accesses of each cluster.
+ * \param num_clusters Size of the counts array.
+ *
+ * \return the number of clusters filled in, 0 if the heatmap is not enabled
+ * or start_cluster is past the end of the blob.
+ */
+uint64_t spdk_blob_get_io_heatmap(struct spdk_blob *blob, uint64_t start_cluster,
+				  uint32_t *counts, uint64_t num_clusters);
+
 /**
  * Set blob as read only.
  *
@@ -83,6 +83,22 @@ struct spdk_bs_dev *spdk_bdev_create_bs_dev_from_desc(struct spdk_bdev_desc *des
 int spdk_bdev_create_bs_dev_ext(const char *bdev_name, spdk_bdev_event_cb_t event_cb,
 				void *event_ctx, struct spdk_bs_dev **bs_dev);
 
+/**
+ * Create a read-only blobstore block device from a bdev.
+ *
+ * The bdev is opened without write access, so it may be shared with other
+ * read-only users. It is suitable as the external snapshot of an esnap clone.
+ *
+ * \param bdev_name Name of the bdev to use.
+ * \param event_cb Called when the bdev triggers asynchronous event.
+ * \param event_ctx Argument passed to function event_cb.
+ * \param bs_dev Output parameter for a pointer to the blobstore block device.
+ *
+ * \return 0 if operation is successful, or suitable errno value otherwise.
+ */
+int spdk_bdev_create_bs_dev_ro(const char *bdev_name, spdk_bdev_event_cb_t event_cb,
+			       void *event_ctx, struct spdk_bs_dev **bs_dev);
+
 /**
  * Claim the bdev module for the given blobstore.
  *
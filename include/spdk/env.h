@@ -642,6 +642,35 @@ bool spdk_iommu_is_enabled(void);
  */
 uint64_t spdk_vtophys(const void *buf, uint64_t *size);
 
+/**
+ * Physically contiguous segment returned by spdk_vtophys_iov().
+ */
+struct spdk_vtophys_seg {
+	/** Physical address of the segment. */
+	uint64_t	phys_addr;
+
+	/** Length of the segment in bytes. */
+	uint64_t	len;
+};
+
+/**
+ * Get the physical segments that make up an array of buffers.
+ *
+ * Each buffer is split where it stops being physically contiguous, and pieces
+ * that are physically adjacent to the previous one, within a buffer or across
+ * consecutive buffers, are merged into a single segment.
+ *
+ * \param iov Array of buffers to translate.
+ * \param iovcnt Number of elements in iov.
+ * \param segs Array filled with the physical segments.
+ * \param max_segs Number of elements in segs.
+ *
+ * \return the number of segments on success, -EFAULT if a buffer can't be
+ * translated or -ENOSPC if more than max_segs segments are needed.
+ */
+int spdk_vtophys_iov(const struct iovec *iov, int iovcnt, struct spdk_vtophys_seg *segs,
+		     int max_segs);
+
 struct spdk_pci_addr {
 	uint32_t			domain;
 	uint8_t				bus;
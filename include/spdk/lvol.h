@@ -73,6 +73,19 @@ struct spdk_lvs_opts {
 	uint32_t		cluster_sz;
 	enum lvs_clear_method	clear_method;
 	char			name[SPDK_LVS_NAME_MAX];
+
+	/**
+	 * Opens the external snapshots of esnap clones. It is called with the
+	 * lvolstore as bs_ctx. Without it, esnap clones cannot be created and are
+	 * skipped when the lvolstore is loaded.
+	 */
+	spdk_bs_esnap_dev_create esnap_bs_dev_create;
+
+	/**
+	 * Size in bytes up to which the lvolstore can be grown by spdk_lvs_grow().
+	 * 0 to only reserve what the base device size allows for.
+	 */
+	uint64_t max_size;
 };
 
 /**
@@ -144,6 +157,21 @@ int spdk_lvs_init(struct spdk_bs_dev *bs_dev, struct spdk_lvs_opts *o,
 void spdk_lvs_rename(struct spdk_lvol_store *lvs, const char *new_name,
 		     spdk_lvs_op_complete cb_fn, void *cb_arg);
 
+/**
+ * Grow the given lvolstore to the current size of its base device.
+ *
+ * The block count of the lvolstore's bs_dev must already reflect the new
+ * size. New clusters become available for allocation once the completion
+ * callback reports success. The lvolstore cannot grow past the max_size it
+ * was created with, or past what the device size at creation time allowed
+ * for when max_size was 0.
+ *
+ * \param lvs Pointer to lvolstore.
+ * \param cb_fn Completion callback.
+ * \param cb_arg Completion callback custom arguments.
+ */
+void spdk_lvs_grow(struct spdk_lvol_store *lvs, spdk_lvs_op_complete cb_fn, void *cb_arg);
+
 /**
  * Unload lvolstore.
  *
@@ -210,6 +238,26 @@ void spdk_lvol_create_snapshot(struct spdk_lvol *lvol, const char *snapshot_name
 void spdk_lvol_create_clone(struct spdk_lvol *lvol, const char *clone_name,
 			    spdk_lvol_op_with_handle_complete cb_fn, void *cb_arg);
 
+/**
+ * Create a clone of an external snapshot.
+ *
+ * The clone is thin provisioned and reads its unallocated clusters from the
+ * device opened by the lvolstore's esnap_bs_dev_create callback for esnap_id.
+ *
+ * \param esnap_id Identifier of the external snapshot, stored with the clone.
+ * \param id_len Length of esnap_id in bytes.
+ * \param size_bytes Size of the clone. Must be a multiple of the cluster size.
+ * \param lvs Handle to lvolstore.
+ * \param clone_name Name of created clone.
+ * \param cb_fn Completion callback.
+ * \param cb_arg Completion callback custom arguments.
+ *
+ * \return 0 on success, negative errno on failure.
+ */
+int spdk_lvol_create_esnap_clone(const void *esnap_id, uint32_t id_len, uint64_t size_bytes,
+				 struct spdk_lvol_store *lvs, const char *clone_name,
+				 spdk_lvol_op_with_handle_complete cb_fn, void *cb_arg);
+
 /**
  * Rename lvol with new_name.
  *
@@ -265,6 +313,20 @@ struct spdk_io_channel *spdk_lvol_get_io_channel(struct spdk_lvol *lvol);
 void spdk_lvs_load(struct spdk_bs_dev *bs_dev, spdk_lvs_op_with_handle_complete cb_fn,
 		   void *cb_arg);
 
+/**
+ * Load lvolstore from the given blobstore device with options.
+ *
+ * Only esnap_bs_dev_create is taken from opts, the other parameters are read
+ * from the device.
+ *
+ * \param bs_dev Pointer to the blobstore device.
+ * \param opts lvolstore options, may be NULL.
+ * \param cb_fn Completion callback.
+ * \param cb_arg Completion callback custom arguments.
+ */
+void spdk_lvs_load_ext(struct spdk_bs_dev *bs_dev, const struct spdk_lvs_opts *opts,
+		       spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg);
+
 /**
  * Open a lvol.
  *
@@ -292,6 +354,46 @@ void spdk_lvol_inflate(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, void
  */
 void spdk_lvol_decouple_parent(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, void *cb_arg);
 
+/**
+ * Start inflating or decoupling the parent of lvol in the background.
+ *
+ * The copy can be paused, resumed, cancelled and its progress queried through
+ * the job returned by spdk_lvol_get_inflate_job(). Closing the lvol cancels it.
+ *
+ * \param lvol Handle to lvol
+ * \param opts Inflate options, NULL for the defaults
+ * \param cb_fn Called when the job has finished, with -ECANCELED if it was cancelled
+ * \param cb_arg Completion callback custom arguments
+ *
+ * \return 0 if the job was started, -EBUSY if lvol already has one, negative
+ * errno on other failures. cb_fn is only called if the job was started.
+ */
+int spdk_lvol_start_inflate(struct spdk_lvol *lvol, const struct spdk_blob_inflate_opts *opts,
+			    spdk_lvol_op_complete cb_fn, void *cb_arg);
+
+/**
+ * Get the background inflate job of lvol.
+ *
+ * \param lvol Handle to lvol
+ *
+ * \return the job started by spdk_lvol_start_inflate(), or NULL if it has finished.
+ */
+struct spdk_blob_inflate_job *spdk_lvol_get_inflate_job(struct spdk_lvol *lvol);
+
+/**
+ * Copy the clusters allocated in lvol, and not in its parents, to another device.
+ *
+ * The clusters are written at the same offsets on ext_dev, other ranges of
+ * ext_dev are left as they are. lvol must be read-only, e.g. a snapshot.
+ *
+ * \param lvol Handle to lvol
+ * \param ext_dev Device to copy the clusters to
+ * \param cb_fn Completion callback
+ * \param cb_arg Completion callback custom arguments
+ */
+void spdk_lvol_shallow_copy(struct spdk_lvol *lvol, struct spdk_bs_dev *ext_dev,
+			    spdk_lvol_op_complete cb_fn, void *cb_arg);
+
 #ifdef __cplusplus
 }
 #endif
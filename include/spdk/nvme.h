@@ -1479,6 +1479,35 @@ int spdk_nvme_ctrlr_cmd_io_raw_with_md(struct spdk_nvme_ctrlr *ctrlr,
 int32_t spdk_nvme_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		uint32_t max_completions);
 
+/**
+ * Start a batch of commands on an I/O qpair.
+ *
+ * Until spdk_nvme_qpair_batch_submit() is called, commands submitted to the
+ * qpair, for any namespace of its controller, are placed on the queue but the
+ * controller is not notified of them. spdk_nvme_qpair_batch_submit() then
+ * notifies the controller of all of them at once, e.g. with a single doorbell
+ * write on PCIe. Each command still completes through its own callback.
+ *
+ * Transports that have no way to defer notification submit each command
+ * immediately, as if no batch was started.
+ *
+ * \param qpair The I/O qpair to start the batch on.
+ *
+ * \return 0 on success, -EINVAL if the qpair is an admin qpair or already has a
+ * batch started.
+ */
+int spdk_nvme_qpair_batch_begin(struct spdk_nvme_qpair *qpair);
+
+/**
+ * Submit the commands queued on an I/O qpair since spdk_nvme_qpair_batch_begin().
+ *
+ * \param qpair The I/O qpair to submit the batch on.
+ *
+ * \return 0 on success, -EINVAL if no batch was started on the qpair, or a
+ * negated errno if the transport failed to submit the commands.
+ */
+int spdk_nvme_qpair_batch_submit(struct spdk_nvme_qpair *qpair);
+
 /**
  * Returns the reason the qpair is disconnected.
  *
@@ -1488,6 +1517,36 @@ int32_t spdk_nvme_qpair_process_completions(struct spdk_nvme_qpair *qpair,
  */
 spdk_nvme_qp_failure_reason spdk_nvme_qpair_get_failure_reason(struct spdk_nvme_qpair *qpair);
 
+/**
+ * Request allocation statistics of a qpair.
+ */
+struct spdk_nvme_qpair_request_stats {
+	/**
+	 * Number of requests taken from the shared pool of the qpair's poll group
+	 * because all of the qpair's own requests were in use.
+	 */
+	uint64_t borrowed;
+
+	/**
+	 * Number of commands that could not be submitted with -ENOMEM because the
+	 * qpair's requests and its poll group's shared pool were all in use.
+	 */
+	uint64_t exhausted;
+};
+
+/**
+ * Get the request allocation statistics of a qpair.
+ *
+ * Qpairs that belong to a poll group borrow requests from a pool shared by the
+ * group when their own io_queue_requests are all in use, e.g. while large I/O
+ * are split into many child requests.
+ *
+ * \param qpair The qpair to query.
+ * \param stats Filled with the statistics of the qpair.
+ */
+void spdk_nvme_qpair_get_request_stats(struct spdk_nvme_qpair *qpair,
+				       struct spdk_nvme_qpair_request_stats *stats);
+
 /**
  * Send the given admin command to the NVMe controller.
  *
@@ -3321,6 +3380,8 @@ struct spdk_nvme_transport_ops {
 			uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb);
 
 	int (*poll_group_destroy)(struct spdk_nvme_transport_poll_group *tgroup);
+
+	int (*qpair_submit_batch)(struct spdk_nvme_qpair *qpair);
 };
 
 /**
@@ -1128,6 +1128,21 @@ struct spdk_nvme_cpl {
 };
 SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_cpl) == 16, "Incorrect size");
 
+/**
+ * Source range of a Copy command in descriptor format 0
+ */
+struct spdk_nvme_scc_source_range {
+	uint64_t	reserved0;
+	uint64_t	slba;
+	uint16_t	nlb;	/* 0's based */
+	uint16_t	reserved18;
+	uint32_t	reserved20;
+	uint32_t	eilbrt;
+	uint16_t	elbat;
+	uint16_t	elbatm;
+};
+SPDK_STATIC_ASSERT(sizeof(struct spdk_nvme_scc_source_range) == 32, "Incorrect size");
+
 /**
  * Dataset Management range
  */
@@ -1258,6 +1273,16 @@ enum spdk_nvme_command_specific_status_code {
 	SPDK_NVME_SC_CONFLICTING_ATTRIBUTES		= 0x80,
 	SPDK_NVME_SC_INVALID_PROTECTION_INFO		= 0x81,
 	SPDK_NVME_SC_ATTEMPTED_WRITE_TO_RO_RANGE	= 0x82,
+	SPDK_NVME_SC_CMD_SIZE_LIMIT_SIZE_EXCEEDED	= 0x83,
+
+	SPDK_NVME_SC_ZONE_BOUNDARY_ERROR		= 0xb8,
+	SPDK_NVME_SC_ZONE_IS_FULL			= 0xb9,
+	SPDK_NVME_SC_ZONE_IS_READ_ONLY			= 0xba,
+	SPDK_NVME_SC_ZONE_IS_OFFLINE			= 0xbb,
+	SPDK_NVME_SC_ZONE_INVALID_WRITE			= 0xbc,
+	SPDK_NVME_SC_TOO_MANY_ACTIVE_ZONES		= 0xbd,
+	SPDK_NVME_SC_TOO_MANY_OPEN_ZONES		= 0xbe,
+	SPDK_NVME_SC_INVALID_ZONE_STATE_TRANSITION	= 0xbf,
 };
 
 /**
@@ -1354,6 +1379,8 @@ enum spdk_nvme_nvm_opcode {
 
 	SPDK_NVME_OPC_RESERVATION_ACQUIRE		= 0x11,
 	SPDK_NVME_OPC_RESERVATION_RELEASE		= 0x15,
+
+	SPDK_NVME_OPC_COPY				= 0x19,
 };
 
 /**
@@ -1937,7 +1964,9 @@ struct __attribute__((packed)) __attribute__((aligned)) spdk_nvme_ctrlr_data {
 		uint16_t	set_features_save: 1;
 		uint16_t	reservations: 1;
 		uint16_t	timestamp: 1;
-		uint16_t	reserved: 9;
+		uint16_t	verify: 1;
+		uint16_t	copy: 1;
+		uint16_t	reserved: 7;
 	} oncs;
 
 	/** fused operation support */
@@ -1975,7 +2004,11 @@ struct __attribute__((packed)) __attribute__((aligned)) spdk_nvme_ctrlr_data {
 	/** atomic compare & write unit */
 	uint16_t		acwu;
 
-	uint16_t		reserved534;
+	/** optional copy formats supported */
+	struct {
+		uint16_t	copy_format0 : 1;
+		uint16_t	reserved : 15;
+	} ocfs;
 
 	struct spdk_nvme_cdata_sgls sgls;
 
@@ -2249,7 +2282,18 @@ struct spdk_nvme_ns_data {
 	/** NVM capacity */
 	uint64_t		nvmcap[2];
 
-	uint8_t			reserved64[28];
+	uint8_t			reserved64[10];
+
+	/** maximum single source range length */
+	uint16_t		mssrl;
+
+	/** maximum copy length */
+	uint32_t		mcl;
+
+	/** maximum source range count (0's based) */
+	uint8_t			msrc;
+
+	uint8_t			reserved81[11];
 
 	/** ANA group identifier */
 	uint32_t		anagrpid;
@@ -428,6 +428,42 @@ int spdk_nvmf_subsystem_resume(struct spdk_nvmf_subsystem *subsystem,
 			       spdk_nvmf_subsystem_state_change_done cb_fn,
 			       void *cb_arg);
 
+/**
+ * Pause a single namespace of an NVMe-oF subsystem.
+ *
+ * New I/O to the namespace is queued and the outstanding I/O is drained, while
+ * the other namespaces of the subsystem keep processing I/O. A paused namespace
+ * can be added or removed without pausing the whole subsystem.
+ *
+ * \param subsystem The NVMe-oF subsystem.
+ * \param nsid The namespace ID, which may be free but not above the subsystem's maximum.
+ * \param cb_fn A function that will be called once the namespace is paused.
+ * \param cb_arg Argument passed to cb_fn.
+ *
+ * \return 0 on success, or negated errno on failure. The callback provided will only
+ * be called on success.
+ */
+int spdk_nvmf_subsystem_pause_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+				 spdk_nvmf_subsystem_state_change_done cb_fn,
+				 void *cb_arg);
+
+/**
+ * Resume a namespace paused by spdk_nvmf_subsystem_pause_ns().
+ *
+ * Each poll group refreshes just this namespace and executes the I/O queued for it.
+ *
+ * \param subsystem The NVMe-oF subsystem.
+ * \param nsid The namespace ID.
+ * \param cb_fn A function that will be called once the namespace is resumed.
+ * \param cb_arg Argument passed to cb_fn.
+ *
+ * \return 0 on success, or negated errno on failure. The callback provided will only
+ * be called on success.
+ */
+int spdk_nvmf_subsystem_resume_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+				  spdk_nvmf_subsystem_state_change_done cb_fn,
+				  void *cb_arg);
+
 /**
  * Search the target for a subsystem with the given NQN.
  *
@@ -738,7 +774,8 @@ uint32_t spdk_nvmf_subsystem_add_ns(struct spdk_nvmf_subsystem *subsystem, struc
 /**
  * Add a namespace to a subsystems in the PAUSED or INACTIVE states.
  *
- * May only be performed on subsystems in the PAUSED or INACTIVE states.
+ * May only be performed on subsystems in the PAUSED or INACTIVE states, or on an
+ * active subsystem whose namespace opts->nsid was paused with spdk_nvmf_subsystem_pause_ns().
  *
  * \param subsystem Subsystem to add namespace to.
  * \param bdev_name Block device name to add as a namespace.
@@ -756,7 +793,8 @@ uint32_t spdk_nvmf_subsystem_add_ns_ext(struct spdk_nvmf_subsystem *subsystem,
 /**
  * Remove a namespace from a subsytem.
  *
- * May only be performed on subsystems in the PAUSED or INACTIVE states.
+ * May only be performed on subsystems in the PAUSED or INACTIVE states, or on an
+ * active subsystem whose namespace nsid was paused with spdk_nvmf_subsystem_pause_ns().
  *
  * \param subsystem Subsystem the namespace belong to.
  * \param nsid Namespace ID to be removed.
@@ -97,6 +97,8 @@ struct spdk_nvmf_request {
 	struct spdk_nvmf_request	*req_to_abort;
 	struct spdk_poller		*poller;
 	uint64_t			timeout_tsc;
+	/* Time the request started executing, for the I/O statistics */
+	uint64_t			start_tsc;
 
 	STAILQ_ENTRY(spdk_nvmf_request)	buf_link;
 	TAILQ_ENTRY(spdk_nvmf_request)	link;
@@ -128,6 +130,9 @@ struct spdk_nvmf_qpair {
 
 	struct spdk_nvmf_request		*first_fused_req;
 
+	/* I/O statistics of the qpair's host in its poll group, looked up on the first I/O */
+	struct spdk_nvmf_host_io_stats		*io_stats;
+
 	TAILQ_HEAD(, spdk_nvmf_request)		outstanding;
 	TAILQ_ENTRY(spdk_nvmf_qpair)		link;
 };
@@ -162,6 +167,8 @@ struct spdk_nvmf_poll_group {
 
 	/* Statistics */
 	struct spdk_nvmf_poll_group_stat		stat;
+	/* log2 of the number of ticks in the first I/O latency histogram bucket */
+	uint32_t					io_stat_tick_shift;
 
 	spdk_nvmf_poll_group_destroy_done_fn		destroy_cb_fn;
 	void						*destroy_cb_arg;
@@ -118,6 +118,14 @@ struct spdk_sock_impl_opts {
 	 */
 	bool enable_placement_id;
 
+	/**
+	 * Busy poll the NIC receive queue for up to this many microseconds when a
+	 * socket group finds no events, instead of relying on interrupts and softirq
+	 * processing. Zero disables busy polling. Works best together with
+	 * enable_placement_id, which binds each socket group to the NAPI ids (NIC
+	 * queues) of its sockets. Used by posix socket module.
+	 */
+	uint32_t busy_poll_usec;
 };
 
 /**
@@ -330,6 +338,29 @@ int spdk_sock_set_recvlowat(struct spdk_sock *sock, int nbytes);
  */
 int spdk_sock_set_recvbuf(struct spdk_sock *sock, int sz);
 
+/**
+ * Hint the socket about the framing of the data it is about to receive.
+ *
+ * Sockets that buffer received data internally read as much as they can when the
+ * caller asks for a few bytes, so that many small messages are received with a
+ * single system call. When a small header is followed by a large payload, that
+ * read also pulls the start of the payload into the socket's buffer and it then
+ * has to be copied out again. This tells the socket that the next hdr_len bytes
+ * of the stream are a header, followed by payload_len bytes of payload that the
+ * caller will read into its own buffers, so the socket stops buffering at the end
+ * of the header. The hint is cleared once hdr_len bytes have been received.
+ *
+ * Sockets that do not buffer received data ignore the hint.
+ *
+ * \param sock Socket to set the hint for.
+ * \param hdr_len Number of bytes before the payload, counted from the next byte
+ * the caller will receive.
+ * \param payload_len Number of bytes of payload following the header.
+ *
+ * \return 0 on success, -1 on failure.
+ */
+int spdk_sock_set_recv_hint(struct spdk_sock *sock, uint32_t hdr_len, uint32_t payload_len);
+
 /**
  * Set send buffer size for the given socket.
  *
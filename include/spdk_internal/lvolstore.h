@@ -59,6 +59,7 @@ struct spdk_lvol_req {
 	struct spdk_lvol	*lvol;
 	size_t			sz;
 	struct spdk_io_channel	*channel;
+	struct spdk_bs_dev	*ext_dev;
 	char			name[SPDK_LVOL_NAME_MAX];
 };
 
@@ -113,6 +114,10 @@ struct spdk_lvol {
 	int				ref_count;
 	bool				action_in_progress;
 	enum blob_clear_method		clear_method;
+	/* Background inflate or decouple started by spdk_lvol_start_inflate() */
+	struct spdk_blob_inflate_job	*inflate_job;
+	/* Close waiting for the background inflate to stop */
+	struct spdk_lvol_req		*close_req;
 	TAILQ_ENTRY(spdk_lvol) link;
 };
 
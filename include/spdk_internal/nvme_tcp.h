@@ -49,6 +49,12 @@
  */
 #define NVME_TCP_MAX_SGL_DESCRIPTORS	(16)
 
+/*
+ * Minimum PDU payload for which the socket is asked not to buffer the payload
+ * together with the PDU header, see nvme_tcp_pdu_set_recv_hint().
+ */
+#define NVME_TCP_RECV_HINT_MIN_PAYLOAD	0x2000
+
 #define MAKE_DIGEST_WORD(BUF, CRC32C) \
         (   ((*((uint8_t *)(BUF)+0)) = (uint8_t)((uint32_t)(CRC32C) >> 0)), \
             ((*((uint8_t *)(BUF)+1)) = (uint8_t)((uint32_t)(CRC32C) >> 8)), \
@@ -155,6 +161,12 @@ enum nvme_tcp_pdu_recv_state {
 	NVME_TCP_PDU_RECV_STATE_ERROR,
 };
 
+/* Framing of the last received PDU that carried a large payload. */
+struct nvme_tcp_recv_hint {
+	uint32_t	hdr_len;
+	uint32_t	payload_len;
+};
+
 enum nvme_tcp_error_codes {
 	NVME_TCP_PDU_IN_PROGRESS        = 0,
 	NVME_TCP_CONNECTION_FATAL       = -1,
@@ -630,4 +642,44 @@ nvme_tcp_pdu_calc_psh_len(struct nvme_tcp_pdu *pdu, bool hdgst_enable)
 	pdu->psh_len = psh_len;
 }
 
+/*
+ * Called before the common header of a new PDU is read. Large data transfers are
+ * split into a series of PDUs of the same size, so assume that the next PDU is
+ * framed like the last one that carried a large payload. This keeps the socket
+ * from pulling the payload into its receive buffer together with the header.
+ */
+static inline void
+nvme_tcp_ch_set_recv_hint(struct spdk_sock *sock, struct nvme_tcp_pdu *pdu,
+			  struct nvme_tcp_recv_hint *hint)
+{
+	if (pdu->ch_valid_bytes == 0 && hint->payload_len != 0) {
+		spdk_sock_set_recv_hint(sock, hint->hdr_len, hint->payload_len);
+	}
+}
+
+/*
+ * Called once the common header has been handled and the framing of the PDU is
+ * known, to receive the rest of the header without the payload behind it.
+ */
+static inline void
+nvme_tcp_pdu_set_recv_hint(struct spdk_sock *sock, struct nvme_tcp_pdu *pdu,
+			   struct nvme_tcp_recv_hint *hint)
+{
+	uint32_t hdr_len, payload_len;
+
+	hdr_len = sizeof(struct spdk_nvme_tcp_common_pdu_hdr) + pdu->psh_len;
+	payload_len = pdu->hdr.common.plen > hdr_len ? pdu->hdr.common.plen - hdr_len : 0;
+	if (payload_len < NVME_TCP_RECV_HINT_MIN_PAYLOAD) {
+		/* Small or dataless PDUs (e.g. responses) interrupt a large transfer, so
+		 * stop predicting until the next large payload. Otherwise every read
+		 * would be capped at the old framing and small PDUs couldn't be batched. */
+		hint->payload_len = 0;
+		return;
+	}
+
+	hint->hdr_len = hdr_len;
+	hint->payload_len = payload_len;
+	spdk_sock_set_recv_hint(sock, pdu->psh_len - pdu->psh_valid_bytes, payload_len);
+}
+
 #endif /* SPDK_INTERNAL_NVME_TCP_H */
@@ -122,6 +122,23 @@ bs_claim_cluster(struct spdk_blob_store *bs)
 	return cluster_num;
 }
 
+/* Claim up to max_clusters contiguous clusters, starting at the lowest free one */
+static uint32_t
+bs_claim_clusters(struct spdk_blob_store *bs, uint32_t max_clusters, uint32_t *num_clusters)
+{
+	uint32_t cluster_num;
+
+	cluster_num = spdk_bit_pool_allocate_bits(bs->used_clusters, max_clusters, num_clusters);
+	if (cluster_num == UINT32_MAX) {
+		return UINT32_MAX;
+	}
+
+	SPDK_DEBUGLOG(blob, "Claiming clusters %u-%u\n", cluster_num, cluster_num + *num_clusters - 1);
+	bs->num_free_clusters -= *num_clusters;
+
+	return cluster_num;
+}
+
 static void
 bs_release_cluster(struct spdk_blob_store *bs, uint32_t cluster_num)
 {
@@ -193,6 +210,175 @@ bs_allocate_cluster(struct spdk_blob *blob, uint32_t cluster_num,
 	return 0;
 }
 
+/* Must be called with used_clusters_mutex held */
+static void
+bs_channel_reserve_clusters(struct spdk_bs_channel *ch)
+{
+	struct spdk_blob_store *bs = ch->bs;
+	uint32_t count, cluster, num_clusters, first, last, tmp, i;
+
+	count = spdk_min(BS_CHANNEL_RESERVED_CLUSTERS,
+			 bs->num_free_clusters / BS_CHANNEL_RESERVE_FREE_DIVISOR);
+	first = ch->num_reserved_clusters;
+
+	/* Take the clusters in contiguous runs where possible */
+	while (ch->num_reserved_clusters < count) {
+		cluster = bs_claim_clusters(bs, count - ch->num_reserved_clusters, &num_clusters);
+		if (cluster == UINT32_MAX) {
+			break;
+		}
+		for (i = 0; i < num_clusters; i++) {
+			ch->reserved_clusters[ch->num_reserved_clusters++] = cluster + i;
+		}
+		__atomic_fetch_add(&bs->num_reserved_clusters, num_clusters, __ATOMIC_RELAXED);
+	}
+
+	/* The reserve is used from the end, so reverse the new clusters to hand them
+	 * out in ascending order. Sequential first writes to a thin provisioned blob
+	 * then land on sequential clusters. */
+	if (ch->num_reserved_clusters == 0) {
+		return;
+	}
+	last = ch->num_reserved_clusters - 1;
+	while (first < last) {
+		tmp = ch->reserved_clusters[first];
+		ch->reserved_clusters[first++] = ch->reserved_clusters[last];
+		ch->reserved_clusters[last--] = tmp;
+	}
+}
+
+/*
+ * Take a cluster from the reserve of a channel. The thread of the channel does
+ * this without used_clusters_mutex, any other thread only with it held. The
+ * reserve is only refilled by its own thread with the mutex held, so a cluster
+ * is never handed out twice.
+ */
+static bool
+bs_channel_take_reserved_cluster(struct spdk_bs_channel *ch, uint32_t *cluster)
+{
+	uint32_t num = __atomic_load_n(&ch->num_reserved_clusters, __ATOMIC_RELAXED);
+
+	do {
+		if (num == 0) {
+			return false;
+		}
+	} while (!__atomic_compare_exchange_n(&ch->num_reserved_clusters, &num, num - 1, false,
+					      __ATOMIC_ACQUIRE, __ATOMIC_RELAXED));
+
+	*cluster = ch->reserved_clusters[num - 1];
+	__atomic_fetch_sub(&ch->bs->num_reserved_clusters, 1, __ATOMIC_RELAXED);
+
+	return true;
+}
+
+/* Must be called with used_clusters_mutex held */
+static void
+bs_channel_release_reserved_clusters(struct spdk_bs_channel *ch)
+{
+	uint32_t cluster;
+
+	while (bs_channel_take_reserved_cluster(ch, &cluster)) {
+		bs_release_cluster(ch->bs, cluster);
+	}
+}
+
+/* Must be called with used_clusters_mutex held, on the md thread. No blob may
+ * be open, so that no channel is using its reserve concurrently. */
+static void
+bs_release_all_reserved_clusters(struct spdk_blob_store *bs)
+{
+	struct spdk_bs_channel *ch;
+
+	TAILQ_FOREACH(ch, &bs->channels, link) {
+		bs_channel_release_reserved_clusters(ch);
+	}
+}
+
+/*
+ * Must be called with used_clusters_mutex held. Reserved clusters are reported
+ * as free, so give those of any channel back to the pool until it holds at
+ * least num_clusters.
+ */
+static void
+bs_reclaim_reserved_clusters(struct spdk_blob_store *bs, uint64_t num_clusters)
+{
+	struct spdk_bs_channel *ch;
+	uint32_t cluster;
+
+	TAILQ_FOREACH(ch, &bs->channels, link) {
+		while (bs->num_free_clusters < num_clusters &&
+		       bs_channel_take_reserved_cluster(ch, &cluster)) {
+			bs_release_cluster(bs, cluster);
+		}
+	}
+}
+
+/*
+ * Allocate a cluster for a thin provisioned blob from the reserve of the channel.
+ * The mutex is only taken to refill the reserve or to claim a new extent page.
+ * The cluster is not inserted into the blob, the same as bs_allocate_cluster()
+ * called with update_map == false.
+ */
+static int
+bs_channel_allocate_cluster(struct spdk_bs_channel *ch, struct spdk_blob *blob,
+			    uint32_t cluster_num, uint64_t *cluster, uint32_t *lowest_free_md_page)
+{
+	struct spdk_blob_store *bs = blob->bs;
+	uint32_t reserved_cluster;
+	bool need_extent_page;
+	int rc = 0;
+
+	need_extent_page = blob->use_extent_table &&
+			   *bs_cluster_to_extent_page(blob, cluster_num) == 0;
+
+	if (!need_extent_page && bs_channel_take_reserved_cluster(ch, &reserved_cluster)) {
+		goto done;
+	}
+
+	pthread_mutex_lock(&bs->used_clusters_mutex);
+	if (ch->num_reserved_clusters == 0) {
+		bs_channel_reserve_clusters(ch);
+	}
+
+	if (ch->num_reserved_clusters == 0) {
+		/* Too few free clusters left to keep a reserve. Other channels may
+		 * still hold some. */
+		bs_reclaim_reserved_clusters(bs, 1);
+		rc = bs_allocate_cluster(blob, cluster_num, cluster, lowest_free_md_page, false);
+		pthread_mutex_unlock(&bs->used_clusters_mutex);
+		return rc;
+	}
+
+	if (need_extent_page) {
+		/* Extent page shall never occupy md_page so start the search from 1 */
+		*lowest_free_md_page = spdk_bit_array_find_first_clear(bs->used_md_pages,
+				       spdk_max(*lowest_free_md_page, 1));
+		if (*lowest_free_md_page == UINT32_MAX) {
+			/* No more free md pages. Cannot satisfy the request */
+			pthread_mutex_unlock(&bs->used_clusters_mutex);
+			return -ENOSPC;
+		}
+		bs_claim_md_page(bs, *lowest_free_md_page);
+	}
+
+	/* Take the cluster before unlocking, other channels may reclaim the reserve */
+	if (!bs_channel_take_reserved_cluster(ch, &reserved_cluster)) {
+		assert(false);
+		rc = -ENOSPC;
+	}
+	pthread_mutex_unlock(&bs->used_clusters_mutex);
+
+	if (rc != 0) {
+		return rc;
+	}
+
+done:
+	*cluster = reserved_cluster;
+	SPDK_DEBUGLOG(blob, "Claiming reserved cluster %lu for blob %lu\n", *cluster, blob->id);
+
+	return rc;
+}
+
 static void
 blob_xattrs_init(struct spdk_blob_xattr_opts *xattrs)
 {
@@ -210,6 +396,8 @@ spdk_blob_opts_init(struct spdk_blob_opts *opts)
 	opts->clear_method = BLOB_CLEAR_WITH_DEFAULT;
 	blob_xattrs_init(&opts->xattrs);
 	opts->use_extent_table = true;
+	opts->esnap_id = NULL;
+	opts->esnap_id_len = 0;
 }
 
 void
@@ -248,6 +436,9 @@ blob_alloc(struct spdk_blob_store *bs, spdk_blob_id id)
 	TAILQ_INIT(&blob->xattrs);
 	TAILQ_INIT(&blob->xattrs_internal);
 	TAILQ_INIT(&blob->pending_persists);
+	TAILQ_INIT(&blob->persists_to_complete);
+	TAILQ_INIT(&blob->queued_extent_inserts);
+	TAILQ_INIT(&blob->extent_inserts_in_progress);
 
 	return blob;
 }
@@ -270,6 +461,9 @@ blob_free(struct spdk_blob *blob)
 {
 	assert(blob != NULL);
 	assert(TAILQ_EMPTY(&blob->pending_persists));
+	assert(TAILQ_EMPTY(&blob->persists_to_complete));
+	assert(TAILQ_EMPTY(&blob->queued_extent_inserts));
+	assert(TAILQ_EMPTY(&blob->extent_inserts_in_progress));
 
 	free(blob->active.extent_pages);
 	free(blob->clean.extent_pages);
@@ -277,6 +471,9 @@ blob_free(struct spdk_blob *blob)
 	free(blob->clean.clusters);
 	free(blob->active.pages);
 	free(blob->clean.pages);
+	free(blob->cor_read_counts);
+	free(blob->io_stat);
+	free(blob->io_heatmap);
 
 	xattrs_free(&blob->xattrs);
 	xattrs_free(&blob->xattrs_internal);
@@ -1266,159 +1463,530 @@ blob_load_final(struct spdk_blob_load_ctx *ctx, int bserrno)
 	free(ctx);
 }
 
+/* START esnap clone back bs_dev */
+
+struct blob_esnap_release_ctx {
+	struct spdk_blob_esnap_dev	*dev;
+	spdk_blob_op_complete		cb_fn;
+	void				*cb_arg;
+};
+
 static void
-blob_load_snapshot_cpl(void *cb_arg, struct spdk_blob *snapshot, int bserrno)
+bs_esnap_channel_free(struct spdk_bs_channel *ch, struct spdk_bs_esnap_channel *esnap_ch)
 {
-	struct spdk_blob_load_ctx	*ctx = cb_arg;
-	struct spdk_blob		*blob = ctx->blob;
+	struct spdk_blob_esnap_dev *dev = esnap_ch->dev;
 
-	if (bserrno == 0) {
-		blob->back_bs_dev = bs_create_blob_bs_dev(snapshot);
-		if (blob->back_bs_dev == NULL) {
-			bserrno = -ENOMEM;
+	TAILQ_REMOVE(&ch->esnap_channels, esnap_ch, link);
+	dev->esnap_dev->destroy_channel(dev->esnap_dev, esnap_ch->channel);
+	__atomic_fetch_sub(&dev->num_channels, 1, __ATOMIC_SEQ_CST);
+	free(esnap_ch);
+}
+
+static void
+bs_channel_destroy_esnap_channels(struct spdk_bs_channel *ch)
+{
+	while (!TAILQ_EMPTY(&ch->esnap_channels)) {
+		bs_esnap_channel_free(ch, TAILQ_FIRST(&ch->esnap_channels));
+	}
+}
+
+static struct spdk_io_channel *
+blob_esnap_get_channel(struct spdk_blob_esnap_dev *dev, struct spdk_io_channel *_ch)
+{
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct spdk_bs_esnap_channel *esnap_ch;
+
+	TAILQ_FOREACH(esnap_ch, &ch->esnap_channels, link) {
+		if (esnap_ch->dev == dev) {
+			if (esnap_ch != TAILQ_FIRST(&ch->esnap_channels)) {
+				/* Keep recently read devices at the front, clones are usually read in bursts */
+				TAILQ_REMOVE(&ch->esnap_channels, esnap_ch, link);
+				TAILQ_INSERT_HEAD(&ch->esnap_channels, esnap_ch, link);
+			}
+			return esnap_ch->channel;
 		}
 	}
-	if (bserrno != 0) {
-		SPDK_ERRLOG("Snapshot fail\n");
+
+	esnap_ch = calloc(1, sizeof(*esnap_ch));
+	if (!esnap_ch) {
+		return NULL;
 	}
 
-	blob_load_final(ctx, bserrno);
+	esnap_ch->channel = dev->esnap_dev->create_channel(dev->esnap_dev);
+	if (!esnap_ch->channel) {
+		SPDK_ERRLOG("Failed to create external snapshot device channel.\n");
+		free(esnap_ch);
+		return NULL;
+	}
+
+	esnap_ch->dev = dev;
+	__atomic_fetch_add(&dev->num_channels, 1, __ATOMIC_SEQ_CST);
+	TAILQ_INSERT_HEAD(&ch->esnap_channels, esnap_ch, link);
+
+	return esnap_ch->channel;
 }
 
-static void blob_update_clear_method(struct spdk_blob *blob);
+/*
+ * A clone may be resized past the end of its external snapshot. Returns the
+ *  number of blocks that can be read from the external snapshot, the rest of
+ *  the request reads as zeroes.
+ */
+static uint32_t
+blob_esnap_dev_lba_count(struct spdk_blob_esnap_dev *dev, uint64_t lba, uint32_t lba_count)
+{
+	if (lba >= dev->bs_dev.blockcnt) {
+		return 0;
+	}
+
+	return spdk_min(lba_count, dev->bs_dev.blockcnt - lba);
+}
 
 static void
-blob_load_backing_dev(void *cb_arg)
+blob_esnap_dev_zero_iov(struct iovec *iov, int iovcnt, uint64_t offset)
 {
-	struct spdk_blob_load_ctx	*ctx = cb_arg;
-	struct spdk_blob		*blob = ctx->blob;
-	const void			*value;
-	size_t				len;
-	int				rc;
+	int i;
 
-	if (spdk_blob_is_thin_provisioned(blob)) {
-		rc = blob_get_xattr_value(blob, BLOB_SNAPSHOT, &value, &len, true);
-		if (rc == 0) {
-			if (len != sizeof(spdk_blob_id)) {
-				blob_load_final(ctx, -EINVAL);
-				return;
-			}
-			/* open snapshot blob and continue in the callback function */
-			blob->parent_id = *(spdk_blob_id *)value;
-			spdk_bs_open_blob(blob->bs, blob->parent_id,
-					  blob_load_snapshot_cpl, ctx);
-			return;
+	for (i = 0; i < iovcnt; i++) {
+		if (offset < iov[i].iov_len) {
+			memset((uint8_t *)iov[i].iov_base + offset, 0, iov[i].iov_len - offset);
+			offset = 0;
 		} else {
-			/* add zeroes_dev for thin provisioned blob */
-			blob->back_bs_dev = bs_create_zeroes_dev();
+			offset -= iov[i].iov_len;
 		}
-	} else {
-		/* standard blob */
-		blob->back_bs_dev = NULL;
 	}
-	blob_load_final(ctx, 0);
 }
 
 static void
-blob_load_cpl_extents_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+blob_esnap_dev_read(struct spdk_bs_dev *bs_dev, struct spdk_io_channel *channel, void *payload,
+		    uint64_t lba, uint32_t lba_count, struct spdk_bs_dev_cb_args *cb_args)
 {
-	struct spdk_blob_load_ctx	*ctx = cb_arg;
-	struct spdk_blob		*blob = ctx->blob;
-	struct spdk_blob_md_page	*page;
-	uint64_t			i;
-	uint32_t			crc;
-	uint64_t			lba;
-	void				*tmp;
-	uint64_t			sz;
+	struct spdk_blob_esnap_dev *dev = (struct spdk_blob_esnap_dev *)bs_dev;
+	struct spdk_io_channel *esnap_channel;
+	uint32_t count;
 
-	if (bserrno) {
-		SPDK_ERRLOG("Extent page read failed: %d\n", bserrno);
-		blob_load_final(ctx, bserrno);
+	if (spdk_unlikely(dev->esnap_dev == NULL)) {
+		/* Degraded, the external snapshot is missing */
+		cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -EIO);
 		return;
 	}
 
-	if (ctx->pages == NULL) {
-		/* First iteration of this function, allocate buffer for single EXTENT_PAGE */
-		ctx->pages = spdk_zmalloc(SPDK_BS_PAGE_SIZE, 0,
-					  NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
-		if (!ctx->pages) {
-			blob_load_final(ctx, -ENOMEM);
-			return;
-		}
-		ctx->num_pages = 1;
-		ctx->next_extent_page = 0;
-	} else {
-		page = &ctx->pages[0];
-		crc = blob_md_page_calc_crc(page);
-		if (crc != page->crc) {
-			blob_load_final(ctx, -EINVAL);
+	count = blob_esnap_dev_lba_count(dev, lba, lba_count);
+	if (count < lba_count) {
+		memset((uint8_t *)payload + (uint64_t)count * bs_dev->blocklen, 0,
+		       (uint64_t)(lba_count - count) * bs_dev->blocklen);
+		if (count == 0) {
+			cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, 0);
 			return;
 		}
+	}
 
-		if (page->next != SPDK_INVALID_MD_PAGE) {
-			blob_load_final(ctx, -EINVAL);
-			return;
-		}
+	esnap_channel = blob_esnap_get_channel(dev, channel);
+	if (!esnap_channel) {
+		cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -ENOMEM);
+		return;
+	}
 
-		bserrno = blob_parse_extent_page(page, blob);
-		if (bserrno) {
-			blob_load_final(ctx, bserrno);
+	dev->esnap_dev->read(dev->esnap_dev, esnap_channel, payload, lba, count, cb_args);
+}
+
+static void
+blob_esnap_dev_readv(struct spdk_bs_dev *bs_dev, struct spdk_io_channel *channel,
+		     struct iovec *iov, int iovcnt,
+		     uint64_t lba, uint32_t lba_count, struct spdk_bs_dev_cb_args *cb_args)
+{
+	struct spdk_blob_esnap_dev *dev = (struct spdk_blob_esnap_dev *)bs_dev;
+	struct spdk_io_channel *esnap_channel;
+	uint32_t count;
+
+	if (spdk_unlikely(dev->esnap_dev == NULL)) {
+		/* Degraded, the external snapshot is missing */
+		cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -EIO);
+		return;
+	}
+
+	count = blob_esnap_dev_lba_count(dev, lba, lba_count);
+	if (count < lba_count) {
+		blob_esnap_dev_zero_iov(iov, iovcnt, (uint64_t)count * bs_dev->blocklen);
+		if (count == 0) {
+			cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, 0);
 			return;
 		}
 	}
 
-	for (i = ctx->next_extent_page; i < blob->active.num_extent_pages; i++) {
-		if (blob->active.extent_pages[i] != 0) {
-			/* Extent page was allocated, read and parse it. */
-			lba = bs_md_page_to_lba(blob->bs, blob->active.extent_pages[i]);
-			ctx->next_extent_page = i + 1;
+	esnap_channel = blob_esnap_get_channel(dev, channel);
+	if (!esnap_channel) {
+		cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -ENOMEM);
+		return;
+	}
 
-			bs_sequence_read_dev(seq, &ctx->pages[0], lba,
-					     bs_byte_to_lba(blob->bs, SPDK_BS_PAGE_SIZE),
-					     blob_load_cpl_extents_cpl, ctx);
-			return;
-		} else {
-			/* Thin provisioned blobs can point to unallocated extent pages.
-			 * In this case blob size should be increased by up to the amount left in remaining_clusters_in_et. */
+	dev->esnap_dev->readv(dev->esnap_dev, esnap_channel, iov, iovcnt, lba, count, cb_args);
+}
 
-			sz = spdk_min(blob->remaining_clusters_in_et, SPDK_EXTENTS_PER_EP);
-			blob->active.num_clusters += sz;
-			blob->remaining_clusters_in_et -= sz;
+static void
+blob_esnap_dev_write(struct spdk_bs_dev *bs_dev, struct spdk_io_channel *channel, void *payload,
+		     uint64_t lba, uint32_t lba_count,
+		     struct spdk_bs_dev_cb_args *cb_args)
+{
+	cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -EPERM);
+	assert(false);
+}
 
-			assert(spdk_blob_is_thin_provisioned(blob));
-			assert(i + 1 < blob->active.num_extent_pages || blob->remaining_clusters_in_et == 0);
+static void
+blob_esnap_dev_writev(struct spdk_bs_dev *bs_dev, struct spdk_io_channel *channel,
+		      struct iovec *iov, int iovcnt,
+		      uint64_t lba, uint32_t lba_count,
+		      struct spdk_bs_dev_cb_args *cb_args)
+{
+	cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -EPERM);
+	assert(false);
+}
 
-			tmp = realloc(blob->active.clusters, blob->active.num_clusters * sizeof(*blob->active.clusters));
-			if (tmp == NULL) {
-				blob_load_final(ctx, -ENOMEM);
-				return;
-			}
-			memset(tmp + sizeof(*blob->active.clusters) * blob->active.cluster_array_size, 0,
-			       sizeof(*blob->active.clusters) * (blob->active.num_clusters - blob->active.cluster_array_size));
-			blob->active.clusters = tmp;
-			blob->active.cluster_array_size = blob->active.num_clusters;
-		}
-	}
+static void
+blob_esnap_dev_write_zeroes(struct spdk_bs_dev *bs_dev, struct spdk_io_channel *channel,
+			    uint64_t lba, uint32_t lba_count,
+			    struct spdk_bs_dev_cb_args *cb_args)
+{
+	cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -EPERM);
+	assert(false);
+}
 
-	blob_load_backing_dev(ctx);
+static void
+blob_esnap_dev_unmap(struct spdk_bs_dev *bs_dev, struct spdk_io_channel *channel,
+		     uint64_t lba, uint32_t lba_count,
+		     struct spdk_bs_dev_cb_args *cb_args)
+{
+	cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, -EPERM);
+	assert(false);
 }
 
 static void
-blob_load_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+blob_esnap_release_channel(struct spdk_io_channel_iter *i)
 {
-	struct spdk_blob_load_ctx	*ctx = cb_arg;
-	struct spdk_blob		*blob = ctx->blob;
-	struct spdk_blob_md_page	*page;
-	int				rc;
-	uint32_t			crc;
-	uint32_t			current_page;
+	struct blob_esnap_release_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(_ch);
+	struct spdk_bs_esnap_channel *esnap_ch;
 
-	if (ctx->num_pages == 1) {
-		current_page = bs_blobid_to_page(blob->id);
-	} else {
-		assert(ctx->num_pages != 0);
-		page = &ctx->pages[ctx->num_pages - 2];
-		current_page = page->next;
+	TAILQ_FOREACH(esnap_ch, &ch->esnap_channels, link) {
+		if (esnap_ch->dev == ctx->dev) {
+			bs_esnap_channel_free(ch, esnap_ch);
+			break;
+		}
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+blob_esnap_release_channels_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct blob_esnap_release_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	assert(status != 0 || ctx->dev->num_channels == 0);
+	ctx->cb_fn(ctx->cb_arg, status);
+	free(ctx);
+}
+
+/*
+ * Destroy the channels to the external snapshot held by every blobstore
+ *  channel. Must complete before the esnap device is destroyed.
+ */
+static void
+blob_esnap_release_channels(struct spdk_blob_esnap_dev *dev, spdk_blob_op_complete cb_fn,
+			    void *cb_arg)
+{
+	struct blob_esnap_release_ctx *ctx;
+
+	if (__atomic_load_n(&dev->num_channels, __ATOMIC_SEQ_CST) == 0) {
+		cb_fn(cb_arg, 0);
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->dev = dev;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_for_each_channel(dev->bs, blob_esnap_release_channel, ctx,
+			      blob_esnap_release_channels_done);
+}
+
+static void
+blob_esnap_dev_destroy_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_esnap_dev *dev = cb_arg;
+
+	if (bserrno != 0) {
+		/* Channels still reference the device, leak it rather than free it under them */
+		SPDK_ERRLOG("Failed to release external snapshot channels: %d\n", bserrno);
+		return;
+	}
+
+	if (dev->esnap_dev != NULL) {
+		dev->esnap_dev->destroy(dev->esnap_dev);
+	}
+	free(dev);
+}
+
+static void
+blob_esnap_dev_destroy(struct spdk_bs_dev *bs_dev)
+{
+	struct spdk_blob_esnap_dev *dev = (struct spdk_blob_esnap_dev *)bs_dev;
+
+	/* Channels are normally released by spdk_blob_close() before the blob is freed */
+	blob_esnap_release_channels(dev, blob_esnap_dev_destroy_cpl, dev);
+}
+
+static int
+blob_esnap_dev_validate(struct spdk_blob *blob, struct spdk_bs_dev *esnap_dev)
+{
+	struct spdk_blob_store *bs = blob->bs;
+
+	if (esnap_dev->blocklen == 0 || bs->io_unit_size % esnap_dev->blocklen != 0 ||
+	    !esnap_dev->create_channel || !esnap_dev->destroy_channel ||
+	    !esnap_dev->read || !esnap_dev->readv) {
+		SPDK_ERRLOG("External snapshot of blob %lu cannot back a blob with io unit size %u\n",
+			    blob->id, bs->io_unit_size);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static int
+blob_esnap_dev_create(struct spdk_blob *blob, struct spdk_bs_dev **_bs_dev)
+{
+	struct spdk_blob_store		*bs = blob->bs;
+	struct spdk_blob_esnap_dev	*dev;
+	struct spdk_bs_dev		*esnap_dev = NULL;
+	const void			*esnap_id;
+	size_t				id_len;
+	int				rc;
+
+	rc = blob_get_xattr_value(blob, BLOB_EXTERNAL_SNAPSHOT_ID, &esnap_id, &id_len, true);
+	if (rc != 0) {
+		SPDK_ERRLOG("Blob %lu has no external snapshot id\n", blob->id);
+		return -EINVAL;
+	}
+
+	if (bs->esnap_bs_dev_create == NULL) {
+		SPDK_ERRLOG("Blob %lu is an esnap clone, but no esnap_bs_dev_create was given\n",
+			    blob->id);
+		return -ENOTSUP;
+	}
+
+	rc = bs->esnap_bs_dev_create(bs->esnap_ctx, blob, esnap_id, id_len, &esnap_dev);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to open external snapshot of blob %lu: %d\n", blob->id, rc);
+		return rc;
+	}
+
+	if (esnap_dev != NULL) {
+		rc = blob_esnap_dev_validate(blob, esnap_dev);
+		if (rc != 0) {
+			esnap_dev->destroy(esnap_dev);
+			return rc;
+		}
+	}
+
+	dev = calloc(1, sizeof(*dev));
+	if (!dev) {
+		if (esnap_dev != NULL) {
+			esnap_dev->destroy(esnap_dev);
+		}
+		return -ENOMEM;
+	}
+
+	if (esnap_dev != NULL) {
+		dev->bs_dev.blockcnt = esnap_dev->blockcnt;
+		dev->bs_dev.blocklen = esnap_dev->blocklen;
+	} else {
+		/* The size of the external snapshot is unknown, fail all reads */
+		SPDK_NOTICELOG("External snapshot of blob %lu is missing, opening it degraded\n",
+			       blob->id);
+		dev->bs_dev.blockcnt = UINT64_MAX;
+		dev->bs_dev.blocklen = bs->io_unit_size;
+	}
+	dev->bs_dev.destroy = blob_esnap_dev_destroy;
+	dev->bs_dev.read = blob_esnap_dev_read;
+	dev->bs_dev.readv = blob_esnap_dev_readv;
+	dev->bs_dev.write = blob_esnap_dev_write;
+	dev->bs_dev.writev = blob_esnap_dev_writev;
+	dev->bs_dev.write_zeroes = blob_esnap_dev_write_zeroes;
+	dev->bs_dev.unmap = blob_esnap_dev_unmap;
+	dev->esnap_dev = esnap_dev;
+	dev->bs = bs;
+
+	*_bs_dev = &dev->bs_dev;
+	return 0;
+}
+
+/* END esnap clone back bs_dev */
+
+static void
+blob_load_snapshot_cpl(void *cb_arg, struct spdk_blob *snapshot, int bserrno)
+{
+	struct spdk_blob_load_ctx	*ctx = cb_arg;
+	struct spdk_blob		*blob = ctx->blob;
+
+	if (bserrno == 0) {
+		blob->back_bs_dev = bs_create_blob_bs_dev(snapshot);
+		if (blob->back_bs_dev == NULL) {
+			bserrno = -ENOMEM;
+		}
+	}
+	if (bserrno != 0) {
+		SPDK_ERRLOG("Snapshot fail\n");
+	}
+
+	blob_load_final(ctx, bserrno);
+}
+
+static void blob_update_clear_method(struct spdk_blob *blob);
+
+static void
+blob_load_backing_dev(void *cb_arg)
+{
+	struct spdk_blob_load_ctx	*ctx = cb_arg;
+	struct spdk_blob		*blob = ctx->blob;
+	const void			*value;
+	size_t				len;
+	int				rc;
+
+	if (spdk_blob_is_esnap_clone(blob)) {
+		rc = blob_esnap_dev_create(blob, &blob->back_bs_dev);
+		blob_load_final(ctx, rc);
+		return;
+	}
+
+	if (spdk_blob_is_thin_provisioned(blob)) {
+		rc = blob_get_xattr_value(blob, BLOB_SNAPSHOT, &value, &len, true);
+		if (rc == 0) {
+			if (len != sizeof(spdk_blob_id)) {
+				blob_load_final(ctx, -EINVAL);
+				return;
+			}
+			/* open snapshot blob and continue in the callback function */
+			blob->parent_id = *(spdk_blob_id *)value;
+			spdk_bs_open_blob(blob->bs, blob->parent_id,
+					  blob_load_snapshot_cpl, ctx);
+			return;
+		} else {
+			/* add zeroes_dev for thin provisioned blob */
+			blob->back_bs_dev = bs_create_zeroes_dev();
+		}
+	} else {
+		/* standard blob */
+		blob->back_bs_dev = NULL;
+	}
+	blob_load_final(ctx, 0);
+}
+
+static void
+blob_load_cpl_extents_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_blob_load_ctx	*ctx = cb_arg;
+	struct spdk_blob		*blob = ctx->blob;
+	struct spdk_blob_md_page	*page;
+	uint64_t			i;
+	uint32_t			crc;
+	uint64_t			lba;
+	void				*tmp;
+	uint64_t			sz;
+
+	if (bserrno) {
+		SPDK_ERRLOG("Extent page read failed: %d\n", bserrno);
+		blob_load_final(ctx, bserrno);
+		return;
+	}
+
+	if (ctx->pages == NULL) {
+		/* First iteration of this function, allocate buffer for single EXTENT_PAGE */
+		ctx->pages = spdk_zmalloc(SPDK_BS_PAGE_SIZE, 0,
+					  NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+		if (!ctx->pages) {
+			blob_load_final(ctx, -ENOMEM);
+			return;
+		}
+		ctx->num_pages = 1;
+		ctx->next_extent_page = 0;
+	} else {
+		page = &ctx->pages[0];
+		crc = blob_md_page_calc_crc(page);
+		if (crc != page->crc) {
+			blob_load_final(ctx, -EINVAL);
+			return;
+		}
+
+		if (page->next != SPDK_INVALID_MD_PAGE) {
+			blob_load_final(ctx, -EINVAL);
+			return;
+		}
+
+		bserrno = blob_parse_extent_page(page, blob);
+		if (bserrno) {
+			blob_load_final(ctx, bserrno);
+			return;
+		}
+	}
+
+	for (i = ctx->next_extent_page; i < blob->active.num_extent_pages; i++) {
+		if (blob->active.extent_pages[i] != 0) {
+			/* Extent page was allocated, read and parse it. */
+			lba = bs_md_page_to_lba(blob->bs, blob->active.extent_pages[i]);
+			ctx->next_extent_page = i + 1;
+
+			bs_sequence_read_dev(seq, &ctx->pages[0], lba,
+					     bs_byte_to_lba(blob->bs, SPDK_BS_PAGE_SIZE),
+					     blob_load_cpl_extents_cpl, ctx);
+			return;
+		} else {
+			/* Thin provisioned blobs can point to unallocated extent pages.
+			 * In this case blob size should be increased by up to the amount left in remaining_clusters_in_et. */
+
+			sz = spdk_min(blob->remaining_clusters_in_et, SPDK_EXTENTS_PER_EP);
+			blob->active.num_clusters += sz;
+			blob->remaining_clusters_in_et -= sz;
+
+			assert(spdk_blob_is_thin_provisioned(blob));
+			assert(i + 1 < blob->active.num_extent_pages || blob->remaining_clusters_in_et == 0);
+
+			tmp = realloc(blob->active.clusters, blob->active.num_clusters * sizeof(*blob->active.clusters));
+			if (tmp == NULL) {
+				blob_load_final(ctx, -ENOMEM);
+				return;
+			}
+			memset(tmp + sizeof(*blob->active.clusters) * blob->active.cluster_array_size, 0,
+			       sizeof(*blob->active.clusters) * (blob->active.num_clusters - blob->active.cluster_array_size));
+			blob->active.clusters = tmp;
+			blob->active.cluster_array_size = blob->active.num_clusters;
+		}
+	}
+
+	blob_load_backing_dev(ctx);
+}
+
+static void
+blob_load_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+{
+	struct spdk_blob_load_ctx	*ctx = cb_arg;
+	struct spdk_blob		*blob = ctx->blob;
+	struct spdk_blob_md_page	*page;
+	int				rc;
+	uint32_t			crc;
+	uint32_t			current_page;
+
+	if (ctx->num_pages == 1) {
+		current_page = bs_blobid_to_page(blob->id);
+	} else {
+		assert(ctx->num_pages != 0);
+		page = &ctx->pages[ctx->num_pages - 2];
+		current_page = page->next;
 	}
 
 	if (bserrno) {
@@ -1532,27 +2100,235 @@ blob_load(spdk_bs_sequence_t *seq, struct spdk_blob *blob,
 			     blob_load_cpl, ctx);
 }
 
-struct spdk_blob_persist_ctx {
-	struct spdk_blob		*blob;
-
-	struct spdk_bs_super_block	*super;
-
-	struct spdk_blob_md_page	*pages;
-	uint32_t			next_extent_page;
-	struct spdk_blob_md_page	*extent_page;
+/* START md page write batching */
 
+/*
+ * Metadata page writes of all blobs are queued on the blobstore and submitted
+ * together on the next iteration of the md thread. Pages that are adjacent on
+ * disk are merged into one write, so that e.g. the root pages of many blobs
+ * synced at the same time do not each need their own I/O.
+ */
+struct spdk_bs_md_write_req {
 	spdk_bs_sequence_t		*seq;
 	spdk_bs_sequence_cpl		cb_fn;
 	void				*cb_arg;
-	TAILQ_ENTRY(spdk_blob_persist_ctx) link;
+	uint32_t			outstanding;
+	int				bserrno;
+
+	struct spdk_bs_md_write_page {
+		struct spdk_bs_md_write_req	*req;
+		uint32_t			page_num;
+		struct spdk_blob_md_page	*page;
+		TAILQ_ENTRY(spdk_bs_md_write_page) link;
+	} pages[0];
+};
+
+struct spdk_bs_md_write_run {
+	struct spdk_bs_dev_cb_args	cb_args;
+	void				*buf;
+	uint32_t			count;
+	struct spdk_bs_md_write_page	*pages[0];
 };
 
 static void
-bs_batch_clear_dev(struct spdk_blob_persist_ctx *ctx, spdk_bs_batch_t *batch, uint64_t lba,
-		   uint32_t lba_count)
+bs_md_write_page_done(struct spdk_bs_md_write_page *write, int bserrno)
 {
-	switch (ctx->blob->clear_method) {
-	case BLOB_CLEAR_WITH_DEFAULT:
+	struct spdk_bs_md_write_req *req = write->req;
+
+	if (bserrno != 0 && req->bserrno == 0) {
+		req->bserrno = bserrno;
+	}
+
+	assert(req->outstanding > 0);
+	if (--req->outstanding == 0) {
+		req->cb_fn(req->seq, req->cb_arg, req->bserrno);
+		free(req);
+	}
+}
+
+static void
+bs_md_write_run_cpl(struct spdk_io_channel *channel, void *cb_arg, int bserrno)
+{
+	struct spdk_bs_md_write_run *run = cb_arg;
+	uint32_t i;
+
+	for (i = 0; i < run->count; i++) {
+		bs_md_write_page_done(run->pages[i], bserrno);
+	}
+
+	spdk_free(run->buf);
+	free(run);
+}
+
+static int
+bs_md_write_page_cmp(const void *a, const void *b)
+{
+	const struct spdk_bs_md_write_page *write_a = *(struct spdk_bs_md_write_page *const *)a;
+	const struct spdk_bs_md_write_page *write_b = *(struct spdk_bs_md_write_page *const *)b;
+
+	if (write_a->page_num < write_b->page_num) {
+		return -1;
+	} else if (write_a->page_num > write_b->page_num) {
+		return 1;
+	}
+	return 0;
+}
+
+static void
+bs_md_write_submit_run(struct spdk_blob_store *bs, struct spdk_bs_md_write_page **writes,
+		       uint32_t count)
+{
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(bs->md_channel);
+	struct spdk_bs_md_write_run *run;
+	void *payload;
+	uint32_t i;
+
+	run = calloc(1, sizeof(*run) + count * sizeof(*run->pages));
+	if (!run) {
+		for (i = 0; i < count; i++) {
+			bs_md_write_page_done(writes[i], -ENOMEM);
+		}
+		return;
+	}
+
+	if (count == 1) {
+		payload = writes[0]->page;
+	} else {
+		run->buf = spdk_malloc(count * SPDK_BS_PAGE_SIZE, SPDK_BS_PAGE_SIZE, NULL,
+				       SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+		if (!run->buf) {
+			/* Write the pages one by one, straight from the callers' buffers */
+			free(run);
+			for (i = 0; i < count; i++) {
+				bs_md_write_submit_run(bs, &writes[i], 1);
+			}
+			return;
+		}
+		for (i = 0; i < count; i++) {
+			memcpy((uint8_t *)run->buf + i * SPDK_BS_PAGE_SIZE, writes[i]->page, SPDK_BS_PAGE_SIZE);
+		}
+		payload = run->buf;
+	}
+
+	memcpy(run->pages, writes, count * sizeof(*run->pages));
+	run->count = count;
+	run->cb_args.cb_fn = bs_md_write_run_cpl;
+	run->cb_args.cb_arg = run;
+	run->cb_args.channel = ch->dev_channel;
+
+	bs->dev->write(bs->dev, ch->dev_channel, payload, bs_md_page_to_lba(bs, writes[0]->page_num),
+		       bs_byte_to_lba(bs, count * SPDK_BS_PAGE_SIZE), &run->cb_args);
+}
+
+static void
+bs_md_write_flush(void *arg)
+{
+	struct spdk_blob_store *bs = arg;
+	struct spdk_bs_md_write_page *write, **writes;
+	uint32_t count = 0, i, j;
+
+	bs->md_writes_flush_pending = false;
+
+	TAILQ_FOREACH(write, &bs->md_writes, link) {
+		count++;
+	}
+
+	writes = calloc(count, sizeof(*writes));
+	if (!writes) {
+		while ((write = TAILQ_FIRST(&bs->md_writes)) != NULL) {
+			TAILQ_REMOVE(&bs->md_writes, write, link);
+			bs_md_write_page_done(write, -ENOMEM);
+		}
+		return;
+	}
+
+	i = 0;
+	while ((write = TAILQ_FIRST(&bs->md_writes)) != NULL) {
+		TAILQ_REMOVE(&bs->md_writes, write, link);
+		writes[i++] = write;
+	}
+
+	qsort(writes, count, sizeof(*writes), bs_md_write_page_cmp);
+
+	for (i = 0; i < count; i = j) {
+		for (j = i + 1; j < count && j - i < BS_MD_WRITE_MAX_PAGES; j++) {
+			if (writes[j]->page_num != writes[j - 1]->page_num + 1) {
+				break;
+			}
+		}
+
+		bs_md_write_submit_run(bs, &writes[i], j - i);
+	}
+
+	free(writes);
+}
+
+/*
+ * Write count metadata pages, pages[i] to md page page_nums[i], and call cb_fn
+ * once all of them are on disk. Must be called on the md thread.
+ */
+static void
+bs_md_write_pages(spdk_bs_sequence_t *seq, struct spdk_blob_store *bs,
+		  struct spdk_blob_md_page *pages, const uint32_t *page_nums, uint32_t count,
+		  spdk_bs_sequence_cpl cb_fn, void *cb_arg)
+{
+	struct spdk_bs_md_write_req *req;
+	uint32_t i;
+
+	assert(spdk_get_thread() == bs->md_thread);
+
+	if (count == 0) {
+		cb_fn(seq, cb_arg, 0);
+		return;
+	}
+
+	req = calloc(1, sizeof(*req) + count * sizeof(*req->pages));
+	if (!req) {
+		cb_fn(seq, cb_arg, -ENOMEM);
+		return;
+	}
+
+	req->seq = seq;
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+	req->outstanding = count;
+
+	for (i = 0; i < count; i++) {
+		req->pages[i].req = req;
+		req->pages[i].page_num = page_nums[i];
+		req->pages[i].page = &pages[i];
+		TAILQ_INSERT_TAIL(&bs->md_writes, &req->pages[i], link);
+	}
+
+	if (!bs->md_writes_flush_pending) {
+		bs->md_writes_flush_pending = true;
+		spdk_thread_send_msg(bs->md_thread, bs_md_write_flush, bs);
+	}
+}
+
+/* END md page write batching */
+
+struct spdk_blob_persist_ctx {
+	struct spdk_blob		*blob;
+
+	struct spdk_bs_super_block	*super;
+
+	struct spdk_blob_md_page	*pages;
+	struct spdk_blob_md_page	*extent_pages;
+	uint32_t			*extent_page_nums;
+
+	spdk_bs_sequence_t		*seq;
+	spdk_bs_sequence_cpl		cb_fn;
+	void				*cb_arg;
+	TAILQ_ENTRY(spdk_blob_persist_ctx) link;
+};
+
+static void
+bs_batch_clear_dev(struct spdk_blob_persist_ctx *ctx, spdk_bs_batch_t *batch, uint64_t lba,
+		   uint32_t lba_count)
+{
+	switch (ctx->blob->clear_method) {
+	case BLOB_CLEAR_WITH_DEFAULT:
 	case BLOB_CLEAR_WITH_UNMAP:
 		bs_batch_unmap_dev(batch, lba, lba_count);
 		break;
@@ -1570,26 +2346,40 @@ static void blob_persist_check_dirty(struct spdk_blob_persist_ctx *ctx);
 static void
 blob_persist_complete(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ctx *ctx, int bserrno)
 {
-	struct spdk_blob_persist_ctx	*next_persist;
+	struct spdk_blob_persist_ctx	*next_persist, *tmp;
 	struct spdk_blob		*blob = ctx->blob;
+	TAILQ_HEAD(, spdk_blob_persist_ctx) completed;
 
 	if (bserrno == 0) {
 		blob_mark_clean(blob);
 	}
 
-	assert(ctx == TAILQ_FIRST(&blob->pending_persists));
-	TAILQ_REMOVE(&blob->pending_persists, ctx, link);
+	assert(ctx == TAILQ_FIRST(&blob->persists_to_complete));
 
-	next_persist = TAILQ_FIRST(&blob->pending_persists);
+	TAILQ_INIT(&completed);
+	TAILQ_SWAP(&completed, &blob->persists_to_complete, spdk_blob_persist_ctx, link);
 
-	/* Call user callback */
-	ctx->cb_fn(seq, ctx->cb_arg, bserrno);
+	/* All persists queued while this one was in progress are completed together
+	 * by a single write of the metadata. Move them before calling the callbacks,
+	 * so that persists requested from the callbacks wait for it. */
+	TAILQ_SWAP(&blob->persists_to_complete, &blob->pending_persists, spdk_blob_persist_ctx, link);
+	next_persist = TAILQ_FIRST(&blob->persists_to_complete);
 
-	/* Free the memory */
-	spdk_free(ctx->pages);
-	free(ctx);
+	TAILQ_FOREACH_SAFE(ctx, &completed, link, tmp) {
+		TAILQ_REMOVE(&completed, ctx, link);
+
+		/* Call user callback */
+		ctx->cb_fn(ctx->seq, ctx->cb_arg, bserrno);
+
+		/* Free the memory */
+		spdk_free(ctx->pages);
+		free(ctx);
+	}
 
 	if (next_persist != NULL) {
+		/* The persist that just completed marked the blob clean, but it might
+		 * have been serialized before the changes the next one was queued for. */
+		blob->state = SPDK_BLOB_STATE_DIRTY;
 		blob_persist_check_dirty(next_persist);
 	}
 }
@@ -1839,10 +2629,7 @@ blob_persist_write_page_root(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
 	struct spdk_blob_persist_ctx	*ctx = cb_arg;
 	struct spdk_blob		*blob = ctx->blob;
-	struct spdk_blob_store		*bs = blob->bs;
-	uint64_t			lba;
-	uint32_t			lba_count;
-	struct spdk_blob_md_page	*page;
+	uint32_t			page_num;
 
 	if (bserrno != 0) {
 		blob_persist_complete(seq, ctx, bserrno);
@@ -1855,48 +2642,32 @@ blob_persist_write_page_root(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 		return;
 	}
 
-	lba_count = bs_byte_to_lba(bs, sizeof(*page));
-
-	page = &ctx->pages[0];
 	/* The first page in the metadata goes where the blobid indicates */
-	lba = bs_md_page_to_lba(bs, bs_blobid_to_page(blob->id));
+	page_num = bs_blobid_to_page(blob->id);
 
-	bs_sequence_write_dev(seq, page, lba, lba_count,
-			      blob_persist_zero_pages, ctx);
+	bs_md_write_pages(seq, blob->bs, &ctx->pages[0], &page_num, 1,
+			  blob_persist_zero_pages, ctx);
 }
 
 static void
 blob_persist_write_page_chain(spdk_bs_sequence_t *seq, struct spdk_blob_persist_ctx *ctx)
 {
 	struct spdk_blob		*blob = ctx->blob;
-	struct spdk_blob_store		*bs = blob->bs;
-	uint64_t			lba;
-	uint32_t			lba_count;
-	struct spdk_blob_md_page	*page;
-	spdk_bs_batch_t			*batch;
 	size_t				i;
 
 	/* Clusters don't move around in blobs. The list shrinks or grows
 	 * at the end, but no changes ever occur in the middle of the list.
 	 */
 
-	lba_count = bs_byte_to_lba(bs, sizeof(*page));
-
-	batch = bs_sequence_to_batch(seq, blob_persist_write_page_root, ctx);
+	for (i = 1; i < blob->active.num_pages; i++) {
+		assert(ctx->pages[i].sequence_num == i);
+	}
 
 	/* This starts at 1. The root page is not written until
 	 * all of the others are finished
 	 */
-	for (i = 1; i < blob->active.num_pages; i++) {
-		page = &ctx->pages[i];
-		assert(page->sequence_num == i);
-
-		lba = bs_md_page_to_lba(bs, blob->active.pages[i]);
-
-		bs_batch_write_dev(batch, page, lba, lba_count);
-	}
-
-	bs_batch_close(batch);
+	bs_md_write_pages(seq, blob->bs, &ctx->pages[1], &blob->active.pages[1],
+			  blob->active.num_pages - 1, blob_persist_write_page_root, ctx);
 }
 
 static int
@@ -1908,6 +2679,8 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 	uint32_t	lfmd; /*  lowest free md page */
 	uint64_t	num_clusters;
 	uint32_t	*ep_tmp;
+	uint16_t	*counts_tmp;
+	uint32_t	*heatmap_tmp;
 	uint64_t	new_num_ep = 0, current_num_ep = 0;
 	struct spdk_blob_store *bs;
 
@@ -1939,6 +2712,12 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 
 	/* Check first that we have enough clusters and md pages before we start claiming them. */
 	if (sz > num_clusters && spdk_blob_is_thin_provisioned(blob) == false) {
+		if ((sz - num_clusters) > bs->num_free_clusters) {
+			/* Clusters reserved by channels are reported as free */
+			pthread_mutex_lock(&bs->used_clusters_mutex);
+			bs_reclaim_reserved_clusters(bs, sz - num_clusters);
+			pthread_mutex_unlock(&bs->used_clusters_mutex);
+		}
 		if ((sz - num_clusters) > bs->num_free_clusters) {
 			return -ENOSPC;
 		}
@@ -1978,6 +2757,28 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 		}
 	}
 
+	if (blob->cor_read_counts != NULL && sz > blob->cor_read_counts_len) {
+		counts_tmp = realloc(blob->cor_read_counts, sizeof(*blob->cor_read_counts) * sz);
+		if (counts_tmp == NULL) {
+			return -ENOMEM;
+		}
+		memset(counts_tmp + blob->cor_read_counts_len, 0,
+		       sizeof(*blob->cor_read_counts) * (sz - blob->cor_read_counts_len));
+		blob->cor_read_counts = counts_tmp;
+		blob->cor_read_counts_len = sz;
+	}
+
+	if (blob->io_heatmap != NULL && sz > blob->io_heatmap_len) {
+		heatmap_tmp = realloc(blob->io_heatmap, sizeof(*blob->io_heatmap) * sz);
+		if (heatmap_tmp == NULL) {
+			return -ENOMEM;
+		}
+		memset(heatmap_tmp + blob->io_heatmap_len, 0,
+		       sizeof(*blob->io_heatmap) * (sz - blob->io_heatmap_len));
+		blob->io_heatmap = heatmap_tmp;
+		blob->io_heatmap_len = sz;
+	}
+
 	blob->state = SPDK_BLOB_STATE_DIRTY;
 
 	if (spdk_blob_is_thin_provisioned(blob) == false) {
@@ -1985,8 +2786,10 @@ blob_resize(struct spdk_blob *blob, uint64_t sz)
 		lfmd = 0;
 		pthread_mutex_lock(&blob->bs->used_clusters_mutex);
 		for (i = num_clusters; i < sz; i++) {
+			/* lfmd is moved to the md page claimed for a new extent page, if
+			 * any. Moving it on every cluster runs past md_len once a blob has
+			 * more clusters than there are md pages, e.g. after spdk_bs_grow(). */
 			bs_allocate_cluster(blob, i, &cluster, &lfmd, true);
-			lfmd++;
 		}
 		pthread_mutex_unlock(&blob->bs->used_clusters_mutex);
 	}
@@ -2058,27 +2861,45 @@ blob_persist_generate_new_md(struct spdk_blob_persist_ctx *ctx)
 }
 
 static void
-blob_persist_write_extent_pages(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+blob_persist_write_extent_pages_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
 	struct spdk_blob_persist_ctx	*ctx = cb_arg;
+
+	spdk_free(ctx->extent_pages);
+	ctx->extent_pages = NULL;
+	free(ctx->extent_page_nums);
+	ctx->extent_page_nums = NULL;
+
+	if (bserrno != 0) {
+		blob_persist_complete(seq, ctx, bserrno);
+		return;
+	}
+
+	blob_persist_generate_new_md(ctx);
+}
+
+static void
+blob_persist_write_extent_pages(struct spdk_blob_persist_ctx *ctx)
+{
+	spdk_bs_sequence_t		*seq = ctx->seq;
 	struct spdk_blob		*blob = ctx->blob;
+	struct spdk_blob_md_page	*page;
 	size_t				i;
 	uint32_t			extent_page_id;
 	uint32_t                        page_count = 0;
 	int				rc;
 
-	if (ctx->extent_page != NULL) {
-		spdk_free(ctx->extent_page);
-		ctx->extent_page = NULL;
-	}
-
-	if (bserrno != 0) {
-		blob_persist_complete(seq, ctx, bserrno);
-		return;
+	if (blob->active.num_extent_pages > 0) {
+		ctx->extent_page_nums = calloc(blob->active.num_extent_pages,
+					       sizeof(*ctx->extent_page_nums));
+		if (!ctx->extent_page_nums) {
+			blob_persist_complete(seq, ctx, -ENOMEM);
+			return;
+		}
 	}
 
-	/* Only write out changed extent pages */
-	for (i = ctx->next_extent_page; i < blob->active.num_extent_pages; i++) {
+	/* Only write out changed extent pages. All of them are written at once. */
+	for (i = 0; i < blob->active.num_extent_pages; i++) {
 		extent_page_id = blob->active.extent_pages[i];
 		if (extent_page_id == 0) {
 			/* No Extent Page to persist */
@@ -2090,26 +2911,25 @@ blob_persist_write_extent_pages(spdk_bs_sequence_t *seq, void *cb_arg, int bserr
 		if (i >= blob->clean.extent_pages_array_size || blob->clean.extent_pages[i] == 0) {
 			blob->state = SPDK_BLOB_STATE_DIRTY;
 			assert(spdk_bit_array_get(blob->bs->used_md_pages, extent_page_id));
-			ctx->next_extent_page = i + 1;
-			rc = blob_serialize_add_page(ctx->blob, &ctx->extent_page, &page_count, &ctx->extent_page);
+			rc = blob_serialize_add_page(ctx->blob, &ctx->extent_pages, &page_count, &page);
 			if (rc < 0) {
-				blob_persist_complete(seq, ctx, rc);
+				blob_persist_write_extent_pages_cpl(seq, ctx, rc);
 				return;
 			}
+			/* Extent pages are not part of the md page chain */
+			page->sequence_num = 0;
 
-			blob_serialize_extent_page(blob, i * SPDK_EXTENTS_PER_EP, ctx->extent_page);
-
-			ctx->extent_page->crc = blob_md_page_calc_crc(ctx->extent_page);
+			blob_serialize_extent_page(blob, i * SPDK_EXTENTS_PER_EP, page);
 
-			bs_sequence_write_dev(seq, ctx->extent_page, bs_md_page_to_lba(blob->bs, extent_page_id),
-					      bs_byte_to_lba(blob->bs, SPDK_BS_PAGE_SIZE),
-					      blob_persist_write_extent_pages, ctx);
-			return;
+			page->crc = blob_md_page_calc_crc(page);
+			ctx->extent_page_nums[page_count - 1] = extent_page_id;
+			continue;
 		}
 		assert(blob->clean.extent_pages[i] != 0);
 	}
 
-	blob_persist_generate_new_md(ctx);
+	bs_md_write_pages(seq, blob->bs, ctx->extent_pages, ctx->extent_page_nums, page_count,
+			  blob_persist_write_extent_pages_cpl, ctx);
 }
 
 static void
@@ -2128,7 +2948,7 @@ blob_persist_start(struct spdk_blob_persist_ctx *ctx)
 
 	}
 
-	blob_persist_write_extent_pages(seq, ctx, 0);
+	blob_persist_write_extent_pages(ctx);
 }
 
 static void
@@ -2200,7 +3020,7 @@ blob_persist(spdk_bs_sequence_t *seq, struct spdk_blob *blob,
 
 	blob_verify_md_op(blob);
 
-	if (blob->state == SPDK_BLOB_STATE_CLEAN && TAILQ_EMPTY(&blob->pending_persists)) {
+	if (blob->state == SPDK_BLOB_STATE_CLEAN && TAILQ_EMPTY(&blob->persists_to_complete)) {
 		cb_fn(seq, cb_arg, 0);
 		return;
 	}
@@ -2214,38 +3034,123 @@ blob_persist(spdk_bs_sequence_t *seq, struct spdk_blob *blob,
 	ctx->seq = seq;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
-	ctx->next_extent_page = 0;
 
 	/* Multiple blob persists can affect one another, via blob->state or
 	 * blob mutable data changes. To prevent it, queue up the persists. */
-	if (!TAILQ_EMPTY(&blob->pending_persists)) {
+	if (!TAILQ_EMPTY(&blob->persists_to_complete)) {
 		TAILQ_INSERT_TAIL(&blob->pending_persists, ctx, link);
 		return;
 	}
-	TAILQ_INSERT_HEAD(&blob->pending_persists, ctx, link);
+	TAILQ_INSERT_HEAD(&blob->persists_to_complete, ctx, link);
 
 	blob_persist_check_dirty(ctx);
 }
 
+/* START I/O statistics */
+
+static inline void
+blob_io_stat_count(struct spdk_blob *blob, enum spdk_blob_op_type op_type,
+		   uint64_t io_unit, uint64_t length, bool is_allocated)
+{
+	struct spdk_blob_io_stat *stat = blob->io_stat;
+	uint64_t bytes, num_ops, cluster;
+
+	if (spdk_likely(stat == NULL)) {
+		return;
+	}
+
+	bytes = length * blob->bs->io_unit_size;
+
+	switch (op_type) {
+	case SPDK_BLOB_READ:
+	case SPDK_BLOB_READV:
+		num_ops = __atomic_add_fetch(&stat->num_read_ops, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&stat->bytes_read, bytes, __ATOMIC_RELAXED);
+		if (!is_allocated &&
+		    (blob->parent_id != SPDK_BLOBID_INVALID || spdk_blob_is_esnap_clone(blob))) {
+			__atomic_fetch_add(&stat->num_backing_dev_reads, 1, __ATOMIC_RELAXED);
+			__atomic_fetch_add(&stat->bytes_backing_dev_read, bytes, __ATOMIC_RELAXED);
+		}
+		break;
+	case SPDK_BLOB_WRITE:
+	case SPDK_BLOB_WRITEV:
+		num_ops = __atomic_add_fetch(&stat->num_write_ops, 1, __ATOMIC_RELAXED);
+		__atomic_fetch_add(&stat->bytes_written, bytes, __ATOMIC_RELAXED);
+		break;
+	case SPDK_BLOB_UNMAP:
+		num_ops = __atomic_add_fetch(&stat->num_unmap_ops, 1, __ATOMIC_RELAXED);
+		break;
+	case SPDK_BLOB_WRITE_ZEROES:
+		num_ops = __atomic_add_fetch(&stat->num_write_zeroes_ops, 1, __ATOMIC_RELAXED);
+		break;
+	default:
+		return;
+	}
+
+	if (blob->io_heatmap == NULL || num_ops % blob->io_heatmap_sample_rate != 0) {
+		return;
+	}
+
+	cluster = bs_io_unit_to_cluster_number(blob, io_unit);
+	if (cluster < blob->io_heatmap_len) {
+		__atomic_fetch_add(&blob->io_heatmap[cluster], 1, __ATOMIC_RELAXED);
+	}
+}
+
+static inline void
+blob_io_stat_count_alloc(struct spdk_blob *blob, bool copied)
+{
+	struct spdk_blob_io_stat *stat = blob->io_stat;
+
+	if (spdk_likely(stat == NULL)) {
+		return;
+	}
+
+	__atomic_fetch_add(&stat->num_clusters_allocated, 1, __ATOMIC_RELAXED);
+	if (copied) {
+		__atomic_fetch_add(&stat->num_cow_copies, 1, __ATOMIC_RELAXED);
+	}
+}
+
+/* END I/O statistics */
+
 struct spdk_blob_copy_cluster_ctx {
 	struct spdk_blob *blob;
 	uint8_t *buf;
 	uint64_t page;
+	uint32_t cluster_num;
 	uint64_t new_cluster;
 	uint32_t new_extent_page;
 	spdk_bs_sequence_t *seq;
 };
 
+static bool
+bs_user_op_is_for_cluster(spdk_bs_user_op_t *op, struct spdk_blob *blob, uint32_t cluster_num)
+{
+	struct spdk_bs_request_set *set = (struct spdk_bs_request_set *)op;
+	struct spdk_bs_user_op_args *args = &set->u.user_op;
+
+	return args->blob == blob &&
+	       bs_io_unit_to_cluster_number(blob, args->offset) == cluster_num;
+}
+
 static void
 blob_allocate_and_copy_cluster_cpl(void *cb_arg, int bserrno)
 {
 	struct spdk_blob_copy_cluster_ctx *ctx = cb_arg;
 	struct spdk_bs_request_set *set = (struct spdk_bs_request_set *)ctx->seq;
 	TAILQ_HEAD(, spdk_bs_request_set) requests;
-	spdk_bs_user_op_t *op;
+	spdk_bs_user_op_t *op, *tmp;
 
+	/* Only the operations waiting for this cluster are resumed. Allocations
+	 * of other clusters on the same channel may still be in progress. */
 	TAILQ_INIT(&requests);
-	TAILQ_SWAP(&set->channel->need_cluster_alloc, &requests, spdk_bs_request_set, link);
+	TAILQ_FOREACH_SAFE(op, &set->channel->need_cluster_alloc, link, tmp) {
+		if (bs_user_op_is_for_cluster(op, ctx->blob, ctx->cluster_num)) {
+			TAILQ_REMOVE(&set->channel->need_cluster_alloc, op, link);
+			TAILQ_INSERT_TAIL(&requests, op, link);
+		}
+	}
 
 	while (!TAILQ_EMPTY(&requests)) {
 		op = TAILQ_FIRST(&requests);
@@ -2279,6 +3184,8 @@ blob_insert_cluster_cpl(void *cb_arg, int bserrno)
 		if (ctx->new_extent_page != 0) {
 			bs_release_md_page(ctx->blob->bs, ctx->new_extent_page);
 		}
+	} else {
+		blob_io_stat_count_alloc(ctx->blob, ctx->buf != NULL);
 	}
 
 	bs_sequence_finish(ctx->seq, bserrno);
@@ -2330,25 +3237,30 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	struct spdk_blob_copy_cluster_ctx *ctx;
 	uint32_t cluster_start_page;
 	uint32_t cluster_number;
+	spdk_bs_user_op_t *pending;
+	bool copy;
 	int rc;
 
 	ch = spdk_io_channel_get_ctx(_ch);
+	copy = blob->parent_id != SPDK_BLOBID_INVALID || spdk_blob_is_esnap_clone(blob);
 
-	if (!TAILQ_EMPTY(&ch->need_cluster_alloc)) {
-		/* There are already operations pending. Queue this user op
-		 * and return because it will be re-executed when the outstanding
-		 * cluster allocation completes. */
-		TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
-		return;
+	/* Calculate which index in the metadata cluster array the corresponding
+	 * cluster is supposed to be at. */
+	cluster_number = bs_io_unit_to_cluster_number(blob, io_unit);
+
+	TAILQ_FOREACH(pending, &ch->need_cluster_alloc, link) {
+		if (bs_user_op_is_for_cluster(pending, blob, cluster_number)) {
+			/* This cluster is already being allocated. Queue this user op
+			 * and return because it will be re-executed when the outstanding
+			 * cluster allocation completes. */
+			TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
+			return;
+		}
 	}
 
 	/* Round the io_unit offset down to the first page in the cluster */
 	cluster_start_page = bs_io_unit_to_cluster_start(blob, io_unit);
 
-	/* Calculate which index in the metadata cluster array the corresponding
-	 * cluster is supposed to be at. */
-	cluster_number = bs_io_unit_to_cluster_number(blob, io_unit);
-
 	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
 		bs_user_op_abort(op);
@@ -2359,8 +3271,9 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 
 	ctx->blob = blob;
 	ctx->page = cluster_start_page;
+	ctx->cluster_num = cluster_number;
 
-	if (blob->parent_id != SPDK_BLOBID_INVALID) {
+	if (copy) {
 		ctx->buf = spdk_malloc(blob->bs->cluster_sz, blob->back_bs_dev->blocklen,
 				       NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
 		if (!ctx->buf) {
@@ -2372,10 +3285,8 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 		}
 	}
 
-	pthread_mutex_lock(&blob->bs->used_clusters_mutex);
-	rc = bs_allocate_cluster(blob, cluster_number, &ctx->new_cluster, &ctx->new_extent_page,
-				 false);
-	pthread_mutex_unlock(&blob->bs->used_clusters_mutex);
+	rc = bs_channel_allocate_cluster(ch, blob, cluster_number, &ctx->new_cluster,
+					 &ctx->new_extent_page);
 	if (rc != 0) {
 		spdk_free(ctx->buf);
 		free(ctx);
@@ -2391,6 +3302,9 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	if (!ctx->seq) {
 		pthread_mutex_lock(&blob->bs->used_clusters_mutex);
 		bs_release_cluster(blob->bs, ctx->new_cluster);
+		if (ctx->new_extent_page != 0) {
+			bs_release_md_page(blob->bs, ctx->new_extent_page);
+		}
 		pthread_mutex_unlock(&blob->bs->used_clusters_mutex);
 		spdk_free(ctx->buf);
 		free(ctx);
@@ -2401,7 +3315,7 @@ bs_allocate_and_copy_cluster(struct spdk_blob *blob,
 	/* Queue the user op to block other incoming operations */
 	TAILQ_INSERT_TAIL(&ch->need_cluster_alloc, op, link);
 
-	if (blob->parent_id != SPDK_BLOBID_INVALID) {
+	if (copy) {
 		/* Read cluster from backing device */
 		bs_sequence_read_bs_dev(ctx->seq, blob->back_bs_dev, ctx->buf,
 					bs_dev_page_to_lba(blob->back_bs_dev, cluster_start_page),
@@ -2533,21 +3447,106 @@ blob_request_submit_op_split(struct spdk_io_channel *ch, struct spdk_blob *blob,
 	blob_request_submit_op_split_next(ctx, 0);
 }
 
+/* START copy-on-read */
+
+struct blob_cor_populate_ctx {
+	struct spdk_blob	*blob;
+	uint64_t		cluster;
+};
+
 static void
-blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blob,
-			      void *payload, uint64_t offset, uint64_t length,
-			      spdk_blob_op_complete cb_fn, void *cb_arg, enum spdk_blob_op_type op_type)
+blob_cor_populate_close_cpl(void *cb_arg, int bserrno)
 {
-	struct spdk_bs_cpl cpl;
-	uint64_t lba;
-	uint32_t lba_count;
-	bool is_allocated;
+	free(cb_arg);
+}
 
-	assert(blob != NULL);
+static void
+blob_cor_populate_cpl(void *cb_arg, int bserrno)
+{
+	struct blob_cor_populate_ctx *ctx = cb_arg;
+	struct spdk_blob *blob = ctx->blob;
 
-	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
-	cpl.u.blob_basic.cb_fn = cb_fn;
-	cpl.u.blob_basic.cb_arg = cb_arg;
+	if (bserrno != 0) {
+		SPDK_DEBUGLOG(blob, "Failed to copy cluster %lu of blob %lu on read: %d\n",
+			      ctx->cluster, blob->id, bserrno);
+		if (ctx->cluster < blob->cor_read_counts_len) {
+			/* Try again once the cluster is read often enough */
+			blob->cor_read_counts[ctx->cluster] = 0;
+		}
+	}
+
+	spdk_blob_close(blob, blob_cor_populate_close_cpl, ctx);
+}
+
+static void
+blob_cor_populate(void *arg)
+{
+	struct blob_cor_populate_ctx *ctx = arg;
+	struct spdk_blob *blob = ctx->blob;
+
+	/*
+	 * The read that got here was submitted before the blob could be closed, so
+	 *  the blob is still open. Everything else may have changed since.
+	 */
+	if (blob->cor_threshold == 0 || blob->data_ro ||
+	    ctx->cluster >= blob->active.num_clusters || blob->active.clusters[ctx->cluster] != 0 ||
+	    (blob->parent_id == SPDK_BLOBID_INVALID && !spdk_blob_is_esnap_clone(blob))) {
+		free(ctx);
+		return;
+	}
+
+	/* Hold the blob open until the cluster is copied */
+	blob->open_ref++;
+
+	/* A zero length write allocates the cluster and copies it from the parent */
+	spdk_blob_io_write(blob, blob->bs->md_channel, NULL, bs_cluster_to_lba(blob->bs, ctx->cluster), 0,
+			   blob_cor_populate_cpl, ctx);
+}
+
+static inline void
+blob_cor_count_read(struct spdk_blob *blob, uint64_t io_unit)
+{
+	struct blob_cor_populate_ctx *ctx;
+	uint64_t cluster;
+
+	if (spdk_likely(blob->cor_read_counts == NULL)) {
+		return;
+	}
+
+	cluster = bs_io_unit_to_cluster_number(blob, io_unit);
+	if (cluster >= blob->cor_read_counts_len ||
+	    __atomic_add_fetch(&blob->cor_read_counts[cluster], 1, __ATOMIC_RELAXED) != blob->cor_threshold) {
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		/* The counter wraps around and triggers the copy again later */
+		return;
+	}
+
+	ctx->blob = blob;
+	ctx->cluster = cluster;
+	spdk_thread_send_msg(blob->bs->md_thread, blob_cor_populate, ctx);
+}
+
+/* END copy-on-read */
+
+static void
+blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blob,
+			      void *payload, uint64_t offset, uint64_t length,
+			      spdk_blob_op_complete cb_fn, void *cb_arg, enum spdk_blob_op_type op_type)
+{
+	struct spdk_bs_cpl cpl;
+	uint64_t lba;
+	uint32_t lba_count;
+	bool is_allocated;
+
+	assert(blob != NULL);
+
+	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
+	cpl.u.blob_basic.cb_fn = cb_fn;
+	cpl.u.blob_basic.cb_arg = cb_arg;
 
 	is_allocated = blob_calculate_lba_and_lba_count(blob, offset, length, &lba, &lba_count);
 
@@ -2577,12 +3576,15 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 			return;
 		}
 
+		blob_io_stat_count(blob, op_type, offset, length, is_allocated);
+
 		if (is_allocated) {
 			/* Read from the blob */
 			bs_batch_read_dev(batch, payload, lba, lba_count);
 		} else {
 			/* Read from the backing block device */
 			bs_batch_read_bs_dev(batch, blob->back_bs_dev, payload, lba, lba_count);
+			blob_cor_count_read(blob, offset);
 		}
 
 		bs_batch_close(batch);
@@ -2605,6 +3607,9 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 				return;
 			}
 
+			/* Writes to unallocated clusters are counted once they are executed again */
+			blob_io_stat_count(blob, op_type, offset, length, is_allocated);
+
 			if (op_type == SPDK_BLOB_WRITE) {
 				bs_batch_write_dev(batch, payload, lba, lba_count);
 			} else {
@@ -2635,6 +3640,8 @@ blob_request_submit_op_single(struct spdk_io_channel *_ch, struct spdk_blob *blo
 			return;
 		}
 
+		blob_io_stat_count(blob, op_type, offset, length, is_allocated);
+
 		if (is_allocated) {
 			bs_batch_unmap_dev(batch, lba, lba_count);
 		}
@@ -2842,11 +3849,14 @@ blob_request_submit_rw_iov(struct spdk_blob *blob, struct spdk_io_channel *_chan
 				return;
 			}
 
+			blob_io_stat_count(blob, SPDK_BLOB_READV, offset, length, is_allocated);
+
 			if (is_allocated) {
 				bs_sequence_readv_dev(seq, iov, iovcnt, lba, lba_count, rw_iov_done, NULL);
 			} else {
 				bs_sequence_readv_bs_dev(seq, blob->back_bs_dev, iov, iovcnt, lba, lba_count,
 							 rw_iov_done, NULL);
+				blob_cor_count_read(blob, offset);
 			}
 		} else {
 			if (is_allocated) {
@@ -2858,6 +3868,7 @@ blob_request_submit_rw_iov(struct spdk_blob *blob, struct spdk_io_channel *_chan
 					return;
 				}
 
+				blob_io_stat_count(blob, SPDK_BLOB_WRITEV, offset, length, is_allocated);
 				bs_sequence_writev_dev(seq, iov, iovcnt, lba, lba_count, rw_iov_done, NULL);
 			} else {
 				/* Queue this operation and allocate the cluster */
@@ -2978,6 +3989,11 @@ bs_channel_create(void *io_device, void *ctx_buf)
 
 	TAILQ_INIT(&channel->need_cluster_alloc);
 	TAILQ_INIT(&channel->queued_io);
+	TAILQ_INIT(&channel->esnap_channels);
+
+	pthread_mutex_lock(&bs->used_clusters_mutex);
+	TAILQ_INSERT_TAIL(&bs->channels, channel, link);
+	pthread_mutex_unlock(&bs->used_clusters_mutex);
 
 	return 0;
 }
@@ -2988,6 +4004,8 @@ bs_channel_destroy(void *io_device, void *ctx_buf)
 	struct spdk_bs_channel *channel = ctx_buf;
 	spdk_bs_user_op_t *op;
 
+	bs_channel_destroy_esnap_channels(channel);
+
 	while (!TAILQ_EMPTY(&channel->need_cluster_alloc)) {
 		op = TAILQ_FIRST(&channel->need_cluster_alloc);
 		TAILQ_REMOVE(&channel->need_cluster_alloc, op, link);
@@ -3000,6 +4018,11 @@ bs_channel_destroy(void *io_device, void *ctx_buf)
 		bs_user_op_abort(op);
 	}
 
+	pthread_mutex_lock(&channel->bs->used_clusters_mutex);
+	bs_channel_release_reserved_clusters(channel);
+	TAILQ_REMOVE(&channel->bs->channels, channel, link);
+	pthread_mutex_unlock(&channel->bs->used_clusters_mutex);
+
 	free(channel->req_mem);
 	channel->dev->destroy_channel(channel->dev, channel->dev_channel);
 }
@@ -3139,6 +4162,9 @@ spdk_bs_opts_init(struct spdk_bs_opts *opts)
 	memset(&opts->bstype, 0, sizeof(opts->bstype));
 	opts->iter_cb_fn = NULL;
 	opts->iter_cb_arg = NULL;
+	opts->esnap_bs_dev_create = NULL;
+	opts->esnap_ctx = NULL;
+	opts->max_size = 0;
 }
 
 static int
@@ -3157,21 +4183,48 @@ bs_opts_verify(struct spdk_bs_opts *opts)
 
 /* spdk_bs_load_ctx is used for init, load, unload and dump code paths. */
 
+struct spdk_bs_load_ctx;
+
+typedef int (*bs_load_replay_page_fn)(struct spdk_bs_load_ctx *ctx, uint32_t page_num,
+				      struct spdk_blob_md_page *page);
+typedef void (*bs_load_replay_done_fn)(struct spdk_bs_load_ctx *ctx, int bserrno);
+
+/* A read of BS_LOAD_REPLAY_CHUNK_PAGES metadata pages during replay */
+struct bs_load_replay_chunk {
+	struct spdk_bs_load_ctx		*ctx;
+	struct spdk_bs_dev_cb_args	cb_args;
+	struct spdk_blob_md_page	*pages;
+	uint32_t			first_page;
+	uint32_t			num_pages;
+	bool				busy;
+};
+
 struct spdk_bs_load_ctx {
 	struct spdk_blob_store		*bs;
 	struct spdk_bs_super_block	*super;
 
 	struct spdk_bs_md_mask		*mask;
-	bool				in_page_chain;
-	uint32_t			page_index;
 	uint32_t			cur_page;
 	struct spdk_blob_md_page	*page;
 
-	uint64_t			num_extent_pages;
-	uint32_t			*extent_page_num;
-	struct spdk_blob_md_page	*extent_pages;
 	struct spdk_bit_array		*used_clusters;
 
+	/* These fields are used when replaying the metadata after a dirty shutdown. */
+	uint32_t			*replay_next;	/* next page of each valid md page */
+	struct spdk_bit_array		*replay_valid;	/* md pages that can be part of a chain */
+	struct spdk_bit_array		*replay_root;	/* valid first pages of blobs */
+	struct spdk_bit_array		*replay_extent_pages;	/* extent pages used by blobs */
+	struct spdk_blob_md_page	*replay_buf;
+	uint32_t			replay_chunk_pages;
+	uint32_t			replay_next_page;
+	uint32_t			replay_outstanding;
+	bool				replay_submitting;
+	int				replay_rc;
+	struct spdk_bit_array		*replay_filter;
+	bs_load_replay_page_fn		replay_page_fn;
+	bs_load_replay_done_fn		replay_done_fn;
+	struct bs_load_replay_chunk	replay_chunks[BS_LOAD_REPLAY_CHUNKS];
+
 	spdk_bs_sequence_t			*seq;
 	spdk_blob_op_with_handle_complete	iter_cb_fn;
 	void					*iter_cb_arg;
@@ -3259,6 +4312,8 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs->max_channel_ops = opts->max_channel_ops;
 	bs->super_blob = SPDK_BLOBID_INVALID;
 	memcpy(&bs->bstype, &opts->bstype, sizeof(opts->bstype));
+	bs->esnap_bs_dev_create = opts->esnap_bs_dev_create;
+	bs->esnap_ctx = opts->esnap_ctx;
 
 	/* The metadata is assumed to be at least 1 page */
 	bs->used_md_pages = spdk_bit_array_create(1);
@@ -3266,6 +4321,8 @@ bs_alloc(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts, struct spdk_blob_st
 	bs->open_blobids = spdk_bit_array_create(0);
 
 	pthread_mutex_init(&bs->used_clusters_mutex, NULL);
+	TAILQ_INIT(&bs->channels);
+	TAILQ_INIT(&bs->md_writes);
 
 	spdk_io_device_register(bs, bs_channel_create, bs_channel_destroy,
 				sizeof(struct spdk_bs_channel), "blobstore");
@@ -3308,6 +4365,9 @@ bs_write_super(spdk_bs_sequence_t *seq, struct spdk_blob_store *bs,
 	/* Update the values in the super block */
 	super->super_blob = bs->super_blob;
 	memcpy(&super->bstype, &bs->bstype, sizeof(bs->bstype));
+	if (bs->grown_size > super->size) {
+		super->size = bs->grown_size;
+	}
 	super->crc = blob_md_page_calc_crc(super);
 	bs_sequence_write_dev(seq, super, bs_page_to_lba(bs, 0),
 			      bs_byte_to_lba(bs, sizeof(*super)),
@@ -3623,6 +4683,14 @@ bs_load_used_blobids_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 		return;
 	}
 
+	/* Blobs opened after a clean load must be found by blob_lookup() as well */
+	rc = spdk_bit_array_resize(&ctx->bs->open_blobids, ctx->mask->length);
+	if (rc < 0) {
+		spdk_free(ctx->mask);
+		bs_load_ctx_fail(ctx, rc);
+		return;
+	}
+
 	spdk_bit_array_load_mask(ctx->bs->used_blobids, ctx->mask->mask);
 	bs_load_complete(ctx);
 }
@@ -3826,10 +4894,8 @@ bs_load_replay_md_parse_page(struct spdk_bs_load_ctx *ctx, struct spdk_blob_md_p
 			/* Skip this item */
 		} else if (desc->type == SPDK_MD_DESCRIPTOR_TYPE_EXTENT_TABLE) {
 			struct spdk_blob_md_descriptor_extent_table *desc_extent_table;
-			uint32_t num_extent_pages = ctx->num_extent_pages;
-			uint32_t i;
+			uint32_t i, page_idx;
 			size_t extent_pages_length;
-			void *tmp;
 
 			desc_extent_table = (struct spdk_blob_md_descriptor_extent_table *)desc;
 			extent_pages_length = desc_extent_table->length - sizeof(desc_extent_table->num_clusters);
@@ -3839,30 +4905,18 @@ bs_load_replay_md_parse_page(struct spdk_bs_load_ctx *ctx, struct spdk_blob_md_p
 				return -EINVAL;
 			}
 
+			/* Extent table entries contain md page numbers for extent pages.
+			 * Zeroes represent unallocated extent pages, those are run-length-encoded.
+			 * The extent pages are read once all of the md page chains are parsed.
+			 */
 			for (i = 0; i < extent_pages_length / sizeof(desc_extent_table->extent_page[0]); i++) {
-				if (desc_extent_table->extent_page[i].page_idx != 0) {
-					if (desc_extent_table->extent_page[i].num_pages != 1) {
+				page_idx = desc_extent_table->extent_page[i].page_idx;
+				if (page_idx != 0) {
+					if (desc_extent_table->extent_page[i].num_pages != 1 ||
+					    page_idx >= ctx->super->md_len) {
 						return -EINVAL;
 					}
-					num_extent_pages += 1;
-				}
-			}
-
-			if (num_extent_pages > 0) {
-				tmp = realloc(ctx->extent_page_num, num_extent_pages * sizeof(uint32_t));
-				if (tmp == NULL) {
-					return -ENOMEM;
-				}
-				ctx->extent_page_num = tmp;
-
-				/* Extent table entries contain md page numbers for extent pages.
-				 * Zeroes represent unallocated extent pages, those are run-length-encoded.
-				 */
-				for (i = 0; i < extent_pages_length / sizeof(desc_extent_table->extent_page[0]); i++) {
-					if (desc_extent_table->extent_page[i].page_idx != 0) {
-						ctx->extent_page_num[ctx->num_extent_pages] = desc_extent_table->extent_page[i].page_idx;
-						ctx->num_extent_pages += 1;
-					}
+					spdk_bit_array_set(ctx->replay_extent_pages, page_idx);
 				}
 			}
 		} else {
@@ -3917,10 +4971,10 @@ static bool bs_load_cur_extent_page_valid(struct spdk_blob_md_page *page)
 	return true;
 }
 
-static bool bs_load_cur_md_page_valid(struct spdk_bs_load_ctx *ctx)
+static bool
+bs_load_md_page_valid(uint32_t page_num, struct spdk_blob_md_page *page)
 {
 	uint32_t crc;
-	struct spdk_blob_md_page *page = ctx->page;
 
 	crc = blob_md_page_calc_crc(page);
 	if (crc != page->crc) {
@@ -3929,7 +4983,7 @@ static bool bs_load_cur_md_page_valid(struct spdk_bs_load_ctx *ctx)
 
 	/* First page of a sequence should match the blobid. */
 	if (page->sequence_num == 0 &&
-	    bs_page_to_blobid(ctx->cur_page) != page->id) {
+	    bs_page_to_blobid(page_num) != page->id) {
 		return false;
 	}
 	assert(bs_load_cur_extent_page_valid(page) == false);
@@ -3937,9 +4991,6 @@ static bool bs_load_cur_md_page_valid(struct spdk_bs_load_ctx *ctx)
 	return true;
 }
 
-static void
-bs_load_replay_cur_md_page(struct spdk_bs_load_ctx *ctx);
-
 static void
 bs_load_write_used_clusters_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
@@ -3992,162 +5043,290 @@ bs_load_write_used_md(struct spdk_bs_load_ctx *ctx)
 }
 
 static void
-bs_load_replay_md_chain_cpl(struct spdk_bs_load_ctx *ctx)
+bs_load_replay_free(struct spdk_bs_load_ctx *ctx)
 {
-	uint64_t num_md_clusters;
-	uint64_t i;
+	free(ctx->replay_next);
+	ctx->replay_next = NULL;
+	spdk_bit_array_free(&ctx->replay_valid);
+	spdk_bit_array_free(&ctx->replay_root);
+	spdk_bit_array_free(&ctx->replay_extent_pages);
+	spdk_free(ctx->replay_buf);
+	ctx->replay_buf = NULL;
+}
+
+static void
+bs_load_replay_fail(struct spdk_bs_load_ctx *ctx, int bserrno)
+{
+	bs_load_replay_free(ctx);
+	bs_load_ctx_fail(ctx, bserrno);
+}
 
-	ctx->in_page_chain = false;
+static void bs_load_replay_scan_submit(struct spdk_bs_load_ctx *ctx);
 
-	do {
-		ctx->page_index++;
-	} while (spdk_bit_array_get(ctx->bs->used_md_pages, ctx->page_index) == true);
+static void
+bs_load_replay_chunk_cpl(struct spdk_io_channel *channel, void *cb_arg, int bserrno)
+{
+	struct bs_load_replay_chunk *chunk = cb_arg;
+	struct spdk_bs_load_ctx *ctx = chunk->ctx;
+	uint32_t i, page_num;
+	int rc;
 
-	if (ctx->page_index < ctx->super->md_len) {
-		ctx->cur_page = ctx->page_index;
-		bs_load_replay_cur_md_page(ctx);
-	} else {
-		/* Claim all of the clusters used by the metadata */
-		num_md_clusters = spdk_divide_round_up(ctx->super->md_len, ctx->bs->pages_per_cluster);
-		for (i = 0; i < num_md_clusters; i++) {
-			spdk_bit_array_set(ctx->used_clusters, i);
+	chunk->busy = false;
+	ctx->replay_outstanding--;
+
+	if (bserrno != 0) {
+		if (ctx->replay_rc == 0) {
+			ctx->replay_rc = bserrno;
+		}
+	} else if (ctx->replay_rc == 0) {
+		for (i = 0; i < chunk->num_pages; i++) {
+			page_num = chunk->first_page + i;
+			if (ctx->replay_filter != NULL &&
+			    spdk_bit_array_get(ctx->replay_filter, page_num) == false) {
+				continue;
+			}
+			rc = ctx->replay_page_fn(ctx, page_num, &chunk->pages[i]);
+			if (rc != 0) {
+				ctx->replay_rc = rc;
+				break;
+			}
 		}
-		ctx->bs->num_free_clusters -= num_md_clusters;
-		spdk_free(ctx->page);
-		bs_load_write_used_md(ctx);
 	}
+
+	bs_load_replay_scan_submit(ctx);
 }
 
 static void
-bs_load_replay_extent_page_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_load_replay_scan_submit(struct spdk_bs_load_ctx *ctx)
 {
-	struct spdk_bs_load_ctx *ctx = cb_arg;
-	uint32_t page_num;
-	uint64_t i;
+	struct spdk_blob_store *bs = ctx->bs;
+	struct spdk_bs_channel *ch = spdk_io_channel_get_ctx(bs->md_channel);
+	struct bs_load_replay_chunk *chunk;
+	uint32_t md_len = ctx->super->md_len;
+	uint32_t first_page;
+	int i;
 
-	if (bserrno != 0) {
-		spdk_free(ctx->extent_pages);
-		bs_load_ctx_fail(ctx, bserrno);
+	/* A read that completes inline lands here again - the outer call keeps submitting. */
+	if (ctx->replay_submitting) {
 		return;
 	}
+	ctx->replay_submitting = true;
 
-	for (i = 0; i < ctx->num_extent_pages; i++) {
-		/* Extent pages are only read when present within in chain md.
-		 * Integrity of md is not right if that page was not a valid extent page. */
-		if (bs_load_cur_extent_page_valid(&ctx->extent_pages[i]) != true) {
-			spdk_free(ctx->extent_pages);
-			bs_load_ctx_fail(ctx, -EILSEQ);
-			return;
+	while (ctx->replay_rc == 0 && ctx->replay_next_page < md_len) {
+		chunk = NULL;
+		for (i = 0; i < BS_LOAD_REPLAY_CHUNKS; i++) {
+			if (!ctx->replay_chunks[i].busy) {
+				chunk = &ctx->replay_chunks[i];
+				break;
+			}
+		}
+		if (chunk == NULL) {
+			break;
 		}
 
-		page_num = ctx->extent_page_num[i];
-		spdk_bit_array_set(ctx->bs->used_md_pages, page_num);
-		if (bs_load_replay_md_parse_page(ctx, &ctx->extent_pages[i])) {
-			spdk_free(ctx->extent_pages);
-			bs_load_ctx_fail(ctx, -EILSEQ);
-			return;
+		first_page = ctx->replay_next_page;
+		if (ctx->replay_filter != NULL) {
+			/* Skip straight to the next page that has to be looked at. */
+			first_page = spdk_bit_array_find_first_set(ctx->replay_filter, first_page);
+			if (first_page == UINT32_MAX || first_page >= md_len) {
+				ctx->replay_next_page = md_len;
+				break;
+			}
 		}
+
+		chunk->first_page = first_page;
+		chunk->num_pages = spdk_min(ctx->replay_chunk_pages, md_len - first_page);
+		chunk->busy = true;
+		ctx->replay_next_page = first_page + chunk->num_pages;
+		ctx->replay_outstanding++;
+
+		bs->dev->read(bs->dev, ch->dev_channel, chunk->pages, bs_md_page_to_lba(bs, first_page),
+			      bs_byte_to_lba(bs, chunk->num_pages * SPDK_BS_PAGE_SIZE), &chunk->cb_args);
 	}
 
-	spdk_free(ctx->extent_pages);
-	free(ctx->extent_page_num);
-	ctx->extent_page_num = NULL;
-	ctx->num_extent_pages = 0;
+	ctx->replay_submitting = false;
 
-	bs_load_replay_md_chain_cpl(ctx);
+	if (ctx->replay_outstanding == 0) {
+		ctx->replay_done_fn(ctx, ctx->replay_rc);
+	}
 }
 
+/*
+ * Read the whole metadata region (or only the pages set in filter) in large
+ * sequential chunks and call page_fn for each page. done_fn is called once
+ * all of the reads completed, with the first error encountered.
+ */
 static void
-bs_load_replay_extent_pages(struct spdk_bs_load_ctx *ctx)
+bs_load_replay_scan(struct spdk_bs_load_ctx *ctx, struct spdk_bit_array *filter,
+		    bs_load_replay_page_fn page_fn, bs_load_replay_done_fn done_fn)
 {
-	spdk_bs_batch_t *batch;
-	uint32_t page;
-	uint64_t lba;
+	ctx->replay_filter = filter;
+	ctx->replay_page_fn = page_fn;
+	ctx->replay_done_fn = done_fn;
+	ctx->replay_next_page = 0;
+	ctx->replay_rc = 0;
+	assert(ctx->replay_outstanding == 0);
+
+	bs_load_replay_scan_submit(ctx);
+}
+
+static void
+bs_load_replay_md_done(struct spdk_bs_load_ctx *ctx, int bserrno)
+{
+	uint64_t num_md_clusters;
 	uint64_t i;
 
-	ctx->extent_pages = spdk_zmalloc(SPDK_BS_PAGE_SIZE * ctx->num_extent_pages, 0,
-					 NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
-	if (!ctx->extent_pages) {
-		bs_load_ctx_fail(ctx, -ENOMEM);
+	bs_load_replay_free(ctx);
+
+	if (bserrno != 0) {
+		bs_load_ctx_fail(ctx, bserrno);
 		return;
 	}
 
-	batch = bs_sequence_to_batch(ctx->seq, bs_load_replay_extent_page_cpl, ctx);
+	/* Claim all of the clusters used by the metadata, including the super block
+	 * and the masks in front of the metadata pages */
+	num_md_clusters = spdk_divide_round_up(ctx->super->md_start + ctx->super->md_len,
+					       ctx->bs->pages_per_cluster);
+	for (i = 0; i < num_md_clusters; i++) {
+		spdk_bit_array_set(ctx->used_clusters, i);
+	}
+	ctx->bs->num_free_clusters -= num_md_clusters;
+	bs_load_write_used_md(ctx);
+}
+
+static int
+bs_load_replay_extent_page(struct spdk_bs_load_ctx *ctx, uint32_t page_num,
+			   struct spdk_blob_md_page *page)
+{
+	/* Extent pages are only read when present within in chain md.
+	 * Integrity of md is not right if that page was not a valid extent page. */
+	if (bs_load_cur_extent_page_valid(page) != true) {
+		return -EILSEQ;
+	}
 
-	for (i = 0; i < ctx->num_extent_pages; i++) {
-		page = ctx->extent_page_num[i];
-		assert(page < ctx->super->md_len);
-		lba = bs_md_page_to_lba(ctx->bs, page);
-		bs_batch_read_dev(batch, &ctx->extent_pages[i], lba,
-				  bs_byte_to_lba(ctx->bs, SPDK_BS_PAGE_SIZE));
+	spdk_bit_array_set(ctx->bs->used_md_pages, page_num);
+	if (bs_load_replay_md_parse_page(ctx, page)) {
+		return -EILSEQ;
 	}
 
-	bs_batch_close(batch);
+	return 0;
+}
+
+static int
+bs_load_replay_parse_page(struct spdk_bs_load_ctx *ctx, uint32_t page_num,
+			  struct spdk_blob_md_page *page)
+{
+	if (bs_load_replay_md_parse_page(ctx, page)) {
+		return -EILSEQ;
+	}
+
+	return 0;
 }
 
 static void
-bs_load_replay_md_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
+bs_load_replay_parse_done(struct spdk_bs_load_ctx *ctx, int bserrno)
 {
-	struct spdk_bs_load_ctx *ctx = cb_arg;
-	uint32_t page_num;
-	struct spdk_blob_md_page *page;
+	if (bserrno != 0) {
+		bs_load_replay_fail(ctx, bserrno);
+		return;
+	}
+
+	/* Extent pages referenced by the extent tables are read last. */
+	bs_load_replay_scan(ctx, ctx->replay_extent_pages, bs_load_replay_extent_page,
+			    bs_load_replay_md_done);
+}
+
+static void
+bs_load_replay_claim_chains(struct spdk_bs_load_ctx *ctx, int bserrno)
+{
+	struct spdk_blob_store *bs = ctx->bs;
+	uint32_t md_len = ctx->super->md_len;
+	uint32_t page_index, page_num;
 
 	if (bserrno != 0) {
-		bs_load_ctx_fail(ctx, bserrno);
+		bs_load_replay_fail(ctx, bserrno);
 		return;
 	}
 
-	page_num = ctx->cur_page;
-	page = ctx->page;
-	if (bs_load_cur_md_page_valid(ctx) == true) {
-		if (page->sequence_num == 0 || ctx->in_page_chain == true) {
-			bs_claim_md_page(ctx->bs, page_num);
-			if (page->sequence_num == 0) {
-				spdk_bit_array_set(ctx->bs->used_blobids, page_num);
-			}
-			if (bs_load_replay_md_parse_page(ctx, page)) {
-				bs_load_ctx_fail(ctx, -EILSEQ);
-				return;
-			}
-			if (page->next != SPDK_INVALID_MD_PAGE) {
-				ctx->in_page_chain = true;
-				ctx->cur_page = page->next;
-				bs_load_replay_cur_md_page(ctx);
-				return;
-			}
-			if (ctx->num_extent_pages != 0) {
-				bs_load_replay_extent_pages(ctx);
-				return;
-			}
+	/* Walk the chain of every valid first page, using the next pointers recorded
+	 * while scanning. Pages of a chain that are not valid end the chain. */
+	for (page_index = spdk_bit_array_find_first_set(ctx->replay_root, 0);
+	     page_index != UINT32_MAX;
+	     page_index = spdk_bit_array_find_first_set(ctx->replay_root, page_index + 1)) {
+		if (spdk_bit_array_get(bs->used_md_pages, page_index) == true) {
+			continue;
 		}
+
+		page_num = page_index;
+		do {
+			bs_claim_md_page(bs, page_num);
+			if (spdk_bit_array_get(ctx->replay_root, page_num) == true) {
+				spdk_bit_array_set(bs->used_blobids, page_num);
+			}
+			page_num = ctx->replay_next[page_num];
+		} while (page_num < md_len &&
+			 spdk_bit_array_get(ctx->replay_valid, page_num) == true &&
+			 spdk_bit_array_get(bs->used_md_pages, page_num) == false);
 	}
-	bs_load_replay_md_chain_cpl(ctx);
+
+	bs_load_replay_scan(ctx, bs->used_md_pages, bs_load_replay_parse_page,
+			    bs_load_replay_parse_done);
 }
 
-static void
-bs_load_replay_cur_md_page(struct spdk_bs_load_ctx *ctx)
+static int
+bs_load_replay_record_page(struct spdk_bs_load_ctx *ctx, uint32_t page_num,
+			   struct spdk_blob_md_page *page)
 {
-	uint64_t lba;
+	if (bs_load_md_page_valid(page_num, page) == true) {
+		spdk_bit_array_set(ctx->replay_valid, page_num);
+		if (page->sequence_num == 0) {
+			spdk_bit_array_set(ctx->replay_root, page_num);
+		}
+		ctx->replay_next[page_num] = page->next;
+	}
 
-	assert(ctx->cur_page < ctx->super->md_len);
-	lba = bs_md_page_to_lba(ctx->bs, ctx->cur_page);
-	bs_sequence_read_dev(ctx->seq, ctx->page, lba,
-			     bs_byte_to_lba(ctx->bs, SPDK_BS_PAGE_SIZE),
-			     bs_load_replay_md_cpl, ctx);
+	return 0;
 }
 
+/*
+ * Replaying the metadata is done in three sequential scans of the metadata region:
+ *  1. Record valid pages and their next pointers. The page chains of all blobs
+ *     are then claimed in memory.
+ *  2. Parse the claimed pages, marking the used clusters and extent pages.
+ *  3. Parse the extent pages.
+ * Each scan keeps several large reads in flight instead of reading a page at a time.
+ */
 static void
 bs_load_replay_md(struct spdk_bs_load_ctx *ctx)
 {
-	ctx->page_index = 0;
-	ctx->cur_page = 0;
-	ctx->page = spdk_zmalloc(SPDK_BS_PAGE_SIZE, 0,
-				 NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
-	if (!ctx->page) {
-		bs_load_ctx_fail(ctx, -ENOMEM);
+	uint32_t md_len = ctx->super->md_len;
+	int i;
+
+	ctx->replay_next = calloc(spdk_max(md_len, 1), sizeof(*ctx->replay_next));
+	ctx->replay_valid = spdk_bit_array_create(md_len);
+	ctx->replay_root = spdk_bit_array_create(md_len);
+	ctx->replay_extent_pages = spdk_bit_array_create(md_len);
+	ctx->replay_chunk_pages = spdk_max(spdk_min(BS_LOAD_REPLAY_CHUNK_PAGES, md_len), 1);
+	ctx->replay_buf = spdk_malloc(BS_LOAD_REPLAY_CHUNKS * ctx->replay_chunk_pages * SPDK_BS_PAGE_SIZE,
+				      SPDK_BS_PAGE_SIZE, NULL, SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (!ctx->replay_next || !ctx->replay_valid || !ctx->replay_root ||
+	    !ctx->replay_extent_pages || !ctx->replay_buf) {
+		bs_load_replay_fail(ctx, -ENOMEM);
 		return;
 	}
-	bs_load_replay_cur_md_page(ctx);
+
+	for (i = 0; i < BS_LOAD_REPLAY_CHUNKS; i++) {
+		struct bs_load_replay_chunk *chunk = &ctx->replay_chunks[i];
+
+		chunk->ctx = ctx;
+		chunk->pages = &ctx->replay_buf[i * ctx->replay_chunk_pages];
+		chunk->cb_args.cb_fn = bs_load_replay_chunk_cpl;
+		chunk->cb_args.cb_arg = chunk;
+		chunk->cb_args.channel = ((struct spdk_bs_channel *)
+					  spdk_io_channel_get_ctx(ctx->bs->md_channel))->dev_channel;
+	}
+
+	bs_load_replay_scan(ctx, NULL, bs_load_replay_record_page, bs_load_replay_claim_chains);
 }
 
 static void
@@ -4715,7 +5894,8 @@ spdk_bs_init(struct spdk_bs_dev *dev, struct spdk_bs_opts *o,
 	 */
 	ctx->super->used_cluster_mask_start = num_md_pages;
 	ctx->super->used_cluster_mask_len = spdk_divide_round_up(sizeof(struct spdk_bs_md_mask) +
-					    spdk_divide_round_up(bs->total_clusters, 8),
+					    spdk_divide_round_up(spdk_max(bs->total_clusters,
+							    opts.max_size / bs->cluster_sz), 8),
 					    SPDK_BS_PAGE_SIZE);
 	num_md_pages += ctx->super->used_cluster_mask_len;
 
@@ -4983,6 +6163,12 @@ spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_a
 
 	ctx->bs = bs;
 
+	/* Channels may outlive the blobstore unload. Give their reserved clusters
+	 * back, so that they are not persisted as used in the cluster mask. */
+	pthread_mutex_lock(&bs->used_clusters_mutex);
+	bs_release_all_reserved_clusters(bs);
+	pthread_mutex_unlock(&bs->used_clusters_mutex);
+
 	ctx->super = spdk_zmalloc(sizeof(*ctx->super), 0x1000, NULL,
 				  SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
 	if (!ctx->super) {
@@ -5098,48 +6284,190 @@ spdk_bs_set_super(struct spdk_blob_store *bs, spdk_blob_id blobid,
 
 /* END spdk_bs_set_super */
 
-void
-spdk_bs_get_super(struct spdk_blob_store *bs,
-		  spdk_blob_op_with_id_complete cb_fn, void *cb_arg)
-{
-	if (bs->super_blob == SPDK_BLOBID_INVALID) {
-		cb_fn(cb_arg, SPDK_BLOBID_INVALID, -ENOENT);
-	} else {
-		cb_fn(cb_arg, bs->super_blob, 0);
-	}
-}
+/* START spdk_bs_grow */
 
-uint64_t
-spdk_bs_get_cluster_size(struct spdk_blob_store *bs)
-{
-	return bs->cluster_sz;
-}
+struct spdk_bs_grow_ctx {
+	struct spdk_blob_store		*bs;
+	struct spdk_bs_super_block	*super;
+	uint64_t			total_clusters;
+	uint64_t			prev_grown_size;
+	bool				prev_clean;
+};
 
-uint64_t
-spdk_bs_get_page_size(struct spdk_blob_store *bs)
+static void
+bs_grow_write_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
-	return SPDK_BS_PAGE_SIZE;
-}
+	struct spdk_bs_grow_ctx	*ctx = cb_arg;
+	struct spdk_blob_store	*bs = ctx->bs;
+	uint64_t		num_new_clusters;
+	int			rc;
 
-uint64_t
-spdk_bs_get_io_unit_size(struct spdk_blob_store *bs)
-{
-	return bs->io_unit_size;
-}
+	spdk_free(ctx->super);
 
-uint64_t
-spdk_bs_free_cluster_count(struct spdk_blob_store *bs)
-{
-	return bs->num_free_clusters;
+	if (bserrno != 0) {
+		SPDK_ERRLOG("Unable to write to super block of blobstore\n");
+		bs->grown_size = ctx->prev_grown_size;
+		bs->clean = ctx->prev_clean;
+		goto out;
+	}
+
+	/* The clusters are only handed out once the new size is on disk */
+	pthread_mutex_lock(&bs->used_clusters_mutex);
+	if (ctx->total_clusters > bs->total_clusters) {
+		rc = spdk_bit_pool_resize(&bs->used_clusters, ctx->total_clusters);
+		if (rc != 0) {
+			bserrno = rc;
+		} else {
+			num_new_clusters = ctx->total_clusters - bs->total_clusters;
+			bs->total_clusters = ctx->total_clusters;
+			bs->total_data_clusters += num_new_clusters;
+			bs->num_free_clusters += num_new_clusters;
+		}
+	}
+	pthread_mutex_unlock(&bs->used_clusters_mutex);
+
+out:
+	bs_sequence_finish(seq, bserrno);
+	free(ctx);
 }
 
-uint64_t
-spdk_bs_total_data_cluster_count(struct spdk_blob_store *bs)
+static void
+bs_grow_read_super_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 {
-	return bs->total_data_clusters;
-}
+	struct spdk_bs_grow_ctx	*ctx = cb_arg;
+	struct spdk_blob_store	*bs = ctx->bs;
+	uint64_t		mask_len;
 
-static int
+	if (bserrno != 0) {
+		SPDK_ERRLOG("Unable to read super block of blobstore\n");
+		goto fail;
+	}
+
+	mask_len = spdk_divide_round_up(sizeof(struct spdk_bs_md_mask) +
+					spdk_divide_round_up(ctx->total_clusters, 8),
+					SPDK_BS_PAGE_SIZE);
+	if (mask_len > ctx->super->used_cluster_mask_len) {
+		SPDK_ERRLOG("Blobstore can track at most %" PRIu64 " clusters, cannot grow to %" PRIu64 "\n",
+			    (ctx->super->used_cluster_mask_len * SPDK_BS_PAGE_SIZE -
+			     sizeof(struct spdk_bs_md_mask)) * 8, ctx->total_clusters);
+		bserrno = -ENOSPC;
+		goto fail;
+	}
+
+	/* A clean super block would let the next load trust the on-disk mask of the old size */
+	ctx->prev_clean = bs->clean;
+	ctx->prev_grown_size = bs->grown_size;
+	ctx->super->clean = 0;
+	bs->clean = 0;
+	bs->grown_size = spdk_max(bs->grown_size, ctx->total_clusters * bs->cluster_sz);
+	bs_write_super(seq, bs, ctx->super, bs_grow_write_super_cpl, ctx);
+	return;
+
+fail:
+	spdk_free(ctx->super);
+	bs_sequence_finish(seq, bserrno);
+	free(ctx);
+}
+
+void
+spdk_bs_grow(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_bs_cpl		cpl;
+	spdk_bs_sequence_t		*seq;
+	struct spdk_bs_grow_ctx		*ctx;
+	uint64_t			total_clusters;
+
+	/* Same rounding down as bs_alloc() */
+	total_clusters = bs->dev->blockcnt / (bs->cluster_sz / bs->dev->blocklen);
+	if (total_clusters <= bs->total_clusters) {
+		SPDK_DEBUGLOG(blob, "Blobstore device did not grow\n");
+		cb_fn(cb_arg, 0);
+		return;
+	}
+
+	SPDK_DEBUGLOG(blob, "Growing blobstore from %" PRIu64 " to %" PRIu64 " clusters\n",
+		      bs->total_clusters, total_clusters);
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->bs = bs;
+	ctx->total_clusters = total_clusters;
+
+	ctx->super = spdk_zmalloc(sizeof(*ctx->super), 0x1000, NULL,
+				  SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+	if (!ctx->super) {
+		free(ctx);
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	cpl.type = SPDK_BS_CPL_TYPE_BS_BASIC;
+	cpl.u.bs_basic.cb_fn = cb_fn;
+	cpl.u.bs_basic.cb_arg = cb_arg;
+
+	seq = bs_sequence_start(bs->md_channel, &cpl);
+	if (!seq) {
+		spdk_free(ctx->super);
+		free(ctx);
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	/* Read super block */
+	bs_sequence_read_dev(seq, ctx->super, bs_page_to_lba(bs, 0),
+			     bs_byte_to_lba(bs, sizeof(*ctx->super)),
+			     bs_grow_read_super_cpl, ctx);
+}
+
+/* END spdk_bs_grow */
+
+void
+spdk_bs_get_super(struct spdk_blob_store *bs,
+		  spdk_blob_op_with_id_complete cb_fn, void *cb_arg)
+{
+	if (bs->super_blob == SPDK_BLOBID_INVALID) {
+		cb_fn(cb_arg, SPDK_BLOBID_INVALID, -ENOENT);
+	} else {
+		cb_fn(cb_arg, bs->super_blob, 0);
+	}
+}
+
+uint64_t
+spdk_bs_get_cluster_size(struct spdk_blob_store *bs)
+{
+	return bs->cluster_sz;
+}
+
+uint64_t
+spdk_bs_get_page_size(struct spdk_blob_store *bs)
+{
+	return SPDK_BS_PAGE_SIZE;
+}
+
+uint64_t
+spdk_bs_get_io_unit_size(struct spdk_blob_store *bs)
+{
+	return bs->io_unit_size;
+}
+
+uint64_t
+spdk_bs_free_cluster_count(struct spdk_blob_store *bs)
+{
+	/* Clusters reserved by channels are free until a blob takes them */
+	return bs->num_free_clusters + __atomic_load_n(&bs->num_reserved_clusters, __ATOMIC_RELAXED);
+}
+
+uint64_t
+spdk_bs_total_data_cluster_count(struct spdk_blob_store *bs)
+{
+	return bs->total_data_clusters;
+}
+
+static int
 bs_register_md_thread(struct spdk_blob_store *bs)
 {
 	bs->md_channel = spdk_get_io_channel(bs);
@@ -5246,6 +6574,14 @@ bs_create_blob(struct spdk_blob_store *bs,
 
 	assert(spdk_get_thread() == bs->md_thread);
 
+	if (opts && opts->esnap_id != NULL) {
+		if (bs->esnap_bs_dev_create == NULL || opts->esnap_id_len == 0 ||
+		    opts->esnap_id_len > UINT16_MAX) {
+			cb_fn(cb_arg, 0, -EINVAL);
+			return;
+		}
+	}
+
 	page_idx = spdk_bit_array_find_first_clear(bs->used_md_pages, 0);
 	if (page_idx == UINT32_MAX) {
 		cb_fn(cb_arg, 0, -ENOMEM);
@@ -5299,7 +6635,20 @@ bs_create_blob(struct spdk_blob_store *bs,
 		return;
 	}
 
-	if (opts->thin_provision) {
+	if (opts->esnap_id != NULL) {
+		rc = blob_set_xattr(blob, BLOB_EXTERNAL_SNAPSHOT_ID, opts->esnap_id,
+				    opts->esnap_id_len, true);
+		if (rc < 0) {
+			blob_free(blob);
+			spdk_bit_array_clear(bs->used_blobids, page_idx);
+			bs_release_md_page(bs, page_idx);
+			cb_fn(cb_arg, 0, rc);
+			return;
+		}
+		/* Unallocated clusters of an esnap clone are read from the external snapshot */
+		blob->invalid_flags |= SPDK_BLOB_EXTERNAL_SNAPSHOT;
+		blob_set_thin_provision(blob);
+	} else if (opts->thin_provision) {
 		blob_set_thin_provision(blob);
 	}
 
@@ -5360,6 +6709,9 @@ struct spdk_clone_snapshot_ctx {
 	 * thin-provisioning. Otherwise only decouple parent and keep clone thin. */
 	bool allocate_all;
 
+	/* Pacing and progress of an inflate operation */
+	struct spdk_blob_inflate_job *job;
+
 	struct {
 		spdk_blob_id id;
 		struct spdk_blob *blob;
@@ -5680,6 +7032,13 @@ bs_snapshot_origblob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno
 		return;
 	}
 
+	if (spdk_blob_is_esnap_clone(_blob)) {
+		SPDK_DEBUGLOG(blob, "Cannot create snapshot of esnap clone with id %lu\n", _blob->id);
+		ctx->bserrno = -ENOTSUP;
+		spdk_blob_close(_blob, bs_clone_snapshot_cleanup_finish, ctx);
+		return;
+	}
+
 	if (_blob->locked_operation_in_progress) {
 		SPDK_DEBUGLOG(blob, "Cannot create snapshot - another operation in progress\n");
 		ctx->bserrno = -EBUSY;
@@ -5846,6 +7205,42 @@ void spdk_bs_create_clone(struct spdk_blob_store *bs, spdk_blob_id blobid,
 
 /* START spdk_bs_inflate_blob */
 
+/* Period of the poller refilling the copy budget of a throttled job */
+#define BLOB_INFLATE_JOB_POLL_US	1000
+
+struct spdk_blob_inflate_job {
+	struct spdk_clone_snapshot_ctx	*ctx;
+	spdk_blob_op_complete		cb_fn;
+	void				*cb_arg;
+
+	uint32_t			max_inflight;
+	uint64_t			max_bytes_per_sec;
+
+	uint64_t			clusters_total;
+	uint64_t			clusters_done;
+	uint32_t			inflight;
+	int				rc;
+
+	/* Clusters are counted and copying can start */
+	bool				started;
+	bool				paused;
+	bool				cancelled;
+	/* Every copy has completed, the blob metadata is being updated */
+	bool				finishing;
+	/* bs_inflate_blob_touch_next() is issuing copies */
+	bool				issuing;
+
+	/* Bytes that may be copied now, refilled by the poller */
+	uint64_t			budget;
+	uint64_t			last_refill_tsc;
+	struct spdk_poller		*poller;
+
+	/* Ticks spent copying before the current running period, which started
+	 * at run_start_tsc unless the job is paused */
+	uint64_t			run_ticks;
+	uint64_t			run_start_tsc;
+};
+
 static void
 bs_inflate_blob_set_parent_cpl(void *cb_arg, struct spdk_blob *_parent, int bserrno)
 {
@@ -5871,12 +7266,45 @@ bs_inflate_blob_set_parent_cpl(void *cb_arg, struct spdk_blob *_parent, int bser
 	spdk_blob_sync_md(_blob, bs_clone_snapshot_origblob_cleanup, ctx);
 }
 
+static void
+bs_inflate_blob_esnap_released(void *cb_arg, int bserrno)
+{
+	struct spdk_clone_snapshot_ctx *ctx = (struct spdk_clone_snapshot_ctx *)cb_arg;
+	struct spdk_blob *_blob = ctx->original.blob;
+
+	if (bserrno != 0) {
+		bs_clone_snapshot_origblob_cleanup(ctx, bserrno);
+		return;
+	}
+
+	/* Every cluster is allocated now, the external snapshot is no longer read */
+	blob_remove_xattr(_blob, BLOB_EXTERNAL_SNAPSHOT_ID, true);
+	_blob->invalid_flags &= ~SPDK_BLOB_EXTERNAL_SNAPSHOT;
+	_blob->back_bs_dev->destroy(_blob->back_bs_dev);
+
+	if (ctx->allocate_all) {
+		_blob->invalid_flags &= ~SPDK_BLOB_THIN_PROV;
+		_blob->back_bs_dev = NULL;
+	} else {
+		_blob->back_bs_dev = bs_create_zeroes_dev();
+	}
+
+	_blob->state = SPDK_BLOB_STATE_DIRTY;
+	spdk_blob_sync_md(_blob, bs_clone_snapshot_origblob_cleanup, ctx);
+}
+
 static void
 bs_inflate_blob_done(struct spdk_clone_snapshot_ctx *ctx)
 {
 	struct spdk_blob *_blob = ctx->original.blob;
 	struct spdk_blob *_parent;
 
+	if (spdk_blob_is_esnap_clone(_blob)) {
+		blob_esnap_release_channels((struct spdk_blob_esnap_dev *)_blob->back_bs_dev,
+					    bs_inflate_blob_esnap_released, ctx);
+		return;
+	}
+
 	if (ctx->allocate_all) {
 		/* remove thin provisioning */
 		bs_blob_list_remove(_blob);
@@ -5918,6 +7346,11 @@ bs_cluster_needs_allocation(struct spdk_blob *blob, uint64_t cluster, bool alloc
 		return false;
 	}
 
+	if (spdk_blob_is_esnap_clone(blob)) {
+		/* Every unallocated cluster is backed by the external snapshot */
+		return true;
+	}
+
 	if (blob->parent_id == SPDK_BLOBID_INVALID) {
 		/* Blob have no parent blob */
 		return allocate_all;
@@ -5927,38 +7360,114 @@ bs_cluster_needs_allocation(struct spdk_blob *blob, uint64_t cluster, bool alloc
 	return (allocate_all || b->blob->active.clusters[cluster] != 0);
 }
 
+static void bs_inflate_blob_touch_next(struct spdk_clone_snapshot_ctx *ctx);
+
 static void
-bs_inflate_blob_touch_next(void *cb_arg, int bserrno)
+bs_inflate_blob_touch_cpl(void *cb_arg, int bserrno)
 {
 	struct spdk_clone_snapshot_ctx *ctx = (struct spdk_clone_snapshot_ctx *)cb_arg;
-	struct spdk_blob *_blob = ctx->original.blob;
-	uint64_t offset;
+	struct spdk_blob_inflate_job *job = ctx->job;
+
+	assert(job->inflight > 0);
+	job->inflight--;
 
 	if (bserrno != 0) {
-		bs_clone_snapshot_origblob_cleanup(ctx, bserrno);
-		return;
+		if (job->rc == 0) {
+			job->rc = bserrno;
+		}
+	} else {
+		job->clusters_done++;
 	}
 
-	for (; ctx->cluster < _blob->active.num_clusters; ctx->cluster++) {
-		if (bs_cluster_needs_allocation(_blob, ctx->cluster, ctx->allocate_all)) {
+	if (!job->issuing) {
+		bs_inflate_blob_touch_next(ctx);
+	}
+}
+
+static void
+bs_inflate_blob_touch_next(struct spdk_clone_snapshot_ctx *ctx)
+{
+	struct spdk_blob_inflate_job *job = ctx->job;
+	struct spdk_blob *_blob = ctx->original.blob;
+	uint64_t offset;
+
+	job->issuing = true;
+	while (job->rc == 0 && !job->cancelled && !job->paused &&
+	       job->inflight < job->max_inflight) {
+		for (; ctx->cluster < _blob->active.num_clusters; ctx->cluster++) {
+			if (bs_cluster_needs_allocation(_blob, ctx->cluster, ctx->allocate_all)) {
+				break;
+			}
+		}
+
+		if (ctx->cluster >= _blob->active.num_clusters) {
 			break;
 		}
-	}
 
-	if (ctx->cluster < _blob->active.num_clusters) {
+		if (job->max_bytes_per_sec != 0) {
+			if (job->budget < _blob->bs->cluster_sz) {
+				/* The poller continues once the budget is refilled */
+				break;
+			}
+			job->budget -= _blob->bs->cluster_sz;
+		}
+
 		offset = bs_cluster_to_lba(_blob->bs, ctx->cluster);
 
 		/* We may safely increment a cluster before write */
 		ctx->cluster++;
+		job->inflight++;
 
 		/* Use zero length write to touch a cluster */
 		spdk_blob_io_write(_blob, ctx->channel, NULL, offset, 0,
-				   bs_inflate_blob_touch_next, ctx);
-	} else {
+				   bs_inflate_blob_touch_cpl, ctx);
+	}
+	job->issuing = false;
+
+	if (job->inflight > 0) {
+		return;
+	}
+
+	if (job->rc == 0 && job->cancelled) {
+		job->rc = -ECANCELED;
+	}
+
+	if (job->rc != 0) {
+		job->finishing = true;
+		bs_clone_snapshot_origblob_cleanup(ctx, job->rc);
+	} else if (ctx->cluster >= _blob->active.num_clusters) {
+		job->finishing = true;
 		bs_inflate_blob_done(ctx);
 	}
 }
 
+static int
+bs_inflate_job_poll(void *arg)
+{
+	struct spdk_blob_inflate_job *job = arg;
+	uint64_t now = spdk_get_ticks();
+	uint64_t ticks = now - job->last_refill_tsc;
+	uint64_t hz = spdk_get_ticks_hz();
+	uint64_t max_budget, refill;
+
+	job->last_refill_tsc = now;
+	if (job->paused) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	/* Allow bursts of up to 100ms worth of copies, and at least a cluster */
+	max_budget = spdk_max(job->max_bytes_per_sec / 10, (uint64_t)job->ctx->original.blob->bs->cluster_sz);
+	refill = (ticks / hz) * job->max_bytes_per_sec + (ticks % hz) * job->max_bytes_per_sec / hz;
+	job->budget = spdk_min(job->budget + refill, max_budget);
+
+	if (!job->started || job->finishing || job->issuing) {
+		return SPDK_POLLER_IDLE;
+	}
+
+	bs_inflate_blob_touch_next(job->ctx);
+	return SPDK_POLLER_BUSY;
+}
+
 static void
 bs_inflate_blob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 {
@@ -5966,176 +7475,851 @@ bs_inflate_blob_open_cpl(void *cb_arg, struct spdk_blob *_blob, int bserrno)
 	uint64_t clusters_needed;
 	uint64_t i;
 
-	if (bserrno != 0) {
-		bs_clone_snapshot_cleanup_finish(ctx, bserrno);
-		return;
-	}
+	if (bserrno != 0) {
+		bs_clone_snapshot_cleanup_finish(ctx, bserrno);
+		return;
+	}
+
+	ctx->original.blob = _blob;
+
+	if (_blob->locked_operation_in_progress) {
+		SPDK_DEBUGLOG(blob, "Cannot inflate blob - another operation in progress\n");
+		ctx->bserrno = -EBUSY;
+		spdk_blob_close(_blob, bs_clone_snapshot_cleanup_finish, ctx);
+		return;
+	}
+
+	_blob->locked_operation_in_progress = true;
+
+	if (ctx->job->cancelled) {
+		bs_clone_snapshot_origblob_cleanup(ctx, -ECANCELED);
+		return;
+	}
+
+	if (!ctx->allocate_all && _blob->parent_id == SPDK_BLOBID_INVALID &&
+	    !spdk_blob_is_esnap_clone(_blob)) {
+		/* This blob have no parent, so we cannot decouple it. */
+		SPDK_ERRLOG("Cannot decouple parent of blob with no parent.\n");
+		bs_clone_snapshot_origblob_cleanup(ctx, -EINVAL);
+		return;
+	}
+
+	if (spdk_blob_is_thin_provisioned(_blob) == false) {
+		/* This is not thin provisioned blob. No need to inflate. */
+		bs_clone_snapshot_origblob_cleanup(ctx, 0);
+		return;
+	}
+
+	/* Do two passes - one to verify that we can obtain enough clusters
+	 * and another to actually claim them.
+	 */
+	clusters_needed = 0;
+	for (i = 0; i < _blob->active.num_clusters; i++) {
+		if (bs_cluster_needs_allocation(_blob, i, ctx->allocate_all)) {
+			clusters_needed++;
+		}
+	}
+
+	if (clusters_needed > _blob->bs->num_free_clusters) {
+		/* Not enough free clusters. Cannot satisfy the request. */
+		bs_clone_snapshot_origblob_cleanup(ctx, -ENOSPC);
+		return;
+	}
+
+	ctx->job->clusters_total = clusters_needed;
+	ctx->job->started = true;
+	ctx->job->last_refill_tsc = spdk_get_ticks();
+	ctx->job->run_start_tsc = ctx->job->last_refill_tsc;
+
+	ctx->cluster = 0;
+	bs_inflate_blob_touch_next(ctx);
+}
+
+static void
+bs_inflate_job_complete(void *cb_arg, int bserrno)
+{
+	struct spdk_blob_inflate_job *job = cb_arg;
+
+	spdk_poller_unregister(&job->poller);
+	job->cb_fn(job->cb_arg, bserrno);
+	free(job);
+}
+
+static int
+bs_inflate_blob(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+		spdk_blob_id blobid, const struct spdk_blob_inflate_opts *opts,
+		spdk_blob_op_complete cb_fn, void *cb_arg, struct spdk_blob_inflate_job **_job)
+{
+	struct spdk_clone_snapshot_ctx *ctx;
+	struct spdk_blob_inflate_job *job;
+
+	if (opts->max_inflight == 0) {
+		return -EINVAL;
+	}
+
+	job = calloc(1, sizeof(*job));
+	if (!job) {
+		return -ENOMEM;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		free(job);
+		return -ENOMEM;
+	}
+
+	if (opts->max_bytes_per_sec != 0) {
+		job->poller = SPDK_POLLER_REGISTER(bs_inflate_job_poll, job, BLOB_INFLATE_JOB_POLL_US);
+		if (!job->poller) {
+			free(ctx);
+			free(job);
+			return -ENOMEM;
+		}
+		job->budget = bs->cluster_sz;
+	}
+
+	job->ctx = ctx;
+	job->cb_fn = cb_fn;
+	job->cb_arg = cb_arg;
+	job->max_inflight = opts->max_inflight;
+	job->max_bytes_per_sec = opts->max_bytes_per_sec;
+
+	ctx->cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
+	ctx->cpl.u.bs_basic.cb_fn = bs_inflate_job_complete;
+	ctx->cpl.u.bs_basic.cb_arg = job;
+	ctx->bserrno = 0;
+	ctx->original.id = blobid;
+	ctx->channel = channel;
+	ctx->allocate_all = !opts->decouple_parent;
+	ctx->job = job;
+
+	if (_job) {
+		*_job = job;
+	}
+
+	spdk_bs_open_blob(bs, ctx->original.id, bs_inflate_blob_open_cpl, ctx);
+	return 0;
+}
+
+static void
+bs_inflate_blob_now(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+		    spdk_blob_id blobid, bool allocate_all, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_blob_inflate_opts opts;
+	int rc;
+
+	/* One cluster at a time at full speed */
+	spdk_blob_inflate_opts_init(&opts);
+	opts.decouple_parent = !allocate_all;
+	opts.max_inflight = 1;
+
+	rc = bs_inflate_blob(bs, channel, blobid, &opts, cb_fn, cb_arg, NULL);
+	if (rc != 0) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+void
+spdk_bs_inflate_blob(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+		     spdk_blob_id blobid, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	bs_inflate_blob_now(bs, channel, blobid, true, cb_fn, cb_arg);
+}
+
+void
+spdk_bs_blob_decouple_parent(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+			     spdk_blob_id blobid, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	bs_inflate_blob_now(bs, channel, blobid, false, cb_fn, cb_arg);
+}
+
+void
+spdk_blob_inflate_opts_init(struct spdk_blob_inflate_opts *opts)
+{
+	opts->decouple_parent = false;
+	opts->max_inflight = 4;
+	opts->max_bytes_per_sec = 0;
+}
+
+int
+spdk_bs_inflate_blob_start(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+			   spdk_blob_id blobid, const struct spdk_blob_inflate_opts *opts,
+			   spdk_blob_op_complete cb_fn, void *cb_arg,
+			   struct spdk_blob_inflate_job **job)
+{
+	struct spdk_blob_inflate_opts opts_default;
+
+	if (!opts) {
+		spdk_blob_inflate_opts_init(&opts_default);
+		opts = &opts_default;
+	}
+
+	return bs_inflate_blob(bs, channel, blobid, opts, cb_fn, cb_arg, job);
+}
+
+void
+spdk_blob_inflate_job_pause(struct spdk_blob_inflate_job *job)
+{
+	if (job->paused) {
+		return;
+	}
+
+	job->paused = true;
+	if (job->started) {
+		job->run_ticks += spdk_get_ticks() - job->run_start_tsc;
+	}
+}
+
+void
+spdk_blob_inflate_job_resume(struct spdk_blob_inflate_job *job)
+{
+	if (!job->paused) {
+		return;
+	}
+
+	job->paused = false;
+	if (job->started) {
+		job->run_start_tsc = spdk_get_ticks();
+		if (!job->finishing && !job->issuing) {
+			bs_inflate_blob_touch_next(job->ctx);
+		}
+	}
+}
+
+void
+spdk_blob_inflate_job_cancel(struct spdk_blob_inflate_job *job)
+{
+	if (job->cancelled) {
+		return;
+	}
+
+	job->cancelled = true;
+	/* A job that is not copying anything now has to be finished here */
+	if (job->started && !job->finishing && !job->issuing) {
+		bs_inflate_blob_touch_next(job->ctx);
+	}
+}
+
+void
+spdk_blob_inflate_job_get_progress(const struct spdk_blob_inflate_job *job,
+				   struct spdk_blob_inflate_progress *progress)
+{
+	uint64_t ticks = job->run_ticks;
+	uint64_t hz = spdk_get_ticks_hz();
+
+	if (job->started && !job->paused) {
+		ticks += spdk_get_ticks() - job->run_start_tsc;
+	}
+
+	progress->clusters_total = job->clusters_total;
+	progress->clusters_done = job->clusters_done;
+	progress->elapsed_usec = (ticks / hz) * SPDK_SEC_TO_USEC + (ticks % hz) * SPDK_SEC_TO_USEC / hz;
+	if (job->clusters_done == 0) {
+		progress->eta_usec = job->clusters_total == 0 && job->started ? 0 : UINT64_MAX;
+	} else {
+		progress->eta_usec = progress->elapsed_usec *
+				     (job->clusters_total - job->clusters_done) / job->clusters_done;
+	}
+	progress->paused = job->paused;
+	progress->cancelled = job->cancelled;
+}
+/* END spdk_bs_inflate_blob */
+
+/* START spdk_bs_blob_shallow_copy */
+#define BLOB_SHALLOW_COPY_MAX_INFLIGHT 16
+
+struct shallow_copy_ctx;
+
+struct shallow_copy_io {
+	struct shallow_copy_ctx		*ctx;
+	uint64_t			cluster;
+	void				*buf;
+	struct spdk_bs_dev_cb_args	cb_args;
+};
+
+struct shallow_copy_ctx {
+	struct spdk_blob_store		*bs;
+	struct spdk_io_channel		*channel;
+	spdk_blob_id			blobid;
+	struct spdk_blob		*blob;
+	struct spdk_bs_dev		*ext_dev;
+	struct spdk_io_channel		*ext_channel;
+	spdk_blob_op_complete		cb_fn;
+	void				*cb_arg;
+
+	/* Next cluster to look at */
+	uint64_t			cluster;
+	uint32_t			inflight;
+	int				bserrno;
+	bool				issuing;
+	struct shallow_copy_io		*free_ios[BLOB_SHALLOW_COPY_MAX_INFLIGHT];
+	uint32_t			num_free_ios;
+	struct shallow_copy_io		ios[BLOB_SHALLOW_COPY_MAX_INFLIGHT];
+};
+
+static void
+bs_shallow_copy_blob_close_cpl(void *cb_arg, int bserrno)
+{
+	struct shallow_copy_ctx *ctx = cb_arg;
+	uint32_t i;
+
+	for (i = 0; i < BLOB_SHALLOW_COPY_MAX_INFLIGHT; i++) {
+		spdk_free(ctx->ios[i].buf);
+	}
+
+	ctx->cb_fn(ctx->cb_arg, ctx->bserrno != 0 ? ctx->bserrno : bserrno);
+	free(ctx);
+}
+
+static void
+bs_shallow_copy_finish(struct shallow_copy_ctx *ctx)
+{
+	if (ctx->ext_channel != NULL) {
+		ctx->ext_dev->destroy_channel(ctx->ext_dev, ctx->ext_channel);
+	}
+	spdk_blob_close(ctx->blob, bs_shallow_copy_blob_close_cpl, ctx);
+}
+
+static void bs_shallow_copy_next(struct shallow_copy_ctx *ctx);
+
+static void
+bs_shallow_copy_io_done(struct shallow_copy_io *io, int bserrno)
+{
+	struct shallow_copy_ctx *ctx = io->ctx;
+
+	if (bserrno != 0 && ctx->bserrno == 0) {
+		SPDK_ERRLOG("Shallow copy of cluster %" PRIu64 " of blob 0x%" PRIx64 " failed\n",
+			    io->cluster, ctx->blobid);
+		ctx->bserrno = bserrno;
+	}
+
+	ctx->inflight--;
+	ctx->free_ios[ctx->num_free_ios++] = io;
+	bs_shallow_copy_next(ctx);
+}
+
+static void
+bs_shallow_copy_write_cpl(struct spdk_io_channel *channel, void *cb_arg, int bserrno)
+{
+	bs_shallow_copy_io_done(cb_arg, bserrno);
+}
+
+static void
+bs_shallow_copy_read_cpl(void *cb_arg, int bserrno)
+{
+	struct shallow_copy_io *io = cb_arg;
+	struct shallow_copy_ctx *ctx = io->ctx;
+	uint64_t lba, lba_count;
+
+	if (bserrno != 0 || ctx->bserrno != 0) {
+		bs_shallow_copy_io_done(io, bserrno);
+		return;
+	}
+
+	lba = io->cluster * ctx->bs->cluster_sz / ctx->ext_dev->blocklen;
+	lba_count = ctx->bs->cluster_sz / ctx->ext_dev->blocklen;
+
+	io->cb_args.cb_fn = bs_shallow_copy_write_cpl;
+	io->cb_args.channel = ctx->ext_channel;
+	io->cb_args.cb_arg = io;
+	ctx->ext_dev->write(ctx->ext_dev, ctx->ext_channel, io->buf, lba, lba_count, &io->cb_args);
+}
+
+static void
+bs_shallow_copy_next(struct shallow_copy_ctx *ctx)
+{
+	struct spdk_blob *blob = ctx->blob;
+	uint64_t io_units_per_cluster = ctx->bs->pages_per_cluster * bs_io_unit_per_page(ctx->bs);
+	struct shallow_copy_io *io;
+
+	if (ctx->issuing) {
+		return;
+	}
+
+	/* Completions may arrive synchronously, so loop here rather than recursing */
+	ctx->issuing = true;
+	while (ctx->bserrno == 0 && ctx->num_free_ios > 0 &&
+	       ctx->cluster < blob->active.num_clusters) {
+		if (blob->active.clusters[ctx->cluster] == 0) {
+			/* Not allocated in this blob, ext_dev is left as it is */
+			ctx->cluster++;
+			continue;
+		}
+
+		io = ctx->free_ios[--ctx->num_free_ios];
+		if (io->buf == NULL) {
+			io->buf = spdk_malloc(ctx->bs->cluster_sz, ctx->ext_dev->blocklen, NULL,
+					      SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_DMA);
+			if (io->buf == NULL) {
+				ctx->free_ios[ctx->num_free_ios++] = io;
+				if (ctx->inflight == 0) {
+					ctx->bserrno = -ENOMEM;
+				}
+				/* Go on with the buffers already allocated */
+				break;
+			}
+		}
+
+		io->cluster = ctx->cluster++;
+		ctx->inflight++;
+		spdk_blob_io_read(blob, ctx->channel, io->buf, io->cluster * io_units_per_cluster,
+				  io_units_per_cluster, bs_shallow_copy_read_cpl, io);
+	}
+	ctx->issuing = false;
+
+	if (ctx->inflight == 0 &&
+	    (ctx->bserrno != 0 || ctx->cluster == blob->active.num_clusters)) {
+		bs_shallow_copy_finish(ctx);
+	}
+}
+
+static void
+bs_shallow_copy_blob_open_cpl(void *cb_arg, struct spdk_blob *blob, int bserrno)
+{
+	struct shallow_copy_ctx *ctx = cb_arg;
+	uint64_t blob_size;
+	uint32_t i;
+
+	if (bserrno != 0) {
+		ctx->cb_fn(ctx->cb_arg, bserrno);
+		free(ctx);
+		return;
+	}
+
+	ctx->blob = blob;
+	blob_size = blob->active.num_clusters * ctx->bs->cluster_sz;
+
+	if (!spdk_blob_is_read_only(blob)) {
+		SPDK_ERRLOG("Blob 0x%" PRIx64 " must be read only to be copied\n", ctx->blobid);
+		ctx->bserrno = -EPERM;
+	} else if (ctx->bs->cluster_sz % ctx->ext_dev->blocklen != 0 ||
+		   ctx->ext_dev->blockcnt * ctx->ext_dev->blocklen < blob_size) {
+		SPDK_ERRLOG("Device does not fit blob 0x%" PRIx64 "\n", ctx->blobid);
+		ctx->bserrno = -EINVAL;
+	} else {
+		ctx->ext_channel = ctx->ext_dev->create_channel(ctx->ext_dev);
+		if (ctx->ext_channel == NULL) {
+			ctx->bserrno = -ENOMEM;
+		}
+	}
+
+	if (ctx->bserrno != 0) {
+		bs_shallow_copy_finish(ctx);
+		return;
+	}
+
+	for (i = 0; i < BLOB_SHALLOW_COPY_MAX_INFLIGHT; i++) {
+		ctx->ios[i].ctx = ctx;
+		ctx->free_ios[i] = &ctx->ios[BLOB_SHALLOW_COPY_MAX_INFLIGHT - 1 - i];
+	}
+	ctx->num_free_ios = BLOB_SHALLOW_COPY_MAX_INFLIGHT;
+
+	bs_shallow_copy_next(ctx);
+}
+
+void
+spdk_bs_blob_shallow_copy(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+			  spdk_blob_id blobid, struct spdk_bs_dev *ext_dev,
+			  spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct shallow_copy_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->bs = bs;
+	ctx->channel = channel;
+	ctx->blobid = blobid;
+	ctx->ext_dev = ext_dev;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	spdk_bs_open_blob(bs, blobid, bs_shallow_copy_blob_open_cpl, ctx);
+}
+/* END spdk_bs_blob_shallow_copy */
+
+/* START spdk_blob_resize */
+struct spdk_bs_resize_ctx {
+	spdk_blob_op_complete cb_fn;
+	void *cb_arg;
+	struct spdk_blob *blob;
+	uint64_t sz;
+	int rc;
+};
+
+static void
+bs_resize_unfreeze_cpl(void *cb_arg, int rc)
+{
+	struct spdk_bs_resize_ctx *ctx = (struct spdk_bs_resize_ctx *)cb_arg;
+
+	if (rc != 0) {
+		SPDK_ERRLOG("Unfreeze failed, rc=%d\n", rc);
+	}
+
+	if (ctx->rc != 0) {
+		SPDK_ERRLOG("Unfreeze failed, ctx->rc=%d\n", ctx->rc);
+		rc = ctx->rc;
+	}
+
+	ctx->blob->locked_operation_in_progress = false;
+
+	ctx->cb_fn(ctx->cb_arg, rc);
+	free(ctx);
+}
+
+static void
+bs_resize_freeze_cpl(void *cb_arg, int rc)
+{
+	struct spdk_bs_resize_ctx *ctx = (struct spdk_bs_resize_ctx *)cb_arg;
+
+	if (rc != 0) {
+		ctx->blob->locked_operation_in_progress = false;
+		ctx->cb_fn(ctx->cb_arg, rc);
+		free(ctx);
+		return;
+	}
+
+	ctx->rc = blob_resize(ctx->blob, ctx->sz);
+
+	blob_unfreeze_io(ctx->blob, bs_resize_unfreeze_cpl, ctx);
+}
+
+void
+spdk_blob_resize(struct spdk_blob *blob, uint64_t sz, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_bs_resize_ctx *ctx;
+
+	blob_verify_md_op(blob);
+
+	SPDK_DEBUGLOG(blob, "Resizing blob %lu to %lu clusters\n", blob->id, sz);
+
+	if (blob->md_ro) {
+		cb_fn(cb_arg, -EPERM);
+		return;
+	}
+
+	if (sz == blob->active.num_clusters) {
+		cb_fn(cb_arg, 0);
+		return;
+	}
+
+	if (blob->locked_operation_in_progress) {
+		cb_fn(cb_arg, -EBUSY);
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	blob->locked_operation_in_progress = true;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	ctx->blob = blob;
+	ctx->sz = sz;
+	blob_freeze_io(blob, bs_resize_freeze_cpl, ctx);
+}
+
+/* END spdk_blob_resize */
+
+/* START spdk_blob_set_copy_on_read */
+
+struct blob_set_cor_ctx {
+	struct spdk_blob	*blob;
+	uint16_t		threshold;
+	spdk_blob_op_complete	cb_fn;
+	void			*cb_arg;
+	int			rc;
+};
+
+static void
+blob_set_cor_unfreeze_cpl(void *cb_arg, int rc)
+{
+	struct blob_set_cor_ctx *ctx = cb_arg;
+
+	ctx->cb_fn(ctx->cb_arg, ctx->rc != 0 ? ctx->rc : rc);
+	free(ctx);
+}
+
+static void
+blob_set_cor_freeze_cpl(void *cb_arg, int rc)
+{
+	struct blob_set_cor_ctx *ctx = cb_arg;
+	struct spdk_blob *blob = ctx->blob;
+
+	if (rc != 0) {
+		ctx->cb_fn(ctx->cb_arg, rc);
+		free(ctx);
+		return;
+	}
+
+	/* No reads are counting now, the counters can be replaced */
+	if (ctx->threshold == 0) {
+		free(blob->cor_read_counts);
+		blob->cor_read_counts = NULL;
+		blob->cor_read_counts_len = 0;
+	} else if (blob->cor_read_counts == NULL) {
+		blob->cor_read_counts = calloc(spdk_max(blob->active.num_clusters, 1),
+					       sizeof(*blob->cor_read_counts));
+		if (blob->cor_read_counts == NULL) {
+			ctx->rc = -ENOMEM;
+			blob_unfreeze_io(blob, blob_set_cor_unfreeze_cpl, ctx);
+			return;
+		}
+		blob->cor_read_counts_len = blob->active.num_clusters;
+	} else {
+		memset(blob->cor_read_counts, 0,
+		       sizeof(*blob->cor_read_counts) * blob->cor_read_counts_len);
+	}
+	blob->cor_threshold = ctx->threshold;
+
+	blob_unfreeze_io(blob, blob_set_cor_unfreeze_cpl, ctx);
+}
+
+void
+spdk_blob_set_copy_on_read(struct spdk_blob *blob, uint32_t threshold,
+			   spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct blob_set_cor_ctx *ctx;
+
+	blob_verify_md_op(blob);
+
+	if (threshold > UINT16_MAX) {
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	if (blob->data_ro) {
+		cb_fn(cb_arg, -EPERM);
+		return;
+	}
+
+	if (threshold == blob->cor_threshold) {
+		cb_fn(cb_arg, 0);
+		return;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	ctx->blob = blob;
+	ctx->threshold = threshold;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	blob_freeze_io(blob, blob_set_cor_freeze_cpl, ctx);
+}
+
+/* END spdk_blob_set_copy_on_read */
 
-	ctx->original.blob = _blob;
+/* START spdk_blob_set_io_stat */
 
-	if (_blob->locked_operation_in_progress) {
-		SPDK_DEBUGLOG(blob, "Cannot inflate blob - another operation in progress\n");
-		ctx->bserrno = -EBUSY;
-		spdk_blob_close(_blob, bs_clone_snapshot_cleanup_finish, ctx);
-		return;
-	}
+struct blob_set_io_stat_ctx {
+	struct spdk_blob	*blob;
+	bool			enable;
+	uint32_t		heatmap_sample_rate;
+	spdk_blob_op_complete	cb_fn;
+	void			*cb_arg;
+	int			rc;
+};
 
-	_blob->locked_operation_in_progress = true;
+static void
+blob_set_io_stat_unfreeze_cpl(void *cb_arg, int rc)
+{
+	struct blob_set_io_stat_ctx *ctx = cb_arg;
 
-	if (!ctx->allocate_all && _blob->parent_id == SPDK_BLOBID_INVALID) {
-		/* This blob have no parent, so we cannot decouple it. */
-		SPDK_ERRLOG("Cannot decouple parent of blob with no parent.\n");
-		bs_clone_snapshot_origblob_cleanup(ctx, -EINVAL);
-		return;
-	}
+	ctx->cb_fn(ctx->cb_arg, ctx->rc != 0 ? ctx->rc : rc);
+	free(ctx);
+}
 
-	if (spdk_blob_is_thin_provisioned(_blob) == false) {
-		/* This is not thin provisioned blob. No need to inflate. */
-		bs_clone_snapshot_origblob_cleanup(ctx, 0);
+static void
+blob_set_io_stat_freeze_cpl(void *cb_arg, int rc)
+{
+	struct blob_set_io_stat_ctx *ctx = cb_arg;
+	struct spdk_blob *blob = ctx->blob;
+	struct spdk_blob_io_stat *stat = NULL;
+	uint32_t *heatmap = NULL;
+
+	if (rc != 0) {
+		ctx->cb_fn(ctx->cb_arg, rc);
+		free(ctx);
 		return;
 	}
 
-	/* Do two passes - one to verify that we can obtain enough clusters
-	 * and another to actually claim them.
-	 */
-	clusters_needed = 0;
-	for (i = 0; i < _blob->active.num_clusters; i++) {
-		if (bs_cluster_needs_allocation(_blob, i, ctx->allocate_all)) {
-			clusters_needed++;
+	/* No I/O is counting now, the statistics can be replaced */
+	if (ctx->enable) {
+		stat = calloc(1, sizeof(*stat));
+		if (ctx->heatmap_sample_rate != 0) {
+			heatmap = calloc(spdk_max(blob->active.num_clusters, 1), sizeof(*heatmap));
+		}
+		if (stat == NULL || (ctx->heatmap_sample_rate != 0 && heatmap == NULL)) {
+			free(stat);
+			free(heatmap);
+			ctx->rc = -ENOMEM;
+			blob_unfreeze_io(blob, blob_set_io_stat_unfreeze_cpl, ctx);
+			return;
 		}
 	}
 
-	if (clusters_needed > _blob->bs->num_free_clusters) {
-		/* Not enough free clusters. Cannot satisfy the request. */
-		bs_clone_snapshot_origblob_cleanup(ctx, -ENOSPC);
-		return;
-	}
+	free(blob->io_stat);
+	free(blob->io_heatmap);
+	blob->io_stat = stat;
+	blob->io_heatmap = heatmap;
+	blob->io_heatmap_len = heatmap != NULL ? blob->active.num_clusters : 0;
+	blob->io_heatmap_sample_rate = ctx->heatmap_sample_rate;
 
-	ctx->cluster = 0;
-	bs_inflate_blob_touch_next(ctx, 0);
+	blob_unfreeze_io(blob, blob_set_io_stat_unfreeze_cpl, ctx);
 }
 
-static void
-bs_inflate_blob(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
-		spdk_blob_id blobid, bool allocate_all, spdk_blob_op_complete cb_fn, void *cb_arg)
+void
+spdk_blob_set_io_stat(struct spdk_blob *blob, bool enable, uint32_t heatmap_sample_rate,
+		      spdk_blob_op_complete cb_fn, void *cb_arg)
 {
-	struct spdk_clone_snapshot_ctx *ctx = calloc(1, sizeof(*ctx));
+	struct blob_set_io_stat_ctx *ctx;
+
+	blob_verify_md_op(blob);
+
+	if (!enable && blob->io_stat == NULL) {
+		cb_fn(cb_arg, 0);
+		return;
+	}
 
+	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
 		cb_fn(cb_arg, -ENOMEM);
 		return;
 	}
-	ctx->cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
-	ctx->cpl.u.bs_basic.cb_fn = cb_fn;
-	ctx->cpl.u.bs_basic.cb_arg = cb_arg;
-	ctx->bserrno = 0;
-	ctx->original.id = blobid;
-	ctx->channel = channel;
-	ctx->allocate_all = allocate_all;
 
-	spdk_bs_open_blob(bs, ctx->original.id, bs_inflate_blob_open_cpl, ctx);
+	ctx->blob = blob;
+	ctx->enable = enable;
+	ctx->heatmap_sample_rate = enable ? heatmap_sample_rate : 0;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+	blob_freeze_io(blob, blob_set_io_stat_freeze_cpl, ctx);
 }
 
-void
-spdk_bs_inflate_blob(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
-		     spdk_blob_id blobid, spdk_blob_op_complete cb_fn, void *cb_arg)
+int
+spdk_blob_get_io_stat(struct spdk_blob *blob, struct spdk_blob_io_stat *stat)
 {
-	bs_inflate_blob(bs, channel, blobid, true, cb_fn, cb_arg);
+	if (blob->io_stat == NULL) {
+		return -ENOENT;
+	}
+
+	*stat = *blob->io_stat;
+	return 0;
 }
 
-void
-spdk_bs_blob_decouple_parent(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
-			     spdk_blob_id blobid, spdk_blob_op_complete cb_fn, void *cb_arg)
+uint64_t
+spdk_blob_get_io_heatmap(struct spdk_blob *blob, uint64_t start_cluster,
+			 uint32_t *counts, uint64_t num_clusters)
 {
-	bs_inflate_blob(bs, channel, blobid, false, cb_fn, cb_arg);
+	uint64_t len;
+
+	len = spdk_min(blob->io_heatmap_len, blob->active.num_clusters);
+	if (blob->io_heatmap == NULL || start_cluster >= len) {
+		return 0;
+	}
+
+	num_clusters = spdk_min(num_clusters, len - start_cluster);
+	memcpy(counts, &blob->io_heatmap[start_cluster], sizeof(*counts) * num_clusters);
+
+	return num_clusters;
 }
-/* END spdk_bs_inflate_blob */
 
-/* START spdk_blob_resize */
-struct spdk_bs_resize_ctx {
-	spdk_blob_op_complete cb_fn;
-	void *cb_arg;
-	struct spdk_blob *blob;
-	uint64_t sz;
-	int rc;
+/* END spdk_blob_set_io_stat */
+
+/* START spdk_blob_set_esnap_bs_dev */
+
+struct blob_set_esnap_ctx {
+	struct spdk_blob	*blob;
+	struct spdk_bs_dev	*esnap_dev;
+	spdk_blob_op_complete	cb_fn;
+	void			*cb_arg;
+	int			rc;
 };
 
 static void
-bs_resize_unfreeze_cpl(void *cb_arg, int rc)
+blob_set_esnap_unfreeze_cpl(void *cb_arg, int bserrno)
 {
-	struct spdk_bs_resize_ctx *ctx = (struct spdk_bs_resize_ctx *)cb_arg;
-
-	if (rc != 0) {
-		SPDK_ERRLOG("Unfreeze failed, rc=%d\n", rc);
-	}
-
-	if (ctx->rc != 0) {
-		SPDK_ERRLOG("Unfreeze failed, ctx->rc=%d\n", ctx->rc);
-		rc = ctx->rc;
-	}
+	struct blob_set_esnap_ctx *ctx = cb_arg;
 
-	ctx->blob->locked_operation_in_progress = false;
-
-	ctx->cb_fn(ctx->cb_arg, rc);
+	ctx->cb_fn(ctx->cb_arg, ctx->rc ? ctx->rc : bserrno);
 	free(ctx);
 }
 
 static void
-bs_resize_freeze_cpl(void *cb_arg, int rc)
+blob_set_esnap_freeze_cpl(void *cb_arg, int bserrno)
 {
-	struct spdk_bs_resize_ctx *ctx = (struct spdk_bs_resize_ctx *)cb_arg;
+	struct blob_set_esnap_ctx *ctx = cb_arg;
+	struct spdk_blob *blob = ctx->blob;
+	struct spdk_blob_esnap_dev *dev;
 
-	if (rc != 0) {
-		ctx->blob->locked_operation_in_progress = false;
-		ctx->cb_fn(ctx->cb_arg, rc);
+	if (bserrno != 0) {
+		ctx->esnap_dev->destroy(ctx->esnap_dev);
+		ctx->cb_fn(ctx->cb_arg, bserrno);
 		free(ctx);
 		return;
 	}
 
-	ctx->rc = blob_resize(ctx->blob, ctx->sz);
+	/* A degraded device has no channels, so nothing refers to the missing
+	 * external snapshot that would need to be released first. */
+	if (!spdk_blob_is_degraded(blob)) {
+		ctx->esnap_dev->destroy(ctx->esnap_dev);
+		ctx->rc = -EEXIST;
+	} else {
+		dev = (struct spdk_blob_esnap_dev *)blob->back_bs_dev;
+		dev->esnap_dev = ctx->esnap_dev;
+		dev->bs_dev.blockcnt = ctx->esnap_dev->blockcnt;
+		dev->bs_dev.blocklen = ctx->esnap_dev->blocklen;
+	}
 
-	blob_unfreeze_io(ctx->blob, bs_resize_unfreeze_cpl, ctx);
+	blob_unfreeze_io(blob, blob_set_esnap_unfreeze_cpl, ctx);
 }
 
 void
-spdk_blob_resize(struct spdk_blob *blob, uint64_t sz, spdk_blob_op_complete cb_fn, void *cb_arg)
+spdk_blob_set_esnap_bs_dev(struct spdk_blob *blob, struct spdk_bs_dev *esnap_dev,
+			   spdk_blob_op_complete cb_fn, void *cb_arg)
 {
-	struct spdk_bs_resize_ctx *ctx;
+	struct blob_set_esnap_ctx *ctx;
+	int rc;
 
 	blob_verify_md_op(blob);
 
-	SPDK_DEBUGLOG(blob, "Resizing blob %lu to %lu clusters\n", blob->id, sz);
-
-	if (blob->md_ro) {
-		cb_fn(cb_arg, -EPERM);
-		return;
-	}
-
-	if (sz == blob->active.num_clusters) {
-		cb_fn(cb_arg, 0);
+	if (!spdk_blob_is_degraded(blob)) {
+		esnap_dev->destroy(esnap_dev);
+		cb_fn(cb_arg, spdk_blob_is_esnap_clone(blob) ? -EEXIST : -EINVAL);
 		return;
 	}
 
-	if (blob->locked_operation_in_progress) {
-		cb_fn(cb_arg, -EBUSY);
+	rc = blob_esnap_dev_validate(blob, esnap_dev);
+	if (rc != 0) {
+		esnap_dev->destroy(esnap_dev);
+		cb_fn(cb_arg, rc);
 		return;
 	}
 
 	ctx = calloc(1, sizeof(*ctx));
 	if (!ctx) {
+		esnap_dev->destroy(esnap_dev);
 		cb_fn(cb_arg, -ENOMEM);
 		return;
 	}
 
-	blob->locked_operation_in_progress = true;
+	ctx->blob = blob;
+	ctx->esnap_dev = esnap_dev;
 	ctx->cb_fn = cb_fn;
 	ctx->cb_arg = cb_arg;
-	ctx->blob = blob;
-	ctx->sz = sz;
-	blob_freeze_io(blob, bs_resize_freeze_cpl, ctx);
+	blob_freeze_io(blob, blob_set_esnap_freeze_cpl, ctx);
 }
 
-/* END spdk_blob_resize */
+/* END spdk_blob_set_esnap_bs_dev */
 
 
 /* START spdk_bs_delete_blob */
@@ -6827,6 +9011,7 @@ struct spdk_blob_insert_cluster_ctx {
 	int			rc;
 	spdk_blob_op_complete	cb_fn;
 	void			*cb_arg;
+	TAILQ_ENTRY(spdk_blob_insert_cluster_ctx) link;
 };
 
 static void
@@ -6887,9 +9072,81 @@ blob_insert_extent(struct spdk_blob *blob, uint32_t extent, uint64_t cluster_num
 
 	assert(spdk_bit_array_get(blob->bs->used_md_pages, extent) == true);
 
-	bs_sequence_write_dev(seq, page, bs_md_page_to_lba(blob->bs, extent),
-			      bs_byte_to_lba(blob->bs, SPDK_BS_PAGE_SIZE),
-			      blob_persist_extent_page_cpl, page);
+	bs_md_write_pages(seq, blob->bs, page, &extent, 1, blob_persist_extent_page_cpl, page);
+}
+
+static void blob_persist_queued_extent_pages(struct spdk_blob *blob);
+
+static void
+blob_persist_queued_extent_pages_cpl(void *cb_arg, int bserrno)
+{
+	struct spdk_blob *blob = cb_arg;
+	struct spdk_blob_insert_cluster_ctx *ctx, *tmp;
+	int rc;
+
+	if (bserrno != 0 && blob->extent_page_write_rc == 0) {
+		blob->extent_page_write_rc = bserrno;
+	}
+
+	assert(blob->extent_page_writes_outstanding > 0);
+	if (--blob->extent_page_writes_outstanding > 0) {
+		return;
+	}
+
+	rc = blob->extent_page_write_rc;
+	blob->extent_page_write_rc = 0;
+
+	TAILQ_FOREACH_SAFE(ctx, &blob->extent_inserts_in_progress, link, tmp) {
+		TAILQ_REMOVE(&blob->extent_inserts_in_progress, ctx, link);
+		blob_insert_cluster_msg_cb(ctx, rc);
+	}
+
+	/* Inserts that arrived while the pages were written need another write */
+	if (!TAILQ_EMPTY(&blob->queued_extent_inserts)) {
+		blob_persist_queued_extent_pages(blob);
+	}
+}
+
+/*
+ * Write out the extent pages of all queued cluster inserts. Each extent page is
+ * written once, no matter how many of its clusters were inserted since the
+ * previous write, so the allocations coming from all threads are committed together.
+ */
+static void
+blob_persist_queued_extent_pages(struct spdk_blob *blob)
+{
+	struct spdk_blob_insert_cluster_ctx *ctx, *prev;
+	uint32_t extent_page;
+
+	assert(TAILQ_EMPTY(&blob->extent_inserts_in_progress));
+	assert(blob->extent_page_writes_outstanding == 0);
+
+	TAILQ_SWAP(&blob->queued_extent_inserts, &blob->extent_inserts_in_progress,
+		   spdk_blob_insert_cluster_ctx, link);
+
+	/* Hold one reference until all of the writes are issued */
+	blob->extent_page_writes_outstanding = 1;
+
+	TAILQ_FOREACH(ctx, &blob->extent_inserts_in_progress, link) {
+		extent_page = *bs_cluster_to_extent_page(blob, ctx->cluster_num);
+
+		TAILQ_FOREACH(prev, &blob->extent_inserts_in_progress, link) {
+			if (prev == ctx ||
+			    *bs_cluster_to_extent_page(blob, prev->cluster_num) == extent_page) {
+				break;
+			}
+		}
+		if (prev != ctx) {
+			/* This extent page is already being written */
+			continue;
+		}
+
+		blob->extent_page_writes_outstanding++;
+		blob_insert_extent(blob, extent_page, ctx->cluster_num,
+				   blob_persist_queued_extent_pages_cpl, blob);
+	}
+
+	blob_persist_queued_extent_pages_cpl(blob, 0);
 }
 
 static void
@@ -6931,9 +9188,13 @@ blob_insert_cluster_msg(void *arg)
 			ctx->extent_page = 0;
 		}
 		/* Extent page already allocated.
-		 * Every cluster allocation, requires just an update of single extent page. */
-		blob_insert_extent(ctx->blob, *extent_page, ctx->cluster_num,
-				   blob_insert_cluster_msg_cb, ctx);
+		 * Every cluster allocation, requires just an update of single extent page.
+		 * Inserts are batched, so that the page is written once for all of
+		 * the clusters inserted while the previous write was in progress. */
+		TAILQ_INSERT_TAIL(&ctx->blob->queued_extent_inserts, ctx, link);
+		if (TAILQ_EMPTY(&ctx->blob->extent_inserts_in_progress)) {
+			blob_persist_queued_extent_pages(ctx->blob);
+		}
 	}
 }
 
@@ -6987,20 +9248,12 @@ blob_close_cpl(spdk_bs_sequence_t *seq, void *cb_arg, int bserrno)
 	bs_sequence_finish(seq, bserrno);
 }
 
-void spdk_blob_close(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg)
+static void
+blob_close_persist(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg)
 {
 	struct spdk_bs_cpl	cpl;
 	spdk_bs_sequence_t	*seq;
 
-	blob_verify_md_op(blob);
-
-	SPDK_DEBUGLOG(blob, "Closing blob %lu\n", blob->id);
-
-	if (blob->open_ref == 0) {
-		cb_fn(cb_arg, -EBADF);
-		return;
-	}
-
 	cpl.type = SPDK_BS_CPL_TYPE_BLOB_BASIC;
 	cpl.u.blob_basic.cb_fn = cb_fn;
 	cpl.u.blob_basic.cb_arg = cb_arg;
@@ -7015,6 +9268,59 @@ void spdk_blob_close(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *
 	blob_persist(seq, blob, blob_close_cpl, blob);
 }
 
+struct blob_close_esnap_ctx {
+	struct spdk_blob	*blob;
+	spdk_blob_op_complete	cb_fn;
+	void			*cb_arg;
+};
+
+static void
+blob_close_esnap_released(void *cb_arg, int bserrno)
+{
+	struct blob_close_esnap_ctx *ctx = cb_arg;
+
+	if (bserrno != 0) {
+		ctx->cb_fn(ctx->cb_arg, bserrno);
+	} else {
+		blob_close_persist(ctx->blob, ctx->cb_fn, ctx->cb_arg);
+	}
+	free(ctx);
+}
+
+void spdk_blob_close(struct spdk_blob *blob, spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	struct blob_close_esnap_ctx *ctx;
+
+	blob_verify_md_op(blob);
+
+	SPDK_DEBUGLOG(blob, "Closing blob %lu\n", blob->id);
+
+	if (blob->open_ref == 0) {
+		cb_fn(cb_arg, -EBADF);
+		return;
+	}
+
+	if (blob->open_ref == 1 && spdk_blob_is_esnap_clone(blob) && blob->back_bs_dev != NULL) {
+		/*
+		 * Last reference - release the external snapshot channels now, so that
+		 *  they are gone by the time the caller may unload the blobstore.
+		 */
+		ctx = calloc(1, sizeof(*ctx));
+		if (!ctx) {
+			cb_fn(cb_arg, -ENOMEM);
+			return;
+		}
+		ctx->blob = blob;
+		ctx->cb_fn = cb_fn;
+		ctx->cb_arg = cb_arg;
+		blob_esnap_release_channels((struct spdk_blob_esnap_dev *)blob->back_bs_dev,
+					    blob_close_esnap_released, ctx);
+		return;
+	}
+
+	blob_close_persist(blob, cb_fn, cb_arg);
+}
+
 /* END spdk_blob_close */
 
 struct spdk_io_channel *spdk_bs_alloc_io_channel(struct spdk_blob_store *bs)
@@ -7415,6 +9721,37 @@ spdk_blob_is_thin_provisioned(struct spdk_blob *blob)
 	return !!(blob->invalid_flags & SPDK_BLOB_THIN_PROV);
 }
 
+bool
+spdk_blob_is_esnap_clone(const struct spdk_blob *blob)
+{
+	assert(blob != NULL);
+	return !!(blob->invalid_flags & SPDK_BLOB_EXTERNAL_SNAPSHOT);
+}
+
+bool
+spdk_blob_is_degraded(const struct spdk_blob *blob)
+{
+	const struct spdk_blob_esnap_dev *dev;
+
+	assert(blob != NULL);
+	if (!spdk_blob_is_esnap_clone(blob) || blob->back_bs_dev == NULL) {
+		return false;
+	}
+
+	dev = (const struct spdk_blob_esnap_dev *)blob->back_bs_dev;
+	return dev->esnap_dev == NULL;
+}
+
+int
+spdk_blob_get_esnap_id(struct spdk_blob *blob, const void **id, size_t *len)
+{
+	if (!spdk_blob_is_esnap_clone(blob)) {
+		return -EINVAL;
+	}
+
+	return blob_get_xattr_value(blob, BLOB_EXTERNAL_SNAPSHOT_ID, id, len, true);
+}
+
 static void
 blob_update_clear_method(struct spdk_blob *blob)
 {
@@ -52,6 +52,20 @@
 #define SPDK_BLOB_OPTS_DEFAULT_CHANNEL_OPS 512
 #define SPDK_BLOB_BLOBID_HIGH_BIT (1ULL << 32)
 
+/* Maximum number of clusters a channel claims in advance for thin provisioned
+ * blobs. A channel never takes more than 1/BS_CHANNEL_RESERVE_FREE_DIVISOR of
+ * the free clusters at once, so reservations shrink as the blobstore fills up. */
+#define BS_CHANNEL_RESERVED_CLUSTERS 16
+#define BS_CHANNEL_RESERVE_FREE_DIVISOR 16
+
+/* Largest number of adjacent metadata pages merged into a single write */
+#define BS_MD_WRITE_MAX_PAGES 32
+
+/* Metadata replay after a dirty shutdown reads the metadata region in chunks of
+ * BS_LOAD_REPLAY_CHUNK_PAGES pages, keeping up to BS_LOAD_REPLAY_CHUNKS reads in flight. */
+#define BS_LOAD_REPLAY_CHUNK_PAGES 256
+#define BS_LOAD_REPLAY_CHUNKS 4
+
 struct spdk_xattr {
 	uint32_t	index;
 	uint16_t	value_len;
@@ -168,10 +182,33 @@ struct spdk_blob {
 
 	/* A list of pending metadata pending_persists */
 	TAILQ_HEAD(, spdk_blob_persist_ctx) pending_persists;
+	/* Persists completed together by the metadata write in progress */
+	TAILQ_HEAD(, spdk_blob_persist_ctx) persists_to_complete;
+
+	/* Cluster inserts waiting for their extent page to be written, and the
+	 * ones covered by the extent page writes currently in progress. */
+	TAILQ_HEAD(, spdk_blob_insert_cluster_ctx) queued_extent_inserts;
+	TAILQ_HEAD(, spdk_blob_insert_cluster_ctx) extent_inserts_in_progress;
+	uint32_t	extent_page_writes_outstanding;
+	int		extent_page_write_rc;
 
 	/* Number of data clusters retrived from extent table,
 	 * that many have to be read from extent pages. */
 	uint64_t	remaining_clusters_in_et;
+
+	/* Copy-on-read: reads of each unallocated cluster, NULL when disabled.
+	 * Only resized or freed while the blob I/O is frozen. */
+	uint16_t	*cor_read_counts;
+	uint64_t	cor_read_counts_len;
+	uint16_t	cor_threshold;
+
+	/* I/O statistics, NULL when disabled. The heatmap holds the sampled
+	 * accesses of each cluster, NULL when not sampled. Only allocated,
+	 * resized or freed while the blob I/O is frozen. */
+	struct spdk_blob_io_stat	*io_stat;
+	uint32_t	*io_heatmap;
+	uint64_t	io_heatmap_len;
+	uint32_t	io_heatmap_sample_rate;
 };
 
 struct spdk_blob_store {
@@ -192,10 +229,21 @@ struct spdk_blob_store {
 
 	pthread_mutex_t			used_clusters_mutex;
 
+	/* Channels that may hold reserved clusters. Protected by used_clusters_mutex. */
+	TAILQ_HEAD(, spdk_bs_channel)	channels;
+	/* Clusters claimed by channels but not yet given to any blob */
+	uint64_t			num_reserved_clusters;
+
+	/* Metadata page writes waiting to be merged and submitted, see bs_md_write_pages() */
+	TAILQ_HEAD(, spdk_bs_md_write_page) md_writes;
+	bool				md_writes_flush_pending;
+
 	uint32_t			cluster_sz;
 	uint64_t			total_clusters;
 	uint64_t			total_data_clusters;
 	uint64_t			num_free_clusters;
+	/* Size set by spdk_bs_grow(), kept by super block writes that read the old one */
+	uint64_t			grown_size;
 	uint64_t			pages_per_cluster;
 	uint8_t				pages_per_cluster_shift;
 	uint32_t			io_unit_size;
@@ -209,6 +257,9 @@ struct spdk_blob_store {
 	TAILQ_HEAD(, spdk_blob)		blobs;
 	TAILQ_HEAD(, spdk_blob_list)	snapshots;
 
+	spdk_bs_esnap_dev_create	esnap_bs_dev_create;
+	void				*esnap_ctx;
+
 	bool                            clean;
 };
 
@@ -223,6 +274,17 @@ struct spdk_bs_channel {
 
 	TAILQ_HEAD(, spdk_bs_request_set) need_cluster_alloc;
 	TAILQ_HEAD(, spdk_bs_request_set) queued_io;
+
+	/* Clusters claimed in advance, so that thin provisioned blobs can be
+	 * allocated without taking used_clusters_mutex on every first write.
+	 * Other threads may take them back with the mutex held when the
+	 * blobstore runs out of free clusters. */
+	uint32_t			reserved_clusters[BS_CHANNEL_RESERVED_CLUSTERS];
+	uint32_t			num_reserved_clusters;
+	TAILQ_ENTRY(spdk_bs_channel)	link;
+
+	/* Channels to external snapshot devices opened on this thread */
+	TAILQ_HEAD(, spdk_bs_esnap_channel) esnap_channels;
 };
 
 /** operation type */
@@ -241,11 +303,31 @@ enum spdk_blob_op_type {
 #define SNAPSHOT_IN_PROGRESS "SNAPTMP"
 #define SNAPSHOT_PENDING_REMOVAL "SNAPRM"
 
+#define BLOB_EXTERNAL_SNAPSHOT_ID "EXTSNAP"
+
 struct spdk_blob_bs_dev {
 	struct spdk_bs_dev bs_dev;
 	struct spdk_blob *blob;
 };
 
+/*
+ * Back bs_dev of an esnap clone. It wraps the device returned by the
+ *  esnap_bs_dev_create callback and keeps one channel to it per blobstore
+ *  channel, created on the first read from that channel.
+ */
+struct spdk_blob_esnap_dev {
+	struct spdk_bs_dev	bs_dev;
+	struct spdk_bs_dev	*esnap_dev;
+	struct spdk_blob_store	*bs;
+	uint32_t		num_channels;
+};
+
+struct spdk_bs_esnap_channel {
+	struct spdk_blob_esnap_dev		*dev;
+	struct spdk_io_channel			*channel;
+	TAILQ_ENTRY(spdk_bs_esnap_channel)	link;
+};
+
 /* On-Disk Data Structures
  *
  * The following data structures exist on disk.
@@ -337,7 +419,9 @@ struct spdk_blob_md_descriptor_extent_page {
 #define SPDK_BLOB_THIN_PROV (1ULL << 0)
 #define SPDK_BLOB_INTERNAL_XATTR (1ULL << 1)
 #define SPDK_BLOB_EXTENT_TABLE (1ULL << 2)
-#define SPDK_BLOB_INVALID_FLAGS_MASK	(SPDK_BLOB_THIN_PROV | SPDK_BLOB_INTERNAL_XATTR | SPDK_BLOB_EXTENT_TABLE)
+#define SPDK_BLOB_EXTERNAL_SNAPSHOT (1ULL << 3)
+#define SPDK_BLOB_INVALID_FLAGS_MASK	(SPDK_BLOB_THIN_PROV | SPDK_BLOB_INTERNAL_XATTR | \
+					 SPDK_BLOB_EXTENT_TABLE | SPDK_BLOB_EXTERNAL_SNAPSHOT)
 
 #define SPDK_BLOB_READ_ONLY (1ULL << 0)
 #define SPDK_BLOB_DATA_RO_FLAGS_MASK	SPDK_BLOB_READ_ONLY
@@ -134,9 +134,40 @@ struct spdk_mem_map {
 	uint64_t default_translation;
 	struct spdk_mem_map_ops ops;
 	void *cb_ctx;
+	/* Changes whenever a translation of this map is set, see g_mem_map_cache */
+	uint64_t generation;
 	TAILQ_ENTRY(spdk_mem_map) tailq;
 };
 
+/*
+ * Per-thread cache of the physically contiguous regions found by spdk_mem_map_translate(),
+ * so that translating many buffers from the same region doesn't walk the map every time.
+ * Entries are direct-mapped by 2MB page and are only valid while their generation matches
+ * the map's. Generations are taken from a global counter, so a map allocated at the address
+ * of a freed one can't match stale entries.
+ */
+#define MEM_MAP_CACHE_SIZE	8
+
+struct mem_map_cache_entry {
+	const struct spdk_mem_map *map;
+	uint64_t generation;
+	uint64_t vfn_2mb;
+	uint64_t translation_2mb;
+	/* Length of the contiguous region, from the start of the 2MB page */
+	uint64_t len;
+};
+
+static __thread struct mem_map_cache_entry g_mem_map_cache[MEM_MAP_CACHE_SIZE];
+static uint64_t g_mem_map_generation;
+
+static inline void
+mem_map_update_generation(struct spdk_mem_map *map)
+{
+	__atomic_store_n(&map->generation,
+			 __atomic_add_fetch(&g_mem_map_generation, 1, __ATOMIC_RELAXED),
+			 __ATOMIC_RELEASE);
+}
+
 /* Registrations map. The 64 bit translations are bit fields with the
  * following layout (starting with the low bits):
  *    0 - 61 : reserved
@@ -301,6 +332,7 @@ spdk_mem_map_alloc(uint64_t default_translation, const struct spdk_mem_map_ops *
 	if (ops) {
 		map->ops = *ops;
 	}
+	mem_map_update_generation(map);
 
 	if (ops && ops->notify_cb) {
 		pthread_mutex_lock(&g_spdk_mem_map_mutex);
@@ -633,6 +665,8 @@ spdk_mem_map_set_translation(struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 		vfn_2mb++;
 	}
 
+	mem_map_update_generation(map);
+
 	return 0;
 }
 
@@ -653,6 +687,8 @@ spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 	uint64_t cur_size;
 	uint64_t prev_translation;
 	uint64_t orig_translation;
+	uint64_t generation;
+	struct mem_map_cache_entry *cache;
 
 	if (spdk_unlikely(vaddr & ~MASK_256TB)) {
 		DEBUG_PRINT("invalid usermode virtual address %p\n", (void *)vaddr);
@@ -678,6 +714,19 @@ spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 		return map_2mb->translation_2mb;
 	}
 
+	if (*size <= cur_size) {
+		return map_2mb->translation_2mb;
+	}
+
+	cache = &g_mem_map_cache[vfn_2mb % MEM_MAP_CACHE_SIZE];
+	if (cache->map == map && cache->vfn_2mb == vfn_2mb &&
+	    cache->generation == __atomic_load_n(&map->generation, __ATOMIC_ACQUIRE) &&
+	    cache->translation_2mb == map_2mb->translation_2mb &&
+	    cache->len - _2MB_OFFSET(vaddr) >= *size) {
+		return cache->translation_2mb;
+	}
+
+	generation = __atomic_load_n(&map->generation, __ATOMIC_ACQUIRE);
 	orig_translation = map_2mb->translation_2mb;
 	prev_translation = orig_translation;
 	while (cur_size < *size) {
@@ -699,6 +748,12 @@ spdk_mem_map_translate(const struct spdk_mem_map *map, uint64_t vaddr, uint64_t
 		prev_translation = map_2mb->translation_2mb;
 	}
 
+	cache->map = map;
+	cache->generation = generation;
+	cache->vfn_2mb = vaddr >> SHIFT_2MB;
+	cache->translation_2mb = orig_translation;
+	cache->len = cur_size + _2MB_OFFSET(vaddr);
+
 	*size = spdk_min(*size, cur_size);
 	return orig_translation;
 }
@@ -1448,6 +1503,48 @@ spdk_vtophys(const void *buf, uint64_t *size)
 	}
 }
 
+int
+spdk_vtophys_iov(const struct iovec *iov, int iovcnt, struct spdk_vtophys_seg *segs,
+		 int max_segs)
+{
+	struct spdk_vtophys_seg *seg = NULL;
+	uint64_t paddr, len, remaining;
+	uint8_t *vaddr;
+	int i, num_segs = 0;
+
+	for (i = 0; i < iovcnt; i++) {
+		vaddr = iov[i].iov_base;
+		remaining = iov[i].iov_len;
+
+		while (remaining > 0) {
+			len = remaining;
+			paddr = spdk_vtophys(vaddr, &len);
+			if (paddr == SPDK_VTOPHYS_ERROR || len == 0) {
+				return -EFAULT;
+			}
+
+			len = spdk_min(len, remaining);
+
+			if (seg != NULL && seg->phys_addr + seg->len == paddr) {
+				seg->len += len;
+			} else {
+				if (num_segs == max_segs) {
+					return -ENOSPC;
+				}
+
+				seg = &segs[num_segs++];
+				seg->phys_addr = paddr;
+				seg->len = len;
+			}
+
+			vaddr += len;
+			remaining -= len;
+		}
+	}
+
+	return num_segs;
+}
+
 int
 spdk_mem_get_fd_and_offset(void *vaddr, uint64_t *offset)
 {
@@ -357,27 +357,16 @@ static void
 lvs_load_cb(void *cb_arg, struct spdk_blob_store *bs, int lvolerrno)
 {
 	struct spdk_lvs_with_handle_req *req = (struct spdk_lvs_with_handle_req *)cb_arg;
-	struct spdk_lvol_store *lvs;
+	struct spdk_lvol_store *lvs = req->lvol_store;
 
 	if (lvolerrno != 0) {
+		lvs_free(lvs);
 		req->cb_fn(req->cb_arg, NULL, lvolerrno);
 		free(req);
 		return;
 	}
 
-	lvs = calloc(1, sizeof(*lvs));
-	if (lvs == NULL) {
-		SPDK_ERRLOG("Cannot alloc memory for lvol store\n");
-		spdk_bs_unload(bs, bs_unload_with_error_cb, req);
-		return;
-	}
-
 	lvs->blobstore = bs;
-	lvs->bs_dev = req->bs_dev;
-	TAILQ_INIT(&lvs->lvols);
-	TAILQ_INIT(&lvs->pending_lvols);
-
-	req->lvol_store = lvs;
 
 	spdk_bs_get_super(bs, lvs_open_super, req);
 }
@@ -390,9 +379,11 @@ lvs_bs_opts_init(struct spdk_bs_opts *opts)
 }
 
 void
-spdk_lvs_load(struct spdk_bs_dev *bs_dev, spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg)
+spdk_lvs_load_ext(struct spdk_bs_dev *bs_dev, const struct spdk_lvs_opts *o,
+		  spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg)
 {
 	struct spdk_lvs_with_handle_req *req;
+	struct spdk_lvol_store *lvs;
 	struct spdk_bs_opts opts = {};
 
 	assert(cb_fn != NULL);
@@ -410,16 +401,40 @@ spdk_lvs_load(struct spdk_bs_dev *bs_dev, spdk_lvs_op_with_handle_complete cb_fn
 		return;
 	}
 
+	/* Allocated up front, it is the esnap_ctx of the blobstore while it loads */
+	lvs = calloc(1, sizeof(*lvs));
+	if (lvs == NULL) {
+		SPDK_ERRLOG("Cannot alloc memory for lvol store\n");
+		free(req);
+		cb_fn(cb_arg, NULL, -ENOMEM);
+		return;
+	}
+
+	lvs->bs_dev = bs_dev;
+	TAILQ_INIT(&lvs->lvols);
+	TAILQ_INIT(&lvs->pending_lvols);
+
 	req->cb_fn = cb_fn;
 	req->cb_arg = cb_arg;
 	req->bs_dev = bs_dev;
+	req->lvol_store = lvs;
 
 	lvs_bs_opts_init(&opts);
 	snprintf(opts.bstype.bstype, sizeof(opts.bstype.bstype), "LVOLSTORE");
+	if (o != NULL) {
+		opts.esnap_bs_dev_create = o->esnap_bs_dev_create;
+		opts.esnap_ctx = lvs;
+	}
 
 	spdk_bs_load(bs_dev, &opts, lvs_load_cb, req);
 }
 
+void
+spdk_lvs_load(struct spdk_bs_dev *bs_dev, spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg)
+{
+	spdk_lvs_load_ext(bs_dev, NULL, cb_fn, cb_arg);
+}
+
 static void
 remove_bs_on_error_cb(void *cb_arg, int bserrno)
 {
@@ -561,6 +576,8 @@ spdk_lvs_opts_init(struct spdk_lvs_opts *o)
 	o->cluster_sz = SPDK_LVS_OPTS_CLUSTER_SZ;
 	o->clear_method = LVS_CLEAR_WITH_UNMAP;
 	memset(o->name, 0, sizeof(o->name));
+	o->esnap_bs_dev_create = NULL;
+	o->max_size = 0;
 }
 
 static void
@@ -570,6 +587,7 @@ setup_lvs_opts(struct spdk_bs_opts *bs_opts, struct spdk_lvs_opts *o)
 	lvs_bs_opts_init(bs_opts);
 	bs_opts->cluster_sz = o->cluster_sz;
 	bs_opts->clear_method = (enum bs_clear_method)o->clear_method;
+	bs_opts->max_size = o->max_size;
 }
 
 int
@@ -611,6 +629,8 @@ spdk_lvs_init(struct spdk_bs_dev *bs_dev, struct spdk_lvs_opts *o,
 
 	spdk_uuid_generate(&lvs->uuid);
 	snprintf(lvs->name, sizeof(lvs->name), "%s", o->name);
+	opts.esnap_bs_dev_create = o->esnap_bs_dev_create;
+	opts.esnap_ctx = lvs;
 
 	rc = add_lvs_to_list(lvs);
 	if (rc) {
@@ -744,6 +764,39 @@ spdk_lvs_rename(struct spdk_lvol_store *lvs, const char *new_name,
 	spdk_bs_open_blob(lvs->blobstore, lvs->super_blob_id, lvs_rename_open_cb, req);
 }
 
+static void
+lvs_grow_cb(void *cb_arg, int lvserrno)
+{
+	struct spdk_lvs_req *req = cb_arg;
+
+	if (lvserrno != 0) {
+		SPDK_ERRLOG("Could not grow lvol store %s\n", req->lvol_store->name);
+	} else {
+		SPDK_INFOLOG(lvol, "Lvol store %s grown\n", req->lvol_store->name);
+	}
+
+	req->cb_fn(req->cb_arg, lvserrno);
+	free(req);
+}
+
+void
+spdk_lvs_grow(struct spdk_lvol_store *lvs, spdk_lvs_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_lvs_req *req;
+
+	req = calloc(1, sizeof(*req));
+	if (!req) {
+		SPDK_ERRLOG("Cannot alloc memory for lvol request pointer\n");
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+	req->lvol_store = lvs;
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+
+	spdk_bs_grow(lvs->blobstore, lvs_grow_cb, req);
+}
+
 static void
 _lvs_unload_cb(void *cb_arg, int lvserrno)
 {
@@ -1206,6 +1259,79 @@ spdk_lvol_create_clone(struct spdk_lvol *origlvol, const char *clone_name,
 			     req);
 }
 
+int
+spdk_lvol_create_esnap_clone(const void *esnap_id, uint32_t id_len, uint64_t size_bytes,
+			     struct spdk_lvol_store *lvs, const char *clone_name,
+			     spdk_lvol_op_with_handle_complete cb_fn, void *cb_arg)
+{
+	struct spdk_lvol_with_handle_req *req;
+	struct spdk_blob_store *bs;
+	struct spdk_lvol *lvol;
+	struct spdk_blob_opts opts;
+	uint64_t cluster_sz;
+	char *xattr_names[] = {LVOL_NAME, "uuid"};
+	int rc;
+
+	if (lvs == NULL) {
+		SPDK_ERRLOG("lvol store does not exist\n");
+		return -EINVAL;
+	}
+
+	if (esnap_id == NULL || id_len == 0) {
+		SPDK_ERRLOG("External snapshot id not provided\n");
+		return -EINVAL;
+	}
+
+	bs = lvs->blobstore;
+
+	cluster_sz = spdk_bs_get_cluster_size(bs);
+	if (size_bytes == 0 || (size_bytes % cluster_sz) != 0) {
+		SPDK_ERRLOG("Cannot create esnap clone of size %" PRIu64 ", it is not a multiple "
+			    "of the cluster size %" PRIu64 "\n", size_bytes, cluster_sz);
+		return -EINVAL;
+	}
+
+	rc = lvs_verify_lvol_name(lvs, clone_name);
+	if (rc < 0) {
+		return rc;
+	}
+
+	req = calloc(1, sizeof(*req));
+	if (!req) {
+		SPDK_ERRLOG("Cannot alloc memory for lvol request pointer\n");
+		return -ENOMEM;
+	}
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+
+	lvol = calloc(1, sizeof(*lvol));
+	if (!lvol) {
+		free(req);
+		SPDK_ERRLOG("Cannot alloc memory for lvol base pointer\n");
+		return -ENOMEM;
+	}
+	lvol->lvol_store = lvs;
+	lvol->thin_provision = true;
+	snprintf(lvol->name, sizeof(lvol->name), "%s", clone_name);
+	TAILQ_INSERT_TAIL(&lvol->lvol_store->pending_lvols, lvol, link);
+	spdk_uuid_generate(&lvol->uuid);
+	spdk_uuid_fmt_lower(lvol->uuid_str, sizeof(lvol->uuid_str), &lvol->uuid);
+	req->lvol = lvol;
+
+	spdk_blob_opts_init(&opts);
+	opts.num_clusters = size_bytes / cluster_sz;
+	opts.esnap_id = esnap_id;
+	opts.esnap_id_len = id_len;
+	opts.xattrs.count = SPDK_COUNTOF(xattr_names);
+	opts.xattrs.names = xattr_names;
+	opts.xattrs.ctx = lvol;
+	opts.xattrs.get_value = lvol_get_xattr_value;
+
+	spdk_bs_create_blob_ext(lvs->blobstore, &opts, lvol_create_cb, req);
+
+	return 0;
+}
+
 static void
 lvol_resize_done(void *cb_arg, int lvolerrno)
 {
@@ -1412,6 +1538,13 @@ spdk_lvol_close(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, void *cb_ar
 	req->cb_arg = cb_arg;
 	req->lvol = lvol;
 
+	if (lvol->inflate_job != NULL) {
+		/* The job holds the blob open, close it once the job has stopped */
+		lvol->close_req = req;
+		spdk_blob_inflate_job_cancel(lvol->inflate_job);
+		return;
+	}
+
 	spdk_blob_close(lvol->blob, lvol_close_blob_cb, req);
 }
 
@@ -1507,3 +1640,131 @@ spdk_lvol_decouple_parent(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, v
 	spdk_bs_blob_decouple_parent(lvol->lvol_store->blobstore, req->channel, blob_id,
 				     lvol_inflate_cb, req);
 }
+
+static void
+lvol_inflate_job_cb(void *cb_arg, int lvolerrno)
+{
+	struct spdk_lvol_req *req = cb_arg;
+	struct spdk_lvol *lvol = req->lvol;
+	struct spdk_lvol_req *close_req;
+
+	lvol->inflate_job = NULL;
+	spdk_bs_free_io_channel(req->channel);
+
+	if (lvolerrno < 0 && lvolerrno != -ECANCELED) {
+		SPDK_ERRLOG("Could not inflate lvol %s\n", lvol->unique_id);
+	}
+
+	close_req = lvol->close_req;
+	lvol->close_req = NULL;
+
+	req->cb_fn(req->cb_arg, lvolerrno);
+	free(req);
+
+	if (close_req != NULL) {
+		spdk_blob_close(lvol->blob, lvol_close_blob_cb, close_req);
+	}
+}
+
+int
+spdk_lvol_start_inflate(struct spdk_lvol *lvol, const struct spdk_blob_inflate_opts *opts,
+			spdk_lvol_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_lvol_req *req;
+	int rc;
+
+	assert(cb_fn != NULL);
+
+	if (lvol == NULL) {
+		SPDK_ERRLOG("Lvol does not exist\n");
+		return -ENODEV;
+	}
+
+	if (lvol->inflate_job != NULL || lvol->action_in_progress) {
+		return -EBUSY;
+	}
+
+	req = calloc(1, sizeof(*req));
+	if (!req) {
+		SPDK_ERRLOG("Cannot alloc memory for lvol request pointer\n");
+		return -ENOMEM;
+	}
+
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+	req->lvol = lvol;
+	req->channel = spdk_bs_alloc_io_channel(lvol->lvol_store->blobstore);
+	if (req->channel == NULL) {
+		SPDK_ERRLOG("Cannot alloc io channel for lvol inflate request\n");
+		free(req);
+		return -ENOMEM;
+	}
+
+	rc = spdk_bs_inflate_blob_start(lvol->lvol_store->blobstore, req->channel,
+					spdk_blob_get_id(lvol->blob), opts, lvol_inflate_job_cb, req,
+					&lvol->inflate_job);
+	if (rc != 0) {
+		spdk_bs_free_io_channel(req->channel);
+		free(req);
+		lvol->inflate_job = NULL;
+	}
+
+	return rc;
+}
+
+struct spdk_blob_inflate_job *
+spdk_lvol_get_inflate_job(struct spdk_lvol *lvol)
+{
+	return lvol->inflate_job;
+}
+
+static void
+lvol_shallow_copy_cb(void *cb_arg, int lvolerrno)
+{
+	struct spdk_lvol_req *req = cb_arg;
+
+	spdk_bs_free_io_channel(req->channel);
+
+	if (lvolerrno < 0) {
+		SPDK_ERRLOG("Could not make a shallow copy of lvol %s\n", req->lvol->unique_id);
+	}
+
+	req->cb_fn(req->cb_arg, lvolerrno);
+	free(req);
+}
+
+void
+spdk_lvol_shallow_copy(struct spdk_lvol *lvol, struct spdk_bs_dev *ext_dev,
+		       spdk_lvol_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_lvol_req *req;
+
+	assert(cb_fn != NULL);
+
+	if (lvol == NULL) {
+		SPDK_ERRLOG("Lvol does not exist\n");
+		cb_fn(cb_arg, -ENODEV);
+		return;
+	}
+
+	req = calloc(1, sizeof(*req));
+	if (!req) {
+		SPDK_ERRLOG("Cannot alloc memory for lvol request pointer\n");
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+	req->lvol = lvol;
+	req->channel = spdk_bs_alloc_io_channel(lvol->lvol_store->blobstore);
+	if (req->channel == NULL) {
+		SPDK_ERRLOG("Cannot alloc io channel for lvol shallow copy request\n");
+		free(req);
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	spdk_bs_blob_shallow_copy(lvol->lvol_store->blobstore, req->channel,
+				  spdk_blob_get_id(lvol->blob), ext_dev, lvol_shallow_copy_cb, req);
+}
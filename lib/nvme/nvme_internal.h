@@ -320,6 +320,13 @@ struct nvme_request {
 
 	uint32_t			md_size;
 
+	/**
+	 * Poll group whose shared pool this request belongs to, or NULL if the
+	 *  request belongs to a qpair.  Set once when the request memory is
+	 *  allocated and never cleared.
+	 */
+	struct spdk_nvme_poll_group	*group;
+
 	/**
 	 * The following members should not be reordered with members
 	 *  above.  These members are only needed when splitting
@@ -413,6 +420,9 @@ struct spdk_nvme_qpair {
 
 	uint8_t					first_fused_submitted: 1;
 
+	/* Set between spdk_nvme_qpair_batch_begin() and spdk_nvme_qpair_batch_submit() */
+	uint8_t					batch_submit: 1;
+
 	enum spdk_nvme_transport_type		trtype;
 
 	STAILQ_HEAD(, nvme_request)		free_req;
@@ -444,11 +454,36 @@ struct spdk_nvme_qpair {
 	const struct spdk_nvme_transport	*transport;
 
 	uint8_t					transport_failure_reason: 2;
+
+	/* Number of requests in req_buf */
+	uint32_t				num_requests;
+
+	/* Requests taken from the poll group's shared pool */
+	uint64_t				num_reqs_borrowed;
+
+	/* Request allocations that failed with both pools empty */
+	uint64_t				num_reqs_exhausted;
+};
+
+struct nvme_poll_group_req_buf {
+	STAILQ_ENTRY(nvme_poll_group_req_buf)		link;
 };
 
 struct spdk_nvme_poll_group {
 	void						*ctx;
 	STAILQ_HEAD(, spdk_nvme_transport_poll_group)	tgroups;
+
+	/*
+	 * Requests shared by the qpairs of this group once their own free_req
+	 *  lists run dry.  The pool grows on demand, up to the sum of the
+	 *  num_requests of the qpairs in the group, so its size follows the
+	 *  queue depth the group actually reaches.
+	 */
+	STAILQ_HEAD(, nvme_request)			free_req;
+	STAILQ_HEAD(, nvme_poll_group_req_buf)		req_bufs;
+	uint32_t					num_reqs;
+	uint32_t					max_reqs;
+	uint32_t					num_outstanding_reqs;
 };
 
 struct spdk_nvme_transport_poll_group {
@@ -1031,6 +1066,8 @@ int	nvme_fabric_ctrlr_get_reg_8(struct spdk_nvme_ctrlr *ctrlr, uint32_t offset,
 int	nvme_fabric_ctrlr_discover(struct spdk_nvme_ctrlr *ctrlr,
 				   struct spdk_nvme_probe_ctx *probe_ctx);
 int	nvme_fabric_qpair_connect(struct spdk_nvme_qpair *qpair, uint32_t num_entries);
+struct nvme_request *nvme_poll_group_get_request(struct spdk_nvme_qpair *qpair);
+void	nvme_poll_group_put_request(struct nvme_request *req);
 
 typedef int (*spdk_nvme_parse_ana_log_page_cb)(
 	const struct spdk_nvme_ana_group_descriptor *desc, void *cb_arg);
@@ -1045,12 +1082,15 @@ nvme_allocate_request(struct spdk_nvme_qpair *qpair,
 	struct nvme_request *req;
 
 	req = STAILQ_FIRST(&qpair->free_req);
-	if (req == NULL) {
-		return req;
+	if (spdk_likely(req != NULL)) {
+		STAILQ_REMOVE_HEAD(&qpair->free_req, stailq);
+	} else {
+		req = nvme_poll_group_get_request(qpair);
+		if (req == NULL) {
+			return req;
+		}
 	}
 
-	STAILQ_REMOVE_HEAD(&qpair->free_req, stailq);
-
 	/*
 	 * Only memset/zero fields that need it.  All other fields
 	 *  will be initialized appropriately either later in this
@@ -1140,6 +1180,11 @@ nvme_free_request(struct nvme_request *req)
 	assert(req->num_children == 0);
 	assert(req->qpair != NULL);
 
+	if (spdk_unlikely(req->group != NULL)) {
+		nvme_poll_group_put_request(req);
+		return;
+	}
+
 	STAILQ_INSERT_HEAD(&req->qpair->free_req, req, stailq);
 }
 
@@ -1160,6 +1205,11 @@ nvme_qpair_free_request(struct spdk_nvme_qpair *qpair, struct nvme_request *req)
 	assert(req != NULL);
 	assert(req->num_children == 0);
 
+	if (spdk_unlikely(req->group != NULL)) {
+		nvme_poll_group_put_request(req);
+		return;
+	}
+
 	STAILQ_INSERT_HEAD(&qpair->free_req, req, stailq);
 }
 
@@ -1280,6 +1330,7 @@ void nvme_transport_ctrlr_disconnect_qpair(struct spdk_nvme_ctrlr *ctrlr,
 void nvme_transport_qpair_abort_reqs(struct spdk_nvme_qpair *qpair, uint32_t dnr);
 int nvme_transport_qpair_reset(struct spdk_nvme_qpair *qpair);
 int nvme_transport_qpair_submit_request(struct spdk_nvme_qpair *qpair, struct nvme_request *req);
+int nvme_transport_qpair_submit_batch(struct spdk_nvme_qpair *qpair);
 int32_t nvme_transport_qpair_process_completions(struct spdk_nvme_qpair *qpair,
 		uint32_t max_completions);
 void nvme_transport_admin_qpair_abort_aers(struct spdk_nvme_qpair *qpair);
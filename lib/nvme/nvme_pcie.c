@@ -1305,6 +1305,8 @@ nvme_pcie_qpair_ring_sq_doorbell(struct spdk_nvme_qpair *qpair)
 		spdk_mmio_write_4(pqpair->sq_tdbl, pqpair->sq_tail);
 		g_thread_mmio_ctrlr = NULL;
 	}
+
+	pqpair->last_sq_tail = pqpair->sq_tail;
 }
 
 static inline void
@@ -1361,7 +1363,7 @@ nvme_pcie_qpair_submit_tracker(struct spdk_nvme_qpair *qpair, struct nvme_tracke
 		SPDK_ERRLOG("sq_tail is passing sq_head!\n");
 	}
 
-	if (!pqpair->flags.delay_cmd_submit) {
+	if (!pqpair->flags.delay_cmd_submit && !qpair->batch_submit) {
 		nvme_pcie_qpair_ring_sq_doorbell(qpair);
 	}
 }
@@ -1845,6 +1847,9 @@ nvme_pcie_fail_request_bad_vtophys(struct spdk_nvme_qpair *qpair, struct nvme_tr
 /*
  * Append PRP list entries to describe a virtually contiguous buffer starting at virt_addr of len bytes.
  *
+ * The buffer is translated one physically contiguous region at a time, which is usually a whole
+ * 2MB hugepage or more, and the PRP entries of each region are then filled in with a single loop.
+ *
  * *prp_index will be updated to account for the number of PRP entries used.
  */
 static inline int
@@ -1853,8 +1858,9 @@ nvme_pcie_prp_list_append(struct nvme_tracker *tr, uint32_t *prp_index, void *vi
 {
 	struct spdk_nvme_cmd *cmd = &tr->req->cmd;
 	uintptr_t page_mask = page_size - 1;
-	uint64_t phys_addr;
-	uint32_t i;
+	uint64_t phys_addr, mapping_len;
+	uint64_t *prp;
+	uint32_t i, j, seg_len, num_entries;
 
 	SPDK_DEBUGLOG(nvme, "prp_index:%u virt_addr:%p len:%u\n",
 		      *prp_index, virt_addr, (uint32_t)len);
@@ -1866,42 +1872,51 @@ nvme_pcie_prp_list_append(struct nvme_tracker *tr, uint32_t *prp_index, void *vi
 
 	i = *prp_index;
 	while (len) {
-		uint32_t seg_len;
-
-		/*
-		 * prp_index 0 is stored in prp1, and the rest are stored in the prp[] array,
-		 * so prp_index == count is valid.
-		 */
-		if (spdk_unlikely(i > SPDK_COUNTOF(tr->u.prp))) {
-			SPDK_ERRLOG("out of PRP entries\n");
-			return -EFAULT;
-		}
-
-		phys_addr = spdk_vtophys(virt_addr, NULL);
-		if (spdk_unlikely(phys_addr == SPDK_VTOPHYS_ERROR)) {
+		mapping_len = len;
+		phys_addr = spdk_vtophys(virt_addr, &mapping_len);
+		if (spdk_unlikely(phys_addr == SPDK_VTOPHYS_ERROR || mapping_len == 0)) {
 			SPDK_ERRLOG("vtophys(%p) failed\n", virt_addr);
 			return -EFAULT;
 		}
 
+		mapping_len = spdk_min(mapping_len, len);
+
 		if (i == 0) {
 			SPDK_DEBUGLOG(nvme, "prp1 = %p\n", (void *)phys_addr);
 			cmd->dptr.prp.prp1 = phys_addr;
 			seg_len = page_size - ((uintptr_t)virt_addr & page_mask);
+			seg_len = spdk_min(seg_len, mapping_len);
+			i++;
 		} else {
 			if ((phys_addr & page_mask) != 0) {
 				SPDK_ERRLOG("PRP %u not page aligned (%p)\n", i, virt_addr);
 				return -EFAULT;
 			}
 
-			SPDK_DEBUGLOG(nvme, "prp[%u] = %p\n", i - 1, (void *)phys_addr);
-			tr->u.prp[i - 1] = phys_addr;
-			seg_len = page_size;
+			seg_len = 0;
 		}
 
-		seg_len = spdk_min(seg_len, len);
-		virt_addr += seg_len;
-		len -= seg_len;
-		i++;
+		/*
+		 * The rest of the region starts on a page boundary and takes one entry per page.
+		 * prp_index 0 is stored in prp1, and the rest are stored in the prp[] array,
+		 * so prp_index == count is valid.
+		 */
+		num_entries = spdk_divide_round_up(mapping_len - seg_len, page_size);
+		if (spdk_unlikely(i - 1 + num_entries > SPDK_COUNTOF(tr->u.prp))) {
+			SPDK_ERRLOG("out of PRP entries\n");
+			return -EFAULT;
+		}
+
+		phys_addr += seg_len;
+		prp = &tr->u.prp[i - 1];
+		for (j = 0; j < num_entries; j++) {
+			prp[j] = phys_addr + (uint64_t)j * page_size;
+		}
+
+		SPDK_DEBUGLOG(nvme, "prp[%u] = %p, %u entries\n", i - 1, (void *)phys_addr, num_entries);
+		i += num_entries;
+		virt_addr += mapping_len;
+		len -= mapping_len;
 	}
 
 	cmd->psdt = SPDK_NVME_PSDT_PRP;
@@ -2333,6 +2348,18 @@ exit:
 	return rc;
 }
 
+static int
+nvme_pcie_qpair_submit_batch(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_pcie_qpair	*pqpair = nvme_pcie_qpair(qpair);
+
+	if (pqpair->last_sq_tail != pqpair->sq_tail) {
+		nvme_pcie_qpair_ring_sq_doorbell(qpair);
+	}
+
+	return 0;
+}
+
 static void
 nvme_pcie_qpair_check_timeout(struct spdk_nvme_qpair *qpair)
 {
@@ -2460,7 +2487,6 @@ nvme_pcie_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_
 	if (pqpair->flags.delay_cmd_submit) {
 		if (pqpair->last_sq_tail != pqpair->sq_tail) {
 			nvme_pcie_qpair_ring_sq_doorbell(qpair);
-			pqpair->last_sq_tail = pqpair->sq_tail;
 		}
 	}
 
@@ -2520,6 +2546,24 @@ nvme_pcie_poll_group_remove(struct spdk_nvme_transport_poll_group *tgroup,
 	return 0;
 }
 
+/*
+ * A qpair with nothing outstanding can't have completions to reap, so the poll group doesn't
+ * read its completion queue. Qpairs that are not enabled or whose controller failed are still
+ * polled, so that their state changes and failures are reported.
+ */
+static inline bool
+nvme_pcie_qpair_is_idle(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_pcie_qpair *pqpair = nvme_pcie_qpair(qpair);
+
+	return TAILQ_EMPTY(&pqpair->outstanding_tr) &&
+	       STAILQ_EMPTY(&qpair->queued_req) &&
+	       STAILQ_EMPTY(&qpair->aborting_queued_req) &&
+	       STAILQ_EMPTY(&qpair->err_req_head) &&
+	       nvme_qpair_get_state(qpair) == NVME_QPAIR_ENABLED &&
+	       !qpair->ctrlr->is_failed;
+}
+
 static int64_t
 nvme_pcie_poll_group_process_completions(struct spdk_nvme_transport_poll_group *tgroup,
 		uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb)
@@ -2533,6 +2577,10 @@ nvme_pcie_poll_group_process_completions(struct spdk_nvme_transport_poll_group *
 	}
 
 	STAILQ_FOREACH_SAFE(qpair, &tgroup->connected_qpairs, poll_group_stailq, tmp_qpair) {
+		if (nvme_pcie_qpair_is_idle(qpair)) {
+			continue;
+		}
+
 		local_completions = spdk_nvme_qpair_process_completions(qpair, completions_per_qpair);
 		if (local_completions < 0) {
 			disconnected_qpair_cb(qpair, tgroup->group->ctx);
@@ -2609,6 +2657,8 @@ const struct spdk_nvme_transport_ops pcie_ops = {
 	.poll_group_remove = nvme_pcie_poll_group_remove,
 	.poll_group_process_completions = nvme_pcie_poll_group_process_completions,
 	.poll_group_destroy = nvme_pcie_poll_group_destroy,
+
+	.qpair_submit_batch = nvme_pcie_qpair_submit_batch,
 };
 
 SPDK_NVME_TRANSPORT_REGISTER(pcie, &pcie_ops);
@@ -46,6 +46,8 @@ spdk_nvme_poll_group_create(void *ctx)
 
 	group->ctx = ctx;
 	STAILQ_INIT(&group->tgroups);
+	STAILQ_INIT(&group->free_req);
+	STAILQ_INIT(&group->req_bufs);
 
 	return group;
 }
@@ -55,6 +57,7 @@ spdk_nvme_poll_group_add(struct spdk_nvme_poll_group *group, struct spdk_nvme_qp
 {
 	struct spdk_nvme_transport_poll_group *tgroup;
 	const struct spdk_nvme_transport *transport;
+	int rc;
 
 	if (nvme_qpair_get_state(qpair) != NVME_QPAIR_DISCONNECTED) {
 		return -EINVAL;
@@ -83,23 +86,116 @@ spdk_nvme_poll_group_add(struct spdk_nvme_poll_group *group, struct spdk_nvme_qp
 		}
 	}
 
-	return tgroup ? nvme_transport_poll_group_add(tgroup, qpair) : -ENODEV;
+	if (!tgroup) {
+		return -ENODEV;
+	}
+
+	rc = nvme_transport_poll_group_add(tgroup, qpair);
+	if (rc == 0) {
+		group->max_reqs += qpair->num_requests;
+	}
+
+	return rc;
 }
 
 int
 spdk_nvme_poll_group_remove(struct spdk_nvme_poll_group *group, struct spdk_nvme_qpair *qpair)
 {
 	struct spdk_nvme_transport_poll_group *tgroup;
+	int rc;
 
 	STAILQ_FOREACH(tgroup, &group->tgroups, link) {
 		if (tgroup->transport == qpair->transport) {
-			return nvme_transport_poll_group_remove(tgroup, qpair);
+			rc = nvme_transport_poll_group_remove(tgroup, qpair);
+			if (rc == 0) {
+				assert(group->max_reqs >= qpair->num_requests);
+				group->max_reqs -= qpair->num_requests;
+			}
+			return rc;
 		}
 	}
 
 	return -ENODEV;
 }
 
+#define NVME_POLL_GROUP_MIN_REQ_GROWTH	32
+
+static int
+nvme_poll_group_grow_requests(struct spdk_nvme_poll_group *group)
+{
+	struct nvme_poll_group_req_buf *req_buf;
+	struct nvme_request *req;
+	size_t req_size_padded;
+	uint32_t i, num_reqs;
+
+	if (group->num_reqs >= group->max_reqs) {
+		return -ENOMEM;
+	}
+
+	/* Double the pool each time it runs dry, so it settles at the depth the group needs. */
+	num_reqs = spdk_max(group->num_reqs, NVME_POLL_GROUP_MIN_REQ_GROWTH);
+	num_reqs = spdk_min(num_reqs, group->max_reqs - group->num_reqs);
+
+	req_size_padded = (sizeof(struct nvme_request) + 63) & ~(size_t)63;
+
+	req_buf = spdk_zmalloc(req_size_padded * (num_reqs + 1), 64, NULL,
+			       SPDK_ENV_SOCKET_ID_ANY, SPDK_MALLOC_SHARE);
+	if (req_buf == NULL) {
+		return -ENOMEM;
+	}
+
+	STAILQ_INSERT_TAIL(&group->req_bufs, req_buf, link);
+
+	/* The first slot holds the req_buf header. */
+	for (i = 1; i <= num_reqs; i++) {
+		req = (struct nvme_request *)((uint8_t *)req_buf + i * req_size_padded);
+		req->group = group;
+		STAILQ_INSERT_HEAD(&group->free_req, req, stailq);
+	}
+
+	group->num_reqs += num_reqs;
+
+	return 0;
+}
+
+struct nvme_request *
+nvme_poll_group_get_request(struct spdk_nvme_qpair *qpair)
+{
+	struct spdk_nvme_poll_group *group;
+	struct nvme_request *req;
+
+	if (qpair->poll_group == NULL) {
+		qpair->num_reqs_exhausted++;
+		return NULL;
+	}
+
+	group = qpair->poll_group->group;
+
+	if (STAILQ_EMPTY(&group->free_req) && nvme_poll_group_grow_requests(group) != 0) {
+		qpair->num_reqs_exhausted++;
+		return NULL;
+	}
+
+	req = STAILQ_FIRST(&group->free_req);
+	STAILQ_REMOVE_HEAD(&group->free_req, stailq);
+
+	req->qpair = qpair;
+	group->num_outstanding_reqs++;
+	qpair->num_reqs_borrowed++;
+
+	return req;
+}
+
+void
+nvme_poll_group_put_request(struct nvme_request *req)
+{
+	struct spdk_nvme_poll_group *group = req->group;
+
+	assert(group->num_outstanding_reqs > 0);
+	group->num_outstanding_reqs--;
+	STAILQ_INSERT_HEAD(&group->free_req, req, stailq);
+}
+
 int
 nvme_poll_group_connect_qpair(struct spdk_nvme_qpair *qpair)
 {
@@ -148,6 +244,11 @@ int
 spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group)
 {
 	struct spdk_nvme_transport_poll_group *tgroup, *tmp_tgroup;
+	struct nvme_poll_group_req_buf *req_buf;
+
+	if (group->num_outstanding_reqs != 0) {
+		return -EBUSY;
+	}
 
 	STAILQ_FOREACH_SAFE(tgroup, &group->tgroups, link, tmp_tgroup) {
 		STAILQ_REMOVE(&group->tgroups, tgroup, spdk_nvme_transport_poll_group, link);
@@ -158,6 +259,11 @@ spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group)
 
 	}
 
+	while ((req_buf = STAILQ_FIRST(&group->req_bufs)) != NULL) {
+		STAILQ_REMOVE_HEAD(&group->req_bufs, link);
+		spdk_free(req_buf);
+	}
+
 	free(group);
 
 	return 0;
@@ -122,6 +122,7 @@ static const struct nvme_string io_opcode[] = {
 	{ SPDK_NVME_OPC_RESERVATION_REPORT, "RESERVATION REPORT" },
 	{ SPDK_NVME_OPC_RESERVATION_ACQUIRE, "RESERVATION ACQUIRE" },
 	{ SPDK_NVME_OPC_RESERVATION_RELEASE, "RESERVATION RELEASE" },
+	{ SPDK_NVME_OPC_COPY, "COPY" },
 	{ SPDK_OCSSD_OPC_VECTOR_RESET, "OCSSD / VECTOR RESET" },
 	{ SPDK_OCSSD_OPC_VECTOR_WRITE, "OCSSD / VECTOR WRITE" },
 	{ SPDK_OCSSD_OPC_VECTOR_READ, "OCSSD / VECTOR READ" },
@@ -381,6 +382,15 @@ static const struct nvme_string command_specific_status[] = {
 	{ SPDK_NVME_SC_CONFLICTING_ATTRIBUTES, "CONFLICTING ATTRIBUTES" },
 	{ SPDK_NVME_SC_INVALID_PROTECTION_INFO, "INVALID PROTECTION INFO" },
 	{ SPDK_NVME_SC_ATTEMPTED_WRITE_TO_RO_RANGE, "WRITE TO RO RANGE" },
+	{ SPDK_NVME_SC_CMD_SIZE_LIMIT_SIZE_EXCEEDED, "COMMAND SIZE LIMIT EXCEEDED" },
+	{ SPDK_NVME_SC_ZONE_BOUNDARY_ERROR, "ZONE BOUNDARY ERROR" },
+	{ SPDK_NVME_SC_ZONE_IS_FULL, "ZONE IS FULL" },
+	{ SPDK_NVME_SC_ZONE_IS_READ_ONLY, "ZONE IS READ ONLY" },
+	{ SPDK_NVME_SC_ZONE_IS_OFFLINE, "ZONE IS OFFLINE" },
+	{ SPDK_NVME_SC_ZONE_INVALID_WRITE, "ZONE INVALID WRITE" },
+	{ SPDK_NVME_SC_TOO_MANY_ACTIVE_ZONES, "TOO MANY ACTIVE ZONES" },
+	{ SPDK_NVME_SC_TOO_MANY_OPEN_ZONES, "TOO MANY OPEN ZONES" },
+	{ SPDK_NVME_SC_INVALID_ZONE_STATE_TRANSITION, "INVALID ZONE STATE TRANSITION" },
 	{ 0xFFFF, "COMMAND SPECIFIC" }
 };
 
@@ -743,6 +753,38 @@ spdk_nvme_qpair_get_failure_reason(struct spdk_nvme_qpair *qpair)
 	return qpair->transport_failure_reason;
 }
 
+int
+spdk_nvme_qpair_batch_begin(struct spdk_nvme_qpair *qpair)
+{
+	if (nvme_qpair_is_admin_queue(qpair) || qpair->batch_submit) {
+		return -EINVAL;
+	}
+
+	qpair->batch_submit = 1;
+
+	return 0;
+}
+
+int
+spdk_nvme_qpair_batch_submit(struct spdk_nvme_qpair *qpair)
+{
+	if (!qpair->batch_submit) {
+		return -EINVAL;
+	}
+
+	qpair->batch_submit = 0;
+
+	return nvme_transport_qpair_submit_batch(qpair);
+}
+
+void
+spdk_nvme_qpair_get_request_stats(struct spdk_nvme_qpair *qpair,
+				  struct spdk_nvme_qpair_request_stats *stats)
+{
+	stats->borrowed = qpair->num_reqs_borrowed;
+	stats->exhausted = qpair->num_reqs_exhausted;
+}
+
 int
 nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 		struct spdk_nvme_ctrlr *ctrlr,
@@ -761,6 +803,9 @@ nvme_qpair_init(struct spdk_nvme_qpair *qpair, uint16_t id,
 
 	qpair->ctrlr = ctrlr;
 	qpair->trtype = ctrlr->trid.trtype;
+	qpair->num_requests = num_requests;
+	qpair->num_reqs_borrowed = 0;
+	qpair->num_reqs_exhausted = 0;
 
 	STAILQ_INIT(&qpair->free_req);
 	STAILQ_INIT(&qpair->queued_req);
@@ -702,7 +702,7 @@ nvme_rdma_qpair_queue_send_wr(struct nvme_rdma_qpair *rqpair, struct ibv_send_wr
 	rqpair->current_num_sends++;
 	spdk_rdma_qp_queue_send_wrs(rqpair->rdma_qp, wr);
 
-	if (!rqpair->delay_cmd_submit) {
+	if (!rqpair->delay_cmd_submit && !rqpair->qpair.batch_submit) {
 		return nvme_rdma_qpair_submit_sends(rqpair);
 	}
 
@@ -727,7 +727,7 @@ nvme_rdma_qpair_queue_recv_wr(struct nvme_rdma_qpair *rqpair, struct ibv_recv_wr
 
 	rqpair->recvs_to_post.last = wr;
 
-	if (!rqpair->delay_cmd_submit) {
+	if (!rqpair->delay_cmd_submit && !rqpair->qpair.batch_submit) {
 		return nvme_rdma_qpair_submit_recvs(rqpair);
 	}
 
@@ -2090,6 +2090,20 @@ nvme_rdma_qpair_submit_request(struct spdk_nvme_qpair *qpair,
 	return nvme_rdma_qpair_queue_send_wr(rqpair, wr);
 }
 
+static int
+nvme_rdma_qpair_submit_batch(struct spdk_nvme_qpair *qpair)
+{
+	struct nvme_rdma_qpair *rqpair = nvme_rdma_qpair(qpair);
+	int rc;
+
+	rc = nvme_rdma_qpair_submit_sends(rqpair);
+	if (rc) {
+		return rc;
+	}
+
+	return nvme_rdma_qpair_submit_recvs(rqpair);
+}
+
 static int
 nvme_rdma_qpair_reset(struct spdk_nvme_qpair *qpair)
 {
@@ -2847,6 +2861,7 @@ const struct spdk_nvme_transport_ops rdma_ops = {
 	.poll_group_process_completions = nvme_rdma_poll_group_process_completions,
 	.poll_group_destroy = nvme_rdma_poll_group_destroy,
 
+	.qpair_submit_batch = nvme_rdma_qpair_submit_batch,
 };
 
 SPDK_NVME_TRANSPORT_REGISTER(rdma, &rdma_ops);
@@ -394,6 +394,18 @@ nvme_transport_qpair_submit_request(struct spdk_nvme_qpair *qpair, struct nvme_r
 	return transport->ops.qpair_submit_request(qpair, req);
 }
 
+int
+nvme_transport_qpair_submit_batch(struct spdk_nvme_qpair *qpair)
+{
+	assert(!nvme_qpair_is_admin_queue(qpair));
+
+	if (qpair->transport->ops.qpair_submit_batch != NULL) {
+		return qpair->transport->ops.qpair_submit_batch(qpair);
+	}
+
+	return 0;
+}
+
 int32_t
 nvme_transport_qpair_process_completions(struct spdk_nvme_qpair *qpair, uint32_t max_completions)
 {
@@ -391,6 +391,11 @@ nvmf_ctrlr_create(struct spdk_nvmf_subsystem *subsystem,
 	ctrlr->vcprop.cap.bits.to = 1; /* ready timeout - 500 msec units */
 	ctrlr->vcprop.cap.bits.dstrd = 0; /* fixed to 0 for NVMe-oF */
 	ctrlr->vcprop.cap.bits.css = SPDK_NVME_CAP_CSS_NVM; /* NVM command set */
+	if (subsystem->subtype == SPDK_NVMF_SUBTYPE_NVME) {
+		/* Zoned namespaces may be added after the host connected and need the
+		 * I/O command set specific identify data, so always offer it. */
+		ctrlr->vcprop.cap.bits.css |= SPDK_NVME_CAP_CSS_IOCS;
+	}
 	ctrlr->vcprop.cap.bits.mpsmin = 0; /* 2 ^ (12 + mpsmin) == 4k */
 	ctrlr->vcprop.cap.bits.mpsmax = 0; /* 2 ^ (12 + mpsmax) == 4k */
 
@@ -953,8 +958,15 @@ nvmf_prop_set_cc(struct spdk_nvmf_ctrlr *ctrlr, uint32_t value)
 	}
 
 	if (diff.bits.css) {
-		SPDK_ERRLOG("I/O Command Set Selected (CSS) 0x%x not supported!\n", cc.bits.css);
-		return false;
+		if (cc.bits.css != SPDK_NVME_CC_CSS_NVM &&
+		    !(cc.bits.css == SPDK_NVME_CC_CSS_IOCS &&
+		      (ctrlr->vcprop.cap.bits.css & SPDK_NVME_CAP_CSS_IOCS))) {
+			SPDK_ERRLOG("I/O Command Set Selected (CSS) 0x%x not supported!\n", cc.bits.css);
+			return false;
+		}
+		SPDK_DEBUGLOG(nvmf, "Prop Set CSS = 0x%x\n", cc.bits.css);
+		ctrlr->vcprop.cc.bits.css = cc.bits.css;
+		diff.bits.css = 0;
 	}
 
 	if (diff.raw != 0) {
@@ -1816,21 +1828,35 @@ static const struct spdk_nvme_cmds_and_effect_log_page g_cmds_and_effect_log_pag
 		[SPDK_NVME_OPC_DATASET_MANAGEMENT]	= {1, 1, 0, 0, 0, 0, 0, 0},
 		/* COMPARE */
 		[SPDK_NVME_OPC_COMPARE]			= {1, 0, 0, 0, 0, 0, 0, 0},
+		/* COPY */
+		[SPDK_NVME_OPC_COPY]			= {1, 1, 0, 0, 0, 0, 0, 0},
 	},
 };
 
 static void
-nvmf_get_cmds_and_effects_log_page(void *buffer,
+nvmf_get_cmds_and_effects_log_page(void *buffer, uint8_t csi,
 				   uint64_t offset, uint32_t length)
 {
+	struct spdk_nvme_cmds_and_effect_log_page page = g_cmds_and_effect_log_page;
 	uint32_t page_size = sizeof(struct spdk_nvme_cmds_and_effect_log_page);
 	size_t copy_len = 0;
 	size_t zero_len = length;
 
+	if (csi == SPDK_NVME_CSI_ZNS) {
+		/* ZONE MANAGEMENT SEND */
+		page.io_cmds_supported[SPDK_NVME_OPC_ZONE_MGMT_SEND].csupp = 1;
+		page.io_cmds_supported[SPDK_NVME_OPC_ZONE_MGMT_SEND].lbcc = 1;
+		/* ZONE MANAGEMENT RECEIVE */
+		page.io_cmds_supported[SPDK_NVME_OPC_ZONE_MGMT_RECV].csupp = 1;
+		/* ZONE APPEND */
+		page.io_cmds_supported[SPDK_NVME_OPC_ZONE_APPEND].csupp = 1;
+		page.io_cmds_supported[SPDK_NVME_OPC_ZONE_APPEND].lbcc = 1;
+	}
+
 	if (offset < page_size) {
 		copy_len = spdk_min(page_size - offset, length);
 		zero_len -= copy_len;
-		memcpy(buffer, (char *)(&g_cmds_and_effect_log_page) + offset, copy_len);
+		memcpy(buffer, (char *)(&page) + offset, copy_len);
 	}
 
 	if (zero_len) {
@@ -1947,7 +1973,8 @@ nvmf_ctrlr_get_log_page(struct spdk_nvmf_request *req)
 				goto invalid_log_page;
 			}
 		case SPDK_NVME_LOG_COMMAND_EFFECTS_LOG:
-			nvmf_get_cmds_and_effects_log_page(req->data, offset, len);
+			/* CSI: CDW14 bits 31:24 */
+			nvmf_get_cmds_and_effects_log_page(req->data, cmd->cdw14 >> 24, offset, len);
 			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 		case SPDK_NVME_LOG_CHANGED_NS_LIST:
 			nvmf_get_changed_ns_list_log_page(ctrlr, req->data, offset, len);
@@ -2114,6 +2141,11 @@ spdk_nvmf_ctrlr_identify_ctrlr(struct spdk_nvmf_ctrlr *ctrlr, struct spdk_nvme_c
 		cdata->oncs.dsm = nvmf_ctrlr_dsm_supported(ctrlr);
 		cdata->oncs.write_zeroes = nvmf_ctrlr_write_zeroes_supported(ctrlr);
 		cdata->oncs.reservations = 1;
+		/* Copied blocks can't keep the protection information the transport inserted */
+		if (!ctrlr->dif_insert_or_strip && nvmf_ctrlr_copy_supported(ctrlr)) {
+			cdata->oncs.copy = 1;
+			cdata->ocfs.copy_format0 = 1;
+		}
 		if (subsystem->flags.ana_reporting) {
 			cdata->anatt = ANA_TRANSITION_TIME_IN_SEC;
 			/* ANA Change state is not used, and ANA Persistent Loss state
@@ -2149,10 +2181,12 @@ static int
 nvmf_ctrlr_identify_active_ns_list(struct spdk_nvmf_subsystem *subsystem,
 				   struct spdk_nvme_cmd *cmd,
 				   struct spdk_nvme_cpl *rsp,
-				   struct spdk_nvme_ns_list *ns_list)
+				   struct spdk_nvme_ns_list *ns_list,
+				   bool match_csi)
 {
 	struct spdk_nvmf_ns *ns;
 	uint32_t count = 0;
+	uint8_t csi = cmd->cdw11_bits.identify.csi;
 
 	if (cmd->nsid >= 0xfffffffeUL) {
 		SPDK_ERRLOG("Identify Active Namespace List with invalid NSID %u\n", cmd->nsid);
@@ -2166,6 +2200,10 @@ nvmf_ctrlr_identify_active_ns_list(struct spdk_nvmf_subsystem *subsystem,
 			continue;
 		}
 
+		if (match_csi && ns->csi != csi) {
+			continue;
+		}
+
 		ns_list->ns_list[count++] = ns->opts.nsid;
 		if (count == SPDK_COUNTOF(ns_list->ns_list)) {
 			break;
@@ -2205,7 +2243,7 @@ _add_ns_id_desc(void **buf_ptr, size_t *buf_remain,
 
 static int
 nvmf_ctrlr_identify_ns_id_descriptor_list(
-	struct spdk_nvmf_subsystem *subsystem,
+	struct spdk_nvmf_ctrlr *ctrlr,
 	struct spdk_nvme_cmd *cmd,
 	struct spdk_nvme_cpl *rsp,
 	void *id_desc_list, size_t id_desc_list_size)
@@ -2213,8 +2251,9 @@ nvmf_ctrlr_identify_ns_id_descriptor_list(
 	struct spdk_nvmf_ns *ns;
 	size_t buf_remain = id_desc_list_size;
 	void *buf_ptr = id_desc_list;
+	uint8_t csi;
 
-	ns = _nvmf_subsystem_get_ns(subsystem, cmd->nsid);
+	ns = _nvmf_subsystem_get_ns(ctrlr->subsys, cmd->nsid);
 	if (ns == NULL || ns->bdev == NULL) {
 		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
 		rsp->status.sc = SPDK_NVME_SC_INVALID_NAMESPACE_OR_FORMAT;
@@ -2232,6 +2271,15 @@ nvmf_ctrlr_identify_ns_id_descriptor_list(
 	ADD_ID_DESC(SPDK_NVME_NIDT_NGUID, ns->opts.nguid, sizeof(ns->opts.nguid));
 	ADD_ID_DESC(SPDK_NVME_NIDT_UUID, &ns->opts.uuid, sizeof(ns->opts.uuid));
 
+	/*
+	 * With more than one I/O command set enabled, the host expects every
+	 * namespace to report its command set, including the NVM one (CSI 0).
+	 */
+	if (ctrlr->vcprop.cc.bits.css == SPDK_NVME_CC_CSS_IOCS) {
+		csi = ns->csi;
+		_add_ns_id_desc(&buf_ptr, &buf_remain, SPDK_NVME_NIDT_CSI, &csi, sizeof(csi));
+	}
+
 	/*
 	 * The list is automatically 0-terminated because controller to host buffers in
 	 * admin commands always get zeroed in nvmf_ctrlr_process_admin_cmd().
@@ -2242,6 +2290,89 @@ nvmf_ctrlr_identify_ns_id_descriptor_list(
 	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 }
 
+static int
+nvmf_ctrlr_identify_ns_iocs(struct spdk_nvmf_ctrlr *ctrlr,
+			    struct spdk_nvme_cmd *cmd,
+			    struct spdk_nvme_cpl *rsp,
+			    void *nsdata)
+{
+	struct spdk_nvmf_ns *ns;
+
+	ns = _nvmf_subsystem_get_ns(ctrlr->subsys, cmd->nsid);
+	if (ns == NULL || ns->bdev == NULL) {
+		SPDK_ERRLOG("Identify Namespace for invalid NSID %u\n", cmd->nsid);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INVALID_NAMESPACE_OR_FORMAT;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	switch (cmd->cdw11_bits.identify.csi) {
+	case SPDK_NVME_CSI_NVM:
+		/* The NVM command set has no specific namespace data, leave it zeroed. */
+		break;
+	case SPDK_NVME_CSI_ZNS:
+		if (ns->csi != SPDK_NVME_CSI_ZNS) {
+			goto invalid_csi;
+		}
+		nvmf_bdev_ctrlr_identify_iocs_zns(ns, nsdata);
+		break;
+	default:
+		goto invalid_csi;
+	}
+
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+
+invalid_csi:
+	rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+	rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+}
+
+static int
+nvmf_ctrlr_identify_ctrlr_iocs(struct spdk_nvmf_ctrlr *ctrlr,
+			       struct spdk_nvme_cmd *cmd,
+			       struct spdk_nvme_cpl *rsp,
+			       void *cdata)
+{
+	struct spdk_nvmf_transport *transport = ctrlr->admin_qpair->transport;
+	struct spdk_nvme_zns_ctrlr_data *cdata_zns;
+
+	switch (cmd->cdw11_bits.identify.csi) {
+	case SPDK_NVME_CSI_NVM:
+		/* The NVM command set has no specific controller data, leave it zeroed. */
+		break;
+	case SPDK_NVME_CSI_ZNS:
+		if (!(ctrlr->vcprop.cap.bits.css & SPDK_NVME_CAP_CSS_IOCS)) {
+			goto invalid_csi;
+		}
+		/* Zone appends are limited to the same size as other I/O. */
+		cdata_zns = cdata;
+		cdata_zns->zasl = spdk_u32log2(transport->opts.max_io_size / 4096);
+		break;
+	default:
+		goto invalid_csi;
+	}
+
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+
+invalid_csi:
+	rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+	rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+}
+
+static int
+nvmf_ctrlr_identify_iocs(struct spdk_nvmf_ctrlr *ctrlr, uint64_t *vectors)
+{
+	/* Only the first I/O command set combination is reported. */
+	vectors[0] = 1ULL << SPDK_NVME_CSI_NVM;
+	if (ctrlr->vcprop.cap.bits.css & SPDK_NVME_CAP_CSS_IOCS) {
+		vectors[0] |= 1ULL << SPDK_NVME_CSI_ZNS;
+	}
+
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+}
+
 static int
 nvmf_ctrlr_identify(struct spdk_nvmf_request *req)
 {
@@ -2272,9 +2403,17 @@ nvmf_ctrlr_identify(struct spdk_nvmf_request *req)
 	case SPDK_NVME_IDENTIFY_CTRLR:
 		return spdk_nvmf_ctrlr_identify_ctrlr(ctrlr, req->data);
 	case SPDK_NVME_IDENTIFY_ACTIVE_NS_LIST:
-		return nvmf_ctrlr_identify_active_ns_list(subsystem, cmd, rsp, req->data);
+		return nvmf_ctrlr_identify_active_ns_list(subsystem, cmd, rsp, req->data, false);
 	case SPDK_NVME_IDENTIFY_NS_ID_DESCRIPTOR_LIST:
-		return nvmf_ctrlr_identify_ns_id_descriptor_list(subsystem, cmd, rsp, req->data, req->length);
+		return nvmf_ctrlr_identify_ns_id_descriptor_list(ctrlr, cmd, rsp, req->data, req->length);
+	case SPDK_NVME_IDENTIFY_NS_IOCS:
+		return nvmf_ctrlr_identify_ns_iocs(ctrlr, cmd, rsp, req->data);
+	case SPDK_NVME_IDENTIFY_CTRLR_IOCS:
+		return nvmf_ctrlr_identify_ctrlr_iocs(ctrlr, cmd, rsp, req->data);
+	case SPDK_NVME_IDENTIFY_ACTIVE_NS_LIST_IOCS:
+		return nvmf_ctrlr_identify_active_ns_list(subsystem, cmd, rsp, req->data, true);
+	case SPDK_NVME_IDENTIFY_IOCS:
+		return nvmf_ctrlr_identify_iocs(ctrlr, req->data);
 	default:
 		goto invalid_cns;
 	}
@@ -3015,6 +3154,9 @@ nvmf_ns_reservation_request_check(struct spdk_nvmf_subsystem_pg_ns_info *ns_info
 	case SPDK_NVME_OPC_WRITE_UNCORRECTABLE:
 	case SPDK_NVME_OPC_WRITE_ZEROES:
 	case SPDK_NVME_OPC_DATASET_MANAGEMENT:
+	case SPDK_NVME_OPC_COPY:
+	case SPDK_NVME_OPC_ZONE_APPEND:
+	case SPDK_NVME_OPC_ZONE_MGMT_SEND:
 		if (rtype == SPDK_NVME_RESERVE_WRITE_EXCLUSIVE ||
 		    rtype == SPDK_NVME_RESERVE_EXCLUSIVE_ACCESS) {
 			status = SPDK_NVME_SC_RESERVATION_CONFLICT;
@@ -3189,7 +3331,15 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 
 	/* scan-build falsely reporting dereference of null pointer */
 	assert(group != NULL && group->sgroups != NULL);
-	ns_info = &group->sgroups[ctrlr->subsys->id].ns_info[nsid - 1];
+	ns_info = nvmf_pg_get_ns_info(&group->sgroups[ctrlr->subsys->id], nsid);
+	if (spdk_unlikely(ns_info == NULL)) {
+		/* The namespace was added but this poll group hasn't picked it up yet. */
+		SPDK_ERRLOG("Namespace %u is not ready on this poll group\n", nsid);
+		response->status.sc = SPDK_NVME_SC_INVALID_NAMESPACE_OR_FORMAT;
+		response->status.dnr = 1;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
 	if (nvmf_ns_reservation_request_check(ns_info, ctrlr, req)) {
 		SPDK_DEBUGLOG(nvmf, "Reservation Conflict for nsid %u, opcode %u\n",
 			      cmd->nsid, cmd->opc);
@@ -3227,6 +3377,23 @@ nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req)
 		return nvmf_bdev_ctrlr_flush_cmd(bdev, desc, ch, req);
 	case SPDK_NVME_OPC_DATASET_MANAGEMENT:
 		return nvmf_bdev_ctrlr_dsm_cmd(bdev, desc, ch, req);
+	case SPDK_NVME_OPC_COPY:
+		return nvmf_bdev_ctrlr_copy_cmd(bdev, desc, ch, req);
+	case SPDK_NVME_OPC_ZONE_APPEND:
+		if (ns->csi == SPDK_NVME_CSI_ZNS) {
+			return nvmf_bdev_ctrlr_zone_append_cmd(bdev, desc, ch, req);
+		}
+		return nvmf_bdev_ctrlr_nvme_passthru_io(bdev, desc, ch, req);
+	case SPDK_NVME_OPC_ZONE_MGMT_SEND:
+		if (ns->csi == SPDK_NVME_CSI_ZNS) {
+			return nvmf_bdev_ctrlr_zone_mgmt_send_cmd(bdev, desc, ch, req);
+		}
+		return nvmf_bdev_ctrlr_nvme_passthru_io(bdev, desc, ch, req);
+	case SPDK_NVME_OPC_ZONE_MGMT_RECV:
+		if (ns->csi == SPDK_NVME_CSI_ZNS) {
+			return nvmf_bdev_ctrlr_zone_mgmt_recv_cmd(bdev, desc, ch, req);
+		}
+		return nvmf_bdev_ctrlr_nvme_passthru_io(bdev, desc, ch, req);
 	case SPDK_NVME_OPC_RESERVATION_REGISTER:
 	case SPDK_NVME_OPC_RESERVATION_ACQUIRE:
 	case SPDK_NVME_OPC_RESERVATION_RELEASE:
@@ -3265,6 +3432,109 @@ spdk_nvmf_request_free(struct spdk_nvmf_request *req)
 	return 0;
 }
 
+/*
+ * Namespace that a request is accounted to, so that a single namespace can
+ * be paused. Admin commands are included because they dereference the namespace
+ * too, except for AERs, which stay outstanding indefinitely. Requests for a NSID
+ * unknown to the poll group are not accounted.
+ */
+static inline struct spdk_nvmf_subsystem_pg_ns_info *
+nvmf_request_get_pg_ns_info(struct spdk_nvmf_request *req,
+			    struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	if (req->cmd->nvmf_cmd.opcode == SPDK_NVME_OPC_FABRIC ||
+	    (nvmf_qpair_is_admin_queue(req->qpair) &&
+	     req->cmd->nvme_cmd.opc == SPDK_NVME_OPC_ASYNC_EVENT_REQUEST)) {
+		return NULL;
+	}
+
+	return nvmf_pg_get_ns_info(sgroup, req->cmd->nvme_cmd.nsid);
+}
+
+static struct spdk_nvmf_host_io_stats *
+nvmf_qpair_get_io_stats(struct spdk_nvmf_qpair *qpair,
+			struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	struct spdk_nvmf_host_io_stats *stats;
+
+	if (spdk_likely(qpair->io_stats != NULL)) {
+		return qpair->io_stats;
+	}
+
+	/* The statistics outlive the controller, so that a reconnecting host keeps adding up. */
+	TAILQ_FOREACH(stats, &sgroup->host_stats, link) {
+		if (strcmp(stats->hostnqn, qpair->ctrlr->hostnqn) == 0) {
+			qpair->io_stats = stats;
+			return stats;
+		}
+	}
+
+	stats = calloc(1, sizeof(*stats));
+	if (stats == NULL) {
+		return NULL;
+	}
+	snprintf(stats->hostnqn, sizeof(stats->hostnqn), "%s", qpair->ctrlr->hostnqn);
+	TAILQ_INSERT_TAIL(&sgroup->host_stats, stats, link);
+
+	qpair->io_stats = stats;
+	return stats;
+}
+
+static void
+nvmf_request_update_io_stats(struct spdk_nvmf_request *req,
+			     struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	struct spdk_nvmf_qpair *qpair = req->qpair;
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	struct spdk_nvmf_host_io_stats *stats;
+	struct spdk_nvmf_ns_io_stat *ns_stat, *new_ns;
+	enum spdk_nvmf_io_stat_type type;
+	uint64_t ticks, units;
+	uint32_t bucket;
+
+	stats = nvmf_qpair_get_io_stats(qpair, sgroup);
+	if (spdk_unlikely(stats == NULL)) {
+		return;
+	}
+
+	if (spdk_unlikely(cmd->nsid > stats->num_ns)) {
+		new_ns = realloc(stats->ns, cmd->nsid * sizeof(*new_ns));
+		if (new_ns == NULL) {
+			return;
+		}
+		memset(&new_ns[stats->num_ns], 0, (cmd->nsid - stats->num_ns) * sizeof(*new_ns));
+		stats->ns = new_ns;
+		stats->num_ns = cmd->nsid;
+	}
+	ns_stat = &stats->ns[cmd->nsid - 1];
+
+	switch (cmd->opc) {
+	case SPDK_NVME_OPC_READ:
+		type = SPDK_NVMF_IO_STAT_READ;
+		break;
+	case SPDK_NVME_OPC_WRITE:
+		type = SPDK_NVMF_IO_STAT_WRITE;
+		break;
+	default:
+		type = SPDK_NVMF_IO_STAT_OTHER;
+		break;
+	}
+
+	ticks = spdk_get_ticks() - req->start_tsc;
+	units = ticks >> qpair->group->io_stat_tick_shift;
+	bucket = units == 0 ? 0 : spdk_min(spdk_u64log2(units) + 1, SPDK_NVMF_IO_STAT_LATENCY_BUCKETS - 1);
+
+	ns_stat->ops[type]++;
+	ns_stat->bytes[type] += req->length;
+	ns_stat->latency_ticks[type] += ticks;
+	ns_stat->latency_buckets[type][bucket]++;
+	if (spdk_unlikely(rsp->status.sct != SPDK_NVME_SCT_GENERIC ||
+			  rsp->status.sc != SPDK_NVME_SC_SUCCESS)) {
+		ns_stat->errors++;
+	}
+}
+
 static void
 _nvmf_request_complete(void *ctx)
 {
@@ -3272,6 +3542,7 @@ _nvmf_request_complete(void *ctx)
 	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
 	struct spdk_nvmf_qpair *qpair;
 	struct spdk_nvmf_subsystem_poll_group *sgroup = NULL;
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
 	bool is_aer = false;
 
 	rsp->sqid = 0;
@@ -3305,6 +3576,21 @@ _nvmf_request_complete(void *ctx)
 			sgroup->state = SPDK_NVMF_SUBSYSTEM_PAUSED;
 			sgroup->cb_fn(sgroup->cb_arg, 0);
 		}
+
+		ns_info = nvmf_request_get_pg_ns_info(req, sgroup);
+		if (ns_info != NULL) {
+			if (!nvmf_qpair_is_admin_queue(qpair)) {
+				nvmf_request_update_io_stats(req, sgroup);
+			}
+
+			assert(ns_info->io_outstanding > 0);
+			ns_info->io_outstanding--;
+			if (spdk_unlikely(ns_info->state == SPDK_NVMF_SUBSYSTEM_PAUSING &&
+					  ns_info->io_outstanding == 0)) {
+				ns_info->state = SPDK_NVMF_SUBSYSTEM_PAUSED;
+				sgroup->cb_fn(sgroup->cb_arg, 0);
+			}
+		}
 	}
 
 	nvmf_qpair_request_cleanup(qpair);
@@ -3330,6 +3616,7 @@ _nvmf_request_exec(struct spdk_nvmf_request *req,
 		   struct spdk_nvmf_subsystem_poll_group *sgroup)
 {
 	struct spdk_nvmf_qpair *qpair = req->qpair;
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
 	enum spdk_nvmf_request_exec_status status;
 
 	if (SPDK_DEBUGLOG_FLAG_ENABLED("nvmf")) {
@@ -3338,6 +3625,10 @@ _nvmf_request_exec(struct spdk_nvmf_request *req,
 
 	if (sgroup) {
 		sgroup->io_outstanding++;
+		ns_info = nvmf_request_get_pg_ns_info(req, sgroup);
+		if (ns_info != NULL) {
+			ns_info->io_outstanding++;
+		}
 	}
 
 	/* Place the request on the outstanding list so we can keep track of it */
@@ -3361,6 +3652,9 @@ spdk_nvmf_request_exec(struct spdk_nvmf_request *req)
 {
 	struct spdk_nvmf_qpair *qpair = req->qpair;
 	struct spdk_nvmf_subsystem_poll_group *sgroup = NULL;
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
+
+	req->start_tsc = spdk_get_ticks();
 
 	if (qpair->ctrlr) {
 		sgroup = &qpair->group->sgroups[qpair->ctrlr->subsys->id];
@@ -3377,6 +3671,10 @@ spdk_nvmf_request_exec(struct spdk_nvmf_request *req)
 		/* Still increment io_outstanding because request_complete decrements it */
 		if (sgroup != NULL) {
 			sgroup->io_outstanding++;
+			ns_info = nvmf_request_get_pg_ns_info(req, sgroup);
+			if (ns_info != NULL) {
+				ns_info->io_outstanding++;
+			}
 		}
 		_nvmf_request_complete(req);
 		return;
@@ -3389,6 +3687,14 @@ spdk_nvmf_request_exec(struct spdk_nvmf_request *req)
 			TAILQ_INSERT_TAIL(&sgroup->queued, req, link);
 			return;
 		}
+
+		/* Check if just the namespace the request is for is paused */
+		ns_info = nvmf_request_get_pg_ns_info(req, sgroup);
+		if (spdk_unlikely(ns_info != NULL && (ns_info->state == SPDK_NVMF_SUBSYSTEM_PAUSING ||
+						      ns_info->state == SPDK_NVMF_SUBSYSTEM_PAUSED))) {
+			TAILQ_INSERT_TAIL(&sgroup->queued, req, link);
+			return;
+		}
 	}
 
 	_nvmf_request_exec(req, sgroup);
@@ -3507,7 +3813,11 @@ spdk_nvmf_request_get_bdev(uint32_t nsid, struct spdk_nvmf_request *req,
 	}
 
 	assert(group != NULL && group->sgroups != NULL);
-	ns_info = &group->sgroups[ctrlr->subsys->id].ns_info[nsid - 1];
+	ns_info = nvmf_pg_get_ns_info(&group->sgroups[ctrlr->subsys->id], nsid);
+	if (ns_info == NULL) {
+		return -EINVAL;
+	}
+
 	*bdev = ns->bdev;
 	*desc = ns->desc;
 	*ch = ns_info->channel;
@@ -36,6 +36,7 @@
 #include "nvmf_internal.h"
 
 #include "spdk/bdev.h"
+#include "spdk/bdev_zone.h"
 #include "spdk/endian.h"
 #include "spdk/thread.h"
 #include "spdk/likely.h"
@@ -87,6 +88,48 @@ nvmf_ctrlr_write_zeroes_supported(struct spdk_nvmf_ctrlr *ctrlr)
 	return nvmf_subsystem_bdev_io_type_supported(ctrlr->subsys, SPDK_BDEV_IO_TYPE_WRITE_ZEROES);
 }
 
+/* Maximum number of source ranges of a Copy command */
+#define NVMF_BDEV_CTRLR_COPY_MAX_RANGES	128
+/* Maximum number of bytes a Copy command can copy */
+#define NVMF_BDEV_CTRLR_COPY_MAX_LEN	(32 * 1024 * 1024)
+/* Size of the buffer a Copy command reads its source ranges into */
+#define NVMF_BDEV_CTRLR_COPY_BUF_LEN	(128 * 1024)
+
+/*
+ * The bdev layer has no copy I/O type, so Copy is carried out by the target
+ * with reads and writes. Blocks carrying protection information would fail
+ * their reference tag checks once moved, so such bdevs are left out.
+ */
+static bool
+nvmf_bdev_copy_supported(struct spdk_bdev *bdev)
+{
+	return spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_READ) &&
+	       spdk_bdev_io_type_supported(bdev, SPDK_BDEV_IO_TYPE_WRITE) &&
+	       !spdk_bdev_is_zoned(bdev) &&
+	       spdk_bdev_get_dif_type(bdev) == SPDK_DIF_DISABLE;
+}
+
+bool
+nvmf_ctrlr_copy_supported(struct spdk_nvmf_ctrlr *ctrlr)
+{
+	struct spdk_nvmf_ns *ns;
+
+	for (ns = spdk_nvmf_subsystem_get_first_ns(ctrlr->subsys); ns != NULL;
+	     ns = spdk_nvmf_subsystem_get_next_ns(ctrlr->subsys, ns)) {
+		if (ns->bdev != NULL && !nvmf_bdev_copy_supported(ns->bdev)) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+static uint32_t
+nvmf_bdev_ctrlr_copy_max_blocks(struct spdk_bdev *bdev)
+{
+	return NVMF_BDEV_CTRLR_COPY_MAX_LEN / spdk_bdev_get_block_size(bdev);
+}
+
 static void
 nvmf_bdev_ctrlr_complete_cmd(struct spdk_bdev_io *bdev_io, bool success,
 			     void *cb_arg)
@@ -182,6 +225,11 @@ nvmf_bdev_ctrlr_identify_ns(struct spdk_nvmf_ns *ns, struct spdk_nvme_ns_data *n
 		nsdata->lbaf[0].lbads = spdk_u32log2(spdk_bdev_get_data_block_size(bdev));
 	}
 	nsdata->noiob = spdk_bdev_get_optimal_io_boundary(bdev);
+	if (nvmf_bdev_copy_supported(bdev)) {
+		nsdata->mcl = nvmf_bdev_ctrlr_copy_max_blocks(bdev);
+		nsdata->mssrl = spdk_min(nsdata->mcl, UINT16_MAX);
+		nsdata->msrc = NVMF_BDEV_CTRLR_COPY_MAX_RANGES - 1;
+	}
 	nsdata->nmic.can_share = 1;
 	if (ns->ptpl_file != NULL) {
 		nsdata->nsrescap.rescap.persist = 1;
@@ -201,6 +249,24 @@ nvmf_bdev_ctrlr_identify_ns(struct spdk_nvmf_ns *ns, struct spdk_nvme_ns_data *n
 	memcpy(&nsdata->eui64, ns->opts.eui64, sizeof(nsdata->eui64));
 }
 
+void
+nvmf_bdev_ctrlr_identify_iocs_zns(struct spdk_nvmf_ns *ns, struct spdk_nvme_zns_ns_data *nsdata_zns)
+{
+	struct spdk_bdev *bdev = ns->bdev;
+	uint32_t max_open_zones = spdk_bdev_get_max_open_zones(bdev);
+
+	/* MAR and MOR are 0's based, all Fs means there is no limit. */
+	if (max_open_zones != 0) {
+		nsdata_zns->mar = max_open_zones - 1;
+		nsdata_zns->mor = max_open_zones - 1;
+	} else {
+		nsdata_zns->mar = UINT32_MAX;
+		nsdata_zns->mor = UINT32_MAX;
+	}
+
+	nsdata_zns->lbafe[0].zsze = spdk_bdev_get_zone_size(bdev);
+}
+
 static void
 nvmf_bdev_ctrlr_get_rw_params(const struct spdk_nvme_cmd *cmd, uint64_t *start_lba,
 			      uint64_t *num_blocks)
@@ -648,6 +714,792 @@ nvmf_bdev_ctrlr_dsm_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
 }
 
+struct nvmf_bdev_ctrlr_copy_ctx {
+	struct spdk_nvmf_request		*req;
+	struct spdk_bdev			*bdev;
+	struct spdk_bdev_desc			*desc;
+	struct spdk_io_channel			*ch;
+	struct spdk_bdev_io_wait_entry		bdev_io_wait;
+
+	struct spdk_nvme_scc_source_range	*ranges;
+	uint16_t				num_ranges;
+	/* Source range being read and the number of its blocks read so far */
+	uint16_t				range_idx;
+	uint32_t				range_offset;
+	/* Number of blocks of the read in progress */
+	uint32_t				num_read_blocks;
+
+	/* Next destination block */
+	uint64_t				dst_lba;
+
+	/* Source blocks are gathered in buf until it is full, then written out at once */
+	void					*buf;
+	uint32_t				buf_blocks;
+	uint32_t				num_buf_blocks;
+};
+
+static void
+nvmf_bdev_ctrlr_copy_done(struct nvmf_bdev_ctrlr_copy_ctx *ctx, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_nvme_cpl *response = &ctx->req->rsp->nvme_cpl;
+	int sct, sc;
+	uint32_t cdw0;
+
+	if (bdev_io != NULL) {
+		spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
+		response->status.sct = sct;
+		response->status.sc = sc;
+		spdk_bdev_free_io(bdev_io);
+	}
+
+	spdk_nvmf_request_complete(ctx->req);
+	spdk_dma_free(ctx->buf);
+	free(ctx);
+}
+
+static void nvmf_bdev_ctrlr_copy_next(void *arg);
+
+static void
+nvmf_bdev_ctrlr_copy_read_cpl(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct nvmf_bdev_ctrlr_copy_ctx *ctx = cb_arg;
+	uint32_t num_blocks = ctx->num_read_blocks;
+
+	if (!success) {
+		nvmf_bdev_ctrlr_copy_done(ctx, bdev_io);
+		return;
+	}
+
+	spdk_bdev_free_io(bdev_io);
+
+	ctx->num_buf_blocks += num_blocks;
+	ctx->range_offset += num_blocks;
+	if (ctx->range_offset == (uint32_t)ctx->ranges[ctx->range_idx].nlb + 1) {
+		ctx->range_idx++;
+		ctx->range_offset = 0;
+	}
+
+	nvmf_bdev_ctrlr_copy_next(ctx);
+}
+
+static void
+nvmf_bdev_ctrlr_copy_write_cpl(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct nvmf_bdev_ctrlr_copy_ctx *ctx = cb_arg;
+
+	if (!success) {
+		nvmf_bdev_ctrlr_copy_done(ctx, bdev_io);
+		return;
+	}
+
+	spdk_bdev_free_io(bdev_io);
+
+	ctx->dst_lba += ctx->num_buf_blocks;
+	ctx->num_buf_blocks = 0;
+
+	nvmf_bdev_ctrlr_copy_next(ctx);
+}
+
+/*
+ * Reads the source ranges in order into the buffer and writes the buffer to
+ * the destination whenever it fills up or the last range has been read. The
+ * progress is only updated on completion, so a submission that ran out of
+ * bdev_io can simply be retried.
+ */
+static void
+nvmf_bdev_ctrlr_copy_next(void *arg)
+{
+	struct nvmf_bdev_ctrlr_copy_ctx *ctx = arg;
+	struct spdk_nvme_cpl *response = &ctx->req->rsp->nvme_cpl;
+	struct spdk_nvme_scc_source_range *range;
+	uint32_t block_size = spdk_bdev_get_block_size(ctx->bdev);
+	uint32_t num_blocks;
+	int rc;
+
+	if (ctx->num_buf_blocks == ctx->buf_blocks ||
+	    (ctx->range_idx == ctx->num_ranges && ctx->num_buf_blocks > 0)) {
+		rc = spdk_bdev_write_blocks(ctx->desc, ctx->ch, ctx->buf, ctx->dst_lba,
+					    ctx->num_buf_blocks, nvmf_bdev_ctrlr_copy_write_cpl, ctx);
+	} else if (ctx->range_idx < ctx->num_ranges) {
+		range = &ctx->ranges[ctx->range_idx];
+		num_blocks = spdk_min((uint32_t)range->nlb + 1 - ctx->range_offset,
+				      ctx->buf_blocks - ctx->num_buf_blocks);
+		ctx->num_read_blocks = num_blocks;
+		rc = spdk_bdev_read_blocks(ctx->desc, ctx->ch,
+					   (uint8_t *)ctx->buf + (uint64_t)ctx->num_buf_blocks * block_size,
+					   range->slba + ctx->range_offset, num_blocks,
+					   nvmf_bdev_ctrlr_copy_read_cpl, ctx);
+	} else {
+		nvmf_bdev_ctrlr_copy_done(ctx, NULL);
+		return;
+	}
+
+	if (spdk_unlikely(rc != 0)) {
+		if (rc == -ENOMEM) {
+			ctx->bdev_io_wait.bdev = ctx->bdev;
+			ctx->bdev_io_wait.cb_fn = nvmf_bdev_ctrlr_copy_next;
+			ctx->bdev_io_wait.cb_arg = ctx;
+			rc = spdk_bdev_queue_io_wait(ctx->bdev, ctx->ch, &ctx->bdev_io_wait);
+			if (rc == 0) {
+				return;
+			}
+		}
+
+		response->status.sct = SPDK_NVME_SCT_GENERIC;
+		response->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		nvmf_bdev_ctrlr_copy_done(ctx, NULL);
+	}
+}
+
+int
+nvmf_bdev_ctrlr_copy_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+			 struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	uint64_t bdev_num_blocks = spdk_bdev_get_num_blocks(bdev);
+	uint32_t block_size = spdk_bdev_get_block_size(bdev);
+	uint32_t max_blocks = nvmf_bdev_ctrlr_copy_max_blocks(bdev);
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	struct spdk_nvme_scc_source_range *ranges;
+	struct nvmf_bdev_ctrlr_copy_ctx *ctx;
+	uint64_t dst_lba, num_blocks = 0, range_blocks;
+	uint32_t buf_blocks;
+	uint16_t num_ranges, i;
+	uint8_t format;
+
+	rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+	rsp->status.sc = SPDK_NVME_SC_SUCCESS;
+
+	if (!nvmf_bdev_copy_supported(bdev)) {
+		rsp->status.sc = SPDK_NVME_SC_INVALID_OPCODE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	/* SDLBA: CDW10 and CDW11, NR: CDW12 bits 07:00, 0's based, Format: CDW12 bits 11:08 */
+	dst_lba = from_le64(&cmd->cdw10);
+	num_ranges = (from_le32(&cmd->cdw12) & 0xFFu) + 1;
+	format = (from_le32(&cmd->cdw12) >> 8) & 0xFu;
+
+	if (format != 0) {
+		SPDK_ERRLOG("Unsupported copy descriptor format %u\n", format);
+		rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (num_ranges > NVMF_BDEV_CTRLR_COPY_MAX_RANGES) {
+		SPDK_ERRLOG("Copy number of ranges %u > %u\n", num_ranges, NVMF_BDEV_CTRLR_COPY_MAX_RANGES);
+		rsp->status.sct = SPDK_NVME_SCT_COMMAND_SPECIFIC;
+		rsp->status.sc = SPDK_NVME_SC_CMD_SIZE_LIMIT_SIZE_EXCEEDED;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (num_ranges * sizeof(struct spdk_nvme_scc_source_range) > req->length) {
+		SPDK_ERRLOG("Copy number of ranges > SGL length\n");
+		rsp->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	ranges = req->data;
+	for (i = 0; i < num_ranges; i++) {
+		range_blocks = (uint64_t)ranges[i].nlb + 1;
+		num_blocks += range_blocks;
+
+		if (range_blocks > spdk_min(max_blocks, UINT16_MAX) || num_blocks > max_blocks) {
+			SPDK_ERRLOG("Copy length exceeds the namespace copy limits\n");
+			rsp->status.sct = SPDK_NVME_SCT_COMMAND_SPECIFIC;
+			rsp->status.sc = SPDK_NVME_SC_CMD_SIZE_LIMIT_SIZE_EXCEEDED;
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		}
+
+		if (!nvmf_bdev_ctrlr_lba_in_range(bdev_num_blocks, ranges[i].slba, range_blocks)) {
+			SPDK_ERRLOG("end of media\n");
+			rsp->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		}
+	}
+
+	if (!nvmf_bdev_ctrlr_lba_in_range(bdev_num_blocks, dst_lba, num_blocks)) {
+		SPDK_ERRLOG("end of media\n");
+		rsp->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	buf_blocks = spdk_min(num_blocks, spdk_max(NVMF_BDEV_CTRLR_COPY_BUF_LEN / block_size, 1));
+	ctx->buf = spdk_dma_malloc((uint64_t)buf_blocks * block_size, spdk_bdev_get_buf_align(bdev), NULL);
+	if (ctx->buf == NULL) {
+		free(ctx);
+		rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	ctx->req = req;
+	ctx->bdev = bdev;
+	ctx->desc = desc;
+	ctx->ch = ch;
+	ctx->ranges = ranges;
+	ctx->num_ranges = num_ranges;
+	ctx->dst_lba = dst_lba;
+	ctx->buf_blocks = buf_blocks;
+
+	nvmf_bdev_ctrlr_copy_next(ctx);
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+}
+
+static void
+nvmf_bdev_ctrlr_zone_append_complete(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct spdk_nvmf_request	*req = cb_arg;
+	struct spdk_nvme_cpl		*response = &req->rsp->nvme_cpl;
+	int				sct, sc;
+	uint32_t			cdw0;
+	uint64_t			alba;
+
+	spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
+	response->status.sc = sc;
+	response->status.sct = sct;
+
+	if (success) {
+		/* The LBA the data was written to is returned in dwords 0 and 1 of the completion. */
+		alba = spdk_bdev_io_get_append_location(bdev_io);
+		response->cdw0 = (uint32_t)alba;
+		response->rsvd1 = (uint32_t)(alba >> 32);
+	} else {
+		response->cdw0 = cdw0;
+	}
+
+	spdk_nvmf_request_complete(req);
+	spdk_bdev_free_io(bdev_io);
+}
+
+int
+nvmf_bdev_ctrlr_zone_append_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+				struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	uint64_t bdev_num_blocks = spdk_bdev_get_num_blocks(bdev);
+	uint32_t block_size = spdk_bdev_get_block_size(bdev);
+	uint64_t zone_size = spdk_bdev_get_zone_size(bdev);
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	uint64_t start_lba;
+	uint64_t num_blocks;
+	int rc;
+
+	/* ZSLBA and NLB are laid out as in a write. */
+	nvmf_bdev_ctrlr_get_rw_params(cmd, &start_lba, &num_blocks);
+
+	if (spdk_unlikely(!nvmf_bdev_ctrlr_lba_in_range(bdev_num_blocks, start_lba, num_blocks))) {
+		SPDK_ERRLOG("end of media\n");
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(start_lba % zone_size != 0)) {
+		SPDK_ERRLOG("Zone append ZSLBA 0x%" PRIx64 " is not the start of a zone\n", start_lba);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(num_blocks > zone_size)) {
+		SPDK_ERRLOG("Zone append NLB %" PRIu64 " exceeds zone size %" PRIu64 "\n",
+			    num_blocks, zone_size);
+		rsp->status.sct = SPDK_NVME_SCT_COMMAND_SPECIFIC;
+		rsp->status.sc = SPDK_NVME_SC_ZONE_BOUNDARY_ERROR;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(num_blocks * block_size > req->length)) {
+		SPDK_ERRLOG("Zone append NLB %" PRIu64 " * block size %" PRIu32 " > SGL length %" PRIu32 "\n",
+			    num_blocks, block_size, req->length);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	rc = spdk_bdev_zone_appendv(desc, ch, req->iov, req->iovcnt, start_lba, num_blocks,
+				    nvmf_bdev_ctrlr_zone_append_complete, req);
+	if (spdk_unlikely(rc)) {
+		if (rc == -ENOMEM) {
+			nvmf_bdev_ctrl_queue_io(req, bdev, ch, nvmf_ctrlr_process_io_cmd_resubmit, req);
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+		}
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+}
+
+/* Number of zones whose information is retrieved at once when walking all zones. */
+#define NVMF_BDEV_CTRLR_ZONE_INFO_BATCH	64
+
+struct nvmf_bdev_ctrlr_zone_ctx {
+	struct spdk_nvmf_request		*req;
+	struct spdk_bdev			*bdev;
+	struct spdk_bdev_desc			*desc;
+	struct spdk_io_channel			*ch;
+	struct spdk_bdev_io_wait_entry		bdev_io_wait;
+
+	/* First zone of the next batch */
+	uint64_t				zone_id;
+	uint32_t				num_infos;
+	uint32_t				info_idx;
+	struct spdk_bdev_zone_info		infos[NVMF_BDEV_CTRLR_ZONE_INFO_BATCH];
+
+	/* Zone Management Send with Select All */
+	enum spdk_bdev_zone_action		action;
+
+	/* Zone Management Receive */
+	uint8_t					filter;
+	bool					partial;
+	struct spdk_nvme_zns_zone_report	*report;
+	uint32_t				report_len;
+	uint64_t				max_descs;
+	uint64_t				nr_zones;
+};
+
+static void
+nvmf_bdev_ctrlr_zone_ctx_done(struct nvmf_bdev_ctrlr_zone_ctx *ctx, struct spdk_bdev_io *bdev_io)
+{
+	struct spdk_nvme_cpl *response = &ctx->req->rsp->nvme_cpl;
+	int sct, sc;
+	uint32_t cdw0;
+
+	if (bdev_io != NULL) {
+		spdk_bdev_io_get_nvme_status(bdev_io, &cdw0, &sct, &sc);
+		response->status.sct = sct;
+		response->status.sc = sc;
+		spdk_bdev_free_io(bdev_io);
+	}
+
+	spdk_nvmf_request_complete(ctx->req);
+	free(ctx->report);
+	free(ctx);
+}
+
+static void
+nvmf_bdev_ctrlr_zone_ctx_submit_failed(struct nvmf_bdev_ctrlr_zone_ctx *ctx, int rc,
+				       spdk_bdev_io_wait_cb retry_fn)
+{
+	struct spdk_nvme_cpl *response = &ctx->req->rsp->nvme_cpl;
+
+	if (rc == -ENOMEM) {
+		ctx->bdev_io_wait.bdev = ctx->bdev;
+		ctx->bdev_io_wait.cb_fn = retry_fn;
+		ctx->bdev_io_wait.cb_arg = ctx;
+		rc = spdk_bdev_queue_io_wait(ctx->bdev, ctx->ch, &ctx->bdev_io_wait);
+		if (rc == 0) {
+			return;
+		}
+	}
+
+	response->status.sct = SPDK_NVME_SCT_GENERIC;
+	response->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+	nvmf_bdev_ctrlr_zone_ctx_done(ctx, NULL);
+}
+
+static int
+nvmf_bdev_ctrlr_zone_get_infos(struct nvmf_bdev_ctrlr_zone_ctx *ctx,
+			       spdk_bdev_io_completion_cb cb_fn)
+{
+	uint64_t zone_size = spdk_bdev_get_zone_size(ctx->bdev);
+	uint64_t num_zones;
+	int rc;
+
+	num_zones = (spdk_bdev_get_num_blocks(ctx->bdev) - ctx->zone_id) / zone_size;
+	num_zones = spdk_min(num_zones, NVMF_BDEV_CTRLR_ZONE_INFO_BATCH);
+
+	ctx->num_infos = num_zones;
+	ctx->info_idx = 0;
+	ctx->zone_id += num_zones * zone_size;
+
+	rc = spdk_bdev_get_zone_info(ctx->desc, ctx->ch, ctx->zone_id - num_zones * zone_size,
+				     num_zones, ctx->infos, cb_fn, ctx);
+	if (rc != 0) {
+		/* Retry the same batch */
+		ctx->num_infos = 0;
+		ctx->zone_id -= num_zones * zone_size;
+	}
+
+	return rc;
+}
+
+static bool
+nvmf_bdev_ctrlr_zone_action_applies(enum spdk_bdev_zone_action action,
+				    enum spdk_bdev_zone_state state)
+{
+	switch (action) {
+	case SPDK_BDEV_ZONE_CLOSE:
+		return state == SPDK_BDEV_ZONE_STATE_OPEN;
+	case SPDK_BDEV_ZONE_FINISH:
+		return state == SPDK_BDEV_ZONE_STATE_OPEN || state == SPDK_BDEV_ZONE_STATE_CLOSED;
+	case SPDK_BDEV_ZONE_OPEN:
+		return state == SPDK_BDEV_ZONE_STATE_CLOSED;
+	case SPDK_BDEV_ZONE_RESET:
+		return state == SPDK_BDEV_ZONE_STATE_OPEN || state == SPDK_BDEV_ZONE_STATE_CLOSED ||
+		       state == SPDK_BDEV_ZONE_STATE_FULL;
+	default:
+		return false;
+	}
+}
+
+static void nvmf_bdev_ctrlr_zone_send_all_next(void *arg);
+
+static void
+nvmf_bdev_ctrlr_zone_send_all_cpl(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct nvmf_bdev_ctrlr_zone_ctx *ctx = cb_arg;
+
+	if (!success) {
+		nvmf_bdev_ctrlr_zone_ctx_done(ctx, bdev_io);
+		return;
+	}
+
+	spdk_bdev_free_io(bdev_io);
+	nvmf_bdev_ctrlr_zone_send_all_next(ctx);
+}
+
+/*
+ * Applies the action to every zone in a state the action is valid for, one
+ * zone at a time, as the Select All bit of Zone Management Send asks for.
+ */
+static void
+nvmf_bdev_ctrlr_zone_send_all_next(void *arg)
+{
+	struct nvmf_bdev_ctrlr_zone_ctx *ctx = arg;
+	struct spdk_bdev_zone_info *info;
+	int rc;
+
+	while (ctx->info_idx < ctx->num_infos) {
+		info = &ctx->infos[ctx->info_idx];
+		if (!nvmf_bdev_ctrlr_zone_action_applies(ctx->action, info->state)) {
+			ctx->info_idx++;
+			continue;
+		}
+
+		rc = spdk_bdev_zone_management(ctx->desc, ctx->ch, info->zone_id, ctx->action,
+					       nvmf_bdev_ctrlr_zone_send_all_cpl, ctx);
+		if (rc != 0) {
+			nvmf_bdev_ctrlr_zone_ctx_submit_failed(ctx, rc, nvmf_bdev_ctrlr_zone_send_all_next);
+			return;
+		}
+
+		ctx->info_idx++;
+		return;
+	}
+
+	if (ctx->zone_id >= spdk_bdev_get_num_blocks(ctx->bdev)) {
+		nvmf_bdev_ctrlr_zone_ctx_done(ctx, NULL);
+		return;
+	}
+
+	rc = nvmf_bdev_ctrlr_zone_get_infos(ctx, nvmf_bdev_ctrlr_zone_send_all_cpl);
+	if (rc != 0) {
+		nvmf_bdev_ctrlr_zone_ctx_submit_failed(ctx, rc, nvmf_bdev_ctrlr_zone_send_all_next);
+	}
+}
+
+static struct nvmf_bdev_ctrlr_zone_ctx *
+nvmf_bdev_ctrlr_zone_ctx_alloc(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+			       struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	struct nvmf_bdev_ctrlr_zone_ctx *ctx;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return NULL;
+	}
+
+	ctx->req = req;
+	ctx->bdev = bdev;
+	ctx->desc = desc;
+	ctx->ch = ch;
+
+	return ctx;
+}
+
+int
+nvmf_bdev_ctrlr_zone_mgmt_send_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+				   struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	uint64_t bdev_num_blocks = spdk_bdev_get_num_blocks(bdev);
+	uint64_t zone_size = spdk_bdev_get_zone_size(bdev);
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	struct nvmf_bdev_ctrlr_zone_ctx *ctx;
+	enum spdk_bdev_zone_action action;
+	uint64_t start_lba;
+	uint8_t zsa;
+	bool select_all;
+	int rc;
+
+	/* SLBA: CDW10 and CDW11, ZSA: CDW13 bits 07:00, Select All: CDW13 bit 08 */
+	start_lba = from_le64(&cmd->cdw10);
+	zsa = from_le32(&cmd->cdw13) & 0xFFu;
+	select_all = (from_le32(&cmd->cdw13) >> 8) & 0x1u;
+
+	switch (zsa) {
+	case SPDK_NVME_ZONE_CLOSE:
+		action = SPDK_BDEV_ZONE_CLOSE;
+		break;
+	case SPDK_NVME_ZONE_FINISH:
+		action = SPDK_BDEV_ZONE_FINISH;
+		break;
+	case SPDK_NVME_ZONE_OPEN:
+		action = SPDK_BDEV_ZONE_OPEN;
+		break;
+	case SPDK_NVME_ZONE_RESET:
+		action = SPDK_BDEV_ZONE_RESET;
+		break;
+	default:
+		/* Offline has no bdev counterpart. */
+		SPDK_ERRLOG("Unsupported zone send action 0x%x\n", zsa);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (select_all) {
+		ctx = nvmf_bdev_ctrlr_zone_ctx_alloc(bdev, desc, ch, req);
+		if (ctx == NULL) {
+			rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+			rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+		}
+
+		ctx->action = action;
+		nvmf_bdev_ctrlr_zone_send_all_next(ctx);
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+	}
+
+	if (spdk_unlikely(start_lba >= bdev_num_blocks)) {
+		SPDK_ERRLOG("end of media\n");
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(start_lba % zone_size != 0)) {
+		SPDK_ERRLOG("Zone send SLBA 0x%" PRIx64 " is not the start of a zone\n", start_lba);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	rc = spdk_bdev_zone_management(desc, ch, start_lba, action, nvmf_bdev_ctrlr_complete_cmd, req);
+	if (spdk_unlikely(rc)) {
+		if (rc == -ENOMEM) {
+			nvmf_bdev_ctrl_queue_io(req, bdev, ch, nvmf_ctrlr_process_io_cmd_resubmit, req);
+			return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+		}
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+}
+
+static bool
+nvmf_bdev_ctrlr_zone_report_match(uint8_t filter, enum spdk_bdev_zone_state state)
+{
+	switch (filter) {
+	case SPDK_NVME_ZRA_LIST_ALL:
+		return true;
+	case SPDK_NVME_ZRA_LIST_ZSE:
+		return state == SPDK_BDEV_ZONE_STATE_EMPTY;
+	case SPDK_NVME_ZRA_LIST_ZSIO:
+		return state == SPDK_BDEV_ZONE_STATE_OPEN;
+	case SPDK_NVME_ZRA_LIST_ZSC:
+		return state == SPDK_BDEV_ZONE_STATE_CLOSED;
+	case SPDK_NVME_ZRA_LIST_ZSF:
+		return state == SPDK_BDEV_ZONE_STATE_FULL;
+	case SPDK_NVME_ZRA_LIST_ZSRO:
+		return state == SPDK_BDEV_ZONE_STATE_READ_ONLY;
+	case SPDK_NVME_ZRA_LIST_ZSO:
+		return state == SPDK_BDEV_ZONE_STATE_OFFLINE;
+	default:
+		return false;
+	}
+}
+
+static void
+nvmf_bdev_ctrlr_zone_fill_desc(struct spdk_nvme_zns_zone_desc *desc,
+			       const struct spdk_bdev_zone_info *info)
+{
+	desc->zt = SPDK_NVME_ZONE_TYPE_SEQWR;
+	desc->zcap = info->capacity;
+	desc->zslba = info->zone_id;
+	desc->wp = info->write_pointer;
+
+	/*
+	 * The bdev layer doesn't tell implicitly and explicitly opened zones
+	 * apart, so open zones are reported as implicitly opened.
+	 */
+	switch (info->state) {
+	case SPDK_BDEV_ZONE_STATE_EMPTY:
+		desc->zs = SPDK_NVME_ZONE_STATE_EMPTY;
+		break;
+	case SPDK_BDEV_ZONE_STATE_OPEN:
+		desc->zs = SPDK_NVME_ZONE_STATE_IOPEN;
+		break;
+	case SPDK_BDEV_ZONE_STATE_FULL:
+		desc->zs = SPDK_NVME_ZONE_STATE_FULL;
+		break;
+	case SPDK_BDEV_ZONE_STATE_CLOSED:
+		desc->zs = SPDK_NVME_ZONE_STATE_CLOSED;
+		break;
+	case SPDK_BDEV_ZONE_STATE_READ_ONLY:
+		desc->zs = SPDK_NVME_ZONE_STATE_RONLY;
+		break;
+	case SPDK_BDEV_ZONE_STATE_OFFLINE:
+		desc->zs = SPDK_NVME_ZONE_STATE_OFFLINE;
+		break;
+	}
+}
+
+static void nvmf_bdev_ctrlr_zone_report_next(void *arg);
+
+static void
+nvmf_bdev_ctrlr_zone_report_cpl(struct spdk_bdev_io *bdev_io, bool success, void *cb_arg)
+{
+	struct nvmf_bdev_ctrlr_zone_ctx *ctx = cb_arg;
+
+	if (!success) {
+		nvmf_bdev_ctrlr_zone_ctx_done(ctx, bdev_io);
+		return;
+	}
+
+	spdk_bdev_free_io(bdev_io);
+	nvmf_bdev_ctrlr_zone_report_next(ctx);
+}
+
+static void
+nvmf_bdev_ctrlr_zone_report_next(void *arg)
+{
+	struct nvmf_bdev_ctrlr_zone_ctx *ctx = arg;
+	struct spdk_bdev_zone_info *info;
+	struct iovec iov;
+	int rc;
+
+	for (; ctx->info_idx < ctx->num_infos; ctx->info_idx++) {
+		info = &ctx->infos[ctx->info_idx];
+		if (!nvmf_bdev_ctrlr_zone_report_match(ctx->filter, info->state)) {
+			continue;
+		}
+
+		if (ctx->nr_zones < ctx->max_descs) {
+			nvmf_bdev_ctrlr_zone_fill_desc(&ctx->report->descs[ctx->nr_zones], info);
+		} else if (ctx->partial) {
+			break;
+		}
+		ctx->nr_zones++;
+	}
+
+	/*
+	 * Without Partial Report, the number of zones counts all matching zones
+	 * from SLBA on, not only the ones that fit in the buffer.
+	 */
+	if ((ctx->partial && ctx->nr_zones == ctx->max_descs) ||
+	    ctx->zone_id >= spdk_bdev_get_num_blocks(ctx->bdev)) {
+		ctx->report->nr_zones = ctx->nr_zones;
+		iov.iov_base = ctx->report;
+		iov.iov_len = ctx->report_len;
+		spdk_iovcpy(&iov, 1, ctx->req->iov, ctx->req->iovcnt);
+		nvmf_bdev_ctrlr_zone_ctx_done(ctx, NULL);
+		return;
+	}
+
+	rc = nvmf_bdev_ctrlr_zone_get_infos(ctx, nvmf_bdev_ctrlr_zone_report_cpl);
+	if (rc != 0) {
+		nvmf_bdev_ctrlr_zone_ctx_submit_failed(ctx, rc, nvmf_bdev_ctrlr_zone_report_next);
+	}
+}
+
+int
+nvmf_bdev_ctrlr_zone_mgmt_recv_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+				   struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
+{
+	uint64_t bdev_num_blocks = spdk_bdev_get_num_blocks(bdev);
+	uint64_t zone_size = spdk_bdev_get_zone_size(bdev);
+	struct spdk_nvme_cmd *cmd = &req->cmd->nvme_cmd;
+	struct spdk_nvme_cpl *rsp = &req->rsp->nvme_cpl;
+	struct nvmf_bdev_ctrlr_zone_ctx *ctx;
+	uint64_t start_lba, len, report_size;
+	uint32_t cdw13;
+	uint8_t zra;
+
+	/* SLBA: CDW10 and CDW11, NUMD: CDW12 0's based */
+	start_lba = from_le64(&cmd->cdw10);
+	len = ((uint64_t)from_le32(&cmd->cdw12) + 1) * 4;
+
+	/* ZRA: CDW13 bits 07:00, ZRASF: bits 15:08, Partial Report: bit 16 */
+	cdw13 = from_le32(&cmd->cdw13);
+	zra = cdw13 & 0xFFu;
+
+	if (zra != SPDK_NVME_ZONE_REPORT || ((cdw13 >> 8) & 0xFFu) > SPDK_NVME_ZRA_LIST_ZSO) {
+		/* Extended reports need zone descriptor extensions, which are not supported. */
+		SPDK_ERRLOG("Unsupported zone receive action 0x%x or filter 0x%x\n", zra,
+			    (cdw13 >> 8) & 0xFFu);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_INVALID_FIELD;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(len > req->length)) {
+		SPDK_ERRLOG("Zone receive NUMD %" PRIu64 " bytes > SGL length %" PRIu32 "\n",
+			    len, req->length);
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	if (spdk_unlikely(start_lba >= bdev_num_blocks)) {
+		SPDK_ERRLOG("end of media\n");
+		rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+		rsp->status.sc = SPDK_NVME_SC_LBA_OUT_OF_RANGE;
+		return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+	}
+
+	ctx = nvmf_bdev_ctrlr_zone_ctx_alloc(bdev, desc, ch, req);
+	if (ctx == NULL) {
+		goto nomem;
+	}
+
+	ctx->max_descs = len > sizeof(struct spdk_nvme_zns_zone_report) ?
+			 (len - sizeof(struct spdk_nvme_zns_zone_report)) /
+			 sizeof(struct spdk_nvme_zns_zone_desc) : 0;
+	report_size = sizeof(struct spdk_nvme_zns_zone_report) +
+		      ctx->max_descs * sizeof(struct spdk_nvme_zns_zone_desc);
+	ctx->report_len = spdk_min(len, report_size);
+	ctx->report = calloc(1, report_size);
+	if (ctx->report == NULL) {
+		free(ctx);
+		goto nomem;
+	}
+
+	/* The report starts with the zone containing SLBA. */
+	ctx->zone_id = start_lba - start_lba % zone_size;
+	ctx->filter = (cdw13 >> 8) & 0xFFu;
+	ctx->partial = (cdw13 >> 16) & 0x1u;
+
+	nvmf_bdev_ctrlr_zone_report_next(ctx);
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS;
+
+nomem:
+	rsp->status.sct = SPDK_NVME_SCT_GENERIC;
+	rsp->status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+	return SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE;
+}
+
 int
 nvmf_bdev_ctrlr_nvme_passthru_io(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 				 struct spdk_io_channel *ch, struct spdk_nvmf_request *req)
@@ -107,6 +107,18 @@ nvmf_poll_group_poll(void *ctx)
 	return count > 0 ? SPDK_POLLER_BUSY : SPDK_POLLER_IDLE;
 }
 
+static void
+nvmf_sgroup_free_io_stats(struct spdk_nvmf_subsystem_poll_group *sgroup)
+{
+	struct spdk_nvmf_host_io_stats *stats, *tmp;
+
+	TAILQ_FOREACH_SAFE(stats, &sgroup->host_stats, link, tmp) {
+		TAILQ_REMOVE(&sgroup->host_stats, stats, link);
+		free(stats->ns);
+		free(stats);
+	}
+}
+
 static int
 nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 {
@@ -117,6 +129,7 @@ nvmf_tgt_create_poll_group(void *io_device, void *ctx_buf)
 
 	TAILQ_INIT(&group->tgroups);
 	TAILQ_INIT(&group->qpairs);
+	group->io_stat_tick_shift = spdk_u64log2(spdk_max(spdk_get_ticks_hz() / SPDK_SEC_TO_USEC, 1));
 
 	TAILQ_FOREACH(transport, &tgt->transports, link) {
 		nvmf_poll_group_add_transport(group, transport);
@@ -181,6 +194,7 @@ nvmf_tgt_destroy_poll_group(void *io_device, void *ctx_buf)
 		}
 
 		free(sgroup->ns_info);
+		nvmf_sgroup_free_io_stats(sgroup);
 	}
 
 	free(group->sgroups);
@@ -1082,19 +1096,120 @@ nvmf_poll_group_add_transport(struct spdk_nvmf_poll_group *group,
 	return 0;
 }
 
+static void
+nvmf_pg_ns_info_clear(struct spdk_nvmf_subsystem_pg_ns_info *ns_info)
+{
+	uint64_t io_outstanding = ns_info->io_outstanding;
+	enum spdk_nvmf_subsystem_state state = ns_info->state;
+
+	/* The pause state of the namespace outlives the namespace it refers to. */
+	memset(ns_info, 0, sizeof(*ns_info));
+	ns_info->io_outstanding = io_outstanding;
+	ns_info->state = state;
+}
+
+static int
+poll_group_update_ns(struct spdk_nvmf_poll_group *group,
+		     struct spdk_nvmf_subsystem *subsystem,
+		     uint32_t nsid, bool *ns_changed)
+{
+	struct spdk_nvmf_subsystem_poll_group *sgroup = &group->sgroups[subsystem->id];
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info = &sgroup->ns_info[nsid - 1];
+	struct spdk_nvmf_ns *ns = subsystem->ns[nsid - 1];
+	struct spdk_nvmf_registrant *reg, *tmp;
+	struct spdk_io_channel *ch;
+	uint32_t j;
+
+	ch = ns_info->channel;
+
+	if (ns == NULL && ch == NULL) {
+		/* Both NULL. Leave empty */
+	} else if (ns == NULL && ch != NULL) {
+		/* There was a channel here, but the namespace is gone. */
+		*ns_changed = true;
+		spdk_put_io_channel(ch);
+		ns_info->channel = NULL;
+	} else if (ns != NULL && ch == NULL) {
+		/* A namespace appeared but there is no channel yet */
+		*ns_changed = true;
+		ch = spdk_bdev_get_io_channel(ns->desc);
+		if (ch == NULL) {
+			SPDK_ERRLOG("Could not allocate I/O channel.\n");
+			return -ENOMEM;
+		}
+		ns_info->channel = ch;
+	} else if (spdk_uuid_compare(&ns_info->uuid, spdk_bdev_get_uuid(ns->bdev)) != 0) {
+		/* A namespace was here before, but was replaced by a new one. */
+		*ns_changed = true;
+		spdk_put_io_channel(ns_info->channel);
+		nvmf_pg_ns_info_clear(ns_info);
+
+		ch = spdk_bdev_get_io_channel(ns->desc);
+		if (ch == NULL) {
+			SPDK_ERRLOG("Could not allocate I/O channel.\n");
+			return -ENOMEM;
+		}
+		ns_info->channel = ch;
+	} else if (ns_info->num_blocks != spdk_bdev_get_num_blocks(ns->bdev)) {
+		/* Namespace is still there but size has changed */
+		SPDK_DEBUGLOG(nvmf, "Namespace resized: subsystem_id %d,"
+			      " nsid %u, pg %p, old %lu, new %lu\n",
+			      subsystem->id,
+			      ns->nsid,
+			      group,
+			      ns_info->num_blocks,
+			      spdk_bdev_get_num_blocks(ns->bdev));
+		*ns_changed = true;
+	}
+
+	if (ns == NULL) {
+		nvmf_pg_ns_info_clear(ns_info);
+	} else {
+		ns_info->uuid = *spdk_bdev_get_uuid(ns->bdev);
+		ns_info->num_blocks = spdk_bdev_get_num_blocks(ns->bdev);
+		ns_info->crkey = ns->crkey;
+		ns_info->rtype = ns->rtype;
+		if (ns->holder) {
+			ns_info->holder_id = ns->holder->hostid;
+		}
+
+		memset(&ns_info->reg_hostid, 0, SPDK_NVMF_MAX_NUM_REGISTRANTS * sizeof(struct spdk_uuid));
+		j = 0;
+		TAILQ_FOREACH_SAFE(reg, &ns->registrants, link, tmp) {
+			if (j >= SPDK_NVMF_MAX_NUM_REGISTRANTS) {
+				SPDK_ERRLOG("Maximum %u registrants can support.\n", SPDK_NVMF_MAX_NUM_REGISTRANTS);
+				return -EINVAL;
+			}
+			ns_info->reg_hostid[j++] = reg->hostid;
+		}
+	}
+
+	return 0;
+}
+
+static void
+poll_group_ns_changed(struct spdk_nvmf_poll_group *group,
+		      struct spdk_nvmf_subsystem *subsystem)
+{
+	struct spdk_nvmf_ctrlr *ctrlr;
+
+	TAILQ_FOREACH(ctrlr, &subsystem->ctrlrs, link) {
+		if (ctrlr->admin_qpair->group == group) {
+			nvmf_ctrlr_async_event_ns_notice(ctrlr);
+		}
+	}
+}
+
 static int
 poll_group_update_subsystem(struct spdk_nvmf_poll_group *group,
 			    struct spdk_nvmf_subsystem *subsystem)
 {
 	struct spdk_nvmf_subsystem_poll_group *sgroup;
 	uint32_t new_num_ns, old_num_ns;
-	uint32_t i, j;
-	struct spdk_nvmf_ns *ns;
-	struct spdk_nvmf_registrant *reg, *tmp;
-	struct spdk_io_channel *ch;
+	uint32_t i;
 	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
-	struct spdk_nvmf_ctrlr *ctrlr;
 	bool ns_changed;
+	int rc;
 
 	/* Make sure our poll group has memory for this subsystem allocated */
 	if (subsystem->id >= group->num_sgroups) {
@@ -1162,79 +1277,14 @@ poll_group_update_subsystem(struct spdk_nvmf_poll_group *group,
 
 	/* Detect bdevs that were added or removed */
 	for (i = 0; i < sgroup->num_ns; i++) {
-		ns = subsystem->ns[i];
-		ns_info = &sgroup->ns_info[i];
-		ch = ns_info->channel;
-
-		if (ns == NULL && ch == NULL) {
-			/* Both NULL. Leave empty */
-		} else if (ns == NULL && ch != NULL) {
-			/* There was a channel here, but the namespace is gone. */
-			ns_changed = true;
-			spdk_put_io_channel(ch);
-			ns_info->channel = NULL;
-		} else if (ns != NULL && ch == NULL) {
-			/* A namespace appeared but there is no channel yet */
-			ns_changed = true;
-			ch = spdk_bdev_get_io_channel(ns->desc);
-			if (ch == NULL) {
-				SPDK_ERRLOG("Could not allocate I/O channel.\n");
-				return -ENOMEM;
-			}
-			ns_info->channel = ch;
-		} else if (spdk_uuid_compare(&ns_info->uuid, spdk_bdev_get_uuid(ns->bdev)) != 0) {
-			/* A namespace was here before, but was replaced by a new one. */
-			ns_changed = true;
-			spdk_put_io_channel(ns_info->channel);
-			memset(ns_info, 0, sizeof(*ns_info));
-
-			ch = spdk_bdev_get_io_channel(ns->desc);
-			if (ch == NULL) {
-				SPDK_ERRLOG("Could not allocate I/O channel.\n");
-				return -ENOMEM;
-			}
-			ns_info->channel = ch;
-		} else if (ns_info->num_blocks != spdk_bdev_get_num_blocks(ns->bdev)) {
-			/* Namespace is still there but size has changed */
-			SPDK_DEBUGLOG(nvmf, "Namespace resized: subsystem_id %d,"
-				      " nsid %u, pg %p, old %lu, new %lu\n",
-				      subsystem->id,
-				      ns->nsid,
-				      group,
-				      ns_info->num_blocks,
-				      spdk_bdev_get_num_blocks(ns->bdev));
-			ns_changed = true;
-		}
-
-		if (ns == NULL) {
-			memset(ns_info, 0, sizeof(*ns_info));
-		} else {
-			ns_info->uuid = *spdk_bdev_get_uuid(ns->bdev);
-			ns_info->num_blocks = spdk_bdev_get_num_blocks(ns->bdev);
-			ns_info->crkey = ns->crkey;
-			ns_info->rtype = ns->rtype;
-			if (ns->holder) {
-				ns_info->holder_id = ns->holder->hostid;
-			}
-
-			memset(&ns_info->reg_hostid, 0, SPDK_NVMF_MAX_NUM_REGISTRANTS * sizeof(struct spdk_uuid));
-			j = 0;
-			TAILQ_FOREACH_SAFE(reg, &ns->registrants, link, tmp) {
-				if (j >= SPDK_NVMF_MAX_NUM_REGISTRANTS) {
-					SPDK_ERRLOG("Maximum %u registrants can support.\n", SPDK_NVMF_MAX_NUM_REGISTRANTS);
-					return -EINVAL;
-				}
-				ns_info->reg_hostid[j++] = reg->hostid;
-			}
+		rc = poll_group_update_ns(group, subsystem, i + 1, &ns_changed);
+		if (rc) {
+			return rc;
 		}
 	}
 
 	if (ns_changed) {
-		TAILQ_FOREACH(ctrlr, &subsystem->ctrlrs, link) {
-			if (ctrlr->admin_qpair->group == group) {
-				nvmf_ctrlr_async_event_ns_notice(ctrlr);
-			}
-		}
+		poll_group_ns_changed(group, subsystem);
 	}
 
 	return 0;
@@ -1256,6 +1306,7 @@ nvmf_poll_group_add_subsystem(struct spdk_nvmf_poll_group *group,
 	struct spdk_nvmf_subsystem_poll_group *sgroup = &group->sgroups[subsystem->id];
 
 	TAILQ_INIT(&sgroup->queued);
+	TAILQ_INIT(&sgroup->host_stats);
 
 	rc = poll_group_update_subsystem(group, subsystem);
 	if (rc) {
@@ -1303,6 +1354,8 @@ _nvmf_poll_group_remove_subsystem_cb(void *ctx, int status)
 	sgroup->num_ns = 0;
 	free(sgroup->ns_info);
 	sgroup->ns_info = NULL;
+	/* All the qpairs of the subsystem are gone, so nothing points to the statistics anymore. */
+	nvmf_sgroup_free_io_stats(sgroup);
 fini:
 	free(qpair_ctx);
 	if (cpl_fn) {
@@ -1433,6 +1486,7 @@ nvmf_poll_group_resume_subsystem(struct spdk_nvmf_poll_group *group,
 {
 	struct spdk_nvmf_request *req, *tmp;
 	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	TAILQ_HEAD(, spdk_nvmf_request) queued;
 	int rc = 0;
 
 	if (subsystem->id >= group->num_sgroups) {
@@ -1453,9 +1507,124 @@ nvmf_poll_group_resume_subsystem(struct spdk_nvmf_poll_group *group,
 
 	sgroup->state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
 
-	/* Release all queued requests */
+	/* Release all queued requests. Requests to a paused namespace are queued again. */
+	TAILQ_INIT(&queued);
+	TAILQ_SWAP(&queued, &sgroup->queued, spdk_nvmf_request, link);
+	TAILQ_FOREACH_SAFE(req, &queued, link, tmp) {
+		TAILQ_REMOVE(&queued, req, link);
+		spdk_nvmf_request_exec(req);
+	}
+fini:
+	if (cb_fn) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+void
+nvmf_poll_group_pause_ns(struct spdk_nvmf_poll_group *group,
+			 struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			 spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg)
+{
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	struct spdk_nvmf_subsystem_pg_ns_info *ns_info;
+	int rc = 0;
+
+	if (subsystem->id >= group->num_sgroups) {
+		rc = -1;
+		goto fini;
+	}
+
+	sgroup = &group->sgroups[subsystem->id];
+
+	/* NOTE: This implicitly also checks for 0, since 0 - 1 wraps around to UINT32_MAX. */
+	if (nsid - 1 >= sgroup->num_ns) {
+		/* This group has never seen the namespace, there is nothing to drain. */
+		goto fini;
+	}
+
+	ns_info = &sgroup->ns_info[nsid - 1];
+	if (ns_info->state == SPDK_NVMF_SUBSYSTEM_PAUSED) {
+		goto fini;
+	}
+	ns_info->state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+
+	if (ns_info->io_outstanding > 0) {
+		/* Namespace state changes are serialized with the subsystem ones. */
+		sgroup->cb_fn = cb_fn;
+		sgroup->cb_arg = cb_arg;
+		return;
+	}
+
+	ns_info->state = SPDK_NVMF_SUBSYSTEM_PAUSED;
+fini:
+	if (cb_fn) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+void
+nvmf_poll_group_resume_ns(struct spdk_nvmf_poll_group *group,
+			  struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			  spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg)
+{
+	struct spdk_nvmf_request *req, *tmp;
+	struct spdk_nvmf_subsystem_poll_group *sgroup;
+	struct spdk_nvmf_ctrlr *ctrlr;
+	TAILQ_HEAD(, spdk_nvmf_request) queued;
+	bool ns_changed = false;
+	int rc = 0;
+
+	if (subsystem->id >= group->num_sgroups) {
+		rc = -1;
+		goto fini;
+	}
+
+	sgroup = &group->sgroups[subsystem->id];
+
+	if (sgroup->state == SPDK_NVMF_SUBSYSTEM_INACTIVE) {
+		/* Adding the subsystem to the poll group will pick up the namespace. */
+		goto fini;
+	}
+
+	if (nsid - 1 >= sgroup->num_ns) {
+		/* The namespace array grew, the whole subsystem has to be refreshed. */
+		rc = poll_group_update_subsystem(group, subsystem);
+		goto fini;
+	}
+
+	/* Only the namespace that changed is refreshed, the others are left untouched. */
+	rc = poll_group_update_ns(group, subsystem, nsid, &ns_changed);
+	if (rc) {
+		goto fini;
+	}
+
+	if (ns_changed) {
+		TAILQ_FOREACH(ctrlr, &subsystem->ctrlrs, link) {
+			if (ctrlr->admin_qpair->group == group) {
+				nvmf_ctrlr_ns_changed(ctrlr, nsid);
+				nvmf_ctrlr_async_event_ns_notice(ctrlr);
+			}
+		}
+	}
+
+	sgroup->ns_info[nsid - 1].state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+
+	if (sgroup->state != SPDK_NVMF_SUBSYSTEM_ACTIVE) {
+		/* The subsystem resume will release the requests. */
+		goto fini;
+	}
+
+	/* Release the requests queued for this namespace */
+	TAILQ_INIT(&queued);
 	TAILQ_FOREACH_SAFE(req, &sgroup->queued, link, tmp) {
-		TAILQ_REMOVE(&sgroup->queued, req, link);
+		if (req->cmd->nvme_cmd.nsid == nsid) {
+			TAILQ_REMOVE(&sgroup->queued, req, link);
+			TAILQ_INSERT_TAIL(&queued, req, link);
+		}
+	}
+
+	TAILQ_FOREACH_SAFE(req, &queued, link, tmp) {
+		TAILQ_REMOVE(&queued, req, link);
 		spdk_nvmf_request_exec(req);
 	}
 fini:
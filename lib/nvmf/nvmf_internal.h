@@ -132,15 +132,54 @@ struct spdk_nvmf_subsystem_pg_ns_info {
 	/* Host ID for the registrants with the namespace */
 	struct spdk_uuid		reg_hostid[SPDK_NVMF_MAX_NUM_REGISTRANTS];
 	uint64_t			num_blocks;
+
+	/* I/O outstanding to this namespace, used to pause just this namespace */
+	uint64_t			io_outstanding;
+	/* PAUSING or PAUSED while paused by spdk_nvmf_subsystem_pause_ns() */
+	enum spdk_nvmf_subsystem_state	state;
 };
 
 typedef void(*spdk_nvmf_poll_group_mod_done)(void *cb_arg, int status);
 
+enum spdk_nvmf_io_stat_type {
+	SPDK_NVMF_IO_STAT_READ,
+	SPDK_NVMF_IO_STAT_WRITE,
+	SPDK_NVMF_IO_STAT_OTHER,
+	SPDK_NVMF_IO_STAT_NUM_TYPES,
+};
+
+/*
+ * Bucket 0 counts the I/O that took less than 1 << group->io_stat_tick_shift ticks (about
+ * a microsecond) and each following bucket covers twice the time of the previous one.
+ */
+#define SPDK_NVMF_IO_STAT_LATENCY_BUCKETS	32
+
+struct spdk_nvmf_ns_io_stat {
+	uint64_t	ops[SPDK_NVMF_IO_STAT_NUM_TYPES];
+	uint64_t	bytes[SPDK_NVMF_IO_STAT_NUM_TYPES];
+	uint64_t	latency_ticks[SPDK_NVMF_IO_STAT_NUM_TYPES];
+	uint64_t	latency_buckets[SPDK_NVMF_IO_STAT_NUM_TYPES][SPDK_NVMF_IO_STAT_LATENCY_BUCKETS];
+	uint64_t	errors;
+};
+
+/* I/O statistics of a host for each namespace of a subsystem, kept by each poll group */
+struct spdk_nvmf_host_io_stats {
+	char					hostnqn[SPDK_NVMF_NQN_MAX_LEN + 1];
+	/* Array of statistics indexed by nsid - 1 */
+	struct spdk_nvmf_ns_io_stat		*ns;
+	uint32_t				num_ns;
+
+	TAILQ_ENTRY(spdk_nvmf_host_io_stats)	link;
+};
+
 struct spdk_nvmf_subsystem_poll_group {
 	/* Array of namespace information for each namespace indexed by nsid - 1 */
 	struct spdk_nvmf_subsystem_pg_ns_info	*ns_info;
 	uint32_t				num_ns;
 
+	/* I/O statistics of the hosts that have sent I/O through this poll group */
+	TAILQ_HEAD(, spdk_nvmf_host_io_stats)	host_stats;
+
 	uint64_t				io_outstanding;
 	spdk_nvmf_poll_group_mod_done		cb_fn;
 	void					*cb_arg;
@@ -179,6 +218,10 @@ struct spdk_nvmf_ns {
 	char *ptpl_file;
 	/* Persist Through Power Loss feature is enabled */
 	bool ptpl_activated;
+	/* I/O command set of the namespace, ZNS for zoned bdevs */
+	enum spdk_nvme_csi csi;
+	/* Link in the subsystem's list of namespaces removed while paused */
+	TAILQ_ENTRY(spdk_nvmf_ns) link;
 };
 
 struct spdk_nvmf_ctrlr_feat {
@@ -265,6 +308,11 @@ struct spdk_nvmf_subsystem {
 	/* boolean for state change synchronization */
 	bool						changing_state;
 
+	/* Namespaces paused by spdk_nvmf_subsystem_pause_ns(), indexed by nsid - 1 */
+	struct spdk_bit_array				*paused_ns;
+	/* Namespaces removed while paused, freed once every poll group resumed them */
+	TAILQ_HEAD(, spdk_nvmf_ns)			removed_ns;
+
 	struct spdk_nvmf_tgt				*tgt;
 
 	/* Array of pointers to namespaces of size max_nsid indexed by nsid - 1 */
@@ -304,6 +352,12 @@ void nvmf_poll_group_pause_subsystem(struct spdk_nvmf_poll_group *group,
 				     struct spdk_nvmf_subsystem *subsystem, spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
 void nvmf_poll_group_resume_subsystem(struct spdk_nvmf_poll_group *group,
 				      struct spdk_nvmf_subsystem *subsystem, spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
+void nvmf_poll_group_pause_ns(struct spdk_nvmf_poll_group *group,
+			      struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			      spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
+void nvmf_poll_group_resume_ns(struct spdk_nvmf_poll_group *group,
+			       struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			       spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg);
 
 void nvmf_get_discovery_log_page(struct spdk_nvmf_tgt *tgt, const char *hostnqn,
 				 struct iovec *iov,
@@ -314,10 +368,13 @@ int nvmf_ctrlr_process_admin_cmd(struct spdk_nvmf_request *req);
 int nvmf_ctrlr_process_io_cmd(struct spdk_nvmf_request *req);
 bool nvmf_ctrlr_dsm_supported(struct spdk_nvmf_ctrlr *ctrlr);
 bool nvmf_ctrlr_write_zeroes_supported(struct spdk_nvmf_ctrlr *ctrlr);
+bool nvmf_ctrlr_copy_supported(struct spdk_nvmf_ctrlr *ctrlr);
 void nvmf_ctrlr_ns_changed(struct spdk_nvmf_ctrlr *ctrlr, uint32_t nsid);
 
 void nvmf_bdev_ctrlr_identify_ns(struct spdk_nvmf_ns *ns, struct spdk_nvme_ns_data *nsdata,
 				 bool dif_insert_or_strip);
+void nvmf_bdev_ctrlr_identify_iocs_zns(struct spdk_nvmf_ns *ns,
+				       struct spdk_nvme_zns_ns_data *nsdata_zns);
 int nvmf_bdev_ctrlr_read_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 			     struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
 int nvmf_bdev_ctrlr_write_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
@@ -332,6 +389,14 @@ int nvmf_bdev_ctrlr_flush_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *des
 			      struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
 int nvmf_bdev_ctrlr_dsm_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 			    struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
+int nvmf_bdev_ctrlr_copy_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+			     struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
+int nvmf_bdev_ctrlr_zone_append_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+				    struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
+int nvmf_bdev_ctrlr_zone_mgmt_send_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+				       struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
+int nvmf_bdev_ctrlr_zone_mgmt_recv_cmd(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
+				       struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
 int nvmf_bdev_ctrlr_nvme_passthru_io(struct spdk_bdev *bdev, struct spdk_bdev_desc *desc,
 				     struct spdk_io_channel *ch, struct spdk_nvmf_request *req);
 bool nvmf_bdev_ctrlr_get_dif_ctx(struct spdk_bdev *bdev, struct spdk_nvme_cmd *cmd,
@@ -392,6 +457,18 @@ _nvmf_subsystem_get_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
 	return subsystem->ns[nsid - 1];
 }
 
+/* Returns the poll group's information for a namespace, or NULL if the NSID is out of its range */
+static inline struct spdk_nvmf_subsystem_pg_ns_info *
+nvmf_pg_get_ns_info(struct spdk_nvmf_subsystem_poll_group *sgroup, uint32_t nsid)
+{
+	/* NOTE: This implicitly also checks for 0, since 0 - 1 wraps around to UINT32_MAX. */
+	if (spdk_unlikely(nsid - 1 >= sgroup->num_ns)) {
+		return NULL;
+	}
+
+	return &sgroup->ns_info[nsid - 1];
+}
+
 static inline bool
 nvmf_qpair_is_admin_queue(struct spdk_nvmf_qpair *qpair)
 {
@@ -1177,6 +1177,8 @@ struct nvmf_rpc_ns_ctx {
 
 	struct spdk_jsonrpc_request *request;
 	bool response_sent;
+	/* Namespace paused instead of the whole subsystem, or 0 */
+	uint32_t paused_nsid;
 };
 
 static const struct spdk_json_object_decoder nvmf_rpc_subsystem_ns_decoder[] = {
@@ -1195,6 +1197,28 @@ nvmf_rpc_ns_ctx_free(struct nvmf_rpc_ns_ctx *ctx)
 	free(ctx);
 }
 
+static int
+nvmf_rpc_ns_resume(struct spdk_nvmf_subsystem *subsystem, uint32_t paused_nsid,
+		   spdk_nvmf_subsystem_state_change_done cb_fn, void *cb_arg)
+{
+	if (paused_nsid != 0) {
+		return spdk_nvmf_subsystem_resume_ns(subsystem, paused_nsid, cb_fn, cb_arg);
+	}
+
+	return spdk_nvmf_subsystem_resume(subsystem, cb_fn, cb_arg);
+}
+
+static int
+nvmf_rpc_ns_pause(struct spdk_nvmf_subsystem *subsystem, uint32_t paused_nsid,
+		  spdk_nvmf_subsystem_state_change_done cb_fn, void *cb_arg)
+{
+	if (paused_nsid != 0) {
+		return spdk_nvmf_subsystem_pause_ns(subsystem, paused_nsid, cb_fn, cb_arg);
+	}
+
+	return spdk_nvmf_subsystem_pause(subsystem, cb_fn, cb_arg);
+}
+
 static void
 nvmf_rpc_ns_failback_resumed(struct spdk_nvmf_subsystem *subsystem,
 			     void *cb_arg, int status)
@@ -1234,7 +1258,7 @@ nvmf_rpc_ns_resumed(struct spdk_nvmf_subsystem *subsystem,
 			return;
 		}
 
-		rc = spdk_nvmf_subsystem_resume(subsystem, nvmf_rpc_ns_failback_resumed, ctx);
+		rc = nvmf_rpc_ns_resume(subsystem, ctx->paused_nsid, nvmf_rpc_ns_failback_resumed, ctx);
 		if (rc != 0) {
 			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 			nvmf_rpc_ns_ctx_free(ctx);
@@ -1287,7 +1311,7 @@ nvmf_rpc_ns_paused(struct spdk_nvmf_subsystem *subsystem,
 	}
 
 resume:
-	if (spdk_nvmf_subsystem_resume(subsystem, nvmf_rpc_ns_resumed, ctx)) {
+	if (nvmf_rpc_ns_resume(subsystem, ctx->paused_nsid, nvmf_rpc_ns_resumed, ctx)) {
 		spdk_jsonrpc_send_error_response(ctx->request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		nvmf_rpc_ns_ctx_free(ctx);
 	}
@@ -1300,6 +1324,7 @@ rpc_nvmf_subsystem_add_ns(struct spdk_jsonrpc_request *request,
 	struct nvmf_rpc_ns_ctx *ctx;
 	struct spdk_nvmf_subsystem *subsystem;
 	struct spdk_nvmf_tgt *tgt;
+	uint32_t nsid;
 	int rc;
 
 	ctx = calloc(1, sizeof(*ctx));
@@ -1337,7 +1362,24 @@ rpc_nvmf_subsystem_add_ns(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	rc = spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_ns_paused, ctx);
+	/*
+	 * A namespace within the current NSID range is added by pausing only that NSID, so I/O
+	 * to the other namespaces keeps flowing. Growing the NSID range needs the whole
+	 * subsystem to be paused.
+	 */
+	if (ctx->ns_params.nsid == 0) {
+		for (nsid = 1; nsid <= spdk_nvmf_subsystem_get_max_nsid(subsystem); nsid++) {
+			if (spdk_nvmf_subsystem_get_ns(subsystem, nsid) == NULL) {
+				ctx->ns_params.nsid = nsid;
+				break;
+			}
+		}
+	}
+	if (ctx->ns_params.nsid <= spdk_nvmf_subsystem_get_max_nsid(subsystem)) {
+		ctx->paused_nsid = ctx->ns_params.nsid;
+	}
+
+	rc = nvmf_rpc_ns_pause(subsystem, ctx->paused_nsid, nvmf_rpc_ns_paused, ctx);
 	if (rc != 0) {
 		if (rc == -EBUSY) {
 			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
@@ -1408,7 +1450,7 @@ nvmf_rpc_remove_ns_paused(struct spdk_nvmf_subsystem *subsystem,
 		ctx->response_sent = true;
 	}
 
-	if (spdk_nvmf_subsystem_resume(subsystem, nvmf_rpc_remove_ns_resumed, ctx)) {
+	if (spdk_nvmf_subsystem_resume_ns(subsystem, ctx->nsid, nvmf_rpc_remove_ns_resumed, ctx)) {
 		if (!ctx->response_sent) {
 			spdk_jsonrpc_send_error_response(ctx->request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR, "Internal error");
 		}
@@ -1460,9 +1502,13 @@ rpc_nvmf_subsystem_remove_ns(struct spdk_jsonrpc_request *request,
 		return;
 	}
 
-	rc = spdk_nvmf_subsystem_pause(subsystem, nvmf_rpc_remove_ns_paused, ctx);
+	rc = spdk_nvmf_subsystem_pause_ns(subsystem, ctx->nsid, nvmf_rpc_remove_ns_paused, ctx);
 	if (rc != 0) {
-		if (rc == -EBUSY) {
+		if (rc == -EINVAL) {
+			SPDK_ERRLOG("Unable to remove namespace ID %u\n", ctx->nsid);
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+							 "Invalid parameters");
+		} else if (rc == -EBUSY) {
 			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
 							 "subsystem busy, retry later.\n");
 		} else {
@@ -2264,6 +2310,288 @@ rpc_nvmf_get_stats(struct spdk_jsonrpc_request *request,
 
 SPDK_RPC_REGISTER("nvmf_get_stats", rpc_nvmf_get_stats, SPDK_RPC_RUNTIME)
 
+struct rpc_nvmf_host_io_stats {
+	uint32_t				sid;
+	struct spdk_nvmf_host_io_stats		stats;
+	TAILQ_ENTRY(rpc_nvmf_host_io_stats)	link;
+};
+
+struct rpc_nvmf_get_io_stats_ctx {
+	char *tgt_name;
+	char *nqn;
+	struct spdk_nvmf_tgt *tgt;
+	struct spdk_jsonrpc_request *request;
+	/* Only the subsystem with this ID is reported, or all of them if it's UINT32_MAX */
+	uint32_t sid;
+	/* Statistics of all the poll groups added up */
+	TAILQ_HEAD(, rpc_nvmf_host_io_stats) hosts;
+};
+
+static const struct spdk_json_object_decoder rpc_get_io_stats_decoders[] = {
+	{"tgt_name", offsetof(struct rpc_nvmf_get_io_stats_ctx, tgt_name), spdk_json_decode_string, true},
+	{"nqn", offsetof(struct rpc_nvmf_get_io_stats_ctx, nqn), spdk_json_decode_string, true},
+};
+
+static void
+free_get_io_stats_ctx(struct rpc_nvmf_get_io_stats_ctx *ctx)
+{
+	struct rpc_nvmf_host_io_stats *host, *tmp;
+
+	TAILQ_FOREACH_SAFE(host, &ctx->hosts, link, tmp) {
+		TAILQ_REMOVE(&ctx->hosts, host, link);
+		free(host->stats.ns);
+		free(host);
+	}
+
+	free(ctx->tgt_name);
+	free(ctx->nqn);
+	free(ctx);
+}
+
+static int
+rpc_nvmf_add_host_io_stats(struct rpc_nvmf_get_io_stats_ctx *ctx, uint32_t sid,
+			   struct spdk_nvmf_host_io_stats *stats)
+{
+	struct rpc_nvmf_host_io_stats *host;
+	struct spdk_nvmf_ns_io_stat *dst, *src, *new_ns;
+	uint32_t nsid, type, bucket;
+
+	TAILQ_FOREACH(host, &ctx->hosts, link) {
+		if (host->sid == sid && strcmp(host->stats.hostnqn, stats->hostnqn) == 0) {
+			break;
+		}
+	}
+
+	if (host == NULL) {
+		host = calloc(1, sizeof(*host));
+		if (host == NULL) {
+			return -ENOMEM;
+		}
+		host->sid = sid;
+		snprintf(host->stats.hostnqn, sizeof(host->stats.hostnqn), "%s", stats->hostnqn);
+		TAILQ_INSERT_TAIL(&ctx->hosts, host, link);
+	}
+
+	if (stats->num_ns > host->stats.num_ns) {
+		new_ns = realloc(host->stats.ns, stats->num_ns * sizeof(*new_ns));
+		if (new_ns == NULL) {
+			return -ENOMEM;
+		}
+		memset(&new_ns[host->stats.num_ns], 0,
+		       (stats->num_ns - host->stats.num_ns) * sizeof(*new_ns));
+		host->stats.ns = new_ns;
+		host->stats.num_ns = stats->num_ns;
+	}
+
+	for (nsid = 0; nsid < stats->num_ns; nsid++) {
+		dst = &host->stats.ns[nsid];
+		src = &stats->ns[nsid];
+
+		for (type = 0; type < SPDK_NVMF_IO_STAT_NUM_TYPES; type++) {
+			dst->ops[type] += src->ops[type];
+			dst->bytes[type] += src->bytes[type];
+			dst->latency_ticks[type] += src->latency_ticks[type];
+			for (bucket = 0; bucket < SPDK_NVMF_IO_STAT_LATENCY_BUCKETS; bucket++) {
+				dst->latency_buckets[type][bucket] += src->latency_buckets[type][bucket];
+			}
+		}
+		dst->errors += src->errors;
+	}
+
+	return 0;
+}
+
+static void
+_rpc_nvmf_get_io_stats(struct spdk_io_channel_iter *i)
+{
+	struct rpc_nvmf_get_io_stats_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_nvmf_poll_group *group;
+	struct spdk_nvmf_host_io_stats *stats;
+	uint32_t sid;
+	int rc = 0;
+
+	group = spdk_io_channel_get_ctx(spdk_io_channel_iter_get_channel(i));
+
+	for (sid = 0; sid < group->num_sgroups && rc == 0; sid++) {
+		if (ctx->sid != UINT32_MAX && ctx->sid != sid) {
+			continue;
+		}
+
+		TAILQ_FOREACH(stats, &group->sgroups[sid].host_stats, link) {
+			rc = rpc_nvmf_add_host_io_stats(ctx, sid, stats);
+			if (rc != 0) {
+				break;
+			}
+		}
+	}
+
+	spdk_for_each_channel_continue(i, rc);
+}
+
+static void
+write_nvmf_io_stat(struct spdk_json_write_ctx *w, const char *name,
+		   struct spdk_nvmf_ns_io_stat *stat, enum spdk_nvmf_io_stat_type type)
+{
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+	uint32_t bucket, last;
+
+	spdk_json_write_named_object_begin(w, name);
+	spdk_json_write_named_uint64(w, "ops", stat->ops[type]);
+	spdk_json_write_named_uint64(w, "bytes", stat->bytes[type]);
+	spdk_json_write_named_uint64(w, "latency_us",
+				     stat->latency_ticks[type] * SPDK_SEC_TO_USEC / ticks_hz);
+
+	/* Trailing empty buckets are left out */
+	last = 0;
+	for (bucket = 0; bucket < SPDK_NVMF_IO_STAT_LATENCY_BUCKETS; bucket++) {
+		if (stat->latency_buckets[type][bucket] != 0) {
+			last = bucket + 1;
+		}
+	}
+	spdk_json_write_named_array_begin(w, "latency_histogram");
+	for (bucket = 0; bucket < last; bucket++) {
+		spdk_json_write_uint64(w, stat->latency_buckets[type][bucket]);
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+}
+
+static void
+write_nvmf_host_io_stats(struct spdk_json_write_ctx *w, struct spdk_nvmf_host_io_stats *stats)
+{
+	struct spdk_nvmf_ns_io_stat *stat;
+	uint32_t nsid;
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "hostnqn", stats->hostnqn);
+	spdk_json_write_named_array_begin(w, "namespaces");
+	for (nsid = 1; nsid <= stats->num_ns; nsid++) {
+		stat = &stats->ns[nsid - 1];
+		if (stat->ops[SPDK_NVMF_IO_STAT_READ] == 0 && stat->ops[SPDK_NVMF_IO_STAT_WRITE] == 0 &&
+		    stat->ops[SPDK_NVMF_IO_STAT_OTHER] == 0) {
+			continue;
+		}
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_uint32(w, "nsid", nsid);
+		write_nvmf_io_stat(w, "read", stat, SPDK_NVMF_IO_STAT_READ);
+		write_nvmf_io_stat(w, "write", stat, SPDK_NVMF_IO_STAT_WRITE);
+		write_nvmf_io_stat(w, "other", stat, SPDK_NVMF_IO_STAT_OTHER);
+		spdk_json_write_named_uint64(w, "errors", stat->errors);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_nvmf_get_io_stats_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct rpc_nvmf_get_io_stats_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_json_write_ctx *w;
+	struct spdk_nvmf_subsystem *subsystem;
+	struct rpc_nvmf_host_io_stats *host;
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+	uint32_t sid, bucket, shift;
+
+	if (status != 0) {
+		spdk_jsonrpc_send_error_response(ctx->request, status, spdk_strerror(-status));
+		free_get_io_stats_ctx(ctx);
+		return;
+	}
+
+	shift = spdk_u64log2(spdk_max(ticks_hz / SPDK_SEC_TO_USEC, 1));
+
+	w = spdk_jsonrpc_begin_result(ctx->request);
+	spdk_json_write_object_begin(w);
+
+	/* Upper bound of each latency histogram bucket */
+	spdk_json_write_named_array_begin(w, "latency_buckets_us");
+	for (bucket = 0; bucket < SPDK_NVMF_IO_STAT_LATENCY_BUCKETS; bucket++) {
+		spdk_json_write_uint64(w, (1ULL << (bucket + shift)) * SPDK_SEC_TO_USEC / ticks_hz);
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_json_write_named_array_begin(w, "subsystems");
+	for (sid = 0; sid < ctx->tgt->max_subsystems; sid++) {
+		subsystem = ctx->tgt->subsystems[sid];
+		if (subsystem == NULL || (ctx->sid != UINT32_MAX && ctx->sid != sid)) {
+			continue;
+		}
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "nqn", spdk_nvmf_subsystem_get_nqn(subsystem));
+		spdk_json_write_named_array_begin(w, "hosts");
+		TAILQ_FOREACH(host, &ctx->hosts, link) {
+			if (host->sid == sid) {
+				write_nvmf_host_io_stats(w, &host->stats);
+			}
+		}
+		spdk_json_write_array_end(w);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(ctx->request, w);
+	free_get_io_stats_ctx(ctx);
+}
+
+static void
+rpc_nvmf_get_io_stats(struct spdk_jsonrpc_request *request,
+		      const struct spdk_json_val *params)
+{
+	struct rpc_nvmf_get_io_stats_ctx *ctx;
+	struct spdk_nvmf_subsystem *subsystem;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Memory allocation error");
+		return;
+	}
+	ctx->request = request;
+	ctx->sid = UINT32_MAX;
+	TAILQ_INIT(&ctx->hosts);
+
+	if (params) {
+		if (spdk_json_decode_object(params, rpc_get_io_stats_decoders,
+					    SPDK_COUNTOF(rpc_get_io_stats_decoders),
+					    ctx)) {
+			SPDK_ERRLOG("spdk_json_decode_object failed\n");
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+			free_get_io_stats_ctx(ctx);
+			return;
+		}
+	}
+
+	ctx->tgt = spdk_nvmf_get_tgt(ctx->tgt_name);
+	if (!ctx->tgt) {
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "Unable to find a target.");
+		free_get_io_stats_ctx(ctx);
+		return;
+	}
+
+	if (ctx->nqn) {
+		subsystem = spdk_nvmf_tgt_find_subsystem(ctx->tgt, ctx->nqn);
+		if (!subsystem) {
+			SPDK_ERRLOG("Unable to find subsystem with NQN %s\n", ctx->nqn);
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS, "Invalid parameters");
+			free_get_io_stats_ctx(ctx);
+			return;
+		}
+		ctx->sid = subsystem->id;
+	}
+
+	spdk_for_each_channel(ctx->tgt,
+			      _rpc_nvmf_get_io_stats,
+			      ctx,
+			      rpc_nvmf_get_io_stats_done);
+}
+
+SPDK_RPC_REGISTER("nvmf_get_io_stats", rpc_nvmf_get_io_stats, SPDK_RPC_RUNTIME)
+
 static void
 dump_nvmf_ctrlr(struct spdk_json_write_ctx *w, struct spdk_nvmf_ctrlr *ctrlr)
 {
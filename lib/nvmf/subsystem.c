@@ -36,6 +36,7 @@
 #include "nvmf_internal.h"
 #include "transport.h"
 
+#include "spdk/bit_array.h"
 #include "spdk/likely.h"
 #include "spdk/string.h"
 #include "spdk/trace.h"
@@ -285,6 +286,7 @@ spdk_nvmf_subsystem_create(struct spdk_nvmf_tgt *tgt,
 	TAILQ_INIT(&subsystem->listeners);
 	TAILQ_INIT(&subsystem->hosts);
 	TAILQ_INIT(&subsystem->ctrlrs);
+	TAILQ_INIT(&subsystem->removed_ns);
 
 	if (num_ns != 0) {
 		subsystem->ns = calloc(num_ns, sizeof(struct spdk_nvmf_ns *));
@@ -296,6 +298,15 @@ spdk_nvmf_subsystem_create(struct spdk_nvmf_tgt *tgt,
 		}
 	}
 
+	subsystem->paused_ns = spdk_bit_array_create(num_ns);
+	if (subsystem->paused_ns == NULL) {
+		SPDK_ERRLOG("Namespace memory allocation failed\n");
+		pthread_mutex_destroy(&subsystem->mutex);
+		free(subsystem->ns);
+		free(subsystem);
+		return NULL;
+	}
+
 	memset(subsystem->sn, '0', sizeof(subsystem->sn) - 1);
 	subsystem->sn[sizeof(subsystem->sn) - 1] = '\0';
 
@@ -334,6 +345,37 @@ _nvmf_subsystem_remove_listener(struct spdk_nvmf_subsystem *subsystem,
 	free(listener);
 }
 
+static void
+nvmf_ns_free(struct spdk_nvmf_ns *ns)
+{
+	struct spdk_nvmf_registrant *reg, *reg_tmp;
+
+	TAILQ_FOREACH_SAFE(reg, &ns->registrants, link, reg_tmp) {
+		TAILQ_REMOVE(&ns->registrants, reg, link);
+		free(reg);
+	}
+	spdk_bdev_module_release_bdev(ns->bdev);
+	spdk_bdev_close(ns->desc);
+	if (ns->ptpl_file) {
+		free(ns->ptpl_file);
+	}
+	free(ns);
+}
+
+/* Free namespaces removed while paused. nsid 0 frees all of them. */
+static void
+nvmf_subsystem_free_removed_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
+{
+	struct spdk_nvmf_ns *ns, *ns_tmp;
+
+	TAILQ_FOREACH_SAFE(ns, &subsystem->removed_ns, link, ns_tmp) {
+		if (nsid == 0 || ns->nsid == nsid) {
+			TAILQ_REMOVE(&subsystem->removed_ns, ns, link);
+			nvmf_ns_free(ns);
+		}
+	}
+}
+
 void
 spdk_nvmf_subsystem_destroy(struct spdk_nvmf_subsystem *subsystem)
 {
@@ -371,7 +413,10 @@ spdk_nvmf_subsystem_destroy(struct spdk_nvmf_subsystem *subsystem)
 		ns = next_ns;
 	}
 
+	nvmf_subsystem_free_removed_ns(subsystem, 0);
+
 	free(subsystem->ns);
+	spdk_bit_array_free(&subsystem->paused_ns);
 
 	subsystem->tgt->subsystems[subsystem->id] = NULL;
 	subsystem->tgt->discovery_genctr++;
@@ -655,6 +700,143 @@ spdk_nvmf_subsystem_resume(struct spdk_nvmf_subsystem *subsystem,
 	return nvmf_subsystem_state_change(subsystem, SPDK_NVMF_SUBSYSTEM_ACTIVE, cb_fn, cb_arg);
 }
 
+struct subsystem_ns_state_change_ctx {
+	struct spdk_nvmf_subsystem *subsystem;
+	uint32_t nsid;
+
+	bool pause;
+	bool reverting;
+
+	spdk_nvmf_subsystem_state_change_done cb_fn;
+	void *cb_arg;
+};
+
+static void subsystem_ns_state_change_on_pg(struct spdk_io_channel_iter *i);
+
+static void
+subsystem_ns_state_change_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct subsystem_ns_state_change_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_nvmf_subsystem *subsystem = ctx->subsystem;
+
+	if (status != 0 && ctx->pause && !ctx->reverting) {
+		/* Resume the namespace on the poll groups that already paused it. */
+		ctx->pause = false;
+		ctx->reverting = true;
+		spdk_for_each_channel(subsystem->tgt,
+				      subsystem_ns_state_change_on_pg,
+				      ctx,
+				      subsystem_ns_state_change_done);
+		return;
+	}
+
+	if (ctx->reverting) {
+		status = -1;
+	} else if (status == 0 && ctx->pause) {
+		spdk_bit_array_set(subsystem->paused_ns, ctx->nsid - 1);
+	} else if (!ctx->pause) {
+		/* Every poll group has dropped its reference to a namespace removed while paused. */
+		nvmf_subsystem_free_removed_ns(subsystem, ctx->nsid);
+	}
+
+	subsystem->changing_state = false;
+	if (ctx->cb_fn) {
+		ctx->cb_fn(subsystem, ctx->cb_arg, status);
+	}
+	free(ctx);
+}
+
+static void
+subsystem_ns_state_change_on_pg(struct spdk_io_channel_iter *i)
+{
+	struct subsystem_ns_state_change_ctx *ctx;
+	struct spdk_nvmf_poll_group *group;
+
+	ctx = spdk_io_channel_iter_get_ctx(i);
+	group = spdk_io_channel_get_ctx(spdk_io_channel_iter_get_channel(i));
+
+	if (ctx->pause) {
+		nvmf_poll_group_pause_ns(group, ctx->subsystem, ctx->nsid,
+					 subsystem_state_change_continue, i);
+	} else {
+		nvmf_poll_group_resume_ns(group, ctx->subsystem, ctx->nsid,
+					  subsystem_state_change_continue, i);
+	}
+}
+
+static int
+nvmf_subsystem_ns_state_change(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid, bool pause,
+			       spdk_nvmf_subsystem_state_change_done cb_fn, void *cb_arg)
+{
+	struct subsystem_ns_state_change_ctx *ctx;
+
+	if (nsid == 0 || nsid > subsystem->max_nsid) {
+		return -EINVAL;
+	}
+
+	if (__sync_val_compare_and_swap(&subsystem->changing_state, false, true)) {
+		return -EBUSY;
+	}
+
+	if (spdk_bit_array_get(subsystem->paused_ns, nsid - 1) == pause) {
+		/* Paused twice, or resumed without being paused */
+		subsystem->changing_state = false;
+		return pause ? -EBUSY : -EINVAL;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		subsystem->changing_state = false;
+		return -ENOMEM;
+	}
+
+	ctx->subsystem = subsystem;
+	ctx->nsid = nsid;
+	ctx->pause = pause;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	if (!pause) {
+		/* The namespace can't be added or removed anymore once it starts resuming. */
+		spdk_bit_array_clear(subsystem->paused_ns, nsid - 1);
+	}
+
+	spdk_for_each_channel(subsystem->tgt,
+			      subsystem_ns_state_change_on_pg,
+			      ctx,
+			      subsystem_ns_state_change_done);
+
+	return 0;
+}
+
+int
+spdk_nvmf_subsystem_pause_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			     spdk_nvmf_subsystem_state_change_done cb_fn,
+			     void *cb_arg)
+{
+	return nvmf_subsystem_ns_state_change(subsystem, nsid, true, cb_fn, cb_arg);
+}
+
+int
+spdk_nvmf_subsystem_resume_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			      spdk_nvmf_subsystem_state_change_done cb_fn,
+			      void *cb_arg)
+{
+	return nvmf_subsystem_ns_state_change(subsystem, nsid, false, cb_fn, cb_arg);
+}
+
+static bool
+nvmf_subsystem_ns_can_change(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
+{
+	if (subsystem->state == SPDK_NVMF_SUBSYSTEM_INACTIVE ||
+	    subsystem->state == SPDK_NVMF_SUBSYSTEM_PAUSED) {
+		return true;
+	}
+
+	/* NOTE: This implicitly also checks for 0, since 0 - 1 wraps around to UINT32_MAX. */
+	return spdk_bit_array_get(subsystem->paused_ns, nsid - 1);
+}
+
 struct spdk_nvmf_subsystem *
 spdk_nvmf_subsystem_get_first(struct spdk_nvmf_tgt *tgt)
 {
@@ -1135,6 +1317,15 @@ nvmf_subsystem_ns_changed(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
 {
 	struct spdk_nvmf_ctrlr *ctrlr;
 
+	if (!(subsystem->state == SPDK_NVMF_SUBSYSTEM_INACTIVE ||
+	      subsystem->state == SPDK_NVMF_SUBSYSTEM_PAUSED)) {
+		/*
+		 * Only the namespace is paused and the admin queues are still running, so
+		 * each poll group records the change when the namespace is resumed.
+		 */
+		return;
+	}
+
 	TAILQ_FOREACH(ctrlr, &subsystem->ctrlrs, link) {
 		nvmf_ctrlr_ns_changed(ctrlr, nsid);
 	}
@@ -1144,10 +1335,8 @@ int
 spdk_nvmf_subsystem_remove_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t nsid)
 {
 	struct spdk_nvmf_ns *ns;
-	struct spdk_nvmf_registrant *reg, *reg_tmp;
 
-	if (!(subsystem->state == SPDK_NVMF_SUBSYSTEM_INACTIVE ||
-	      subsystem->state == SPDK_NVMF_SUBSYSTEM_PAUSED)) {
+	if (!nvmf_subsystem_ns_can_change(subsystem, nsid)) {
 		assert(false);
 		return -1;
 	}
@@ -1163,16 +1352,14 @@ spdk_nvmf_subsystem_remove_ns(struct spdk_nvmf_subsystem *subsystem, uint32_t ns
 
 	subsystem->ns[nsid - 1] = NULL;
 
-	TAILQ_FOREACH_SAFE(reg, &ns->registrants, link, reg_tmp) {
-		TAILQ_REMOVE(&ns->registrants, reg, link);
-		free(reg);
-	}
-	spdk_bdev_module_release_bdev(ns->bdev);
-	spdk_bdev_close(ns->desc);
-	if (ns->ptpl_file) {
-		free(ns->ptpl_file);
+	if (subsystem->state == SPDK_NVMF_SUBSYSTEM_INACTIVE ||
+	    subsystem->state == SPDK_NVMF_SUBSYSTEM_PAUSED) {
+		nvmf_ns_free(ns);
+	} else {
+		/* Only this namespace is paused, so admin commands on the poll groups may still
+		 * hold a pointer to it. Keep it open until it's resumed on all of them. */
+		TAILQ_INSERT_TAIL(&subsystem->removed_ns, ns, link);
 	}
-	free(ns);
 
 	nvmf_subsystem_ns_changed(subsystem, nsid);
 
@@ -1197,7 +1384,7 @@ _nvmf_ns_hot_remove(struct spdk_nvmf_subsystem *subsystem,
 		SPDK_ERRLOG("Failed to make changes to NVME-oF subsystem with id: %u\n", subsystem->id);
 	}
 
-	spdk_nvmf_subsystem_resume(subsystem, NULL, NULL);
+	spdk_nvmf_subsystem_resume_ns(subsystem, ctx->nsid, NULL, NULL);
 
 	free(ctx);
 }
@@ -1208,7 +1395,7 @@ nvmf_ns_change_msg(void *ns_ctx)
 	struct subsystem_ns_change_ctx *ctx = ns_ctx;
 	int rc;
 
-	rc = spdk_nvmf_subsystem_pause(ctx->subsystem, ctx->cb_fn, ctx);
+	rc = spdk_nvmf_subsystem_pause_ns(ctx->subsystem, ctx->nsid, ctx->cb_fn, ctx);
 	if (rc) {
 		if (rc == -EBUSY) {
 			/* Try again, this is not a permanent situation. */
@@ -1240,7 +1427,7 @@ nvmf_ns_hot_remove(void *remove_ctx)
 	ns_ctx->nsid = ns->opts.nsid;
 	ns_ctx->cb_fn = _nvmf_ns_hot_remove;
 
-	rc = spdk_nvmf_subsystem_pause(ns->subsystem, _nvmf_ns_hot_remove, ns_ctx);
+	rc = spdk_nvmf_subsystem_pause_ns(ns->subsystem, ns_ctx->nsid, _nvmf_ns_hot_remove, ns_ctx);
 	if (rc) {
 		if (rc == -EBUSY) {
 			/* Try again, this is not a permanent situation. */
@@ -1257,8 +1444,9 @@ _nvmf_ns_resize(struct spdk_nvmf_subsystem *subsystem, void *cb_arg, int status)
 {
 	struct subsystem_ns_change_ctx *ctx = cb_arg;
 
+	/* The poll groups notice the new size when the namespace is resumed. */
 	nvmf_subsystem_ns_changed(subsystem, ctx->nsid);
-	spdk_nvmf_subsystem_resume(subsystem, NULL, NULL);
+	spdk_nvmf_subsystem_resume_ns(subsystem, ctx->nsid, NULL, NULL);
 
 	free(ctx);
 }
@@ -1283,7 +1471,7 @@ nvmf_ns_resize(void *event_ctx)
 	ns_ctx->nsid = ns->opts.nsid;
 	ns_ctx->cb_fn = _nvmf_ns_resize;
 
-	rc = spdk_nvmf_subsystem_pause(ns->subsystem, _nvmf_ns_resize, ns_ctx);
+	rc = spdk_nvmf_subsystem_pause_ns(ns->subsystem, ns_ctx->nsid, _nvmf_ns_resize, ns_ctx);
 	if (rc) {
 		if (rc == -EBUSY) {
 			/* Try again, this is not a permanent situation. */
@@ -1345,16 +1533,16 @@ spdk_nvmf_subsystem_add_ns_ext(struct spdk_nvmf_subsystem *subsystem, const char
 	struct spdk_nvmf_reservation_info info = {0};
 	int rc;
 
-	if (!(subsystem->state == SPDK_NVMF_SUBSYSTEM_INACTIVE ||
-	      subsystem->state == SPDK_NVMF_SUBSYSTEM_PAUSED)) {
-		return 0;
-	}
-
 	spdk_nvmf_ns_opts_get_defaults(&opts, sizeof(opts));
 	if (user_opts) {
 		memcpy(&opts, user_opts, spdk_min(sizeof(opts), opts_size));
 	}
 
+	/* Only the namespace being added has to be paused, not the whole subsystem. */
+	if (!nvmf_subsystem_ns_can_change(subsystem, opts.nsid)) {
+		return 0;
+	}
+
 	if (opts.nsid == SPDK_NVME_GLOBAL_NS_TAG) {
 		SPDK_ERRLOG("Invalid NSID %" PRIu32 "\n", opts.nsid);
 		return 0;
@@ -1394,6 +1582,11 @@ spdk_nvmf_subsystem_add_ns_ext(struct spdk_nvmf_subsystem *subsystem, const char
 			return 0;
 		}
 
+		if (spdk_bit_array_resize(&subsystem->paused_ns, opts.nsid) != 0) {
+			SPDK_ERRLOG("Memory allocation error while resizing namespace array.\n");
+			return 0;
+		}
+
 		new_ns_array = realloc(subsystem->ns, sizeof(struct spdk_nvmf_ns *) * opts.nsid);
 		if (new_ns_array == NULL) {
 			SPDK_ERRLOG("Memory allocation error while resizing namespace array.\n");
@@ -1436,6 +1629,12 @@ spdk_nvmf_subsystem_add_ns_ext(struct spdk_nvmf_subsystem *subsystem, const char
 		return 0;
 	}
 
+	if (spdk_bdev_is_zoned(ns->bdev)) {
+		ns->csi = SPDK_NVME_CSI_ZNS;
+	} else {
+		ns->csi = SPDK_NVME_CSI_NVM;
+	}
+
 	if (spdk_mem_all_zero(&opts.uuid, sizeof(opts.uuid))) {
 		opts.uuid = *spdk_bdev_get_uuid(ns->bdev);
 	}
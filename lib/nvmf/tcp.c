@@ -53,6 +53,7 @@
 #define SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY 0
 #define SPDK_NVMF_TCP_DEFAULT_CONTROL_MSG_NUM 32
 #define SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION true
+#define SPDK_NVMF_TCP_DEFAULT_SHARED_REQ_NUM 0
 
 const struct spdk_nvmf_transport_ops spdk_nvmf_transport_tcp;
 
@@ -177,6 +178,8 @@ struct spdk_nvmf_tcp_req  {
 
 	/* In-capsule data buffer */
 	uint8_t					*buf;
+	/* Entry of the poll group's shared pool that pdu and buf come from, if any */
+	struct spdk_nvmf_tcp_shared_req		*shared_req;
 	/*
 	 * The PDU for a request may be used multiple times in serial over
 	 * the request's lifetime. For example, first to send an R2T, then
@@ -229,12 +232,17 @@ struct spdk_nvmf_tcp_qpair {
 	struct nvme_tcp_pdu			*mgmt_pdu;
 
 	/* Arrays of in-capsule buffers, requests, and pdus.
-	 * Each array is 'resource_count' number of elements */
+	 * Each array is 'resource_count' number of elements, except
+	 * when the requests borrow their in-capsule buffers and pdus
+	 * from shared_pool. Then there are no bufs and the only pdu
+	 * is the mgmt_pdu. */
 	void					*bufs;
 	struct spdk_nvmf_tcp_req		*reqs;
 	struct nvme_tcp_pdu			*pdus;
 	uint32_t				resource_count;
+	struct spdk_nvmf_tcp_shared_pool	*shared_pool;
 	uint32_t				recv_buf_size;
+	struct nvme_tcp_recv_hint		recv_hint;
 
 	struct spdk_nvmf_tcp_port		*port;
 
@@ -263,6 +271,20 @@ struct spdk_nvmf_tcp_control_msg_list {
 	STAILQ_HEAD(, spdk_nvmf_tcp_control_msg) free_msgs;
 };
 
+/* In-capsule data buffer and PDU lent to a request for its lifetime */
+struct spdk_nvmf_tcp_shared_req {
+	struct nvme_tcp_pdu			*pdu;
+	uint8_t					*buf;
+	STAILQ_ENTRY(spdk_nvmf_tcp_shared_req)	link;
+};
+
+struct spdk_nvmf_tcp_shared_pool {
+	struct spdk_nvmf_tcp_shared_req		*reqs;
+	struct nvme_tcp_pdu			*pdus;
+	void					*bufs;
+	STAILQ_HEAD(, spdk_nvmf_tcp_shared_req)	free_reqs;
+};
+
 struct spdk_nvmf_tcp_poll_group {
 	struct spdk_nvmf_transport_poll_group	group;
 	struct spdk_sock_group			*sock_group;
@@ -271,6 +293,9 @@ struct spdk_nvmf_tcp_poll_group {
 	TAILQ_HEAD(, spdk_nvmf_tcp_qpair)	await_req;
 
 	struct spdk_nvmf_tcp_control_msg_list	*control_msg_list;
+
+	/* In-capsule buffers and pdus shared by the requests of all the qpairs */
+	struct spdk_nvmf_tcp_shared_pool	*shared_pool;
 };
 
 struct spdk_nvmf_tcp_port {
@@ -283,6 +308,7 @@ struct tcp_transport_opts {
 	bool		c2h_success;
 	uint16_t	control_msg_num;
 	uint32_t	sock_priority;
+	uint32_t	shared_req_num;
 };
 
 struct spdk_nvmf_tcp_transport {
@@ -307,6 +333,10 @@ static const struct spdk_json_object_decoder tcp_transport_opts_decoder[] = {
 		"sock_priority", offsetof(struct tcp_transport_opts, sock_priority),
 		spdk_json_decode_uint32, true
 	},
+	{
+		"shared_req_num", offsetof(struct tcp_transport_opts, shared_req_num),
+		spdk_json_decode_uint32, true
+	},
 };
 
 static bool nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
@@ -355,12 +385,25 @@ static struct spdk_nvmf_tcp_req *
 nvmf_tcp_req_get(struct spdk_nvmf_tcp_qpair *tqpair)
 {
 	struct spdk_nvmf_tcp_req *tcp_req;
+	struct spdk_nvmf_tcp_shared_req *shared_req;
 
 	tcp_req = TAILQ_FIRST(&tqpair->state_queue[TCP_REQUEST_STATE_FREE]);
 	if (!tcp_req) {
 		return NULL;
 	}
 
+	if (tqpair->shared_pool) {
+		shared_req = STAILQ_FIRST(&tqpair->shared_pool->free_reqs);
+		if (!shared_req) {
+			return NULL;
+		}
+
+		STAILQ_REMOVE_HEAD(&tqpair->shared_pool->free_reqs, link);
+		tcp_req->shared_req = shared_req;
+		tcp_req->pdu = shared_req->pdu;
+		tcp_req->buf = shared_req->buf;
+	}
+
 	memset(&tcp_req->rsp, 0, sizeof(tcp_req->rsp));
 	tcp_req->h2c_offset = 0;
 	tcp_req->has_incapsule_data = false;
@@ -370,6 +413,19 @@ nvmf_tcp_req_get(struct spdk_nvmf_tcp_qpair *tqpair)
 	return tcp_req;
 }
 
+static void
+nvmf_tcp_req_put_shared(struct spdk_nvmf_tcp_qpair *tqpair, struct spdk_nvmf_tcp_req *tcp_req)
+{
+	if (!tcp_req->shared_req) {
+		return;
+	}
+
+	STAILQ_INSERT_HEAD(&tqpair->shared_pool->free_reqs, tcp_req->shared_req, link);
+	tcp_req->shared_req = NULL;
+	tcp_req->pdu = NULL;
+	tcp_req->buf = NULL;
+}
+
 static void
 nvmf_tcp_request_free(struct spdk_nvmf_tcp_req *tcp_req)
 {
@@ -482,6 +538,7 @@ nvmf_tcp_dump_opts(struct spdk_nvmf_transport *transport, struct spdk_json_write
 	ttransport = SPDK_CONTAINEROF(transport, struct spdk_nvmf_tcp_transport, transport);
 	spdk_json_write_named_bool(w, "c2h_success", ttransport->tcp_opts.c2h_success);
 	spdk_json_write_named_uint32(w, "sock_priority", ttransport->tcp_opts.sock_priority);
+	spdk_json_write_named_uint32(w, "shared_req_num", ttransport->tcp_opts.shared_req_num);
 }
 
 static int
@@ -516,6 +573,7 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 	ttransport->tcp_opts.c2h_success = SPDK_NVMF_TCP_DEFAULT_SUCCESS_OPTIMIZATION;
 	ttransport->tcp_opts.sock_priority = SPDK_NVMF_TCP_DEFAULT_SOCK_PRIORITY;
 	ttransport->tcp_opts.control_msg_num = SPDK_NVMF_TCP_DEFAULT_CONTROL_MSG_NUM;
+	ttransport->tcp_opts.shared_req_num = SPDK_NVMF_TCP_DEFAULT_SHARED_REQ_NUM;
 	if (opts->transport_specific != NULL &&
 	    spdk_json_decode_object_relaxed(opts->transport_specific, tcp_transport_opts_decoder,
 					    SPDK_COUNTOF(tcp_transport_opts_decoder),
@@ -533,7 +591,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     "  in_capsule_data_size=%d, max_aq_depth=%d\n"
 		     "  num_shared_buffers=%d, c2h_success=%d,\n"
 		     "  dif_insert_or_strip=%d, sock_priority=%d\n"
-		     "  abort_timeout_sec=%d, control_msg_num=%hu\n",
+		     "  abort_timeout_sec=%d, control_msg_num=%hu\n"
+		     "  shared_req_num=%d\n",
 		     opts->max_queue_depth,
 		     opts->max_io_size,
 		     opts->max_qpairs_per_ctrlr - 1,
@@ -545,7 +604,8 @@ nvmf_tcp_create(struct spdk_nvmf_transport_opts *opts)
 		     opts->dif_insert_or_strip,
 		     ttransport->tcp_opts.sock_priority,
 		     opts->abort_timeout_sec,
-		     ttransport->tcp_opts.control_msg_num);
+		     ttransport->tcp_opts.control_msg_num,
+		     ttransport->tcp_opts.shared_req_num);
 
 	if (ttransport->tcp_opts.sock_priority > SPDK_NVMF_TCP_DEFAULT_MAX_SOCK_PRIORITY) {
 		SPDK_ERRLOG("Unsupported socket_priority=%d, the current range is: 0 to %d\n"
@@ -833,7 +893,7 @@ nvmf_tcp_qpair_write_pdu(struct spdk_nvmf_tcp_qpair *tqpair,
 static int
 nvmf_tcp_qpair_init_mem_resource(struct spdk_nvmf_tcp_qpair *tqpair)
 {
-	uint32_t i;
+	uint32_t i, num_pdus;
 	struct spdk_nvmf_transport_opts *opts;
 	uint32_t in_capsule_data_size;
 
@@ -852,7 +912,14 @@ nvmf_tcp_qpair_init_mem_resource(struct spdk_nvmf_tcp_qpair *tqpair)
 		return -1;
 	}
 
-	if (in_capsule_data_size) {
+	/* The requests borrow their in-capsule buffers and pdus from the poll group */
+	if (tqpair->shared_pool) {
+		num_pdus = 0;
+	} else {
+		num_pdus = tqpair->resource_count;
+	}
+
+	if (in_capsule_data_size && !tqpair->shared_pool) {
 		tqpair->bufs = spdk_zmalloc(tqpair->resource_count * in_capsule_data_size, 0x1000,
 					    NULL, SPDK_ENV_LCORE_ID_ANY,
 					    SPDK_MALLOC_DMA);
@@ -863,7 +930,7 @@ nvmf_tcp_qpair_init_mem_resource(struct spdk_nvmf_tcp_qpair *tqpair)
 	}
 
 	/* Add addtional one member, which will be used for mgmt_pdu owned by the tqpair */
-	tqpair->pdus = spdk_dma_malloc((tqpair->resource_count + 1) * sizeof(*tqpair->pdus), 0x1000, NULL);
+	tqpair->pdus = spdk_dma_malloc((num_pdus + 1) * sizeof(*tqpair->pdus), 0x1000, NULL);
 	if (!tqpair->pdus) {
 		SPDK_ERRLOG("Unable to allocate pdu pool on tqpair =%p.\n", tqpair);
 		return -1;
@@ -875,8 +942,10 @@ nvmf_tcp_qpair_init_mem_resource(struct spdk_nvmf_tcp_qpair *tqpair)
 		tcp_req->ttag = i + 1;
 		tcp_req->req.qpair = &tqpair->qpair;
 
-		tcp_req->pdu = &tqpair->pdus[i];
-		tcp_req->pdu->qpair = tqpair;
+		if (!tqpair->shared_pool) {
+			tcp_req->pdu = &tqpair->pdus[i];
+			tcp_req->pdu->qpair = tqpair;
+		}
 
 		/* Set up memory to receive commands */
 		if (tqpair->bufs) {
@@ -893,7 +962,7 @@ nvmf_tcp_qpair_init_mem_resource(struct spdk_nvmf_tcp_qpair *tqpair)
 		tqpair->state_cntr[TCP_REQUEST_STATE_FREE]++;
 	}
 
-	tqpair->mgmt_pdu = &tqpair->pdus[i];
+	tqpair->mgmt_pdu = &tqpair->pdus[num_pdus];
 	tqpair->mgmt_pdu->qpair = tqpair;
 
 	tqpair->recv_buf_size = (in_capsule_data_size + sizeof(struct spdk_nvme_tcp_cmd) + 2 *
@@ -1070,6 +1139,76 @@ nvmf_tcp_control_msg_list_free(struct spdk_nvmf_tcp_control_msg_list *list)
 	free(list);
 }
 
+static void
+nvmf_tcp_shared_pool_free(struct spdk_nvmf_tcp_shared_pool *pool)
+{
+	if (!pool) {
+		return;
+	}
+
+	spdk_free(pool->bufs);
+	spdk_dma_free(pool->pdus);
+	free(pool->reqs);
+	free(pool);
+}
+
+static struct spdk_nvmf_tcp_shared_pool *
+nvmf_tcp_shared_pool_create(struct spdk_nvmf_transport_opts *opts, uint32_t num_reqs)
+{
+	struct spdk_nvmf_tcp_shared_pool *pool;
+	struct spdk_nvmf_tcp_shared_req *shared_req;
+	uint32_t in_capsule_data_size, i;
+
+	in_capsule_data_size = opts->in_capsule_data_size;
+	if (opts->dif_insert_or_strip) {
+		in_capsule_data_size = SPDK_BDEV_BUF_SIZE_WITH_MD(in_capsule_data_size);
+	}
+
+	pool = calloc(1, sizeof(*pool));
+	if (!pool) {
+		SPDK_ERRLOG("Failed to allocate memory for shared pool structure\n");
+		return NULL;
+	}
+
+	STAILQ_INIT(&pool->free_reqs);
+
+	pool->reqs = calloc(num_reqs, sizeof(*pool->reqs));
+	if (!pool->reqs) {
+		SPDK_ERRLOG("Failed to allocate memory for shared pool entries\n");
+		goto err;
+	}
+
+	pool->pdus = spdk_dma_malloc(num_reqs * sizeof(*pool->pdus), 0x1000, NULL);
+	if (!pool->pdus) {
+		SPDK_ERRLOG("Failed to allocate memory for shared pool pdus\n");
+		goto err;
+	}
+
+	if (in_capsule_data_size) {
+		pool->bufs = spdk_zmalloc(num_reqs * in_capsule_data_size, 0x1000,
+					  NULL, SPDK_ENV_LCORE_ID_ANY, SPDK_MALLOC_DMA);
+		if (!pool->bufs) {
+			SPDK_ERRLOG("Failed to allocate memory for shared pool in-capsule buffers\n");
+			goto err;
+		}
+	}
+
+	for (i = 0; i < num_reqs; i++) {
+		shared_req = &pool->reqs[i];
+		shared_req->pdu = &pool->pdus[i];
+		if (pool->bufs) {
+			shared_req->buf = (uint8_t *)pool->bufs + i * in_capsule_data_size;
+		}
+		STAILQ_INSERT_TAIL(&pool->free_reqs, shared_req, link);
+	}
+
+	return pool;
+
+err:
+	nvmf_tcp_shared_pool_free(pool);
+	return NULL;
+}
+
 static struct spdk_nvmf_transport_poll_group *
 nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport)
 {
@@ -1101,6 +1240,14 @@ nvmf_tcp_poll_group_create(struct spdk_nvmf_transport *transport)
 		}
 	}
 
+	if (ttransport->tcp_opts.shared_req_num) {
+		tgroup->shared_pool = nvmf_tcp_shared_pool_create(&transport->opts,
+				      ttransport->tcp_opts.shared_req_num);
+		if (!tgroup->shared_pool) {
+			goto cleanup;
+		}
+	}
+
 	return &tgroup->group;
 
 cleanup:
@@ -1135,6 +1282,7 @@ nvmf_tcp_poll_group_destroy(struct spdk_nvmf_transport_poll_group *group)
 		nvmf_tcp_control_msg_list_free(tgroup->control_msg_list);
 	}
 
+	nvmf_tcp_shared_pool_free(tgroup->shared_pool);
 	free(tgroup);
 }
 
@@ -1246,8 +1394,10 @@ nvmf_tcp_capsule_cmd_hdr_handle(struct spdk_nvmf_tcp_transport *ttransport,
 
 	tcp_req = nvmf_tcp_req_get(tqpair);
 	if (!tcp_req) {
-		/* Directly return and make the allocation retry again */
-		if (tqpair->state_cntr[TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST] > 0) {
+		/* Directly return and make the allocation retry again. If the qpair still
+		 * has free requests, the poll group's shared pool ran out. */
+		if (tqpair->state_cntr[TCP_REQUEST_STATE_TRANSFERRING_CONTROLLER_TO_HOST] > 0 ||
+		    tqpair->state_cntr[TCP_REQUEST_STATE_FREE] > 0) {
 			return;
 		}
 
@@ -1814,6 +1964,7 @@ nvmf_tcp_pdu_ch_handle(struct spdk_nvmf_tcp_qpair *tqpair)
 	} else {
 		nvmf_tcp_qpair_set_recv_state(tqpair, NVME_TCP_PDU_RECV_STATE_AWAIT_PDU_PSH);
 		nvme_tcp_pdu_calc_psh_len(&tqpair->pdu_in_progress, tqpair->host_hdgst_enable);
+		nvme_tcp_pdu_set_recv_hint(tqpair->sock, &tqpair->pdu_in_progress, &tqpair->recv_hint);
 		return;
 	}
 err:
@@ -1859,6 +2010,7 @@ nvmf_tcp_sock_process(struct spdk_nvmf_tcp_qpair *tqpair)
 				return rc;
 			}
 
+			nvme_tcp_ch_set_recv_hint(tqpair->sock, pdu, &tqpair->recv_hint);
 			rc = nvme_tcp_read_data(tqpair->sock,
 						sizeof(struct spdk_nvme_tcp_common_pdu_hdr) - pdu->ch_valid_bytes,
 						(void *)&pdu->hdr.common + pdu->ch_valid_bytes);
@@ -2444,6 +2596,7 @@ nvmf_tcp_req_process(struct spdk_nvmf_tcp_transport *ttransport,
 			tcp_req->req.data = NULL;
 
 			nvmf_tcp_req_pdu_fini(tcp_req);
+			nvmf_tcp_req_put_shared(tqpair, tcp_req);
 
 			nvmf_tcp_req_set_state(tcp_req, TCP_REQUEST_STATE_FREE);
 			break;
@@ -2507,6 +2660,7 @@ nvmf_tcp_poll_group_add(struct spdk_nvmf_transport_poll_group *group,
 		return -1;
 	}
 
+	tqpair->shared_pool = tgroup->shared_pool;
 	rc = nvmf_tcp_qpair_init_mem_resource(tqpair);
 	if (rc < 0) {
 		SPDK_ERRLOG("Cannot init memory resource info for tqpair=%p\n", tqpair);
@@ -44,17 +44,56 @@
 static STAILQ_HEAD(, spdk_net_impl) g_net_impls = STAILQ_HEAD_INITIALIZER(g_net_impls);
 static struct spdk_net_impl *g_default_impl;
 
+/* Number of slots in the placement map. Must be a power of 2. */
+#define SPDK_SOCK_PLACEMENT_MAP_SIZE 4096
+
+/* The placement map is an open addressing hash table with linear probing.
+ * Writers (insert/release/remove) are serialized by g_map_table_mutex, while
+ * lookups from the I/O path are lock-free. A slot is claimed for a placement_id
+ * for the lifetime of the process, so once placement_id is published in a slot
+ * it never changes and readers only need to observe the group pointer. Placement
+ * ids (e.g. NAPI ids) come from a small, bounded space, so the table does not
+ * need to support slot reuse.
+ */
 struct spdk_sock_placement_id_entry {
 	int placement_id;
 	uint32_t ref;
 	struct spdk_sock_group *group;
-	STAILQ_ENTRY(spdk_sock_placement_id_entry) link;
 };
 
-static STAILQ_HEAD(, spdk_sock_placement_id_entry) g_placement_id_map = STAILQ_HEAD_INITIALIZER(
-			g_placement_id_map);
+static struct spdk_sock_placement_id_entry g_placement_id_map[SPDK_SOCK_PLACEMENT_MAP_SIZE];
 static pthread_mutex_t g_map_table_mutex = PTHREAD_MUTEX_INITIALIZER;
 
+static inline uint32_t
+sock_map_hash(int placement_id)
+{
+	/* Fibonacci hashing spreads out the sequential ids handed out by the kernel. */
+	return ((uint32_t)placement_id * 2654435761u) & (SPDK_SOCK_PLACEMENT_MAP_SIZE - 1);
+}
+
+/* Find the slot for placement_id. If the id is not in the map, return the first
+ * free slot in its probe sequence, or NULL if the map is full.
+ */
+static struct spdk_sock_placement_id_entry *
+sock_map_find_slot(int placement_id)
+{
+	struct spdk_sock_placement_id_entry *entry;
+	uint32_t i, idx;
+	int id;
+
+	idx = sock_map_hash(placement_id);
+	for (i = 0; i < SPDK_SOCK_PLACEMENT_MAP_SIZE; i++) {
+		entry = &g_placement_id_map[idx];
+		id = __atomic_load_n(&entry->placement_id, __ATOMIC_ACQUIRE);
+		if (id == placement_id || id == 0) {
+			return entry;
+		}
+		idx = (idx + 1) & (SPDK_SOCK_PLACEMENT_MAP_SIZE - 1);
+	}
+
+	return NULL;
+}
+
 /* Insert a group into the placement map.
  * If the group is already in the map, take a reference.
  */
@@ -64,87 +103,77 @@ sock_map_insert(int placement_id, struct spdk_sock_group *group)
 	struct spdk_sock_placement_id_entry *entry;
 
 	pthread_mutex_lock(&g_map_table_mutex);
-	STAILQ_FOREACH(entry, &g_placement_id_map, link) {
-		if (placement_id == entry->placement_id) {
-			/* The mapping already exists, it means that different sockets have
-			 * the same placement_ids.
-			 */
-			entry->ref++;
-			pthread_mutex_unlock(&g_map_table_mutex);
-			return 0;
-		}
-	}
-
-	entry = calloc(1, sizeof(*entry));
+	entry = sock_map_find_slot(placement_id);
 	if (!entry) {
 		SPDK_ERRLOG("Cannot allocate an entry for placement_id=%u\n", placement_id);
 		pthread_mutex_unlock(&g_map_table_mutex);
 		return -ENOMEM;
 	}
 
-	entry->placement_id = placement_id;
-	entry->group = group;
-	entry->ref++;
+	if (entry->placement_id == placement_id && entry->group != NULL) {
+		/* The mapping already exists, it means that different sockets have
+		 * the same placement_ids.
+		 */
+		entry->ref++;
+		pthread_mutex_unlock(&g_map_table_mutex);
+		return 0;
+	}
 
-	STAILQ_INSERT_TAIL(&g_placement_id_map, entry, link);
+	entry->ref = 1;
+	__atomic_store_n(&entry->group, group, __ATOMIC_RELEASE);
+	/* Publish the slot only after the group is visible to readers. */
+	__atomic_store_n(&entry->placement_id, placement_id, __ATOMIC_RELEASE);
 	pthread_mutex_unlock(&g_map_table_mutex);
 
 	return 0;
 }
 
-/* Release a reference to the group for a given placement_id.
- * If the reference count is 0, remove the group.
- */
+/* Release a reference to the group for a given placement_id. */
 static void
 sock_map_release(int placement_id)
 {
 	struct spdk_sock_placement_id_entry *entry;
 
 	pthread_mutex_lock(&g_map_table_mutex);
-	STAILQ_FOREACH(entry, &g_placement_id_map, link) {
-		if (placement_id == entry->placement_id) {
-			assert(entry->ref > 0);
-			entry->ref--;
-			break;
-		}
+	entry = sock_map_find_slot(placement_id);
+	if (entry && entry->placement_id == placement_id && entry->group != NULL) {
+		assert(entry->ref > 0);
+		entry->ref--;
 	}
 
 	pthread_mutex_unlock(&g_map_table_mutex);
 }
 
-/* Look up the group for a placement_id. */
+/* Look up the group for a placement_id. This does not take the map lock. */
 static void
 sock_map_lookup(int placement_id, struct spdk_sock_group **group)
 {
 	struct spdk_sock_placement_id_entry *entry;
 
 	*group = NULL;
-	pthread_mutex_lock(&g_map_table_mutex);
-	STAILQ_FOREACH(entry, &g_placement_id_map, link) {
-		if (placement_id == entry->placement_id) {
-			assert(entry->group != NULL);
-			*group = entry->group;
-			break;
-		}
+	entry = sock_map_find_slot(placement_id);
+	if (entry && __atomic_load_n(&entry->placement_id, __ATOMIC_ACQUIRE) == placement_id) {
+		*group = __atomic_load_n(&entry->group, __ATOMIC_ACQUIRE);
 	}
-	pthread_mutex_unlock(&g_map_table_mutex);
 }
 
 /* Remove the socket group from the map table */
 static void
 sock_remove_sock_group_from_map_table(struct spdk_sock_group *group)
 {
-	struct spdk_sock_placement_id_entry *entry, *tmp;
+	struct spdk_sock_placement_id_entry *entry;
+	uint32_t i;
 
 	pthread_mutex_lock(&g_map_table_mutex);
-	STAILQ_FOREACH_SAFE(entry, &g_placement_id_map, link, tmp) {
+	for (i = 0; i < SPDK_SOCK_PLACEMENT_MAP_SIZE; i++) {
+		entry = &g_placement_id_map[i];
 		if (entry->group == group) {
-			STAILQ_REMOVE(&g_placement_id_map, entry, spdk_sock_placement_id_entry, link);
-			free(entry);
+			/* Keep the placement_id so the probe sequences of other ids stay intact. */
+			entry->ref = 0;
+			__atomic_store_n(&entry->group, NULL, __ATOMIC_RELEASE);
 		}
 	}
 	pthread_mutex_unlock(&g_map_table_mutex);
-
 }
 
 static int
@@ -222,6 +251,20 @@ sock_init_opts(struct spdk_sock_opts *opts, struct spdk_sock_opts *opts_user)
 	}
 }
 
+/*
+ * Implementations registered below the default priority are opt-in: they're
+ * only used when requested by name or set as the default implementation.
+ */
+static bool
+sock_impl_is_selected(struct spdk_net_impl *impl, const char *impl_name)
+{
+	if (impl_name) {
+		return strncmp(impl_name, impl->name, strlen(impl->name) + 1) == 0;
+	}
+
+	return impl->priority >= DEFAULT_SOCK_PRIORITY;
+}
+
 struct spdk_sock *
 spdk_sock_connect(const char *ip, int port, char *impl_name)
 {
@@ -252,7 +295,7 @@ spdk_sock_connect_ext(const char *ip, int port, char *_impl_name, struct spdk_so
 	}
 
 	STAILQ_FOREACH_FROM(impl, &g_net_impls, link) {
-		if (impl_name && strncmp(impl_name, impl->name, strlen(impl->name) + 1)) {
+		if (!sock_impl_is_selected(impl, impl_name)) {
 			continue;
 		}
 
@@ -302,7 +345,7 @@ spdk_sock_listen_ext(const char *ip, int port, char *_impl_name, struct spdk_soc
 	}
 
 	STAILQ_FOREACH_FROM(impl, &g_net_impls, link) {
-		if (impl_name && strncmp(impl_name, impl->name, strlen(impl->name) + 1)) {
+		if (!sock_impl_is_selected(impl, impl_name)) {
 			continue;
 		}
 
@@ -472,6 +515,16 @@ spdk_sock_set_sendbuf(struct spdk_sock *sock, int sz)
 	return sock->net_impl->set_sendbuf(sock, sz);
 }
 
+int
+spdk_sock_set_recv_hint(struct spdk_sock *sock, uint32_t hdr_len, uint32_t payload_len)
+{
+	if (sock->net_impl->set_recv_hint == NULL) {
+		return 0;
+	}
+
+	return sock->net_impl->set_recv_hint(sock, hdr_len, payload_len);
+}
+
 bool
 spdk_sock_is_ipv6(struct spdk_sock *sock)
 {
@@ -827,6 +880,7 @@ spdk_sock_write_config_json(struct spdk_json_write_ctx *w)
 			spdk_json_write_named_uint32(w, "send_buf_size", opts.send_buf_size);
 			spdk_json_write_named_bool(w, "enable_recv_pipe", opts.enable_recv_pipe);
 			spdk_json_write_named_bool(w, "enable_zerocopy_send", opts.enable_zerocopy_send);
+			spdk_json_write_named_uint32(w, "busy_poll_usec", opts.busy_poll_usec);
 			spdk_json_write_object_end(w);
 			spdk_json_write_object_end(w);
 		} else {
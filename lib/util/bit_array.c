@@ -365,10 +365,78 @@ spdk_bit_array_clear_mask(struct spdk_bit_array *ba)
 
 struct spdk_bit_pool {
 	struct spdk_bit_array	*array;
+	/*
+	 * Summary level with one bit per word of array, set when every bit of that
+	 * word is allocated. Searching for a free bit skips fully allocated words
+	 * 64 at a time instead of walking them one by one.
+	 */
+	struct spdk_bit_array	*full_words;
 	uint32_t		lowest_free_bit;
 	uint32_t		free_count;
 };
 
+static void
+bit_pool_update_summary(struct spdk_bit_pool *pool)
+{
+	uint32_t word_count = bit_array_word_count(pool->array->bit_count);
+	uint32_t i;
+
+	/*
+	 * The bits past bit_count in the last word are always cleared, so a partial
+	 * last word is never marked as full.
+	 */
+	for (i = 0; i < word_count; i++) {
+		if (pool->array->words[i] == SPDK_BIT_ARRAY_WORD_C(-1)) {
+			spdk_bit_array_set(pool->full_words, i);
+		} else {
+			spdk_bit_array_clear(pool->full_words, i);
+		}
+	}
+}
+
+static uint32_t
+bit_pool_find_first_free(const struct spdk_bit_pool *pool, uint32_t start_bit_index)
+{
+	const struct spdk_bit_array *array = pool->array;
+	uint32_t word_index, bit_index;
+	spdk_bit_array_word word;
+
+	if (spdk_unlikely(start_bit_index >= array->bit_count)) {
+		return UINT32_MAX;
+	}
+
+	/* Treat the bits below start_bit_index in the first word as allocated. */
+	word_index = start_bit_index >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT;
+	word = array->words[word_index] |
+	       bit_array_word_mask(start_bit_index & SPDK_BIT_ARRAY_WORD_INDEX_MASK);
+
+	if (word == SPDK_BIT_ARRAY_WORD_C(-1)) {
+		word_index = spdk_bit_array_find_first_clear(pool->full_words, word_index + 1);
+		if (word_index == UINT32_MAX) {
+			return UINT32_MAX;
+		}
+		word = array->words[word_index];
+	}
+
+	bit_index = (word_index << SPDK_BIT_ARRAY_WORD_INDEX_SHIFT) + SPDK_BIT_ARRAY_WORD_TZCNT(~word);
+	if (bit_index >= array->bit_count) {
+		return UINT32_MAX;
+	}
+
+	return bit_index;
+}
+
+static void
+bit_pool_set_bit(struct spdk_bit_pool *pool, uint32_t bit_index)
+{
+	uint32_t word_index = bit_index >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT;
+
+	spdk_bit_array_set(pool->array, bit_index);
+	if (pool->array->words[word_index] == SPDK_BIT_ARRAY_WORD_C(-1)) {
+		spdk_bit_array_set(pool->full_words, word_index);
+	}
+}
+
 struct spdk_bit_pool *
 spdk_bit_pool_create(uint32_t num_bits)
 {
@@ -386,6 +454,13 @@ spdk_bit_pool_create(uint32_t num_bits)
 		return NULL;
 	}
 
+	pool->full_words = spdk_bit_array_create(bit_array_word_count(num_bits));
+	if (pool->full_words == NULL) {
+		spdk_bit_array_free(&array);
+		free(pool);
+		return NULL;
+	}
+
 	pool->array = array;
 	pool->lowest_free_bit = 0;
 	pool->free_count = num_bits;
@@ -403,7 +478,14 @@ spdk_bit_pool_create_from_array(struct spdk_bit_array *array)
 		return NULL;
 	}
 
+	pool->full_words = spdk_bit_array_create(bit_array_word_count(array->bit_count));
+	if (pool->full_words == NULL) {
+		free(pool);
+		return NULL;
+	}
+
 	pool->array = array;
+	bit_pool_update_summary(pool);
 	pool->lowest_free_bit = spdk_bit_array_find_first_clear(array, 0);
 	pool->free_count = spdk_bit_array_count_clear(array);
 
@@ -423,6 +505,7 @@ spdk_bit_pool_free(struct spdk_bit_pool **ppool)
 	*ppool = NULL;
 	if (pool != NULL) {
 		spdk_bit_array_free(&pool->array);
+		spdk_bit_array_free(&pool->full_words);
 		free(pool);
 	}
 }
@@ -441,6 +524,13 @@ spdk_bit_pool_resize(struct spdk_bit_pool **ppool, uint32_t num_bits)
 		return rc;
 	}
 
+	rc = spdk_bit_array_resize(&pool->full_words, bit_array_word_count(num_bits));
+	if (rc) {
+		return rc;
+	}
+
+	bit_pool_update_summary(pool);
+
 	pool->lowest_free_bit = spdk_bit_array_find_first_clear(pool->array, 0);
 	pool->free_count = spdk_bit_array_count_clear(pool->array);
 
@@ -468,18 +558,42 @@ spdk_bit_pool_allocate_bit(struct spdk_bit_pool *pool)
 		return UINT32_MAX;
 	}
 
-	spdk_bit_array_set(pool->array, bit_index);
-	pool->lowest_free_bit = spdk_bit_array_find_first_clear(pool->array, bit_index);
+	bit_pool_set_bit(pool, bit_index);
+	pool->lowest_free_bit = bit_pool_find_first_free(pool, bit_index + 1);
 	pool->free_count--;
 	return bit_index;
 }
 
+uint32_t
+spdk_bit_pool_allocate_bits(struct spdk_bit_pool *pool, uint32_t max_bits, uint32_t *num_bits)
+{
+	uint32_t first_bit = pool->lowest_free_bit;
+	uint32_t count = 0;
+
+	*num_bits = 0;
+	if (first_bit == UINT32_MAX || max_bits == 0) {
+		return UINT32_MAX;
+	}
+
+	while (count < max_bits && first_bit + count < pool->array->bit_count &&
+	       !spdk_bit_array_get(pool->array, first_bit + count)) {
+		bit_pool_set_bit(pool, first_bit + count);
+		count++;
+	}
+
+	pool->lowest_free_bit = bit_pool_find_first_free(pool, first_bit + count);
+	pool->free_count -= count;
+	*num_bits = count;
+	return first_bit;
+}
+
 void
 spdk_bit_pool_free_bit(struct spdk_bit_pool *pool, uint32_t bit_index)
 {
 	assert(spdk_bit_array_get(pool->array, bit_index) == true);
 
 	spdk_bit_array_clear(pool->array, bit_index);
+	spdk_bit_array_clear(pool->full_words, bit_index >> SPDK_BIT_ARRAY_WORD_INDEX_SHIFT);
 	if (pool->lowest_free_bit > bit_index) {
 		pool->lowest_free_bit = bit_index;
 	}
@@ -508,6 +622,7 @@ void
 spdk_bit_pool_load_mask(struct spdk_bit_pool *pool, const void *mask)
 {
 	spdk_bit_array_load_mask(pool->array, mask);
+	bit_pool_update_summary(pool);
 	pool->lowest_free_bit = spdk_bit_array_find_first_clear(pool->array, 0);
 	pool->free_count = spdk_bit_array_count_clear(pool->array);
 }
@@ -516,6 +631,7 @@ void
 spdk_bit_pool_free_all_bits(struct spdk_bit_pool *pool)
 {
 	spdk_bit_array_clear_mask(pool->array);
+	spdk_bit_array_clear_mask(pool->full_words);
 	pool->lowest_free_bit = 0;
 	pool->free_count = spdk_bit_array_capacity(pool->array);
 }
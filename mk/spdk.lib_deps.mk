@@ -116,6 +116,7 @@ DEPDIRS-env_dpdk_rpc := log $(JSON_LIBS)
 # module/sock
 DEPDIRS-sock_posix := log sock util
 DEPDIRS-sock_uring := log sock util
+DEPDIRS-sock_memory := log sock util
 
 # module/bdev
 DEPDIRS-bdev_gpt := bdev json log thread util
@@ -91,7 +91,7 @@ BLOCKDEV_MODULES_LIST += bdev_pmem
 SYS_LIBS += -lpmemblk -lpmem
 endif
 
-SOCK_MODULES_LIST = sock_posix
+SOCK_MODULES_LIST = sock_posix sock_memory
 
 ifeq ($(OS), Linux)
 ifeq ($(CONFIG_URING),y)
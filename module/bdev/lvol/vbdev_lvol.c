@@ -45,11 +45,13 @@ static TAILQ_HEAD(, lvol_store_bdev) g_spdk_lvol_pairs = TAILQ_HEAD_INITIALIZER(
 
 static int vbdev_lvs_init(void);
 static int vbdev_lvs_get_ctx_size(void);
+static void vbdev_lvs_examine_config(struct spdk_bdev *bdev);
 static void vbdev_lvs_examine(struct spdk_bdev *bdev);
 
 static struct spdk_bdev_module g_lvol_if = {
 	.name = "lvol",
 	.module_init = vbdev_lvs_init,
+	.examine_config = vbdev_lvs_examine_config,
 	.examine_disk = vbdev_lvs_examine,
 	.get_ctx_size = vbdev_lvs_get_ctx_size,
 
@@ -160,6 +162,28 @@ vbdev_lvs_hotremove_cb(struct spdk_bdev *bdev)
 	}
 }
 
+static void
+_vbdev_lvs_resize_cb(void *cb_arg, int lvserrno)
+{
+	struct spdk_bdev *bdev = cb_arg;
+
+	if (lvserrno != 0) {
+		SPDK_ERRLOG("Cannot grow lvol store on resized bdev %s: %s\n",
+			    spdk_bdev_get_name(bdev), spdk_strerror(-lvserrno));
+	}
+}
+
+static void
+vbdev_lvs_resize_cb(struct spdk_bdev *bdev)
+{
+	struct lvol_store_bdev *lvs_bdev;
+
+	lvs_bdev = vbdev_get_lvs_bdev_by_bdev(bdev);
+	if (lvs_bdev != NULL) {
+		vbdev_lvs_grow(lvs_bdev->lvs, _vbdev_lvs_resize_cb, bdev);
+	}
+}
+
 static void
 vbdev_lvs_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
 			     void *event_ctx)
@@ -168,12 +192,59 @@ vbdev_lvs_base_bdev_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *b
 	case SPDK_BDEV_EVENT_REMOVE:
 		vbdev_lvs_hotremove_cb(bdev);
 		break;
+	case SPDK_BDEV_EVENT_RESIZE:
+		vbdev_lvs_resize_cb(bdev);
+		break;
+	default:
+		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+		break;
+	}
+}
+
+static void
+vbdev_lvol_esnap_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+			  void *event_ctx)
+{
+	switch (type) {
+	case SPDK_BDEV_EVENT_REMOVE:
+		SPDK_WARNLOG("External snapshot bdev %s is being removed, it stays open until "
+			     "its esnap clones are closed\n", spdk_bdev_get_name(bdev));
+		break;
 	default:
 		SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
 		break;
 	}
 }
 
+/* The external snapshot id of an esnap clone is the NUL terminated name of its bdev */
+static int
+vbdev_lvol_esnap_dev_create(void *bs_ctx, struct spdk_blob *blob, const void *esnap_id,
+			    uint32_t id_len, struct spdk_bs_dev **bs_dev)
+{
+	const char *name = esnap_id;
+	int rc;
+
+	if (id_len == 0 || strnlen(name, id_len) != id_len - 1) {
+		SPDK_ERRLOG("Invalid external snapshot bdev name\n");
+		return -EINVAL;
+	}
+
+	if (spdk_bdev_get_by_name(name) == NULL) {
+		/* The lvol stays in the lvol store, degraded, so that its name remains
+		 * taken. The bdev is opened when it gets registered. */
+		SPDK_NOTICELOG("External snapshot bdev %s is missing\n", name);
+		*bs_dev = NULL;
+		return 0;
+	}
+
+	rc = spdk_bdev_create_bs_dev_ro(name, vbdev_lvol_esnap_event_cb, NULL, bs_dev);
+	if (rc != 0) {
+		SPDK_ERRLOG("Cannot open external snapshot bdev %s: %s\n", name, spdk_strerror(-rc));
+	}
+
+	return rc;
+}
+
 static void
 _vbdev_lvs_create_cb(void *cb_arg, struct spdk_lvol_store *lvs, int lvserrno)
 {
@@ -218,7 +289,8 @@ end:
 
 int
 vbdev_lvs_create(const char *base_bdev_name, const char *name, uint32_t cluster_sz,
-		 enum lvs_clear_method clear_method, spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg)
+		 enum lvs_clear_method clear_method, uint64_t max_size,
+		 spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg)
 {
 	struct spdk_bs_dev *bs_dev;
 	struct spdk_lvs_with_handle_req *lvs_req;
@@ -240,6 +312,9 @@ vbdev_lvs_create(const char *base_bdev_name, const char *name, uint32_t cluster_
 		opts.clear_method = clear_method;
 	}
 
+	opts.max_size = max_size;
+	opts.esnap_bs_dev_create = vbdev_lvol_esnap_dev_create;
+
 	if (name == NULL) {
 		SPDK_ERRLOG("missing name param\n");
 		return -EINVAL;
@@ -329,6 +404,34 @@ vbdev_lvs_rename(struct spdk_lvol_store *lvs, const char *new_lvs_name,
 	spdk_lvs_rename(lvs, new_lvs_name, _vbdev_lvs_rename_cb, req);
 }
 
+void
+vbdev_lvs_grow(struct spdk_lvol_store *lvs, spdk_lvs_op_complete cb_fn, void *cb_arg)
+{
+	struct lvol_store_bdev *lvs_bdev;
+	uint64_t num_blocks;
+
+	lvs_bdev = vbdev_get_lvs_bdev_by_lvs(lvs);
+	if (!lvs_bdev) {
+		SPDK_ERRLOG("No such lvol store found\n");
+		cb_fn(cb_arg, -ENODEV);
+		return;
+	}
+
+	/* The blobstore can't shrink, and clusters past the new end may be in use */
+	num_blocks = spdk_bdev_get_num_blocks(lvs_bdev->bdev);
+	if (num_blocks < lvs->bs_dev->blockcnt) {
+		SPDK_ERRLOG("Base bdev %s shrank from %" PRIu64 " to %" PRIu64 " blocks\n",
+			    spdk_bdev_get_name(lvs_bdev->bdev), lvs->bs_dev->blockcnt, num_blocks);
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	/* The bs_dev was sized when the lvol store was opened */
+	lvs->bs_dev->blockcnt = num_blocks;
+
+	spdk_lvs_grow(lvs, cb_fn, cb_arg);
+}
+
 static void
 _vbdev_lvs_remove_cb(void *cb_arg, int lvserrno)
 {
@@ -690,6 +793,18 @@ vbdev_lvol_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 		}
 	}
 
+	spdk_json_write_named_bool(w, "esnap_clone", spdk_blob_is_esnap_clone(blob));
+
+	if (spdk_blob_is_esnap_clone(blob)) {
+		const void *esnap_id;
+		size_t id_len;
+
+		if (spdk_blob_get_esnap_id(blob, &esnap_id, &id_len) == 0 && id_len > 0 &&
+		    strnlen(esnap_id, id_len) == id_len - 1) {
+			spdk_json_write_named_string(w, "external_snapshot_name", esnap_id);
+		}
+	}
+
 	if (spdk_blob_is_snapshot(blob)) {
 		/* Take a number of clones */
 		rc = spdk_blob_get_clones(lvol->lvol_store->blobstore, lvol->blob_id, NULL, &count);
@@ -1057,6 +1172,56 @@ vbdev_lvol_create_clone(struct spdk_lvol *lvol, const char *clone_name,
 	spdk_lvol_create_clone(lvol, clone_name, _vbdev_lvol_create_cb, req);
 }
 
+int
+vbdev_lvol_create_bdev_clone(const char *esnap_name, struct spdk_lvol_store *lvs,
+			     const char *clone_name, spdk_lvol_op_with_handle_complete cb_fn,
+			     void *cb_arg)
+{
+	struct spdk_lvol_with_handle_req *req;
+	struct spdk_bdev *bdev;
+	uint64_t sz;
+	int rc;
+
+	if (lvs == NULL) {
+		SPDK_ERRLOG("lvol store does not exist\n");
+		return -EINVAL;
+	}
+
+	bdev = spdk_bdev_get_by_name(esnap_name);
+	if (bdev == NULL) {
+		SPDK_ERRLOG("bdev %s does not exist\n", esnap_name);
+		return -ENODEV;
+	}
+
+	if (spdk_bs_get_io_unit_size(lvs->blobstore) % spdk_bdev_get_block_size(bdev) != 0) {
+		SPDK_ERRLOG("Block size of bdev %s does not divide the lvol store io unit size\n",
+			    esnap_name);
+		return -EINVAL;
+	}
+
+	sz = spdk_bdev_get_num_blocks(bdev) * spdk_bdev_get_block_size(bdev);
+	if (sz % spdk_bs_get_cluster_size(lvs->blobstore) != 0) {
+		SPDK_ERRLOG("Size of bdev %s is not a multiple of the lvol store cluster size\n",
+			    esnap_name);
+		return -EINVAL;
+	}
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL) {
+		return -ENOMEM;
+	}
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+
+	rc = spdk_lvol_create_esnap_clone(esnap_name, strlen(esnap_name) + 1, sz, lvs, clone_name,
+					  _vbdev_lvol_create_cb, req);
+	if (rc != 0) {
+		free(req);
+	}
+
+	return rc;
+}
+
 static void
 _vbdev_lvol_rename_cb(void *cb_arg, int lvolerrno)
 {
@@ -1190,6 +1355,67 @@ vbdev_lvol_set_read_only(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, vo
 	spdk_lvol_set_read_only(lvol, _vbdev_lvol_set_read_only_cb, req);
 }
 
+static void
+vbdev_lvol_shallow_copy_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+				 void *event_ctx)
+{
+	SPDK_NOTICELOG("Unsupported bdev event: type %d\n", type);
+}
+
+static void
+_vbdev_lvol_shallow_copy_cb(void *cb_arg, int lvolerrno)
+{
+	struct spdk_lvol_req *req = cb_arg;
+
+	req->ext_dev->destroy(req->ext_dev);
+	req->cb_fn(req->cb_arg, lvolerrno);
+	free(req);
+}
+
+void
+vbdev_lvol_shallow_copy(struct spdk_lvol *lvol, const char *bdev_name,
+			spdk_lvol_op_complete cb_fn, void *cb_arg)
+{
+	struct spdk_lvol_req *req;
+	int rc;
+
+	if (lvol == NULL) {
+		SPDK_ERRLOG("lvol does not exist\n");
+		cb_fn(cb_arg, -EINVAL);
+		return;
+	}
+
+	req = calloc(1, sizeof(*req));
+	if (req == NULL) {
+		cb_fn(cb_arg, -ENOMEM);
+		return;
+	}
+
+	rc = spdk_bdev_create_bs_dev_ext(bdev_name, vbdev_lvol_shallow_copy_event_cb, NULL,
+					 &req->ext_dev);
+	if (rc != 0) {
+		SPDK_ERRLOG("Cannot open bdev %s: %s\n", bdev_name, spdk_strerror(-rc));
+		free(req);
+		cb_fn(cb_arg, rc);
+		return;
+	}
+
+	/* Nobody else may write the bdev while the copy is in progress */
+	rc = spdk_bs_bdev_claim(req->ext_dev, &g_lvol_if);
+	if (rc != 0) {
+		req->ext_dev->destroy(req->ext_dev);
+		free(req);
+		cb_fn(cb_arg, rc);
+		return;
+	}
+
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+	req->lvol = lvol;
+
+	spdk_lvol_shallow_copy(lvol, req->ext_dev, _vbdev_lvol_shallow_copy_cb, req);
+}
+
 static int
 vbdev_lvs_init(void)
 {
@@ -1308,11 +1534,60 @@ end:
 	free(req);
 }
 
+static void
+vbdev_lvol_set_esnap_cb(void *cb_arg, int lvolerrno)
+{
+	struct spdk_lvol *lvol = cb_arg;
+
+	if (lvolerrno != 0) {
+		SPDK_ERRLOG("Cannot set external snapshot of lvol %s: %s\n", lvol->unique_id,
+			    spdk_strerror(-lvolerrno));
+		return;
+	}
+
+	SPDK_NOTICELOG("External snapshot of lvol %s is available\n", lvol->unique_id);
+}
+
+/* Open the bdev for the esnap clones that were loaded before it was registered */
+static void
+vbdev_lvs_examine_config(struct spdk_bdev *bdev)
+{
+	struct lvol_store_bdev *lvs_bdev;
+	struct spdk_lvol *lvol;
+	struct spdk_bs_dev *bs_dev;
+	const char *name = spdk_bdev_get_name(bdev);
+	const void *esnap_id;
+	size_t id_len;
+	int rc;
+
+	for (lvs_bdev = vbdev_lvol_store_first(); lvs_bdev != NULL;
+	     lvs_bdev = vbdev_lvol_store_next(lvs_bdev)) {
+		TAILQ_FOREACH(lvol, &lvs_bdev->lvs->lvols, link) {
+			if (lvol->blob == NULL || !spdk_blob_is_degraded(lvol->blob) ||
+			    spdk_blob_get_esnap_id(lvol->blob, &esnap_id, &id_len) != 0 ||
+			    id_len != strlen(name) + 1 || memcmp(esnap_id, name, id_len) != 0) {
+				continue;
+			}
+
+			rc = spdk_bdev_create_bs_dev_ro(name, vbdev_lvol_esnap_event_cb, NULL, &bs_dev);
+			if (rc != 0) {
+				SPDK_ERRLOG("Cannot open external snapshot bdev %s: %s\n", name,
+					    spdk_strerror(-rc));
+				continue;
+			}
+			spdk_blob_set_esnap_bs_dev(lvol->blob, bs_dev, vbdev_lvol_set_esnap_cb, lvol);
+		}
+	}
+
+	spdk_bdev_module_examine_done(&g_lvol_if);
+}
+
 static void
 vbdev_lvs_examine(struct spdk_bdev *bdev)
 {
 	struct spdk_bs_dev *bs_dev;
 	struct spdk_lvs_with_handle_req *req;
+	struct spdk_lvs_opts opts;
 	int rc;
 
 	req = calloc(1, sizeof(*req));
@@ -1333,7 +1608,10 @@ vbdev_lvs_examine(struct spdk_bdev *bdev)
 
 	req->base_bdev = bdev;
 
-	spdk_lvs_load(bs_dev, _vbdev_lvs_examine_cb, req);
+	spdk_lvs_opts_init(&opts);
+	opts.esnap_bs_dev_create = vbdev_lvol_esnap_dev_create;
+
+	spdk_lvs_load_ext(bs_dev, &opts, _vbdev_lvs_examine_cb, req);
 }
 
 struct spdk_lvol *
@@ -48,7 +48,8 @@ struct lvol_store_bdev {
 };
 
 int vbdev_lvs_create(const char *base_bdev_name, const char *name, uint32_t cluster_sz,
-		     enum lvs_clear_method clear_method, spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg);
+		     enum lvs_clear_method clear_method, uint64_t max_size,
+		     spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg);
 void vbdev_lvs_destruct(struct spdk_lvol_store *lvs, spdk_lvs_op_complete cb_fn, void *cb_arg);
 void vbdev_lvs_unload(struct spdk_lvol_store *lvs, spdk_lvs_op_complete cb_fn, void *cb_arg);
 
@@ -63,6 +64,19 @@ void vbdev_lvol_create_snapshot(struct spdk_lvol *lvol, const char *snapshot_nam
 void vbdev_lvol_create_clone(struct spdk_lvol *lvol, const char *clone_name,
 			     spdk_lvol_op_with_handle_complete cb_fn, void *cb_arg);
 
+/**
+ * \brief Create a thin provisioned lvol whose unallocated clusters are read from a bdev
+ * \param esnap_name Name of the read-only bdev used as the external snapshot
+ * \param lvs Handle to lvolstore
+ * \param clone_name Name of created clone
+ * \param cb_fn Completion callback
+ * \param cb_arg Completion callback custom arguments
+ * \return 0 on success, negative errno on failure
+ */
+int vbdev_lvol_create_bdev_clone(const char *esnap_name, struct spdk_lvol_store *lvs,
+				 const char *clone_name, spdk_lvol_op_with_handle_complete cb_fn,
+				 void *cb_arg);
+
 /**
  * \brief Change size of lvol
  * \param lvol Handle to lvol
@@ -82,6 +96,16 @@ void vbdev_lvol_resize(struct spdk_lvol *lvol, uint64_t sz, spdk_lvol_op_complet
  */
 void vbdev_lvol_set_read_only(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, void *cb_arg);
 
+/**
+ * \brief Copy the clusters allocated in a read-only lvol to a bdev
+ * \param lvol Handle to lvol
+ * \param bdev_name Name of the bdev to copy to, claimed during the copy
+ * \param cb_fn Completion callback
+ * \param cb_arg Completion callback custom arguments
+ */
+void vbdev_lvol_shallow_copy(struct spdk_lvol *lvol, const char *bdev_name,
+			     spdk_lvol_op_complete cb_fn, void *cb_arg);
+
 void vbdev_lvol_rename(struct spdk_lvol *lvol, const char *new_lvol_name,
 		       spdk_lvol_op_complete cb_fn, void *cb_arg);
 
@@ -104,6 +128,15 @@ void vbdev_lvol_destroy(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, voi
 void vbdev_lvs_rename(struct spdk_lvol_store *lvs, const char *new_lvs_name,
 		      spdk_lvs_op_complete cb_fn, void *cb_arg);
 
+/**
+ * \brief Grows given lvolstore to the current size of its base bdev.
+ *
+ * \param lvs Pointer to lvolstore
+ * \param cb_fn Completion callback
+ * \param cb_arg Completion callback custom arguments
+ */
+void vbdev_lvs_grow(struct spdk_lvol_store *lvs, spdk_lvs_op_complete cb_fn, void *cb_arg);
+
 /**
  * \brief Search for handle lvolstore
  * \param uuid_str UUID of lvolstore
@@ -45,6 +45,7 @@ struct rpc_bdev_lvol_create_lvstore {
 	char *bdev_name;
 	uint32_t cluster_sz;
 	char *clear_method;
+	uint64_t max_size;
 };
 
 static int
@@ -90,6 +91,7 @@ static const struct spdk_json_object_decoder rpc_bdev_lvol_create_lvstore_decode
 	{"cluster_sz", offsetof(struct rpc_bdev_lvol_create_lvstore, cluster_sz), spdk_json_decode_uint32, true},
 	{"lvs_name", offsetof(struct rpc_bdev_lvol_create_lvstore, lvs_name), spdk_json_decode_string},
 	{"clear_method", offsetof(struct rpc_bdev_lvol_create_lvstore, clear_method), spdk_json_decode_string, true},
+	{"max_size", offsetof(struct rpc_bdev_lvol_create_lvstore, max_size), spdk_json_decode_uint64, true},
 };
 
 static void
@@ -148,7 +150,7 @@ rpc_bdev_lvol_create_lvstore(struct spdk_jsonrpc_request *request,
 	}
 
 	rc = vbdev_lvs_create(req.bdev_name, req.lvs_name, req.cluster_sz, clear_method,
-			      rpc_lvol_store_construct_cb, request);
+			      req.max_size, rpc_lvol_store_construct_cb, request);
 	if (rc < 0) {
 		spdk_jsonrpc_send_error_response(request, -rc, spdk_strerror(rc));
 		goto cleanup;
@@ -299,6 +301,73 @@ cleanup:
 SPDK_RPC_REGISTER("bdev_lvol_delete_lvstore", rpc_bdev_lvol_delete_lvstore, SPDK_RPC_RUNTIME)
 SPDK_RPC_REGISTER_ALIAS_DEPRECATED(bdev_lvol_delete_lvstore, destroy_lvol_store)
 
+struct rpc_bdev_lvol_grow_lvstore {
+	char *uuid;
+	char *lvs_name;
+};
+
+static void
+free_rpc_bdev_lvol_grow_lvstore(struct rpc_bdev_lvol_grow_lvstore *req)
+{
+	free(req->uuid);
+	free(req->lvs_name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_lvol_grow_lvstore_decoders[] = {
+	{"uuid", offsetof(struct rpc_bdev_lvol_grow_lvstore, uuid), spdk_json_decode_string, true},
+	{"lvs_name", offsetof(struct rpc_bdev_lvol_grow_lvstore, lvs_name), spdk_json_decode_string, true},
+};
+
+static void
+rpc_bdev_lvol_grow_lvstore_cb(void *cb_arg, int lvserrno)
+{
+	struct spdk_json_write_ctx *w;
+	struct spdk_jsonrpc_request *request = cb_arg;
+
+	if (lvserrno != 0) {
+		goto invalid;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_bool(w, true);
+	spdk_jsonrpc_end_result(request, w);
+	return;
+
+invalid:
+	spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+					 spdk_strerror(-lvserrno));
+}
+
+static void
+rpc_bdev_lvol_grow_lvstore(struct spdk_jsonrpc_request *request,
+			   const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_grow_lvstore req = {};
+	struct spdk_lvol_store *lvs = NULL;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_lvol_grow_lvstore_decoders,
+				    SPDK_COUNTOF(rpc_bdev_lvol_grow_lvstore_decoders),
+				    &req)) {
+		SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = vbdev_get_lvol_store_by_uuid_xor_name(req.uuid, req.lvs_name, &lvs);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	vbdev_lvs_grow(lvs, rpc_bdev_lvol_grow_lvstore_cb, request);
+
+cleanup:
+	free_rpc_bdev_lvol_grow_lvstore(&req);
+}
+SPDK_RPC_REGISTER("bdev_lvol_grow_lvstore", rpc_bdev_lvol_grow_lvstore, SPDK_RPC_RUNTIME)
+
 struct rpc_bdev_lvol_create {
 	char *uuid;
 	char *lvs_name;
@@ -559,6 +628,68 @@ cleanup:
 SPDK_RPC_REGISTER("bdev_lvol_clone", rpc_bdev_lvol_clone, SPDK_RPC_RUNTIME)
 SPDK_RPC_REGISTER_ALIAS_DEPRECATED(bdev_lvol_clone, clone_lvol_bdev)
 
+struct rpc_bdev_lvol_clone_bdev {
+	/* Name of the bdev used as the external snapshot, stored in the clone's metadata */
+	char *bdev_name;
+	char *uuid;
+	char *lvs_name;
+	char *clone_name;
+};
+
+static void
+free_rpc_bdev_lvol_clone_bdev(struct rpc_bdev_lvol_clone_bdev *req)
+{
+	free(req->bdev_name);
+	free(req->uuid);
+	free(req->lvs_name);
+	free(req->clone_name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_lvol_clone_bdev_decoders[] = {
+	{"bdev", offsetof(struct rpc_bdev_lvol_clone_bdev, bdev_name), spdk_json_decode_string},
+	{"uuid", offsetof(struct rpc_bdev_lvol_clone_bdev, uuid), spdk_json_decode_string, true},
+	{"lvs_name", offsetof(struct rpc_bdev_lvol_clone_bdev, lvs_name), spdk_json_decode_string, true},
+	{"clone_name", offsetof(struct rpc_bdev_lvol_clone_bdev, clone_name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_lvol_clone_bdev(struct spdk_jsonrpc_request *request,
+			 const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_clone_bdev req = {};
+	struct spdk_lvol_store *lvs = NULL;
+	int rc;
+
+	SPDK_INFOLOG(lvol_rpc, "Cloning bdev\n");
+
+	if (spdk_json_decode_object(params, rpc_bdev_lvol_clone_bdev_decoders,
+				    SPDK_COUNTOF(rpc_bdev_lvol_clone_bdev_decoders),
+				    &req)) {
+		SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	rc = vbdev_get_lvol_store_by_uuid_xor_name(req.uuid, req.lvs_name, &lvs);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	rc = vbdev_lvol_create_bdev_clone(req.bdev_name, lvs, req.clone_name,
+					  rpc_bdev_lvol_clone_cb, request);
+	if (rc < 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+cleanup:
+	free_rpc_bdev_lvol_clone_bdev(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_clone_bdev", rpc_bdev_lvol_clone_bdev, SPDK_RPC_RUNTIME)
+
 struct rpc_bdev_lvol_rename {
 	char *old_name;
 	char *new_name;
@@ -756,6 +887,478 @@ cleanup:
 SPDK_RPC_REGISTER("bdev_lvol_decouple_parent", rpc_bdev_lvol_decouple_parent, SPDK_RPC_RUNTIME)
 SPDK_RPC_REGISTER_ALIAS_DEPRECATED(bdev_lvol_decouple_parent, decouple_parent_lvol_bdev)
 
+struct rpc_bdev_lvol_start_inflate {
+	char *name;
+	bool decouple_parent;
+	uint64_t max_mbytes_per_sec;
+	uint32_t max_inflight_clusters;
+};
+
+static void
+free_rpc_bdev_lvol_start_inflate(struct rpc_bdev_lvol_start_inflate *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_lvol_start_inflate_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_lvol_start_inflate, name), spdk_json_decode_string},
+	{"decouple_parent", offsetof(struct rpc_bdev_lvol_start_inflate, decouple_parent), spdk_json_decode_bool, true},
+	{"max_mbytes_per_sec", offsetof(struct rpc_bdev_lvol_start_inflate, max_mbytes_per_sec), spdk_json_decode_uint64, true},
+	{"max_inflight_clusters", offsetof(struct rpc_bdev_lvol_start_inflate, max_inflight_clusters), spdk_json_decode_uint32, true},
+};
+
+static struct spdk_lvol *
+rpc_bdev_lvol_get_by_name(struct spdk_jsonrpc_request *request, const char *name)
+{
+	struct spdk_bdev *bdev;
+	struct spdk_lvol *lvol;
+
+	bdev = spdk_bdev_get_by_name(name);
+	if (bdev == NULL) {
+		SPDK_ERRLOG("bdev '%s' does not exist\n", name);
+		spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+		return NULL;
+	}
+
+	lvol = vbdev_lvol_get_from_bdev(bdev);
+	if (lvol == NULL) {
+		SPDK_ERRLOG("lvol does not exist\n");
+		spdk_jsonrpc_send_error_response(request, -ENODEV, spdk_strerror(ENODEV));
+		return NULL;
+	}
+
+	return lvol;
+}
+
+static void
+rpc_bdev_lvol_start_inflate_done(void *cb_arg, int lvolerrno)
+{
+	struct spdk_lvol *lvol = cb_arg;
+
+	if (lvolerrno == 0) {
+		SPDK_NOTICELOG("Background inflate of lvol %s finished\n", lvol->unique_id);
+	} else if (lvolerrno == -ECANCELED) {
+		SPDK_NOTICELOG("Background inflate of lvol %s cancelled\n", lvol->unique_id);
+	}
+}
+
+static void
+rpc_bdev_lvol_start_inflate(struct spdk_jsonrpc_request *request,
+			    const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_start_inflate req = {};
+	struct spdk_blob_inflate_opts opts;
+	struct spdk_json_write_ctx *w;
+	struct spdk_lvol *lvol;
+	int rc;
+
+	SPDK_INFOLOG(lvol_rpc, "Starting background inflate of lvol\n");
+
+	spdk_blob_inflate_opts_init(&opts);
+	req.max_inflight_clusters = opts.max_inflight;
+
+	if (spdk_json_decode_object(params, rpc_bdev_lvol_start_inflate_decoders,
+				    SPDK_COUNTOF(rpc_bdev_lvol_start_inflate_decoders),
+				    &req)) {
+		SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	lvol = rpc_bdev_lvol_get_by_name(request, req.name);
+	if (lvol == NULL) {
+		goto cleanup;
+	}
+
+	opts.decouple_parent = req.decouple_parent;
+	opts.max_inflight = req.max_inflight_clusters;
+	opts.max_bytes_per_sec = req.max_mbytes_per_sec * 1024 * 1024;
+
+	rc = spdk_lvol_start_inflate(lvol, &opts, rpc_bdev_lvol_start_inflate_done, lvol);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_bool(w, true);
+	spdk_jsonrpc_end_result(request, w);
+
+cleanup:
+	free_rpc_bdev_lvol_start_inflate(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_start_inflate", rpc_bdev_lvol_start_inflate, SPDK_RPC_RUNTIME)
+
+static void
+rpc_bdev_lvol_inflate_job_op(struct spdk_jsonrpc_request *request,
+			     const struct spdk_json_val *params,
+			     void (*op)(struct spdk_blob_inflate_job *job))
+{
+	struct rpc_bdev_lvol_inflate req = {};
+	struct spdk_json_write_ctx *w;
+	struct spdk_blob_inflate_job *job;
+	struct spdk_lvol *lvol;
+
+	if (spdk_json_decode_object(params, rpc_bdev_lvol_inflate_decoders,
+				    SPDK_COUNTOF(rpc_bdev_lvol_inflate_decoders),
+				    &req)) {
+		SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	lvol = rpc_bdev_lvol_get_by_name(request, req.name);
+	if (lvol == NULL) {
+		goto cleanup;
+	}
+
+	job = spdk_lvol_get_inflate_job(lvol);
+	if (job == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOENT, spdk_strerror(ENOENT));
+		goto cleanup;
+	}
+
+	op(job);
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_bool(w, true);
+	spdk_jsonrpc_end_result(request, w);
+
+cleanup:
+	free_rpc_bdev_lvol_inflate(&req);
+}
+
+static void
+rpc_bdev_lvol_pause_inflate(struct spdk_jsonrpc_request *request,
+			    const struct spdk_json_val *params)
+{
+	rpc_bdev_lvol_inflate_job_op(request, params, spdk_blob_inflate_job_pause);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_pause_inflate", rpc_bdev_lvol_pause_inflate, SPDK_RPC_RUNTIME)
+
+static void
+rpc_bdev_lvol_resume_inflate(struct spdk_jsonrpc_request *request,
+			     const struct spdk_json_val *params)
+{
+	rpc_bdev_lvol_inflate_job_op(request, params, spdk_blob_inflate_job_resume);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_resume_inflate", rpc_bdev_lvol_resume_inflate, SPDK_RPC_RUNTIME)
+
+static void
+rpc_bdev_lvol_cancel_inflate(struct spdk_jsonrpc_request *request,
+			     const struct spdk_json_val *params)
+{
+	rpc_bdev_lvol_inflate_job_op(request, params, spdk_blob_inflate_job_cancel);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_cancel_inflate", rpc_bdev_lvol_cancel_inflate, SPDK_RPC_RUNTIME)
+
+static void
+rpc_dump_lvol_inflate_job(struct spdk_json_write_ctx *w, struct spdk_lvol *lvol)
+{
+	struct spdk_blob_inflate_progress progress;
+	const char *state;
+
+	spdk_blob_inflate_job_get_progress(spdk_lvol_get_inflate_job(lvol), &progress);
+
+	if (progress.cancelled) {
+		state = "cancelling";
+	} else if (progress.paused) {
+		state = "paused";
+	} else {
+		state = "running";
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(lvol->bdev));
+	spdk_json_write_named_string(w, "uuid", lvol->uuid_str);
+	spdk_json_write_named_string(w, "state", state);
+	spdk_json_write_named_uint64(w, "clusters_total", progress.clusters_total);
+	spdk_json_write_named_uint64(w, "clusters_done", progress.clusters_done);
+	spdk_json_write_named_uint64(w, "elapsed_ms", progress.elapsed_usec / 1000);
+	if (progress.eta_usec != UINT64_MAX) {
+		spdk_json_write_named_uint64(w, "eta_ms", progress.eta_usec / 1000);
+	}
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_bdev_lvol_get_inflate_jobs(struct spdk_jsonrpc_request *request,
+			       const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_inflate req = {};
+	struct spdk_json_write_ctx *w;
+	struct lvol_store_bdev *lvs_bdev;
+	struct spdk_lvol *lvol = NULL;
+
+	if (params != NULL) {
+		if (spdk_json_decode_object(params, rpc_bdev_lvol_inflate_decoders,
+					    SPDK_COUNTOF(rpc_bdev_lvol_inflate_decoders),
+					    &req)) {
+			SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+							 "spdk_json_decode_object failed");
+			goto cleanup;
+		}
+
+		lvol = rpc_bdev_lvol_get_by_name(request, req.name);
+		if (lvol == NULL) {
+			goto cleanup;
+		}
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_array_begin(w);
+
+	if (lvol != NULL) {
+		if (spdk_lvol_get_inflate_job(lvol) != NULL) {
+			rpc_dump_lvol_inflate_job(w, lvol);
+		}
+	} else {
+		for (lvs_bdev = vbdev_lvol_store_first(); lvs_bdev != NULL;
+		     lvs_bdev = vbdev_lvol_store_next(lvs_bdev)) {
+			TAILQ_FOREACH(lvol, &lvs_bdev->lvs->lvols, link) {
+				if (lvol->bdev != NULL && spdk_lvol_get_inflate_job(lvol) != NULL) {
+					rpc_dump_lvol_inflate_job(w, lvol);
+				}
+			}
+		}
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_jsonrpc_end_result(request, w);
+
+cleanup:
+	free_rpc_bdev_lvol_inflate(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_get_inflate_jobs", rpc_bdev_lvol_get_inflate_jobs, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_lvol_shallow_copy {
+	char *src_lvol_name;
+	char *dst_bdev_name;
+};
+
+static void
+free_rpc_bdev_lvol_shallow_copy(struct rpc_bdev_lvol_shallow_copy *req)
+{
+	free(req->src_lvol_name);
+	free(req->dst_bdev_name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_lvol_shallow_copy_decoders[] = {
+	{"src_lvol_name", offsetof(struct rpc_bdev_lvol_shallow_copy, src_lvol_name), spdk_json_decode_string},
+	{"dst_bdev_name", offsetof(struct rpc_bdev_lvol_shallow_copy, dst_bdev_name), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_lvol_shallow_copy(struct spdk_jsonrpc_request *request,
+			   const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_shallow_copy req = {};
+	struct spdk_lvol *lvol;
+
+	SPDK_INFOLOG(lvol_rpc, "Shallow copying lvol\n");
+
+	if (spdk_json_decode_object(params, rpc_bdev_lvol_shallow_copy_decoders,
+				    SPDK_COUNTOF(rpc_bdev_lvol_shallow_copy_decoders),
+				    &req)) {
+		SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	lvol = rpc_bdev_lvol_get_by_name(request, req.src_lvol_name);
+	if (lvol == NULL) {
+		goto cleanup;
+	}
+
+	vbdev_lvol_shallow_copy(lvol, req.dst_bdev_name, rpc_bdev_lvol_inflate_cb, request);
+
+cleanup:
+	free_rpc_bdev_lvol_shallow_copy(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_shallow_copy", rpc_bdev_lvol_shallow_copy, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_lvol_set_io_stat {
+	char *name;
+	bool enable;
+	uint32_t heatmap_sample_rate;
+};
+
+static void
+free_rpc_bdev_lvol_set_io_stat(struct rpc_bdev_lvol_set_io_stat *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_lvol_set_io_stat_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_lvol_set_io_stat, name), spdk_json_decode_string},
+	{"enable", offsetof(struct rpc_bdev_lvol_set_io_stat, enable), spdk_json_decode_bool},
+	{"heatmap_sample_rate", offsetof(struct rpc_bdev_lvol_set_io_stat, heatmap_sample_rate), spdk_json_decode_uint32, true},
+};
+
+static void
+rpc_bdev_lvol_set_io_stat(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_set_io_stat req = {};
+	struct spdk_lvol *lvol;
+
+	if (spdk_json_decode_object(params, rpc_bdev_lvol_set_io_stat_decoders,
+				    SPDK_COUNTOF(rpc_bdev_lvol_set_io_stat_decoders),
+				    &req)) {
+		SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	lvol = rpc_bdev_lvol_get_by_name(request, req.name);
+	if (lvol == NULL) {
+		goto cleanup;
+	}
+
+	spdk_blob_set_io_stat(lvol->blob, req.enable, req.heatmap_sample_rate,
+			      rpc_bdev_lvol_inflate_cb, request);
+
+cleanup:
+	free_rpc_bdev_lvol_set_io_stat(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_set_io_stat", rpc_bdev_lvol_set_io_stat, SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_lvol_get_io_stat {
+	char *name;
+	bool heatmap;
+};
+
+static void
+free_rpc_bdev_lvol_get_io_stat(struct rpc_bdev_lvol_get_io_stat *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_lvol_get_io_stat_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_lvol_get_io_stat, name), spdk_json_decode_string, true},
+	{"heatmap", offsetof(struct rpc_bdev_lvol_get_io_stat, heatmap), spdk_json_decode_bool, true},
+};
+
+#define RPC_LVOL_HEATMAP_CHUNK	256
+
+static void
+rpc_dump_lvol_io_heatmap(struct spdk_json_write_ctx *w, struct spdk_lvol *lvol)
+{
+	uint32_t counts[RPC_LVOL_HEATMAP_CHUNK];
+	uint64_t start, num, i;
+
+	/* Only clusters that were accessed are listed */
+	spdk_json_write_named_array_begin(w, "heatmap");
+	for (start = 0;; start += num) {
+		num = spdk_blob_get_io_heatmap(lvol->blob, start, counts, SPDK_COUNTOF(counts));
+		if (num == 0) {
+			break;
+		}
+		for (i = 0; i < num; i++) {
+			if (counts[i] == 0) {
+				continue;
+			}
+			spdk_json_write_object_begin(w);
+			spdk_json_write_named_uint64(w, "cluster", start + i);
+			spdk_json_write_named_uint32(w, "count", counts[i]);
+			spdk_json_write_object_end(w);
+		}
+	}
+	spdk_json_write_array_end(w);
+}
+
+static void
+rpc_dump_lvol_io_stat(struct spdk_json_write_ctx *w, struct spdk_lvol *lvol, bool heatmap)
+{
+	struct spdk_blob_io_stat stat;
+
+	if (spdk_blob_get_io_stat(lvol->blob, &stat) != 0) {
+		return;
+	}
+
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(lvol->bdev));
+	spdk_json_write_named_string(w, "uuid", lvol->uuid_str);
+	spdk_json_write_named_uint64(w, "num_read_ops", stat.num_read_ops);
+	spdk_json_write_named_uint64(w, "bytes_read", stat.bytes_read);
+	spdk_json_write_named_uint64(w, "num_write_ops", stat.num_write_ops);
+	spdk_json_write_named_uint64(w, "bytes_written", stat.bytes_written);
+	spdk_json_write_named_uint64(w, "num_unmap_ops", stat.num_unmap_ops);
+	spdk_json_write_named_uint64(w, "num_write_zeroes_ops", stat.num_write_zeroes_ops);
+	spdk_json_write_named_uint64(w, "num_clusters_allocated", stat.num_clusters_allocated);
+	spdk_json_write_named_uint64(w, "num_cow_copies", stat.num_cow_copies);
+	spdk_json_write_named_uint64(w, "num_backing_dev_reads", stat.num_backing_dev_reads);
+	spdk_json_write_named_uint64(w, "bytes_backing_dev_read", stat.bytes_backing_dev_read);
+	if (heatmap) {
+		rpc_dump_lvol_io_heatmap(w, lvol);
+	}
+	spdk_json_write_object_end(w);
+}
+
+static void
+rpc_bdev_lvol_get_io_stat(struct spdk_jsonrpc_request *request,
+			  const struct spdk_json_val *params)
+{
+	struct rpc_bdev_lvol_get_io_stat req = {};
+	struct spdk_json_write_ctx *w;
+	struct lvol_store_bdev *lvs_bdev;
+	struct spdk_lvol *lvol = NULL;
+
+	if (params != NULL) {
+		if (spdk_json_decode_object(params, rpc_bdev_lvol_get_io_stat_decoders,
+					    SPDK_COUNTOF(rpc_bdev_lvol_get_io_stat_decoders),
+					    &req)) {
+			SPDK_INFOLOG(lvol_rpc, "spdk_json_decode_object failed\n");
+			spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+							 "spdk_json_decode_object failed");
+			goto cleanup;
+		}
+
+		if (req.name != NULL) {
+			lvol = rpc_bdev_lvol_get_by_name(request, req.name);
+			if (lvol == NULL) {
+				goto cleanup;
+			}
+		}
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_array_begin(w);
+
+	if (lvol != NULL) {
+		rpc_dump_lvol_io_stat(w, lvol, req.heatmap);
+	} else {
+		for (lvs_bdev = vbdev_lvol_store_first(); lvs_bdev != NULL;
+		     lvs_bdev = vbdev_lvol_store_next(lvs_bdev)) {
+			TAILQ_FOREACH(lvol, &lvs_bdev->lvs->lvols, link) {
+				if (lvol->bdev != NULL) {
+					rpc_dump_lvol_io_stat(w, lvol, req.heatmap);
+				}
+			}
+		}
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_jsonrpc_end_result(request, w);
+
+cleanup:
+	free_rpc_bdev_lvol_get_io_stat(&req);
+}
+
+SPDK_RPC_REGISTER("bdev_lvol_get_io_stat", rpc_bdev_lvol_get_io_stat, SPDK_RPC_RUNTIME)
+
 struct rpc_bdev_lvol_resize {
 	char *name;
 	uint64_t size;
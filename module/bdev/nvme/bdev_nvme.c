@@ -54,6 +54,27 @@
 
 static int bdev_nvme_config_json(struct spdk_json_write_ctx *w);
 
+/* Per-channel view of one path of a multipath bdev. */
+struct nvme_io_path {
+	/** NULL once the path has been removed from the bdev */
+	struct nvme_bdev_path		*path;
+	struct nvme_bdev_ns		*nvme_ns;
+	struct spdk_io_channel		*ctrlr_ch;
+	struct nvme_io_channel		*nvme_ch;
+	uint32_t			outstanding;
+	bool				removed;
+	struct nvme_io_path_stat	stat;
+	TAILQ_ENTRY(nvme_io_path)	tailq;
+};
+
+/* I/O channel of a multipath bdev. */
+struct nvme_bdev_channel {
+	TAILQ_HEAD(, nvme_io_path)	io_paths;
+	uint32_t			num_io_paths;
+	/** Path the last I/O was sent to. The next search starts right after it. */
+	struct nvme_io_path		*current;
+};
+
 struct nvme_bdev_io {
 	/** array of iovecs to transfer. */
 	struct iovec *iovs;
@@ -87,6 +108,15 @@ struct nvme_bdev_io {
 
 	/** Keeps track if first of fused commands was submitted */
 	bool first_fused_submitted;
+
+	/** Path the I/O was submitted on, only set for multipath bdevs */
+	struct nvme_io_path *io_path;
+
+	/** Number of times the I/O was resubmitted on another path */
+	uint32_t retry_count;
+
+	/** Index of the next path to reset, for resets of multipath bdevs */
+	uint32_t reset_path_idx;
 };
 
 struct nvme_probe_ctx {
@@ -302,6 +332,45 @@ bdev_nvme_flush(struct nvme_bdev_ns *nvme_ns, struct nvme_bdev_io *bio,
 	return 0;
 }
 
+static int
+bdev_nvme_mp_reset_next(struct nvme_bdev *nbdev, struct nvme_bdev_io *bio)
+{
+	struct nvme_bdev_path *path;
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = NULL;
+	uint32_t i = 0;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_FOREACH(path, &nbdev->paths, tailq) {
+		if (i++ == bio->reset_path_idx) {
+			nvme_bdev_ctrlr = path->nvme_ns->ctrlr;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	if (nvme_bdev_ctrlr == NULL) {
+		return -ENOENT;
+	}
+
+	bio->reset_path_idx++;
+	return bdev_nvme_reset(nvme_bdev_ctrlr, bio, false);
+}
+
+static void
+bdev_nvme_reset_io_complete(struct nvme_bdev_io *bio, enum spdk_bdev_io_status status)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
+	struct nvme_bdev *nbdev = (struct nvme_bdev *)bdev_io->bdev->ctxt;
+
+	/* A reset of a multipath bdev resets the controllers of all its paths one by one. */
+	if (nbdev->multipath && status == SPDK_BDEV_IO_STATUS_SUCCESS &&
+	    bdev_nvme_mp_reset_next(nbdev, bio) == 0) {
+		return;
+	}
+
+	spdk_bdev_io_complete(bdev_io, status);
+}
+
 static void
 _bdev_nvme_complete_pending_resets(struct spdk_io_channel_iter *i)
 {
@@ -318,7 +387,7 @@ _bdev_nvme_complete_pending_resets(struct spdk_io_channel_iter *i)
 	while (!TAILQ_EMPTY(&nvme_ch->pending_resets)) {
 		bdev_io = TAILQ_FIRST(&nvme_ch->pending_resets);
 		TAILQ_REMOVE(&nvme_ch->pending_resets, bdev_io, module_link);
-		spdk_bdev_io_complete(bdev_io, status);
+		bdev_nvme_reset_io_complete((struct nvme_bdev_io *)bdev_io->driver_ctx, status);
 	}
 
 	spdk_for_each_channel_continue(i, 0);
@@ -359,7 +428,7 @@ _bdev_nvme_reset_create_qpairs_done(struct spdk_io_channel_iter *i, int status)
 		rc = SPDK_BDEV_IO_STATUS_FAILED;
 	}
 	if (ctx) {
-		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(ctx), rc);
+		bdev_nvme_reset_io_complete(ctx, rc);
 	}
 	_bdev_nvme_reset_complete(nvme_bdev_ctrlr, status);
 }
@@ -386,6 +455,7 @@ _bdev_nvme_reset_create_qpair(struct spdk_io_channel_iter *i)
 	if (spdk_nvme_poll_group_add(nvme_ch->group->group, nvme_ch->qpair) != 0) {
 		SPDK_ERRLOG("Unable to begin polling on NVMe Channel.\n");
 		spdk_nvme_ctrlr_free_io_qpair(nvme_ch->qpair);
+		nvme_ch->qpair = NULL;
 		spdk_for_each_channel_continue(i, -1);
 		return;
 	}
@@ -394,6 +464,7 @@ _bdev_nvme_reset_create_qpair(struct spdk_io_channel_iter *i)
 		SPDK_ERRLOG("Unable to connect I/O qpair.\n");
 		spdk_nvme_poll_group_remove(nvme_ch->group->group, nvme_ch->qpair);
 		spdk_nvme_ctrlr_free_io_qpair(nvme_ch->qpair);
+		nvme_ch->qpair = NULL;
 		spdk_for_each_channel_continue(i, -1);
 		return;
 	}
@@ -410,7 +481,7 @@ _bdev_nvme_reset(struct spdk_io_channel_iter *i, int status)
 
 	if (status) {
 		if (bio) {
-			spdk_bdev_io_complete(spdk_bdev_io_from_ctx(bio), SPDK_BDEV_IO_STATUS_FAILED);
+			bdev_nvme_reset_io_complete(bio, SPDK_BDEV_IO_STATUS_FAILED);
 		}
 		_bdev_nvme_reset_complete(nvme_bdev_ctrlr, status);
 		return;
@@ -419,7 +490,7 @@ _bdev_nvme_reset(struct spdk_io_channel_iter *i, int status)
 	rc = spdk_nvme_ctrlr_reset(nvme_bdev_ctrlr->ctrlr);
 	if (rc != 0) {
 		if (bio) {
-			spdk_bdev_io_complete(spdk_bdev_io_from_ctx(bio), SPDK_BDEV_IO_STATUS_FAILED);
+			bdev_nvme_reset_io_complete(bio, SPDK_BDEV_IO_STATUS_FAILED);
 		}
 		_bdev_nvme_reset_complete(nvme_bdev_ctrlr, rc);
 		return;
@@ -460,7 +531,7 @@ bdev_nvme_reset(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr, struct nvme_bdev_io *bi
 		pthread_mutex_unlock(&g_bdev_nvme_mutex);
 		/* Don't bother resetting if the controller is in the process of being destructed. */
 		if (bio) {
-			spdk_bdev_io_complete(spdk_bdev_io_from_ctx(bio), SPDK_BDEV_IO_STATUS_FAILED);
+			bdev_nvme_reset_io_complete(bio, SPDK_BDEV_IO_STATUS_FAILED);
 		}
 		return 0;
 	}
@@ -527,22 +598,34 @@ bdev_nvme_unmap(struct nvme_bdev_ns *nvme_ns, struct nvme_io_channel *nvme_ch,
 		uint64_t offset_blocks,
 		uint64_t num_blocks);
 
+static void bdev_nvme_io_complete(struct nvme_bdev_io *bio, enum spdk_bdev_io_status status);
+
 static void
 bdev_nvme_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 		     bool success)
 {
 	struct nvme_bdev *nbdev = (struct nvme_bdev *)bdev_io->bdev->ctxt;
-	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
+	struct nvme_bdev_io *bio = (struct nvme_bdev_io *)bdev_io->driver_ctx;
+	struct nvme_bdev_ns *nvme_ns;
+	struct nvme_io_channel *nvme_ch;
 	int ret;
 
 	if (!success) {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		bdev_nvme_io_complete(bio, SPDK_BDEV_IO_STATUS_FAILED);
 		return;
 	}
 
-	ret = bdev_nvme_readv(nbdev->nvme_ns,
+	if (bio->io_path != NULL) {
+		nvme_ns = bio->io_path->nvme_ns;
+		nvme_ch = bio->io_path->nvme_ch;
+	} else {
+		nvme_ns = nbdev->nvme_ns;
+		nvme_ch = spdk_io_channel_get_ctx(ch);
+	}
+
+	ret = bdev_nvme_readv(nvme_ns,
 			      nvme_ch,
-			      (struct nvme_bdev_io *)bdev_io->driver_ctx,
+			      bio,
 			      bdev_io->u.bdev.iovs,
 			      bdev_io->u.bdev.iovcnt,
 			      bdev_io->u.bdev.md_buf,
@@ -553,16 +636,16 @@ bdev_nvme_get_buf_cb(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io,
 	if (spdk_likely(ret == 0)) {
 		return;
 	} else if (ret == -ENOMEM) {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		bdev_nvme_io_complete(bio, SPDK_BDEV_IO_STATUS_NOMEM);
 	} else {
-		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		bdev_nvme_io_complete(bio, SPDK_BDEV_IO_STATUS_FAILED);
 	}
 }
 
 static int
-_bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+_bdev_nvme_submit_request(struct nvme_bdev_ns *nvme_ns, struct nvme_io_channel *nvme_ch,
+			  struct spdk_bdev_io *bdev_io)
 {
-	struct nvme_io_channel *nvme_ch = spdk_io_channel_get_ctx(ch);
 	struct nvme_bdev *nbdev = (struct nvme_bdev *)bdev_io->bdev->ctxt;
 	struct nvme_bdev_io *nbdev_io = (struct nvme_bdev_io *)bdev_io->driver_ctx;
 	struct nvme_bdev_io *nbdev_io_to_abort;
@@ -575,7 +658,7 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 	switch (bdev_io->type) {
 	case SPDK_BDEV_IO_TYPE_READ:
 		if (bdev_io->u.bdev.iovs && bdev_io->u.bdev.iovs[0].iov_base) {
-			bdev_nvme_get_buf_cb(ch, bdev_io, true);
+			bdev_nvme_get_buf_cb(spdk_io_channel_from_ctx(nvme_ch), bdev_io, true);
 		} else {
 			spdk_bdev_io_get_buf(bdev_io, bdev_nvme_get_buf_cb,
 					     bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen);
@@ -583,7 +666,7 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 		return 0;
 
 	case SPDK_BDEV_IO_TYPE_WRITE:
-		return bdev_nvme_writev(nbdev->nvme_ns,
+		return bdev_nvme_writev(nvme_ns,
 					nvme_ch,
 					nbdev_io,
 					bdev_io->u.bdev.iovs,
@@ -594,7 +677,7 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 					nbdev->disk.dif_check_flags);
 
 	case SPDK_BDEV_IO_TYPE_COMPARE:
-		return bdev_nvme_comparev(nbdev->nvme_ns,
+		return bdev_nvme_comparev(nvme_ns,
 					  nvme_ch,
 					  nbdev_io,
 					  bdev_io->u.bdev.iovs,
@@ -605,7 +688,7 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 					  nbdev->disk.dif_check_flags);
 
 	case SPDK_BDEV_IO_TYPE_COMPARE_AND_WRITE:
-		return bdev_nvme_comparev_and_writev(nbdev->nvme_ns,
+		return bdev_nvme_comparev_and_writev(nvme_ns,
 						     nvme_ch,
 						     nbdev_io,
 						     bdev_io->u.bdev.iovs,
@@ -618,30 +701,30 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 						     nbdev->disk.dif_check_flags);
 
 	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
-		return bdev_nvme_unmap(nbdev->nvme_ns,
+		return bdev_nvme_unmap(nvme_ns,
 				       nvme_ch,
 				       nbdev_io,
 				       bdev_io->u.bdev.offset_blocks,
 				       bdev_io->u.bdev.num_blocks);
 
 	case SPDK_BDEV_IO_TYPE_UNMAP:
-		return bdev_nvme_unmap(nbdev->nvme_ns,
+		return bdev_nvme_unmap(nvme_ns,
 				       nvme_ch,
 				       nbdev_io,
 				       bdev_io->u.bdev.offset_blocks,
 				       bdev_io->u.bdev.num_blocks);
 
 	case SPDK_BDEV_IO_TYPE_RESET:
-		return bdev_nvme_reset(nbdev->nvme_ns->ctrlr, nbdev_io, false);
+		return bdev_nvme_reset(nvme_ns->ctrlr, nbdev_io, false);
 
 	case SPDK_BDEV_IO_TYPE_FLUSH:
-		return bdev_nvme_flush(nbdev->nvme_ns,
+		return bdev_nvme_flush(nvme_ns,
 				       nbdev_io,
 				       bdev_io->u.bdev.offset_blocks,
 				       bdev_io->u.bdev.num_blocks);
 
 	case SPDK_BDEV_IO_TYPE_NVME_ADMIN:
-		return bdev_nvme_admin_passthru(nbdev->nvme_ns,
+		return bdev_nvme_admin_passthru(nvme_ns,
 						nvme_ch,
 						nbdev_io,
 						&bdev_io->u.nvme_passthru.cmd,
@@ -649,7 +732,7 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 						bdev_io->u.nvme_passthru.nbytes);
 
 	case SPDK_BDEV_IO_TYPE_NVME_IO:
-		return bdev_nvme_io_passthru(nbdev->nvme_ns,
+		return bdev_nvme_io_passthru(nvme_ns,
 					     nvme_ch,
 					     nbdev_io,
 					     &bdev_io->u.nvme_passthru.cmd,
@@ -657,7 +740,7 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 					     bdev_io->u.nvme_passthru.nbytes);
 
 	case SPDK_BDEV_IO_TYPE_NVME_IO_MD:
-		return bdev_nvme_io_passthru_md(nbdev->nvme_ns,
+		return bdev_nvme_io_passthru_md(nvme_ns,
 						nvme_ch,
 						nbdev_io,
 						&bdev_io->u.nvme_passthru.cmd,
@@ -668,7 +751,7 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 
 	case SPDK_BDEV_IO_TYPE_ABORT:
 		nbdev_io_to_abort = (struct nvme_bdev_io *)bdev_io->u.abort.bio_to_abort->driver_ctx;
-		return bdev_nvme_abort(nbdev->nvme_ns,
+		return bdev_nvme_abort(nvme_ns,
 				       nvme_ch,
 				       nbdev_io,
 				       nbdev_io_to_abort);
@@ -682,7 +765,343 @@ _bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_
 static void
 bdev_nvme_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
 {
-	int rc = _bdev_nvme_submit_request(ch, bdev_io);
+	struct nvme_bdev *nbdev = (struct nvme_bdev *)bdev_io->bdev->ctxt;
+	struct nvme_bdev_io *nbdev_io = (struct nvme_bdev_io *)bdev_io->driver_ctx;
+	int rc;
+
+	nbdev_io->io_path = NULL;
+	rc = _bdev_nvme_submit_request(nbdev->nvme_ns, spdk_io_channel_get_ctx(ch), bdev_io);
+
+	if (spdk_unlikely(rc != 0)) {
+		if (rc == -ENOMEM) {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NOMEM);
+		} else {
+			spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_FAILED);
+		}
+	}
+}
+
+static void
+bdev_nvme_io_path_stat_add(struct nvme_io_path_stat *total, const struct nvme_io_path_stat *stat)
+{
+	total->num_read_ops += stat->num_read_ops;
+	total->bytes_read += stat->bytes_read;
+	total->num_write_ops += stat->num_write_ops;
+	total->bytes_written += stat->bytes_written;
+	total->num_other_ops += stat->num_other_ops;
+	total->num_io_errors += stat->num_io_errors;
+	total->num_retries += stat->num_retries;
+}
+
+static void
+bdev_nvme_io_path_stat_update(struct nvme_io_path *io_path, struct spdk_bdev_io *bdev_io,
+			      bool success)
+{
+	struct nvme_io_path_stat *stat = &io_path->stat;
+
+	if (spdk_unlikely(!success)) {
+		stat->num_io_errors++;
+		return;
+	}
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+		stat->num_read_ops++;
+		stat->bytes_read += bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+		break;
+	case SPDK_BDEV_IO_TYPE_WRITE:
+		stat->num_write_ops++;
+		stat->bytes_written += bdev_io->u.bdev.num_blocks * bdev_io->bdev->blocklen;
+		break;
+	default:
+		stat->num_other_ops++;
+		break;
+	}
+}
+
+static void
+bdev_nvme_io_path_free(struct nvme_io_path *io_path)
+{
+	spdk_put_io_channel(io_path->ctrlr_ch);
+	free(io_path);
+}
+
+static inline void
+bdev_nvme_io_path_put(struct nvme_io_path *io_path)
+{
+	assert(io_path->outstanding > 0);
+	io_path->outstanding--;
+
+	/* A removed path is kept alive until the I/O submitted on it has completed. */
+	if (spdk_unlikely(io_path->removed) && io_path->outstanding == 0) {
+		bdev_nvme_io_path_free(io_path);
+	}
+}
+
+/*
+ * Returns a negative value if the path can't take I/O right now, otherwise 0
+ * for an ANA optimized path and 1 for a non-optimized one.
+ */
+static inline int
+bdev_nvme_io_path_rank(struct nvme_io_path *io_path)
+{
+	if (spdk_unlikely(io_path->nvme_ch->qpair == NULL)) {
+		/* The controller is being reset. */
+		return -1;
+	}
+
+	switch (spdk_nvme_ns_get_ana_state(io_path->nvme_ns->ns)) {
+	case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+		return 1;
+	case SPDK_NVME_ANA_INACCESSIBLE_STATE:
+	case SPDK_NVME_ANA_PERSISTENT_LOSS_STATE:
+	case SPDK_NVME_ANA_CHANGE_STATE:
+		return -1;
+	default:
+		/* Optimized, or the controller doesn't report ANA states. */
+		return 0;
+	}
+}
+
+static struct nvme_io_path *
+bdev_nvme_find_io_path(struct nvme_bdev_channel *nbdev_ch, enum nvme_bdev_mp_policy policy,
+		       struct nvme_io_path *prev, struct nvme_io_path *exclude)
+{
+	struct nvme_io_path *io_path, *start, *best = NULL;
+	int rank, best_rank = INT_MAX;
+
+	/* Start right after the previously used path so that equally good paths take turns. */
+	start = (prev != NULL && !prev->removed) ? TAILQ_NEXT(prev, tailq) : NULL;
+	if (start == NULL) {
+		start = TAILQ_FIRST(&nbdev_ch->io_paths);
+		if (start == NULL) {
+			return NULL;
+		}
+	}
+
+	io_path = start;
+	do {
+		rank = io_path != exclude ? bdev_nvme_io_path_rank(io_path) : -1;
+		if (rank >= 0) {
+			switch (policy) {
+			case NVME_BDEV_MP_POLICY_QUEUE_DEPTH:
+				if (io_path->outstanding == 0) {
+					return io_path;
+				}
+				if (best == NULL || io_path->outstanding < best->outstanding) {
+					best = io_path;
+				}
+				break;
+			case NVME_BDEV_MP_POLICY_ANA:
+				if (rank == 0) {
+					return io_path;
+				}
+				if (rank < best_rank) {
+					best = io_path;
+					best_rank = rank;
+				}
+				break;
+			default:
+				return io_path;
+			}
+		}
+
+		io_path = TAILQ_NEXT(io_path, tailq);
+		if (io_path == NULL) {
+			io_path = TAILQ_FIRST(&nbdev_ch->io_paths);
+		}
+	} while (io_path != start);
+
+	return best;
+}
+
+static int
+bdev_nvme_submit_on_io_path(struct nvme_io_path *io_path, struct spdk_bdev_io *bdev_io)
+{
+	struct nvme_bdev_io *nbdev_io = (struct nvme_bdev_io *)bdev_io->driver_ctx;
+	int rc;
+
+	nbdev_io->io_path = io_path;
+	io_path->outstanding++;
+
+	rc = _bdev_nvme_submit_request(io_path->nvme_ns, io_path->nvme_ch, bdev_io);
+	if (spdk_unlikely(rc != 0)) {
+		nbdev_io->io_path = NULL;
+		bdev_nvme_io_path_put(io_path);
+	}
+
+	return rc;
+}
+
+static inline bool
+bdev_nvme_is_path_error(int sct, int sc)
+{
+	return sct == SPDK_NVME_SCT_PATH ||
+	       (sct == SPDK_NVME_SCT_GENERIC && sc == SPDK_NVME_SC_ABORTED_SQ_DELETION);
+}
+
+/* Resubmits an I/O that failed because of its path on the next usable one. */
+static bool
+bdev_nvme_mp_retry_io(struct nvme_bdev_io *bio)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *failed = bio->io_path, *io_path;
+	int rc;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_READ:
+	case SPDK_BDEV_IO_TYPE_WRITE:
+	case SPDK_BDEV_IO_TYPE_COMPARE:
+	case SPDK_BDEV_IO_TYPE_UNMAP:
+	case SPDK_BDEV_IO_TYPE_WRITE_ZEROES:
+		break;
+	default:
+		return false;
+	}
+
+	nbdev_ch = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
+	if (bio->retry_count >= nbdev_ch->num_io_paths) {
+		return false;
+	}
+
+	io_path = bdev_nvme_find_io_path(nbdev_ch, NVME_BDEV_MP_POLICY_ROUND_ROBIN, failed, failed);
+	if (io_path == NULL) {
+		return false;
+	}
+
+	failed->stat.num_retries++;
+	bio->retry_count++;
+
+	rc = bdev_nvme_submit_on_io_path(io_path, bdev_io);
+	if (rc != 0) {
+		spdk_bdev_io_complete(bdev_io, rc == -ENOMEM ? SPDK_BDEV_IO_STATUS_NOMEM :
+				      SPDK_BDEV_IO_STATUS_FAILED);
+	}
+
+	return true;
+}
+
+static void
+bdev_nvme_io_complete_nvme_status(struct nvme_bdev_io *bio, uint32_t cdw0, int sct, int sc)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
+	struct nvme_io_path *io_path = bio->io_path;
+	bool success, retried = false;
+
+	if (io_path != NULL) {
+		success = sct == SPDK_NVME_SCT_GENERIC && sc == SPDK_NVME_SC_SUCCESS;
+		bdev_nvme_io_path_stat_update(io_path, bdev_io, success);
+
+		if (spdk_unlikely(!success) && bdev_nvme_is_path_error(sct, sc)) {
+			retried = bdev_nvme_mp_retry_io(bio);
+		}
+
+		bdev_nvme_io_path_put(io_path);
+		if (retried) {
+			return;
+		}
+		bio->io_path = NULL;
+	}
+
+	spdk_bdev_io_complete_nvme_status(bdev_io, cdw0, sct, sc);
+}
+
+static void
+bdev_nvme_io_complete(struct nvme_bdev_io *bio, enum spdk_bdev_io_status status)
+{
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
+
+	if (bio->io_path != NULL) {
+		if (status != SPDK_BDEV_IO_STATUS_NOMEM) {
+			bdev_nvme_io_path_stat_update(bio->io_path, bdev_io,
+						      status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		}
+		bdev_nvme_io_path_put(bio->io_path);
+		bio->io_path = NULL;
+	}
+
+	spdk_bdev_io_complete(bdev_io, status);
+}
+
+static int
+bdev_nvme_mp_reset(struct nvme_bdev *nbdev, struct nvme_bdev_io *bio)
+{
+	bio->reset_path_idx = 0;
+	if (bdev_nvme_mp_reset_next(nbdev, bio) == -ENOENT) {
+		spdk_bdev_io_complete(spdk_bdev_io_from_ctx(bio), SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+
+	return 0;
+}
+
+static void
+bdev_nvme_mp_submit_request(struct spdk_io_channel *ch, struct spdk_bdev_io *bdev_io)
+{
+	struct nvme_bdev_channel *nbdev_ch = spdk_io_channel_get_ctx(ch);
+	struct nvme_bdev *nbdev = (struct nvme_bdev *)bdev_io->bdev->ctxt;
+	struct nvme_bdev_io *nbdev_io = (struct nvme_bdev_io *)bdev_io->driver_ctx;
+	struct nvme_bdev_io *nbdev_io_to_abort;
+	struct nvme_io_path *io_path, *prev;
+	uint32_t i;
+	int rc = -ENXIO;
+
+	nbdev_io->io_path = NULL;
+	nbdev_io->retry_count = 0;
+
+	switch (bdev_io->type) {
+	case SPDK_BDEV_IO_TYPE_RESET:
+		rc = bdev_nvme_mp_reset(nbdev, nbdev_io);
+		break;
+
+	case SPDK_BDEV_IO_TYPE_FLUSH:
+		rc = bdev_nvme_flush(nbdev->nvme_ns,
+				     nbdev_io,
+				     bdev_io->u.bdev.offset_blocks,
+				     bdev_io->u.bdev.num_blocks);
+		break;
+
+	case SPDK_BDEV_IO_TYPE_ABORT:
+		/* Abort on the path the I/O to abort was sent to. */
+		nbdev_io_to_abort = (struct nvme_bdev_io *)bdev_io->u.abort.bio_to_abort->driver_ctx;
+		io_path = nbdev_io_to_abort->io_path;
+		if (io_path == NULL) {
+			io_path = bdev_nvme_find_io_path(nbdev_ch, nbdev->mp_policy, nbdev_ch->current, NULL);
+		}
+		if (io_path != NULL) {
+			rc = bdev_nvme_abort(io_path->nvme_ns,
+					     io_path->nvme_ch,
+					     nbdev_io,
+					     nbdev_io_to_abort);
+		}
+		break;
+
+	case SPDK_BDEV_IO_TYPE_NVME_ADMIN:
+		io_path = bdev_nvme_find_io_path(nbdev_ch, nbdev->mp_policy, nbdev_ch->current, NULL);
+		if (io_path != NULL) {
+			rc = _bdev_nvme_submit_request(io_path->nvme_ns, io_path->nvme_ch, bdev_io);
+		}
+		break;
+
+	default:
+		/* If a path refuses the I/O, give the other ones a chance before failing it. */
+		prev = nbdev_ch->current;
+		for (i = 0; i < nbdev_ch->num_io_paths; i++) {
+			io_path = bdev_nvme_find_io_path(nbdev_ch, nbdev->mp_policy, prev,
+							 i == 0 ? NULL : prev);
+			if (io_path == NULL) {
+				break;
+			}
+
+			nbdev_ch->current = io_path;
+			rc = bdev_nvme_submit_on_io_path(io_path, bdev_io);
+			if (spdk_likely(rc == 0) || rc == -ENOMEM) {
+				break;
+			}
+			prev = io_path;
+		}
+		break;
+	}
 
 	if (spdk_unlikely(rc != 0)) {
 		if (rc == -ENOMEM) {
@@ -829,39 +1248,493 @@ bdev_nvme_destroy_cb(void *io_device, void *ctx_buf)
 	}
 	spdk_put_io_channel(spdk_io_channel_from_ctx(group));
 
-	spdk_nvme_ctrlr_free_io_qpair(ch->qpair);
+	spdk_nvme_ctrlr_free_io_qpair(ch->qpair);
+}
+
+static int
+bdev_nvme_poll_group_create_cb(void *io_device, void *ctx_buf)
+{
+	struct nvme_bdev_poll_group *group = ctx_buf;
+
+	group->group = spdk_nvme_poll_group_create(group);
+	if (group->group == NULL) {
+		return -1;
+	}
+
+	group->poller = SPDK_POLLER_REGISTER(bdev_nvme_poll, group, g_opts.nvme_ioq_poll_period_us);
+
+	if (group->poller == NULL) {
+		spdk_nvme_poll_group_destroy(group->group);
+		return -1;
+	}
+
+	return 0;
+}
+
+static void
+bdev_nvme_poll_group_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct nvme_bdev_poll_group *group = ctx_buf;
+
+	spdk_poller_unregister(&group->poller);
+	if (spdk_nvme_poll_group_destroy(group->group)) {
+		SPDK_ERRLOG("Unable to destroy a poll group for the NVMe bdev module.");
+		assert(false);
+	}
+}
+
+static int
+bdev_nvme_channel_add_path(struct nvme_bdev_channel *nbdev_ch, struct nvme_bdev_path *path)
+{
+	struct nvme_io_path *io_path;
+
+	TAILQ_FOREACH(io_path, &nbdev_ch->io_paths, tailq) {
+		if (io_path->path == path) {
+			/* The channel was created after the path was added to the bdev. */
+			return 0;
+		}
+	}
+
+	io_path = calloc(1, sizeof(*io_path));
+	if (io_path == NULL) {
+		return -ENOMEM;
+	}
+
+	io_path->ctrlr_ch = spdk_get_io_channel(path->nvme_ns->ctrlr);
+	if (io_path->ctrlr_ch == NULL) {
+		free(io_path);
+		return -ENODEV;
+	}
+
+	io_path->path = path;
+	io_path->nvme_ns = path->nvme_ns;
+	io_path->nvme_ch = spdk_io_channel_get_ctx(io_path->ctrlr_ch);
+
+	TAILQ_INSERT_TAIL(&nbdev_ch->io_paths, io_path, tailq);
+	nbdev_ch->num_io_paths++;
+
+	return 0;
+}
+
+/* Must be called with g_bdev_nvme_mutex held. */
+static void
+bdev_nvme_channel_remove_path(struct nvme_bdev_channel *nbdev_ch, struct nvme_io_path *io_path)
+{
+	TAILQ_REMOVE(&nbdev_ch->io_paths, io_path, tailq);
+	nbdev_ch->num_io_paths--;
+	if (nbdev_ch->current == io_path) {
+		nbdev_ch->current = NULL;
+	}
+
+	if (io_path->path != NULL) {
+		bdev_nvme_io_path_stat_add(&io_path->path->stat, &io_path->stat);
+		io_path->path = NULL;
+	}
+
+	io_path->removed = true;
+	if (io_path->outstanding == 0) {
+		bdev_nvme_io_path_free(io_path);
+	}
+}
+
+static void bdev_nvme_mp_destroy_cb(void *io_device, void *ctx_buf);
+
+static int
+bdev_nvme_mp_create_cb(void *io_device, void *ctx_buf)
+{
+	struct nvme_bdev *nbdev = io_device;
+	struct nvme_bdev_channel *nbdev_ch = ctx_buf;
+	struct nvme_bdev_path *path;
+	int rc;
+
+	TAILQ_INIT(&nbdev_ch->io_paths);
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_FOREACH(path, &nbdev->paths, tailq) {
+		rc = bdev_nvme_channel_add_path(nbdev_ch, path);
+		if (rc != 0) {
+			/* Keep the channel usable through the remaining paths. */
+			SPDK_ERRLOG("Failed to open path %s of %s: %s\n",
+				    path->nvme_ns->ctrlr->connected_trid->traddr,
+				    nbdev->disk.name, spdk_strerror(-rc));
+		}
+	}
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	return 0;
+}
+
+static void
+bdev_nvme_mp_destroy_cb(void *io_device, void *ctx_buf)
+{
+	struct nvme_bdev_channel *nbdev_ch = ctx_buf;
+	struct nvme_io_path *io_path;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	while ((io_path = TAILQ_FIRST(&nbdev_ch->io_paths)) != NULL) {
+		assert(io_path->outstanding == 0);
+		bdev_nvme_channel_remove_path(nbdev_ch, io_path);
+	}
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+}
+
+static struct spdk_io_channel *
+bdev_nvme_mp_get_io_channel(void *ctx)
+{
+	return spdk_get_io_channel(ctx);
+}
+
+static void bdev_nvme_mp_unregister_cb(void *io_device);
+
+static void
+bdev_nvme_channel_iter_done(struct nvme_bdev *nbdev)
+{
+	bool unregister;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	assert(nbdev->channel_iters > 0);
+	nbdev->channel_iters--;
+	unregister = nbdev->channel_iters == 0 && nbdev->destruct;
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	if (unregister) {
+		spdk_io_device_unregister(nbdev, bdev_nvme_mp_unregister_cb);
+	}
+}
+
+static struct nvme_bdev_path *
+bdev_nvme_path_create(struct nvme_bdev *nbdev, struct nvme_bdev_ns *nvme_ns)
+{
+	struct nvme_bdev_path *path;
+
+	path = calloc(1, sizeof(*path));
+	if (path == NULL) {
+		return NULL;
+	}
+
+	path->nvme_ns = nvme_ns;
+	path->nbdev = nbdev;
+
+	/* Each path holds a reference to its controller. */
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_INSERT_TAIL(&nbdev->paths, path, tailq);
+	TAILQ_INSERT_TAIL(&nvme_ns->paths, path, ns_tailq);
+	nvme_ns->ctrlr->ref++;
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	return path;
+}
+
+static void
+_bdev_nvme_remove_io_path(struct spdk_io_channel_iter *i)
+{
+	struct nvme_bdev_path *path = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+	struct nvme_bdev_channel *nbdev_ch = spdk_io_channel_get_ctx(_ch);
+	struct nvme_io_path *io_path;
+
+	TAILQ_FOREACH(io_path, &nbdev_ch->io_paths, tailq) {
+		if (io_path->path == path) {
+			pthread_mutex_lock(&g_bdev_nvme_mutex);
+			bdev_nvme_channel_remove_path(nbdev_ch, io_path);
+			pthread_mutex_unlock(&g_bdev_nvme_mutex);
+			break;
+		}
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+_bdev_nvme_remove_io_path_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct nvme_bdev *nbdev = spdk_io_channel_iter_get_io_device(i);
+	struct nvme_bdev_path *path = spdk_io_channel_iter_get_ctx(i);
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = path->nvme_ns->ctrlr;
+
+	free(path);
+	nvme_ctrlr_depopulate_namespace_done(nvme_bdev_ctrlr);
+	bdev_nvme_channel_iter_done(nbdev);
+}
+
+static void
+bdev_nvme_remove_path(struct nvme_bdev_path *path)
+{
+	struct nvme_bdev *nbdev = path->nbdev;
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = path->nvme_ns->ctrlr;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_REMOVE(&nbdev->paths, path, tailq);
+	TAILQ_REMOVE(&path->nvme_ns->paths, path, ns_tailq);
+	if (!nbdev->destruct) {
+		nbdev->channel_iters++;
+		pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+		spdk_for_each_channel(nbdev, _bdev_nvme_remove_io_path, path,
+				      _bdev_nvme_remove_io_path_done);
+		return;
+	}
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	/* There are no I/O channels left once the bdev is being destructed. */
+	free(path);
+	nvme_ctrlr_depopulate_namespace_done(nvme_bdev_ctrlr);
+}
+
+struct nvme_bdev_add_path_ctx {
+	struct nvme_bdev_path		*path;
+	struct nvme_async_probe_ctx	*probe_ctx;
+};
+
+static void
+_bdev_nvme_add_io_path(struct spdk_io_channel_iter *i)
+{
+	struct nvme_bdev_add_path_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+	struct nvme_bdev_channel *nbdev_ch = spdk_io_channel_get_ctx(_ch);
+	int rc;
+
+	rc = bdev_nvme_channel_add_path(nbdev_ch, ctx->path);
+	if (rc != 0) {
+		SPDK_ERRLOG("Failed to open path %s of %s: %s\n",
+			    ctx->path->nvme_ns->ctrlr->connected_trid->traddr,
+			    ctx->path->nbdev->disk.name, spdk_strerror(-rc));
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+_bdev_nvme_add_io_path_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct nvme_bdev *nbdev = spdk_io_channel_iter_get_io_device(i);
+	struct nvme_bdev_add_path_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	SPDK_NOTICELOG("Added path %s to %s\n", ctx->path->nvme_ns->ctrlr->connected_trid->traddr,
+		       nbdev->disk.name);
+
+	nvme_ctrlr_populate_namespace_done(ctx->probe_ctx, ctx->path->nvme_ns, 0);
+	free(ctx);
+	bdev_nvme_channel_iter_done(nbdev);
+}
+
+static int
+bdev_nvme_check_path(struct nvme_bdev *nbdev, struct spdk_nvme_ns *ns)
+{
+	struct spdk_nvme_ns *owner_ns = nbdev->nvme_ns->ns;
+	const struct spdk_uuid *uuid, *owner_uuid;
+
+	if (memcmp(spdk_nvme_ns_get_data(ns)->nguid, spdk_nvme_ns_get_data(owner_ns)->nguid,
+		   sizeof(spdk_nvme_ns_get_data(ns)->nguid))) {
+		return -EINVAL;
+	}
+
+	uuid = spdk_nvme_ns_get_uuid(ns);
+	owner_uuid = spdk_nvme_ns_get_uuid(owner_ns);
+	if ((uuid == NULL) != (owner_uuid == NULL) ||
+	    (uuid != NULL && spdk_uuid_compare(uuid, owner_uuid) != 0)) {
+		return -EINVAL;
+	}
+
+	if (spdk_nvme_ns_get_extended_sector_size(ns) != nbdev->disk.blocklen ||
+	    spdk_nvme_ns_get_md_size(ns) != nbdev->disk.md_len) {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static void
+bdev_nvme_add_path(struct nvme_bdev *nbdev, struct nvme_bdev_ns *nvme_ns,
+		   struct nvme_async_probe_ctx *probe_ctx)
+{
+	struct nvme_bdev_add_path_ctx *ctx;
+	int rc;
+
+	rc = bdev_nvme_check_path(nbdev, nvme_ns->ns);
+	if (rc != 0) {
+		SPDK_ERRLOG("Namespace %u of %s (%s) does not match bdev %s\n", nvme_ns->id,
+			    nvme_ns->ctrlr->name, nvme_ns->ctrlr->connected_trid->traddr, nbdev->disk.name);
+		goto err;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		rc = -ENOMEM;
+		goto err;
+	}
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	if (nbdev->destruct) {
+		pthread_mutex_unlock(&g_bdev_nvme_mutex);
+		free(ctx);
+		rc = -ENODEV;
+		goto err;
+	}
+	nbdev->channel_iters++;
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	ctx->path = bdev_nvme_path_create(nbdev, nvme_ns);
+	if (ctx->path == NULL) {
+		free(ctx);
+		bdev_nvme_channel_iter_done(nbdev);
+		rc = -ENOMEM;
+		goto err;
+	}
+	ctx->probe_ctx = probe_ctx;
+
+	spdk_for_each_channel(nbdev, _bdev_nvme_add_io_path, ctx, _bdev_nvme_add_io_path_done);
+	return;
+
+err:
+	nvme_ctrlr_populate_namespace_done(probe_ctx, nvme_ns, rc);
+}
+
+/*
+ * Hands a multipath bdev over to one of its remaining paths when the namespace
+ * owning it goes away.
+ */
+static int
+bdev_nvme_transfer_bdev(struct nvme_bdev *nbdev)
+{
+	struct nvme_bdev_ns *old_ns = nbdev->nvme_ns;
+	struct nvme_bdev_path *path;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	path = TAILQ_FIRST(&nbdev->paths);
+	if (path == NULL || nbdev->destruct) {
+		pthread_mutex_unlock(&g_bdev_nvme_mutex);
+		return -ENODEV;
+	}
+
+	/* The caller still holds a reference to the old controller, so it can't drop to zero here. */
+	TAILQ_REMOVE(&old_ns->bdevs, nbdev, tailq);
+	old_ns->ctrlr->ref--;
+	nbdev->nvme_ns = path->nvme_ns;
+	TAILQ_INSERT_TAIL(&path->nvme_ns->bdevs, nbdev, tailq);
+	path->nvme_ns->ctrlr->ref++;
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	SPDK_NOTICELOG("%s is now owned by controller %s (%s)\n", nbdev->disk.name,
+		       path->nvme_ns->ctrlr->name, path->nvme_ns->ctrlr->connected_trid->traddr);
+	return 0;
+}
+
+static struct nvme_bdev *
+bdev_nvme_find_multipath_bdev(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr, uint32_t nsid)
+{
+	struct nvme_bdev_ctrlr *peer;
+	struct nvme_bdev_ns *peer_ns;
+	struct nvme_bdev *nbdev = NULL;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_FOREACH(peer, &g_nvme_bdev_ctrlrs, tailq) {
+		if (peer == nvme_bdev_ctrlr || !peer->multipath || nsid > peer->num_ns ||
+		    strcmp(peer->name, nvme_bdev_ctrlr->name) != 0) {
+			continue;
+		}
+
+		peer_ns = peer->namespaces[nsid - 1];
+		if (peer_ns->populated && !TAILQ_EMPTY(&peer_ns->paths)) {
+			nbdev = TAILQ_FIRST(&peer_ns->paths)->nbdev;
+			break;
+		}
+	}
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	return nbdev;
+}
+
+static int
+bdev_nvme_mp_destruct(void *ctx)
+{
+	struct nvme_bdev *nvme_disk = ctx;
+	bool deferred;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	nvme_disk->destruct = true;
+	/* The last walk over the channels in progress unregisters the bdev. */
+	deferred = nvme_disk->channel_iters > 0;
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	if (!deferred) {
+		spdk_io_device_unregister(nvme_disk, bdev_nvme_mp_unregister_cb);
+	}
+
+	return 1;
+}
+
+static void
+bdev_nvme_mp_unregister_cb(void *io_device)
+{
+	struct nvme_bdev *nvme_disk = io_device;
+	struct nvme_bdev_path *path;
+
+	while ((path = TAILQ_FIRST(&nvme_disk->paths)) != NULL) {
+		bdev_nvme_remove_path(path);
+	}
+
+	nvme_bdev_detach_bdev_from_ns(nvme_disk);
+
+	spdk_bdev_destruct_done(&nvme_disk->disk, 0);
+
+	free(nvme_disk->disk.name);
+	free(nvme_disk);
 }
 
 static int
-bdev_nvme_poll_group_create_cb(void *io_device, void *ctx_buf)
+bdev_nvme_mp_init_bdev(struct nvme_bdev *nbdev, struct nvme_bdev_ns *nvme_ns)
 {
-	struct nvme_bdev_poll_group *group = ctx_buf;
+	nbdev->multipath = true;
+	nbdev->mp_policy = nvme_ns->ctrlr->mp_policy;
+	TAILQ_INIT(&nbdev->paths);
 
-	group->group = spdk_nvme_poll_group_create(group);
-	if (group->group == NULL) {
-		return -1;
+	if (bdev_nvme_path_create(nbdev, nvme_ns) == NULL) {
+		return -ENOMEM;
 	}
 
-	group->poller = SPDK_POLLER_REGISTER(bdev_nvme_poll, group, g_opts.nvme_ioq_poll_period_us);
+	spdk_io_device_register(nbdev, bdev_nvme_mp_create_cb, bdev_nvme_mp_destroy_cb,
+				sizeof(struct nvme_bdev_channel), nbdev->disk.name);
+	return 0;
+}
 
-	if (group->poller == NULL) {
-		spdk_nvme_poll_group_destroy(group->group);
-		return -1;
-	}
+static void
+bdev_nvme_mp_fini_bdev(struct nvme_bdev *nbdev)
+{
+	struct nvme_bdev_path *path = TAILQ_FIRST(&nbdev->paths);
 
-	return 0;
+	spdk_io_device_unregister(nbdev, NULL);
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_REMOVE(&nbdev->paths, path, tailq);
+	TAILQ_REMOVE(&path->nvme_ns->paths, path, ns_tailq);
+	path->nvme_ns->ctrlr->ref--;
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	free(path);
 }
 
 static void
-bdev_nvme_poll_group_destroy_cb(void *io_device, void *ctx_buf)
+bdev_nvme_mp_dump_info_json(struct nvme_bdev *nbdev, struct spdk_json_write_ctx *w)
 {
-	struct nvme_bdev_poll_group *group = ctx_buf;
+	struct nvme_bdev_path *path;
 
-	spdk_poller_unregister(&group->poller);
-	if (spdk_nvme_poll_group_destroy(group->group)) {
-		SPDK_ERRLOG("Unable to destroy a poll group for the NVMe bdev module.");
-		assert(false);
+	spdk_json_write_named_object_begin(w, "multipath");
+	spdk_json_write_named_string(w, "policy", bdev_nvme_mp_policy_str(nbdev->mp_policy));
+
+	spdk_json_write_named_array_begin(w, "paths");
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_FOREACH(path, &nbdev->paths, tailq) {
+		spdk_json_write_object_begin(w);
+		nvme_bdev_dump_trid_json(path->nvme_ns->ctrlr->connected_trid, w);
+		spdk_json_write_named_string(w, "ana_state",
+					     bdev_nvme_ana_state_str(spdk_nvme_ns_get_ana_state(path->nvme_ns->ns)));
+		spdk_json_write_object_end(w);
 	}
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+	spdk_json_write_array_end(w);
+
+	spdk_json_write_object_end(w);
 }
 
 static struct spdk_io_channel *
@@ -972,6 +1845,10 @@ bdev_nvme_dump_info_json(void *ctx, struct spdk_json_write_ctx *w)
 
 	spdk_json_write_object_end(w);
 
+	if (nvme_bdev->multipath) {
+		bdev_nvme_mp_dump_info_json(nvme_bdev, w);
+	}
+
 	return 0;
 }
 
@@ -1014,6 +1891,15 @@ static const struct spdk_bdev_fn_table nvmelib_fn_table = {
 	.get_spin_time		= bdev_nvme_get_spin_time,
 };
 
+static const struct spdk_bdev_fn_table nvmelib_mp_fn_table = {
+	.destruct		= bdev_nvme_mp_destruct,
+	.submit_request		= bdev_nvme_mp_submit_request,
+	.io_type_supported	= bdev_nvme_io_type_supported,
+	.get_io_channel		= bdev_nvme_mp_get_io_channel,
+	.dump_info_json		= bdev_nvme_dump_info_json,
+	.write_config_json	= bdev_nvme_write_config_json,
+};
+
 static void
 nvme_ctrlr_populate_standard_namespace(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 				       struct nvme_bdev_ns *nvme_ns, struct nvme_async_probe_ctx *ctx)
@@ -1035,6 +1921,16 @@ nvme_ctrlr_populate_standard_namespace(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 		goto done;
 	}
 
+	if (nvme_bdev_ctrlr->multipath) {
+		/* Another controller may already expose this namespace. */
+		bdev = bdev_nvme_find_multipath_bdev(nvme_bdev_ctrlr, nvme_ns->id);
+		if (bdev != NULL) {
+			nvme_ns->ns = ns;
+			bdev_nvme_add_path(bdev, nvme_ns, ctx);
+			return;
+		}
+	}
+
 	bdev = calloc(1, sizeof(*bdev));
 	if (!bdev) {
 		SPDK_ERRLOG("bdev calloc() failed\n");
@@ -1090,8 +1986,22 @@ nvme_ctrlr_populate_standard_namespace(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 	bdev->disk.ctxt = bdev;
 	bdev->disk.fn_table = &nvmelib_fn_table;
 	bdev->disk.module = &nvme_if;
+
+	if (nvme_bdev_ctrlr->multipath) {
+		rc = bdev_nvme_mp_init_bdev(bdev, nvme_ns);
+		if (rc) {
+			free(bdev->disk.name);
+			free(bdev);
+			goto done;
+		}
+		bdev->disk.fn_table = &nvmelib_mp_fn_table;
+	}
+
 	rc = spdk_bdev_register(&bdev->disk);
 	if (rc) {
+		if (bdev->multipath) {
+			bdev_nvme_mp_fini_bdev(bdev);
+		}
 		free(bdev->disk.name);
 		free(bdev);
 		goto done;
@@ -1199,8 +2109,17 @@ static void
 nvme_ctrlr_depopulate_standard_namespace(struct nvme_bdev_ns *ns)
 {
 	struct nvme_bdev *bdev, *tmp;
+	struct nvme_bdev_path *path, *tmp_path;
+
+	TAILQ_FOREACH_SAFE(path, &ns->paths, ns_tailq, tmp_path) {
+		bdev_nvme_remove_path(path);
+	}
 
 	TAILQ_FOREACH_SAFE(bdev, &ns->bdevs, tailq, tmp) {
+		/* Multipath bdevs stay registered as long as they have another path. */
+		if (bdev->multipath && bdev_nvme_transfer_bdev(bdev) == 0) {
+			continue;
+		}
 		spdk_bdev_unregister(&bdev->disk, NULL, NULL);
 	}
 
@@ -1274,7 +2193,7 @@ nvme_ctrlr_populate_namespaces(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 			nvme_ns = spdk_nvme_ctrlr_get_ns(ctrlr, nsid);
 			num_sectors = spdk_nvme_ns_get_num_sectors(nvme_ns);
 			bdev = TAILQ_FIRST(&ns->bdevs);
-			if (bdev->disk.blockcnt != num_sectors) {
+			if (bdev != NULL && bdev->disk.blockcnt != num_sectors) {
 				SPDK_NOTICELOG("NSID %u is resized: bdev name %s, old size %lu, new size %lu\n",
 					       nsid,
 					       bdev->disk.name,
@@ -1298,6 +2217,7 @@ nvme_ctrlr_populate_namespaces(struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
 			}
 
 			TAILQ_INIT(&ns->bdevs);
+			TAILQ_INIT(&ns->paths);
 
 			if (ctx) {
 				ctx->populates_in_progress++;
@@ -1642,6 +2562,19 @@ bdev_nvme_set_hotplug(bool enabled, uint64_t period_us, spdk_msg_fn cb, void *cb
 static void
 populate_namespaces_cb(struct nvme_async_probe_ctx *ctx, size_t count, int rc)
 {
+	uint64_t now, ticks_hz;
+
+	if (ctx->timings) {
+		now = spdk_get_ticks();
+		ticks_hz = spdk_get_ticks_hz();
+		if (ctx->attach_tsc == 0) {
+			/* Failed before the controller was attached */
+			ctx->attach_tsc = now;
+		}
+		ctx->timings->connect_us = (ctx->attach_tsc - ctx->start_tsc) * SPDK_SEC_TO_USEC / ticks_hz;
+		ctx->timings->populate_us = (now - ctx->attach_tsc) * SPDK_SEC_TO_USEC / ticks_hz;
+	}
+
 	if (ctx->cb_fn) {
 		ctx->cb_fn(ctx->cb_ctx, count, rc);
 	}
@@ -1655,10 +2588,15 @@ nvme_ctrlr_populate_namespaces_done(struct nvme_async_probe_ctx *ctx)
 	struct nvme_bdev_ctrlr	*nvme_bdev_ctrlr;
 	struct nvme_bdev_ns	*ns;
 	struct nvme_bdev	*nvme_bdev, *tmp;
+	struct nvme_bdev_path	*path;
 	uint32_t		i, nsid;
 	size_t			j;
 
-	nvme_bdev_ctrlr = nvme_bdev_ctrlr_get_by_name(ctx->base_name);
+	/* Several multipath controllers share a name, so look the new one up by its trid first. */
+	nvme_bdev_ctrlr = nvme_bdev_ctrlr_get(&ctx->trid);
+	if (nvme_bdev_ctrlr == NULL) {
+		nvme_bdev_ctrlr = nvme_bdev_ctrlr_get_by_name(ctx->base_name);
+	}
 	assert(nvme_bdev_ctrlr != NULL);
 
 	/*
@@ -1673,6 +2611,20 @@ nvme_ctrlr_populate_namespaces_done(struct nvme_async_probe_ctx *ctx)
 			continue;
 		}
 		assert(ns->id == nsid);
+		if (nvme_bdev_ctrlr->multipath) {
+			TAILQ_FOREACH(path, &ns->paths, ns_tailq) {
+				if (j < ctx->count) {
+					ctx->names[j] = path->nbdev->disk.name;
+					j++;
+				} else {
+					SPDK_ERRLOG("Maximum number of namespaces supported per NVMe controller is %du. Unable to return all names of created bdevs\n",
+						    ctx->count);
+					populate_namespaces_cb(ctx, 0, -ERANGE);
+					return;
+				}
+			}
+			continue;
+		}
 		TAILQ_FOREACH_SAFE(nvme_bdev, &ns->bdevs, tailq, tmp) {
 			if (j < ctx->count) {
 				ctx->names[j] = nvme_bdev->disk.name;
@@ -1694,13 +2646,75 @@ connect_attach_cb(void *cb_ctx, const struct spdk_nvme_transport_id *trid,
 		  struct spdk_nvme_ctrlr *ctrlr, const struct spdk_nvme_ctrlr_opts *opts)
 {
 	struct spdk_nvme_ctrlr_opts *user_opts = cb_ctx;
-	struct nvme_bdev_ctrlr	*nvme_bdev_ctrlr;
 	struct nvme_async_probe_ctx *ctx;
-	int rc;
 
 	ctx = SPDK_CONTAINEROF(user_opts, struct nvme_async_probe_ctx, opts);
 
-	spdk_poller_unregister(&ctx->poller);
+	/*
+	 * The poller finishes the attach once spdk_nvme_probe_poll_async() returns, which also
+	 * tells a controller that failed to initialize apart from one that was attached.
+	 */
+	ctx->ctrlr = ctrlr;
+	ctx->attach_tsc = spdk_get_ticks();
+}
+
+static int
+bdev_nvme_check_multipath(struct nvme_bdev_ctrlr *existing_ctrlr,
+			  const struct spdk_nvme_transport_id *trid)
+{
+	if (trid->trtype == SPDK_NVME_TRANSPORT_PCIE) {
+		SPDK_ERRLOG("PCIe multipath is not supported.\n");
+		return -ENOTSUP;
+	}
+
+	if (existing_ctrlr == NULL) {
+		return 0;
+	}
+
+	if (!existing_ctrlr->multipath) {
+		SPDK_ERRLOG("Controller %s was not attached in multipath mode.\n", existing_ctrlr->name);
+		return -EINVAL;
+	}
+
+	/* All the paths of a bdev must lead to the same subsystem. */
+	if (strncmp(trid->subnqn, existing_ctrlr->connected_trid->subnqn, SPDK_NVMF_NQN_MAX_LEN)) {
+		SPDK_ERRLOG("Subsystem %s does not match subsystem %s of controller %s.\n", trid->subnqn,
+			    existing_ctrlr->connected_trid->subnqn, existing_ctrlr->name);
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+static void
+connect_attach_ctrlr(struct nvme_async_probe_ctx *ctx)
+{
+	struct spdk_nvme_ctrlr	*ctrlr = ctx->ctrlr;
+	struct nvme_bdev_ctrlr	*nvme_bdev_ctrlr, *primary;
+	int rc;
+
+	if (ctx->multipath && spdk_nvme_ctrlr_is_ocssd_supported(ctrlr)) {
+		SPDK_ERRLOG("Multipath is not supported for Open-Channel SSDs\n");
+		spdk_nvme_detach(ctrlr);
+		populate_namespaces_cb(ctx, 0, -ENOTSUP);
+		return;
+	}
+
+	/* Another attach may have taken the name while this controller was being probed. */
+	primary = nvme_bdev_ctrlr_get_by_name(ctx->base_name);
+	if (primary != NULL) {
+		if (ctx->multipath) {
+			rc = bdev_nvme_check_multipath(primary, &ctx->trid);
+		} else {
+			SPDK_ERRLOG("A controller named %s already exists.\n", ctx->base_name);
+			rc = -EEXIST;
+		}
+		if (rc) {
+			spdk_nvme_detach(ctrlr);
+			populate_namespaces_cb(ctx, 0, rc);
+			return;
+		}
+	}
 
 	rc = nvme_bdev_ctrlr_create(ctrlr, ctx->base_name, &ctx->trid, ctx->prchk_flags);
 	if (rc) {
@@ -1712,6 +2726,15 @@ connect_attach_cb(void *cb_ctx, const struct spdk_nvme_transport_id *trid,
 	nvme_bdev_ctrlr = nvme_bdev_ctrlr_get(&ctx->trid);
 	assert(nvme_bdev_ctrlr != NULL);
 
+	if (ctx->multipath) {
+		nvme_bdev_ctrlr->multipath = true;
+		if (primary != NULL) {
+			/* Additional paths inherit the settings of the first controller. */
+			nvme_bdev_ctrlr->mp_policy = primary->mp_policy;
+			nvme_bdev_ctrlr->prchk_flags = primary->prchk_flags;
+		}
+	}
+
 	nvme_ctrlr_populate_namespaces(nvme_bdev_ctrlr, ctx);
 }
 
@@ -1722,9 +2745,16 @@ bdev_nvme_async_poll(void *arg)
 	int				rc;
 
 	rc = spdk_nvme_probe_poll_async(ctx->probe_ctx);
-	if (spdk_unlikely(rc != -EAGAIN && rc != 0)) {
-		spdk_poller_unregister(&ctx->poller);
-		free(ctx);
+	if (rc == -EAGAIN) {
+		return SPDK_POLLER_BUSY;
+	}
+
+	spdk_poller_unregister(&ctx->poller);
+	if (spdk_unlikely(ctx->ctrlr == NULL)) {
+		/* The controller failed to initialize and was never attached. */
+		populate_namespaces_cb(ctx, 0, rc != 0 ? rc : -ENODEV);
+	} else {
+		connect_attach_ctrlr(ctx);
 	}
 
 	return SPDK_POLLER_BUSY;
@@ -1810,10 +2840,25 @@ out:
 	return rc;
 }
 
+static uint32_t
+bdev_nvme_count_ctrlrs(const char *name)
+{
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr;
+	uint32_t count = 0;
+
+	TAILQ_FOREACH(nvme_bdev_ctrlr, &g_nvme_bdev_ctrlrs, tailq) {
+		if (strcmp(nvme_bdev_ctrlr->name, name) == 0 && !nvme_bdev_ctrlr->destruct) {
+			count++;
+		}
+	}
+
+	return count;
+}
+
 int
 bdev_nvme_remove_trid(const char *name, struct spdk_nvme_transport_id *trid)
 {
-	struct nvme_bdev_ctrlr		*nvme_bdev_ctrlr;
+	struct nvme_bdev_ctrlr		*nvme_bdev_ctrlr, *ctrlr;
 	struct nvme_bdev_ctrlr_trid	*ctrlr_trid, *tmp_trid;
 
 	if (name == NULL) {
@@ -1826,6 +2871,21 @@ bdev_nvme_remove_trid(const char *name, struct spdk_nvme_transport_id *trid)
 		return -ENODEV;
 	}
 
+	/* A multipath controller connected to the trid is detached while the other paths stay. */
+	if (nvme_bdev_ctrlr->multipath) {
+		TAILQ_FOREACH(ctrlr, &g_nvme_bdev_ctrlrs, tailq) {
+			if (strcmp(ctrlr->name, name) == 0 && !ctrlr->destruct &&
+			    !spdk_nvme_transport_id_compare(trid, ctrlr->connected_trid)) {
+				break;
+			}
+		}
+
+		if (ctrlr != NULL && bdev_nvme_count_ctrlrs(name) > 1) {
+			remove_cb(NULL, ctrlr->ctrlr);
+			return 0;
+		}
+	}
+
 	/* case 1: we are currently using the path to be removed. */
 	if (!spdk_nvme_transport_id_compare(trid, nvme_bdev_ctrlr->connected_trid)) {
 		ctrlr_trid = TAILQ_FIRST(&nvme_bdev_ctrlr->trids);
@@ -1865,6 +2925,8 @@ bdev_nvme_create(struct spdk_nvme_transport_id *trid,
 		 uint32_t count,
 		 const char *hostnqn,
 		 uint32_t prchk_flags,
+		 bool multipath,
+		 struct nvme_bdev_attach_timings *timings,
 		 spdk_bdev_create_nvme_fn cb_fn,
 		 void *cb_ctx)
 {
@@ -1891,20 +2953,40 @@ bdev_nvme_create(struct spdk_nvme_transport_id *trid,
 	ctx->cb_fn = cb_fn;
 	ctx->cb_ctx = cb_ctx;
 	ctx->prchk_flags = prchk_flags;
+	ctx->multipath = multipath;
 	ctx->trid = *trid;
+	ctx->timings = timings;
+	ctx->start_tsc = spdk_get_ticks();
 
 	existing_ctrlr = nvme_bdev_ctrlr_get_by_name(base_name);
-	if (existing_ctrlr) {
+	if (existing_ctrlr && !multipath) {
+		/* Paths of a multipath controller are controllers of their own. */
+		if (existing_ctrlr->multipath) {
+			SPDK_ERRLOG("Controller %s was attached in multipath mode, multipath has to be "
+				    "requested for its other paths too.\n", base_name);
+			free(ctx);
+			return -EINVAL;
+		}
+
 		rc = bdev_nvme_add_trid(existing_ctrlr, trid);
 		if (rc) {
 			free(ctx);
 			return rc;
 		}
+		ctx->attach_tsc = spdk_get_ticks();
 
 		nvme_ctrlr_populate_namespaces_done(ctx);
 		return 0;
 	}
 
+	if (multipath) {
+		rc = bdev_nvme_check_multipath(existing_ctrlr, trid);
+		if (rc) {
+			free(ctx);
+			return rc;
+		}
+	}
+
 	if (trid->trtype == SPDK_NVME_TRANSPORT_PCIE) {
 		TAILQ_FOREACH_SAFE(entry, &g_skipped_nvme_ctrlrs, tailq, tmp) {
 			if (spdk_nvme_transport_id_compare(trid, &entry->trid) == 0) {
@@ -1944,7 +3026,7 @@ bdev_nvme_create(struct spdk_nvme_transport_id *trid,
 int
 bdev_nvme_delete(const char *name)
 {
-	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = NULL;
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr = NULL, *tmp;
 	struct nvme_probe_skip_entry *entry;
 
 	if (name == NULL) {
@@ -1966,7 +3048,13 @@ bdev_nvme_delete(const char *name)
 		TAILQ_INSERT_TAIL(&g_skipped_nvme_ctrlrs, entry, tailq);
 	}
 
-	remove_cb(NULL, nvme_bdev_ctrlr->ctrlr);
+	/* Detach additional multipath controllers first so that bdevs don't change owners. */
+	TAILQ_FOREACH_REVERSE_SAFE(nvme_bdev_ctrlr, &g_nvme_bdev_ctrlrs, nvme_bdev_ctrlrs, tailq, tmp) {
+		if (strcmp(nvme_bdev_ctrlr->name, name) == 0) {
+			remove_cb(NULL, nvme_bdev_ctrlr->ctrlr);
+		}
+	}
+
 	return 0;
 }
 
@@ -2080,7 +3168,7 @@ bdev_nvme_no_pi_readv_done(void *ref, const struct spdk_nvme_cpl *cpl)
 	}
 
 	/* Return original completion status */
-	spdk_bdev_io_complete_nvme_status(bdev_io, bio->cpl.cdw0, bio->cpl.status.sct,
+	bdev_nvme_io_complete_nvme_status(bio, bio->cpl.cdw0, bio->cpl.status.sct,
 					  bio->cpl.status.sc);
 }
 
@@ -2090,6 +3178,7 @@ bdev_nvme_readv_done(void *ref, const struct spdk_nvme_cpl *cpl)
 	struct nvme_bdev_io *bio = ref;
 	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
 	struct nvme_bdev *nbdev = (struct nvme_bdev *)bdev_io->bdev->ctxt;
+	struct nvme_bdev_ns *nvme_ns;
 	struct nvme_io_channel *nvme_ch;
 	int ret;
 
@@ -2100,10 +3189,16 @@ bdev_nvme_readv_done(void *ref, const struct spdk_nvme_cpl *cpl)
 		/* Save completion status to use after verifying PI error. */
 		bio->cpl = *cpl;
 
-		nvme_ch = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
+		if (bio->io_path != NULL) {
+			nvme_ns = bio->io_path->nvme_ns;
+			nvme_ch = bio->io_path->nvme_ch;
+		} else {
+			nvme_ns = nbdev->nvme_ns;
+			nvme_ch = spdk_io_channel_get_ctx(spdk_bdev_io_get_io_channel(bdev_io));
+		}
 
 		/* Read without PI checking to verify PI error. */
-		ret = bdev_nvme_no_pi_readv(nbdev->nvme_ns,
+		ret = bdev_nvme_no_pi_readv(nvme_ns,
 					    nvme_ch,
 					    bio,
 					    bdev_io->u.bdev.iovs,
@@ -2116,13 +3211,14 @@ bdev_nvme_readv_done(void *ref, const struct spdk_nvme_cpl *cpl)
 		}
 	}
 
-	spdk_bdev_io_complete_nvme_status(bdev_io, cpl->cdw0, cpl->status.sct, cpl->status.sc);
+	bdev_nvme_io_complete_nvme_status(bio, cpl->cdw0, cpl->status.sct, cpl->status.sc);
 }
 
 static void
 bdev_nvme_writev_done(void *ref, const struct spdk_nvme_cpl *cpl)
 {
-	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx((struct nvme_bdev_io *)ref);
+	struct nvme_bdev_io *bio = ref;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
 
 	if (spdk_nvme_cpl_is_pi_error(cpl)) {
 		SPDK_ERRLOG("writev completed with PI error (sct=%d, sc=%d)\n",
@@ -2131,13 +3227,14 @@ bdev_nvme_writev_done(void *ref, const struct spdk_nvme_cpl *cpl)
 		bdev_nvme_verify_pi_error(bdev_io);
 	}
 
-	spdk_bdev_io_complete_nvme_status(bdev_io, cpl->cdw0, cpl->status.sct, cpl->status.sc);
+	bdev_nvme_io_complete_nvme_status(bio, cpl->cdw0, cpl->status.sct, cpl->status.sc);
 }
 
 static void
 bdev_nvme_comparev_done(void *ref, const struct spdk_nvme_cpl *cpl)
 {
-	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx((struct nvme_bdev_io *)ref);
+	struct nvme_bdev_io *bio = ref;
+	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
 
 	if (spdk_nvme_cpl_is_pi_error(cpl)) {
 		SPDK_ERRLOG("comparev completed with PI error (sct=%d, sc=%d)\n",
@@ -2146,14 +3243,13 @@ bdev_nvme_comparev_done(void *ref, const struct spdk_nvme_cpl *cpl)
 		bdev_nvme_verify_pi_error(bdev_io);
 	}
 
-	spdk_bdev_io_complete_nvme_status(bdev_io, cpl->cdw0, cpl->status.sct, cpl->status.sc);
+	bdev_nvme_io_complete_nvme_status(bio, cpl->cdw0, cpl->status.sct, cpl->status.sc);
 }
 
 static void
 bdev_nvme_comparev_and_writev_done(void *ref, const struct spdk_nvme_cpl *cpl)
 {
 	struct nvme_bdev_io *bio = ref;
-	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx(bio);
 
 	/* Compare operation completion */
 	if ((cpl->cdw0 & 0xFF) == SPDK_NVME_OPC_COMPARE) {
@@ -2171,18 +3267,16 @@ bdev_nvme_comparev_and_writev_done(void *ref, const struct spdk_nvme_cpl *cpl)
 			SPDK_ERRLOG("Unexpected write success after compare failure.\n");
 		}
 
-		spdk_bdev_io_complete_nvme_status(bdev_io, bio->cpl.cdw0, bio->cpl.status.sct, bio->cpl.status.sc);
+		bdev_nvme_io_complete_nvme_status(bio, bio->cpl.cdw0, bio->cpl.status.sct, bio->cpl.status.sc);
 	} else {
-		spdk_bdev_io_complete_nvme_status(bdev_io, cpl->cdw0, cpl->status.sct, cpl->status.sc);
+		bdev_nvme_io_complete_nvme_status(bio, cpl->cdw0, cpl->status.sct, cpl->status.sc);
 	}
 }
 
 static void
 bdev_nvme_queued_done(void *ref, const struct spdk_nvme_cpl *cpl)
 {
-	struct spdk_bdev_io *bdev_io = spdk_bdev_io_from_ctx((struct nvme_bdev_io *)ref);
-
-	spdk_bdev_io_complete_nvme_status(bdev_io, cpl->cdw0, cpl->status.sct, cpl->status.sc);
+	bdev_nvme_io_complete_nvme_status(ref, cpl->cdw0, cpl->status.sct, cpl->status.sc);
 }
 
 static void
@@ -2723,10 +3817,20 @@ bdev_nvme_config_json(struct spdk_json_write_ctx *w)
 		spdk_json_write_named_object_begin(w, "params");
 		spdk_json_write_named_string(w, "name", nvme_bdev_ctrlr->name);
 		nvme_bdev_dump_trid_json(trid, w);
-		spdk_json_write_named_bool(w, "prchk_reftag",
-					   (nvme_bdev_ctrlr->prchk_flags & SPDK_NVME_IO_FLAGS_PRCHK_REFTAG) != 0);
-		spdk_json_write_named_bool(w, "prchk_guard",
-					   (nvme_bdev_ctrlr->prchk_flags & SPDK_NVME_IO_FLAGS_PRCHK_GUARD) != 0);
+		if (nvme_bdev_ctrlr->multipath) {
+			spdk_json_write_named_string(w, "multipath", "multipath");
+		}
+		/* Additional multipath controllers inherit these from the first one. */
+		if (nvme_bdev_ctrlr_get_by_name(nvme_bdev_ctrlr->name) == nvme_bdev_ctrlr) {
+			spdk_json_write_named_bool(w, "prchk_reftag",
+						   (nvme_bdev_ctrlr->prchk_flags & SPDK_NVME_IO_FLAGS_PRCHK_REFTAG) != 0);
+			spdk_json_write_named_bool(w, "prchk_guard",
+						   (nvme_bdev_ctrlr->prchk_flags & SPDK_NVME_IO_FLAGS_PRCHK_GUARD) != 0);
+			if (nvme_bdev_ctrlr->multipath) {
+				spdk_json_write_named_string(w, "mp_policy",
+							     bdev_nvme_mp_policy_str(nvme_bdev_ctrlr->mp_policy));
+			}
+		}
 
 		spdk_json_write_object_end(w);
 
@@ -2768,4 +3872,195 @@ bdev_nvme_get_ctrlr(struct spdk_bdev *bdev)
 	return SPDK_CONTAINEROF(bdev, struct nvme_bdev, disk)->nvme_ns->ctrlr->ctrlr;
 }
 
+const char *
+bdev_nvme_mp_policy_str(enum nvme_bdev_mp_policy policy)
+{
+	switch (policy) {
+	case NVME_BDEV_MP_POLICY_ROUND_ROBIN:
+		return "round_robin";
+	case NVME_BDEV_MP_POLICY_QUEUE_DEPTH:
+		return "queue_depth";
+	case NVME_BDEV_MP_POLICY_ANA:
+		return "ana";
+	default:
+		return NULL;
+	}
+}
+
+int
+bdev_nvme_mp_policy_parse(enum nvme_bdev_mp_policy *policy, const char *str)
+{
+	if (strcasecmp(str, "round_robin") == 0) {
+		*policy = NVME_BDEV_MP_POLICY_ROUND_ROBIN;
+	} else if (strcasecmp(str, "queue_depth") == 0) {
+		*policy = NVME_BDEV_MP_POLICY_QUEUE_DEPTH;
+	} else if (strcasecmp(str, "ana") == 0) {
+		*policy = NVME_BDEV_MP_POLICY_ANA;
+	} else {
+		return -EINVAL;
+	}
+
+	return 0;
+}
+
+const char *
+bdev_nvme_ana_state_str(enum spdk_nvme_ana_state ana_state)
+{
+	switch (ana_state) {
+	case SPDK_NVME_ANA_OPTIMIZED_STATE:
+		return "optimized";
+	case SPDK_NVME_ANA_NON_OPTIMIZED_STATE:
+		return "non_optimized";
+	case SPDK_NVME_ANA_INACCESSIBLE_STATE:
+		return "inaccessible";
+	case SPDK_NVME_ANA_PERSISTENT_LOSS_STATE:
+		return "persistent_loss";
+	case SPDK_NVME_ANA_CHANGE_STATE:
+		return "change";
+	default:
+		return "unreported";
+	}
+}
+
+int
+bdev_nvme_set_multipath_policy(const char *name, enum nvme_bdev_mp_policy policy)
+{
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr;
+	struct nvme_bdev_path *path;
+	uint32_t i;
+	int rc = -ENODEV;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	TAILQ_FOREACH(nvme_bdev_ctrlr, &g_nvme_bdev_ctrlrs, tailq) {
+		if (strcmp(nvme_bdev_ctrlr->name, name) != 0) {
+			continue;
+		}
+
+		if (!nvme_bdev_ctrlr->multipath) {
+			rc = -EINVAL;
+			break;
+		}
+
+		nvme_bdev_ctrlr->mp_policy = policy;
+		for (i = 0; i < nvme_bdev_ctrlr->num_ns; i++) {
+			if (!nvme_bdev_ctrlr->namespaces[i]->populated) {
+				continue;
+			}
+			TAILQ_FOREACH(path, &nvme_bdev_ctrlr->namespaces[i]->paths, ns_tailq) {
+				path->nbdev->mp_policy = policy;
+			}
+		}
+		rc = 0;
+	}
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	return rc;
+}
+
+struct bdev_nvme_get_io_paths_ctx {
+	struct nvme_bdev		*nbdev;
+	uint32_t			num_paths;
+	struct nvme_bdev_path		**paths;
+	struct bdev_nvme_io_path_info	*info;
+	bdev_nvme_get_io_paths_cb	cb_fn;
+	void				*cb_arg;
+};
+
+static void
+_bdev_nvme_get_io_paths(struct spdk_io_channel_iter *i)
+{
+	struct bdev_nvme_get_io_paths_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+	struct spdk_io_channel *_ch = spdk_io_channel_iter_get_channel(i);
+	struct nvme_bdev_channel *nbdev_ch = spdk_io_channel_get_ctx(_ch);
+	struct nvme_io_path *io_path;
+	uint32_t j;
+
+	TAILQ_FOREACH(io_path, &nbdev_ch->io_paths, tailq) {
+		for (j = 0; j < ctx->num_paths; j++) {
+			if (io_path->path == ctx->paths[j]) {
+				ctx->info[j].outstanding += io_path->outstanding;
+				bdev_nvme_io_path_stat_add(&ctx->info[j].stat, &io_path->stat);
+				break;
+			}
+		}
+	}
+
+	spdk_for_each_channel_continue(i, 0);
+}
+
+static void
+_bdev_nvme_get_io_paths_done(struct spdk_io_channel_iter *i, int status)
+{
+	struct bdev_nvme_get_io_paths_ctx *ctx = spdk_io_channel_iter_get_ctx(i);
+
+	ctx->cb_fn(ctx->cb_arg, ctx->info, ctx->num_paths, 0);
+
+	bdev_nvme_channel_iter_done(ctx->nbdev);
+	free(ctx->paths);
+	free(ctx->info);
+	free(ctx);
+}
+
+int
+bdev_nvme_get_io_paths(struct spdk_bdev *bdev, bdev_nvme_get_io_paths_cb cb_fn, void *cb_arg)
+{
+	struct bdev_nvme_get_io_paths_ctx *ctx;
+	struct nvme_bdev *nbdev;
+	struct nvme_bdev_path *path;
+	uint32_t i;
+
+	if (bdev->module != &nvme_if) {
+		return -ENODEV;
+	}
+
+	nbdev = SPDK_CONTAINEROF(bdev, struct nvme_bdev, disk);
+	if (!nbdev->multipath) {
+		return -EINVAL;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		return -ENOMEM;
+	}
+	ctx->nbdev = nbdev;
+	ctx->cb_fn = cb_fn;
+	ctx->cb_arg = cb_arg;
+
+	pthread_mutex_lock(&g_bdev_nvme_mutex);
+	if (nbdev->destruct) {
+		pthread_mutex_unlock(&g_bdev_nvme_mutex);
+		free(ctx);
+		return -ENODEV;
+	}
+
+	TAILQ_FOREACH(path, &nbdev->paths, tailq) {
+		ctx->num_paths++;
+	}
+
+	ctx->paths = calloc(ctx->num_paths, sizeof(*ctx->paths));
+	ctx->info = calloc(ctx->num_paths, sizeof(*ctx->info));
+	if (ctx->paths == NULL || ctx->info == NULL) {
+		pthread_mutex_unlock(&g_bdev_nvme_mutex);
+		free(ctx->paths);
+		free(ctx->info);
+		free(ctx);
+		return -ENOMEM;
+	}
+
+	/* Counters of the live channels are added to the ones already folded into each path. */
+	i = 0;
+	TAILQ_FOREACH(path, &nbdev->paths, tailq) {
+		ctx->paths[i] = path;
+		ctx->info[i].trid = *path->nvme_ns->ctrlr->connected_trid;
+		ctx->info[i].ana_state = spdk_nvme_ns_get_ana_state(path->nvme_ns->ns);
+		ctx->info[i].stat = path->stat;
+		i++;
+	}
+	nbdev->channel_iters++;
+	pthread_mutex_unlock(&g_bdev_nvme_mutex);
+
+	spdk_for_each_channel(nbdev, _bdev_nvme_get_io_paths, ctx, _bdev_nvme_get_io_paths_done);
+	return 0;
+}
+
 SPDK_LOG_REGISTER_COMPONENT(bdev_nvme)
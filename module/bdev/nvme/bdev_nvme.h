@@ -75,6 +75,8 @@ int bdev_nvme_create(struct spdk_nvme_transport_id *trid,
 		     uint32_t count,
 		     const char *hostnqn,
 		     uint32_t prchk_flags,
+		     bool multipath,
+		     struct nvme_bdev_attach_timings *timings,
 		     spdk_bdev_create_nvme_fn cb_fn,
 		     void *cb_ctx);
 struct spdk_nvme_ctrlr *bdev_nvme_get_ctrlr(struct spdk_bdev *bdev);
@@ -88,4 +90,41 @@ struct spdk_nvme_ctrlr *bdev_nvme_get_ctrlr(struct spdk_bdev *bdev);
  */
 int bdev_nvme_delete(const char *name);
 
+struct bdev_nvme_io_path_info {
+	struct spdk_nvme_transport_id	trid;
+	enum spdk_nvme_ana_state	ana_state;
+	uint64_t			outstanding;
+	struct nvme_io_path_stat	stat;
+};
+
+typedef void (*bdev_nvme_get_io_paths_cb)(void *cb_arg, struct bdev_nvme_io_path_info *info,
+		uint32_t num_paths, int rc);
+
+/**
+ * Get the I/O paths of a multipath NVMe bdev together with their counters
+ * summed over all threads.
+ *
+ * \param bdev Multipath NVMe bdev.
+ * \param cb_fn Called with the path information once collected.
+ * \param cb_arg Argument passed to cb_fn.
+ * \return zero on success, -ENODEV if bdev is not an NVMe bdev, -EINVAL if it
+ * is not a multipath bdev or -ENOMEM.
+ */
+int bdev_nvme_get_io_paths(struct spdk_bdev *bdev, bdev_nvme_get_io_paths_cb cb_fn, void *cb_arg);
+
+/**
+ * Set the path selection policy of all multipath controllers with the given name
+ * and of the bdevs on top of them.
+ *
+ * \param name NVMe controller name
+ * \param policy Path selection policy
+ * \return zero on success, -ENODEV if controller is not found or -EINVAL if it
+ * was not attached in multipath mode
+ */
+int bdev_nvme_set_multipath_policy(const char *name, enum nvme_bdev_mp_policy policy);
+
+const char *bdev_nvme_mp_policy_str(enum nvme_bdev_mp_policy policy);
+int bdev_nvme_mp_policy_parse(enum nvme_bdev_mp_policy *policy, const char *str);
+const char *bdev_nvme_ana_state_str(enum spdk_nvme_ana_state ana_state);
+
 #endif /* SPDK_BDEV_NVME_H */
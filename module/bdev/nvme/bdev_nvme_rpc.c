@@ -180,6 +180,8 @@ struct rpc_bdev_nvme_attach_controller {
 	char *hostsvcid;
 	bool prchk_reftag;
 	bool prchk_guard;
+	char *multipath;
+	char *mp_policy;
 };
 
 static void
@@ -195,6 +197,8 @@ free_rpc_bdev_nvme_attach_controller(struct rpc_bdev_nvme_attach_controller *req
 	free(req->hostnqn);
 	free(req->hostaddr);
 	free(req->hostsvcid);
+	free(req->multipath);
+	free(req->mp_policy);
 }
 
 static const struct spdk_json_object_decoder rpc_bdev_nvme_attach_controller_decoders[] = {
@@ -211,16 +215,44 @@ static const struct spdk_json_object_decoder rpc_bdev_nvme_attach_controller_dec
 	{"hostsvcid", offsetof(struct rpc_bdev_nvme_attach_controller, hostsvcid), spdk_json_decode_string, true},
 
 	{"prchk_reftag", offsetof(struct rpc_bdev_nvme_attach_controller, prchk_reftag), spdk_json_decode_bool, true},
-	{"prchk_guard", offsetof(struct rpc_bdev_nvme_attach_controller, prchk_guard), spdk_json_decode_bool, true}
+	{"prchk_guard", offsetof(struct rpc_bdev_nvme_attach_controller, prchk_guard), spdk_json_decode_bool, true},
+	{"multipath", offsetof(struct rpc_bdev_nvme_attach_controller, multipath), spdk_json_decode_string, true},
+	{"mp_policy", offsetof(struct rpc_bdev_nvme_attach_controller, mp_policy), spdk_json_decode_string, true}
 };
 
 #define NVME_MAX_BDEVS_PER_RPC 128
 
+struct rpc_bdev_nvme_attach_controllers_ctx;
+
+enum rpc_bdev_nvme_attach_state {
+	RPC_BDEV_NVME_ATTACH_PENDING,
+	RPC_BDEV_NVME_ATTACH_RUNNING,
+	RPC_BDEV_NVME_ATTACH_DONE,
+};
+
 struct rpc_bdev_nvme_attach_controller_ctx {
 	struct rpc_bdev_nvme_attach_controller req;
 	uint32_t count;
 	const char *names[NVME_MAX_BDEVS_PER_RPC];
 	struct spdk_jsonrpc_request *request;
+	bool set_mp_policy;
+	enum nvme_bdev_mp_policy mp_policy;
+
+	struct spdk_nvme_transport_id trid;
+	struct spdk_nvme_host_id hostid;
+	uint32_t prchk_flags;
+	bool multipath;
+
+	/* Only used by bdev_nvme_attach_controllers */
+	struct rpc_bdev_nvme_attach_controllers_ctx *batch;
+	/* Previous entry of the batch with the same name, which has to be attached first */
+	struct rpc_bdev_nvme_attach_controller_ctx *prev;
+	enum rpc_bdev_nvme_attach_state state;
+	int rc;
+	size_t bdev_count;
+	char *bdev_names[NVME_MAX_BDEVS_PER_RPC];
+	uint64_t start_tsc;
+	struct nvme_bdev_attach_timings timings;
 };
 
 static void
@@ -236,6 +268,14 @@ rpc_bdev_nvme_attach_controller_done(void *cb_ctx, size_t bdev_count, int rc)
 		goto exit;
 	}
 
+	if (ctx->set_mp_policy) {
+		rc = bdev_nvme_set_multipath_policy(ctx->req.name, ctx->mp_policy);
+		if (rc != 0) {
+			spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+			goto exit;
+		}
+	}
+
 	w = spdk_jsonrpc_begin_result(request);
 	spdk_json_write_array_begin(w);
 	for (i = 0; i < bdev_count; i++) {
@@ -249,137 +289,193 @@ exit:
 	free(ctx);
 }
 
-static void
-rpc_bdev_nvme_attach_controller(struct spdk_jsonrpc_request *request,
-				const struct spdk_json_val *params)
+/* Parses the decoded parameters into ctx, sending the error response on failure. */
+static int
+rpc_bdev_nvme_attach_controller_parse(struct spdk_jsonrpc_request *request,
+				      struct rpc_bdev_nvme_attach_controller_ctx *ctx)
 {
-	struct rpc_bdev_nvme_attach_controller_ctx *ctx;
-	struct spdk_nvme_transport_id trid = {};
-	struct spdk_nvme_host_id hostid = {};
-	uint32_t prchk_flags = 0;
-	struct nvme_bdev_ctrlr *ctrlr = NULL;
+	struct spdk_nvme_transport_id *trid = &ctx->trid;
+	struct spdk_nvme_host_id *hostid = &ctx->hostid;
 	size_t len, maxlen;
 	int rc;
 
-	ctx = calloc(1, sizeof(*ctx));
-	if (!ctx) {
-		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
-		return;
-	}
-
-	if (spdk_json_decode_object(params, rpc_bdev_nvme_attach_controller_decoders,
-				    SPDK_COUNTOF(rpc_bdev_nvme_attach_controller_decoders),
-				    &ctx->req)) {
-		SPDK_ERRLOG("spdk_json_decode_object failed\n");
-		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
-						 "spdk_json_decode_object failed");
-		goto cleanup;
-	}
-
 	/* Parse trstring */
-	rc = spdk_nvme_transport_id_populate_trstring(&trid, ctx->req.trtype);
+	rc = spdk_nvme_transport_id_populate_trstring(trid, ctx->req.trtype);
 	if (rc < 0) {
 		SPDK_ERRLOG("Failed to parse trtype: %s\n", ctx->req.trtype);
 		spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "Failed to parse trtype: %s",
 						     ctx->req.trtype);
-		goto cleanup;
+		return -EINVAL;
 	}
 
 	/* Parse trtype */
-	rc = spdk_nvme_transport_id_parse_trtype(&trid.trtype, ctx->req.trtype);
+	rc = spdk_nvme_transport_id_parse_trtype(&trid->trtype, ctx->req.trtype);
 	assert(rc == 0);
 
-	ctrlr = nvme_bdev_ctrlr_get_by_name(ctx->req.name);
-
 	/* Parse traddr */
-	maxlen = sizeof(trid.traddr);
+	maxlen = sizeof(trid->traddr);
 	len = strnlen(ctx->req.traddr, maxlen);
 	if (len == maxlen) {
 		spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "traddr too long: %s",
 						     ctx->req.traddr);
-		goto cleanup;
+		return -EINVAL;
 	}
-	memcpy(trid.traddr, ctx->req.traddr, len + 1);
+	memcpy(trid->traddr, ctx->req.traddr, len + 1);
 
 	/* Parse adrfam */
 	if (ctx->req.adrfam) {
-		rc = spdk_nvme_transport_id_parse_adrfam(&trid.adrfam, ctx->req.adrfam);
+		rc = spdk_nvme_transport_id_parse_adrfam(&trid->adrfam, ctx->req.adrfam);
 		if (rc < 0) {
 			SPDK_ERRLOG("Failed to parse adrfam: %s\n", ctx->req.adrfam);
 			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "Failed to parse adrfam: %s",
 							     ctx->req.adrfam);
-			goto cleanup;
+			return -EINVAL;
 		}
 	}
 
 	/* Parse trsvcid */
 	if (ctx->req.trsvcid) {
-		maxlen = sizeof(trid.trsvcid);
+		maxlen = sizeof(trid->trsvcid);
 		len = strnlen(ctx->req.trsvcid, maxlen);
 		if (len == maxlen) {
 			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "trsvcid too long: %s",
 							     ctx->req.trsvcid);
-			goto cleanup;
+			return -EINVAL;
 		}
-		memcpy(trid.trsvcid, ctx->req.trsvcid, len + 1);
+		memcpy(trid->trsvcid, ctx->req.trsvcid, len + 1);
 	}
 
 	/* Parse priority for the NVMe-oF transport connection */
 	if (ctx->req.priority) {
-		trid.priority = spdk_strtol(ctx->req.priority, 10);
+		trid->priority = spdk_strtol(ctx->req.priority, 10);
 	}
 
 	/* Parse subnqn */
 	if (ctx->req.subnqn) {
-		maxlen = sizeof(trid.subnqn);
+		maxlen = sizeof(trid->subnqn);
 		len = strnlen(ctx->req.subnqn, maxlen);
 		if (len == maxlen) {
 			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "subnqn too long: %s",
 							     ctx->req.subnqn);
-			goto cleanup;
+			return -EINVAL;
 		}
-		memcpy(trid.subnqn, ctx->req.subnqn, len + 1);
+		memcpy(trid->subnqn, ctx->req.subnqn, len + 1);
 	}
 
-	if (ctrlr && (ctx->req.hostaddr || ctx->req.hostnqn || ctx->req.hostsvcid || ctx->req.prchk_guard ||
-		      ctx->req.prchk_reftag)) {
-		goto conflicting_arguments;
+	/* Parse multipath mode */
+	if (ctx->req.multipath) {
+		if (strcasecmp(ctx->req.multipath, "multipath") == 0) {
+			ctx->multipath = true;
+		} else if (strcasecmp(ctx->req.multipath, "failover") != 0) {
+			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "Invalid multipath mode: %s",
+							     ctx->req.multipath);
+			return -EINVAL;
+		}
+	}
+
+	if (ctx->req.mp_policy) {
+		if (!ctx->multipath) {
+			spdk_jsonrpc_send_error_response(request, -EINVAL,
+							 "mp_policy requires multipath mode");
+			return -EINVAL;
+		}
+		if (bdev_nvme_mp_policy_parse(&ctx->mp_policy, ctx->req.mp_policy) != 0) {
+			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "Invalid mp_policy: %s",
+							     ctx->req.mp_policy);
+			return -EINVAL;
+		}
+		ctx->set_mp_policy = true;
 	}
 
 	if (ctx->req.hostaddr) {
-		maxlen = sizeof(hostid.hostaddr);
+		maxlen = sizeof(hostid->hostaddr);
 		len = strnlen(ctx->req.hostaddr, maxlen);
 		if (len == maxlen) {
 			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "hostaddr too long: %s",
 							     ctx->req.hostaddr);
-			goto cleanup;
+			return -EINVAL;
 		}
-		memcpy(hostid.hostaddr, ctx->req.hostaddr, len + 1);
+		memcpy(hostid->hostaddr, ctx->req.hostaddr, len + 1);
 	}
 
 	if (ctx->req.hostsvcid) {
-		maxlen = sizeof(hostid.hostsvcid);
+		maxlen = sizeof(hostid->hostsvcid);
 		len = strnlen(ctx->req.hostsvcid, maxlen);
 		if (len == maxlen) {
 			spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "hostsvcid too long: %s",
 							     ctx->req.hostsvcid);
-			goto cleanup;
+			return -EINVAL;
 		}
-		memcpy(hostid.hostsvcid, ctx->req.hostsvcid, len + 1);
+		memcpy(hostid->hostsvcid, ctx->req.hostsvcid, len + 1);
 	}
 
 	if (ctx->req.prchk_reftag) {
-		prchk_flags |= SPDK_NVME_IO_FLAGS_PRCHK_REFTAG;
+		ctx->prchk_flags |= SPDK_NVME_IO_FLAGS_PRCHK_REFTAG;
 	}
 
 	if (ctx->req.prchk_guard) {
-		prchk_flags |= SPDK_NVME_IO_FLAGS_PRCHK_GUARD;
+		ctx->prchk_flags |= SPDK_NVME_IO_FLAGS_PRCHK_GUARD;
+	}
+
+	return 0;
+}
+
+/* Checks the options that can't be given for a name that already has a controller. */
+static bool
+rpc_bdev_nvme_attach_controller_conflicts(struct rpc_bdev_nvme_attach_controller_ctx *ctx)
+{
+	struct nvme_bdev_ctrlr *ctrlr;
+
+	ctrlr = nvme_bdev_ctrlr_get_by_name(ctx->req.name);
+	if (ctrlr == NULL) {
+		return false;
+	}
+
+	if (ctx->multipath) {
+		/* Each path has its own connection, so only the options shared by
+		 * all paths of the name are fixed by the first controller. */
+		return ctx->req.prchk_guard || ctx->req.prchk_reftag || ctx->req.mp_policy;
+	}
+
+	return ctx->req.hostaddr || ctx->req.hostnqn || ctx->req.hostsvcid ||
+	       ctx->req.prchk_guard || ctx->req.prchk_reftag;
+}
+
+static void
+rpc_bdev_nvme_attach_controller(struct spdk_jsonrpc_request *request,
+				const struct spdk_json_val *params)
+{
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx;
+	int rc;
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (!ctx) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		return;
+	}
+
+	if (spdk_json_decode_object(params, rpc_bdev_nvme_attach_controller_decoders,
+				    SPDK_COUNTOF(rpc_bdev_nvme_attach_controller_decoders),
+				    &ctx->req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	if (rpc_bdev_nvme_attach_controller_parse(request, ctx) != 0) {
+		goto cleanup;
+	}
+
+	if (rpc_bdev_nvme_attach_controller_conflicts(ctx)) {
+		goto conflicting_arguments;
 	}
 
 	ctx->request = request;
 	ctx->count = NVME_MAX_BDEVS_PER_RPC;
-	rc = bdev_nvme_create(&trid, &hostid, ctx->req.name, ctx->names, ctx->count, ctx->req.hostnqn,
-			      prchk_flags, rpc_bdev_nvme_attach_controller_done, ctx);
+	rc = bdev_nvme_create(&ctx->trid, &ctx->hostid, ctx->req.name, ctx->names, ctx->count,
+			      ctx->req.hostnqn, ctx->prchk_flags, ctx->multipath, NULL,
+			      rpc_bdev_nvme_attach_controller_done, ctx);
 	if (rc) {
 		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
 		goto cleanup;
@@ -398,6 +494,286 @@ SPDK_RPC_REGISTER("bdev_nvme_attach_controller", rpc_bdev_nvme_attach_controller
 		  SPDK_RPC_RUNTIME)
 SPDK_RPC_REGISTER_ALIAS_DEPRECATED(bdev_nvme_attach_controller, construct_nvme_bdev)
 
+#define NVME_MAX_CTRLRS_PER_RPC 1024
+
+struct rpc_bdev_nvme_attach_controllers_ctx {
+	struct rpc_bdev_nvme_attach_controller_ctx *ctrlrs;
+	size_t num_ctrlrs;
+	uint32_t max_concurrent;
+
+	struct spdk_jsonrpc_request *request;
+	uint32_t in_flight;
+	size_t num_done;
+	bool starting;
+	uint64_t start_tsc;
+};
+
+static int
+rpc_decode_attach_controller(const struct spdk_json_val *val, void *out)
+{
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx = out;
+
+	return spdk_json_decode_object(val, rpc_bdev_nvme_attach_controller_decoders,
+				       SPDK_COUNTOF(rpc_bdev_nvme_attach_controller_decoders),
+				       &ctx->req);
+}
+
+static int
+rpc_decode_attach_controllers(const struct spdk_json_val *val, void *out)
+{
+	struct rpc_bdev_nvme_attach_controllers_ctx *batch;
+	size_t i, count = 0;
+
+	batch = SPDK_CONTAINEROF(out, struct rpc_bdev_nvme_attach_controllers_ctx, ctrlrs);
+
+	if (val->type != SPDK_JSON_VAL_ARRAY_BEGIN || batch->ctrlrs != NULL) {
+		return -1;
+	}
+
+	/* Each entry is large, so only allocate as many as were given. */
+	for (i = 0; i < val->len; i += spdk_json_val_len(&val[i + 1])) {
+		count++;
+	}
+
+	if (count == 0) {
+		return 0;
+	}
+
+	if (count > NVME_MAX_CTRLRS_PER_RPC) {
+		SPDK_ERRLOG("At most %d controllers can be attached at once\n", NVME_MAX_CTRLRS_PER_RPC);
+		return -1;
+	}
+
+	batch->ctrlrs = calloc(count, sizeof(*batch->ctrlrs));
+	if (batch->ctrlrs == NULL) {
+		return -1;
+	}
+
+	if (spdk_json_decode_array(val, rpc_decode_attach_controller, batch->ctrlrs, count,
+				   &batch->num_ctrlrs, sizeof(*batch->ctrlrs))) {
+		/* The entry that failed may be partially decoded, so free all of them. */
+		batch->num_ctrlrs = count;
+		return -1;
+	}
+
+	return 0;
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_nvme_attach_controllers_decoders[] = {
+	{"controllers", offsetof(struct rpc_bdev_nvme_attach_controllers_ctx, ctrlrs), rpc_decode_attach_controllers},
+	{"max_concurrent", offsetof(struct rpc_bdev_nvme_attach_controllers_ctx, max_concurrent), spdk_json_decode_uint32, true},
+};
+
+static void
+free_rpc_bdev_nvme_attach_controllers(struct rpc_bdev_nvme_attach_controllers_ctx *batch)
+{
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx;
+	size_t i, j;
+
+	for (i = 0; i < batch->num_ctrlrs; i++) {
+		ctx = &batch->ctrlrs[i];
+		free_rpc_bdev_nvme_attach_controller(&ctx->req);
+		for (j = 0; j < ctx->bdev_count; j++) {
+			free(ctx->bdev_names[j]);
+		}
+	}
+
+	free(batch->ctrlrs);
+	free(batch);
+}
+
+static void
+rpc_bdev_nvme_attach_controllers_respond(struct rpc_bdev_nvme_attach_controllers_ctx *batch)
+{
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx;
+	struct spdk_json_write_ctx *w;
+	uint64_t ticks_hz = spdk_get_ticks_hz();
+	size_t i, j;
+
+	w = spdk_jsonrpc_begin_result(batch->request);
+	spdk_json_write_array_begin(w);
+	for (i = 0; i < batch->num_ctrlrs; i++) {
+		ctx = &batch->ctrlrs[i];
+
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_string(w, "name", ctx->req.name);
+		spdk_json_write_named_string(w, "traddr", ctx->req.traddr);
+		if (ctx->rc != 0) {
+			spdk_json_write_named_string(w, "error", spdk_strerror(-ctx->rc));
+		}
+		spdk_json_write_named_array_begin(w, "bdevs");
+		for (j = 0; j < ctx->bdev_count; j++) {
+			spdk_json_write_string(w, ctx->bdev_names[j]);
+		}
+		spdk_json_write_array_end(w);
+		spdk_json_write_named_uint64(w, "queued_us",
+					     (ctx->start_tsc - batch->start_tsc) * SPDK_SEC_TO_USEC / ticks_hz);
+		spdk_json_write_named_uint64(w, "connect_us", ctx->timings.connect_us);
+		spdk_json_write_named_uint64(w, "populate_us", ctx->timings.populate_us);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+	spdk_jsonrpc_end_result(batch->request, w);
+
+	free_rpc_bdev_nvme_attach_controllers(batch);
+}
+
+static void
+rpc_bdev_nvme_attach_controllers_finish(struct rpc_bdev_nvme_attach_controller_ctx *ctx, int rc)
+{
+	struct rpc_bdev_nvme_attach_controllers_ctx *batch = ctx->batch;
+
+	ctx->rc = rc;
+	ctx->state = RPC_BDEV_NVME_ATTACH_DONE;
+	batch->num_done++;
+}
+
+static void rpc_bdev_nvme_attach_controllers_start(struct rpc_bdev_nvme_attach_controllers_ctx *batch);
+
+static void
+rpc_bdev_nvme_attach_controllers_done(void *cb_ctx, size_t bdev_count, int rc)
+{
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx = cb_ctx;
+	struct rpc_bdev_nvme_attach_controllers_ctx *batch = ctx->batch;
+	size_t i;
+
+	if (rc == 0 && ctx->set_mp_policy) {
+		rc = bdev_nvme_set_multipath_policy(ctx->req.name, ctx->mp_policy);
+	}
+
+	if (rc == 0) {
+		/* The bdevs may go away before the whole batch is done. */
+		for (i = 0; i < bdev_count; i++) {
+			ctx->bdev_names[i] = strdup(ctx->names[i]);
+			if (ctx->bdev_names[i] == NULL) {
+				rc = -ENOMEM;
+				break;
+			}
+		}
+		ctx->bdev_count = i;
+	}
+
+	assert(batch->in_flight > 0);
+	batch->in_flight--;
+	rpc_bdev_nvme_attach_controllers_finish(ctx, rc);
+
+	rpc_bdev_nvme_attach_controllers_start(batch);
+}
+
+/*
+ * Starts the attach of every controller that is allowed to run. All of them are connected
+ * and initialized concurrently, except that the controllers sharing a name are attached
+ * in the order they were given, since the later ones become additional paths.
+ */
+static void
+rpc_bdev_nvme_attach_controllers_start(struct rpc_bdev_nvme_attach_controllers_ctx *batch)
+{
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx;
+	bool progress;
+	size_t i;
+	int rc;
+
+	if (batch->starting) {
+		/* A controller completed synchronously, the outer loop picks up the change. */
+		return;
+	}
+
+	batch->starting = true;
+	do {
+		progress = false;
+		for (i = 0; i < batch->num_ctrlrs; i++) {
+			if (batch->max_concurrent != 0 && batch->in_flight >= batch->max_concurrent) {
+				break;
+			}
+
+			ctx = &batch->ctrlrs[i];
+			if (ctx->state != RPC_BDEV_NVME_ATTACH_PENDING ||
+			    (ctx->prev != NULL && ctx->prev->state != RPC_BDEV_NVME_ATTACH_DONE)) {
+				continue;
+			}
+
+			progress = true;
+			ctx->state = RPC_BDEV_NVME_ATTACH_RUNNING;
+			ctx->start_tsc = spdk_get_ticks();
+
+			if (rpc_bdev_nvme_attach_controller_conflicts(ctx)) {
+				rpc_bdev_nvme_attach_controllers_finish(ctx, -EINVAL);
+				continue;
+			}
+
+			batch->in_flight++;
+			rc = bdev_nvme_create(&ctx->trid, &ctx->hostid, ctx->req.name, ctx->names, ctx->count,
+					      ctx->req.hostnqn, ctx->prchk_flags, ctx->multipath, &ctx->timings,
+					      rpc_bdev_nvme_attach_controllers_done, ctx);
+			if (rc != 0) {
+				batch->in_flight--;
+				rpc_bdev_nvme_attach_controllers_finish(ctx, rc);
+			}
+		}
+	} while (progress);
+	batch->starting = false;
+
+	if (batch->num_done == batch->num_ctrlrs) {
+		rpc_bdev_nvme_attach_controllers_respond(batch);
+	}
+}
+
+static void
+rpc_bdev_nvme_attach_controllers(struct spdk_jsonrpc_request *request,
+				 const struct spdk_json_val *params)
+{
+	struct rpc_bdev_nvme_attach_controllers_ctx *batch;
+	struct rpc_bdev_nvme_attach_controller_ctx *ctx;
+	size_t i, j;
+
+	batch = calloc(1, sizeof(*batch));
+	if (batch == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		return;
+	}
+
+	if (spdk_json_decode_object(params, rpc_bdev_nvme_attach_controllers_decoders,
+				    SPDK_COUNTOF(rpc_bdev_nvme_attach_controllers_decoders),
+				    batch)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INVALID_PARAMS,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	if (batch->num_ctrlrs == 0) {
+		spdk_jsonrpc_send_error_response(request, -EINVAL, "No controllers given");
+		goto cleanup;
+	}
+
+	/* Validate every entry before attaching any controller. */
+	for (i = 0; i < batch->num_ctrlrs; i++) {
+		ctx = &batch->ctrlrs[i];
+		if (rpc_bdev_nvme_attach_controller_parse(request, ctx) != 0) {
+			goto cleanup;
+		}
+
+		ctx->batch = batch;
+		ctx->count = NVME_MAX_BDEVS_PER_RPC;
+		for (j = i; j > 0; j--) {
+			if (strcmp(batch->ctrlrs[j - 1].req.name, ctx->req.name) == 0) {
+				ctx->prev = &batch->ctrlrs[j - 1];
+				break;
+			}
+		}
+	}
+
+	batch->request = request;
+	batch->start_tsc = spdk_get_ticks();
+	rpc_bdev_nvme_attach_controllers_start(batch);
+	return;
+
+cleanup:
+	free_rpc_bdev_nvme_attach_controllers(batch);
+}
+SPDK_RPC_REGISTER("bdev_nvme_attach_controllers", rpc_bdev_nvme_attach_controllers,
+		  SPDK_RPC_RUNTIME)
+
 static void
 rpc_dump_nvme_controller_info(struct spdk_json_write_ctx *w,
 			      struct nvme_bdev_ctrlr *nvme_bdev_ctrlr)
@@ -470,7 +846,12 @@ rpc_bdev_nvme_get_controllers(struct spdk_jsonrpc_request *request,
 	spdk_json_write_array_begin(w);
 
 	if (ctrlr != NULL) {
-		rpc_dump_nvme_controller_info(w, ctrlr);
+		/* Every path of a multipath controller is attached under the same name. */
+		for (; ctrlr; ctrlr = nvme_bdev_next_ctrlr(ctrlr)) {
+			if (strcmp(ctrlr->name, req.name) == 0) {
+				rpc_dump_nvme_controller_info(w, ctrlr);
+			}
+		}
 	} else {
 		for (ctrlr = nvme_bdev_first_ctrlr(); ctrlr; ctrlr = nvme_bdev_next_ctrlr(ctrlr))  {
 			rpc_dump_nvme_controller_info(w, ctrlr);
@@ -962,3 +1343,178 @@ rpc_bdev_nvme_apply_firmware(struct spdk_jsonrpc_request *request,
 }
 SPDK_RPC_REGISTER("bdev_nvme_apply_firmware", rpc_bdev_nvme_apply_firmware, SPDK_RPC_RUNTIME)
 SPDK_RPC_REGISTER_ALIAS_DEPRECATED(bdev_nvme_apply_firmware, apply_nvme_firmware)
+
+struct rpc_bdev_nvme_set_multipath_policy {
+	char *name;
+	char *policy;
+};
+
+static void
+free_rpc_bdev_nvme_set_multipath_policy(struct rpc_bdev_nvme_set_multipath_policy *req)
+{
+	free(req->name);
+	free(req->policy);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_nvme_set_multipath_policy_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_nvme_set_multipath_policy, name), spdk_json_decode_string},
+	{"policy", offsetof(struct rpc_bdev_nvme_set_multipath_policy, policy), spdk_json_decode_string},
+};
+
+static void
+rpc_bdev_nvme_set_multipath_policy(struct spdk_jsonrpc_request *request,
+				   const struct spdk_json_val *params)
+{
+	struct rpc_bdev_nvme_set_multipath_policy req = {};
+	enum nvme_bdev_mp_policy policy;
+	struct spdk_json_write_ctx *w;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_nvme_set_multipath_policy_decoders,
+				    SPDK_COUNTOF(rpc_bdev_nvme_set_multipath_policy_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	if (bdev_nvme_mp_policy_parse(&policy, req.policy) != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, -EINVAL, "Invalid policy: %s", req.policy);
+		goto cleanup;
+	}
+
+	rc = bdev_nvme_set_multipath_policy(req.name, policy);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		goto cleanup;
+	}
+
+	w = spdk_jsonrpc_begin_result(request);
+	spdk_json_write_bool(w, true);
+	spdk_jsonrpc_end_result(request, w);
+
+cleanup:
+	free_rpc_bdev_nvme_set_multipath_policy(&req);
+}
+SPDK_RPC_REGISTER("bdev_nvme_set_multipath_policy", rpc_bdev_nvme_set_multipath_policy,
+		  SPDK_RPC_RUNTIME)
+
+struct rpc_bdev_nvme_get_io_paths {
+	char *name;
+};
+
+static void
+free_rpc_bdev_nvme_get_io_paths(struct rpc_bdev_nvme_get_io_paths *req)
+{
+	free(req->name);
+}
+
+static const struct spdk_json_object_decoder rpc_bdev_nvme_get_io_paths_decoders[] = {
+	{"name", offsetof(struct rpc_bdev_nvme_get_io_paths, name), spdk_json_decode_string},
+};
+
+struct rpc_bdev_nvme_get_io_paths_ctx {
+	struct spdk_jsonrpc_request *request;
+	struct spdk_bdev_desc *desc;
+	struct spdk_bdev *bdev;
+};
+
+static void
+rpc_bdev_nvme_get_io_paths_event_cb(enum spdk_bdev_event_type type, struct spdk_bdev *bdev,
+				    void *event_ctx)
+{
+	/* The descriptor only keeps the bdev from being freed during the walk. */
+}
+
+static void
+rpc_bdev_nvme_get_io_paths_done(void *cb_arg, struct bdev_nvme_io_path_info *info,
+				uint32_t num_paths, int rc)
+{
+	struct rpc_bdev_nvme_get_io_paths_ctx *ctx = cb_arg;
+	struct nvme_bdev *nbdev = SPDK_CONTAINEROF(ctx->bdev, struct nvme_bdev, disk);
+	struct spdk_json_write_ctx *w;
+	uint32_t i;
+
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(ctx->request, rc, spdk_strerror(-rc));
+		spdk_bdev_close(ctx->desc);
+		free(ctx);
+		return;
+	}
+
+	w = spdk_jsonrpc_begin_result(ctx->request);
+	spdk_json_write_object_begin(w);
+	spdk_json_write_named_string(w, "name", spdk_bdev_get_name(ctx->bdev));
+	spdk_json_write_named_string(w, "policy", bdev_nvme_mp_policy_str(nbdev->mp_policy));
+
+	spdk_json_write_named_array_begin(w, "paths");
+	for (i = 0; i < num_paths; i++) {
+		spdk_json_write_object_begin(w);
+		spdk_json_write_named_object_begin(w, "trid");
+		nvme_bdev_dump_trid_json(&info[i].trid, w);
+		spdk_json_write_object_end(w);
+		spdk_json_write_named_string(w, "ana_state", bdev_nvme_ana_state_str(info[i].ana_state));
+		spdk_json_write_named_uint64(w, "outstanding", info[i].outstanding);
+		spdk_json_write_named_uint64(w, "num_read_ops", info[i].stat.num_read_ops);
+		spdk_json_write_named_uint64(w, "bytes_read", info[i].stat.bytes_read);
+		spdk_json_write_named_uint64(w, "num_write_ops", info[i].stat.num_write_ops);
+		spdk_json_write_named_uint64(w, "bytes_written", info[i].stat.bytes_written);
+		spdk_json_write_named_uint64(w, "num_other_ops", info[i].stat.num_other_ops);
+		spdk_json_write_named_uint64(w, "num_io_errors", info[i].stat.num_io_errors);
+		spdk_json_write_named_uint64(w, "num_retries", info[i].stat.num_retries);
+		spdk_json_write_object_end(w);
+	}
+	spdk_json_write_array_end(w);
+
+	spdk_json_write_object_end(w);
+	spdk_jsonrpc_end_result(ctx->request, w);
+	spdk_bdev_close(ctx->desc);
+	free(ctx);
+}
+
+static void
+rpc_bdev_nvme_get_io_paths(struct spdk_jsonrpc_request *request,
+			   const struct spdk_json_val *params)
+{
+	struct rpc_bdev_nvme_get_io_paths req = {};
+	struct rpc_bdev_nvme_get_io_paths_ctx *ctx;
+	int rc;
+
+	if (spdk_json_decode_object(params, rpc_bdev_nvme_get_io_paths_decoders,
+				    SPDK_COUNTOF(rpc_bdev_nvme_get_io_paths_decoders),
+				    &req)) {
+		SPDK_ERRLOG("spdk_json_decode_object failed\n");
+		spdk_jsonrpc_send_error_response(request, SPDK_JSONRPC_ERROR_INTERNAL_ERROR,
+						 "spdk_json_decode_object failed");
+		goto cleanup;
+	}
+
+	ctx = calloc(1, sizeof(*ctx));
+	if (ctx == NULL) {
+		spdk_jsonrpc_send_error_response(request, -ENOMEM, spdk_strerror(ENOMEM));
+		goto cleanup;
+	}
+	ctx->request = request;
+
+	/* Keep the bdev open until its channels have been walked. */
+	rc = spdk_bdev_open_ext(req.name, false, rpc_bdev_nvme_get_io_paths_event_cb, NULL,
+				&ctx->desc);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response_fmt(request, -ENODEV, "Bdev %s does not exist", req.name);
+		free(ctx);
+		goto cleanup;
+	}
+	ctx->bdev = spdk_bdev_desc_get_bdev(ctx->desc);
+
+	rc = bdev_nvme_get_io_paths(ctx->bdev, rpc_bdev_nvme_get_io_paths_done, ctx);
+	if (rc != 0) {
+		spdk_jsonrpc_send_error_response(request, rc, spdk_strerror(-rc));
+		spdk_bdev_close(ctx->desc);
+		free(ctx);
+	}
+
+cleanup:
+	free_rpc_bdev_nvme_get_io_paths(&req);
+}
+SPDK_RPC_REGISTER("bdev_nvme_get_io_paths", rpc_bdev_nvme_get_io_paths, SPDK_RPC_RUNTIME)
@@ -51,6 +51,15 @@ enum nvme_bdev_ns_type {
 	NVME_BDEV_NS_OCSSD	= 2,
 };
 
+enum nvme_bdev_mp_policy {
+	/** Rotate I/O across all usable paths. */
+	NVME_BDEV_MP_POLICY_ROUND_ROBIN	= 0,
+	/** Send I/O to the usable path with the fewest outstanding requests. */
+	NVME_BDEV_MP_POLICY_QUEUE_DEPTH	= 1,
+	/** Rotate I/O across ANA optimized paths, fall back to non-optimized ones. */
+	NVME_BDEV_MP_POLICY_ANA		= 2,
+};
+
 struct nvme_bdev_ns {
 	uint32_t		id;
 	enum nvme_bdev_ns_type	type;
@@ -64,6 +73,8 @@ struct nvme_bdev_ns {
 	struct spdk_nvme_ns	*ns;
 	struct nvme_bdev_ctrlr	*ctrlr;
 	TAILQ_HEAD(, nvme_bdev)	bdevs;
+	/** Multipath bdevs reaching this namespace, linked through nvme_bdev_path::ns_tailq */
+	TAILQ_HEAD(, nvme_bdev_path)	paths;
 	void			*type_ctx;
 };
 
@@ -87,6 +98,13 @@ struct nvme_bdev_ctrlr {
 	bool					resetting;
 	bool					failover_in_progress;
 	bool					destruct;
+	/**
+	 * Set when the controller was attached in multipath mode. Its namespaces
+	 * are then merged with the namespaces of the other controllers attached
+	 * under the same name instead of being exposed as separate bdevs.
+	 */
+	bool					multipath;
+	enum nvme_bdev_mp_policy		mp_policy;
 	/**
 	 * PI check flags. This flags is set to NVMe controllers created only
 	 * through bdev_nvme_attach_controller RPC or .INI config file. Hot added
@@ -111,10 +129,38 @@ struct nvme_bdev_ctrlr {
 	TAILQ_HEAD(, nvme_bdev_ctrlr_trid)	trids;
 };
 
+struct nvme_io_path_stat {
+	uint64_t	num_read_ops;
+	uint64_t	bytes_read;
+	uint64_t	num_write_ops;
+	uint64_t	bytes_written;
+	uint64_t	num_other_ops;
+	uint64_t	num_io_errors;
+	uint64_t	num_retries;
+};
+
+/* One namespace of one controller through which a multipath bdev can be reached. */
+struct nvme_bdev_path {
+	struct nvme_bdev_ns		*nvme_ns;
+	struct nvme_bdev		*nbdev;
+	/** Counters of per-channel paths that have already been released */
+	struct nvme_io_path_stat	stat;
+	TAILQ_ENTRY(nvme_bdev_path)	tailq;
+	TAILQ_ENTRY(nvme_bdev_path)	ns_tailq;
+};
+
 struct nvme_bdev {
 	struct spdk_bdev	disk;
+	/** Namespace owning the bdev. For multipath bdevs this is one of the paths. */
 	struct nvme_bdev_ns	*nvme_ns;
 	TAILQ_ENTRY(nvme_bdev)	tailq;
+
+	bool					multipath;
+	bool					destruct;
+	enum nvme_bdev_mp_policy		mp_policy;
+	/** Number of spdk_for_each_channel() walks over the bdev in progress */
+	uint32_t				channel_iters;
+	TAILQ_HEAD(, nvme_bdev_path)		paths;
 };
 
 struct nvme_bdev_poll_group {
@@ -128,18 +174,31 @@ struct nvme_bdev_poll_group {
 
 typedef void (*spdk_bdev_create_nvme_fn)(void *ctx, size_t bdev_count, int rc);
 
+/* Time spent in each stage of attaching a controller, filled in before the create callback */
+struct nvme_bdev_attach_timings {
+	/* Fabric connect and controller initialization */
+	uint64_t connect_us;
+	/* Namespace discovery and bdev registration */
+	uint64_t populate_us;
+};
+
 struct nvme_async_probe_ctx {
 	struct spdk_nvme_probe_ctx *probe_ctx;
+	struct spdk_nvme_ctrlr *ctrlr;
 	const char *base_name;
 	const char **names;
 	uint32_t count;
 	uint32_t prchk_flags;
+	bool multipath;
 	struct spdk_poller *poller;
 	struct spdk_nvme_transport_id trid;
 	struct spdk_nvme_ctrlr_opts opts;
 	spdk_bdev_create_nvme_fn cb_fn;
 	void *cb_ctx;
 	uint32_t populates_in_progress;
+	struct nvme_bdev_attach_timings *timings;
+	uint64_t start_tsc;
+	uint64_t attach_tsc;
 };
 
 struct ocssd_io_channel;
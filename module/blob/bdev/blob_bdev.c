@@ -392,9 +392,9 @@ spdk_bdev_create_bs_dev_from_desc(struct spdk_bdev_desc *desc)
 }
 
 
-int
-spdk_bdev_create_bs_dev_ext(const char *bdev_name, spdk_bdev_event_cb_t event_cb,
-			    void *event_ctx, struct spdk_bs_dev **_bs_dev)
+static int
+blob_bdev_create(const char *bdev_name, bool write, spdk_bdev_event_cb_t event_cb,
+		 void *event_ctx, struct spdk_bs_dev **_bs_dev)
 {
 	struct blob_bdev *b;
 	struct spdk_bdev_desc *desc;
@@ -407,7 +407,7 @@ spdk_bdev_create_bs_dev_ext(const char *bdev_name, spdk_bdev_event_cb_t event_cb
 		return -ENOMEM;
 	}
 
-	rc = spdk_bdev_open_ext(bdev_name, true, event_cb, event_ctx, &desc);
+	rc = spdk_bdev_open_ext(bdev_name, write, event_cb, event_ctx, &desc);
 	if (rc != 0) {
 		free(b);
 		return rc;
@@ -419,3 +419,17 @@ spdk_bdev_create_bs_dev_ext(const char *bdev_name, spdk_bdev_event_cb_t event_cb
 
 	return 0;
 }
+
+int
+spdk_bdev_create_bs_dev_ext(const char *bdev_name, spdk_bdev_event_cb_t event_cb,
+			    void *event_ctx, struct spdk_bs_dev **_bs_dev)
+{
+	return blob_bdev_create(bdev_name, true, event_cb, event_ctx, _bs_dev);
+}
+
+int
+spdk_bdev_create_bs_dev_ro(const char *bdev_name, spdk_bdev_event_cb_t event_cb,
+			   void *event_ctx, struct spdk_bs_dev **_bs_dev)
+{
+	return blob_bdev_create(bdev_name, false, event_cb, event_ctx, _bs_dev);
+}
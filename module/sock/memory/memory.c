@@ -0,0 +1,959 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation. All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+
+/*
+ * In-process socket implementation. Sockets are connected through memory
+ * channels instead of the kernel network stack, which makes it possible to
+ * measure the per-I/O cost of the layers above the socket (NVMe-oF, iSCSI)
+ * without the cost of TCP.
+ *
+ * Listeners are identified by an arbitrary name and port. Data written with
+ * spdk_sock_writev_async() on a socket that belongs to a sock group is handed
+ * to the peer by reference: the reader copies straight out of the writer's
+ * buffers and the write request completes once the data has been consumed.
+ * Synchronous writes, and writes on sockets outside of a sock group, are
+ * copied into a private buffer instead.
+ */
+
+#include "spdk/stdinc.h"
+
+#include "spdk/log.h"
+#include "spdk/sock.h"
+#include "spdk/util.h"
+#include "spdk/likely.h"
+#include "spdk_internal/sock.h"
+
+#define MEMORY_SOCK_NAME_LEN 256
+#define IOV_BATCH_SIZE 64
+
+struct spdk_memory_sock_desc {
+	/* Set while the data still lives in the writer's request buffers */
+	struct spdk_sock_request		*req;
+	struct iovec				*iovs;
+	int					iovcnt;
+	int					iovpos;
+	size_t					iov_offset;
+	/* Bytes not yet read */
+	size_t					len;
+	/* Private copy of the data, used when not handing off a request */
+	struct iovec				bounce;
+	void					*buf;
+	TAILQ_ENTRY(spdk_memory_sock_desc)	link;
+};
+
+/* One direction of a connection. Written by one end, read by the other. */
+struct spdk_memory_sock_chan {
+	pthread_spinlock_t			lock;
+	TAILQ_HEAD(, spdk_memory_sock_desc)	descs;
+	/* Handed off requests already read by the peer, completed by the writer */
+	TAILQ_HEAD(, spdk_memory_sock_desc)	completed;
+	uint32_t				num_completed;
+	size_t					bytes;
+	bool					writer_closed;
+	bool					reader_closed;
+};
+
+struct spdk_memory_sock_conn {
+	struct spdk_memory_sock_chan		chan[2];
+	int					ref;
+};
+
+struct spdk_memory_sock {
+	struct spdk_sock			base;
+	char					name[MEMORY_SOCK_NAME_LEN];
+	int					port;
+	int					peer_port;
+
+	struct spdk_memory_sock_conn		*conn;
+	struct spdk_memory_sock_chan		*tx;
+	struct spdk_memory_sock_chan		*rx;
+	TAILQ_HEAD(, spdk_memory_sock_desc)	free_descs;
+
+	/* Listening sockets only. Protected by g_memory_sock_mutex. */
+	bool					listener;
+	TAILQ_HEAD(, spdk_memory_sock)		accept_queue;
+	uint32_t				num_pending;
+
+	/* Either the global listener list or the accept queue of a listener */
+	TAILQ_ENTRY(spdk_memory_sock)		link;
+	/* Sock group membership, used to rotate the order of polling */
+	TAILQ_ENTRY(spdk_memory_sock)		group_link;
+};
+
+struct spdk_memory_sock_group_impl {
+	struct spdk_sock_group_impl		base;
+	TAILQ_HEAD(, spdk_memory_sock)		socks;
+};
+
+static TAILQ_HEAD(, spdk_memory_sock) g_memory_sock_listeners = TAILQ_HEAD_INITIALIZER(
+			g_memory_sock_listeners);
+static pthread_mutex_t g_memory_sock_mutex = PTHREAD_MUTEX_INITIALIZER;
+static int g_memory_sock_next_port = 1;
+
+#define __memory_sock(sock) (struct spdk_memory_sock *)sock
+#define __memory_group_impl(group) (struct spdk_memory_sock_group_impl *)group
+
+static int
+memory_sock_getaddr(struct spdk_sock *_sock, char *saddr, int slen, uint16_t *sport,
+		    char *caddr, int clen, uint16_t *cport)
+{
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+
+	assert(sock != NULL);
+
+	if (snprintf(saddr, slen, "%s", sock->name) >= slen) {
+		return -1;
+	}
+
+	if (sport) {
+		*sport = sock->port;
+	}
+
+	if (sock->listener) {
+		/* Listening sockets have no peer */
+		return -1;
+	}
+
+	if (snprintf(caddr, clen, "%s", sock->name) >= clen) {
+		return -1;
+	}
+
+	if (cport) {
+		*cport = sock->peer_port;
+	}
+
+	return 0;
+}
+
+static struct spdk_memory_sock *
+memory_sock_alloc(const char *name, int port)
+{
+	struct spdk_memory_sock *sock;
+
+	sock = calloc(1, sizeof(*sock));
+	if (sock == NULL) {
+		SPDK_ERRLOG("sock allocation failed\n");
+		return NULL;
+	}
+
+	snprintf(sock->name, sizeof(sock->name), "%s", name);
+	sock->port = port;
+	TAILQ_INIT(&sock->free_descs);
+	TAILQ_INIT(&sock->accept_queue);
+
+	return sock;
+}
+
+static void
+memory_sock_chan_init(struct spdk_memory_sock_chan *chan)
+{
+	pthread_spin_init(&chan->lock, PTHREAD_PROCESS_PRIVATE);
+	TAILQ_INIT(&chan->descs);
+	TAILQ_INIT(&chan->completed);
+}
+
+static void
+memory_sock_desc_free(struct spdk_memory_sock_desc *desc)
+{
+	free(desc->buf);
+	free(desc);
+}
+
+static void
+memory_sock_chan_fini(struct spdk_memory_sock_chan *chan)
+{
+	struct spdk_memory_sock_desc *desc;
+
+	while ((desc = TAILQ_FIRST(&chan->descs))) {
+		TAILQ_REMOVE(&chan->descs, desc, link);
+		memory_sock_desc_free(desc);
+	}
+
+	while ((desc = TAILQ_FIRST(&chan->completed))) {
+		TAILQ_REMOVE(&chan->completed, desc, link);
+		memory_sock_desc_free(desc);
+	}
+
+	pthread_spin_destroy(&chan->lock);
+}
+
+static struct spdk_sock *
+memory_sock_listen(const char *ip, int port, struct spdk_sock_opts *opts)
+{
+	struct spdk_memory_sock *sock;
+
+	if (ip == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_memory_sock_mutex);
+	TAILQ_FOREACH(sock, &g_memory_sock_listeners, link) {
+		if (sock->port == port && strcmp(sock->name, ip) == 0) {
+			SPDK_ERRLOG("Memory sock %s:%d is already listening\n", ip, port);
+			pthread_mutex_unlock(&g_memory_sock_mutex);
+			return NULL;
+		}
+	}
+
+	sock = memory_sock_alloc(ip, port);
+	if (sock == NULL) {
+		pthread_mutex_unlock(&g_memory_sock_mutex);
+		return NULL;
+	}
+
+	sock->listener = true;
+	TAILQ_INSERT_TAIL(&g_memory_sock_listeners, sock, link);
+	pthread_mutex_unlock(&g_memory_sock_mutex);
+
+	return &sock->base;
+}
+
+static struct spdk_sock *
+memory_sock_connect(const char *ip, int port, struct spdk_sock_opts *opts)
+{
+	struct spdk_memory_sock *listener, *client, *server;
+	struct spdk_memory_sock_conn *conn;
+
+	if (ip == NULL) {
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_memory_sock_mutex);
+	TAILQ_FOREACH(listener, &g_memory_sock_listeners, link) {
+		if (listener->port == port && strcmp(listener->name, ip) == 0) {
+			break;
+		}
+	}
+
+	if (listener == NULL) {
+		SPDK_ERRLOG("No memory sock is listening on %s:%d\n", ip, port);
+		pthread_mutex_unlock(&g_memory_sock_mutex);
+		return NULL;
+	}
+
+	conn = calloc(1, sizeof(*conn));
+	client = memory_sock_alloc(ip, g_memory_sock_next_port++);
+	server = memory_sock_alloc(ip, port);
+	if (conn == NULL || client == NULL || server == NULL) {
+		pthread_mutex_unlock(&g_memory_sock_mutex);
+		free(conn);
+		free(client);
+		free(server);
+		return NULL;
+	}
+
+	memory_sock_chan_init(&conn->chan[0]);
+	memory_sock_chan_init(&conn->chan[1]);
+	conn->ref = 2;
+
+	client->conn = conn;
+	client->tx = &conn->chan[0];
+	client->rx = &conn->chan[1];
+	client->peer_port = server->port;
+
+	server->conn = conn;
+	server->tx = &conn->chan[1];
+	server->rx = &conn->chan[0];
+	server->peer_port = client->port;
+
+	TAILQ_INSERT_TAIL(&listener->accept_queue, server, link);
+	__atomic_store_n(&listener->num_pending, listener->num_pending + 1, __ATOMIC_RELEASE);
+	pthread_mutex_unlock(&g_memory_sock_mutex);
+
+	return &client->base;
+}
+
+static struct spdk_sock *
+memory_sock_accept(struct spdk_sock *_sock)
+{
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+	struct spdk_memory_sock *new_sock;
+
+	assert(sock != NULL);
+
+	if (__atomic_load_n(&sock->num_pending, __ATOMIC_ACQUIRE) == 0) {
+		errno = EAGAIN;
+		return NULL;
+	}
+
+	pthread_mutex_lock(&g_memory_sock_mutex);
+	new_sock = TAILQ_FIRST(&sock->accept_queue);
+	if (new_sock != NULL) {
+		TAILQ_REMOVE(&sock->accept_queue, new_sock, link);
+		__atomic_store_n(&sock->num_pending, sock->num_pending - 1, __ATOMIC_RELEASE);
+	}
+	pthread_mutex_unlock(&g_memory_sock_mutex);
+
+	if (new_sock == NULL) {
+		errno = EAGAIN;
+		return NULL;
+	}
+
+	return &new_sock->base;
+}
+
+static void
+memory_sock_free(struct spdk_memory_sock *sock)
+{
+	struct spdk_memory_sock_conn *conn = sock->conn;
+	struct spdk_memory_sock_desc *desc, *tmp;
+
+	if (conn != NULL) {
+		/* Nothing can be written to us anymore */
+		pthread_spin_lock(&sock->rx->lock);
+		sock->rx->reader_closed = true;
+		/* Handed off requests that were never read still have to be completed
+		 * by the writer. Everything else can be dropped right away. */
+		TAILQ_FOREACH_SAFE(desc, &sock->rx->descs, link, tmp) {
+			TAILQ_REMOVE(&sock->rx->descs, desc, link);
+			if (desc->req) {
+				TAILQ_INSERT_TAIL(&sock->rx->completed, desc, link);
+				sock->rx->num_completed++;
+			} else {
+				memory_sock_desc_free(desc);
+			}
+		}
+		__atomic_store_n(&sock->rx->bytes, 0, __ATOMIC_RELEASE);
+		pthread_spin_unlock(&sock->rx->lock);
+
+		pthread_spin_lock(&sock->tx->lock);
+		__atomic_store_n(&sock->tx->writer_closed, true, __ATOMIC_RELEASE);
+		pthread_spin_unlock(&sock->tx->lock);
+
+		if (__atomic_sub_fetch(&conn->ref, 1, __ATOMIC_ACQ_REL) == 0) {
+			memory_sock_chan_fini(&conn->chan[0]);
+			memory_sock_chan_fini(&conn->chan[1]);
+			free(conn);
+		}
+	}
+
+	while ((desc = TAILQ_FIRST(&sock->free_descs))) {
+		TAILQ_REMOVE(&sock->free_descs, desc, link);
+		free(desc);
+	}
+
+	free(sock);
+}
+
+static int
+memory_sock_close(struct spdk_sock *_sock)
+{
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+	struct spdk_memory_sock *pending;
+
+	assert(TAILQ_EMPTY(&_sock->pending_reqs));
+
+	if (sock->listener) {
+		pthread_mutex_lock(&g_memory_sock_mutex);
+		TAILQ_REMOVE(&g_memory_sock_listeners, sock, link);
+		/* Connections that were never accepted are reset */
+		while ((pending = TAILQ_FIRST(&sock->accept_queue))) {
+			TAILQ_REMOVE(&sock->accept_queue, pending, link);
+			memory_sock_free(pending);
+		}
+		pthread_mutex_unlock(&g_memory_sock_mutex);
+	} else {
+		/* Requests are only handed off while in a sock group and removing
+		 * the sock from its group detached all of them. */
+		assert(sock->tx->num_completed == 0);
+	}
+
+	memory_sock_free(sock);
+
+	return 0;
+}
+
+/* Copy as much of the unread data of desc as fits into diov, starting at
+ * element *didx and offset *doff of the destination. */
+static size_t
+memory_sock_desc_copy(struct spdk_memory_sock_desc *desc, struct iovec *diov, int diovcnt,
+		      int *didx, size_t *doff)
+{
+	struct iovec *siov;
+	size_t copied = 0, len;
+
+	while (desc->iovpos < desc->iovcnt && *didx < diovcnt) {
+		siov = &desc->iovs[desc->iovpos];
+		len = spdk_min(siov->iov_len - desc->iov_offset, diov[*didx].iov_len - *doff);
+		memcpy((uint8_t *)diov[*didx].iov_base + *doff,
+		       (uint8_t *)siov->iov_base + desc->iov_offset, len);
+		copied += len;
+
+		desc->iov_offset += len;
+		if (desc->iov_offset == siov->iov_len) {
+			desc->iovpos++;
+			desc->iov_offset = 0;
+		}
+
+		*doff += len;
+		if (*doff == diov[*didx].iov_len) {
+			(*didx)++;
+			*doff = 0;
+		}
+	}
+
+	desc->len -= copied;
+
+	return copied;
+}
+
+static struct spdk_memory_sock_desc *
+memory_sock_desc_alloc_copy(struct iovec *iov, int iovcnt)
+{
+	struct spdk_memory_sock_desc *desc;
+	struct iovec src;
+	size_t len = 0, off = 0;
+	int i, idx = 0;
+
+	for (i = 0; i < iovcnt; i++) {
+		len += iov[i].iov_len;
+	}
+
+	desc = calloc(1, sizeof(*desc));
+	if (desc == NULL) {
+		return NULL;
+	}
+
+	desc->buf = malloc(spdk_max(len, 1));
+	if (desc->buf == NULL) {
+		free(desc);
+		return NULL;
+	}
+
+	/* Use a temporary descriptor over the source to do the gather */
+	src.iov_base = desc->buf;
+	src.iov_len = len;
+	desc->iovs = iov;
+	desc->iovcnt = iovcnt;
+	desc->len = len;
+	memory_sock_desc_copy(desc, &src, 1, &idx, &off);
+
+	desc->bounce = src;
+	desc->iovs = &desc->bounce;
+	desc->iovcnt = 1;
+	desc->iovpos = 0;
+	desc->iov_offset = 0;
+	desc->len = len;
+
+	return desc;
+}
+
+static ssize_t
+memory_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
+{
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+	struct spdk_memory_sock_chan *rx = sock->rx;
+	struct spdk_memory_sock_desc *desc;
+	size_t total = 0, doff = 0;
+	int didx = 0;
+	bool eof;
+
+	assert(rx != NULL);
+
+	pthread_spin_lock(&rx->lock);
+	while (didx < iovcnt && (desc = TAILQ_FIRST(&rx->descs)) != NULL) {
+		total += memory_sock_desc_copy(desc, iov, iovcnt, &didx, &doff);
+		if (desc->len != 0) {
+			break;
+		}
+
+		TAILQ_REMOVE(&rx->descs, desc, link);
+		if (desc->req) {
+			/* The writer completes the request on its own thread */
+			TAILQ_INSERT_TAIL(&rx->completed, desc, link);
+			__atomic_store_n(&rx->num_completed, rx->num_completed + 1, __ATOMIC_RELEASE);
+		} else {
+			memory_sock_desc_free(desc);
+		}
+	}
+	__atomic_store_n(&rx->bytes, rx->bytes - total, __ATOMIC_RELEASE);
+	eof = rx->writer_closed && TAILQ_EMPTY(&rx->descs);
+	pthread_spin_unlock(&rx->lock);
+
+	if (total == 0) {
+		if (eof) {
+			return 0;
+		}
+
+		errno = EAGAIN;
+		return -1;
+	}
+
+	return total;
+}
+
+static ssize_t
+memory_sock_recv(struct spdk_sock *sock, void *buf, size_t len)
+{
+	struct iovec iov[1];
+
+	iov[0].iov_base = buf;
+	iov[0].iov_len = len;
+
+	return memory_sock_readv(sock, iov, 1);
+}
+
+static int
+memory_sock_chan_append(struct spdk_memory_sock_chan *tx, struct spdk_memory_sock_desc *desc)
+{
+	pthread_spin_lock(&tx->lock);
+	if (tx->reader_closed) {
+		pthread_spin_unlock(&tx->lock);
+		errno = EPIPE;
+		return -1;
+	}
+
+	TAILQ_INSERT_TAIL(&tx->descs, desc, link);
+	__atomic_store_n(&tx->bytes, tx->bytes + desc->len, __ATOMIC_RELEASE);
+	pthread_spin_unlock(&tx->lock);
+
+	return 0;
+}
+
+static ssize_t
+memory_sock_writev(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
+{
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+	struct spdk_memory_sock_desc *desc;
+	ssize_t len;
+
+	assert(sock->tx != NULL);
+
+	desc = memory_sock_desc_alloc_copy(iov, iovcnt);
+	if (desc == NULL) {
+		errno = ENOMEM;
+		return -1;
+	}
+
+	len = desc->len;
+	if (memory_sock_chan_append(sock->tx, desc) != 0) {
+		memory_sock_desc_free(desc);
+		return -1;
+	}
+
+	return len;
+}
+
+/* Complete the handed off requests that the peer has finished reading.
+ * Data is read in order, so these are always at the head of pending_reqs. */
+static int
+memory_sock_complete_reqs(struct spdk_memory_sock *sock)
+{
+	struct spdk_memory_sock_chan *tx = sock->tx;
+	struct spdk_memory_sock_desc *desc;
+	struct spdk_sock_request *req;
+	int rc;
+
+	while (__atomic_load_n(&tx->num_completed, __ATOMIC_ACQUIRE) > 0) {
+		pthread_spin_lock(&tx->lock);
+		desc = TAILQ_FIRST(&tx->completed);
+		if (desc != NULL) {
+			TAILQ_REMOVE(&tx->completed, desc, link);
+			tx->num_completed--;
+		}
+		pthread_spin_unlock(&tx->lock);
+
+		if (desc == NULL) {
+			break;
+		}
+
+		req = desc->req;
+		assert(req == TAILQ_FIRST(&sock->base.pending_reqs));
+		TAILQ_INSERT_HEAD(&sock->free_descs, desc, link);
+
+		rc = spdk_sock_request_put(&sock->base, req, 0);
+		if (rc) {
+			return rc;
+		}
+	}
+
+	return 0;
+}
+
+static int
+_memory_sock_flush(struct spdk_sock *_sock)
+{
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+	struct spdk_memory_sock_chan *tx = sock->tx;
+	struct spdk_memory_sock_desc *desc;
+	struct spdk_sock_request *req;
+	int i, rc;
+
+	/* Can't flush from within a callback or we end up with recursive calls */
+	if (_sock->cb_cnt > 0) {
+		return 0;
+	}
+
+	rc = memory_sock_complete_reqs(sock);
+	if (rc) {
+		return rc;
+	}
+
+	if (TAILQ_EMPTY(&_sock->queued_reqs)) {
+		return 0;
+	}
+
+	if (_sock->group_impl == NULL) {
+		/* Without a sock group there is no poller to complete handed off
+		 * requests, so copy the data and complete the requests now. */
+		while ((req = TAILQ_FIRST(&_sock->queued_reqs))) {
+			desc = memory_sock_desc_alloc_copy(SPDK_SOCK_REQUEST_IOV(req, 0), req->iovcnt);
+			if (desc == NULL) {
+				return 0;
+			}
+
+			if (memory_sock_chan_append(tx, desc) != 0) {
+				memory_sock_desc_free(desc);
+				return -1;
+			}
+
+			spdk_sock_request_pend(_sock, req);
+			rc = spdk_sock_request_put(_sock, req, 0);
+			if (rc) {
+				break;
+			}
+		}
+
+		return 0;
+	}
+
+	pthread_spin_lock(&tx->lock);
+	if (tx->reader_closed) {
+		pthread_spin_unlock(&tx->lock);
+		/* The peer may have closed since the completions were processed
+		 * above. Complete what it returned before failing the rest. */
+		rc = memory_sock_complete_reqs(sock);
+		if (rc) {
+			return rc;
+		}
+		errno = EPIPE;
+		return -1;
+	}
+
+	while ((req = TAILQ_FIRST(&_sock->queued_reqs))) {
+		desc = TAILQ_FIRST(&sock->free_descs);
+		if (desc != NULL) {
+			TAILQ_REMOVE(&sock->free_descs, desc, link);
+			memset(desc, 0, sizeof(*desc));
+		} else {
+			desc = calloc(1, sizeof(*desc));
+			if (desc == NULL) {
+				break;
+			}
+		}
+
+		desc->req = req;
+		desc->iovs = SPDK_SOCK_REQUEST_IOV(req, 0);
+		desc->iovcnt = req->iovcnt;
+		for (i = 0; i < req->iovcnt; i++) {
+			desc->len += desc->iovs[i].iov_len;
+		}
+
+		spdk_sock_request_pend(_sock, req);
+		TAILQ_INSERT_TAIL(&tx->descs, desc, link);
+		__atomic_store_n(&tx->bytes, tx->bytes + desc->len, __ATOMIC_RELEASE);
+	}
+	pthread_spin_unlock(&tx->lock);
+
+	return 0;
+}
+
+static int
+memory_sock_flush(struct spdk_sock *sock)
+{
+	return _memory_sock_flush(sock);
+}
+
+static void
+memory_sock_writev_async(struct spdk_sock *sock, struct spdk_sock_request *req)
+{
+	int rc;
+
+	spdk_sock_request_queue(sock, req);
+
+	/* If there are a sufficient number queued, just flush them out immediately. */
+	if (sock->queued_iovcnt >= IOV_BATCH_SIZE) {
+		rc = _memory_sock_flush(sock);
+		if (rc) {
+			spdk_sock_abort_requests(sock);
+		}
+	}
+}
+
+static int
+memory_sock_set_recvlowat(struct spdk_sock *_sock, int nbytes)
+{
+	return 0;
+}
+
+static int
+memory_sock_set_recvbuf(struct spdk_sock *_sock, int sz)
+{
+	return 0;
+}
+
+static int
+memory_sock_set_sendbuf(struct spdk_sock *_sock, int sz)
+{
+	return 0;
+}
+
+static bool
+memory_sock_is_ipv6(struct spdk_sock *_sock)
+{
+	return false;
+}
+
+static bool
+memory_sock_is_ipv4(struct spdk_sock *_sock)
+{
+	/* Report IPv4 so that transports accept the connection's address family */
+	return true;
+}
+
+static bool
+memory_sock_is_connected(struct spdk_sock *_sock)
+{
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+
+	if (sock->listener) {
+		return false;
+	}
+
+	return !__atomic_load_n(&sock->rx->writer_closed, __ATOMIC_ACQUIRE);
+}
+
+static int
+memory_sock_get_placement_id(struct spdk_sock *_sock, int *placement_id)
+{
+	return -1;
+}
+
+static struct spdk_sock_group_impl *
+memory_sock_group_impl_create(void)
+{
+	struct spdk_memory_sock_group_impl *group_impl;
+
+	group_impl = calloc(1, sizeof(*group_impl));
+	if (group_impl == NULL) {
+		SPDK_ERRLOG("group_impl allocation failed\n");
+		return NULL;
+	}
+
+	TAILQ_INIT(&group_impl->socks);
+
+	return &group_impl->base;
+}
+
+static int
+memory_sock_group_impl_add_sock(struct spdk_sock_group_impl *_group, struct spdk_sock *_sock)
+{
+	struct spdk_memory_sock_group_impl *group = __memory_group_impl(_group);
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+
+	TAILQ_INSERT_TAIL(&group->socks, sock, group_link);
+
+	return 0;
+}
+
+/* Make the data of handed off requests independent of the writer's buffers, so
+ * that the requests can be completed while the peer still has them queued. */
+static void
+memory_sock_detach_reqs(struct spdk_memory_sock *sock)
+{
+	struct spdk_memory_sock_chan *tx = sock->tx;
+	struct spdk_memory_sock_desc *desc, *tmp;
+	struct spdk_sock_request *req;
+	struct iovec iov;
+	size_t off, len;
+	int idx;
+
+	pthread_spin_lock(&tx->lock);
+	TAILQ_FOREACH(desc, &tx->descs, link) {
+		if (desc->req == NULL) {
+			continue;
+		}
+
+		len = desc->len;
+		desc->buf = malloc(spdk_max(len, 1));
+		if (desc->buf == NULL) {
+			SPDK_ERRLOG("Failed to detach %zu bytes from sock %p, dropping data\n", len, sock);
+			len = 0;
+		} else {
+			iov.iov_base = desc->buf;
+			iov.iov_len = len;
+			idx = 0;
+			off = 0;
+			memory_sock_desc_copy(desc, &iov, 1, &idx, &off);
+		}
+
+		desc->req = NULL;
+		desc->bounce.iov_base = desc->buf;
+		desc->bounce.iov_len = len;
+		desc->iovs = &desc->bounce;
+		desc->iovcnt = 1;
+		desc->iovpos = 0;
+		desc->iov_offset = 0;
+		desc->len = len;
+	}
+
+	TAILQ_FOREACH_SAFE(desc, &tx->completed, link, tmp) {
+		TAILQ_REMOVE(&tx->completed, desc, link);
+		TAILQ_INSERT_HEAD(&sock->free_descs, desc, link);
+	}
+	tx->num_completed = 0;
+	pthread_spin_unlock(&tx->lock);
+
+	/* Everything that was handed off has now been sent */
+	while ((req = TAILQ_FIRST(&sock->base.pending_reqs))) {
+		if (spdk_sock_request_put(&sock->base, req, 0)) {
+			break;
+		}
+	}
+}
+
+static int
+memory_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group, struct spdk_sock *_sock)
+{
+	struct spdk_memory_sock_group_impl *group = __memory_group_impl(_group);
+	struct spdk_memory_sock *sock = __memory_sock(_sock);
+
+	TAILQ_REMOVE(&group->socks, sock, group_link);
+
+	if (!sock->listener) {
+		memory_sock_detach_reqs(sock);
+	}
+
+	spdk_sock_abort_requests(_sock);
+
+	return 0;
+}
+
+static bool
+memory_sock_readable(struct spdk_memory_sock *sock)
+{
+	if (sock->listener) {
+		return __atomic_load_n(&sock->num_pending, __ATOMIC_ACQUIRE) > 0;
+	}
+
+	return __atomic_load_n(&sock->rx->bytes, __ATOMIC_ACQUIRE) > 0 ||
+	       __atomic_load_n(&sock->rx->writer_closed, __ATOMIC_ACQUIRE);
+}
+
+static int
+memory_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
+			    struct spdk_sock **socks)
+{
+	struct spdk_memory_sock_group_impl *group = __memory_group_impl(_group);
+	struct spdk_sock *sock, *tmp;
+	struct spdk_memory_sock *msock, *mtmp;
+	int num_events, i, rc;
+
+	/* This must be a TAILQ_FOREACH_SAFE because while flushing,
+	 * a completion callback could remove the sock from the
+	 * group. */
+	TAILQ_FOREACH_SAFE(sock, &_group->socks, link, tmp) {
+		msock = __memory_sock(sock);
+		if (msock->listener) {
+			continue;
+		}
+
+		rc = _memory_sock_flush(sock);
+		if (rc) {
+			spdk_sock_abort_requests(sock);
+		}
+	}
+
+	num_events = 0;
+	TAILQ_FOREACH_SAFE(msock, &group->socks, group_link, mtmp) {
+		if (num_events == max_events) {
+			break;
+		}
+
+		if (memory_sock_readable(msock)) {
+			socks[num_events++] = &msock->base;
+		}
+	}
+
+	/* Cycle the list so that each time we poll things aren't
+	 * in the same order. */
+	for (i = 0; i < num_events; i++) {
+		msock = __memory_sock(socks[i]);
+
+		TAILQ_REMOVE(&group->socks, msock, group_link);
+		TAILQ_INSERT_TAIL(&group->socks, msock, group_link);
+	}
+
+	return num_events;
+}
+
+static int
+memory_sock_group_impl_close(struct spdk_sock_group_impl *_group)
+{
+	struct spdk_memory_sock_group_impl *group = __memory_group_impl(_group);
+
+	assert(TAILQ_EMPTY(&group->socks));
+	free(group);
+
+	return 0;
+}
+
+static struct spdk_net_impl g_memory_net_impl = {
+	.name		= "memory",
+	.getaddr	= memory_sock_getaddr,
+	.connect	= memory_sock_connect,
+	.listen		= memory_sock_listen,
+	.accept		= memory_sock_accept,
+	.close		= memory_sock_close,
+	.recv		= memory_sock_recv,
+	.readv		= memory_sock_readv,
+	.writev		= memory_sock_writev,
+	.writev_async	= memory_sock_writev_async,
+	.flush		= memory_sock_flush,
+	.set_recvlowat	= memory_sock_set_recvlowat,
+	.set_recvbuf	= memory_sock_set_recvbuf,
+	.set_sendbuf	= memory_sock_set_sendbuf,
+	.is_ipv6	= memory_sock_is_ipv6,
+	.is_ipv4	= memory_sock_is_ipv4,
+	.is_connected	= memory_sock_is_connected,
+	.get_placement_id	= memory_sock_get_placement_id,
+	.group_impl_create	= memory_sock_group_impl_create,
+	.group_impl_add_sock	= memory_sock_group_impl_add_sock,
+	.group_impl_remove_sock = memory_sock_group_impl_remove_sock,
+	.group_impl_poll	= memory_sock_group_impl_poll,
+	.group_impl_close	= memory_sock_group_impl_close,
+};
+
+/* Registered below the default priority, which makes it opt-in: it is only used
+ * when requested by name or set as the default implementation. */
+SPDK_NET_IMPL_REGISTER(memory, &g_memory_net_impl, DEFAULT_SOCK_PRIORITY - 1);
@@ -50,6 +50,8 @@
 #define MAX_TMPBUF 1024
 #define PORTNUMLEN 32
 #define IOV_BATCH_SIZE 64
+#define MAX_BUSY_POLL_QUEUES 8
+#define BUSY_POLL_BUDGET 64
 
 #if defined(SO_ZEROCOPY) && defined(MSG_ZEROCOPY)
 #define SPDK_ZEROCOPY
@@ -64,6 +66,7 @@ struct spdk_posix_sock {
 	struct spdk_pipe	*recv_pipe;
 	void			*recv_buf;
 	int			recv_buf_sz;
+	uint32_t		recv_hint;
 	bool			pending_recv;
 	bool			zcopy;
 	int			so_priority;
@@ -84,6 +87,7 @@ static struct spdk_sock_impl_opts g_spdk_posix_sock_impl_opts = {
 	.enable_zerocopy_send = false,
 	.enable_quickack = false,
 	.enable_placement_id = false,
+	.busy_poll_usec = 0,
 };
 
 static int
@@ -214,6 +218,7 @@ posix_sock_alloc_pipe(struct spdk_posix_sock *sock, int sz)
 		free(sock->recv_buf);
 		sock->recv_pipe = NULL;
 		sock->recv_buf = NULL;
+		sock->recv_hint = 0;
 		return 0;
 	} else if (sz < MIN_SOCK_PIPE_SIZE) {
 		SPDK_ERRLOG("The size of the pipe must be larger than %d\n", MIN_SOCK_PIPE_SIZE);
@@ -309,11 +314,33 @@ posix_sock_set_sendbuf(struct spdk_sock *_sock, int sz)
 	return 0;
 }
 
+static int
+posix_sock_set_recv_hint(struct spdk_sock *_sock, uint32_t hdr_len, uint32_t payload_len)
+{
+	struct spdk_posix_sock *sock = __posix_sock(_sock);
+	uint32_t buffered;
+
+	sock->recv_hint = 0;
+
+	/* Small payloads are cheaper to batch in the pipe than to receive on their own. */
+	if (sock->recv_pipe == NULL || payload_len < MIN_SOCK_PIPE_SIZE) {
+		return 0;
+	}
+
+	/* The hint counts from the caller's position, the limit from the fd's. */
+	buffered = spdk_pipe_reader_bytes_available(sock->recv_pipe);
+	if (hdr_len > buffered) {
+		sock->recv_hint = hdr_len - buffered;
+	}
+
+	return 0;
+}
+
 static struct spdk_posix_sock *
 posix_sock_alloc(int fd, bool enable_zero_copy)
 {
 	struct spdk_posix_sock *sock;
-#if defined(SPDK_ZEROCOPY) || defined(__linux__)
+#if defined(SPDK_ZEROCOPY) || defined(__linux__) || defined(SO_BUSY_POLL)
 	int flag;
 	int rc;
 #endif
@@ -329,14 +356,12 @@ posix_sock_alloc(int fd, bool enable_zero_copy)
 #if defined(SPDK_ZEROCOPY)
 	flag = 1;
 
-	if (!enable_zero_copy || !g_spdk_posix_sock_impl_opts.enable_zerocopy_send) {
-		return sock;
-	}
-
-	/* Try to turn on zero copy sends */
-	rc = setsockopt(sock->fd, SOL_SOCKET, SO_ZEROCOPY, &flag, sizeof(flag));
-	if (rc == 0) {
-		sock->zcopy = true;
+	if (enable_zero_copy && g_spdk_posix_sock_impl_opts.enable_zerocopy_send) {
+		/* Try to turn on zero copy sends */
+		rc = setsockopt(sock->fd, SOL_SOCKET, SO_ZEROCOPY, &flag, sizeof(flag));
+		if (rc == 0) {
+			sock->zcopy = true;
+		}
 	}
 #endif
 
@@ -351,6 +376,24 @@ posix_sock_alloc(int fd, bool enable_zero_copy)
 	}
 #endif
 
+#if defined(SO_BUSY_POLL)
+	flag = g_spdk_posix_sock_impl_opts.busy_poll_usec;
+
+	if (flag) {
+		rc = setsockopt(sock->fd, SOL_SOCKET, SO_BUSY_POLL, &flag, sizeof(flag));
+		if (rc != 0) {
+			SPDK_ERRLOG("busy poll was failed to set (errno=%d)\n", errno);
+		}
+#if defined(SO_PREFER_BUSY_POLL)
+		flag = 1;
+		rc = setsockopt(sock->fd, SOL_SOCKET, SO_PREFER_BUSY_POLL, &flag, sizeof(flag));
+		if (rc != 0) {
+			SPDK_ERRLOG("prefer busy poll was failed to set (errno=%d)\n", errno);
+		}
+#endif
+	}
+#endif
+
 	return sock;
 }
 
@@ -908,18 +951,35 @@ posix_sock_recv_from_pipe(struct spdk_posix_sock *sock, struct iovec *diov, int
 	return bytes;
 }
 
+static inline void
+posix_sock_consume_recv_hint(struct spdk_posix_sock *sock, ssize_t bytes)
+{
+	if (spdk_unlikely(sock->recv_hint != 0) && bytes > 0) {
+		sock->recv_hint -= spdk_min((uint32_t)bytes, sock->recv_hint);
+	}
+}
+
 static inline ssize_t
 posix_sock_read(struct spdk_posix_sock *sock)
 {
 	struct iovec iov[2];
 	int bytes;
+	uint32_t sz;
 	struct spdk_posix_sock_group_impl *group;
 
-	bytes = spdk_pipe_writer_get_buffer(sock->recv_pipe, sock->recv_buf_sz, iov);
+	/* Don't read past the end of a header announced by posix_sock_set_recv_hint(),
+	 * so that the payload behind it can be received directly by the caller. */
+	sz = sock->recv_buf_sz;
+	if (spdk_unlikely(sock->recv_hint != 0)) {
+		sz = spdk_min(sz, sock->recv_hint);
+	}
+
+	bytes = spdk_pipe_writer_get_buffer(sock->recv_pipe, sz, iov);
 
 	if (bytes > 0) {
 		bytes = readv(sock->fd, iov, 2);
 		if (bytes > 0) {
+			posix_sock_consume_recv_hint(sock, bytes);
 			spdk_pipe_writer_advance(sock->recv_pipe, bytes);
 			if (sock->base.group_impl) {
 				group = __posix_group_impl(sock->base.group_impl);
@@ -952,7 +1012,9 @@ posix_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		/* If the user is receiving a sufficiently large amount of data,
 		 * receive directly to their buffers. */
 		if (len >= MIN_SOCK_PIPE_SIZE) {
-			return readv(sock->fd, iov, iovcnt);
+			rc = readv(sock->fd, iov, iovcnt);
+			posix_sock_consume_recv_hint(sock, rc);
+			return rc;
 		}
 
 		/* Otherwise, do a big read into our pipe */
@@ -1143,6 +1205,20 @@ posix_sock_group_impl_create(void)
 	group_impl->fd = fd;
 	TAILQ_INIT(&group_impl->pending_recv);
 
+#if defined(EPIOCSPARAMS)
+	if (g_spdk_posix_sock_impl_opts.busy_poll_usec) {
+		struct epoll_params params = {};
+
+		/* Let epoll_wait() itself busy poll the NIC queue of the group */
+		params.busy_poll_usecs = g_spdk_posix_sock_impl_opts.busy_poll_usec;
+		params.busy_poll_budget = BUSY_POLL_BUDGET;
+		params.prefer_busy_poll = 1;
+		if (ioctl(fd, EPIOCSPARAMS, &params) != 0) {
+			SPDK_ERRLOG("epoll busy poll was failed to set (errno=%d)\n", errno);
+		}
+	}
+#endif
+
 	return &group_impl->base;
 }
 
@@ -1220,6 +1296,41 @@ posix_sock_group_impl_remove_sock(struct spdk_sock_group_impl *_group, struct sp
 	return rc;
 }
 
+/* Busy poll the NIC queues serving the sockets in this group. A MSG_PEEK recv on
+ * a socket with SO_BUSY_POLL set makes the kernel poll that socket's NAPI context
+ * directly, so only one socket per placement_id needs to be peeked. When placement
+ * ids are enabled the group usually owns a single NIC queue.
+ */
+static void
+posix_sock_group_busy_poll(struct spdk_sock_group_impl *_group)
+{
+	struct spdk_sock *sock;
+	struct spdk_posix_sock *psock;
+	int polled[MAX_BUSY_POLL_QUEUES];
+	int num_polled = 0, i;
+	uint8_t byte;
+
+	TAILQ_FOREACH(sock, &_group->socks, link) {
+		for (i = 0; i < num_polled; i++) {
+			if (polled[i] == sock->placement_id) {
+				break;
+			}
+		}
+
+		if (i < num_polled) {
+			continue;
+		}
+
+		psock = __posix_sock(sock);
+		recv(psock->fd, &byte, 1, MSG_PEEK);
+
+		polled[num_polled++] = sock->placement_id;
+		if (num_polled == MAX_BUSY_POLL_QUEUES) {
+			break;
+		}
+	}
+}
+
 static int
 posix_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 			   struct spdk_sock **socks)
@@ -1256,13 +1367,17 @@ posix_sock_group_impl_poll(struct spdk_sock_group_impl *_group, int max_events,
 	} else if (num_events == 0 && !TAILQ_EMPTY(&_group->socks)) {
 		uint8_t byte;
 
-		sock = TAILQ_FIRST(&_group->socks);
-		psock = __posix_sock(sock);
-		/* a recv is done here to busy poll the queue associated with
-		 * first socket in list and potentially reap incoming data.
-		 */
-		if (psock->so_priority) {
-			recv(psock->fd, &byte, 1, MSG_PEEK);
+		if (g_spdk_posix_sock_impl_opts.busy_poll_usec) {
+			posix_sock_group_busy_poll(_group);
+		} else {
+			sock = TAILQ_FIRST(&_group->socks);
+			psock = __posix_sock(sock);
+			/* a recv is done here to busy poll the queue associated with
+			 * first socket in list and potentially reap incoming data.
+			 */
+			if (psock->so_priority) {
+				recv(psock->fd, &byte, 1, MSG_PEEK);
+			}
 		}
 	}
 
@@ -1360,6 +1475,7 @@ posix_sock_impl_get_opts(struct spdk_sock_impl_opts *opts, size_t *len)
 	GET_FIELD(enable_zerocopy_send);
 	GET_FIELD(enable_quickack);
 	GET_FIELD(enable_placement_id);
+	GET_FIELD(busy_poll_usec);
 
 #undef GET_FIELD
 #undef FIELD_OK
@@ -1390,6 +1506,7 @@ posix_sock_impl_set_opts(const struct spdk_sock_impl_opts *opts, size_t len)
 	SET_FIELD(enable_zerocopy_send);
 	SET_FIELD(enable_quickack);
 	SET_FIELD(enable_placement_id);
+	SET_FIELD(busy_poll_usec);
 
 #undef SET_FIELD
 #undef FIELD_OK
@@ -1413,6 +1530,7 @@ static struct spdk_net_impl g_posix_net_impl = {
 	.set_recvlowat	= posix_sock_set_recvlowat,
 	.set_recvbuf	= posix_sock_set_recvbuf,
 	.set_sendbuf	= posix_sock_set_sendbuf,
+	.set_recv_hint	= posix_sock_set_recv_hint,
 	.is_ipv6	= posix_sock_is_ipv6,
 	.is_ipv4	= posix_sock_is_ipv4,
 	.is_connected	= posix_sock_is_connected,
@@ -85,6 +85,7 @@ struct spdk_uring_sock {
 	struct spdk_pipe			*recv_pipe;
 	void					*recv_buf;
 	int					recv_buf_sz;
+	uint32_t				recv_hint;
 	bool					pending_recv;
 	int					connection_status;
 	TAILQ_ENTRY(spdk_uring_sock)		link;
@@ -237,6 +238,7 @@ uring_sock_alloc_pipe(struct spdk_uring_sock *sock, int sz)
 		free(sock->recv_buf);
 		sock->recv_pipe = NULL;
 		sock->recv_buf = NULL;
+		sock->recv_hint = 0;
 		return 0;
 	} else if (sz < MIN_SOCK_PIPE_SIZE) {
 		SPDK_ERRLOG("The size of the pipe must be larger than %d\n", MIN_SOCK_PIPE_SIZE);
@@ -332,6 +334,28 @@ uring_sock_set_sendbuf(struct spdk_sock *_sock, int sz)
 	return 0;
 }
 
+static int
+uring_sock_set_recv_hint(struct spdk_sock *_sock, uint32_t hdr_len, uint32_t payload_len)
+{
+	struct spdk_uring_sock *sock = __uring_sock(_sock);
+	uint32_t buffered;
+
+	sock->recv_hint = 0;
+
+	/* Small payloads are cheaper to batch in the pipe than to receive on their own. */
+	if (sock->recv_pipe == NULL || payload_len < MIN_SOCK_PIPE_SIZE) {
+		return 0;
+	}
+
+	/* The hint counts from the caller's position, the limit from the fd's. */
+	buffered = spdk_pipe_reader_bytes_available(sock->recv_pipe);
+	if (hdr_len > buffered) {
+		sock->recv_hint = hdr_len - buffered;
+	}
+
+	return 0;
+}
+
 static struct spdk_uring_sock *
 uring_sock_alloc(int fd)
 {
@@ -639,18 +663,35 @@ uring_sock_recv_from_pipe(struct spdk_uring_sock *sock, struct iovec *diov, int
 	return bytes;
 }
 
+static inline void
+uring_sock_consume_recv_hint(struct spdk_uring_sock *sock, ssize_t bytes)
+{
+	if (spdk_unlikely(sock->recv_hint != 0) && bytes > 0) {
+		sock->recv_hint -= spdk_min((uint32_t)bytes, sock->recv_hint);
+	}
+}
+
 static inline ssize_t
 uring_sock_read(struct spdk_uring_sock *sock)
 {
 	struct iovec iov[2];
 	int bytes;
+	uint32_t sz;
 	struct spdk_uring_sock_group_impl *group;
 
-	bytes = spdk_pipe_writer_get_buffer(sock->recv_pipe, sock->recv_buf_sz, iov);
+	/* Don't read past the end of a header announced by uring_sock_set_recv_hint(),
+	 * so that the payload behind it can be received directly by the caller. */
+	sz = sock->recv_buf_sz;
+	if (spdk_unlikely(sock->recv_hint != 0)) {
+		sz = spdk_min(sz, sock->recv_hint);
+	}
+
+	bytes = spdk_pipe_writer_get_buffer(sock->recv_pipe, sz, iov);
 
 	if (bytes > 0) {
 		bytes = readv(sock->fd, iov, 2);
 		if (bytes > 0) {
+			uring_sock_consume_recv_hint(sock, bytes);
 			spdk_pipe_writer_advance(sock->recv_pipe, bytes);
 			if (sock->base.group_impl) {
 				group = __uring_group_impl(sock->base.group_impl);
@@ -683,7 +724,9 @@ uring_sock_readv(struct spdk_sock *_sock, struct iovec *iov, int iovcnt)
 		/* If the user is receiving a sufficiently large amount of data,
 		 * receive directly to their buffers. */
 		if (len >= MIN_SOCK_PIPE_SIZE) {
-			return readv(sock->fd, iov, iovcnt);
+			rc = readv(sock->fd, iov, iovcnt);
+			uring_sock_consume_recv_hint(sock, rc);
+			return rc;
 		}
 
 		/* Otherwise, do a big read into our pipe */
@@ -1395,6 +1438,7 @@ static struct spdk_net_impl g_uring_net_impl = {
 	.set_recvlowat	= uring_sock_set_recvlowat,
 	.set_recvbuf	= uring_sock_set_recvbuf,
 	.set_sendbuf	= uring_sock_set_sendbuf,
+	.set_recv_hint	= uring_sock_set_recv_hint,
 	.is_ipv6	= uring_sock_is_ipv6,
 	.is_ipv4	= uring_sock_is_ipv4,
 	.is_connected   = uring_sock_is_connected,
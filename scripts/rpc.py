@@ -476,7 +476,9 @@ if __name__ == "__main__":
                                                          hostaddr=args.hostaddr,
                                                          hostsvcid=args.hostsvcid,
                                                          prchk_reftag=args.prchk_reftag,
-                                                         prchk_guard=args.prchk_guard))
+                                                         prchk_guard=args.prchk_guard,
+                                                         multipath=args.multipath,
+                                                         mp_policy=args.mp_policy))
 
     p = subparsers.add_parser('bdev_nvme_attach_controller', aliases=['construct_nvme_bdev'],
                               help='Add bdevs with nvme backend')
@@ -501,8 +503,50 @@ if __name__ == "__main__":
                    help='Enable checking of PI reference tag for I/O processing.', action='store_true')
     p.add_argument('-g', '--prchk-guard',
                    help='Enable checking of PI guard for I/O processing.', action='store_true')
+    p.add_argument('-x', '--multipath',
+                   help='Use the controller as a failover path (default) or as an additional active path.',
+                   choices=['failover', 'multipath'])
+    p.add_argument('--mp-policy',
+                   help='Path selection policy of a multipath controller.',
+                   choices=['round_robin', 'queue_depth', 'ana'])
     p.set_defaults(func=bdev_nvme_attach_controller)
 
+    def bdev_nvme_attach_controllers(args):
+        print_json(rpc.bdev.bdev_nvme_attach_controllers(args.client,
+                                                         controllers=json.loads(args.controllers),
+                                                         max_concurrent=args.max_concurrent))
+
+    p = subparsers.add_parser('bdev_nvme_attach_controllers',
+                              help='Attach several NVMe controllers concurrently')
+    p.add_argument('-c', '--controllers', required=True,
+                   help="""JSON list of controllers, each with the parameters of bdev_nvme_attach_controller,
+                   e.g. '[{"name": "Nvme0", "trtype": "tcp", "traddr": "10.0.0.1", "adrfam": "ipv4",
+                   "trsvcid": "4420", "subnqn": "nqn.2016-06.io.spdk:cnode1"}]'""")
+    p.add_argument('-m', '--max-concurrent', type=int,
+                   help='Maximum number of controllers attached at the same time. Default: no limit')
+    p.set_defaults(func=bdev_nvme_attach_controllers)
+
+    def bdev_nvme_set_multipath_policy(args):
+        rpc.bdev.bdev_nvme_set_multipath_policy(args.client,
+                                                name=args.name,
+                                                policy=args.policy)
+
+    p = subparsers.add_parser('bdev_nvme_set_multipath_policy',
+                              help='Set the path selection policy of a multipath NVMe controller')
+    p.add_argument('-b', '--name', help='Name of the NVMe controller', required=True)
+    p.add_argument('-p', '--policy', help='Path selection policy',
+                   choices=['round_robin', 'queue_depth', 'ana'], required=True)
+    p.set_defaults(func=bdev_nvme_set_multipath_policy)
+
+    def bdev_nvme_get_io_paths(args):
+        print_dict(rpc.bdev.bdev_nvme_get_io_paths(args.client,
+                                                   name=args.name))
+
+    p = subparsers.add_parser('bdev_nvme_get_io_paths',
+                              help='Display the I/O paths of a multipath NVMe bdev')
+    p.add_argument('-b', '--name', help='Name of the NVMe bdev', required=True)
+    p.set_defaults(func=bdev_nvme_get_io_paths)
+
     def bdev_nvme_get_controllers(args):
         print_dict(rpc.nvme.bdev_nvme_get_controllers(args.client,
                                                       name=args.name))
@@ -1436,7 +1480,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                                      bdev_name=args.bdev_name,
                                                      lvs_name=args.lvs_name,
                                                      cluster_sz=args.cluster_sz,
-                                                     clear_method=args.clear_method))
+                                                     clear_method=args.clear_method,
+                                                     max_size=args.max_size))
 
     p = subparsers.add_parser('bdev_lvol_create_lvstore', aliases=['construct_lvol_store'],
                               help='Add logical volume store on base bdev')
@@ -1445,6 +1490,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-c', '--cluster-sz', help='size of cluster (in bytes)', type=int, required=False)
     p.add_argument('--clear-method', help="""Change clear method for data region.
         Available: none, unmap, write_zeroes""", required=False)
+    p.add_argument('-m', '--max-size', help='size (in bytes) the lvol store can later be grown to',
+                   type=int, required=False)
     p.set_defaults(func=bdev_lvol_create_lvstore)
 
     def bdev_lvol_rename_lvstore(args):
@@ -1500,6 +1547,21 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('clone_name', help='lvol clone name')
     p.set_defaults(func=bdev_lvol_clone)
 
+    def bdev_lvol_clone_bdev(args):
+        print_json(rpc.lvol.bdev_lvol_clone_bdev(args.client,
+                                                 bdev=args.bdev,
+                                                 clone_name=args.clone_name,
+                                                 uuid=args.uuid,
+                                                 lvs_name=args.lvs_name))
+
+    p = subparsers.add_parser('bdev_lvol_clone_bdev',
+                              help='Create a clone of a read-only bdev in an lvol store')
+    p.add_argument('-u', '--uuid', help='lvol store UUID', required=False)
+    p.add_argument('-l', '--lvs-name', help='lvol store name', required=False)
+    p.add_argument('bdev', help='bdev to use as the external snapshot')
+    p.add_argument('clone_name', help='lvol clone name')
+    p.set_defaults(func=bdev_lvol_clone_bdev)
+
     def bdev_lvol_rename(args):
         rpc.lvol.bdev_lvol_rename(args.client,
                                   old_name=args.old_name,
@@ -1529,6 +1591,93 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('name', help='lvol bdev name')
     p.set_defaults(func=bdev_lvol_decouple_parent)
 
+    def bdev_lvol_start_inflate(args):
+        rpc.lvol.bdev_lvol_start_inflate(args.client,
+                                         name=args.name,
+                                         decouple_parent=args.decouple_parent,
+                                         max_mbytes_per_sec=args.max_mbytes_per_sec,
+                                         max_inflight_clusters=args.max_inflight_clusters)
+
+    p = subparsers.add_parser('bdev_lvol_start_inflate',
+                              help='Start inflating or decoupling the parent of lvol in the background')
+    p.add_argument('name', help='lvol bdev name')
+    p.add_argument('-d', '--decouple-parent', action='store_true',
+                   help='Only decouple the parent instead of inflating')
+    p.add_argument('-r', '--max-mbytes-per-sec', type=int,
+                   help='Copy rate limit in MiB/s, 0 for unlimited')
+    p.add_argument('-q', '--max-inflight-clusters', type=int,
+                   help='Number of clusters copied at a time')
+    p.set_defaults(func=bdev_lvol_start_inflate)
+
+    def bdev_lvol_get_inflate_jobs(args):
+        print_dict(rpc.lvol.bdev_lvol_get_inflate_jobs(args.client,
+                                                       name=args.name))
+
+    p = subparsers.add_parser('bdev_lvol_get_inflate_jobs',
+                              help='Display background inflate jobs of lvols')
+    p.add_argument('-b', '--name', help='lvol bdev name', required=False)
+    p.set_defaults(func=bdev_lvol_get_inflate_jobs)
+
+    def bdev_lvol_pause_inflate(args):
+        rpc.lvol.bdev_lvol_pause_inflate(args.client,
+                                         name=args.name)
+
+    p = subparsers.add_parser('bdev_lvol_pause_inflate', help='Pause background inflate of lvol')
+    p.add_argument('name', help='lvol bdev name')
+    p.set_defaults(func=bdev_lvol_pause_inflate)
+
+    def bdev_lvol_resume_inflate(args):
+        rpc.lvol.bdev_lvol_resume_inflate(args.client,
+                                          name=args.name)
+
+    p = subparsers.add_parser('bdev_lvol_resume_inflate', help='Resume background inflate of lvol')
+    p.add_argument('name', help='lvol bdev name')
+    p.set_defaults(func=bdev_lvol_resume_inflate)
+
+    def bdev_lvol_cancel_inflate(args):
+        rpc.lvol.bdev_lvol_cancel_inflate(args.client,
+                                          name=args.name)
+
+    p = subparsers.add_parser('bdev_lvol_cancel_inflate', help='Cancel background inflate of lvol')
+    p.add_argument('name', help='lvol bdev name')
+    p.set_defaults(func=bdev_lvol_cancel_inflate)
+
+    def bdev_lvol_shallow_copy(args):
+        rpc.lvol.bdev_lvol_shallow_copy(args.client,
+                                        src_lvol_name=args.src_lvol_name,
+                                        dst_bdev_name=args.dst_bdev_name)
+
+    p = subparsers.add_parser('bdev_lvol_shallow_copy',
+                              help='Copy the clusters allocated in a read-only lvol to a bdev')
+    p.add_argument('src_lvol_name', help='read-only lvol bdev name')
+    p.add_argument('dst_bdev_name', help='bdev name to copy to')
+    p.set_defaults(func=bdev_lvol_shallow_copy)
+
+    def bdev_lvol_set_io_stat(args):
+        rpc.lvol.bdev_lvol_set_io_stat(args.client,
+                                       name=args.name,
+                                       enable=not args.disable,
+                                       heatmap_sample_rate=args.heatmap_sample_rate)
+
+    p = subparsers.add_parser('bdev_lvol_set_io_stat',
+                              help='Enable or disable I/O statistics of an lvol')
+    p.add_argument('name', help='lvol bdev name')
+    p.add_argument('-d', '--disable', help='disable the statistics', action='store_true')
+    p.add_argument('-s', '--heatmap-sample-rate', help='sample every Nth I/O into the cluster heatmap',
+                   type=int, required=False)
+    p.set_defaults(func=bdev_lvol_set_io_stat)
+
+    def bdev_lvol_get_io_stat(args):
+        print_dict(rpc.lvol.bdev_lvol_get_io_stat(args.client,
+                                                  name=args.name,
+                                                  heatmap=args.heatmap))
+
+    p = subparsers.add_parser('bdev_lvol_get_io_stat',
+                              help='Display I/O statistics of lvols')
+    p.add_argument('-b', '--name', help='lvol bdev name', required=False)
+    p.add_argument('-m', '--heatmap', help='include the cluster heatmap', action='store_true')
+    p.set_defaults(func=bdev_lvol_get_io_stat)
+
     def bdev_lvol_resize(args):
         rpc.lvol.bdev_lvol_resize(args.client,
                                   name=args.name,
@@ -1569,6 +1718,17 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-l', '--lvs-name', help='lvol store name', required=False)
     p.set_defaults(func=bdev_lvol_delete_lvstore)
 
+    def bdev_lvol_grow_lvstore(args):
+        print_json(rpc.lvol.bdev_lvol_grow_lvstore(args.client,
+                                                   uuid=args.uuid,
+                                                   lvs_name=args.lvs_name))
+
+    p = subparsers.add_parser('bdev_lvol_grow_lvstore',
+                              help='Grow a logical volume store to the size of its base bdev')
+    p.add_argument('-u', '--uuid', help='lvol store UUID', required=False)
+    p.add_argument('-l', '--lvs-name', help='lvol store name', required=False)
+    p.set_defaults(func=bdev_lvol_grow_lvstore)
+
     def bdev_lvol_get_lvstores(args):
         print_dict(rpc.lvol.bdev_lvol_get_lvstores(args.client,
                                                    uuid=args.uuid,
@@ -1816,7 +1976,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        acceptor_backlog=args.acceptor_backlog,
                                        abort_timeout_sec=args.abort_timeout_sec,
                                        no_wr_batching=args.no_wr_batching,
-                                       control_msg_num=args.control_msg_num)
+                                       control_msg_num=args.control_msg_num,
+                                       shared_req_num=args.shared_req_num)
 
     p = subparsers.add_parser('nvmf_create_transport', help='Create NVMf transport')
     p.add_argument('-t', '--trtype', help='Transport type (ex. RDMA)', type=str, required=True)
@@ -1841,6 +2002,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-w', '--no-wr-batching', action='store_true', help='Disable work requests batching. Relevant only for RDMA transport')
     p.add_argument('-e', '--control_msg_num', help="""The number of control messages per poll group.
     Relevant only for TCP transport""", type=int)
+    p.add_argument('-k', '--shared-req-num', help="""The number of in-capsule data buffers and PDUs shared by
+    the qpairs of each poll group. 0 gives each qpair its own. Relevant only for TCP transport""", type=int)
     p.set_defaults(func=nvmf_create_transport)
 
     def nvmf_get_transports(args):
@@ -2077,6 +2240,17 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
     p.add_argument('-t', '--tgt_name', help='The name of the parent NVMe-oF target (optional)', type=str)
     p.set_defaults(func=nvmf_get_stats)
 
+    def nvmf_get_io_stats(args):
+        print_dict(rpc.nvmf.nvmf_get_io_stats(args.client,
+                                              tgt_name=args.tgt_name,
+                                              nqn=args.nqn))
+
+    p = subparsers.add_parser(
+        'nvmf_get_io_stats', help='Display I/O statistics of each host and namespace of NVMf subsystems')
+    p.add_argument('-t', '--tgt_name', help='The name of the parent NVMe-oF target (optional)', type=str)
+    p.add_argument('-n', '--nqn', help='Only display the statistics of this subsystem NQN (optional)', type=str)
+    p.set_defaults(func=nvmf_get_io_stats)
+
     # pmem
     def bdev_pmem_create_pool(args):
         num_blocks = int((args.total_size * 1024 * 1024) / args.block_size)
@@ -2544,7 +2718,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                                        enable_recv_pipe=args.enable_recv_pipe,
                                        enable_zerocopy_send=args.enable_zerocopy_send,
                                        enable_quickack=args.enable_quickack,
-                                       enable_placement_id=args.enable_placement_id)
+                                       enable_placement_id=args.enable_placement_id,
+                                       busy_poll_usec=args.busy_poll_usec)
 
     p = subparsers.add_parser('sock_impl_set_options', help="""Set options of socket layer implementation""")
     p.add_argument('-i', '--impl', help='Socket implementation name, e.g. posix', required=True)
@@ -2566,6 +2741,8 @@ Format: 'user:u1 secret:s1 muser:mu1 msecret:ms1,user:u2 secret:s2 muser:mu2 mse
                    action='store_true', dest='enable_placement_id')
     p.add_argument('--disable-placement_id', help='Disable placement_id',
                    action='store_false', dest='enable_placement_id')
+    p.add_argument('--busy-poll-usec', help='Busy poll the NIC queue for this many microseconds (0 disables)',
+                   type=int)
     p.set_defaults(func=sock_impl_set_options, enable_recv_pipe=None, enable_zerocopy_send=None,
                    enable_quickack=None, enable_placement_id=None)
 
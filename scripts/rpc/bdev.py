@@ -458,7 +458,8 @@ def bdev_nvme_set_hotplug(client, enable, period_us=None):
 @deprecated_alias('construct_nvme_bdev')
 def bdev_nvme_attach_controller(client, name, trtype, traddr, adrfam=None, trsvcid=None,
                                 priority=None, subnqn=None, hostnqn=None, hostaddr=None,
-                                hostsvcid=None, prchk_reftag=None, prchk_guard=None):
+                                hostsvcid=None, prchk_reftag=None, prchk_guard=None,
+                                multipath=None, mp_policy=None):
     """Construct block device for each NVMe namespace in the attached controller.
 
     Args:
@@ -474,6 +475,8 @@ def bdev_nvme_attach_controller(client, name, trtype, traddr, adrfam=None, trsvc
         hostsvcid: host transport service ID (port number for IP-based transports, NULL for PCIe or FC; optional)
         prchk_reftag: Enable checking of PI reference tag for I/O processing (optional)
         prchk_guard: Enable checking of PI guard for I/O processing (optional)
+        multipath: "failover" (default) or "multipath" to use all paths of the name at once (optional)
+        mp_policy: path selection policy of a multipath controller: "round_robin", "queue_depth" or "ana" (optional)
 
     Returns:
         Names of created block devices.
@@ -509,9 +512,57 @@ def bdev_nvme_attach_controller(client, name, trtype, traddr, adrfam=None, trsvc
     if prchk_guard:
         params['prchk_guard'] = prchk_guard
 
+    if multipath:
+        params['multipath'] = multipath
+
+    if mp_policy:
+        params['mp_policy'] = mp_policy
+
     return client.call('bdev_nvme_attach_controller', params)
 
 
+def bdev_nvme_attach_controllers(client, controllers, max_concurrent=None):
+    """Attach several NVMe controllers at once, connecting and initializing them concurrently.
+
+    Args:
+        controllers: list of controllers, each with the parameters of bdev_nvme_attach_controller
+        max_concurrent: maximum number of controllers attached at the same time; 0 for no limit (optional)
+
+    Returns:
+        Result, bdev names and stage timings of each controller.
+    """
+    params = {'controllers': controllers}
+
+    if max_concurrent is not None:
+        params['max_concurrent'] = max_concurrent
+
+    return client.call('bdev_nvme_attach_controllers', params)
+
+
+def bdev_nvme_set_multipath_policy(client, name, policy):
+    """Set the path selection policy of a multipath NVMe controller.
+
+    Args:
+        name: name of the NVMe controller
+        policy: path selection policy: "round_robin", "queue_depth" or "ana"
+    """
+    params = {'name': name,
+              'policy': policy}
+
+    return client.call('bdev_nvme_set_multipath_policy', params)
+
+
+def bdev_nvme_get_io_paths(client, name):
+    """Get the I/O paths of a multipath NVMe bdev and their statistics.
+
+    Args:
+        name: name of the NVMe bdev
+    """
+    params = {'name': name}
+
+    return client.call('bdev_nvme_get_io_paths', params)
+
+
 @deprecated_alias('delete_nvme_controller')
 def bdev_nvme_detach_controller(client, name, trtype=None, traddr=None,
                                 adrfam=None, trsvcid=None, subnqn=None):
@@ -2,7 +2,8 @@ from .helpers import deprecated_alias
 
 
 @deprecated_alias('construct_lvol_store')
-def bdev_lvol_create_lvstore(client, bdev_name, lvs_name, cluster_sz=None, clear_method=None):
+def bdev_lvol_create_lvstore(client, bdev_name, lvs_name, cluster_sz=None, clear_method=None,
+                             max_size=None):
     """Construct a logical volume store.
 
     Args:
@@ -10,6 +11,7 @@ def bdev_lvol_create_lvstore(client, bdev_name, lvs_name, cluster_sz=None, clear
         lvs_name: name of the logical volume store to create
         cluster_sz: cluster size of the logical volume store in bytes (optional)
         clear_method: Change clear method for data region. Available: none, unmap, write_zeroes (optional)
+        max_size: size in bytes the logical volume store can later be grown to (optional)
 
     Returns:
         UUID of created logical volume store.
@@ -19,6 +21,8 @@ def bdev_lvol_create_lvstore(client, bdev_name, lvs_name, cluster_sz=None, clear
         params['cluster_sz'] = cluster_sz
     if clear_method:
         params['clear_method'] = clear_method
+    if max_size:
+        params['max_size'] = max_size
     return client.call('bdev_lvol_create_lvstore', params)
 
 
@@ -104,6 +108,34 @@ def bdev_lvol_clone(client, snapshot_name, clone_name):
     return client.call('bdev_lvol_clone', params)
 
 
+def bdev_lvol_clone_bdev(client, bdev, clone_name, uuid=None, lvs_name=None):
+    """Create a logical volume based on a read-only bdev.
+
+    Args:
+        bdev: name of the bdev to use as the external snapshot
+        clone_name: name of logical volume to create
+        uuid: UUID of logical volume store to create logical volume on (optional)
+        lvs_name: name of logical volume store to create logical volume on (optional)
+
+    Either uuid or lvs_name must be specified, but not both.
+
+    Returns:
+        Name of created logical volume clone.
+    """
+    if (uuid and lvs_name) or (not uuid and not lvs_name):
+        raise ValueError("Either uuid or lvs_name must be specified, but not both")
+
+    params = {
+        'bdev': bdev,
+        'clone_name': clone_name
+    }
+    if uuid:
+        params['uuid'] = uuid
+    if lvs_name:
+        params['lvs_name'] = lvs_name
+    return client.call('bdev_lvol_clone_bdev', params)
+
+
 @deprecated_alias('rename_lvol_bdev')
 def bdev_lvol_rename(client, old_name, new_name):
     """Rename a logical volume.
@@ -186,6 +218,117 @@ def bdev_lvol_decouple_parent(client, name):
     return client.call('bdev_lvol_decouple_parent', params)
 
 
+def bdev_lvol_start_inflate(client, name, decouple_parent=None, max_mbytes_per_sec=None,
+                            max_inflight_clusters=None):
+    """Start inflating or decoupling the parent of a logical volume in the background.
+
+    Args:
+        name: name of logical volume
+        decouple_parent: only decouple the parent instead of inflating (optional)
+        max_mbytes_per_sec: copy rate limit in MiB/s, 0 for unlimited (optional)
+        max_inflight_clusters: number of clusters copied at a time (optional)
+    """
+    params = {'name': name}
+    if decouple_parent:
+        params['decouple_parent'] = decouple_parent
+    if max_mbytes_per_sec is not None:
+        params['max_mbytes_per_sec'] = max_mbytes_per_sec
+    if max_inflight_clusters is not None:
+        params['max_inflight_clusters'] = max_inflight_clusters
+    return client.call('bdev_lvol_start_inflate', params)
+
+
+def bdev_lvol_get_inflate_jobs(client, name=None):
+    """List background inflate jobs of logical volumes.
+
+    Args:
+        name: name of logical volume (optional)
+
+    Returns:
+        List of inflate jobs.
+    """
+    params = {}
+    if name:
+        params['name'] = name
+    return client.call('bdev_lvol_get_inflate_jobs', params)
+
+
+def bdev_lvol_pause_inflate(client, name):
+    """Pause the background inflate job of a logical volume.
+
+    Args:
+        name: name of logical volume
+    """
+    params = {'name': name}
+    return client.call('bdev_lvol_pause_inflate', params)
+
+
+def bdev_lvol_resume_inflate(client, name):
+    """Resume the background inflate job of a logical volume.
+
+    Args:
+        name: name of logical volume
+    """
+    params = {'name': name}
+    return client.call('bdev_lvol_resume_inflate', params)
+
+
+def bdev_lvol_cancel_inflate(client, name):
+    """Cancel the background inflate job of a logical volume.
+
+    Args:
+        name: name of logical volume
+    """
+    params = {'name': name}
+    return client.call('bdev_lvol_cancel_inflate', params)
+
+
+def bdev_lvol_shallow_copy(client, src_lvol_name, dst_bdev_name):
+    """Copy the clusters allocated in a read-only logical volume to a bdev.
+
+    Args:
+        src_lvol_name: name of read-only logical volume to copy
+        dst_bdev_name: name of bdev to copy the clusters to
+    """
+    params = {
+        'src_lvol_name': src_lvol_name,
+        'dst_bdev_name': dst_bdev_name,
+    }
+    return client.call('bdev_lvol_shallow_copy', params)
+
+
+def bdev_lvol_set_io_stat(client, name, enable, heatmap_sample_rate=None):
+    """Enable or disable I/O statistics of a logical volume.
+
+    Args:
+        name: name of logical volume
+        enable: True to enable and reset the statistics, False to disable them
+        heatmap_sample_rate: sample every Nth I/O into the cluster heatmap (optional)
+    """
+    params = {'name': name, 'enable': enable}
+    if heatmap_sample_rate:
+        params['heatmap_sample_rate'] = heatmap_sample_rate
+    return client.call('bdev_lvol_set_io_stat', params)
+
+
+def bdev_lvol_get_io_stat(client, name=None, heatmap=None):
+    """Get I/O statistics of logical volumes.
+
+    Args:
+        name: name of logical volume (optional)
+        heatmap: include the sampled accesses of each cluster (optional)
+
+    Returns:
+        List of I/O statistics of logical volumes that have them enabled.
+    """
+    params = {}
+    if name:
+        params['name'] = name
+    if heatmap:
+        params['heatmap'] = heatmap
+    return client.call('bdev_lvol_get_io_stat', params)
+
+
 @deprecated_alias('destroy_lvol_store')
 def bdev_lvol_delete_lvstore(client, uuid=None, lvs_name=None):
     """Destroy a logical volume store.
@@ -207,6 +350,26 @@ def bdev_lvol_delete_lvstore(client, uuid=None, lvs_name=None):
     return client.call('bdev_lvol_delete_lvstore', params)
 
 
+def bdev_lvol_grow_lvstore(client, uuid=None, lvs_name=None):
+    """Grow a logical volume store to the current size of its base bdev.
+
+    Args:
+        uuid: UUID of logical volume store to grow (optional)
+        lvs_name: name of logical volume store to grow (optional)
+
+    Either uuid or lvs_name must be specified, but not both.
+    """
+    if (uuid and lvs_name) or (not uuid and not lvs_name):
+        raise ValueError("Exactly one of uuid or lvs_name must be specified")
+
+    params = {}
+    if uuid:
+        params['uuid'] = uuid
+    if lvs_name:
+        params['lvs_name'] = lvs_name
+    return client.call('bdev_lvol_grow_lvstore', params)
+
+
 @deprecated_alias('get_lvol_stores')
 def bdev_lvol_get_lvstores(client, uuid=None, lvs_name=None):
     """List logical volume stores.
@@ -111,7 +111,8 @@ def nvmf_create_transport(client,
                           acceptor_backlog=None,
                           abort_timeout_sec=None,
                           no_wr_batching=None,
-                          control_msg_num=None):
+                          control_msg_num=None,
+                          shared_req_num=None):
     """NVMf Transport Create options.
 
     Args:
@@ -133,6 +134,7 @@ def nvmf_create_transport(client,
         abort_timeout_sec: Abort execution timeout value, in seconds (optional)
         no_wr_batching: Boolean flag to disable work requests batching - RDMA specific (optional)
         control_msg_num: The number of control messages per poll group - TCP specific (optional)
+        shared_req_num: The number of in-capsule data buffers and PDUs shared by the qpairs of each poll group - TCP specific (optional)
     Returns:
         True or False
     """
@@ -178,6 +180,8 @@ def nvmf_create_transport(client,
         params['no_wr_batching'] = no_wr_batching
     if control_msg_num is not None:
         params['control_msg_num'] = control_msg_num
+    if shared_req_num is not None:
+        params['shared_req_num'] = shared_req_num
     return client.call('nvmf_create_transport', params)
 
 
@@ -608,3 +612,24 @@ def nvmf_get_stats(client, tgt_name=None):
         }
 
     return client.call('nvmf_get_stats', params)
+
+
+def nvmf_get_io_stats(client, tgt_name=None, nqn=None):
+    """Query the I/O statistics of each host and namespace.
+
+    Args:
+        tgt_name: name of the parent NVMe-oF target (optional).
+        nqn: only report the statistics of this subsystem (optional).
+
+    Returns:
+        I/O statistics of the NVMf subsystems.
+    """
+
+    params = {}
+
+    if tgt_name:
+        params['tgt_name'] = tgt_name
+    if nqn:
+        params['nqn'] = nqn
+
+    return client.call('nvmf_get_io_stats', params)
@@ -18,7 +18,8 @@ def sock_impl_set_options(client,
                           enable_recv_pipe=None,
                           enable_zerocopy_send=None,
                           enable_quickack=None,
-                          enable_placement_id=None):
+                          enable_placement_id=None,
+                          busy_poll_usec=None):
     """Set parameters for the socket layer implementation.
 
     Args:
@@ -29,6 +30,7 @@ def sock_impl_set_options(client,
         enable_zerocopy_send: enable or disable zerocopy on send (optional)
         enable_quickack: enable or disable quickack (optional)
         enable_placement_id: enable or disable placement_id (optional)
+        busy_poll_usec: busy poll the NIC queue for this many microseconds, 0 to disable (optional)
     """
     params = {}
 
@@ -45,6 +47,8 @@ def sock_impl_set_options(client,
         params['enable_quickack'] = enable_quickack
     if enable_placement_id is not None:
         params['enable_placement_id'] = enable_placement_id
+    if busy_poll_usec is not None:
+        params['busy_poll_usec'] = busy_poll_usec
 
     return client.call('sock_impl_set_options', params)
 
@@ -373,6 +373,88 @@ test_mem_map_translation(void)
 	CU_ASSERT(map == NULL);
 }
 
+static void
+test_mem_map_translation_cache(void)
+{
+	struct spdk_mem_map *map;
+	uint64_t default_translation = 0xDEADBEEF0BADF00D;
+	uint64_t addr, mapping_length;
+	int rc;
+
+	map = spdk_mem_map_alloc(default_translation, &test_mem_map_ops, NULL);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+
+	/* Two contiguous 2MB pages */
+	rc = spdk_mem_map_set_translation(map, 0, 2 * VALUE_2MB, 0);
+	CU_ASSERT(rc == 0);
+
+	mapping_length = 2 * VALUE_2MB;
+	addr = spdk_mem_map_translate(map, 0, &mapping_length);
+	CU_ASSERT(addr == 0);
+	CU_ASSERT(mapping_length == 2 * VALUE_2MB);
+
+	/* Served from the cached region */
+	mapping_length = VALUE_2MB;
+	addr = spdk_mem_map_translate(map, VALUE_4KB, &mapping_length);
+	CU_ASSERT(addr == 0);
+	CU_ASSERT(mapping_length == VALUE_2MB);
+
+	/* Changing a translation invalidates the cached region */
+	rc = spdk_mem_map_set_translation(map, VALUE_2MB, VALUE_2MB, 0x1234);
+	CU_ASSERT(rc == 0);
+
+	mapping_length = 2 * VALUE_2MB;
+	addr = spdk_mem_map_translate(map, 0, &mapping_length);
+	CU_ASSERT(addr == 0);
+	CU_ASSERT(mapping_length == VALUE_2MB);
+
+	mapping_length = VALUE_2MB;
+	addr = spdk_mem_map_translate(map, VALUE_4KB, &mapping_length);
+	CU_ASSERT(addr == 0);
+	CU_ASSERT(mapping_length == VALUE_2MB - VALUE_4KB);
+
+	rc = spdk_mem_map_clear_translation(map, 0, 2 * VALUE_2MB);
+	CU_ASSERT(rc == 0);
+
+	spdk_mem_map_free(&map);
+	CU_ASSERT(map == NULL);
+
+	/* Cache a region, then free the map without clearing it */
+	map = spdk_mem_map_alloc(default_translation, &test_mem_map_ops, NULL);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+
+	rc = spdk_mem_map_set_translation(map, 0, 2 * VALUE_2MB, 0);
+	CU_ASSERT(rc == 0);
+
+	mapping_length = 2 * VALUE_2MB;
+	addr = spdk_mem_map_translate(map, 0, &mapping_length);
+	CU_ASSERT(addr == 0);
+	CU_ASSERT(mapping_length == 2 * VALUE_2MB);
+
+	spdk_mem_map_free(&map);
+
+	/*
+	 * A new map, likely at the freed one's address, going through the same number of
+	 * updates must not be served the freed map's region.
+	 */
+	map = spdk_mem_map_alloc(default_translation, &test_mem_map_ops, NULL);
+	SPDK_CU_ASSERT_FATAL(map != NULL);
+
+	rc = spdk_mem_map_set_translation(map, 0, VALUE_2MB, 0);
+	CU_ASSERT(rc == 0);
+
+	mapping_length = 2 * VALUE_2MB;
+	addr = spdk_mem_map_translate(map, 0, &mapping_length);
+	CU_ASSERT(addr == 0);
+	CU_ASSERT(mapping_length == VALUE_2MB);
+
+	rc = spdk_mem_map_clear_translation(map, 0, VALUE_2MB);
+	CU_ASSERT(rc == 0);
+
+	spdk_mem_map_free(&map);
+	CU_ASSERT(map == NULL);
+}
+
 static void
 test_mem_map_registration(void)
 {
@@ -512,6 +594,7 @@ main(int argc, char **argv)
 	if (
 		CU_add_test(suite, "alloc and free memory map", test_mem_map_alloc_free) == NULL ||
 		CU_add_test(suite, "mem map translation", test_mem_map_translation) == NULL ||
+		CU_add_test(suite, "mem map translation cache", test_mem_map_translation_cache) == NULL ||
 		CU_add_test(suite, "mem map registration", test_mem_map_registration) == NULL ||
 		CU_add_test(suite, "mem map adjacent registrations", test_mem_map_registration_adjacent) == NULL
 	) {
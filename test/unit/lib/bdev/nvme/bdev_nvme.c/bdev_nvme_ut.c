@@ -0,0 +1,1392 @@
+/*-
+ *   BSD LICENSE
+ *
+ *   Copyright (c) Intel Corporation.
+ *   All rights reserved.
+ *
+ *   Redistribution and use in source and binary forms, with or without
+ *   modification, are permitted provided that the following conditions
+ *   are met:
+ *
+ *     * Redistributions of source code must retain the above copyright
+ *       notice, this list of conditions and the following disclaimer.
+ *     * Redistributions in binary form must reproduce the above copyright
+ *       notice, this list of conditions and the following disclaimer in
+ *       the documentation and/or other materials provided with the
+ *       distribution.
+ *     * Neither the name of Intel Corporation nor the names of its
+ *       contributors may be used to endorse or promote products derived
+ *       from this software without specific prior written permission.
+ *
+ *   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ *   "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ *   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ *   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ *   OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ *   SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ *   LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ *   DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ *   THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ *   (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ *   OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "spdk/stdinc.h"
+#include "spdk_cunit.h"
+#include "spdk/thread.h"
+#include "spdk/bdev_module.h"
+#include "spdk/util.h"
+
+#include "common/lib/ut_multithread.c"
+
+#include "bdev/nvme/bdev_nvme.c"
+#include "bdev/nvme/common.c"
+#include "bdev/nvme/bdev_nvme_rpc.c"
+
+#define UT_SUBNQN	"nqn.2016-06.io.spdk:cnode1"
+#define UT_MAX_BDEVS	8
+#define UT_MAX_RPC_RESPONSE	4096
+
+DEFINE_STUB_V(spdk_bdev_module_list_add, (struct spdk_bdev_module *bdev_module));
+DEFINE_STUB_V(spdk_bdev_module_finish_done, (void));
+DEFINE_STUB_V(spdk_bdev_destruct_done, (struct spdk_bdev *bdev, int bdeverrno));
+DEFINE_STUB(spdk_bdev_notify_blockcnt_change, int, (struct spdk_bdev *bdev, uint64_t size), 0);
+DEFINE_STUB_V(spdk_bdev_io_get_buf, (struct spdk_bdev_io *bdev_io, spdk_bdev_io_get_buf_cb cb,
+				     uint64_t len));
+
+DEFINE_STUB(spdk_bdev_open, int, (struct spdk_bdev *bdev, bool write,
+				  spdk_bdev_remove_cb_t remove_cb, void *remove_ctx, struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB(spdk_bdev_open_ext, int, (const char *bdev_name, bool write,
+				      spdk_bdev_event_cb_t event_cb, void *event_ctx, struct spdk_bdev_desc **desc), 0);
+DEFINE_STUB_V(spdk_bdev_close, (struct spdk_bdev_desc *desc));
+DEFINE_STUB(spdk_bdev_desc_get_bdev, struct spdk_bdev *, (struct spdk_bdev_desc *desc), NULL);
+DEFINE_STUB(spdk_bdev_get_io_channel, struct spdk_io_channel *, (struct spdk_bdev_desc *desc),
+	    NULL);
+DEFINE_STUB(spdk_bdev_first, struct spdk_bdev *, (void), NULL);
+DEFINE_STUB(spdk_bdev_next, struct spdk_bdev *, (struct spdk_bdev *prev), NULL);
+DEFINE_STUB(spdk_bdev_get_name, const char *, (const struct spdk_bdev *bdev), NULL);
+DEFINE_STUB_V(spdk_bdev_free_io, (struct spdk_bdev_io *bdev_io));
+DEFINE_STUB(spdk_bdev_nvme_admin_passthru, int, (struct spdk_bdev_desc *desc,
+		struct spdk_io_channel *ch, const struct spdk_nvme_cmd *cmd, void *buf, size_t nbytes,
+		spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+
+DEFINE_STUB_V(spdk_rpc_register_method, (const char *method, spdk_rpc_method_handler func,
+		uint32_t state_mask));
+DEFINE_STUB_V(spdk_rpc_register_alias_deprecated, (const char *method, const char *alias));
+
+DEFINE_STUB(spdk_opal_dev_construct, struct spdk_opal_dev *, (struct spdk_nvme_ctrlr *ctrlr), NULL);
+DEFINE_STUB_V(spdk_opal_dev_destruct, (struct spdk_opal_dev *dev));
+
+DEFINE_STUB_V(bdev_ocssd_populate_namespace, (struct nvme_bdev_ctrlr *nvme_bdev_ctrlr,
+		struct nvme_bdev_ns *nvme_ns, struct nvme_async_probe_ctx *ctx));
+DEFINE_STUB_V(bdev_ocssd_depopulate_namespace, (struct nvme_bdev_ns *ns));
+DEFINE_STUB_V(bdev_ocssd_namespace_config_json, (struct spdk_json_write_ctx *w,
+		struct nvme_bdev_ns *ns));
+DEFINE_STUB(bdev_ocssd_create_io_channel, int, (struct nvme_io_channel *ioch), 0);
+DEFINE_STUB_V(bdev_ocssd_destroy_io_channel, (struct nvme_io_channel *ioch));
+DEFINE_STUB(bdev_ocssd_init_ctrlr, int, (struct nvme_bdev_ctrlr *nvme_bdev_ctrlr), 0);
+DEFINE_STUB_V(bdev_ocssd_fini_ctrlr, (struct nvme_bdev_ctrlr *nvme_bdev_ctrlr));
+DEFINE_STUB_V(bdev_ocssd_handle_chunk_notification, (struct nvme_bdev_ctrlr *nvme_bdev_ctrlr));
+
+DEFINE_STUB(spdk_nvme_ctrlr_is_ocssd_supported, bool, (struct spdk_nvme_ctrlr *ctrlr), false);
+DEFINE_STUB(spdk_nvme_ctrlr_get_flags, uint64_t, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB_V(spdk_nvme_ctrlr_register_aer_callback, (struct spdk_nvme_ctrlr *ctrlr,
+		spdk_nvme_aer_cb aer_cb_fn, void *aer_cb_arg));
+DEFINE_STUB_V(spdk_nvme_ctrlr_register_timeout_callback, (struct spdk_nvme_ctrlr *ctrlr,
+		uint64_t timeout_us, spdk_nvme_timeout_cb cb_fn, void *cb_arg));
+DEFINE_STUB(spdk_nvme_ctrlr_process_admin_completions, int32_t, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB_V(spdk_nvme_ctrlr_get_default_ctrlr_opts, (struct spdk_nvme_ctrlr_opts *opts,
+		size_t opts_size));
+DEFINE_STUB_V(spdk_nvme_ctrlr_get_default_io_qpair_opts, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_io_qpair_opts *opts, size_t opts_size));
+DEFINE_STUB(spdk_nvme_ctrlr_connect_io_qpair, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_reconnect_io_qpair, int, (struct spdk_nvme_qpair *qpair), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_reset, int, (struct spdk_nvme_ctrlr *ctrlr), 0);
+DEFINE_STUB_V(spdk_nvme_ctrlr_fail, (struct spdk_nvme_ctrlr *ctrlr));
+DEFINE_STUB(spdk_nvme_ctrlr_set_trid, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_transport_id *trid), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_get_regs_csts, union spdk_nvme_csts_register,
+	    (struct spdk_nvme_ctrlr *ctrlr), {});
+DEFINE_STUB(spdk_nvme_ctrlr_get_regs_vs, union spdk_nvme_vs_register,
+	    (struct spdk_nvme_ctrlr *ctrlr), {});
+DEFINE_STUB(spdk_nvme_ctrlr_get_max_xfer_size, uint32_t, (const struct spdk_nvme_ctrlr *ctrlr),
+	    UINT32_MAX);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_abort, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair, uint16_t cid, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_abort_ext, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair, void *cmd_cb_arg, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_admin_raw, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_cmd *cmd, void *buf, uint32_t len, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_io_raw, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair, struct spdk_nvme_cmd *cmd, void *buf, uint32_t len,
+		spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_ctrlr_cmd_io_raw_with_md, int, (struct spdk_nvme_ctrlr *ctrlr,
+		struct spdk_nvme_qpair *qpair, struct spdk_nvme_cmd *cmd, void *buf, uint32_t len,
+		void *md_buf, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+DEFINE_STUB(spdk_nvme_connect, struct spdk_nvme_ctrlr *, (const struct spdk_nvme_transport_id *trid,
+		const struct spdk_nvme_ctrlr_opts *opts, size_t opts_size), NULL);
+DEFINE_STUB(spdk_nvme_probe_async, struct spdk_nvme_probe_ctx *,
+	    (const struct spdk_nvme_transport_id *trid, void *cb_ctx, spdk_nvme_probe_cb probe_cb,
+	     spdk_nvme_attach_cb attach_cb, spdk_nvme_remove_cb remove_cb), NULL);
+DEFINE_STUB_V(spdk_nvme_trid_populate_transport, (struct spdk_nvme_transport_id *trid,
+		enum spdk_nvme_transport_type trtype));
+DEFINE_STUB(spdk_nvme_cuse_get_ns_name, int, (struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid,
+		char *name, size_t *size), -ENODEV);
+DEFINE_STUB(spdk_nvme_transport_id_trtype_str, const char *, (enum spdk_nvme_transport_type trtype),
+	    NULL);
+DEFINE_STUB(spdk_nvme_transport_id_parse_adrfam, int, (enum spdk_nvmf_adrfam *adrfam,
+		const char *str), 0);
+DEFINE_STUB(spdk_nvme_transport_id_adrfam_str, const char *, (enum spdk_nvmf_adrfam adrfam), NULL);
+DEFINE_STUB(spdk_nvme_poll_group_process_completions, int64_t, (struct spdk_nvme_poll_group *group,
+		uint32_t completions_per_qpair, spdk_nvme_disconnected_qpair_cb disconnected_qpair_cb), 0);
+
+DEFINE_STUB(spdk_nvme_ns_get_md_size, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_pi_type, enum spdk_nvme_pi_type, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_optimal_io_boundary, uint32_t, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_get_uuid, const struct spdk_uuid *, (const struct spdk_nvme_ns *ns), NULL);
+DEFINE_STUB(spdk_nvme_ns_supports_compare, bool, (struct spdk_nvme_ns *ns), false);
+DEFINE_STUB(spdk_nvme_ns_get_dealloc_logical_block_read_value,
+	    enum spdk_nvme_dealloc_logical_block_read_value, (struct spdk_nvme_ns *ns), 0);
+DEFINE_STUB(spdk_nvme_ns_cmd_comparev_with_md, int, (struct spdk_nvme_ns *ns,
+		struct spdk_nvme_qpair *qpair, uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn,
+		void *cb_arg, uint32_t io_flags, spdk_nvme_req_reset_sgl_cb reset_sgl_fn,
+		spdk_nvme_req_next_sge_cb next_sge_fn, void *metadata, uint16_t apptag_mask,
+		uint16_t apptag), 0);
+DEFINE_STUB(spdk_nvme_ns_cmd_dataset_management, int, (struct spdk_nvme_ns *ns,
+		struct spdk_nvme_qpair *qpair, uint32_t type, const struct spdk_nvme_dsm_range *ranges,
+		uint16_t num_ranges, spdk_nvme_cmd_cb cb_fn, void *cb_arg), 0);
+
+struct ut_nvme_req {
+	spdk_nvme_cmd_cb		cb_fn;
+	void				*cb_arg;
+	struct spdk_nvme_cpl		cpl;
+	TAILQ_ENTRY(ut_nvme_req)	tailq;
+};
+
+struct spdk_nvme_ns {
+	uint32_t			id;
+	struct spdk_nvme_ns_data	data;
+	enum spdk_nvme_ana_state	ana_state;
+};
+
+struct spdk_nvme_qpair {
+	struct spdk_nvme_ctrlr		*ctrlr;
+	struct spdk_nvme_poll_group	*poll_group;
+	TAILQ_HEAD(, ut_nvme_req)	outstanding_reqs;
+	uint32_t			num_outstanding_reqs;
+};
+
+struct spdk_nvme_ctrlr {
+	struct spdk_nvme_transport_id	trid;
+	struct spdk_nvme_ctrlr_data	cdata;
+	struct spdk_nvme_ctrlr_opts	opts;
+	uint32_t			num_ns;
+	struct spdk_nvme_ns		*ns;
+	/* Fail the initialization instead of attaching the controller */
+	bool				fail_init;
+	TAILQ_ENTRY(spdk_nvme_ctrlr)	tailq;
+};
+
+struct spdk_nvme_probe_ctx {
+	struct spdk_nvme_transport_id	trid;
+	void				*cb_ctx;
+	spdk_nvme_attach_cb		attach_cb;
+};
+
+struct spdk_nvme_poll_group {
+	void				*ctx;
+};
+
+struct ut_attach_ctx {
+	const char			*names[UT_MAX_BDEVS];
+	size_t				bdev_count;
+	int				rc;
+	bool				done;
+};
+
+/* Only the address of the request is used, the RPC layer is faked below. */
+static struct spdk_jsonrpc_request *g_ut_rpc_request = (struct spdk_jsonrpc_request *)0xDEADBEEF;
+static char g_ut_rpc_response[UT_MAX_RPC_RESPONSE];
+static size_t g_ut_rpc_response_len;
+static int g_ut_rpc_error_code;
+static bool g_ut_rpc_done;
+
+static TAILQ_HEAD(, spdk_nvme_ctrlr) g_ut_init_ctrlrs = TAILQ_HEAD_INITIALIZER(g_ut_init_ctrlrs);
+static TAILQ_HEAD(, spdk_nvme_ctrlr) g_ut_attached_ctrlrs = TAILQ_HEAD_INITIALIZER(
+			g_ut_attached_ctrlrs);
+static TAILQ_HEAD(, spdk_bdev) g_ut_bdevs = TAILQ_HEAD_INITIALIZER(g_ut_bdevs);
+static uint32_t g_ut_num_probe_ctxs;
+
+static void
+ut_init_trid(struct spdk_nvme_transport_id *trid, const char *traddr)
+{
+	memset(trid, 0, sizeof(*trid));
+	trid->trtype = SPDK_NVME_TRANSPORT_TCP;
+	snprintf(trid->trstring, sizeof(trid->trstring), "TCP");
+	trid->adrfam = SPDK_NVMF_ADRFAM_IPV4;
+	snprintf(trid->traddr, sizeof(trid->traddr), "%s", traddr);
+	snprintf(trid->trsvcid, sizeof(trid->trsvcid), "4420");
+	snprintf(trid->subnqn, sizeof(trid->subnqn), "%s", UT_SUBNQN);
+}
+
+/* Adds a controller that can be attached through the transport ID of the given address. */
+static struct spdk_nvme_ctrlr *
+ut_add_ctrlr(const char *traddr, uint32_t num_ns)
+{
+	struct spdk_nvme_ctrlr *ctrlr;
+	uint32_t i;
+
+	ctrlr = calloc(1, sizeof(*ctrlr));
+	SPDK_CU_ASSERT_FATAL(ctrlr != NULL);
+
+	ctrlr->ns = calloc(num_ns, sizeof(*ctrlr->ns));
+	SPDK_CU_ASSERT_FATAL(ctrlr->ns != NULL);
+
+	ut_init_trid(&ctrlr->trid, traddr);
+	ctrlr->num_ns = num_ns;
+	for (i = 0; i < num_ns; i++) {
+		ctrlr->ns[i].id = i + 1;
+		ctrlr->ns[i].ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+		/* The same namespace is reachable through all the controllers. */
+		ctrlr->ns[i].data.nguid[0] = i + 1;
+		ctrlr->ns[i].data.nsze = 1024;
+	}
+
+	TAILQ_INSERT_TAIL(&g_ut_init_ctrlrs, ctrlr, tailq);
+
+	return ctrlr;
+}
+
+static void
+ut_free_ctrlr(struct spdk_nvme_ctrlr *ctrlr)
+{
+	free(ctrlr->ns);
+	free(ctrlr);
+}
+
+/* Removes a controller that was never attached. */
+static void
+ut_remove_ctrlr(struct spdk_nvme_ctrlr *ctrlr)
+{
+	TAILQ_REMOVE(&g_ut_init_ctrlrs, ctrlr, tailq);
+	ut_free_ctrlr(ctrlr);
+}
+
+static struct spdk_nvme_ctrlr *
+ut_find_ctrlr(const struct spdk_nvme_transport_id *trid)
+{
+	struct spdk_nvme_ctrlr *ctrlr;
+
+	TAILQ_FOREACH(ctrlr, &g_ut_init_ctrlrs, tailq) {
+		if (spdk_nvme_transport_id_compare(&ctrlr->trid, trid) == 0) {
+			return ctrlr;
+		}
+	}
+
+	return NULL;
+}
+
+static bool
+ut_ctrlr_is_attached(struct spdk_nvme_ctrlr *ctrlr)
+{
+	struct spdk_nvme_ctrlr *tmp;
+
+	TAILQ_FOREACH(tmp, &g_ut_attached_ctrlrs, tailq) {
+		if (tmp == ctrlr) {
+			return true;
+		}
+	}
+
+	return false;
+}
+
+int
+spdk_nvme_transport_id_compare(const struct spdk_nvme_transport_id *trid1,
+			       const struct spdk_nvme_transport_id *trid2)
+{
+	int cmp;
+
+	cmp = (int)trid1->trtype - (int)trid2->trtype;
+	if (cmp) {
+		return cmp;
+	}
+
+	cmp = strcasecmp(trid1->traddr, trid2->traddr);
+	if (cmp) {
+		return cmp;
+	}
+
+	cmp = strcasecmp(trid1->trsvcid, trid2->trsvcid);
+	if (cmp) {
+		return cmp;
+	}
+
+	return strcmp(trid1->subnqn, trid2->subnqn);
+}
+
+int
+spdk_nvme_transport_id_parse_trtype(enum spdk_nvme_transport_type *trtype, const char *str)
+{
+	if (strcasecmp(str, "tcp") == 0) {
+		*trtype = SPDK_NVME_TRANSPORT_TCP;
+	} else if (strcasecmp(str, "rdma") == 0) {
+		*trtype = SPDK_NVME_TRANSPORT_RDMA;
+	} else if (strcasecmp(str, "pcie") == 0) {
+		*trtype = SPDK_NVME_TRANSPORT_PCIE;
+	} else {
+		return -ENOENT;
+	}
+
+	return 0;
+}
+
+int
+spdk_nvme_transport_id_populate_trstring(struct spdk_nvme_transport_id *trid,
+		const char *trstring)
+{
+	enum spdk_nvme_transport_type trtype;
+	size_t i;
+
+	if (spdk_nvme_transport_id_parse_trtype(&trtype, trstring) != 0) {
+		return -EINVAL;
+	}
+
+	for (i = 0; trstring[i] != '\0' && i < SPDK_NVMF_TRSTRING_MAX_LEN; i++) {
+		trid->trstring[i] = toupper(trstring[i]);
+	}
+	trid->trstring[i] = '\0';
+
+	return 0;
+}
+
+struct spdk_nvme_probe_ctx *
+spdk_nvme_connect_async(const struct spdk_nvme_transport_id *trid,
+			const struct spdk_nvme_ctrlr_opts *opts,
+			spdk_nvme_attach_cb attach_cb)
+{
+	struct spdk_nvme_probe_ctx *probe_ctx;
+
+	if (ut_find_ctrlr(trid) == NULL) {
+		return NULL;
+	}
+
+	probe_ctx = calloc(1, sizeof(*probe_ctx));
+	SPDK_CU_ASSERT_FATAL(probe_ctx != NULL);
+
+	probe_ctx->trid = *trid;
+	probe_ctx->cb_ctx = (void *)opts;
+	probe_ctx->attach_cb = attach_cb;
+	g_ut_num_probe_ctxs++;
+
+	return probe_ctx;
+}
+
+int
+spdk_nvme_probe_poll_async(struct spdk_nvme_probe_ctx *probe_ctx)
+{
+	struct spdk_nvme_ctrlr *ctrlr;
+	int rc = -EIO;
+
+	ctrlr = ut_find_ctrlr(&probe_ctx->trid);
+	if (ctrlr != NULL && !ctrlr->fail_init) {
+		TAILQ_REMOVE(&g_ut_init_ctrlrs, ctrlr, tailq);
+		TAILQ_INSERT_TAIL(&g_ut_attached_ctrlrs, ctrlr, tailq);
+		probe_ctx->attach_cb(probe_ctx->cb_ctx, &ctrlr->trid, ctrlr, &ctrlr->opts);
+		rc = 0;
+	}
+
+	free(probe_ctx);
+	g_ut_num_probe_ctxs--;
+
+	return rc;
+}
+
+int
+spdk_nvme_detach(struct spdk_nvme_ctrlr *ctrlr)
+{
+	CU_ASSERT(ut_ctrlr_is_attached(ctrlr));
+	TAILQ_REMOVE(&g_ut_attached_ctrlrs, ctrlr, tailq);
+	ut_free_ctrlr(ctrlr);
+
+	return 0;
+}
+
+const struct spdk_nvme_ctrlr_data *
+spdk_nvme_ctrlr_get_data(struct spdk_nvme_ctrlr *ctrlr)
+{
+	return &ctrlr->cdata;
+}
+
+uint32_t
+spdk_nvme_ctrlr_get_num_ns(struct spdk_nvme_ctrlr *ctrlr)
+{
+	return ctrlr->num_ns;
+}
+
+bool
+spdk_nvme_ctrlr_is_active_ns(struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid)
+{
+	return nsid >= 1 && nsid <= ctrlr->num_ns;
+}
+
+struct spdk_nvme_ns *
+spdk_nvme_ctrlr_get_ns(struct spdk_nvme_ctrlr *ctrlr, uint32_t nsid)
+{
+	if (!spdk_nvme_ctrlr_is_active_ns(ctrlr, nsid)) {
+		return NULL;
+	}
+
+	return &ctrlr->ns[nsid - 1];
+}
+
+uint32_t
+spdk_nvme_ns_get_id(struct spdk_nvme_ns *ns)
+{
+	return ns->id;
+}
+
+const struct spdk_nvme_ns_data *
+spdk_nvme_ns_get_data(struct spdk_nvme_ns *ns)
+{
+	return &ns->data;
+}
+
+uint32_t
+spdk_nvme_ns_get_extended_sector_size(struct spdk_nvme_ns *ns)
+{
+	return 512;
+}
+
+uint64_t
+spdk_nvme_ns_get_num_sectors(struct spdk_nvme_ns *ns)
+{
+	return ns->data.nsze;
+}
+
+enum spdk_nvme_ana_state
+spdk_nvme_ns_get_ana_state(const struct spdk_nvme_ns *ns)
+{
+	return ns->ana_state;
+}
+
+struct spdk_nvme_qpair *
+spdk_nvme_ctrlr_alloc_io_qpair(struct spdk_nvme_ctrlr *ctrlr,
+			       const struct spdk_nvme_io_qpair_opts *opts,
+			       size_t opts_size)
+{
+	struct spdk_nvme_qpair *qpair;
+
+	qpair = calloc(1, sizeof(*qpair));
+	SPDK_CU_ASSERT_FATAL(qpair != NULL);
+
+	qpair->ctrlr = ctrlr;
+	TAILQ_INIT(&qpair->outstanding_reqs);
+
+	return qpair;
+}
+
+int
+spdk_nvme_ctrlr_free_io_qpair(struct spdk_nvme_qpair *qpair)
+{
+	if (qpair == NULL) {
+		return 0;
+	}
+
+	CU_ASSERT(qpair->num_outstanding_reqs == 0);
+	CU_ASSERT(qpair->poll_group == NULL);
+	free(qpair);
+
+	return 0;
+}
+
+struct spdk_nvme_poll_group *
+spdk_nvme_poll_group_create(void *ctx)
+{
+	struct spdk_nvme_poll_group *group;
+
+	group = calloc(1, sizeof(*group));
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	group->ctx = ctx;
+
+	return group;
+}
+
+int
+spdk_nvme_poll_group_destroy(struct spdk_nvme_poll_group *group)
+{
+	free(group);
+
+	return 0;
+}
+
+int
+spdk_nvme_poll_group_add(struct spdk_nvme_poll_group *group, struct spdk_nvme_qpair *qpair)
+{
+	CU_ASSERT(qpair->poll_group == NULL);
+	qpair->poll_group = group;
+
+	return 0;
+}
+
+int
+spdk_nvme_poll_group_remove(struct spdk_nvme_poll_group *group, struct spdk_nvme_qpair *qpair)
+{
+	CU_ASSERT(qpair->poll_group == group);
+	qpair->poll_group = NULL;
+
+	return 0;
+}
+
+static int
+ut_submit_nvme_request(struct spdk_nvme_qpair *qpair, spdk_nvme_cmd_cb cb_fn, void *cb_arg)
+{
+	struct ut_nvme_req *req;
+
+	req = calloc(1, sizeof(*req));
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+
+	req->cb_fn = cb_fn;
+	req->cb_arg = cb_arg;
+
+	TAILQ_INSERT_TAIL(&qpair->outstanding_reqs, req, tailq);
+	qpair->num_outstanding_reqs++;
+
+	return 0;
+}
+
+/* Completes the oldest request of the qpair with the given status. */
+static void
+ut_complete_nvme_request(struct spdk_nvme_qpair *qpair, int sct, int sc)
+{
+	struct ut_nvme_req *req;
+
+	req = TAILQ_FIRST(&qpair->outstanding_reqs);
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+
+	TAILQ_REMOVE(&qpair->outstanding_reqs, req, tailq);
+	qpair->num_outstanding_reqs--;
+
+	req->cpl.status.sct = sct;
+	req->cpl.status.sc = sc;
+	req->cb_fn(req->cb_arg, &req->cpl);
+
+	free(req);
+}
+
+int
+spdk_nvme_ns_cmd_read_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			      void *payload, void *metadata, uint64_t lba, uint32_t lba_count,
+			      spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+			      uint16_t apptag_mask, uint16_t apptag)
+{
+	return ut_submit_nvme_request(qpair, cb_fn, cb_arg);
+}
+
+int
+spdk_nvme_ns_cmd_readv_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			       uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn,
+			       void *cb_arg, uint32_t io_flags,
+			       spdk_nvme_req_reset_sgl_cb reset_sgl_fn,
+			       spdk_nvme_req_next_sge_cb next_sge_fn, void *metadata,
+			       uint16_t apptag_mask, uint16_t apptag)
+{
+	return ut_submit_nvme_request(qpair, cb_fn, cb_arg);
+}
+
+int
+spdk_nvme_ns_cmd_write_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+			       void *payload, void *metadata, uint64_t lba, uint32_t lba_count,
+			       spdk_nvme_cmd_cb cb_fn, void *cb_arg, uint32_t io_flags,
+			       uint16_t apptag_mask, uint16_t apptag)
+{
+	return ut_submit_nvme_request(qpair, cb_fn, cb_arg);
+}
+
+int
+spdk_nvme_ns_cmd_writev_with_md(struct spdk_nvme_ns *ns, struct spdk_nvme_qpair *qpair,
+				uint64_t lba, uint32_t lba_count, spdk_nvme_cmd_cb cb_fn,
+				void *cb_arg, uint32_t io_flags,
+				spdk_nvme_req_reset_sgl_cb reset_sgl_fn,
+				spdk_nvme_req_next_sge_cb next_sge_fn, void *metadata,
+				uint16_t apptag_mask, uint16_t apptag)
+{
+	return ut_submit_nvme_request(qpair, cb_fn, cb_arg);
+}
+
+struct spdk_bdev *
+spdk_bdev_get_by_name(const char *bdev_name)
+{
+	struct spdk_bdev *bdev;
+
+	TAILQ_FOREACH(bdev, &g_ut_bdevs, internal.link) {
+		if (strcmp(bdev->name, bdev_name) == 0) {
+			return bdev;
+		}
+	}
+
+	return NULL;
+}
+
+int
+spdk_bdev_register(struct spdk_bdev *bdev)
+{
+	CU_ASSERT_PTR_NULL(spdk_bdev_get_by_name(bdev->name));
+	TAILQ_INSERT_TAIL(&g_ut_bdevs, bdev, internal.link);
+
+	return 0;
+}
+
+void
+spdk_bdev_unregister(struct spdk_bdev *bdev, spdk_bdev_unregister_cb cb_fn, void *cb_arg)
+{
+	int rc;
+
+	CU_ASSERT_EQUAL(spdk_bdev_get_by_name(bdev->name), bdev);
+	TAILQ_REMOVE(&g_ut_bdevs, bdev, internal.link);
+
+	rc = bdev->fn_table->destruct(bdev->ctxt);
+	if (rc <= 0 && cb_fn != NULL) {
+		cb_fn(cb_arg, rc);
+	}
+}
+
+struct spdk_io_channel *
+spdk_bdev_io_get_io_channel(struct spdk_bdev_io *bdev_io)
+{
+	return (struct spdk_io_channel *)bdev_io->internal.ch;
+}
+
+void
+spdk_bdev_io_complete(struct spdk_bdev_io *bdev_io, enum spdk_bdev_io_status status)
+{
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	bdev_io->internal.status = status;
+}
+
+void
+spdk_bdev_io_complete_nvme_status(struct spdk_bdev_io *bdev_io, uint32_t cdw0, int sct, int sc)
+{
+	bdev_io->internal.error.nvme.cdw0 = cdw0;
+	bdev_io->internal.error.nvme.sct = sct;
+	bdev_io->internal.error.nvme.sc = sc;
+
+	if (sct == SPDK_NVME_SCT_GENERIC && sc == SPDK_NVME_SC_SUCCESS) {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_SUCCESS);
+	} else {
+		spdk_bdev_io_complete(bdev_io, SPDK_BDEV_IO_STATUS_NVME_ERROR);
+	}
+}
+
+static int
+ut_rpc_write_cb(void *cb_ctx, const void *data, size_t size)
+{
+	SPDK_CU_ASSERT_FATAL(g_ut_rpc_response_len + size < sizeof(g_ut_rpc_response));
+	memcpy(g_ut_rpc_response + g_ut_rpc_response_len, data, size);
+	g_ut_rpc_response_len += size;
+
+	return 0;
+}
+
+struct spdk_json_write_ctx *
+spdk_jsonrpc_begin_result(struct spdk_jsonrpc_request *request)
+{
+	CU_ASSERT(request == g_ut_rpc_request);
+	CU_ASSERT(g_ut_rpc_done == false);
+
+	return spdk_json_write_begin(ut_rpc_write_cb, NULL, 0);
+}
+
+void
+spdk_jsonrpc_end_result(struct spdk_jsonrpc_request *request, struct spdk_json_write_ctx *w)
+{
+	CU_ASSERT(request == g_ut_rpc_request);
+	CU_ASSERT(spdk_json_write_end(w) == 0);
+	g_ut_rpc_done = true;
+}
+
+void
+spdk_jsonrpc_send_error_response(struct spdk_jsonrpc_request *request, int error_code,
+				 const char *msg)
+{
+	CU_ASSERT(request == g_ut_rpc_request);
+	CU_ASSERT(g_ut_rpc_done == false);
+	g_ut_rpc_error_code = error_code;
+	g_ut_rpc_done = true;
+}
+
+void
+spdk_jsonrpc_send_error_response_fmt(struct spdk_jsonrpc_request *request, int error_code,
+				     const char *fmt, ...)
+{
+	spdk_jsonrpc_send_error_response(request, error_code, fmt);
+}
+
+/* Calls the RPC handler with the given parameters, the response is collected by the fakes above. */
+static void
+ut_rpc_call(spdk_rpc_method_handler fn, const char *params)
+{
+	struct spdk_json_val values[128];
+	char *json;
+	ssize_t rc;
+
+	memset(g_ut_rpc_response, 0, sizeof(g_ut_rpc_response));
+	g_ut_rpc_response_len = 0;
+	g_ut_rpc_error_code = 0;
+	g_ut_rpc_done = false;
+
+	json = strdup(params);
+	SPDK_CU_ASSERT_FATAL(json != NULL);
+
+	rc = spdk_json_parse(json, strlen(json), values, SPDK_COUNTOF(values), NULL,
+			     SPDK_JSON_PARSE_FLAG_DECODE_IN_PLACE);
+	SPDK_CU_ASSERT_FATAL(rc > 0);
+
+	fn(g_ut_rpc_request, values);
+
+	free(json);
+}
+
+static struct spdk_bdev_io *
+ut_alloc_bdev_io(enum spdk_bdev_io_type type, struct nvme_bdev *nbdev, struct spdk_io_channel *ch)
+{
+	struct spdk_bdev_io *bdev_io;
+
+	bdev_io = calloc(1, sizeof(struct spdk_bdev_io) + sizeof(struct nvme_bdev_io));
+	SPDK_CU_ASSERT_FATAL(bdev_io != NULL);
+
+	bdev_io->type = type;
+	bdev_io->bdev = &nbdev->disk;
+	bdev_io->internal.ch = (struct spdk_bdev_channel *)ch;
+	bdev_io->internal.status = SPDK_BDEV_IO_STATUS_PENDING;
+	bdev_io->iov.iov_base = (void *)0xFEEDBEEF;
+	bdev_io->iov.iov_len = 512;
+	bdev_io->u.bdev.iovs = &bdev_io->iov;
+	bdev_io->u.bdev.iovcnt = 1;
+	bdev_io->u.bdev.num_blocks = 1;
+
+	return bdev_io;
+}
+
+static struct nvme_io_path *
+ut_get_bdev_io_path(struct spdk_bdev_io *bdev_io)
+{
+	return ((struct nvme_bdev_io *)bdev_io->driver_ctx)->io_path;
+}
+
+static struct nvme_io_path *
+ut_get_io_path(struct nvme_bdev_channel *nbdev_ch, struct spdk_nvme_ctrlr *ctrlr)
+{
+	struct nvme_io_path *io_path;
+
+	TAILQ_FOREACH(io_path, &nbdev_ch->io_paths, tailq) {
+		if (io_path->nvme_ns->ctrlr->ctrlr == ctrlr) {
+			return io_path;
+		}
+	}
+
+	return NULL;
+}
+
+static struct nvme_bdev *
+ut_get_nbdev(const char *name)
+{
+	struct spdk_bdev *bdev;
+
+	bdev = spdk_bdev_get_by_name(name);
+	if (bdev == NULL) {
+		return NULL;
+	}
+
+	return SPDK_CONTAINEROF(bdev, struct nvme_bdev, disk);
+}
+
+static void
+ut_attach_done(void *cb_ctx, size_t bdev_count, int rc)
+{
+	struct ut_attach_ctx *ctx = cb_ctx;
+
+	ctx->bdev_count = bdev_count;
+	ctx->rc = rc;
+	ctx->done = true;
+}
+
+/* Starts attaching the controller, the attach completes once the probe poller ran. */
+static int
+ut_attach_ctrlr(struct spdk_nvme_ctrlr *ctrlr, const char *name, bool multipath,
+		struct ut_attach_ctx *ctx)
+{
+	struct spdk_nvme_host_id hostid = {};
+
+	memset(ctx, 0, sizeof(*ctx));
+
+	return bdev_nvme_create(&ctrlr->trid, &hostid, name, ctx->names, UT_MAX_BDEVS, NULL, 0,
+				multipath, NULL, ut_attach_done, ctx);
+}
+
+static void
+ut_poll_attach(void)
+{
+	spdk_delay_us(1000);
+	poll_threads();
+}
+
+/* Attaches two controllers as the paths of the multipath bdev nvme0n1. */
+static struct nvme_bdev *
+ut_attach_multipath(struct spdk_nvme_ctrlr **ctrlr1, struct spdk_nvme_ctrlr **ctrlr2)
+{
+	struct ut_attach_ctx ctx;
+	struct nvme_bdev *nbdev;
+	int rc;
+
+	*ctrlr1 = ut_add_ctrlr("192.168.0.1", 1);
+	*ctrlr2 = ut_add_ctrlr("192.168.0.2", 1);
+
+	rc = ut_attach_ctrlr(*ctrlr1, "nvme0", true, &ctx);
+	CU_ASSERT(rc == 0);
+	ut_poll_attach();
+	CU_ASSERT(ctx.done == true);
+	CU_ASSERT(ctx.rc == 0);
+	CU_ASSERT(ctx.bdev_count == 1);
+
+	rc = ut_attach_ctrlr(*ctrlr2, "nvme0", true, &ctx);
+	CU_ASSERT(rc == 0);
+	ut_poll_attach();
+	CU_ASSERT(ctx.done == true);
+	CU_ASSERT(ctx.rc == 0);
+	SPDK_CU_ASSERT_FATAL(ctx.bdev_count == 1);
+	CU_ASSERT(strcmp(ctx.names[0], "nvme0n1") == 0);
+
+	nbdev = ut_get_nbdev("nvme0n1");
+	SPDK_CU_ASSERT_FATAL(nbdev != NULL);
+	CU_ASSERT(nbdev->multipath == true);
+
+	return nbdev;
+}
+
+static void
+ut_detach(const char *name)
+{
+	int rc;
+
+	rc = bdev_nvme_delete(name);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name(name) == NULL);
+}
+
+static void
+test_multipath_policies(void)
+{
+	struct spdk_nvme_ctrlr *ctrlr1, *ctrlr2;
+	struct nvme_bdev *nbdev;
+	struct spdk_io_channel *ch;
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *io_path1, *io_path2;
+	struct spdk_bdev_io *bdev_io[4];
+	int i, rc;
+
+	nbdev = ut_attach_multipath(&ctrlr1, &ctrlr2);
+	CU_ASSERT(nbdev->mp_policy == NVME_BDEV_MP_POLICY_ROUND_ROBIN);
+
+	ch = spdk_get_io_channel(nbdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	nbdev_ch = spdk_io_channel_get_ctx(ch);
+	CU_ASSERT(nbdev_ch->num_io_paths == 2);
+
+	io_path1 = ut_get_io_path(nbdev_ch, ctrlr1);
+	io_path2 = ut_get_io_path(nbdev_ch, ctrlr2);
+	SPDK_CU_ASSERT_FATAL(io_path1 != NULL && io_path2 != NULL);
+
+	/* Round robin alternates between the paths. */
+	for (i = 0; i < 4; i++) {
+		bdev_io[i] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+		bdev_nvme_mp_submit_request(ch, bdev_io[i]);
+		CU_ASSERT(ut_get_bdev_io_path(bdev_io[i]) == (i % 2 == 0 ? io_path1 : io_path2));
+	}
+	CU_ASSERT(io_path1->outstanding == 2);
+	CU_ASSERT(io_path2->outstanding == 2);
+
+	for (i = 0; i < 4; i++) {
+		ut_complete_nvme_request(ut_get_bdev_io_path(bdev_io[i])->nvme_ch->qpair,
+					 SPDK_NVME_SCT_GENERIC, SPDK_NVME_SC_SUCCESS);
+		CU_ASSERT(bdev_io[i]->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		free(bdev_io[i]);
+	}
+	CU_ASSERT(io_path1->outstanding == 0);
+	CU_ASSERT(io_path2->outstanding == 0);
+	CU_ASSERT(io_path1->stat.num_write_ops == 2);
+	CU_ASSERT(io_path2->stat.num_write_ops == 2);
+
+	/* Queue depth sends I/O to the path with the fewest outstanding requests. */
+	rc = bdev_nvme_set_multipath_policy("nvme0", NVME_BDEV_MP_POLICY_QUEUE_DEPTH);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(nbdev->mp_policy == NVME_BDEV_MP_POLICY_QUEUE_DEPTH);
+
+	bdev_io[0] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_io[1] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io[0]);
+	bdev_nvme_mp_submit_request(ch, bdev_io[1]);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[0]) != ut_get_bdev_io_path(bdev_io[1]));
+
+	/* Both paths are busy, the one with less outstanding I/O wins over the next in turn. */
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	bdev_io[2] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_io[3] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io[2]);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[2]) == io_path1);
+	bdev_nvme_mp_submit_request(ch, bdev_io[3]);
+	CU_ASSERT(io_path1->outstanding == 1);
+	CU_ASSERT(io_path2->outstanding == 2);
+
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	ut_complete_nvme_request(io_path2->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	ut_complete_nvme_request(io_path2->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	for (i = 0; i < 4; i++) {
+		CU_ASSERT(bdev_io[i]->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		free(bdev_io[i]);
+	}
+
+	/* ANA prefers optimized paths and falls back to non-optimized ones. */
+	rc = bdev_nvme_set_multipath_policy("nvme0", NVME_BDEV_MP_POLICY_ANA);
+	CU_ASSERT(rc == 0);
+	ctrlr1->ns[0].ana_state = SPDK_NVME_ANA_NON_OPTIMIZED_STATE;
+
+	bdev_io[0] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_io[1] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io[0]);
+	bdev_nvme_mp_submit_request(ch, bdev_io[1]);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[0]) == io_path2);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[1]) == io_path2);
+
+	ctrlr2->ns[0].ana_state = SPDK_NVME_ANA_INACCESSIBLE_STATE;
+	bdev_io[2] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io[2]);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[2]) == io_path1);
+
+	/* No path is usable. */
+	ctrlr1->ns[0].ana_state = SPDK_NVME_ANA_PERSISTENT_LOSS_STATE;
+	bdev_io[3] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io[3]);
+	CU_ASSERT(bdev_io[3]->internal.status == SPDK_BDEV_IO_STATUS_FAILED);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[3]) == NULL);
+	CU_ASSERT(io_path1->outstanding == 1);
+	CU_ASSERT(io_path2->outstanding == 2);
+
+	ctrlr1->ns[0].ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+	ctrlr2->ns[0].ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	ut_complete_nvme_request(io_path2->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	ut_complete_nvme_request(io_path2->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(bdev_io[i]->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	}
+	for (i = 0; i < 4; i++) {
+		free(bdev_io[i]);
+	}
+
+	/* The policy can only be set for controllers attached in multipath mode. */
+	rc = bdev_nvme_set_multipath_policy("nvme1", NVME_BDEV_MP_POLICY_ANA);
+	CU_ASSERT(rc == -ENODEV);
+
+	spdk_put_io_channel(ch);
+	poll_threads();
+
+	ut_detach("nvme0");
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_attached_ctrlrs));
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_bdevs));
+}
+
+static void
+test_multipath_retry(void)
+{
+	struct spdk_nvme_ctrlr *ctrlr1, *ctrlr2;
+	struct nvme_bdev *nbdev;
+	struct spdk_io_channel *ch;
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *io_path1, *io_path2;
+	struct spdk_bdev_io *bdev_io;
+
+	nbdev = ut_attach_multipath(&ctrlr1, &ctrlr2);
+
+	ch = spdk_get_io_channel(nbdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	nbdev_ch = spdk_io_channel_get_ctx(ch);
+
+	io_path1 = ut_get_io_path(nbdev_ch, ctrlr1);
+	io_path2 = ut_get_io_path(nbdev_ch, ctrlr2);
+	SPDK_CU_ASSERT_FATAL(io_path1 != NULL && io_path2 != NULL);
+
+	/* A path error resubmits the I/O on the other path. */
+	bdev_io = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io) == io_path1);
+
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_PATH,
+				 SPDK_NVME_SC_INTERNAL_PATH_ERROR);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io) == io_path2);
+	CU_ASSERT(io_path1->outstanding == 0);
+	CU_ASSERT(io_path2->outstanding == 1);
+	CU_ASSERT(io_path1->stat.num_io_errors == 1);
+	CU_ASSERT(io_path1->stat.num_retries == 1);
+
+	ut_complete_nvme_request(io_path2->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	CU_ASSERT(io_path2->outstanding == 0);
+	CU_ASSERT(io_path2->stat.num_write_ops == 1);
+	free(bdev_io);
+
+	/* The I/O fails once it was retried on every path. */
+	bdev_io = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io) == io_path2);
+
+	ut_complete_nvme_request(io_path2->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_ABORTED_SQ_DELETION);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io) == io_path1);
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_PATH,
+				 SPDK_NVME_SC_INTERNAL_PATH_ERROR);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io) == io_path2);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_PENDING);
+	ut_complete_nvme_request(io_path2->nvme_ch->qpair, SPDK_NVME_SCT_PATH,
+				 SPDK_NVME_SC_INTERNAL_PATH_ERROR);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_NVME_ERROR);
+	CU_ASSERT(bdev_io->internal.error.nvme.sct == SPDK_NVME_SCT_PATH);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io) == NULL);
+	CU_ASSERT(io_path1->outstanding == 0);
+	CU_ASSERT(io_path2->outstanding == 0);
+	CU_ASSERT(io_path1->stat.num_retries == 2);
+	CU_ASSERT(io_path2->stat.num_retries == 1);
+	free(bdev_io);
+
+	/* Other errors are not retried. */
+	bdev_io = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io) == io_path1);
+
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_DATA_TRANSFER_ERROR);
+	CU_ASSERT(bdev_io->internal.status == SPDK_BDEV_IO_STATUS_NVME_ERROR);
+	CU_ASSERT(bdev_io->internal.error.nvme.sc == SPDK_NVME_SC_DATA_TRANSFER_ERROR);
+	CU_ASSERT(io_path1->stat.num_io_errors == 3);
+	CU_ASSERT(io_path1->stat.num_retries == 2);
+	free(bdev_io);
+
+	spdk_put_io_channel(ch);
+	poll_threads();
+
+	ut_detach("nvme0");
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_attached_ctrlrs));
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_bdevs));
+}
+
+static void
+test_multipath_remove_path(void)
+{
+	struct spdk_nvme_ctrlr *ctrlr1, *ctrlr2;
+	struct spdk_nvme_transport_id trid2;
+	struct spdk_nvme_qpair *qpair2;
+	struct nvme_bdev *nbdev;
+	struct spdk_io_channel *ch;
+	struct nvme_bdev_channel *nbdev_ch;
+	struct nvme_io_path *io_path1, *io_path2;
+	struct spdk_bdev_io *bdev_io[3];
+	int i, rc;
+
+	nbdev = ut_attach_multipath(&ctrlr1, &ctrlr2);
+
+	ch = spdk_get_io_channel(nbdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	nbdev_ch = spdk_io_channel_get_ctx(ch);
+
+	io_path1 = ut_get_io_path(nbdev_ch, ctrlr1);
+	io_path2 = ut_get_io_path(nbdev_ch, ctrlr2);
+	SPDK_CU_ASSERT_FATAL(io_path1 != NULL && io_path2 != NULL);
+	qpair2 = io_path2->nvme_ch->qpair;
+
+	bdev_io[0] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_io[1] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io[0]);
+	bdev_nvme_mp_submit_request(ch, bdev_io[1]);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[1]) == io_path2);
+
+	/* The removed path stays alive while it has outstanding I/O. */
+	trid2 = ctrlr2->trid;
+	rc = bdev_nvme_remove_trid("nvme0", &trid2);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+
+	CU_ASSERT(nbdev_ch->num_io_paths == 1);
+	CU_ASSERT(TAILQ_FIRST(&nbdev_ch->io_paths) == io_path1);
+	CU_ASSERT(io_path2->removed == true);
+	CU_ASSERT(io_path2->outstanding == 1);
+	CU_ASSERT(ut_ctrlr_is_attached(ctrlr2));
+	CU_ASSERT(nvme_bdev_ctrlr_get(&trid2) != NULL);
+
+	/* New I/O only goes to the remaining path. */
+	bdev_io[2] = ut_alloc_bdev_io(SPDK_BDEV_IO_TYPE_WRITE, nbdev, ch);
+	bdev_nvme_mp_submit_request(ch, bdev_io[2]);
+	CU_ASSERT(ut_get_bdev_io_path(bdev_io[2]) == io_path1);
+
+	/* Completing the last I/O frees the path and lets the controller go. */
+	ut_complete_nvme_request(qpair2, SPDK_NVME_SCT_GENERIC, SPDK_NVME_SC_SUCCESS);
+	CU_ASSERT(bdev_io[1]->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+	poll_threads();
+
+	CU_ASSERT(!ut_ctrlr_is_attached(ctrlr2));
+	CU_ASSERT(nvme_bdev_ctrlr_get(&trid2) == NULL);
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme0") != NULL);
+	CU_ASSERT(ut_get_nbdev("nvme0n1") == nbdev);
+
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	ut_complete_nvme_request(io_path1->nvme_ch->qpair, SPDK_NVME_SCT_GENERIC,
+				 SPDK_NVME_SC_SUCCESS);
+	for (i = 0; i < 3; i++) {
+		CU_ASSERT(bdev_io[i]->internal.status == SPDK_BDEV_IO_STATUS_SUCCESS);
+		free(bdev_io[i]);
+	}
+
+	spdk_put_io_channel(ch);
+	poll_threads();
+
+	ut_detach("nvme0");
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_attached_ctrlrs));
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_bdevs));
+}
+
+static void
+test_reject_duplicate_name(void)
+{
+	struct spdk_nvme_ctrlr *ctrlr1, *ctrlr2, *ctrlr3, *ctrlr4;
+	struct spdk_nvme_transport_id trid4;
+	struct ut_attach_ctx ctx, ctx2;
+	struct nvme_bdev_ctrlr *nvme_bdev_ctrlr;
+	int rc;
+
+	ctrlr1 = ut_add_ctrlr("192.168.0.1", 1);
+	ctrlr2 = ut_add_ctrlr("192.168.0.2", 1);
+
+	/* A multipath path can't be added to a controller attached without multipath. */
+	rc = ut_attach_ctrlr(ctrlr1, "nvme0", false, &ctx);
+	CU_ASSERT(rc == 0);
+	ut_poll_attach();
+	CU_ASSERT(ctx.rc == 0);
+
+	rc = ut_attach_ctrlr(ctrlr2, "nvme0", true, &ctx);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(g_ut_num_probe_ctxs == 0);
+
+	ut_detach("nvme0");
+
+	/* Nor can a controller be attached without multipath under a multipath name. */
+	ctrlr3 = ut_add_ctrlr("192.168.0.3", 1);
+	rc = ut_attach_ctrlr(ctrlr3, "nvme0", true, &ctx);
+	CU_ASSERT(rc == 0);
+	ut_poll_attach();
+	CU_ASSERT(ctx.rc == 0);
+
+	rc = ut_attach_ctrlr(ctrlr2, "nvme0", false, &ctx);
+	CU_ASSERT(rc == -EINVAL);
+	CU_ASSERT(g_ut_num_probe_ctxs == 0);
+
+	ut_detach("nvme0");
+
+	/* Of two attaches racing for a name, the later one fails and is detached. */
+	ctrlr4 = ut_add_ctrlr("192.168.0.4", 1);
+	trid4 = ctrlr4->trid;
+
+	rc = ut_attach_ctrlr(ctrlr2, "nvme1", false, &ctx);
+	CU_ASSERT(rc == 0);
+	rc = ut_attach_ctrlr(ctrlr4, "nvme1", false, &ctx2);
+	CU_ASSERT(rc == 0);
+	ut_poll_attach();
+
+	CU_ASSERT(ctx.done == true);
+	CU_ASSERT(ctx.rc == 0);
+	CU_ASSERT(ctx.bdev_count == 1);
+	CU_ASSERT(ctx2.done == true);
+	CU_ASSERT(ctx2.rc == -EEXIST);
+	CU_ASSERT(ctx2.bdev_count == 0);
+
+	nvme_bdev_ctrlr = nvme_bdev_ctrlr_get_by_name("nvme1");
+	SPDK_CU_ASSERT_FATAL(nvme_bdev_ctrlr != NULL);
+	CU_ASSERT(nvme_bdev_ctrlr->ctrlr == ctrlr2);
+	CU_ASSERT(nvme_bdev_ctrlr_get(&trid4) == NULL);
+	CU_ASSERT(!ut_ctrlr_is_attached(ctrlr4));
+	CU_ASSERT(ut_find_ctrlr(&trid4) == NULL);
+
+	ut_detach("nvme1");
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_init_ctrlrs));
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_attached_ctrlrs));
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_bdevs));
+}
+
+#define UT_RPC_CTRLR(name, traddr, extra) \
+	"{\"name\": \"" name "\", \"trtype\": \"tcp\", \"traddr\": \"" traddr "\", " \
+	"\"trsvcid\": \"4420\", \"subnqn\": \"" UT_SUBNQN "\"" extra "}"
+
+static void
+test_attach_controllers_rpc(void)
+{
+	struct spdk_nvme_ctrlr *ctrlr1, *ctrlr2;
+	struct nvme_bdev *nbdev;
+	struct spdk_io_channel *ch;
+	struct nvme_bdev_channel *nbdev_ch;
+
+	ctrlr1 = ut_add_ctrlr("192.168.0.1", 1);
+	ctrlr2 = ut_add_ctrlr("192.168.0.2", 1);
+	ctrlr2->fail_init = true;
+
+	/* Only one controller is attached at a time, and the failures are reported per entry. */
+	ut_rpc_call(rpc_bdev_nvme_attach_controllers,
+		    "{\"controllers\": ["
+		    UT_RPC_CTRLR("nvme0", "192.168.0.1", "") ", "
+		    UT_RPC_CTRLR("nvme1", "192.168.0.2", "") ", "
+		    UT_RPC_CTRLR("nvme2", "192.168.0.9", "")
+		    "], \"max_concurrent\": 1}");
+	CU_ASSERT(g_ut_rpc_done == false);
+	CU_ASSERT(g_ut_num_probe_ctxs == 1);
+
+	ut_poll_attach();
+	CU_ASSERT(g_ut_rpc_done == false);
+	CU_ASSERT(ut_ctrlr_is_attached(ctrlr1));
+	CU_ASSERT(g_ut_num_probe_ctxs == 1);
+
+	ut_poll_attach();
+	CU_ASSERT(g_ut_rpc_done == true);
+	CU_ASSERT(g_ut_rpc_error_code == 0);
+	CU_ASSERT(g_ut_num_probe_ctxs == 0);
+
+	CU_ASSERT(strstr(g_ut_rpc_response,
+			 "{\"name\":\"nvme0\",\"traddr\":\"192.168.0.1\",\"bdevs\":[\"nvme0n1\"],") != NULL);
+	CU_ASSERT(strstr(g_ut_rpc_response,
+			 "{\"name\":\"nvme1\",\"traddr\":\"192.168.0.2\",\"error\":\"Input/output error\","
+			 "\"bdevs\":[],") != NULL);
+	CU_ASSERT(strstr(g_ut_rpc_response,
+			 "{\"name\":\"nvme2\",\"traddr\":\"192.168.0.9\",\"error\":\"No such device\","
+			 "\"bdevs\":[],") != NULL);
+	CU_ASSERT(nvme_bdev_ctrlr_get_by_name("nvme1") == NULL);
+
+	ut_detach("nvme0");
+	ut_remove_ctrlr(ctrlr2);
+
+	/* Entries sharing a name are attached in order, the later ones as additional paths. */
+	ctrlr1 = ut_add_ctrlr("192.168.0.1", 1);
+	ctrlr2 = ut_add_ctrlr("192.168.0.2", 1);
+
+	ut_rpc_call(rpc_bdev_nvme_attach_controllers,
+		    "{\"controllers\": ["
+		    UT_RPC_CTRLR("nvme0", "192.168.0.1", ", \"multipath\": \"multipath\"") ", "
+		    UT_RPC_CTRLR("nvme0", "192.168.0.2", ", \"multipath\": \"multipath\"")
+		    "]}");
+	CU_ASSERT(g_ut_num_probe_ctxs == 1);
+
+	ut_poll_attach();
+	CU_ASSERT(g_ut_rpc_done == false);
+	CU_ASSERT(g_ut_num_probe_ctxs == 1);
+
+	ut_poll_attach();
+	CU_ASSERT(g_ut_rpc_done == true);
+	CU_ASSERT(g_ut_rpc_error_code == 0);
+	CU_ASSERT(strstr(g_ut_rpc_response,
+			 "{\"name\":\"nvme0\",\"traddr\":\"192.168.0.1\",\"bdevs\":[\"nvme0n1\"],") != NULL);
+	CU_ASSERT(strstr(g_ut_rpc_response,
+			 "{\"name\":\"nvme0\",\"traddr\":\"192.168.0.2\",\"bdevs\":[\"nvme0n1\"],") != NULL);
+	CU_ASSERT(strstr(g_ut_rpc_response, "error") == NULL);
+
+	nbdev = ut_get_nbdev("nvme0n1");
+	SPDK_CU_ASSERT_FATAL(nbdev != NULL);
+	ch = spdk_get_io_channel(nbdev);
+	SPDK_CU_ASSERT_FATAL(ch != NULL);
+	nbdev_ch = spdk_io_channel_get_ctx(ch);
+	CU_ASSERT(nbdev_ch->num_io_paths == 2);
+	CU_ASSERT(ut_get_io_path(nbdev_ch, ctrlr1) != NULL);
+	CU_ASSERT(ut_get_io_path(nbdev_ch, ctrlr2) != NULL);
+	spdk_put_io_channel(ch);
+	poll_threads();
+
+	ut_detach("nvme0");
+
+	/* Invalid requests fail before any controller is attached. */
+	ctrlr1 = ut_add_ctrlr("192.168.0.1", 1);
+
+	ut_rpc_call(rpc_bdev_nvme_attach_controllers, "{\"controllers\": []}");
+	CU_ASSERT(g_ut_rpc_done == true);
+	CU_ASSERT(g_ut_rpc_error_code == -EINVAL);
+
+	ut_rpc_call(rpc_bdev_nvme_attach_controllers, "{\"controllers\": [{\"name\": \"nvme0\"}]}");
+	CU_ASSERT(g_ut_rpc_done == true);
+	CU_ASSERT(g_ut_rpc_error_code == SPDK_JSONRPC_ERROR_INVALID_PARAMS);
+
+	ut_rpc_call(rpc_bdev_nvme_attach_controllers,
+		    "{\"controllers\": ["
+		    UT_RPC_CTRLR("nvme0", "192.168.0.1", "") ", "
+		    "{\"name\": \"nvme1\", \"trtype\": \"foo\", \"traddr\": \"192.168.0.2\"}"
+		    "]}");
+	CU_ASSERT(g_ut_rpc_done == true);
+	CU_ASSERT(g_ut_rpc_error_code == -EINVAL);
+
+	ut_rpc_call(rpc_bdev_nvme_attach_controllers,
+		    "{\"controllers\": ["
+		    UT_RPC_CTRLR("nvme0", "192.168.0.1", ", \"mp_policy\": \"ana\"")
+		    "]}");
+	CU_ASSERT(g_ut_rpc_done == true);
+	CU_ASSERT(g_ut_rpc_error_code == -EINVAL);
+
+	CU_ASSERT(g_ut_num_probe_ctxs == 0);
+	CU_ASSERT(!ut_ctrlr_is_attached(ctrlr1));
+
+	ut_remove_ctrlr(ctrlr1);
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_init_ctrlrs));
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_attached_ctrlrs));
+	CU_ASSERT(TAILQ_EMPTY(&g_ut_bdevs));
+}
+
+int
+main(int argc, const char **argv)
+{
+	CU_pSuite	suite = NULL;
+	unsigned int	num_failures;
+
+	CU_set_error_action(CUEA_ABORT);
+	CU_initialize_registry();
+
+	suite = CU_add_suite("nvme", NULL, NULL);
+
+	CU_ADD_TEST(suite, test_multipath_policies);
+	CU_ADD_TEST(suite, test_multipath_retry);
+	CU_ADD_TEST(suite, test_multipath_remove_path);
+	CU_ADD_TEST(suite, test_reject_duplicate_name);
+	CU_ADD_TEST(suite, test_attach_controllers_rpc);
+
+	CU_basic_set_mode(CU_BRM_VERBOSE);
+
+	allocate_threads(1);
+	set_thread(0);
+
+	bdev_nvme_library_init();
+
+	CU_basic_run_tests();
+
+	bdev_nvme_library_fini();
+	poll_threads();
+
+	free_threads();
+
+	num_failures = CU_get_number_of_failures();
+	CU_cleanup_registry();
+
+	return num_failures;
+}
@@ -210,11 +210,50 @@ spdk_blob_is_thin_provisioned(struct spdk_blob *blob)
 	return false;
 }
 
+bool
+spdk_blob_is_esnap_clone(const struct spdk_blob *blob)
+{
+	return false;
+}
+
+/* Name of the missing external snapshot of degraded blobs */
+static const char *g_esnap_missing_name;
+static struct spdk_bs_dev g_esnap_bs_dev;
+static int g_esnap_set_count;
+
+int
+spdk_blob_get_esnap_id(struct spdk_blob *blob, const void **id, size_t *len)
+{
+	if (g_esnap_missing_name == NULL) {
+		return -EINVAL;
+	}
+
+	*id = g_esnap_missing_name;
+	*len = strlen(g_esnap_missing_name) + 1;
+	return 0;
+}
+
+bool
+spdk_blob_is_degraded(const struct spdk_blob *blob)
+{
+	return g_esnap_missing_name != NULL;
+}
+
+void
+spdk_blob_set_esnap_bs_dev(struct spdk_blob *blob, struct spdk_bs_dev *esnap_dev,
+			   spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	CU_ASSERT(esnap_dev == &g_esnap_bs_dev);
+	g_esnap_missing_name = NULL;
+	g_esnap_set_count++;
+	cb_fn(cb_arg, 0);
+}
+
 static struct spdk_lvol *_lvol_create(struct spdk_lvol_store *lvs);
 
 void
-spdk_lvs_load(struct spdk_bs_dev *dev,
-	      spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg)
+spdk_lvs_load_ext(struct spdk_bs_dev *dev, const struct spdk_lvs_opts *opts,
+		  spdk_lvs_op_with_handle_complete cb_fn, void *cb_arg)
 {
 	struct spdk_lvol_store *lvs = NULL;
 	int i;
@@ -320,6 +359,18 @@ spdk_bdev_create_bs_dev_ext(const char *bdev_name, spdk_bdev_event_cb_t event_cb
 	return 0;
 }
 
+int
+spdk_bdev_create_bs_dev_ro(const char *bdev_name, spdk_bdev_event_cb_t event_cb,
+			   void *event_ctx, struct spdk_bs_dev **_bs_dev)
+{
+	if (spdk_bdev_get_by_name(bdev_name) == NULL) {
+		return -ENODEV;
+	}
+
+	*_bs_dev = &g_esnap_bs_dev;
+	return 0;
+}
+
 void
 spdk_lvs_opts_init(struct spdk_lvs_opts *opts)
 {
@@ -420,6 +471,20 @@ spdk_lvol_set_read_only(struct spdk_lvol *lvol, spdk_lvol_op_complete cb_fn, voi
 	cb_fn(cb_arg, 0);
 }
 
+void
+spdk_lvol_shallow_copy(struct spdk_lvol *lvol, struct spdk_bs_dev *ext_dev,
+		       spdk_lvol_op_complete cb_fn, void *cb_arg)
+{
+	CU_ASSERT(lvol_already_opened == true);
+	cb_fn(cb_arg, 0);
+}
+
+void
+spdk_lvs_grow(struct spdk_lvol_store *lvs, spdk_lvs_op_complete cb_fn, void *cb_arg)
+{
+	cb_fn(cb_arg, 0);
+}
+
 int
 spdk_bdev_notify_blockcnt_change(struct spdk_bdev *bdev, uint64_t size)
 {
@@ -436,7 +501,7 @@ spdk_bs_get_cluster_size(struct spdk_blob_store *bs)
 struct spdk_bdev *
 spdk_bdev_get_by_name(const char *bdev_name)
 {
-	if (!strcmp(g_base_bdev->name, bdev_name)) {
+	if (g_base_bdev != NULL && !strcmp(g_base_bdev->name, bdev_name)) {
 		return g_base_bdev;
 	}
 
@@ -570,7 +635,19 @@ spdk_bdev_module_list_add(struct spdk_bdev_module *bdev_module)
 const char *
 spdk_bdev_get_name(const struct spdk_bdev *bdev)
 {
-	return "test";
+	return bdev->name != NULL ? bdev->name : "test";
+}
+
+uint32_t
+spdk_bdev_get_block_size(const struct spdk_bdev *bdev)
+{
+	return bdev->blocklen;
+}
+
+uint64_t
+spdk_bdev_get_num_blocks(const struct spdk_bdev *bdev)
+{
+	return bdev->blockcnt;
 }
 
 int
@@ -641,6 +718,23 @@ spdk_lvol_create_clone(struct spdk_lvol *lvol, const char *clone_name,
 	cb_fn(cb_arg, clone, 0);
 }
 
+int
+spdk_lvol_create_esnap_clone(const void *esnap_id, uint32_t id_len, uint64_t size_bytes,
+			     struct spdk_lvol_store *lvs, const char *clone_name,
+			     spdk_lvol_op_with_handle_complete cb_fn, void *cb_arg)
+{
+	struct spdk_lvol *clone;
+
+	CU_ASSERT(id_len == strlen(esnap_id) + 1);
+	CU_ASSERT(size_bytes % g_cluster_size == 0);
+
+	clone = _lvol_create(lvs);
+	snprintf(clone->name, sizeof(clone->name), "%s", clone_name);
+	cb_fn(cb_arg, clone, 0);
+
+	return 0;
+}
+
 static void
 lvol_store_op_complete(void *cb_arg, int lvserrno)
 {
@@ -689,8 +783,8 @@ ut_lvs_destroy(void)
 	struct spdk_lvol_store *lvs;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -723,8 +817,8 @@ ut_lvol_init(void)
 	int rc;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -758,8 +852,8 @@ ut_lvol_snapshot(void)
 	struct spdk_lvol *lvol = NULL;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -808,8 +902,8 @@ ut_lvol_clone(void)
 	struct spdk_lvol *clone = NULL;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -864,6 +958,91 @@ ut_lvol_clone(void)
 	CU_ASSERT(g_lvol_store == NULL);
 }
 
+static void
+ut_lvol_bdev_clone(void)
+{
+	struct spdk_lvol_store *lvs;
+	struct spdk_bdev esnap_bdev = {};
+	struct spdk_bs_dev *bs_dev;
+	struct spdk_lvol *clone;
+	int cluster_size = g_cluster_size;
+	int rc;
+
+	/* Lvol store is successfully created */
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+	lvs = g_lvol_store;
+
+	esnap_bdev.name = "esnap";
+	esnap_bdev.blocklen = 512;
+	esnap_bdev.blockcnt = 8192;
+	g_cluster_size = 1024 * 1024;
+	g_base_bdev = &esnap_bdev;
+
+	/* Bdev does not exist */
+	rc = vbdev_lvol_create_bdev_clone("nonexistent", lvs, "clone", vbdev_lvol_create_complete, NULL);
+	CU_ASSERT(rc == -ENODEV);
+
+	/* Size of the bdev is not a multiple of the cluster size */
+	esnap_bdev.blockcnt = 8191;
+	rc = vbdev_lvol_create_bdev_clone("esnap", lvs, "clone", vbdev_lvol_create_complete, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Block size of the bdev does not divide the io unit size */
+	esnap_bdev.blockcnt = 8192;
+	esnap_bdev.blocklen = 8192;
+	rc = vbdev_lvol_create_bdev_clone("esnap", lvs, "clone", vbdev_lvol_create_complete, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* Successful clone create */
+	esnap_bdev.blocklen = 512;
+	g_lvol = NULL;
+	g_lvolerrno = -1;
+	rc = vbdev_lvol_create_bdev_clone("esnap", lvs, "clone", vbdev_lvol_create_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvolerrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol != NULL);
+	clone = g_lvol;
+
+	/* A clone whose bdev is missing at load opens degraded and keeps its name */
+	bs_dev = &g_esnap_bs_dev;
+	rc = vbdev_lvol_esnap_dev_create(lvs, NULL, "missing", sizeof("missing"), &bs_dev);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(bs_dev == NULL);
+
+	/* Registering its bdev sets the external snapshot of the degraded clone */
+	clone->blob = (struct spdk_blob *)&g_esnap_bs_dev;
+	g_esnap_missing_name = "other";
+	g_esnap_set_count = 0;
+	vbdev_lvs_examine_config(&esnap_bdev);
+	CU_ASSERT(g_examine_done == true);
+	g_examine_done = false;
+	CU_ASSERT(g_esnap_set_count == 0);
+
+	g_esnap_missing_name = "esnap";
+	vbdev_lvs_examine_config(&esnap_bdev);
+	CU_ASSERT(g_examine_done == true);
+	g_examine_done = false;
+	CU_ASSERT(g_esnap_set_count == 1);
+	CU_ASSERT(g_esnap_missing_name == NULL);
+	clone->blob = NULL;
+
+	g_base_bdev = NULL;
+	g_cluster_size = cluster_size;
+
+	/* Successful clone destroy */
+	vbdev_lvol_destroy(clone, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvol == NULL);
+
+	/* Destroy lvol store */
+	vbdev_lvs_destruct(lvs, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	CU_ASSERT(g_lvol_store == NULL);
+}
+
 static void
 ut_lvol_hotremove(void)
 {
@@ -874,8 +1053,8 @@ ut_lvol_hotremove(void)
 	lvol_already_opened = false;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -892,6 +1071,56 @@ ut_lvol_hotremove(void)
 
 }
 
+static void
+ut_lvs_grow(void)
+{
+	uint64_t blockcnt = g_bdev.blockcnt;
+	int rc = 0;
+
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store->bs_dev != NULL);
+
+	/* Grow picks up the current size of the base bdev */
+	g_bdev.blockcnt = 2048;
+	g_lvserrno = -1;
+	vbdev_lvs_grow(g_lvol_store, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	CU_ASSERT(g_lvol_store->bs_dev->blockcnt == 2048);
+
+	/* Resize event on the base bdev grows the lvol store */
+	g_bdev.blockcnt = 4096;
+	vbdev_lvs_base_bdev_event_cb(SPDK_BDEV_EVENT_RESIZE, &g_bdev, NULL);
+	CU_ASSERT(g_lvol_store->bs_dev->blockcnt == 4096);
+
+	/* A shrunk base bdev is rejected and the lvol store keeps its size */
+	g_bdev.blockcnt = 1024;
+	g_lvserrno = 0;
+	vbdev_lvs_grow(g_lvol_store, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvserrno == -EINVAL);
+	CU_ASSERT(g_lvol_store->bs_dev->blockcnt == 4096);
+
+	/* Same for a resize event */
+	vbdev_lvs_base_bdev_event_cb(SPDK_BDEV_EVENT_RESIZE, &g_bdev, NULL);
+	CU_ASSERT(g_lvol_store->bs_dev->blockcnt == 4096);
+
+	/* An unchanged size is not an error */
+	g_bdev.blockcnt = 4096;
+	g_lvserrno = -1;
+	vbdev_lvs_grow(g_lvol_store, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	CU_ASSERT(g_lvol_store->bs_dev->blockcnt == 4096);
+
+	vbdev_lvs_destruct(g_lvol_store, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	CU_ASSERT(g_lvol_store == NULL);
+
+	g_bdev.blockcnt = blockcnt;
+}
+
 static void
 ut_lvs_examine_check(bool success)
 {
@@ -968,8 +1197,8 @@ ut_lvol_rename(void)
 	int rc;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -1033,8 +1262,8 @@ ut_lvol_destroy(void)
 	int rc;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -1081,8 +1310,8 @@ ut_lvol_resize(void)
 	int rc = 0;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -1127,8 +1356,8 @@ ut_lvol_set_read_only(void)
 	int rc = 0;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -1159,6 +1388,54 @@ ut_lvol_set_read_only(void)
 	CU_ASSERT(g_lvol_store == NULL);
 }
 
+static void
+ut_lvol_shallow_copy(void)
+{
+	struct spdk_lvol_store *lvs;
+	struct spdk_lvol *lvol;
+	int sz = 10;
+	int rc = 0;
+
+	/* Lvol store is successfully created */
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+	lvs = g_lvol_store;
+
+	/* Successful lvol create */
+	g_lvolerrno = -1;
+	rc = vbdev_lvol_create(lvs, "lvol", sz, false, LVOL_CLEAR_WITH_DEFAULT, vbdev_lvol_create_complete,
+			       NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvolerrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol != NULL);
+	lvol = g_lvol;
+
+	/* The base bdev of the lvol store is claimed and can't be copied to */
+	g_lvolerrno = 0;
+	vbdev_lvol_shallow_copy(lvol, "bdev", vbdev_lvol_set_read_only_complete, NULL);
+	CU_ASSERT(g_lvolerrno == -EINVAL);
+
+	/* The target bdev is claimed during the copy and released afterwards */
+	lvol_already_opened = false;
+	g_lvolerrno = -1;
+	vbdev_lvol_shallow_copy(lvol, "bdev2", vbdev_lvol_set_read_only_complete, NULL);
+	CU_ASSERT(g_lvolerrno == 0);
+	CU_ASSERT(lvol_already_opened == false);
+	lvol_already_opened = true;
+
+	/* Successful lvol destroy */
+	vbdev_lvol_destroy(lvol, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvol == NULL);
+
+	/* Destroy lvol store */
+	vbdev_lvs_destruct(lvs, lvol_store_op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	CU_ASSERT(g_lvol_store == NULL);
+}
+
 static void
 ut_lvs_unload(void)
 {
@@ -1167,8 +1444,8 @@ ut_lvs_unload(void)
 	struct spdk_lvol_store *lvs;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -1203,8 +1480,8 @@ ut_lvs_init(void)
 	/* spdk_lvs_init() fails */
 	lvol_store_initialize_fail = true;
 
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc != 0);
 	CU_ASSERT(g_lvserrno == 0);
 	CU_ASSERT(g_lvol_store == NULL);
@@ -1214,8 +1491,8 @@ ut_lvs_init(void)
 	/* spdk_lvs_init_cb() fails */
 	lvol_store_initialize_cb_fail = true;
 
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno != 0);
 	CU_ASSERT(g_lvol_store == NULL);
@@ -1223,8 +1500,8 @@ ut_lvs_init(void)
 	lvol_store_initialize_cb_fail = false;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
@@ -1234,8 +1511,8 @@ ut_lvs_init(void)
 	g_lvol_store = NULL;
 
 	/* Bdev with lvol store already claimed */
-	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, lvol_store_op_with_handle_complete,
-			      NULL);
+	rc = vbdev_lvs_create("bdev", "lvs", 0, LVS_CLEAR_WITH_UNMAP, 0,
+			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc != 0);
 	CU_ASSERT(g_lvserrno == 0);
 	CU_ASSERT(g_lvol_store == NULL);
@@ -1368,7 +1645,7 @@ ut_lvs_rename(void)
 	struct spdk_lvol_store *lvs;
 
 	/* Lvol store is successfully created */
-	rc = vbdev_lvs_create("bdev", "old_lvs_name", 0, LVS_CLEAR_WITH_UNMAP,
+	rc = vbdev_lvs_create("bdev", "old_lvs_name", 0, LVS_CLEAR_WITH_UNMAP, 0,
 			      lvol_store_op_with_handle_complete, NULL);
 	CU_ASSERT(rc == 0);
 	CU_ASSERT(g_lvserrno == 0);
@@ -1429,10 +1706,12 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, ut_lvol_init);
 	CU_ADD_TEST(suite, ut_lvol_snapshot);
 	CU_ADD_TEST(suite, ut_lvol_clone);
+	CU_ADD_TEST(suite, ut_lvol_bdev_clone);
 	CU_ADD_TEST(suite, ut_lvs_destroy);
 	CU_ADD_TEST(suite, ut_lvs_unload);
 	CU_ADD_TEST(suite, ut_lvol_resize);
 	CU_ADD_TEST(suite, ut_lvol_set_read_only);
+	CU_ADD_TEST(suite, ut_lvol_shallow_copy);
 	CU_ADD_TEST(suite, ut_lvol_hotremove);
 	CU_ADD_TEST(suite, ut_vbdev_lvol_get_io_channel);
 	CU_ADD_TEST(suite, ut_vbdev_lvol_io_type_supported);
@@ -1442,6 +1721,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, ut_lvol_rename);
 	CU_ADD_TEST(suite, ut_lvol_destroy);
 	CU_ADD_TEST(suite, ut_lvs_rename);
+	CU_ADD_TEST(suite, ut_lvs_grow);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
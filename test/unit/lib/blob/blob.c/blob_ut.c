@@ -2506,6 +2506,103 @@ bs_load_custom_cluster_size(void)
 	g_bs = NULL;
 }
 
+static void
+bs_grow(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_super_block *super_block = (struct spdk_bs_super_block *)g_dev_buffer;
+	struct spdk_bs_opts opts;
+	struct spdk_blob_opts blob_opts;
+	struct spdk_blob *blob;
+	uint64_t cluster_sz = 4 * SPDK_BS_PAGE_SIZE;
+	uint64_t total_clusters, free_clusters;
+
+	/* Blobstore on the first half of the device */
+	dev = init_dev();
+	dev->blockcnt = DEV_BUFFER_BLOCKCNT / 2;
+	spdk_bs_opts_init(&opts);
+	opts.cluster_sz = cluster_sz;
+	spdk_bs_init(dev, &opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	total_clusters = bs->total_clusters;
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	CU_ASSERT(total_clusters == DEV_BUFFER_SIZE / 2 / cluster_sz);
+
+	/* Nothing to do if the device did not grow */
+	g_bserrno = -1;
+	spdk_bs_grow(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs->total_clusters == total_clusters);
+
+	/* The new clusters are free and the new size is persisted as dirty right away */
+	dev->blockcnt = DEV_BUFFER_BLOCKCNT;
+	spdk_bs_grow(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs->total_clusters == 2 * total_clusters);
+	CU_ASSERT(spdk_bs_total_data_cluster_count(bs) == free_clusters + total_clusters);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters + total_clusters);
+	CU_ASSERT(super_block->size == DEV_BUFFER_SIZE);
+	CU_ASSERT(super_block->clean == 0);
+
+	/* And can be allocated */
+	ut_spdk_blob_opts_init(&blob_opts);
+	blob_opts.num_clusters = free_clusters + total_clusters;
+	blob = ut_blob_create_and_open(bs, &blob_opts);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* The mask of the initial device size has no room for this many clusters */
+	dev->blockcnt = 16 * DEV_BUFFER_BLOCKCNT;
+	spdk_bs_grow(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -ENOSPC);
+	CU_ASSERT(bs->total_clusters == 2 * total_clusters);
+	CU_ASSERT(super_block->size == DEV_BUFFER_SIZE);
+	dev->blockcnt = DEV_BUFFER_BLOCKCNT;
+
+	/* The grown blobstore is recovered after a crash, and loads cleanly */
+	ut_bs_dirty_load(&bs, &opts);
+	CU_ASSERT(bs->total_clusters == 2 * total_clusters);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	ut_bs_reload(&bs, &opts);
+	CU_ASSERT(bs->total_clusters == 2 * total_clusters);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+
+	/* Room for growing can be reserved when the blobstore is created */
+	dev = init_dev();
+	opts.max_size = 16 * DEV_BUFFER_SIZE;
+	spdk_bs_init(dev, &opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+
+	dev->blockcnt = 16 * DEV_BUFFER_BLOCKCNT;
+	spdk_bs_grow(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs->total_clusters == 16 * DEV_BUFFER_SIZE / cluster_sz);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(super_block->clean == 1);
+	g_bs = NULL;
+}
+
 static void
 bs_type(void)
 {
@@ -3336,147 +3433,644 @@ blob_dirty_shutdown(void)
 }
 
 static void
-blob_flags(void)
+blob_dirty_shutdown_replay(void)
 {
-	struct spdk_blob_store *bs = g_bs;
-	spdk_blob_id blobid_invalid, blobid_data_ro, blobid_md_ro;
-	struct spdk_blob *blob_invalid, *blob_data_ro, *blob_md_ro;
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
 	struct spdk_blob_opts blob_opts;
-	int rc;
+	struct spdk_blob *blob;
+	spdk_blob_id blobids[300], big_blobid;
+	uint64_t free_clusters, read_ops;
+	uint32_t md_len;
+	const void *value;
+	size_t value_len;
+	char *xattr;
+	size_t xattr_length;
+	int rc, i;
 
-	/* Create three blobs - one each for testing invalid, data_ro and md_ro flags. */
-	blob_invalid = ut_blob_create_and_open(bs, NULL);
-	blobid_invalid = spdk_blob_get_id(blob_invalid);
+	/* Small clusters make for a metadata region larger than a single replay read */
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts);
+	bs_opts.cluster_sz = SPDK_BS_PAGE_SIZE * 4;
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	md_len = bs->md_len;
+	SPDK_CU_ASSERT_FATAL(md_len > BS_LOAD_REPLAY_CHUNK_PAGES * BS_LOAD_REPLAY_CHUNKS);
 
-	blob_data_ro = ut_blob_create_and_open(bs, NULL);
-	blobid_data_ro = spdk_blob_get_id(blob_data_ro);
+	/* Enough blobs for their first pages to span several replay reads */
+	for (i = 0; i < (int)SPDK_COUNTOF(blobids); i++) {
+		blob = ut_blob_create_and_open(bs, NULL);
+		blobids[i] = spdk_blob_get_id(blob);
+		spdk_blob_close(blob, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
 
+	/* One blob with a multi-page chain and clusters spread over several extent pages */
 	ut_spdk_blob_opts_init(&blob_opts);
-	blob_opts.clear_method = BLOB_CLEAR_WITH_WRITE_ZEROES;
-	blob_md_ro = ut_blob_create_and_open(bs, &blob_opts);
-	blobid_md_ro = spdk_blob_get_id(blob_md_ro);
-	CU_ASSERT((blob_md_ro->md_ro_flags & SPDK_BLOB_MD_RO_FLAGS_MASK) == BLOB_CLEAR_WITH_WRITE_ZEROES);
-
-	/* Change the size of blob_data_ro to check if flags are serialized
-	 * when blob has non zero number of extents */
-	spdk_blob_resize(blob_data_ro, 10, blob_op_complete, NULL);
+	blob_opts.num_clusters = SPDK_EXTENTS_PER_EP * 2 + 10;
+	blob = ut_blob_create_and_open(bs, &blob_opts);
+	big_blobid = spdk_blob_get_id(blob);
+	xattr_length = 4072 - sizeof(struct spdk_blob_md_descriptor_xattr) - strlen("large_xattr");
+	xattr = calloc(xattr_length, sizeof(char));
+	SPDK_CU_ASSERT_FATAL(xattr != NULL);
+	memset(xattr, 0xA5, xattr_length);
+	rc = spdk_blob_set_xattr(blob, "large_xattr", xattr, xattr_length);
+	CU_ASSERT(rc == 0);
+	spdk_blob_close(blob, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
 
-	/* Set the xattr to check if flags are serialized
-	 * when blob has non zero number of xattrs */
-	rc = spdk_blob_set_xattr(blob_md_ro, "name", "log.txt", strlen("log.txt") + 1);
-	CU_ASSERT(rc == 0);
+	free_clusters = spdk_bs_free_cluster_count(bs);
 
-	blob_invalid->invalid_flags = (1ULL << 63);
-	blob_invalid->state = SPDK_BLOB_STATE_DIRTY;
-	blob_data_ro->data_ro_flags = (1ULL << 62);
-	blob_data_ro->state = SPDK_BLOB_STATE_DIRTY;
-	blob_md_ro->md_ro_flags = (1ULL << 61);
-	blob_md_ro->state = SPDK_BLOB_STATE_DIRTY;
+	/* Dirty shutdown and recover */
+	read_ops = g_dev_read_ops;
+	ut_bs_dirty_load(&bs, &bs_opts);
+	CU_ASSERT(bs->md_len == md_len);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+	/* The metadata region is read with a few large reads per pass, not page by page */
+	CU_ASSERT(g_dev_read_ops - read_ops < md_len / 8);
 
-	g_bserrno = -1;
-	spdk_blob_sync_md(blob_invalid, blob_op_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
-	g_bserrno = -1;
-	spdk_blob_sync_md(blob_data_ro, blob_op_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
-	g_bserrno = -1;
-	spdk_blob_sync_md(blob_md_ro, blob_op_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
+	for (i = 0; i < (int)SPDK_COUNTOF(blobids); i++) {
+		CU_ASSERT(spdk_bit_array_get(bs->used_blobids, bs_blobid_to_page(blobids[i])) == true);
+		spdk_bs_open_blob(bs, blobids[i], blob_op_with_handle_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+		spdk_blob_close(g_blob, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
 
-	g_bserrno = -1;
-	spdk_blob_close(blob_invalid, blob_op_complete, NULL);
+	spdk_bs_open_blob(bs, big_blobid, blob_op_with_handle_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	blob_invalid = NULL;
-	g_bserrno = -1;
-	spdk_blob_close(blob_data_ro, blob_op_complete, NULL);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(spdk_blob_get_num_clusters(blob) == SPDK_EXTENTS_PER_EP * 2 + 10);
+	rc = spdk_blob_get_xattr_value(blob, "large_xattr", &value, &value_len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(value_len == xattr_length);
+	CU_ASSERT(value != NULL && memcmp(value, xattr, xattr_length) == 0);
+	free(xattr);
+	spdk_blob_close(blob, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	blob_data_ro = NULL;
-	g_bserrno = -1;
-	spdk_blob_close(blob_md_ro, blob_op_complete, NULL);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	blob_md_ro = NULL;
-
+	g_bs = NULL;
 	g_blob = NULL;
 	g_blobid = SPDK_BLOBID_INVALID;
+}
 
-	ut_bs_reload(&bs, NULL);
+struct ut_esnap_dev {
+	struct spdk_bs_dev	bs_dev;
+	uint32_t		*destroyed;
+};
 
-	g_blob = NULL;
-	g_bserrno = 0;
-	spdk_bs_open_blob(bs, blobid_invalid, blob_op_with_handle_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno != 0);
-	CU_ASSERT(g_blob == NULL);
+static uint32_t g_ut_esnap_channels;
 
-	g_blob = NULL;
-	g_bserrno = -1;
-	spdk_bs_open_blob(bs, blobid_data_ro, blob_op_with_handle_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
-	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
-	blob_data_ro = g_blob;
-	/* If an unknown data_ro flag was found, the blob should be marked both data and md read-only. */
-	CU_ASSERT(blob_data_ro->data_ro == true);
-	CU_ASSERT(blob_data_ro->md_ro == true);
-	CU_ASSERT(spdk_blob_get_num_clusters(blob_data_ro) == 10);
+static struct spdk_io_channel *
+ut_esnap_create_channel(struct spdk_bs_dev *dev)
+{
+	g_ut_esnap_channels++;
+	return calloc(1, sizeof(uint64_t));
+}
 
-	g_blob = NULL;
-	g_bserrno = -1;
-	spdk_bs_open_blob(bs, blobid_md_ro, blob_op_with_handle_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
-	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
-	blob_md_ro = g_blob;
-	CU_ASSERT(blob_md_ro->data_ro == false);
-	CU_ASSERT(blob_md_ro->md_ro == true);
+static void
+ut_esnap_destroy_channel(struct spdk_bs_dev *dev, struct spdk_io_channel *channel)
+{
+	CU_ASSERT(g_ut_esnap_channels > 0);
+	g_ut_esnap_channels--;
+	free(channel);
+}
 
-	g_bserrno = -1;
-	spdk_blob_sync_md(blob_md_ro, blob_op_complete, NULL);
-	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
+static void
+ut_esnap_destroy(struct spdk_bs_dev *bs_dev)
+{
+	struct ut_esnap_dev *dev = (struct ut_esnap_dev *)bs_dev;
 
-	ut_blob_close_and_delete(bs, blob_data_ro);
-	ut_blob_close_and_delete(bs, blob_md_ro);
+	(*dev->destroyed)++;
+	free(dev);
 }
 
+/* Every block of the external snapshot holds its LBA + 1 */
 static void
-bs_version(void)
+ut_esnap_fill(struct spdk_bs_dev *dev, void *payload, uint64_t lba, uint32_t lba_count)
 {
-	struct spdk_bs_super_block *super;
-	struct spdk_blob_store *bs = g_bs;
+	uint32_t i;
+
+	CU_ASSERT(lba + lba_count <= dev->blockcnt);
+	for (i = 0; i < lba_count; i++) {
+		memset((uint8_t *)payload + i * dev->blocklen, (uint8_t)(lba + i + 1), dev->blocklen);
+	}
+}
+
+static void
+ut_esnap_read(struct spdk_bs_dev *dev, struct spdk_io_channel *channel, void *payload,
+	      uint64_t lba, uint32_t lba_count, struct spdk_bs_dev_cb_args *cb_args)
+{
+	ut_esnap_fill(dev, payload, lba, lba_count);
+	cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, 0);
+}
+
+static void
+ut_esnap_readv(struct spdk_bs_dev *dev, struct spdk_io_channel *channel,
+	       struct iovec *iov, int iovcnt, uint64_t lba, uint32_t lba_count,
+	       struct spdk_bs_dev_cb_args *cb_args)
+{
+	int i;
+
+	for (i = 0; i < iovcnt; i++) {
+		CU_ASSERT(iov[i].iov_len % dev->blocklen == 0);
+		ut_esnap_fill(dev, iov[i].iov_base, lba, iov[i].iov_len / dev->blocklen);
+		lba += iov[i].iov_len / dev->blocklen;
+	}
+	cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, 0);
+}
+
+static struct spdk_bs_dev *
+ut_esnap_dev_alloc(uint32_t *destroyed)
+{
+	struct ut_esnap_dev *dev;
+
+	dev = calloc(1, sizeof(*dev));
+	SPDK_CU_ASSERT_FATAL(dev != NULL);
+	dev->destroyed = destroyed;
+	dev->bs_dev.blocklen = 512;
+	dev->bs_dev.blockcnt = 4 * SPDK_BS_PAGE_SIZE * 4 / 512;
+	dev->bs_dev.create_channel = ut_esnap_create_channel;
+	dev->bs_dev.destroy_channel = ut_esnap_destroy_channel;
+	dev->bs_dev.destroy = ut_esnap_destroy;
+	dev->bs_dev.read = ut_esnap_read;
+	dev->bs_dev.readv = ut_esnap_readv;
+
+	return &dev->bs_dev;
+}
+
+/* Simulates an external snapshot that is not available yet */
+static bool g_ut_esnap_missing;
+
+static int
+ut_esnap_dev_create(void *bs_ctx, struct spdk_blob *blob, const void *esnap_id,
+		    uint32_t id_len, struct spdk_bs_dev **bs_dev)
+{
+	if (id_len != sizeof("esnap") || memcmp(esnap_id, "esnap", id_len) != 0) {
+		return -ENODEV;
+	}
+
+	*bs_dev = g_ut_esnap_missing ? NULL : ut_esnap_dev_alloc(bs_ctx);
+	return 0;
+}
+
+/* Check len bytes at byte offset off of the clone against the esnap pattern */
+static bool
+ut_esnap_content_is(const uint8_t *buf, uint64_t off, uint64_t len)
+{
+	uint64_t i;
+
+	for (i = 0; i < len; i++) {
+		if (buf[i] != (uint8_t)((off + i) / 512 + 1)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+static void
+blob_esnap_clone(void)
+{
+	struct spdk_blob_store *bs;
 	struct spdk_bs_dev *dev;
-	struct spdk_blob *blob;
+	struct spdk_bs_opts bs_opts;
 	struct spdk_blob_opts blob_opts;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel, *channel_thread1;
 	spdk_blob_id blobid;
+	uint64_t free_clusters, cluster_sz;
+	uint32_t destroyed = 0;
+	uint8_t payload[SPDK_BS_PAGE_SIZE * 4], zero[SPDK_BS_PAGE_SIZE * 4];
+	const void *id;
+	size_t id_len;
+	int rc;
 
-	/* Unload the blob store */
-	spdk_bs_unload(bs, bs_op_complete, NULL);
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts);
+	bs_opts.cluster_sz = SPDK_BS_PAGE_SIZE * 4;
+	bs_opts.esnap_bs_dev_create = ut_esnap_dev_create;
+	bs_opts.esnap_ctx = &destroyed;
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	g_bs = NULL;
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	cluster_sz = bs_opts.cluster_sz;
+	memset(zero, 0, sizeof(zero));
+	g_ut_esnap_channels = 0;
 
-	/*
-	 * Change the bs version on disk.  This will allow us to
-	 *  test that the version does not get modified automatically
-	 *  when loading and unloading the blobstore.
-	 */
-	super = (struct spdk_bs_super_block *)&g_dev_buffer[0];
-	CU_ASSERT(super->version == SPDK_BS_VERSION);
-	CU_ASSERT(super->clean == 1);
-	super->version = 2;
-	/*
-	 * Version 2 metadata does not have a used blobid mask, so clear
-	 *  those fields in the super block and zero the corresponding
-	 *  region on "disk".  We will use this to ensure blob IDs are
-	 *  correctly reconstructed.
+	/* An external snapshot requires a blobstore that can open it */
+	ut_spdk_blob_opts_init(&blob_opts);
+	blob_opts.num_clusters = 4;
+	blob_opts.esnap_id = "esnap";
+	blob_opts.esnap_id_len = sizeof("esnap");
+	bs->esnap_bs_dev_create = NULL;
+	spdk_bs_create_blob_ext(bs, &blob_opts, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EINVAL);
+	bs->esnap_bs_dev_create = ut_esnap_dev_create;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	blob = ut_blob_create_and_open(bs, &blob_opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(spdk_blob_is_esnap_clone(blob));
+	CU_ASSERT(spdk_blob_is_thin_provisioned(blob));
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
+	rc = spdk_blob_get_esnap_id(blob, &id, &id_len);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(id_len == sizeof("esnap"));
+	CU_ASSERT(id != NULL && memcmp(id, "esnap", id_len) == 0);
+
+	/* Unallocated clusters read from the external snapshot, one channel per blobstore channel */
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+	spdk_blob_io_read(blob, channel, payload, 4, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_esnap_content_is(payload, cluster_sz, cluster_sz));
+	CU_ASSERT(g_ut_esnap_channels == 1);
+
+	set_thread(1);
+	channel_thread1 = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel_thread1 != NULL);
+	spdk_blob_io_read(blob, channel_thread1, payload, 12, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_esnap_content_is(payload, 3 * cluster_sz, cluster_sz));
+	CU_ASSERT(g_ut_esnap_channels == 2);
+	set_thread(0);
+
+	/* A write copies the rest of the cluster from the external snapshot */
+	memset(payload, 0xE5, SPDK_BS_PAGE_SIZE);
+	spdk_blob_io_write(blob, channel, payload, 9, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+	spdk_blob_io_read(blob, channel, payload, 8, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_esnap_content_is(payload, 2 * cluster_sz, SPDK_BS_PAGE_SIZE));
+	CU_ASSERT(payload[SPDK_BS_PAGE_SIZE] == 0xE5 && payload[2 * SPDK_BS_PAGE_SIZE - 1] == 0xE5);
+	CU_ASSERT(ut_esnap_content_is(payload + 2 * SPDK_BS_PAGE_SIZE,
+				      2 * cluster_sz + 2 * SPDK_BS_PAGE_SIZE, 2 * SPDK_BS_PAGE_SIZE));
+
+	/* Growing past the end of the external snapshot reads zeroes */
+	spdk_blob_resize(blob, 5, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	memset(payload, 0xFF, sizeof(payload));
+	spdk_blob_io_read(blob, channel, payload, 16, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload, zero, sizeof(payload)) == 0);
+
+	/* Snapshots of external snapshot clones are not supported */
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -ENOTSUP);
+
+	/* Closing the blob releases the channels on every thread and destroys the device */
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_ut_esnap_channels == 0);
+	CU_ASSERT(destroyed == 1);
+
+	set_thread(1);
+	spdk_bs_free_io_channel(channel_thread1);
+	set_thread(0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	/* The external snapshot is opened again after reload */
+	ut_bs_reload(&bs, &bs_opts);
+	/* Load opens and closes every blob once to rebuild the snapshot lists */
+	destroyed = 0;
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(spdk_blob_is_esnap_clone(blob));
+	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
+	CU_ASSERT(destroyed == 0);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+	spdk_blob_io_read(blob, channel, payload, 8, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_esnap_content_is(payload, 2 * cluster_sz, SPDK_BS_PAGE_SIZE));
+	CU_ASSERT(payload[SPDK_BS_PAGE_SIZE] == 0xE5);
+	spdk_blob_io_read(blob, channel, payload, 0, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_esnap_content_is(payload, 0, cluster_sz));
+	CU_ASSERT(g_ut_esnap_channels == 1);
+
+	/* Inflating copies the external snapshot and drops it */
+	spdk_bs_inflate_blob(bs, channel, blobid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(!spdk_blob_is_esnap_clone(blob));
+	CU_ASSERT(!spdk_blob_is_thin_provisioned(blob));
+	CU_ASSERT(spdk_blob_get_esnap_id(blob, &id, &id_len) == -EINVAL);
+	CU_ASSERT(g_ut_esnap_channels == 0);
+	CU_ASSERT(destroyed == 1);
+
+	spdk_blob_io_read(blob, channel, payload, 4, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_esnap_content_is(payload, cluster_sz, cluster_sz));
+	spdk_blob_io_read(blob, channel, payload, 8, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(payload[SPDK_BS_PAGE_SIZE] == 0xE5);
+	spdk_blob_io_read(blob, channel, payload, 16, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload, zero, sizeof(payload)) == 0);
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(destroyed == 1);
+
+	/* No longer an external snapshot clone after reload */
+	ut_bs_reload(&bs, &bs_opts);
+	destroyed = 0;
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	CU_ASSERT(!spdk_blob_is_esnap_clone(g_blob));
+	spdk_blob_close(g_blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(destroyed == 0);
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+	g_blob = NULL;
+	g_blobid = SPDK_BLOBID_INVALID;
+}
+
+static void
+blob_esnap_clone_degraded(void)
+{
+	struct spdk_blob_store *bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_bs_opts bs_opts;
+	struct spdk_blob_opts blob_opts;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	spdk_blob_id blobid;
+	uint64_t cluster_sz;
+	uint32_t destroyed = 0;
+	uint8_t payload[SPDK_BS_PAGE_SIZE * 4];
+
+	dev = init_dev();
+	spdk_bs_opts_init(&bs_opts);
+	bs_opts.cluster_sz = SPDK_BS_PAGE_SIZE * 4;
+	bs_opts.esnap_bs_dev_create = ut_esnap_dev_create;
+	bs_opts.esnap_ctx = &destroyed;
+	spdk_bs_init(dev, &bs_opts, bs_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_bs != NULL);
+	bs = g_bs;
+	cluster_sz = bs_opts.cluster_sz;
+	g_ut_esnap_channels = 0;
+
+	ut_spdk_blob_opts_init(&blob_opts);
+	blob_opts.num_clusters = 4;
+	blob_opts.esnap_id = "esnap";
+	blob_opts.esnap_id_len = sizeof("esnap");
+	blob = ut_blob_create_and_open(bs, &blob_opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(!spdk_blob_is_degraded(blob));
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Without its external snapshot the blob still loads and opens, degraded */
+	g_ut_esnap_missing = true;
+	ut_bs_reload(&bs, &bs_opts);
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	CU_ASSERT(spdk_blob_is_esnap_clone(blob));
+	CU_ASSERT(spdk_blob_is_degraded(blob));
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+	spdk_blob_io_read(blob, channel, payload, 0, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EIO);
+	memset(payload, 0xE5, SPDK_BS_PAGE_SIZE);
+	spdk_blob_io_write(blob, channel, payload, 1, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno != 0);
+	CU_ASSERT(g_ut_esnap_channels == 0);
+
+	/* The external snapshot is set once it shows up */
+	destroyed = 0;
+	spdk_blob_set_esnap_bs_dev(blob, ut_esnap_dev_alloc(&destroyed), blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(!spdk_blob_is_degraded(blob));
+	spdk_blob_io_read(blob, channel, payload, 4, 4, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(ut_esnap_content_is(payload, cluster_sz, cluster_sz));
+	CU_ASSERT(g_ut_esnap_channels == 1);
+
+	/* Only once */
+	spdk_blob_set_esnap_bs_dev(blob, ut_esnap_dev_alloc(&destroyed), blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EEXIST);
+	CU_ASSERT(destroyed == 1);
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(destroyed == 2);
+	CU_ASSERT(g_ut_esnap_channels == 0);
+	g_ut_esnap_missing = false;
+
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+	g_blob = NULL;
+	g_blobid = SPDK_BLOBID_INVALID;
+}
+
+static void
+blob_flags(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	spdk_blob_id blobid_invalid, blobid_data_ro, blobid_md_ro;
+	struct spdk_blob *blob_invalid, *blob_data_ro, *blob_md_ro;
+	struct spdk_blob_opts blob_opts;
+	int rc;
+
+	/* Create three blobs - one each for testing invalid, data_ro and md_ro flags. */
+	blob_invalid = ut_blob_create_and_open(bs, NULL);
+	blobid_invalid = spdk_blob_get_id(blob_invalid);
+
+	blob_data_ro = ut_blob_create_and_open(bs, NULL);
+	blobid_data_ro = spdk_blob_get_id(blob_data_ro);
+
+	ut_spdk_blob_opts_init(&blob_opts);
+	blob_opts.clear_method = BLOB_CLEAR_WITH_WRITE_ZEROES;
+	blob_md_ro = ut_blob_create_and_open(bs, &blob_opts);
+	blobid_md_ro = spdk_blob_get_id(blob_md_ro);
+	CU_ASSERT((blob_md_ro->md_ro_flags & SPDK_BLOB_MD_RO_FLAGS_MASK) == BLOB_CLEAR_WITH_WRITE_ZEROES);
+
+	/* Change the size of blob_data_ro to check if flags are serialized
+	 * when blob has non zero number of extents */
+	spdk_blob_resize(blob_data_ro, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Set the xattr to check if flags are serialized
+	 * when blob has non zero number of xattrs */
+	rc = spdk_blob_set_xattr(blob_md_ro, "name", "log.txt", strlen("log.txt") + 1);
+	CU_ASSERT(rc == 0);
+
+	blob_invalid->invalid_flags = (1ULL << 63);
+	blob_invalid->state = SPDK_BLOB_STATE_DIRTY;
+	blob_data_ro->data_ro_flags = (1ULL << 62);
+	blob_data_ro->state = SPDK_BLOB_STATE_DIRTY;
+	blob_md_ro->md_ro_flags = (1ULL << 61);
+	blob_md_ro->state = SPDK_BLOB_STATE_DIRTY;
+
+	g_bserrno = -1;
+	spdk_blob_sync_md(blob_invalid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bserrno = -1;
+	spdk_blob_sync_md(blob_data_ro, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bserrno = -1;
+	spdk_blob_sync_md(blob_md_ro, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	g_bserrno = -1;
+	spdk_blob_close(blob_invalid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	blob_invalid = NULL;
+	g_bserrno = -1;
+	spdk_blob_close(blob_data_ro, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	blob_data_ro = NULL;
+	g_bserrno = -1;
+	spdk_blob_close(blob_md_ro, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	blob_md_ro = NULL;
+
+	g_blob = NULL;
+	g_blobid = SPDK_BLOBID_INVALID;
+
+	ut_bs_reload(&bs, NULL);
+
+	g_blob = NULL;
+	g_bserrno = 0;
+	spdk_bs_open_blob(bs, blobid_invalid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno != 0);
+	CU_ASSERT(g_blob == NULL);
+
+	g_blob = NULL;
+	g_bserrno = -1;
+	spdk_bs_open_blob(bs, blobid_data_ro, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob_data_ro = g_blob;
+	/* If an unknown data_ro flag was found, the blob should be marked both data and md read-only. */
+	CU_ASSERT(blob_data_ro->data_ro == true);
+	CU_ASSERT(blob_data_ro->md_ro == true);
+	CU_ASSERT(spdk_blob_get_num_clusters(blob_data_ro) == 10);
+
+	g_blob = NULL;
+	g_bserrno = -1;
+	spdk_bs_open_blob(bs, blobid_md_ro, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob_md_ro = g_blob;
+	CU_ASSERT(blob_md_ro->data_ro == false);
+	CU_ASSERT(blob_md_ro->md_ro == true);
+
+	g_bserrno = -1;
+	spdk_blob_sync_md(blob_md_ro, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	ut_blob_close_and_delete(bs, blob_data_ro);
+	ut_blob_close_and_delete(bs, blob_md_ro);
+}
+
+static void
+bs_version(void)
+{
+	struct spdk_bs_super_block *super;
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_bs_dev *dev;
+	struct spdk_blob *blob;
+	struct spdk_blob_opts blob_opts;
+	spdk_blob_id blobid;
+
+	/* Unload the blob store */
+	spdk_bs_unload(bs, bs_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	g_bs = NULL;
+
+	/*
+	 * Change the bs version on disk.  This will allow us to
+	 *  test that the version does not get modified automatically
+	 *  when loading and unloading the blobstore.
+	 */
+	super = (struct spdk_bs_super_block *)&g_dev_buffer[0];
+	CU_ASSERT(super->version == SPDK_BS_VERSION);
+	CU_ASSERT(super->clean == 1);
+	super->version = 2;
+	/*
+	 * Version 2 metadata does not have a used blobid mask, so clear
+	 *  those fields in the super block and zero the corresponding
+	 *  region on "disk".  We will use this to ensure blob IDs are
+	 *  correctly reconstructed.
 	 */
 	memset(&g_dev_buffer[super->used_blobid_mask_start * SPDK_BS_PAGE_SIZE], 0,
 	       super->used_blobid_mask_len * SPDK_BS_PAGE_SIZE);
@@ -3836,32 +4430,231 @@ blob_thin_prov_rw(void)
 	CU_ASSERT(free_clusters - 2 == spdk_bs_free_cluster_count(bs));
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(free_clusters - 1 == spdk_bs_free_cluster_count(bs));
-	/* For thin-provisioned blob we need to write 20 pages plus one page metadata and
-	 * read 0 bytes */
-	if (g_use_extent_table) {
-		/* Add one more page for EXTENT_PAGE write */
-		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 22);
-	} else {
-		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 21);
+	CU_ASSERT(free_clusters - 1 == spdk_bs_free_cluster_count(bs));
+	/* For thin-provisioned blob we need to write 20 pages plus one page metadata and
+	 * read 0 bytes */
+	if (g_use_extent_table) {
+		/* Add one more page for EXTENT_PAGE write */
+		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 22);
+	} else {
+		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 21);
+	}
+	CU_ASSERT(g_dev_read_bytes - read_bytes == 0);
+
+	spdk_blob_io_read(blob, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
+
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	set_thread(1);
+	spdk_bs_free_io_channel(channel_thread1);
+	set_thread(0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	g_blob = NULL;
+	g_blobid = 0;
+}
+
+static void
+blob_thin_prov_cluster_reserve(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	struct spdk_bs_channel *bs_channel;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid;
+	uint64_t free_clusters;
+	uint64_t io_units_per_cluster;
+	uint64_t page_size;
+	uint64_t write_bytes;
+	uint8_t payload[4096];
+	uint64_t i;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	page_size = spdk_bs_get_page_size(bs);
+	io_units_per_cluster = spdk_bs_get_cluster_size(bs) / spdk_bs_get_io_unit_size(bs);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 4;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	/* Use a thread other than the md thread, so that the channel is not shared
+	 * with the blobstore */
+	set_thread(1);
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+	bs_channel = spdk_io_channel_get_ctx(channel);
+
+	/* The first allocation fills the reserve of the channel. Clusters held in
+	 * the reserve are still reported as free. */
+	memset(payload, 0xE5, sizeof(payload));
+	spdk_blob_io_write(blob, channel, payload, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.clusters[0] != 0);
+	CU_ASSERT(bs_channel->num_reserved_clusters > 0);
+	CU_ASSERT(bs->num_reserved_clusters == bs_channel->num_reserved_clusters);
+	CU_ASSERT(free_clusters - 1 == spdk_bs_free_cluster_count(bs));
+
+	/* Allocations of different clusters on one channel proceed in parallel,
+	 * and the updates of a single extent page are written together. */
+	write_bytes = g_dev_write_bytes;
+	for (i = 1; i < 4; i++) {
+		spdk_blob_io_write(blob, channel, payload, i * io_units_per_cluster, 1,
+				   blob_op_complete, NULL);
+	}
+	CU_ASSERT(free_clusters - 4 == spdk_bs_free_cluster_count(bs));
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	/* The reserve holds contiguous clusters and hands them out in ascending order,
+	 * so sequential first writes land on sequential clusters, also across a refill. */
+	for (i = 1; i < 4; i++) {
+		CU_ASSERT(blob->active.clusters[i] != 0);
+		CU_ASSERT(blob->active.clusters[i] == blob->active.clusters[i - 1] + io_units_per_cluster);
+	}
+	if (g_use_extent_table) {
+		/* Three data pages and two writes of the extent page, instead of three */
+		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 5);
+	}
+	CU_ASSERT(free_clusters - 4 == spdk_bs_free_cluster_count(bs));
+
+	/* Freeing the channel gives the reserve back */
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	set_thread(0);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+	CU_ASSERT(bs->num_free_clusters == free_clusters - 4);
+
+	/* A channel on the md thread is shared with the blobstore and keeps its
+	 * reserve until unload. Reserved clusters must not be persisted as used. */
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+	spdk_blob_resize(blob, 5, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_io_write(blob, channel, payload, 4 * io_units_per_cluster, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	CU_ASSERT(bs->num_reserved_clusters > 0);
+
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	ut_bs_reload(&bs, NULL);
+	CU_ASSERT(free_clusters - 5 == spdk_bs_free_cluster_count(bs));
+
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+	for (i = 0; i < 5; i++) {
+		CU_ASSERT(blob->active.clusters[i] != 0);
+	}
+
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+}
+
+static void
+blob_thin_prov_cluster_reserve_full(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob, *thick;
+	struct spdk_io_channel *md_channel, *channel;
+	struct spdk_bs_channel *bs_channel;
+	struct spdk_blob_opts opts;
+	uint64_t free_clusters;
+	uint64_t io_units_per_cluster;
+	uint8_t payload[4096];
+	uint64_t i;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	io_units_per_cluster = spdk_bs_get_cluster_size(bs) / spdk_bs_get_io_unit_size(bs);
+	memset(payload, 0xE5, sizeof(payload));
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = free_clusters;
+	blob = ut_blob_create_and_open(bs, &opts);
+
+	/* Fill the reserves of the md thread's channel and of another one */
+	md_channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(md_channel != NULL);
+	set_thread(1);
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+	bs_channel = spdk_io_channel_get_ctx(channel);
+	spdk_blob_io_write(blob, channel, payload, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	set_thread(0);
+	spdk_blob_io_write(blob, md_channel, payload, io_units_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(bs_channel->num_reserved_clusters > 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 2);
+
+	/* A thick blob can use every cluster reported as free, including the
+	 * ones reserved by a channel of another thread */
+	ut_spdk_blob_opts_init(&opts);
+	opts.num_clusters = free_clusters - 2;
+	thick = ut_blob_create_and_open(bs, &opts);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == 0);
+	CU_ASSERT(bs->num_reserved_clusters == 0);
+
+	/* With the pool empty, a thin allocation takes a cluster reserved by
+	 * another channel */
+	ut_blob_close_and_delete(bs, thick);
+	set_thread(1);
+	spdk_blob_io_write(blob, channel, payload, 2 * io_units_per_cluster, 1,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	set_thread(0);
+	SPDK_CU_ASSERT_FATAL(bs_channel->num_reserved_clusters > 0);
+	ut_spdk_blob_opts_init(&opts);
+	opts.num_clusters = bs->num_free_clusters;
+	thick = ut_blob_create_and_open(bs, &opts);
+	CU_ASSERT(bs->num_free_clusters == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == bs_channel->num_reserved_clusters);
+
+	/* The md thread's channel allocates until no cluster is left anywhere */
+	i = 3;
+	while (spdk_bs_free_cluster_count(bs) > 0) {
+		free_clusters = spdk_bs_free_cluster_count(bs);
+		spdk_blob_io_write(blob, md_channel, payload, i++ * io_units_per_cluster, 1,
+				   blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
 	}
-	CU_ASSERT(g_dev_read_bytes - read_bytes == 0);
-
-	spdk_blob_io_read(blob, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	CU_ASSERT(bs_channel->num_reserved_clusters == 0);
+	spdk_blob_io_write(blob, md_channel, payload, i * io_units_per_cluster, 1,
+			   blob_op_complete, NULL);
 	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
-
-	ut_blob_close_and_delete(bs, blob);
-	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+	CU_ASSERT(g_bserrno != 0);
 
+	spdk_bs_free_io_channel(md_channel);
 	set_thread(1);
-	spdk_bs_free_io_channel(channel_thread1);
-	set_thread(0);
 	spdk_bs_free_io_channel(channel);
 	poll_threads();
-	g_blob = NULL;
-	g_blobid = 0;
+	set_thread(0);
+	ut_blob_close_and_delete(bs, thick);
+	ut_blob_close_and_delete(bs, blob);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == bs->total_data_clusters);
 }
 
 static void
@@ -4140,29 +4933,276 @@ bs_load_iter_test(void)
 }
 
 static void
-blob_snapshot_rw(void)
+blob_snapshot_rw(void)
+{
+	static const uint8_t zero[10 * 4096] = { 0 };
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob, *snapshot;
+	struct spdk_io_channel *channel;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid, snapshotid;
+	uint64_t free_clusters;
+	uint64_t cluster_size;
+	uint64_t page_size;
+	uint8_t payload_read[10 * 4096];
+	uint8_t payload_write[10 * 4096];
+	uint64_t write_bytes;
+	uint64_t read_bytes;
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	cluster_size = spdk_bs_get_cluster_size(bs);
+	page_size = spdk_bs_get_page_size(bs);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 5;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
+
+	memset(payload_read, 0xFF, sizeof(payload_read));
+	spdk_blob_io_read(blob, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(zero, payload_read, 10 * 4096) == 0);
+
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	spdk_blob_io_write(blob, channel, payload_write, 4, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(free_clusters != spdk_bs_free_cluster_count(bs));
+
+	/* Create snapshot from blob */
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+	snapshotid = g_blobid;
+
+	spdk_bs_open_blob(bs, snapshotid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	snapshot = g_blob;
+	CU_ASSERT(snapshot->data_ro == true);
+	CU_ASSERT(snapshot->md_ro == true);
+
+	CU_ASSERT(spdk_blob_get_num_clusters(snapshot) == 5);
+
+	write_bytes = g_dev_write_bytes;
+	read_bytes = g_dev_read_bytes;
+
+	memset(payload_write, 0xAA, sizeof(payload_write));
+	spdk_blob_io_write(blob, channel, payload_write, 4, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(free_clusters != spdk_bs_free_cluster_count(bs));
+
+	/* For a clone we need to allocate and copy one cluster, update one page of metadata
+	 * and then write 10 pages of payload.
+	 */
+	if (g_use_extent_table) {
+		/* Add one more page for EXTENT_PAGE write */
+		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 12 + cluster_size);
+	} else {
+		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 11 + cluster_size);
+	}
+	CU_ASSERT(g_dev_read_bytes - read_bytes == cluster_size);
+
+	spdk_blob_io_read(blob, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
+
+	/* Data on snapshot should not change after write to clone */
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	spdk_blob_io_read(snapshot, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
+
+	ut_blob_close_and_delete(bs, blob);
+	ut_blob_close_and_delete(bs, snapshot);
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+	g_blob = NULL;
+	g_blobid = 0;
+}
+
+static void
+blob_snapshot_rw_iov(void)
+{
+	static const uint8_t zero[10 * 4096] = { 0 };
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob, *snapshot;
+	struct spdk_io_channel *channel;
+	struct spdk_blob_opts opts;
+	spdk_blob_id blobid, snapshotid;
+	uint64_t free_clusters;
+	uint8_t payload_read[10 * 4096];
+	uint8_t payload_write[10 * 4096];
+	struct iovec iov_read[3];
+	struct iovec iov_write[3];
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+
+	channel = spdk_bs_alloc_io_channel(bs);
+	CU_ASSERT(channel != NULL);
+
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 5;
+
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
+
+	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
+
+	/* Create snapshot from blob */
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+	snapshotid = g_blobid;
+
+	spdk_bs_open_blob(bs, snapshotid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	snapshot = g_blob;
+	CU_ASSERT(snapshot->data_ro == true);
+	CU_ASSERT(snapshot->md_ro == true);
+	CU_ASSERT(spdk_blob_get_num_clusters(snapshot) == 5);
+
+	/* Payload should be all zeros from unallocated clusters */
+	memset(payload_read, 0xAA, sizeof(payload_read));
+	iov_read[0].iov_base = payload_read;
+	iov_read[0].iov_len = 3 * 4096;
+	iov_read[1].iov_base = payload_read + 3 * 4096;
+	iov_read[1].iov_len = 4 * 4096;
+	iov_read[2].iov_base = payload_read + 7 * 4096;
+	iov_read[2].iov_len = 3 * 4096;
+	spdk_blob_io_readv(blob, channel, iov_read, 3, 250, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(zero, payload_read, 10 * 4096) == 0);
+
+	memset(payload_write, 0xE5, sizeof(payload_write));
+	iov_write[0].iov_base = payload_write;
+	iov_write[0].iov_len = 1 * 4096;
+	iov_write[1].iov_base = payload_write + 1 * 4096;
+	iov_write[1].iov_len = 5 * 4096;
+	iov_write[2].iov_base = payload_write + 6 * 4096;
+	iov_write[2].iov_len = 4 * 4096;
+
+	spdk_blob_io_writev(blob, channel, iov_write, 3, 250, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	memset(payload_read, 0xAA, sizeof(payload_read));
+	iov_read[0].iov_base = payload_read;
+	iov_read[0].iov_len = 3 * 4096;
+	iov_read[1].iov_base = payload_read + 3 * 4096;
+	iov_read[1].iov_len = 4 * 4096;
+	iov_read[2].iov_base = payload_read + 7 * 4096;
+	iov_read[2].iov_len = 3 * 4096;
+	spdk_blob_io_readv(blob, channel, iov_read, 3, 250, 10, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
+
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
+
+	ut_blob_close_and_delete(bs, blob);
+	ut_blob_close_and_delete(bs, snapshot);
+}
+
+/**
+ * Inflate / decouple parent rw unit tests.
+ *
+ * --------------
+ * original blob:         0         1         2         3         4
+ *                   ,---------+---------+---------+---------+---------.
+ *         snapshot  |xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|    -    |
+ *                   +---------+---------+---------+---------+---------+
+ *         snapshot2 |    -    |yyyyyyyyy|    -    |yyyyyyyyy|    -    |
+ *                   +---------+---------+---------+---------+---------+
+ *         blob      |    -    |zzzzzzzzz|    -    |    -    |    -    |
+ *                   '---------+---------+---------+---------+---------'
+ *                   .         .         .         .         .         .
+ * --------          .         .         .         .         .         .
+ * inflate:          .         .         .         .         .         .
+ *                   ,---------+---------+---------+---------+---------.
+ *         blob      |xxxxxxxxx|zzzzzzzzz|xxxxxxxxx|yyyyyyyyy|000000000|
+ *                   '---------+---------+---------+---------+---------'
+ *
+ *         NOTE: needs to allocate 4 clusters, thin provisioning removed, dependency
+ *               on snapshot2 and snapshot removed .         .         .
+ *                   .         .         .         .         .         .
+ * ----------------  .         .         .         .         .         .
+ * decouple parent:  .         .         .         .         .         .
+ *                   ,---------+---------+---------+---------+---------.
+ *         snapshot  |xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|    -    |
+ *                   +---------+---------+---------+---------+---------+
+ *         blob      |    -    |zzzzzzzzz|    -    |yyyyyyyyy|    -    |
+ *                   '---------+---------+---------+---------+---------'
+ *
+ *         NOTE: needs to allocate 1 cluster, 3 clusters unallocated, dependency
+ *               on snapshot2 removed and on snapshot still exists. Snapshot2
+ *               should remain a clone of snapshot.
+ */
+static void
+_blob_inflate_rw(bool decouple_parent)
 {
-	static const uint8_t zero[10 * 4096] = { 0 };
 	struct spdk_blob_store *bs = g_bs;
-	struct spdk_blob *blob, *snapshot;
+	struct spdk_blob *blob, *snapshot, *snapshot2;
 	struct spdk_io_channel *channel;
 	struct spdk_blob_opts opts;
-	spdk_blob_id blobid, snapshotid;
+	spdk_blob_id blobid, snapshotid, snapshot2id;
 	uint64_t free_clusters;
 	uint64_t cluster_size;
-	uint64_t page_size;
-	uint8_t payload_read[10 * 4096];
-	uint8_t payload_write[10 * 4096];
-	uint64_t write_bytes;
-	uint64_t read_bytes;
+
+	uint64_t payload_size;
+	uint8_t *payload_read;
+	uint8_t *payload_write;
+	uint8_t *payload_clone;
+
+	uint64_t pages_per_cluster;
+	uint64_t pages_per_payload;
+
+	int i;
+	spdk_blob_id ids[2];
+	size_t count;
 
 	free_clusters = spdk_bs_free_cluster_count(bs);
 	cluster_size = spdk_bs_get_cluster_size(bs);
-	page_size = spdk_bs_get_page_size(bs);
+	pages_per_cluster = cluster_size / spdk_bs_get_page_size(bs);
+	pages_per_payload = pages_per_cluster * 5;
+
+	payload_size = cluster_size * 5;
+
+	payload_read = malloc(payload_size);
+	SPDK_CU_ASSERT_FATAL(payload_read != NULL);
+
+	payload_write = malloc(payload_size);
+	SPDK_CU_ASSERT_FATAL(payload_write != NULL);
+
+	payload_clone = malloc(payload_size);
+	SPDK_CU_ASSERT_FATAL(payload_clone != NULL);
 
 	channel = spdk_bs_alloc_io_channel(bs);
-	CU_ASSERT(channel != NULL);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
 
+	/* Create blob */
 	ut_spdk_blob_opts_init(&opts);
 	opts.thin_provision = true;
 	opts.num_clusters = 5;
@@ -4173,19 +5213,24 @@ blob_snapshot_rw(void)
 
 	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
 
-	memset(payload_read, 0xFF, sizeof(payload_read));
-	spdk_blob_io_read(blob, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	/* 1) Initial read should return zeroed payload */
+	memset(payload_read, 0xFF, payload_size);
+	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
+			  blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(zero, payload_read, 10 * 4096) == 0);
+	CU_ASSERT(spdk_mem_all_zero(payload_read, payload_size));
 
-	memset(payload_write, 0xE5, sizeof(payload_write));
-	spdk_blob_io_write(blob, channel, payload_write, 4, 10, blob_op_complete, NULL);
+	/* Fill whole blob with a pattern, except last cluster (to be sure it
+	 * isn't allocated) */
+	memset(payload_write, 0xE5, payload_size - cluster_size);
+	spdk_blob_io_write(blob, channel, payload_write, 0, pages_per_payload -
+			   pages_per_cluster, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
 	CU_ASSERT(free_clusters != spdk_bs_free_cluster_count(bs));
 
-	/* Create snapshot from blob */
+	/* 2) Create snapshot from blob (first level) */
 	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
@@ -4202,451 +5247,760 @@ blob_snapshot_rw(void)
 
 	CU_ASSERT(spdk_blob_get_num_clusters(snapshot) == 5);
 
-	write_bytes = g_dev_write_bytes;
-	read_bytes = g_dev_read_bytes;
+	/* Write every second cluster with a pattern.
+	 *
+	 * Last cluster shouldn't be written, to be sure that snapshot nor clone
+	 * doesn't allocate it.
+	 *
+	 * payload_clone stores expected result on "blob" read at the time and
+	 * is used only to check data consistency on clone before and after
+	 * inflation. Initially we fill it with a backing snapshots pattern
+	 * used before.
+	 */
+	memset(payload_clone, 0xE5, payload_size - cluster_size);
+	memset(payload_clone + payload_size - cluster_size, 0x00, cluster_size);
+	memset(payload_write, 0xAA, payload_size);
+	for (i = 1; i < 5; i += 2) {
+		spdk_blob_io_write(blob, channel, payload_write, i * pages_per_cluster,
+				   pages_per_cluster, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
 
-	memset(payload_write, 0xAA, sizeof(payload_write));
-	spdk_blob_io_write(blob, channel, payload_write, 4, 10, blob_op_complete, NULL);
+		/* Update expected result */
+		memcpy(payload_clone + (cluster_size * i), payload_write,
+		       cluster_size);
+	}
+	CU_ASSERT(free_clusters != spdk_bs_free_cluster_count(bs));
+
+	/* Check data consistency on clone */
+	memset(payload_read, 0xFF, payload_size);
+	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
+			  blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(free_clusters != spdk_bs_free_cluster_count(bs));
+	CU_ASSERT(memcmp(payload_clone, payload_read, payload_size) == 0);
 
-	/* For a clone we need to allocate and copy one cluster, update one page of metadata
-	 * and then write 10 pages of payload.
-	 */
-	if (g_use_extent_table) {
-		/* Add one more page for EXTENT_PAGE write */
-		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 12 + cluster_size);
+	/* 3) Create second levels snapshot from blob */
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+	snapshot2id = g_blobid;
+
+	spdk_bs_open_blob(bs, snapshot2id, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	snapshot2 = g_blob;
+	CU_ASSERT(snapshot2->data_ro == true);
+	CU_ASSERT(snapshot2->md_ro == true);
+
+	CU_ASSERT(spdk_blob_get_num_clusters(snapshot2) == 5);
+
+	CU_ASSERT(snapshot2->parent_id == snapshotid);
+
+	/* Write one cluster on the top level blob. This cluster (1) covers
+	 * already allocated cluster in the snapshot2, so shouldn't be inflated
+	 * at all */
+	spdk_blob_io_write(blob, channel, payload_write, pages_per_cluster,
+			   pages_per_cluster, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Update expected result */
+	memcpy(payload_clone + cluster_size, payload_write, cluster_size);
+
+	/* Check data consistency on clone */
+	memset(payload_read, 0xFF, payload_size);
+	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
+			  blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_clone, payload_read, payload_size) == 0);
+
+
+	/* Close all blobs */
+	spdk_blob_close(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_blob_close(snapshot2, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	spdk_blob_close(snapshot, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+
+	/* Check snapshot-clone relations */
+	count = 2;
+	CU_ASSERT(spdk_blob_get_clones(bs, snapshotid, ids, &count) == 0);
+	CU_ASSERT(count == 1);
+	CU_ASSERT(ids[0] == snapshot2id);
+
+	count = 2;
+	CU_ASSERT(spdk_blob_get_clones(bs, snapshot2id, ids, &count) == 0);
+	CU_ASSERT(count == 1);
+	CU_ASSERT(ids[0] == blobid);
+
+	CU_ASSERT(spdk_blob_get_parent_snapshot(bs, blobid) == snapshot2id);
+
+	free_clusters = spdk_bs_free_cluster_count(bs);
+	if (!decouple_parent) {
+		/* Do full blob inflation */
+		spdk_bs_inflate_blob(bs, channel, blobid, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+
+		/* All clusters should be inflated (except one already allocated
+		 * in a top level blob) */
+		CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 4);
+
+		/* Check if relation tree updated correctly */
+		count = 2;
+		CU_ASSERT(spdk_blob_get_clones(bs, snapshotid, ids, &count) == 0);
+
+		/* snapshotid have one clone */
+		CU_ASSERT(count == 1);
+		CU_ASSERT(ids[0] == snapshot2id);
+
+		/* snapshot2id have no clones */
+		count = 2;
+		CU_ASSERT(spdk_blob_get_clones(bs, snapshot2id, ids, &count) == 0);
+		CU_ASSERT(count == 0);
+
+		CU_ASSERT(spdk_blob_get_parent_snapshot(bs, blobid) == SPDK_BLOBID_INVALID);
 	} else {
-		CU_ASSERT(g_dev_write_bytes - write_bytes == page_size * 11 + cluster_size);
+		/* Decouple parent of blob */
+		spdk_bs_blob_decouple_parent(bs, channel, blobid, blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+
+		/* Only one cluster from a parent should be inflated (second one
+		 * is covered by a cluster written on a top level blob, and
+		 * already allocated) */
+		CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+
+		/* Check if relation tree updated correctly */
+		count = 2;
+		CU_ASSERT(spdk_blob_get_clones(bs, snapshotid, ids, &count) == 0);
+
+		/* snapshotid have two clones now */
+		CU_ASSERT(count == 2);
+		CU_ASSERT(ids[0] == blobid || ids[1] == blobid);
+		CU_ASSERT(ids[0] == snapshot2id || ids[1] == snapshot2id);
+
+		/* snapshot2id have no clones */
+		count = 2;
+		CU_ASSERT(spdk_blob_get_clones(bs, snapshot2id, ids, &count) == 0);
+		CU_ASSERT(count == 0);
+
+		CU_ASSERT(spdk_blob_get_parent_snapshot(bs, blobid) == snapshotid);
 	}
-	CU_ASSERT(g_dev_read_bytes - read_bytes == cluster_size);
 
-	spdk_blob_io_read(blob, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	/* Try to delete snapshot2 (should pass) */
+	spdk_bs_delete_blob(bs, snapshot2id, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
 
-	/* Data on snapshot should not change after write to clone */
-	memset(payload_write, 0xE5, sizeof(payload_write));
-	spdk_blob_io_read(snapshot, channel, payload_read, 4, 10, blob_op_complete, NULL);
+	/* Try to delete base snapshot */
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
 
-	ut_blob_close_and_delete(bs, blob);
-	ut_blob_close_and_delete(bs, snapshot);
+	/* Reopen blob after snapshot deletion */
+	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+	blob = g_blob;
+
+	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
+
+	/* Check data consistency on inflated blob */
+	memset(payload_read, 0xFF, payload_size);
+	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
+			  blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(memcmp(payload_clone, payload_read, payload_size) == 0);
 
 	spdk_bs_free_io_channel(channel);
 	poll_threads();
-	g_blob = NULL;
-	g_blobid = 0;
+
+	free(payload_read);
+	free(payload_write);
+	free(payload_clone);
+
+	ut_blob_close_and_delete(bs, blob);
+}
+
+static void
+blob_inflate_rw(void)
+{
+	_blob_inflate_rw(false);
+	_blob_inflate_rw(true);
 }
 
 static void
-blob_snapshot_rw_iov(void)
+blob_copy_on_read(void)
 {
-	static const uint8_t zero[10 * 4096] = { 0 };
 	struct spdk_blob_store *bs = g_bs;
 	struct spdk_blob *blob, *snapshot;
-	struct spdk_io_channel *channel;
+	struct spdk_io_channel *channel, *channel_thread1;
 	struct spdk_blob_opts opts;
 	spdk_blob_id blobid, snapshotid;
-	uint64_t free_clusters;
-	uint8_t payload_read[10 * 4096];
-	uint8_t payload_write[10 * 4096];
-	struct iovec iov_read[3];
-	struct iovec iov_write[3];
+	uint64_t free_clusters, cluster_size, pages_per_cluster;
+	uint8_t *payload;
 
-	free_clusters = spdk_bs_free_cluster_count(bs);
+	cluster_size = spdk_bs_get_cluster_size(bs);
+	pages_per_cluster = cluster_size / spdk_bs_get_page_size(bs);
+	payload = malloc(cluster_size);
+	SPDK_CU_ASSERT_FATAL(payload != NULL);
 
 	channel = spdk_bs_alloc_io_channel(bs);
-	CU_ASSERT(channel != NULL);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
 
+	/* Fill a blob with a pattern and turn it into a clone of its snapshot */
 	ut_spdk_blob_opts_init(&opts);
-	opts.thin_provision = true;
-	opts.num_clusters = 5;
-
+	opts.num_clusters = 4;
 	blob = ut_blob_create_and_open(bs, &opts);
 	blobid = spdk_blob_get_id(blob);
-	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
 
-	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
+	memset(payload, 0xA5, cluster_size);
+	spdk_blob_io_write(blob, channel, payload, 0, pages_per_cluster, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	memset(payload, 0x5A, cluster_size);
+	spdk_blob_io_write(blob, channel, payload, pages_per_cluster, pages_per_cluster,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
 
-	/* Create snapshot from blob */
 	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
 	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
 	snapshotid = g_blobid;
+	free_clusters = spdk_bs_free_cluster_count(bs);
 
+	/* Snapshots are read only, their clusters are never copied */
 	spdk_bs_open_blob(bs, snapshotid, blob_op_with_handle_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
 	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
 	snapshot = g_blob;
-	CU_ASSERT(snapshot->data_ro == true);
-	CU_ASSERT(snapshot->md_ro == true);
-	CU_ASSERT(spdk_blob_get_num_clusters(snapshot) == 5);
+	spdk_blob_set_copy_on_read(snapshot, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EPERM);
+	spdk_blob_close(snapshot, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
 
-	/* Payload should be all zeros from unallocated clusters */
-	memset(payload_read, 0xAA, sizeof(payload_read));
-	iov_read[0].iov_base = payload_read;
-	iov_read[0].iov_len = 3 * 4096;
-	iov_read[1].iov_base = payload_read + 3 * 4096;
-	iov_read[1].iov_len = 4 * 4096;
-	iov_read[2].iov_base = payload_read + 7 * 4096;
-	iov_read[2].iov_len = 3 * 4096;
-	spdk_blob_io_readv(blob, channel, iov_read, 3, 250, 10, blob_op_complete, NULL);
+	spdk_blob_set_copy_on_read(blob, UINT16_MAX + 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EINVAL);
+	CU_ASSERT(blob->cor_read_counts == NULL);
+
+	/* Reads go to the snapshot until copy-on-read is enabled */
+	spdk_blob_io_read(blob, channel, payload, 0, pages_per_cluster, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(zero, payload_read, 10 * 4096) == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
 
-	memset(payload_write, 0xE5, sizeof(payload_write));
-	iov_write[0].iov_base = payload_write;
-	iov_write[0].iov_len = 1 * 4096;
-	iov_write[1].iov_base = payload_write + 1 * 4096;
-	iov_write[1].iov_len = 5 * 4096;
-	iov_write[2].iov_base = payload_write + 6 * 4096;
-	iov_write[2].iov_len = 4 * 4096;
+	spdk_blob_set_copy_on_read(blob, 2, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	SPDK_CU_ASSERT_FATAL(blob->cor_read_counts != NULL);
 
-	spdk_blob_io_writev(blob, channel, iov_write, 3, 250, 10, blob_op_complete, NULL);
+	/* The second read of a cluster copies it from the snapshot */
+	memset(payload, 0, cluster_size);
+	spdk_blob_io_read(blob, channel, payload, 0, 1, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(payload[0] == 0xA5);
+	CU_ASSERT(blob->active.clusters[0] == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters);
 
-	memset(payload_read, 0xAA, sizeof(payload_read));
-	iov_read[0].iov_base = payload_read;
-	iov_read[0].iov_len = 3 * 4096;
-	iov_read[1].iov_base = payload_read + 3 * 4096;
-	iov_read[1].iov_len = 4 * 4096;
-	iov_read[2].iov_base = payload_read + 7 * 4096;
-	iov_read[2].iov_len = 3 * 4096;
-	spdk_blob_io_readv(blob, channel, iov_read, 3, 250, 10, blob_op_complete, NULL);
+	spdk_blob_io_read(blob, channel, payload, 1, 1, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(payload_write, payload_read, 10 * 4096) == 0);
+	CU_ASSERT(blob->active.clusters[0] != 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+
+	spdk_blob_io_read(blob, channel, payload, 0, pages_per_cluster, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(payload[0] == 0xA5 && payload[cluster_size - 1] == 0xA5);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+
+	/* Reads from other threads count as well, including vectored ones */
+	set_thread(1);
+	channel_thread1 = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel_thread1 != NULL);
+	spdk_blob_io_read(blob, channel_thread1, payload, pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.clusters[1] == 0);
+	set_thread(0);
+	spdk_blob_io_read(blob, channel, payload, pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.clusters[1] != 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 2);
+
+	memset(payload, 0, cluster_size);
+	spdk_blob_io_read(blob, channel, payload, pages_per_cluster, pages_per_cluster,
+			  blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(payload[0] == 0x5A && payload[cluster_size - 1] == 0x5A);
+
+	/* Clusters allocated in the snapshot are copied whether they were written or not */
+	spdk_blob_io_read(blob, channel, payload, 2 * pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	spdk_blob_io_read(blob, channel, payload, 2 * pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.clusters[2] != 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 3);
+
+	/* Disabling copy-on-read stops counting reads */
+	spdk_blob_set_copy_on_read(blob, 0, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->cor_read_counts == NULL);
+	spdk_blob_io_read(blob, channel, payload, 3 * pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	spdk_blob_io_read(blob, channel, payload, 3 * pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(blob->active.clusters[3] == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 3);
 
+	set_thread(1);
+	spdk_bs_free_io_channel(channel_thread1);
+	set_thread(0);
 	spdk_bs_free_io_channel(channel);
 	poll_threads();
 
 	ut_blob_close_and_delete(bs, blob);
-	ut_blob_close_and_delete(bs, snapshot);
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	free(payload);
 }
 
-/**
- * Inflate / decouple parent rw unit tests.
- *
- * --------------
- * original blob:         0         1         2         3         4
- *                   ,---------+---------+---------+---------+---------.
- *         snapshot  |xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|    -    |
- *                   +---------+---------+---------+---------+---------+
- *         snapshot2 |    -    |yyyyyyyyy|    -    |yyyyyyyyy|    -    |
- *                   +---------+---------+---------+---------+---------+
- *         blob      |    -    |zzzzzzzzz|    -    |    -    |    -    |
- *                   '---------+---------+---------+---------+---------'
- *                   .         .         .         .         .         .
- * --------          .         .         .         .         .         .
- * inflate:          .         .         .         .         .         .
- *                   ,---------+---------+---------+---------+---------.
- *         blob      |xxxxxxxxx|zzzzzzzzz|xxxxxxxxx|yyyyyyyyy|000000000|
- *                   '---------+---------+---------+---------+---------'
- *
- *         NOTE: needs to allocate 4 clusters, thin provisioning removed, dependency
- *               on snapshot2 and snapshot removed .         .         .
- *                   .         .         .         .         .         .
- * ----------------  .         .         .         .         .         .
- * decouple parent:  .         .         .         .         .         .
- *                   ,---------+---------+---------+---------+---------.
- *         snapshot  |xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|xxxxxxxxx|    -    |
- *                   +---------+---------+---------+---------+---------+
- *         blob      |    -    |zzzzzzzzz|    -    |yyyyyyyyy|    -    |
- *                   '---------+---------+---------+---------+---------'
- *
- *         NOTE: needs to allocate 1 cluster, 3 clusters unallocated, dependency
- *               on snapshot2 removed and on snapshot still exists. Snapshot2
- *               should remain a clone of snapshot.
- */
 static void
-_blob_inflate_rw(bool decouple_parent)
+blob_io_stat(void)
 {
 	struct spdk_blob_store *bs = g_bs;
-	struct spdk_blob *blob, *snapshot, *snapshot2;
+	struct spdk_blob *blob;
 	struct spdk_io_channel *channel;
 	struct spdk_blob_opts opts;
-	spdk_blob_id blobid, snapshotid, snapshot2id;
-	uint64_t free_clusters;
-	uint64_t cluster_size;
-
-	uint64_t payload_size;
-	uint8_t *payload_read;
-	uint8_t *payload_write;
-	uint8_t *payload_clone;
-
-	uint64_t pages_per_cluster;
-	uint64_t pages_per_payload;
-
-	int i;
-	spdk_blob_id ids[2];
-	size_t count;
-
-	free_clusters = spdk_bs_free_cluster_count(bs);
-	cluster_size = spdk_bs_get_cluster_size(bs);
-	pages_per_cluster = cluster_size / spdk_bs_get_page_size(bs);
-	pages_per_payload = pages_per_cluster * 5;
-
-	payload_size = cluster_size * 5;
-
-	payload_read = malloc(payload_size);
-	SPDK_CU_ASSERT_FATAL(payload_read != NULL);
-
-	payload_write = malloc(payload_size);
-	SPDK_CU_ASSERT_FATAL(payload_write != NULL);
+	struct spdk_blob_io_stat stat;
+	struct iovec iov[2];
+	spdk_blob_id snapshotid;
+	uint64_t pages_per_cluster, page_size;
+	uint32_t heat[8];
+	uint8_t *payload;
+	int rc;
 
-	payload_clone = malloc(payload_size);
-	SPDK_CU_ASSERT_FATAL(payload_clone != NULL);
+	page_size = spdk_bs_get_page_size(bs);
+	pages_per_cluster = spdk_bs_get_cluster_size(bs) / page_size;
+	payload = calloc(2, page_size);
+	SPDK_CU_ASSERT_FATAL(payload != NULL);
 
 	channel = spdk_bs_alloc_io_channel(bs);
 	SPDK_CU_ASSERT_FATAL(channel != NULL);
 
-	/* Create blob */
 	ut_spdk_blob_opts_init(&opts);
 	opts.thin_provision = true;
-	opts.num_clusters = 5;
-
+	opts.num_clusters = 4;
 	blob = ut_blob_create_and_open(bs, &opts);
-	blobid = spdk_blob_get_id(blob);
-	CU_ASSERT(free_clusters == spdk_bs_free_cluster_count(bs));
 
-	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
+	/* Nothing is counted until the statistics are enabled */
+	spdk_blob_io_write(blob, channel, payload, 3 * pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	rc = spdk_blob_get_io_stat(blob, &stat);
+	CU_ASSERT(rc == -ENOENT);
+	CU_ASSERT(spdk_blob_get_io_heatmap(blob, 0, heat, SPDK_COUNTOF(heat)) == 0);
 
-	/* 1) Initial read should return zeroed payload */
-	memset(payload_read, 0xFF, payload_size);
-	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
-			  blob_op_complete, NULL);
+	spdk_blob_set_io_stat(blob, true, 1, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(spdk_mem_all_zero(payload_read, payload_size));
+	rc = spdk_blob_get_io_stat(blob, &stat);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stat.num_write_ops == 0);
 
-	/* Fill whole blob with a pattern, except last cluster (to be sure it
-	 * isn't allocated) */
-	memset(payload_write, 0xE5, payload_size - cluster_size);
-	spdk_blob_io_write(blob, channel, payload_write, 0, pages_per_payload -
-			   pages_per_cluster, blob_op_complete, NULL);
+	/* A write to a thin provisioned cluster allocates it without copying */
+	spdk_blob_io_write(blob, channel, payload, 0, 1, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(free_clusters != spdk_bs_free_cluster_count(bs));
+	/* Reads of unallocated clusters without a parent are not backing device reads */
+	spdk_blob_io_read(blob, channel, payload, pages_per_cluster, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	rc = spdk_blob_get_io_stat(blob, &stat);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stat.num_write_ops == 1);
+	CU_ASSERT(stat.bytes_written == page_size);
+	CU_ASSERT(stat.num_read_ops == 1);
+	CU_ASSERT(stat.bytes_read == page_size);
+	CU_ASSERT(stat.num_clusters_allocated == 1);
+	CU_ASSERT(stat.num_cow_copies == 0);
+	CU_ASSERT(stat.num_backing_dev_reads == 0);
 
-	/* 2) Create snapshot from blob (first level) */
-	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	/* A vectored write across a cluster boundary counts once per cluster */
+	iov[0].iov_base = payload;
+	iov[0].iov_len = page_size;
+	iov[1].iov_base = payload + page_size;
+	iov[1].iov_len = page_size;
+	spdk_blob_io_writev(blob, channel, iov, 2, pages_per_cluster - 1, 2, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_io_unmap(blob, channel, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_io_write_zeroes(blob, channel, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	rc = spdk_blob_get_io_stat(blob, &stat);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stat.num_write_ops == 3);
+	CU_ASSERT(stat.bytes_written == 3 * page_size);
+	CU_ASSERT(stat.num_unmap_ops == 1);
+	CU_ASSERT(stat.num_write_zeroes_ops == 1);
+	CU_ASSERT(stat.num_clusters_allocated == 2);
+
+	/* Every access is sampled with a sample rate of 1 */
+	memset(heat, 0xFF, sizeof(heat));
+	CU_ASSERT(spdk_blob_get_io_heatmap(blob, 0, heat, SPDK_COUNTOF(heat)) == 4);
+	CU_ASSERT(heat[0] == 4);
+	CU_ASSERT(heat[1] == 2);
+	CU_ASSERT(heat[2] == 0);
+	CU_ASSERT(heat[3] == 0);
+	CU_ASSERT(spdk_blob_get_io_heatmap(blob, 1, heat, 1) == 1);
+	CU_ASSERT(heat[0] == 2);
+	CU_ASSERT(spdk_blob_get_io_heatmap(blob, 4, heat, SPDK_COUNTOF(heat)) == 0);
+
+	/* Once the blob is a clone, reads and writes of unallocated clusters go to the snapshot */
+	spdk_bs_create_snapshot(bs, spdk_blob_get_id(blob), NULL, blob_op_with_id_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
 	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
 	snapshotid = g_blobid;
 
-	spdk_bs_open_blob(bs, snapshotid, blob_op_with_handle_complete, NULL);
+	/* Enabling the statistics again resets them */
+	spdk_blob_set_io_stat(blob, true, 2, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
-	snapshot = g_blob;
-	CU_ASSERT(snapshot->data_ro == true);
-	CU_ASSERT(snapshot->md_ro == true);
-
-	CU_ASSERT(spdk_blob_get_num_clusters(snapshot) == 5);
-
-	/* Write every second cluster with a pattern.
-	 *
-	 * Last cluster shouldn't be written, to be sure that snapshot nor clone
-	 * doesn't allocate it.
-	 *
-	 * payload_clone stores expected result on "blob" read at the time and
-	 * is used only to check data consistency on clone before and after
-	 * inflation. Initially we fill it with a backing snapshots pattern
-	 * used before.
-	 */
-	memset(payload_clone, 0xE5, payload_size - cluster_size);
-	memset(payload_clone + payload_size - cluster_size, 0x00, cluster_size);
-	memset(payload_write, 0xAA, payload_size);
-	for (i = 1; i < 5; i += 2) {
-		spdk_blob_io_write(blob, channel, payload_write, i * pages_per_cluster,
-				   pages_per_cluster, blob_op_complete, NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
+	rc = spdk_blob_get_io_stat(blob, &stat);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stat.num_write_ops == 0);
 
-		/* Update expected result */
-		memcpy(payload_clone + (cluster_size * i), payload_write,
-		       cluster_size);
-	}
-	CU_ASSERT(free_clusters != spdk_bs_free_cluster_count(bs));
+	spdk_blob_io_read(blob, channel, payload, 1, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_io_read(blob, channel, payload, 2, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_io_write(blob, channel, payload, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_io_read(blob, channel, payload, 0, 1, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	rc = spdk_blob_get_io_stat(blob, &stat);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(stat.num_read_ops == 3);
+	CU_ASSERT(stat.num_backing_dev_reads == 2);
+	CU_ASSERT(stat.bytes_backing_dev_read == 2 * page_size);
+	CU_ASSERT(stat.num_clusters_allocated == 1);
+	CU_ASSERT(stat.num_cow_copies == 1);
 
-	/* Check data consistency on clone */
-	memset(payload_read, 0xFF, payload_size);
-	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
-			  blob_op_complete, NULL);
+	/* Only every second read and write is sampled */
+	CU_ASSERT(spdk_blob_get_io_heatmap(blob, 0, heat, SPDK_COUNTOF(heat)) == 4);
+	CU_ASSERT(heat[0] == 1);
+
+	/* The heatmap follows the size of the blob */
+	spdk_blob_resize(blob, 8, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(payload_clone, payload_read, payload_size) == 0);
-
-	/* 3) Create second levels snapshot from blob */
-	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
+	spdk_blob_io_unmap(blob, channel, 7 * pages_per_cluster, 1, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
-	snapshot2id = g_blobid;
-
-	spdk_bs_open_blob(bs, snapshot2id, blob_op_with_handle_complete, NULL);
+	spdk_blob_io_unmap(blob, channel, 7 * pages_per_cluster, 1, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
-	snapshot2 = g_blob;
-	CU_ASSERT(snapshot2->data_ro == true);
-	CU_ASSERT(snapshot2->md_ro == true);
+	CU_ASSERT(spdk_blob_get_io_heatmap(blob, 0, heat, SPDK_COUNTOF(heat)) == 8);
+	CU_ASSERT(heat[7] == 1);
 
-	CU_ASSERT(spdk_blob_get_num_clusters(snapshot2) == 5);
+	spdk_blob_set_io_stat(blob, false, 0, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	rc = spdk_blob_get_io_stat(blob, &stat);
+	CU_ASSERT(rc == -ENOENT);
+	CU_ASSERT(spdk_blob_get_io_heatmap(blob, 0, heat, SPDK_COUNTOF(heat)) == 0);
 
-	CU_ASSERT(snapshot2->parent_id == snapshotid);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
 
-	/* Write one cluster on the top level blob. This cluster (1) covers
-	 * already allocated cluster in the snapshot2, so shouldn't be inflated
-	 * at all */
-	spdk_blob_io_write(blob, channel, payload_write, pages_per_cluster,
-			   pages_per_cluster, blob_op_complete, NULL);
+	ut_blob_close_and_delete(bs, blob);
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
+	free(payload);
+}
 
-	/* Update expected result */
-	memcpy(payload_clone + cluster_size, payload_write, cluster_size);
+static void
+blob_inflate_job(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	struct spdk_blob_opts opts;
+	struct spdk_blob_inflate_opts inflate_opts;
+	struct spdk_blob_inflate_job *job;
+	struct spdk_blob_inflate_progress progress;
+	spdk_blob_id blobid, snapshotid;
+	uint64_t free_clusters, cluster_size;
+	int rc;
 
-	/* Check data consistency on clone */
-	memset(payload_read, 0xFF, payload_size);
-	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
-			  blob_op_complete, NULL);
+	cluster_size = spdk_bs_get_cluster_size(bs);
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+
+	/* Clone with 8 clusters allocated in its snapshot */
+	ut_spdk_blob_opts_init(&opts);
+	opts.num_clusters = 8;
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(payload_clone, payload_read, payload_size) == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+	snapshotid = g_blobid;
+	free_clusters = spdk_bs_free_cluster_count(bs);
 
+	spdk_blob_inflate_opts_init(&inflate_opts);
+	inflate_opts.max_inflight = 0;
+	rc = spdk_bs_inflate_blob_start(bs, channel, blobid, &inflate_opts, blob_op_complete, NULL, &job);
+	CU_ASSERT(rc == -EINVAL);
 
-	/* Close all blobs */
-	spdk_blob_close(blob, blob_op_complete, NULL);
+	/* Two clusters per second */
+	inflate_opts.max_inflight = 2;
+	inflate_opts.max_bytes_per_sec = 2 * cluster_size;
+	g_bserrno = -1;
+	rc = spdk_bs_inflate_blob_start(bs, channel, blobid, &inflate_opts, blob_op_complete, NULL, &job);
+	CU_ASSERT(rc == 0);
+	SPDK_CU_ASSERT_FATAL(job != NULL);
 	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_bserrno == -1);
+	spdk_blob_inflate_job_get_progress(job, &progress);
+	CU_ASSERT(progress.clusters_total == 8);
+	CU_ASSERT(progress.clusters_done == 1);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
 
-	spdk_blob_close(snapshot2, blob_op_complete, NULL);
+	spdk_delay_us(500000);
 	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_inflate_job_get_progress(job, &progress);
+	CU_ASSERT(progress.clusters_done == 2);
+	CU_ASSERT(progress.elapsed_usec == 500000);
+	CU_ASSERT(progress.eta_usec == 1500000);
+	CU_ASSERT(!progress.paused);
 
-	spdk_blob_close(snapshot, blob_op_complete, NULL);
+	/* Nothing is copied while paused, and the time doesn't count */
+	spdk_blob_inflate_job_pause(job);
+	spdk_delay_us(1000000);
 	poll_threads();
-	CU_ASSERT(g_bserrno == 0);
+	spdk_blob_inflate_job_get_progress(job, &progress);
+	CU_ASSERT(progress.clusters_done == 2);
+	CU_ASSERT(progress.elapsed_usec == 500000);
+	CU_ASSERT(progress.paused);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 2);
 
-	/* Check snapshot-clone relations */
-	count = 2;
-	CU_ASSERT(spdk_blob_get_clones(bs, snapshotid, ids, &count) == 0);
-	CU_ASSERT(count == 1);
-	CU_ASSERT(ids[0] == snapshot2id);
+	spdk_blob_inflate_job_resume(job);
+	spdk_delay_us(500000);
+	poll_threads();
+	spdk_blob_inflate_job_get_progress(job, &progress);
+	CU_ASSERT(progress.clusters_done == 3);
+	CU_ASSERT(progress.elapsed_usec == 1000000);
 
-	count = 2;
-	CU_ASSERT(spdk_blob_get_clones(bs, snapshot2id, ids, &count) == 0);
-	CU_ASSERT(count == 1);
-	CU_ASSERT(ids[0] == blobid);
+	/* A cancelled job leaves a partially inflated clone */
+	spdk_blob_inflate_job_cancel(job);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -ECANCELED);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 3);
+	CU_ASSERT(spdk_blob_is_clone(blob));
+	CU_ASSERT(spdk_blob_is_thin_provisioned(blob));
+	CU_ASSERT(blob->locked_operation_in_progress == false);
 
-	CU_ASSERT(spdk_blob_get_parent_snapshot(bs, blobid) == snapshot2id);
+	/* Without a limit the job copies the rest right away */
+	spdk_blob_inflate_opts_init(&inflate_opts);
+	g_bserrno = -1;
+	rc = spdk_bs_inflate_blob_start(bs, channel, blobid, &inflate_opts, blob_op_complete, NULL, &job);
+	CU_ASSERT(rc == 0);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 8);
+	CU_ASSERT(!spdk_blob_is_clone(blob));
+	CU_ASSERT(!spdk_blob_is_thin_provisioned(blob));
 
-	free_clusters = spdk_bs_free_cluster_count(bs);
-	if (!decouple_parent) {
-		/* Do full blob inflation */
-		spdk_bs_inflate_blob(bs, channel, blobid, blob_op_complete, NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
 
-		/* All clusters should be inflated (except one already allocated
-		 * in a top level blob) */
-		CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 4);
+	ut_blob_close_and_delete(bs, blob);
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+}
 
-		/* Check if relation tree updated correctly */
-		count = 2;
-		CU_ASSERT(spdk_blob_get_clones(bs, snapshotid, ids, &count) == 0);
+struct ut_copy_dev {
+	struct spdk_bs_dev	bs_dev;
+	uint8_t			*buf;
+	uint32_t		writes;
+};
 
-		/* snapshotid have one clone */
-		CU_ASSERT(count == 1);
-		CU_ASSERT(ids[0] == snapshot2id);
+static void
+ut_copy_dev_write(struct spdk_bs_dev *dev, struct spdk_io_channel *channel, void *payload,
+		  uint64_t lba, uint32_t lba_count, struct spdk_bs_dev_cb_args *cb_args)
+{
+	struct ut_copy_dev *copy_dev = (struct ut_copy_dev *)dev;
 
-		/* snapshot2id have no clones */
-		count = 2;
-		CU_ASSERT(spdk_blob_get_clones(bs, snapshot2id, ids, &count) == 0);
-		CU_ASSERT(count == 0);
+	CU_ASSERT(lba + lba_count <= dev->blockcnt);
+	memcpy(copy_dev->buf + lba * dev->blocklen, payload, lba_count * dev->blocklen);
+	copy_dev->writes++;
+	cb_args->cb_fn(cb_args->channel, cb_args->cb_arg, 0);
+}
 
-		CU_ASSERT(spdk_blob_get_parent_snapshot(bs, blobid) == SPDK_BLOBID_INVALID);
-	} else {
-		/* Decouple parent of blob */
-		spdk_bs_blob_decouple_parent(bs, channel, blobid, blob_op_complete, NULL);
-		poll_threads();
-		CU_ASSERT(g_bserrno == 0);
+static void
+ut_copy_dev_init(struct ut_copy_dev *dev, uint64_t size)
+{
+	memset(dev, 0, sizeof(*dev));
+	dev->bs_dev.blocklen = 512;
+	dev->bs_dev.blockcnt = size / 512;
+	dev->bs_dev.create_channel = ut_esnap_create_channel;
+	dev->bs_dev.destroy_channel = ut_esnap_destroy_channel;
+	dev->bs_dev.write = ut_copy_dev_write;
+	dev->buf = malloc(size);
+	SPDK_CU_ASSERT_FATAL(dev->buf != NULL);
+	memset(dev->buf, 0xFF, size);
+}
 
-		/* Only one cluster from a parent should be inflated (second one
-		 * is covered by a cluster written on a top level blob, and
-		 * already allocated) */
-		CU_ASSERT(spdk_bs_free_cluster_count(bs) == free_clusters - 1);
+static bool
+ut_buf_is(const uint8_t *buf, uint8_t val, uint64_t len)
+{
+	uint64_t i;
 
-		/* Check if relation tree updated correctly */
-		count = 2;
-		CU_ASSERT(spdk_blob_get_clones(bs, snapshotid, ids, &count) == 0);
+	for (i = 0; i < len; i++) {
+		if (buf[i] != val) {
+			return false;
+		}
+	}
+	return true;
+}
 
-		/* snapshotid have two clones now */
-		CU_ASSERT(count == 2);
-		CU_ASSERT(ids[0] == blobid || ids[1] == blobid);
-		CU_ASSERT(ids[0] == snapshot2id || ids[1] == snapshot2id);
+static void
+blob_shallow_copy(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blob;
+	struct spdk_io_channel *channel;
+	struct spdk_blob_opts opts;
+	struct ut_copy_dev dev;
+	spdk_blob_id blobid, snapshotid;
+	uint64_t cluster_size, io_units_per_cluster;
+	uint8_t *payload;
 
-		/* snapshot2id have no clones */
-		count = 2;
-		CU_ASSERT(spdk_blob_get_clones(bs, snapshot2id, ids, &count) == 0);
-		CU_ASSERT(count == 0);
+	cluster_size = spdk_bs_get_cluster_size(bs);
+	io_units_per_cluster = cluster_size / spdk_bs_get_io_unit_size(bs);
+	channel = spdk_bs_alloc_io_channel(bs);
+	SPDK_CU_ASSERT_FATAL(channel != NULL);
+	payload = malloc(cluster_size);
+	SPDK_CU_ASSERT_FATAL(payload != NULL);
 
-		CU_ASSERT(spdk_blob_get_parent_snapshot(bs, blobid) == snapshotid);
-	}
+	/* Thin blob with clusters 1 and 3 written, then snapshotted */
+	ut_spdk_blob_opts_init(&opts);
+	opts.thin_provision = true;
+	opts.num_clusters = 4;
+	blob = ut_blob_create_and_open(bs, &opts);
+	blobid = spdk_blob_get_id(blob);
 
-	/* Try to delete snapshot2 (should pass) */
-	spdk_bs_delete_blob(bs, snapshot2id, blob_op_complete, NULL);
+	memset(payload, 0x11, cluster_size);
+	spdk_blob_io_write(blob, channel, payload, 1 * io_units_per_cluster, io_units_per_cluster,
+			   blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	memset(payload, 0x33, cluster_size);
+	spdk_blob_io_write(blob, channel, payload, 3 * io_units_per_cluster, io_units_per_cluster,
+			   blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
 
-	/* Try to delete base snapshot */
-	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
+	spdk_bs_create_snapshot(bs, blobid, NULL, blob_op_with_id_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(g_blobid != SPDK_BLOBID_INVALID);
+	snapshotid = g_blobid;
 
-	/* Reopen blob after snapshot deletion */
-	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
+	/* The clone itself only has cluster 0 */
+	memset(payload, 0x22, cluster_size);
+	spdk_blob_io_write(blob, channel, payload, 0, io_units_per_cluster, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	SPDK_CU_ASSERT_FATAL(g_blob != NULL);
-	blob = g_blob;
 
-	CU_ASSERT(spdk_blob_get_num_clusters(blob) == 5);
+	ut_copy_dev_init(&dev, 4 * cluster_size);
 
-	/* Check data consistency on inflated blob */
-	memset(payload_read, 0xFF, payload_size);
-	spdk_blob_io_read(blob, channel, payload_read, 0, pages_per_payload,
-			  blob_op_complete, NULL);
+	/* Writable blobs can't be copied */
+	spdk_bs_blob_shallow_copy(bs, channel, blobid, &dev.bs_dev, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EPERM);
+	CU_ASSERT(dev.writes == 0);
+
+	/* Only clusters allocated in the snapshot are written */
+	spdk_bs_blob_shallow_copy(bs, channel, snapshotid, &dev.bs_dev, blob_op_complete, NULL);
 	poll_threads();
 	CU_ASSERT(g_bserrno == 0);
-	CU_ASSERT(memcmp(payload_clone, payload_read, payload_size) == 0);
+	CU_ASSERT(dev.writes == 2);
+	CU_ASSERT(ut_buf_is(dev.buf, 0xFF, cluster_size));
+	CU_ASSERT(ut_buf_is(dev.buf + cluster_size, 0x11, cluster_size));
+	CU_ASSERT(ut_buf_is(dev.buf + 2 * cluster_size, 0xFF, cluster_size));
+	CU_ASSERT(ut_buf_is(dev.buf + 3 * cluster_size, 0x33, cluster_size));
+	CU_ASSERT(g_ut_esnap_channels == 0);
+	free(dev.buf);
 
-	spdk_bs_free_io_channel(channel);
+	/* And those of the clone, not of its parent */
+	spdk_blob_set_read_only(blob);
+	spdk_blob_sync_md(blob, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	ut_copy_dev_init(&dev, 4 * cluster_size);
+	spdk_bs_blob_shallow_copy(bs, channel, blobid, &dev.bs_dev, blob_op_complete, NULL);
 	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
+	CU_ASSERT(dev.writes == 1);
+	CU_ASSERT(ut_buf_is(dev.buf, 0x22, cluster_size));
+	CU_ASSERT(ut_buf_is(dev.buf + cluster_size, 0xFF, 3 * cluster_size));
+	free(dev.buf);
 
-	free(payload_read);
-	free(payload_write);
-	free(payload_clone);
+	/* The device must fit the whole blob */
+	ut_copy_dev_init(&dev, 3 * cluster_size);
+	spdk_bs_blob_shallow_copy(bs, channel, blobid, &dev.bs_dev, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == -EINVAL);
+	CU_ASSERT(dev.writes == 0);
+	free(dev.buf);
 
-	ut_blob_close_and_delete(bs, blob);
-}
+	free(payload);
+	spdk_bs_free_io_channel(channel);
+	poll_threads();
 
-static void
-blob_inflate_rw(void)
-{
-	_blob_inflate_rw(false);
-	_blob_inflate_rw(true);
+	ut_blob_close_and_delete(bs, blob);
+	spdk_bs_delete_blob(bs, snapshotid, blob_op_complete, NULL);
+	poll_threads();
+	CU_ASSERT(g_bserrno == 0);
 }
 
 /**
@@ -6606,6 +7960,95 @@ blob_persist_test(void)
 	poll_threads();
 }
 
+static void
+blob_sync_md_count_complete(void *cb_arg, int bserrno)
+{
+	int *count = cb_arg;
+
+	CU_ASSERT(bserrno == 0);
+	(*count)++;
+}
+
+static void
+blob_sync_md_batch(void)
+{
+	struct spdk_blob_store *bs = g_bs;
+	struct spdk_blob *blobs[4];
+	spdk_blob_id blobids[4];
+	uint64_t write_ops;
+	const void *value;
+	size_t value_len;
+	int completed;
+	int rc, i;
+
+	for (i = 0; i < 4; i++) {
+		blobs[i] = ut_blob_create_and_open(bs, NULL);
+		blobids[i] = spdk_blob_get_id(blobs[i]);
+	}
+	/* Blobs created one after another have their root pages next to each other */
+	for (i = 1; i < 4; i++) {
+		SPDK_CU_ASSERT_FATAL(bs_blobid_to_page(blobids[i]) == bs_blobid_to_page(blobids[0]) + i);
+	}
+
+	/* The root pages of blobs synced at the same time are written with one I/O */
+	completed = 0;
+	write_ops = g_dev_write_ops;
+	for (i = 0; i < 4; i++) {
+		rc = spdk_blob_set_xattr(blobs[i], "name", "blob", strlen("blob") + 1);
+		CU_ASSERT(rc == 0);
+		spdk_blob_sync_md(blobs[i], blob_sync_md_count_complete, &completed);
+	}
+	poll_threads();
+	CU_ASSERT(completed == 4);
+	CU_ASSERT(g_dev_write_ops - write_ops == 1);
+
+	/* Syncs of one blob requested while its metadata is being written are
+	 * completed together by the next write */
+	completed = 0;
+	write_ops = g_dev_write_ops;
+	rc = spdk_blob_set_xattr(blobs[0], "first", "1", 2);
+	CU_ASSERT(rc == 0);
+	spdk_blob_sync_md(blobs[0], blob_sync_md_count_complete, &completed);
+	rc = spdk_blob_set_xattr(blobs[0], "second", "2", 2);
+	CU_ASSERT(rc == 0);
+	spdk_blob_sync_md(blobs[0], blob_sync_md_count_complete, &completed);
+	rc = spdk_blob_set_xattr(blobs[0], "third", "3", 2);
+	CU_ASSERT(rc == 0);
+	spdk_blob_sync_md(blobs[0], blob_sync_md_count_complete, &completed);
+	poll_threads();
+	CU_ASSERT(completed == 3);
+	CU_ASSERT(g_dev_write_ops - write_ops == 2);
+
+	for (i = 0; i < 4; i++) {
+		spdk_blob_close(blobs[i], blob_op_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+	}
+
+	/* All of the changes are on disk */
+	ut_bs_reload(&bs, NULL);
+
+	for (i = 0; i < 4; i++) {
+		spdk_bs_open_blob(bs, blobids[i], blob_op_with_handle_complete, NULL);
+		poll_threads();
+		CU_ASSERT(g_bserrno == 0);
+		SPDK_CU_ASSERT_FATAL(g_blob != NULL);
+		blobs[i] = g_blob;
+
+		rc = spdk_blob_get_xattr_value(blobs[i], "name", &value, &value_len);
+		CU_ASSERT(rc == 0);
+		CU_ASSERT(value_len == strlen("blob") + 1);
+	}
+	rc = spdk_blob_get_xattr_value(blobs[0], "first", &value, &value_len);
+	CU_ASSERT(rc == 0);
+	rc = spdk_blob_get_xattr_value(blobs[0], "third", &value, &value_len);
+	CU_ASSERT(rc == 0);
+
+	for (i = 0; i < 4; i++) {
+		ut_blob_close_and_delete(bs, blobs[i]);
+	}
+}
+
 static void
 suite_bs_setup(void)
 {
@@ -6650,6 +8093,7 @@ ut_blob_create_and_open(struct spdk_blob_store *bs, struct spdk_blob_opts *blob_
 
 	spdk_bs_open_blob(bs, blobid, blob_op_with_handle_complete, NULL);
 	poll_threads();
+	if (g_bserrno) fprintf(stderr, "DBG open %d\n", g_bserrno);
 	CU_ASSERT(g_bserrno == 0);
 	CU_ASSERT(g_blob != NULL);
 	blob = g_blob;
@@ -6738,6 +8182,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, bs_load);
 	CU_ADD_TEST(suite_bs, bs_load_pending_removal);
 	CU_ADD_TEST(suite, bs_load_custom_cluster_size);
+	CU_ADD_TEST(suite, bs_grow);
 	CU_ADD_TEST(suite_bs, bs_unload);
 	CU_ADD_TEST(suite, bs_cluster_sz);
 	CU_ADD_TEST(suite_bs, bs_usable_clusters);
@@ -6749,12 +8194,17 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite_bs, blob_crc);
 	CU_ADD_TEST(suite, super_block_crc);
 	CU_ADD_TEST(suite_blob, blob_dirty_shutdown);
+	CU_ADD_TEST(suite, blob_dirty_shutdown_replay);
+	CU_ADD_TEST(suite, blob_esnap_clone);
+	CU_ADD_TEST(suite, blob_esnap_clone_degraded);
 	CU_ADD_TEST(suite_bs, blob_flags);
 	CU_ADD_TEST(suite_bs, bs_version);
 	CU_ADD_TEST(suite_bs, blob_set_xattrs_test);
 	CU_ADD_TEST(suite_bs, blob_thin_prov_alloc);
 	CU_ADD_TEST(suite_bs, blob_insert_cluster_msg_test);
 	CU_ADD_TEST(suite_bs, blob_thin_prov_rw);
+	CU_ADD_TEST(suite_bs, blob_thin_prov_cluster_reserve);
+	CU_ADD_TEST(suite_bs, blob_thin_prov_cluster_reserve_full);
 	CU_ADD_TEST(suite_bs, blob_thin_prov_rle);
 	CU_ADD_TEST(suite_bs, blob_thin_prov_rw_iov);
 	CU_ADD_TEST(suite, bs_load_iter_test);
@@ -6766,6 +8216,10 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, blob_delete_snapshot_power_failure);
 	CU_ADD_TEST(suite, blob_create_snapshot_power_failure);
 	CU_ADD_TEST(suite_bs, blob_inflate_rw);
+	CU_ADD_TEST(suite_bs, blob_copy_on_read);
+	CU_ADD_TEST(suite_bs, blob_io_stat);
+	CU_ADD_TEST(suite_bs, blob_inflate_job);
+	CU_ADD_TEST(suite_bs, blob_shallow_copy);
 	CU_ADD_TEST(suite_bs, blob_snapshot_freeze_io);
 	CU_ADD_TEST(suite_bs, blob_operation_split_rw);
 	CU_ADD_TEST(suite_bs, blob_operation_split_rw_iov);
@@ -6773,6 +8227,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, blob_io_unit_compatiblity);
 	CU_ADD_TEST(suite_bs, blob_simultaneous_operations);
 	CU_ADD_TEST(suite_bs, blob_persist_test);
+	CU_ADD_TEST(suite_bs, blob_sync_md_batch);
 
 	allocate_threads(2);
 	set_thread(0);
@@ -41,6 +41,8 @@
 uint8_t *g_dev_buffer;
 uint64_t g_dev_write_bytes;
 uint64_t g_dev_read_bytes;
+uint64_t g_dev_write_ops;
+uint64_t g_dev_read_ops;
 
 struct spdk_power_failure_counters {
 	uint64_t general_counter;
@@ -159,6 +161,7 @@ dev_read(struct spdk_bs_dev *dev, struct spdk_io_channel *channel, void *payload
 
 		memcpy(payload, &g_dev_buffer[offset], length);
 		g_dev_read_bytes += length;
+		g_dev_read_ops++;
 	} else {
 		g_power_failure_rc = -EIO;
 	}
@@ -191,6 +194,7 @@ dev_write(struct spdk_bs_dev *dev, struct spdk_io_channel *channel, void *payloa
 
 		memcpy(&g_dev_buffer[offset], payload, length);
 		g_dev_write_bytes += length;
+		g_dev_write_ops++;
 	} else {
 		g_power_failure_rc = -EIO;
 	}
@@ -242,6 +246,7 @@ dev_readv(struct spdk_bs_dev *dev, struct spdk_io_channel *channel,
 		}
 
 		g_dev_read_bytes += length;
+		g_dev_read_ops++;
 	} else {
 		g_power_failure_rc = -EIO;
 	}
@@ -281,6 +286,7 @@ dev_writev(struct spdk_bs_dev *dev, struct spdk_io_channel *channel,
 		}
 
 		g_dev_write_bytes += length;
+		g_dev_write_ops++;
 	} else {
 		g_power_failure_rc = -EIO;
 	}
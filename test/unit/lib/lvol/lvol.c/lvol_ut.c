@@ -67,6 +67,7 @@ struct spdk_blob {
 	char			uuid[SPDK_UUID_STRING_LEN];
 	char			name[SPDK_LVS_NAME_MAX];
 	bool			thin_provisioned;
+	bool			esnap_clone;
 };
 
 int g_lvserrno;
@@ -74,6 +75,7 @@ int g_close_super_status;
 int g_resize_rc;
 int g_inflate_rc;
 int g_remove_rc;
+int g_grow_rc;
 bool g_lvs_rename_blob_open_error = false;
 struct spdk_lvol_store *g_lvol_store;
 struct spdk_lvol *g_lvol;
@@ -106,6 +108,47 @@ void spdk_bs_blob_decouple_parent(struct spdk_blob_store *bs, struct spdk_io_cha
 	cb_fn(cb_arg, g_inflate_rc);
 }
 
+void
+spdk_bs_blob_shallow_copy(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+			  spdk_blob_id blobid, struct spdk_bs_dev *ext_dev,
+			  spdk_blob_op_complete cb_fn, void *cb_arg)
+{
+	cb_fn(cb_arg, g_inflate_rc);
+}
+
+struct spdk_blob_inflate_job {
+	spdk_blob_op_complete	cb_fn;
+	void			*cb_arg;
+};
+
+static struct spdk_blob_inflate_job g_inflate_job;
+static bool g_inflate_job_async;
+
+int
+spdk_bs_inflate_blob_start(struct spdk_blob_store *bs, struct spdk_io_channel *channel,
+			   spdk_blob_id blobid, const struct spdk_blob_inflate_opts *opts,
+			   spdk_blob_op_complete cb_fn, void *cb_arg,
+			   struct spdk_blob_inflate_job **job)
+{
+	if (g_inflate_rc != 0) {
+		return g_inflate_rc;
+	}
+
+	g_inflate_job.cb_fn = cb_fn;
+	g_inflate_job.cb_arg = cb_arg;
+	*job = &g_inflate_job;
+	if (!g_inflate_job_async) {
+		cb_fn(cb_arg, 0);
+	}
+	return 0;
+}
+
+void
+spdk_blob_inflate_job_cancel(struct spdk_blob_inflate_job *job)
+{
+	job->cb_fn(job->cb_arg, -ECANCELED);
+}
+
 void
 spdk_bs_iter_next(struct spdk_blob_store *bs, struct spdk_blob *b,
 		  spdk_blob_op_with_handle_complete cb_fn, void *cb_arg)
@@ -173,6 +216,8 @@ spdk_bs_load(struct spdk_bs_dev *dev, struct spdk_bs_opts *opts,
 
 	if (ut_dev->load_status == 0) {
 		bs = ut_dev->bs;
+		bs->bs_opts.esnap_bs_dev_create = opts->esnap_bs_dev_create;
+		bs->bs_opts.esnap_ctx = opts->esnap_ctx;
 	}
 
 	cb_fn(cb_arg, bs, ut_dev->load_status);
@@ -299,6 +344,12 @@ spdk_bs_unload(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_a
 	cb_fn(cb_arg, 0);
 }
 
+void
+spdk_bs_grow(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn, void *cb_arg)
+{
+	cb_fn(cb_arg, g_grow_rc);
+}
+
 void
 spdk_bs_destroy(struct spdk_blob_store *bs, spdk_bs_op_complete cb_fn,
 		void *cb_arg)
@@ -339,6 +390,8 @@ spdk_bs_opts_init(struct spdk_bs_opts *opts)
 	opts->max_md_ops = SPDK_BLOB_OPTS_MAX_MD_OPS;
 	opts->max_channel_ops = SPDK_BLOB_OPTS_MAX_CHANNEL_OPS;
 	memset(&opts->bstype, 0, sizeof(opts->bstype));
+	opts->esnap_bs_dev_create = NULL;
+	opts->esnap_ctx = NULL;
 }
 
 DEFINE_STUB(spdk_bs_get_cluster_size, uint64_t, (struct spdk_blob_store *bs), BS_CLUSTER_SIZE);
@@ -406,6 +459,8 @@ spdk_blob_opts_init(struct spdk_blob_opts *opts)
 	opts->xattrs.names = NULL;
 	opts->xattrs.ctx = NULL;
 	opts->xattrs.get_value = NULL;
+	opts->esnap_id = NULL;
+	opts->esnap_id_len = 0;
 }
 
 void
@@ -439,6 +494,11 @@ spdk_bs_create_blob_ext(struct spdk_blob_store *bs, const struct spdk_blob_opts
 	if (opts != NULL && opts->thin_provision) {
 		b->thin_provisioned = true;
 	}
+	if (opts != NULL && opts->esnap_id != NULL) {
+		CU_ASSERT(bs->bs_opts.esnap_bs_dev_create != NULL);
+		b->thin_provisioned = true;
+		b->esnap_clone = true;
+	}
 	b->bs = bs;
 
 	TAILQ_INSERT_TAIL(&bs->blobs, b, link);
@@ -1945,6 +2005,95 @@ lvol_create_thin_provisioned(void)
 	free_dev(&dev);
 }
 
+static int
+ut_esnap_dev_create(void *bs_ctx, struct spdk_blob *blob, const void *esnap_id, uint32_t id_len,
+		    struct spdk_bs_dev **bs_dev)
+{
+	return -ENOTSUP;
+}
+
+static void
+lvol_esnap_clone(void)
+{
+	struct lvol_ut_bs_dev dev;
+	struct spdk_lvs_opts opts;
+	struct spdk_lvol_store *lvs;
+	const char *esnap_id = "esnap";
+	int rc = 0;
+
+	init_dev(&dev);
+
+	spdk_lvs_opts_init(&opts);
+	snprintf(opts.name, sizeof(opts.name), "lvs");
+	opts.esnap_bs_dev_create = ut_esnap_dev_create;
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_init(&dev.bs_dev, &opts, lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+	lvs = g_lvol_store;
+
+	/* The blobstore opens external snapshots with the lvolstore as context */
+	CU_ASSERT(dev.bs->bs_opts.esnap_bs_dev_create == ut_esnap_dev_create);
+	CU_ASSERT(dev.bs->bs_opts.esnap_ctx == lvs);
+
+	/* Size must be a multiple of the cluster size */
+	rc = spdk_lvol_create_esnap_clone(esnap_id, strlen(esnap_id) + 1, BS_CLUSTER_SIZE + 1, lvs,
+					  "clone", lvol_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	/* External snapshot id is required */
+	rc = spdk_lvol_create_esnap_clone(NULL, 0, BS_CLUSTER_SIZE, lvs,
+					  "clone", lvol_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == -EINVAL);
+
+	g_lvserrno = -1;
+	g_lvol = NULL;
+	rc = spdk_lvol_create_esnap_clone(esnap_id, strlen(esnap_id) + 1, 2 * BS_CLUSTER_SIZE, lvs,
+					  "clone", lvol_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol != NULL);
+	CU_ASSERT(g_lvol->thin_provision == true);
+	CU_ASSERT(g_lvol->blob->esnap_clone == true);
+	CU_ASSERT(g_lvol->blob->thin_provisioned == true);
+
+	/* Name is already taken */
+	rc = spdk_lvol_create_esnap_clone(esnap_id, strlen(esnap_id) + 1, BS_CLUSTER_SIZE, lvs,
+					  "clone", lvol_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == -EEXIST);
+
+	spdk_lvol_close(g_lvol, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	spdk_lvol_destroy(g_lvol, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_unload(lvs, op_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	g_lvol_store = NULL;
+
+	/* Load passes the callback and the lvolstore to the blobstore */
+	dev.bs->bs_opts.esnap_bs_dev_create = NULL;
+	dev.bs->bs_opts.esnap_ctx = NULL;
+	g_lvserrno = -1;
+	spdk_lvs_load_ext(&dev.bs_dev, &opts, lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+	CU_ASSERT(dev.bs->bs_opts.esnap_bs_dev_create == ut_esnap_dev_create);
+	CU_ASSERT(dev.bs->bs_opts.esnap_ctx == g_lvol_store);
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_unload(g_lvol_store, op_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	g_lvol_store = NULL;
+
+	free_dev(&dev);
+}
+
 static void
 lvol_inflate(void)
 {
@@ -2045,6 +2194,162 @@ lvol_decouple_parent(void)
 	CU_ASSERT(g_io_channel == NULL);
 }
 
+static void
+lvol_start_inflate(void)
+{
+	struct lvol_ut_bs_dev dev;
+	struct spdk_lvs_opts opts;
+	int rc = 0;
+
+	init_dev(&dev);
+
+	spdk_lvs_opts_init(&opts);
+	snprintf(opts.name, sizeof(opts.name), "lvs");
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_init(&dev.bs_dev, &opts, lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+
+	spdk_lvol_create(g_lvol_store, "lvol", 10, false, LVOL_CLEAR_WITH_DEFAULT,
+			 lvol_op_with_handle_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol != NULL);
+
+	/* Failure to start is reported through the return code only */
+	g_inflate_rc = -ENOMEM;
+	g_lvserrno = 1;
+	rc = spdk_lvol_start_inflate(g_lvol, NULL, op_complete, NULL);
+	CU_ASSERT(rc == -ENOMEM);
+	CU_ASSERT(g_lvserrno == 1);
+	CU_ASSERT(spdk_lvol_get_inflate_job(g_lvol) == NULL);
+	CU_ASSERT(g_io_channel == NULL);
+
+	/* Job completing right away */
+	g_inflate_rc = 0;
+	g_lvserrno = -1;
+	rc = spdk_lvol_start_inflate(g_lvol, NULL, op_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	CU_ASSERT(spdk_lvol_get_inflate_job(g_lvol) == NULL);
+
+	/* Only one job at a time */
+	g_inflate_job_async = true;
+	g_lvserrno = -1;
+	rc = spdk_lvol_start_inflate(g_lvol, NULL, op_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == -1);
+	CU_ASSERT(spdk_lvol_get_inflate_job(g_lvol) == &g_inflate_job);
+	rc = spdk_lvol_start_inflate(g_lvol, NULL, op_complete, NULL);
+	CU_ASSERT(rc == -EBUSY);
+
+	/* Closing the lvol cancels the job before the blob is closed */
+	spdk_lvol_close(g_lvol, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	CU_ASSERT(spdk_lvol_get_inflate_job(g_lvol) == NULL);
+	g_inflate_job_async = false;
+
+	spdk_lvol_destroy(g_lvol, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_unload(g_lvol_store, op_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	g_lvol_store = NULL;
+
+	free_dev(&dev);
+
+	CU_ASSERT(g_io_channel == NULL);
+}
+
+static void
+lvol_shallow_copy(void)
+{
+	struct lvol_ut_bs_dev dev;
+	struct spdk_bs_dev ext_dev = {};
+	struct spdk_lvs_opts opts;
+	int rc = 0;
+
+	init_dev(&dev);
+
+	spdk_lvs_opts_init(&opts);
+	snprintf(opts.name, sizeof(opts.name), "lvs");
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_init(&dev.bs_dev, &opts, lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+
+	spdk_lvol_create(g_lvol_store, "lvol", 10, false, LVOL_CLEAR_WITH_DEFAULT,
+			 lvol_op_with_handle_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol != NULL);
+
+	g_inflate_rc = -EPERM;
+	spdk_lvol_shallow_copy(g_lvol, &ext_dev, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == -EPERM);
+
+	g_inflate_rc = 0;
+	spdk_lvol_shallow_copy(g_lvol, &ext_dev, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+
+	spdk_lvol_close(g_lvol, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+	spdk_lvol_destroy(g_lvol, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_unload(g_lvol_store, op_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	g_lvol_store = NULL;
+
+	free_dev(&dev);
+
+	CU_ASSERT(g_io_channel == NULL);
+}
+
+static void
+lvs_grow(void)
+{
+	struct lvol_ut_bs_dev dev;
+	struct spdk_lvs_opts opts;
+	int rc = 0;
+
+	init_dev(&dev);
+
+	spdk_lvs_opts_init(&opts);
+	CU_ASSERT(opts.max_size == 0);
+	snprintf(opts.name, sizeof(opts.name), "lvs");
+	opts.max_size = 4ULL * DEV_BUFFER_SIZE;
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_init(&dev.bs_dev, &opts, lvol_store_op_with_handle_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	SPDK_CU_ASSERT_FATAL(g_lvol_store != NULL);
+	CU_ASSERT(dev.bs->bs_opts.max_size == opts.max_size);
+
+	g_grow_rc = -ENOSPC;
+	spdk_lvs_grow(g_lvol_store, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == -ENOSPC);
+
+	g_grow_rc = 0;
+	spdk_lvs_grow(g_lvol_store, op_complete, NULL);
+	CU_ASSERT(g_lvserrno == 0);
+
+	g_lvserrno = -1;
+	rc = spdk_lvs_unload(g_lvol_store, op_complete, NULL);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(g_lvserrno == 0);
+	g_lvol_store = NULL;
+
+	free_dev(&dev);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -2077,10 +2382,14 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, lvol_refcnt);
 	CU_ADD_TEST(suite, lvol_names);
 	CU_ADD_TEST(suite, lvol_create_thin_provisioned);
+	CU_ADD_TEST(suite, lvol_esnap_clone);
 	CU_ADD_TEST(suite, lvol_rename);
 	CU_ADD_TEST(suite, lvs_rename);
 	CU_ADD_TEST(suite, lvol_inflate);
 	CU_ADD_TEST(suite, lvol_decouple_parent);
+	CU_ADD_TEST(suite, lvol_start_inflate);
+	CU_ADD_TEST(suite, lvol_shallow_copy);
+	CU_ADD_TEST(suite, lvs_grow);
 
 	allocate_threads(1);
 	set_thread(0);
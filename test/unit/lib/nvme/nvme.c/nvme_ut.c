@@ -41,6 +41,10 @@
 
 #include "common/lib/test_env.c"
 
+DEFINE_STUB(nvme_poll_group_get_request, struct nvme_request *,
+	    (struct spdk_nvme_qpair *qpair), NULL);
+DEFINE_STUB_V(nvme_poll_group_put_request, (struct nvme_request *req));
+
 DEFINE_STUB_V(nvme_ctrlr_proc_get_ref, (struct spdk_nvme_ctrlr *ctrlr));
 DEFINE_STUB_V(nvme_ctrlr_proc_put_ref, (struct spdk_nvme_ctrlr *ctrlr));
 DEFINE_STUB_V(nvme_ctrlr_fail, (struct spdk_nvme_ctrlr *ctrlr, bool hotremove));
@@ -731,6 +735,7 @@ test_nvme_free_request(void)
 	/* put a req on the Q, take it off and compare */
 	memset(&match_req.cmd, 0x5a, sizeof(struct spdk_nvme_cmd));
 	match_req.qpair = &qpair;
+	match_req.group = NULL;
 	/* the code under tests asserts this condition */
 	match_req.num_children = 0;
 	STAILQ_INIT(&qpair.free_req);
@@ -42,6 +42,10 @@
 #include "nvme/nvme_ctrlr.c"
 #include "nvme/nvme_quirks.c"
 
+DEFINE_STUB(nvme_poll_group_get_request, struct nvme_request *,
+	    (struct spdk_nvme_qpair *qpair), NULL);
+DEFINE_STUB_V(nvme_poll_group_put_request, (struct nvme_request *req));
+
 SPDK_LOG_REGISTER_COMPONENT(nvme)
 
 pid_t g_spdk_nvme_pid;
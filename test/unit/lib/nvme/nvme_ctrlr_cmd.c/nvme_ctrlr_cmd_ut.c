@@ -68,6 +68,17 @@ uint32_t expected_feature_cdw12 = 1;
 typedef void (*verify_request_fn_t)(struct nvme_request *req);
 verify_request_fn_t verify_fn;
 
+struct nvme_request *
+nvme_poll_group_get_request(struct spdk_nvme_qpair *qpair)
+{
+	return NULL;
+}
+
+void
+nvme_poll_group_put_request(struct nvme_request *req)
+{
+}
+
 static void verify_firmware_log_page(struct nvme_request *req)
 {
 	uint32_t temp_cdw10;
@@ -49,6 +49,17 @@ struct nvme_request g_req;
 typedef void (*verify_request_fn_t)(struct nvme_request *req);
 verify_request_fn_t verify_fn;
 
+struct nvme_request *
+nvme_poll_group_get_request(struct spdk_nvme_qpair *qpair)
+{
+	return NULL;
+}
+
+void
+nvme_poll_group_put_request(struct nvme_request *req)
+{
+}
+
 static const uint32_t expected_geometry_ns = 1;
 
 int
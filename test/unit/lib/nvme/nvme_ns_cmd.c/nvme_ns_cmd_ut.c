@@ -38,6 +38,10 @@
 
 #include "common/lib/test_env.c"
 
+DEFINE_STUB(nvme_poll_group_get_request, struct nvme_request *,
+	    (struct spdk_nvme_qpair *qpair), NULL);
+DEFINE_STUB_V(nvme_poll_group_put_request, (struct nvme_request *req));
+
 static struct nvme_driver _g_nvme_driver = {
 	.lock = PTHREAD_MUTEX_INITIALIZER,
 };
@@ -39,6 +39,10 @@
 
 #include "common/lib/test_env.c"
 
+DEFINE_STUB(nvme_poll_group_get_request, struct nvme_request *,
+	    (struct spdk_nvme_qpair *qpair), NULL);
+DEFINE_STUB_V(nvme_poll_group_put_request, (struct nvme_request *req));
+
 #define OCSSD_SECTOR_SIZE 0x1000
 
 static struct nvme_driver _g_nvme_driver = {
@@ -123,14 +123,18 @@ spdk_pci_enumerate(struct spdk_pci_driver *driver, spdk_pci_enum_cb enum_cb, voi
 	return 0;
 }
 
+/* When non-zero, the size of the physically contiguous regions that buffers are split into */
 static uint64_t g_vtophys_size = 0;
+static uint32_t g_vtophys_calls = 0;
 
 DEFINE_RETURN_MOCK(spdk_vtophys, uint64_t);
 uint64_t
 spdk_vtophys(const void *buf, uint64_t *size)
 {
-	if (size) {
-		*size = g_vtophys_size;
+	g_vtophys_calls++;
+
+	if (size && g_vtophys_size) {
+		*size = g_vtophys_size - ((uintptr_t)buf % g_vtophys_size);
 	}
 
 	HANDLE_RETURN_MOCK(spdk_vtophys);
@@ -289,6 +293,30 @@ test_prp_list_append(void)
 	prp_list_prep(&tr, &req, &prp_index);
 	CU_ASSERT(nvme_pcie_prp_list_append(&tr, &prp_index, (void *)0x100800,
 					    (NVME_MAX_PRP_LIST_ENTRIES + 1) * 0x1000, 0x1000) == -EFAULT);
+
+	/* 128K physically contiguous buffer is translated once */
+	prp_list_prep(&tr, &req, &prp_index);
+	g_vtophys_calls = 0;
+	CU_ASSERT(nvme_pcie_prp_list_append(&tr, &prp_index, (void *)0x100000, 0x20000, 0x1000) == 0);
+	CU_ASSERT(g_vtophys_calls == 1);
+	CU_ASSERT(prp_index == 32);
+	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x100000);
+	CU_ASSERT(req.cmd.dptr.prp.prp2 == tr.prp_sgl_bus_addr);
+	CU_ASSERT(tr.u.prp[0] == 0x101000);
+	CU_ASSERT(tr.u.prp[30] == 0x11f000);
+
+	/* Non-4K-aligned buffer crossing the boundary of two 2MB regions */
+	g_vtophys_size = 0x200000;
+	prp_list_prep(&tr, &req, &prp_index);
+	g_vtophys_calls = 0;
+	CU_ASSERT(nvme_pcie_prp_list_append(&tr, &prp_index, (void *)0x1ff800, 0x2000, 0x1000) == 0);
+	CU_ASSERT(g_vtophys_calls == 2);
+	CU_ASSERT(prp_index == 3);
+	CU_ASSERT(req.cmd.dptr.prp.prp1 == 0x1ff800);
+	CU_ASSERT(req.cmd.dptr.prp.prp2 == tr.prp_sgl_bus_addr);
+	CU_ASSERT(tr.u.prp[0] == 0x200000);
+	CU_ASSERT(tr.u.prp[1] == 0x201000);
+	g_vtophys_size = 0;
 }
 
 static void
@@ -473,6 +501,47 @@ test_build_contig_hw_sgl_request(void)
 	memset(&tr, 0, sizeof(tr));
 }
 
+static void
+test_nvme_pcie_qpair_is_idle(void)
+{
+	struct nvme_pcie_qpair pqpair = {};
+	struct spdk_nvme_qpair *qpair = &pqpair.qpair;
+	struct spdk_nvme_ctrlr ctrlr = {};
+	struct nvme_tracker tr = {};
+	struct nvme_request req = {};
+
+	TAILQ_INIT(&pqpair.outstanding_tr);
+	STAILQ_INIT(&qpair->queued_req);
+	STAILQ_INIT(&qpair->aborting_queued_req);
+	STAILQ_INIT(&qpair->err_req_head);
+	qpair->ctrlr = &ctrlr;
+	qpair->trtype = SPDK_NVME_TRANSPORT_PCIE;
+	nvme_qpair_set_state(qpair, NVME_QPAIR_ENABLED);
+
+	CU_ASSERT(nvme_pcie_qpair_is_idle(qpair));
+
+	/* Outstanding commands */
+	TAILQ_INSERT_TAIL(&pqpair.outstanding_tr, &tr, tq_list);
+	CU_ASSERT(!nvme_pcie_qpair_is_idle(qpair));
+	TAILQ_REMOVE(&pqpair.outstanding_tr, &tr, tq_list);
+
+	/* Requests waiting for a tracker */
+	STAILQ_INSERT_TAIL(&qpair->queued_req, &req, stailq);
+	CU_ASSERT(!nvme_pcie_qpair_is_idle(qpair));
+	STAILQ_REMOVE_HEAD(&qpair->queued_req, stailq);
+
+	/* Qpairs that are being reset and failed controllers must still be polled */
+	nvme_qpair_set_state(qpair, NVME_QPAIR_CONNECTING);
+	CU_ASSERT(!nvme_pcie_qpair_is_idle(qpair));
+	nvme_qpair_set_state(qpair, NVME_QPAIR_ENABLED);
+
+	ctrlr.is_failed = true;
+	CU_ASSERT(!nvme_pcie_qpair_is_idle(qpair));
+	ctrlr.is_failed = false;
+
+	CU_ASSERT(nvme_pcie_qpair_is_idle(qpair));
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -486,6 +555,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_pcie_hotplug_monitor);
 	CU_ADD_TEST(suite, test_shadow_doorbell_update);
 	CU_ADD_TEST(suite, test_build_contig_hw_sgl_request);
+	CU_ADD_TEST(suite, test_nvme_pcie_qpair_is_idle);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
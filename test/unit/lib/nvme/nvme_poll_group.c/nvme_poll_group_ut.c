@@ -448,6 +448,64 @@ test_spdk_nvme_poll_group_destroy(void)
 	free(tgroup_1);
 }
 
+static void
+test_nvme_poll_group_shared_requests(void)
+{
+	struct spdk_nvme_poll_group *group;
+	struct spdk_nvme_transport_poll_group *tgroup;
+	struct spdk_nvme_qpair qpair = {0};
+	struct nvme_request *reqs[40];
+	int i;
+
+	TAILQ_INSERT_TAIL(&g_spdk_nvme_transports, &t1, link);
+	group = spdk_nvme_poll_group_create(NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+
+	/* The qpair's own free_req list is empty, so every request comes from the group. */
+	qpair.transport = &t1;
+	qpair.num_requests = SPDK_COUNTOF(reqs);
+	STAILQ_INIT(&qpair.free_req);
+	CU_ASSERT(spdk_nvme_poll_group_add(group, &qpair) == 0);
+	CU_ASSERT(group->max_reqs == SPDK_COUNTOF(reqs));
+	CU_ASSERT(group->num_reqs == 0);
+
+	/* The pool grows by NVME_POLL_GROUP_MIN_REQ_GROWTH, then up to max_reqs. */
+	for (i = 0; i < (int)SPDK_COUNTOF(reqs); i++) {
+		reqs[i] = nvme_poll_group_get_request(&qpair);
+		SPDK_CU_ASSERT_FATAL(reqs[i] != NULL);
+		CU_ASSERT(reqs[i]->qpair == &qpair);
+		CU_ASSERT(reqs[i]->group == group);
+		if (i == 0) {
+			CU_ASSERT(group->num_reqs == NVME_POLL_GROUP_MIN_REQ_GROWTH);
+		}
+	}
+	CU_ASSERT(group->num_reqs == SPDK_COUNTOF(reqs));
+	CU_ASSERT(group->num_outstanding_reqs == SPDK_COUNTOF(reqs));
+	CU_ASSERT(qpair.num_reqs_borrowed == SPDK_COUNTOF(reqs));
+	CU_ASSERT(qpair.num_reqs_exhausted == 0);
+
+	/* Both pools are empty. */
+	CU_ASSERT(nvme_poll_group_get_request(&qpair) == NULL);
+	CU_ASSERT(qpair.num_reqs_exhausted == 1);
+
+	/* The group can't go away while its requests are in use. */
+	CU_ASSERT(spdk_nvme_poll_group_destroy(group) == -EBUSY);
+
+	for (i = 0; i < (int)SPDK_COUNTOF(reqs); i++) {
+		nvme_free_request(reqs[i]);
+	}
+	CU_ASSERT(group->num_outstanding_reqs == 0);
+	CU_ASSERT(STAILQ_EMPTY(&qpair.free_req));
+
+	CU_ASSERT(spdk_nvme_poll_group_remove(group, &qpair) == 0);
+	CU_ASSERT(group->max_reqs == 0);
+
+	tgroup = STAILQ_FIRST(&group->tgroups);
+	SPDK_CU_ASSERT_FATAL(spdk_nvme_poll_group_destroy(group) == 0);
+	free(tgroup);
+	TAILQ_REMOVE(&g_spdk_nvme_transports, &t1, link);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -470,7 +528,9 @@ main(int argc, char **argv)
 			    test_spdk_nvme_poll_group_add_remove) == NULL ||
 		CU_add_test(suite, "nvme_poll_group_process_completions",
 			    test_spdk_nvme_poll_group_process_completions) == NULL ||
-		CU_add_test(suite, "nvme_poll_group_destroy_test", test_spdk_nvme_poll_group_destroy) == NULL
+		CU_add_test(suite, "nvme_poll_group_destroy_test", test_spdk_nvme_poll_group_destroy) == NULL ||
+		CU_add_test(suite, "nvme_poll_group_shared_requests",
+			    test_nvme_poll_group_shared_requests) == NULL
 	) {
 		CU_cleanup_registry();
 		return CU_get_error();
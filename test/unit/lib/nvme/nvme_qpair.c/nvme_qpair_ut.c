@@ -53,10 +53,14 @@ struct nvme_driver _g_nvme_driver = {
 DEFINE_STUB_V(nvme_transport_qpair_abort_reqs, (struct spdk_nvme_qpair *qpair, uint32_t dnr));
 DEFINE_STUB(nvme_transport_qpair_submit_request, int,
 	    (struct spdk_nvme_qpair *qpair, struct nvme_request *req), 0);
+DEFINE_STUB(nvme_transport_qpair_submit_batch, int, (struct spdk_nvme_qpair *qpair), 0);
 DEFINE_STUB(spdk_nvme_ctrlr_free_io_qpair, int, (struct spdk_nvme_qpair *qpair), 0);
 DEFINE_STUB_V(nvme_transport_ctrlr_disconnect_qpair, (struct spdk_nvme_ctrlr *ctrlr,
 		struct spdk_nvme_qpair *qpair));
 DEFINE_STUB_V(nvme_ctrlr_disconnect_qpair, (struct spdk_nvme_qpair *qpair));
+DEFINE_STUB(nvme_poll_group_get_request, struct nvme_request *,
+	    (struct spdk_nvme_qpair *qpair), NULL);
+DEFINE_STUB_V(nvme_poll_group_put_request, (struct nvme_request *req));
 
 void
 nvme_ctrlr_fail(struct spdk_nvme_ctrlr *ctrlr, bool hot_remove)
@@ -613,6 +617,37 @@ test_nvme_qpair_resubmit_request_with_transport_failed(void)
 	cleanup_submit_request_test(&qpair);
 }
 
+static void
+test_nvme_qpair_batch(void)
+{
+	struct spdk_nvme_qpair		qpair = {};
+	struct spdk_nvme_ctrlr		ctrlr = {};
+
+	prepare_submit_request_test(&qpair, &ctrlr);
+
+	/* Batches can't be nested or submitted without being started. */
+	CU_ASSERT(spdk_nvme_qpair_batch_submit(&qpair) == -EINVAL);
+	CU_ASSERT(spdk_nvme_qpair_batch_begin(&qpair) == 0);
+	CU_ASSERT(qpair.batch_submit == 1);
+	CU_ASSERT(spdk_nvme_qpair_batch_begin(&qpair) == -EINVAL);
+	CU_ASSERT(spdk_nvme_qpair_batch_submit(&qpair) == 0);
+	CU_ASSERT(qpair.batch_submit == 0);
+
+	/* Transport errors are returned and end the batch. */
+	CU_ASSERT(spdk_nvme_qpair_batch_begin(&qpair) == 0);
+	MOCK_SET(nvme_transport_qpair_submit_batch, -EIO);
+	CU_ASSERT(spdk_nvme_qpair_batch_submit(&qpair) == -EIO);
+	MOCK_CLEAR(nvme_transport_qpair_submit_batch);
+	CU_ASSERT(qpair.batch_submit == 0);
+
+	/* Admin qpairs don't support batches. */
+	qpair.id = 0;
+	CU_ASSERT(spdk_nvme_qpair_batch_begin(&qpair) == -EINVAL);
+	CU_ASSERT(qpair.batch_submit == 0);
+
+	cleanup_submit_request_test(&qpair);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -634,6 +669,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_qpair_add_cmd_error_injection);
 	CU_ADD_TEST(suite, test_nvme_qpair_submit_request);
 	CU_ADD_TEST(suite, test_nvme_qpair_resubmit_request_with_transport_failed);
+	CU_ADD_TEST(suite, test_nvme_qpair_batch);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
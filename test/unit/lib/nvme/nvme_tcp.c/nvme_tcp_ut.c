@@ -48,6 +48,20 @@ DEFINE_STUB(nvme_qpair_submit_request,
 DEFINE_STUB(spdk_sock_set_priority,
 	    int, (struct spdk_sock *sock, int priority), 0);
 
+static int g_recv_hint_count;
+static uint32_t g_recv_hint_hdr_len;
+static uint32_t g_recv_hint_payload_len;
+
+int
+spdk_sock_set_recv_hint(struct spdk_sock *sock, uint32_t hdr_len, uint32_t payload_len)
+{
+	g_recv_hint_count++;
+	g_recv_hint_hdr_len = hdr_len;
+	g_recv_hint_payload_len = payload_len;
+
+	return 0;
+}
+
 DEFINE_STUB(spdk_nvme_poll_group_remove, int, (struct spdk_nvme_poll_group *group,
 		struct spdk_nvme_qpair *qpair), 0);
 
@@ -441,6 +455,75 @@ test_nvme_tcp_build_iovs_with_md(void)
 		  512 * 8 + SPDK_NVME_TCP_DIGEST_LEN);
 }
 
+static void
+test_nvme_tcp_recv_hint(void)
+{
+	struct nvme_tcp_pdu pdu = {};
+	struct nvme_tcp_recv_hint hint = {};
+	const uint32_t psh_len = sizeof(struct spdk_nvme_tcp_cmd) -
+				 sizeof(struct spdk_nvme_tcp_common_pdu_hdr);
+	const uint32_t hdr_len = sizeof(struct spdk_nvme_tcp_cmd);
+	const uint32_t large_len = NVME_TCP_RECV_HINT_MIN_PAYLOAD * 2;
+
+	g_recv_hint_count = 0;
+
+	/* A capsule with a large payload arms the prediction and limits the header read. */
+	pdu.psh_len = psh_len;
+	pdu.hdr.common.plen = hdr_len + large_len;
+	nvme_tcp_pdu_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 1);
+	CU_ASSERT(g_recv_hint_hdr_len == psh_len);
+	CU_ASSERT(g_recv_hint_payload_len == large_len);
+	CU_ASSERT(hint.hdr_len == hdr_len);
+	CU_ASSERT(hint.payload_len == large_len);
+
+	/* The next common header is expected to be framed the same way. */
+	pdu.ch_valid_bytes = 0;
+	nvme_tcp_ch_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 2);
+	CU_ASSERT(g_recv_hint_hdr_len == hdr_len);
+	CU_ASSERT(g_recv_hint_payload_len == large_len);
+
+	/* Not when part of it has already been received. */
+	pdu.ch_valid_bytes = 1;
+	nvme_tcp_ch_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 2);
+
+	/* A capsule without data clears the prediction. */
+	pdu.ch_valid_bytes = 0;
+	pdu.hdr.common.plen = hdr_len;
+	nvme_tcp_pdu_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 2);
+	CU_ASSERT(hint.payload_len == 0);
+	nvme_tcp_ch_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 2);
+
+	/* Re-arm it, then a capsule with a small payload clears it too. */
+	pdu.hdr.common.plen = hdr_len + large_len;
+	nvme_tcp_pdu_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 3);
+	CU_ASSERT(hint.payload_len == large_len);
+	pdu.hdr.common.plen = hdr_len + NVME_TCP_RECV_HINT_MIN_PAYLOAD - 1;
+	nvme_tcp_pdu_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 3);
+	CU_ASSERT(hint.payload_len == 0);
+	nvme_tcp_ch_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 3);
+
+	/* Interleaved responses don't keep a stale prediction between large transfers. */
+	pdu.hdr.common.plen = hdr_len + large_len;
+	nvme_tcp_pdu_set_recv_hint(NULL, &pdu, &hint);
+	pdu.hdr.common.plen = hdr_len;
+	nvme_tcp_pdu_set_recv_hint(NULL, &pdu, &hint);
+	pdu.hdr.common.plen = hdr_len + large_len / 2;
+	nvme_tcp_pdu_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 5);
+	CU_ASSERT(hint.payload_len == large_len / 2);
+	nvme_tcp_ch_set_recv_hint(NULL, &pdu, &hint);
+	CU_ASSERT(g_recv_hint_count == 6);
+	CU_ASSERT(g_recv_hint_payload_len == large_len / 2);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -455,6 +538,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvme_tcp_build_sgl_request);
 	CU_ADD_TEST(suite, test_nvme_tcp_pdu_set_data_buf_with_md);
 	CU_ADD_TEST(suite, test_nvme_tcp_build_iovs_with_md);
+	CU_ADD_TEST(suite, test_nvme_tcp_recv_hint);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
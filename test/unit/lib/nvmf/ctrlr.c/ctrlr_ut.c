@@ -95,6 +95,11 @@ DEFINE_STUB(nvmf_ctrlr_write_zeroes_supported,
 	    (struct spdk_nvmf_ctrlr *ctrlr),
 	    false);
 
+DEFINE_STUB(nvmf_ctrlr_copy_supported,
+	    bool,
+	    (struct spdk_nvmf_ctrlr *ctrlr),
+	    false);
+
 DEFINE_STUB_V(nvmf_get_discovery_log_page,
 	      (struct spdk_nvmf_tgt *tgt, const char *hostnqn, struct iovec *iov,
 	       uint32_t iovcnt, uint64_t offset, uint32_t length));
@@ -157,6 +162,33 @@ DEFINE_STUB(nvmf_bdev_ctrlr_dsm_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(nvmf_bdev_ctrlr_copy_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB(nvmf_bdev_ctrlr_zone_append_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB(nvmf_bdev_ctrlr_zone_mgmt_send_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB(nvmf_bdev_ctrlr_zone_mgmt_recv_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB_V(nvmf_bdev_ctrlr_identify_iocs_zns,
+	      (struct spdk_nvmf_ns *ns, struct spdk_nvme_zns_ns_data *nsdata_zns));
+
 DEFINE_STUB(nvmf_bdev_ctrlr_nvme_passthru_io,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -340,6 +372,7 @@ test_connect(void)
 	struct spdk_nvmf_tgt tgt;
 	union nvmf_h2c_msg cmd;
 	union nvmf_c2h_msg rsp;
+	union spdk_nvme_cc_register cc;
 	const uint8_t hostid[16] = {
 		0x00, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07,
 		0x08, 0x09, 0x0A, 0x0B, 0x0C, 0x0D, 0x0E, 0x0F
@@ -425,6 +458,14 @@ test_connect(void)
 	CU_ASSERT(nvme_status_success(&rsp.nvme_cpl.status));
 	CU_ASSERT(qpair.ctrlr != NULL);
 	CU_ASSERT(sgroups[subsystem.id].io_outstanding == 0);
+	/* The I/O command set selection is offered even without a zoned namespace */
+	SPDK_CU_ASSERT_FATAL(qpair.ctrlr != NULL);
+	CU_ASSERT(qpair.ctrlr->vcprop.cap.bits.css & SPDK_NVME_CAP_CSS_NVM);
+	CU_ASSERT(qpair.ctrlr->vcprop.cap.bits.css & SPDK_NVME_CAP_CSS_IOCS);
+	cc.raw = 0;
+	cc.bits.css = SPDK_NVME_CC_CSS_IOCS;
+	CU_ASSERT(nvmf_prop_set_cc(qpair.ctrlr, cc.raw) == true);
+	CU_ASSERT(qpair.ctrlr->vcprop.cc.bits.css == SPDK_NVME_CC_CSS_IOCS);
 	nvmf_ctrlr_stop_keep_alive_timer(qpair.ctrlr);
 	spdk_bit_array_free(&qpair.ctrlr->qpair_mask);
 	free(qpair.ctrlr);
@@ -634,6 +675,7 @@ test_connect(void)
 	CU_ASSERT(qpair.ctrlr != NULL);
 	CU_ASSERT(qpair.ctrlr->keep_alive_poller != NULL);
 	CU_ASSERT(sgroups[subsystem.id].io_outstanding == 0);
+	CU_ASSERT(!(qpair.ctrlr->vcprop.cap.bits.css & SPDK_NVME_CAP_CSS_IOCS));
 	nvmf_ctrlr_stop_keep_alive_timer(qpair.ctrlr);
 	spdk_bit_array_free(&qpair.ctrlr->qpair_mask);
 	free(qpair.ctrlr);
@@ -882,6 +924,19 @@ test_get_ns_id_desc_list(void)
 	CU_ASSERT(buf[36] == 0x33);
 	CU_ASSERT(buf[51] == 0xDD);
 	CU_ASSERT(buf[53] == 0);
+
+	/* Valid NSID, all IDs defined and the I/O command set reported */
+	ctrlr.vcprop.cc.bits.css = SPDK_NVME_CC_CSS_IOCS;
+	ns.csi = SPDK_NVME_CSI_ZNS;
+	memset(&rsp, 0, sizeof(rsp));
+	CU_ASSERT(nvmf_ctrlr_process_admin_cmd(&req) == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+	CU_ASSERT(buf[32] == SPDK_NVME_NIDT_UUID);
+	CU_ASSERT(buf[52] == SPDK_NVME_NIDT_CSI);
+	CU_ASSERT(buf[53] == 1);
+	CU_ASSERT(buf[56] == SPDK_NVME_CSI_ZNS);
+	CU_ASSERT(buf[58] == 0);
 }
 
 static void
@@ -1568,6 +1623,7 @@ test_fused_compare_and_write(void)
 	sgroups.num_ns = 1;
 	sgroups.ns_info = &ns_info;
 	TAILQ_INIT(&sgroups.queued);
+	TAILQ_INIT(&sgroups.host_stats);
 	group.sgroups = &sgroups;
 	TAILQ_INIT(&qpair.outstanding);
 
@@ -1627,6 +1683,225 @@ test_fused_compare_and_write(void)
 	spdk_nvmf_request_exec(&req);
 	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_OPCODE);
 	CU_ASSERT(qpair.first_fused_req == NULL);
+
+	SPDK_CU_ASSERT_FATAL(qpair.io_stats != NULL);
+	free(qpair.io_stats->ns);
+	free(qpair.io_stats);
+}
+
+static int g_ns_paused_status;
+
+static void
+ns_paused_done(void *cb_arg, int status)
+{
+	g_ns_paused_status = status;
+}
+
+static void
+test_paused_ns_io(void)
+{
+	struct spdk_nvmf_request req = {};
+	struct spdk_nvmf_qpair qpair = {};
+	struct spdk_nvme_cmd cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_ctrlr ctrlr = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns = {};
+	struct spdk_nvmf_ns *subsys_ns[1] = {};
+	struct spdk_nvmf_subsystem_listener listener = {};
+	struct spdk_bdev bdev = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info = {};
+
+	ns.bdev = &bdev;
+	subsystem.id = 0;
+	subsystem.max_nsid = 1;
+	subsys_ns[0] = &ns;
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+	listener.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	ctrlr.vcprop.cc.bits.en = 1;
+	ctrlr.subsys = &subsystem;
+	ctrlr.listener = &listener;
+
+	group.num_sgroups = 1;
+	group.thread = spdk_get_thread();
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 1;
+	sgroups.ns_info = &ns_info;
+	sgroups.cb_fn = ns_paused_done;
+	TAILQ_INIT(&sgroups.queued);
+	TAILQ_INIT(&sgroups.host_stats);
+	group.sgroups = &sgroups;
+	TAILQ_INIT(&qpair.outstanding);
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+
+	cmd.nsid = 1;
+	cmd.opc = SPDK_NVME_OPC_READ;
+	req.qpair = &qpair;
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+
+	/* I/O is accounted to its namespace while it is outstanding */
+	MOCK_SET(nvmf_bdev_ctrlr_read_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	spdk_nvmf_request_exec(&req);
+	CU_ASSERT(ns_info.io_outstanding == 1);
+	CU_ASSERT(sgroups.io_outstanding == 1);
+
+	/* The namespace finishes pausing once its last I/O completes */
+	ns_info.state = SPDK_NVMF_SUBSYSTEM_PAUSING;
+	g_ns_paused_status = -1;
+	spdk_nvmf_request_complete(&req);
+	CU_ASSERT(ns_info.io_outstanding == 0);
+	CU_ASSERT(ns_info.state == SPDK_NVMF_SUBSYSTEM_PAUSED);
+	CU_ASSERT(g_ns_paused_status == 0);
+
+	/* New I/O to the paused namespace is queued */
+	spdk_nvmf_request_exec(&req);
+	CU_ASSERT(TAILQ_FIRST(&sgroups.queued) == &req);
+	CU_ASSERT(ns_info.io_outstanding == 0);
+	CU_ASSERT(TAILQ_EMPTY(&qpair.outstanding));
+
+	/* I/O to an NSID the poll group doesn't know fails instead of being queued */
+	TAILQ_INIT(&sgroups.queued);
+	cmd.nsid = 2;
+	spdk_nvmf_request_exec(&req);
+	CU_ASSERT(TAILQ_EMPTY(&sgroups.queued));
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_NAMESPACE_OR_FORMAT);
+	CU_ASSERT(sgroups.io_outstanding == 0);
+
+	/* Admin commands referring to the paused namespace are queued as well */
+	qpair.qid = 0;
+	cmd.nsid = 1;
+	cmd.opc = SPDK_NVME_OPC_IDENTIFY;
+	spdk_nvmf_request_exec(&req);
+	CU_ASSERT(TAILQ_FIRST(&sgroups.queued) == &req);
+	CU_ASSERT(TAILQ_EMPTY(&qpair.outstanding));
+
+	/* AERs aren't, as they'd keep the namespace from ever pausing */
+	TAILQ_INIT(&sgroups.queued);
+	cmd.opc = SPDK_NVME_OPC_ASYNC_EVENT_REQUEST;
+	spdk_nvmf_request_exec(&req);
+	CU_ASSERT(TAILQ_EMPTY(&sgroups.queued));
+	CU_ASSERT(ctrlr.aer_req[0] == &req);
+	CU_ASSERT(ns_info.io_outstanding == 0);
+	CU_ASSERT(sgroups.io_outstanding == 0);
+	ctrlr.aer_req[0] = NULL;
+	ctrlr.nr_aer_reqs = 0;
+	TAILQ_INIT(&qpair.outstanding);
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_read_cmd);
+	SPDK_CU_ASSERT_FATAL(qpair.io_stats != NULL);
+	free(qpair.io_stats->ns);
+	free(qpair.io_stats);
+}
+
+static void
+test_io_stats(void)
+{
+	struct spdk_nvmf_request req = {};
+	struct spdk_nvmf_qpair qpair = {}, qpair2 = {};
+	struct spdk_nvme_cmd cmd = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvmf_ctrlr ctrlr = {}, ctrlr2 = {};
+	struct spdk_nvmf_subsystem subsystem = {};
+	struct spdk_nvmf_ns ns[2] = {};
+	struct spdk_nvmf_ns *subsys_ns[2] = {};
+	struct spdk_nvmf_subsystem_listener listener = {};
+	struct spdk_bdev bdev = {};
+	struct spdk_nvmf_poll_group group = {};
+	struct spdk_nvmf_subsystem_poll_group sgroups = {};
+	struct spdk_nvmf_subsystem_pg_ns_info ns_info[2] = {};
+	struct spdk_nvmf_host_io_stats *stats;
+	struct spdk_nvmf_ns_io_stat *ns_stat;
+
+	ns[0].bdev = &bdev;
+	ns[1].bdev = &bdev;
+	subsystem.id = 0;
+	subsystem.max_nsid = 2;
+	subsys_ns[0] = &ns[0];
+	subsys_ns[1] = &ns[1];
+	subsystem.ns = (struct spdk_nvmf_ns **)&subsys_ns;
+	listener.ana_state = SPDK_NVME_ANA_OPTIMIZED_STATE;
+
+	ctrlr.vcprop.cc.bits.en = 1;
+	ctrlr.subsys = &subsystem;
+	ctrlr.listener = &listener;
+	snprintf(ctrlr.hostnqn, sizeof(ctrlr.hostnqn), "nqn.2016-06.io.spdk:host1");
+	/* A second controller of the same host */
+	ctrlr2 = ctrlr;
+
+	group.num_sgroups = 1;
+	group.thread = spdk_get_thread();
+	/* Each histogram bucket is twice as wide as the previous one, starting at 1 tick */
+	group.io_stat_tick_shift = 0;
+	sgroups.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+	sgroups.num_ns = 2;
+	sgroups.ns_info = ns_info;
+	TAILQ_INIT(&sgroups.queued);
+	TAILQ_INIT(&sgroups.host_stats);
+	group.sgroups = &sgroups;
+	TAILQ_INIT(&qpair.outstanding);
+	TAILQ_INIT(&qpair2.outstanding);
+
+	qpair.ctrlr = &ctrlr;
+	qpair.group = &group;
+	qpair.qid = 1;
+	qpair.state = SPDK_NVMF_QPAIR_ACTIVE;
+	qpair2 = qpair;
+	qpair2.ctrlr = &ctrlr2;
+	TAILQ_INIT(&qpair2.outstanding);
+
+	cmd.nsid = 2;
+	cmd.opc = SPDK_NVME_OPC_READ;
+	req.qpair = &qpair;
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+	req.length = 4096;
+
+	/* A read that takes 5 ticks lands in the bucket of [4, 8) ticks */
+	MOCK_SET(nvmf_bdev_ctrlr_read_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	spdk_nvmf_request_exec(&req);
+	spdk_delay_us(5);
+	spdk_nvmf_request_complete(&req);
+
+	stats = TAILQ_FIRST(&sgroups.host_stats);
+	SPDK_CU_ASSERT_FATAL(stats != NULL);
+	CU_ASSERT(qpair.io_stats == stats);
+	CU_ASSERT(strcmp(stats->hostnqn, ctrlr.hostnqn) == 0);
+	SPDK_CU_ASSERT_FATAL(stats->num_ns == 2);
+	ns_stat = &stats->ns[1];
+	CU_ASSERT(ns_stat->ops[SPDK_NVMF_IO_STAT_READ] == 1);
+	CU_ASSERT(ns_stat->bytes[SPDK_NVMF_IO_STAT_READ] == 4096);
+	CU_ASSERT(ns_stat->latency_ticks[SPDK_NVMF_IO_STAT_READ] == 5);
+	CU_ASSERT(ns_stat->latency_buckets[SPDK_NVMF_IO_STAT_READ][3] == 1);
+	CU_ASSERT(ns_stat->ops[SPDK_NVMF_IO_STAT_WRITE] == 0);
+	CU_ASSERT(ns_stat->errors == 0);
+	CU_ASSERT(stats->ns[0].ops[SPDK_NVMF_IO_STAT_READ] == 0);
+
+	/* I/O from another controller of the same host adds up to the same statistics */
+	req.qpair = &qpair2;
+	cmd.opc = SPDK_NVME_OPC_FLUSH;
+	MOCK_SET(nvmf_bdev_ctrlr_flush_cmd, SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	spdk_nvmf_request_exec(&req);
+	rsp.nvme_cpl.status.sc = SPDK_NVME_SC_INTERNAL_DEVICE_ERROR;
+	spdk_nvmf_request_complete(&req);
+
+	CU_ASSERT(qpair2.io_stats == stats);
+	CU_ASSERT(TAILQ_NEXT(stats, link) == NULL);
+	CU_ASSERT(ns_stat->ops[SPDK_NVMF_IO_STAT_OTHER] == 1);
+	CU_ASSERT(ns_stat->latency_buckets[SPDK_NVMF_IO_STAT_OTHER][0] == 1);
+	CU_ASSERT(ns_stat->errors == 1);
+
+	MOCK_CLEAR(nvmf_bdev_ctrlr_read_cmd);
+	MOCK_CLEAR(nvmf_bdev_ctrlr_flush_cmd);
+	free(stats->ns);
+	free(stats);
 }
 
 static void
@@ -1787,6 +2062,8 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_identify_ctrlr);
 	CU_ADD_TEST(suite, test_custom_admin_cmd);
 	CU_ADD_TEST(suite, test_fused_compare_and_write);
+	CU_ADD_TEST(suite, test_paused_ns_io);
+	CU_ADD_TEST(suite, test_io_stats);
 	CU_ADD_TEST(suite, test_multi_async_event_reqs);
 	CU_ADD_TEST(suite, test_get_ana_log_page);
 
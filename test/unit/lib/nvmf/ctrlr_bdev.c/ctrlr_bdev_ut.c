@@ -37,6 +37,7 @@
 
 #include "spdk_internal/mock.h"
 
+#include "common/lib/test_env.c"
 #include "nvmf/ctrlr_bdev.c"
 
 
@@ -50,6 +51,7 @@ struct spdk_bdev {
 	uint32_t blocklen;
 	uint64_t num_blocks;
 	uint32_t md_len;
+	uint64_t zone_size;
 };
 
 uint32_t
@@ -77,6 +79,50 @@ spdk_bdev_get_md_size(const struct spdk_bdev *bdev)
 	return bdev->md_len;
 }
 
+uint64_t
+spdk_bdev_get_zone_size(const struct spdk_bdev *bdev)
+{
+	return bdev->zone_size;
+}
+
+DEFINE_STUB(spdk_bdev_get_max_open_zones, uint32_t, (const struct spdk_bdev *bdev), 0);
+
+DEFINE_STUB(spdk_bdev_zone_appendv, int,
+	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct iovec *iov, int iovcnt, uint64_t zone_id, uint64_t num_blocks,
+	     spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+
+DEFINE_STUB(spdk_bdev_zone_management, int,
+	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     uint64_t zone_id, enum spdk_bdev_zone_action action,
+	     spdk_bdev_io_completion_cb cb, void *cb_arg), 0);
+
+DEFINE_STUB(spdk_bdev_io_get_append_location, uint64_t, (struct spdk_bdev_io *bdev_io), 0);
+
+static struct spdk_bdev *g_zone_bdev;
+static enum spdk_bdev_zone_state g_zone_states[16];
+
+int
+spdk_bdev_get_zone_info(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+			uint64_t zone_id, size_t num_zones, struct spdk_bdev_zone_info *info,
+			spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	uint64_t zone_size = g_zone_bdev->zone_size;
+	size_t i;
+
+	SPDK_CU_ASSERT_FATAL(zone_id + num_zones * zone_size <= g_zone_bdev->num_blocks);
+
+	for (i = 0; i < num_zones; i++) {
+		info[i].zone_id = zone_id + i * zone_size;
+		info[i].write_pointer = info[i].zone_id;
+		info[i].capacity = zone_size;
+		info[i].state = g_zone_states[info[i].zone_id / zone_size];
+	}
+
+	cb(NULL, true, cb_arg);
+	return 0;
+}
+
 DEFINE_STUB(spdk_bdev_comparev_and_writev_blocks, int,
 	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
 	     struct iovec *compare_iov, int compare_iovcnt,
@@ -123,11 +169,46 @@ DEFINE_STUB(spdk_bdev_queue_io_wait, int,
 	     struct spdk_bdev_io_wait_entry *entry),
 	    0);
 
-DEFINE_STUB(spdk_bdev_write_blocks, int,
-	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, void *buf,
-	     uint64_t offset_blocks, uint64_t num_blocks,
-	     spdk_bdev_io_completion_cb cb, void *cb_arg),
-	    0);
+DEFINE_STUB(spdk_bdev_is_zoned, bool, (const struct spdk_bdev *bdev), false);
+
+DEFINE_STUB(spdk_bdev_get_buf_align, size_t, (const struct spdk_bdev *bdev), 0);
+
+/* Reads and writes done by an emulated Copy, in order */
+static struct {
+	bool		write;
+	uint64_t	offset_blocks;
+	uint64_t	num_blocks;
+	uint64_t	buf_offset;
+} g_copy_ios[8];
+static uint32_t g_num_copy_ios;
+static void *g_copy_buf;
+
+static int
+ut_copy_io(bool write, void *buf, uint64_t offset_blocks, uint64_t num_blocks,
+	   spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	SPDK_CU_ASSERT_FATAL(g_num_copy_ios < SPDK_COUNTOF(g_copy_ios));
+
+	if (g_copy_buf == NULL) {
+		g_copy_buf = buf;
+	}
+	g_copy_ios[g_num_copy_ios].write = write;
+	g_copy_ios[g_num_copy_ios].offset_blocks = offset_blocks;
+	g_copy_ios[g_num_copy_ios].num_blocks = num_blocks;
+	g_copy_ios[g_num_copy_ios].buf_offset = (uint8_t *)buf - (uint8_t *)g_copy_buf;
+	g_num_copy_ios++;
+
+	cb(NULL, true, cb_arg);
+	return 0;
+}
+
+int
+spdk_bdev_write_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, void *buf,
+		       uint64_t offset_blocks, uint64_t num_blocks,
+		       spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return ut_copy_io(true, buf, offset_blocks, num_blocks, cb, cb_arg);
+}
 
 DEFINE_STUB(spdk_bdev_writev_blocks, int,
 	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -135,11 +216,13 @@ DEFINE_STUB(spdk_bdev_writev_blocks, int,
 	     spdk_bdev_io_completion_cb cb, void *cb_arg),
 	    0);
 
-DEFINE_STUB(spdk_bdev_read_blocks, int,
-	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, void *buf,
-	     uint64_t offset_blocks, uint64_t num_blocks,
-	     spdk_bdev_io_completion_cb cb, void *cb_arg),
-	    0);
+int
+spdk_bdev_read_blocks(struct spdk_bdev_desc *desc, struct spdk_io_channel *ch, void *buf,
+		      uint64_t offset_blocks, uint64_t num_blocks,
+		      spdk_bdev_io_completion_cb cb, void *cb_arg)
+{
+	return ut_copy_io(false, buf, offset_blocks, num_blocks, cb, cb_arg);
+}
 
 DEFINE_STUB(spdk_bdev_readv_blocks, int,
 	    (struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -391,6 +474,207 @@ test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd(void)
 	CU_ASSERT(write_rsp.nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
 }
 
+static void
+test_nvmf_bdev_ctrlr_zone_cmds(void)
+{
+	struct spdk_bdev bdev = {};
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel ch = {};
+	struct spdk_nvmf_request req = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvme_cmd cmd = {};
+	struct spdk_nvme_zns_zone_report *report;
+	uint8_t buf[sizeof(*report) + 4 * sizeof(struct spdk_nvme_zns_zone_desc)];
+	struct iovec iov;
+	uint32_t i;
+	int rc;
+
+	bdev.blocklen = 512;
+	bdev.zone_size = 16;
+	bdev.num_blocks = 16 * SPDK_COUNTOF(g_zone_states);
+	g_zone_bdev = &bdev;
+
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+
+	/* Zone append to the start of a zone */
+	cmd.opc = SPDK_NVME_OPC_ZONE_APPEND;
+	cmd.cdw10 = 32;		/* ZSLBA: CDW10 and CDW11 */
+	cmd.cdw12 = 7;		/* NLB: CDW12 bits 15:00, 0's based */
+	req.length = 8 * bdev.blocklen;
+
+	rc = nvmf_bdev_ctrlr_zone_append_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	/* ZSLBA in the middle of a zone */
+	cmd.cdw10 = 33;
+	memset(&rsp, 0, sizeof(rsp));
+
+	rc = nvmf_bdev_ctrlr_zone_append_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_GENERIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+
+	/* Append larger than the zone */
+	cmd.cdw10 = 32;
+	cmd.cdw12 = 16;
+	req.length = 17 * bdev.blocklen;
+	memset(&rsp, 0, sizeof(rsp));
+
+	rc = nvmf_bdev_ctrlr_zone_append_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_COMMAND_SPECIFIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_ZONE_BOUNDARY_ERROR);
+
+	/* Zone management send with an offline action is not supported */
+	memset(&cmd, 0, sizeof(cmd));
+	memset(&rsp, 0, sizeof(rsp));
+	cmd.opc = SPDK_NVME_OPC_ZONE_MGMT_SEND;
+	cmd.cdw10 = 16;		/* SLBA: CDW10 and CDW11 */
+	cmd.cdw13 = SPDK_NVME_ZONE_OFFLINE;
+
+	rc = nvmf_bdev_ctrlr_zone_mgmt_send_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+
+	cmd.cdw13 = SPDK_NVME_ZONE_RESET;
+	rc = nvmf_bdev_ctrlr_zone_mgmt_send_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+
+	/* Zone report of closed zones, starting in the middle of zone 1 */
+	for (i = 0; i < SPDK_COUNTOF(g_zone_states); i++) {
+		g_zone_states[i] = (i % 3 == 0) ? SPDK_BDEV_ZONE_STATE_CLOSED : SPDK_BDEV_ZONE_STATE_EMPTY;
+	}
+
+	memset(&cmd, 0, sizeof(cmd));
+	memset(&rsp, 0, sizeof(rsp));
+	memset(buf, 0xFF, sizeof(buf));
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	req.iov[0] = iov;
+	req.iovcnt = 1;
+	req.length = sizeof(buf);
+	report = (struct spdk_nvme_zns_zone_report *)buf;
+
+	cmd.opc = SPDK_NVME_OPC_ZONE_MGMT_RECV;
+	cmd.cdw10 = 20;				/* SLBA: CDW10 and CDW11 */
+	cmd.cdw12 = sizeof(buf) / 4 - 1;	/* NUMD: 0's based */
+	cmd.cdw13 = SPDK_NVME_ZONE_REPORT | (SPDK_NVME_ZRA_LIST_ZSC << 8);
+
+	rc = nvmf_bdev_ctrlr_zone_mgmt_recv_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	/* Zones 3, 6, 9, 12 and 15 are closed, only 4 fit in the buffer */
+	CU_ASSERT(report->nr_zones == 5);
+	CU_ASSERT(report->descs[0].zslba == 48);
+	CU_ASSERT(report->descs[0].zs == SPDK_NVME_ZONE_STATE_CLOSED);
+	CU_ASSERT(report->descs[0].zcap == 16);
+	CU_ASSERT(report->descs[3].zslba == 192);
+
+	/* Partial report only counts the returned zones */
+	cmd.cdw13 |= 1u << 16;
+	rc = nvmf_bdev_ctrlr_zone_mgmt_recv_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(report->nr_zones == 4);
+
+	/* Extended reports are not supported */
+	cmd.cdw13 = 0x1;	/* ZRA: Extended Report */
+	memset(&rsp, 0, sizeof(rsp));
+	rc = nvmf_bdev_ctrlr_zone_mgmt_recv_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+}
+
+static void
+test_nvmf_bdev_ctrlr_copy_cmd(void)
+{
+	struct spdk_bdev bdev = {};
+	struct spdk_bdev_desc *desc = NULL;
+	struct spdk_io_channel ch = {};
+	struct spdk_nvmf_request req = {};
+	union nvmf_c2h_msg rsp = {};
+	struct spdk_nvme_cmd cmd = {};
+	struct spdk_nvme_scc_source_range ranges[2] = {};
+	int rc;
+
+	bdev.blocklen = 512;
+	bdev.num_blocks = 4096;
+
+	ranges[0].slba = 0;
+	ranges[0].nlb = 9;
+	ranges[1].slba = 100;
+	ranges[1].nlb = 299;
+
+	req.cmd = (union nvmf_h2c_msg *)&cmd;
+	req.rsp = &rsp;
+	req.data = ranges;
+	req.length = sizeof(ranges);
+
+	cmd.opc = SPDK_NVME_OPC_COPY;
+	cmd.cdw10 = 1000;	/* SDLBA: CDW10 and CDW11 */
+	cmd.cdw12 = 1;		/* NR: CDW12 bits 07:00, 0's based */
+
+	/* The bdev must support reads and writes */
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_OPCODE);
+
+	MOCK_SET(spdk_bdev_io_type_supported, true);
+
+	/*
+	 * 310 blocks go through a 256 block buffer: the first range and the start of
+	 * the second one fill it, then the rest of the second range is written.
+	 */
+	g_num_copy_ios = 0;
+	g_copy_buf = NULL;
+	memset(&rsp, 0, sizeof(rsp));
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_ASYNCHRONOUS);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_SUCCESS);
+	SPDK_CU_ASSERT_FATAL(g_num_copy_ios == 5);
+	CU_ASSERT(!g_copy_ios[0].write && g_copy_ios[0].offset_blocks == 0 &&
+		  g_copy_ios[0].num_blocks == 10 && g_copy_ios[0].buf_offset == 0);
+	CU_ASSERT(!g_copy_ios[1].write && g_copy_ios[1].offset_blocks == 100 &&
+		  g_copy_ios[1].num_blocks == 246 && g_copy_ios[1].buf_offset == 10 * 512);
+	CU_ASSERT(g_copy_ios[2].write && g_copy_ios[2].offset_blocks == 1000 &&
+		  g_copy_ios[2].num_blocks == 256 && g_copy_ios[2].buf_offset == 0);
+	CU_ASSERT(!g_copy_ios[3].write && g_copy_ios[3].offset_blocks == 346 &&
+		  g_copy_ios[3].num_blocks == 54 && g_copy_ios[3].buf_offset == 0);
+	CU_ASSERT(g_copy_ios[4].write && g_copy_ios[4].offset_blocks == 1256 &&
+		  g_copy_ios[4].num_blocks == 54 && g_copy_ios[4].buf_offset == 0);
+
+	/* Only descriptor format 0 is supported */
+	cmd.cdw12 = 1 | (1 << 8);
+	memset(&rsp, 0, sizeof(rsp));
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_INVALID_FIELD);
+
+	/* More ranges than MSRC */
+	cmd.cdw12 = NVMF_BDEV_CTRLR_COPY_MAX_RANGES;
+	memset(&rsp, 0, sizeof(rsp));
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sct == SPDK_NVME_SCT_COMMAND_SPECIFIC);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_CMD_SIZE_LIMIT_SIZE_EXCEEDED);
+
+	/* More ranges than the data holds */
+	cmd.cdw12 = 2;
+	memset(&rsp, 0, sizeof(rsp));
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_DATA_SGL_LENGTH_INVALID);
+
+	/* Destination past the end of the namespace */
+	cmd.cdw10 = 4000;
+	cmd.cdw12 = 1;
+	memset(&rsp, 0, sizeof(rsp));
+	rc = nvmf_bdev_ctrlr_copy_cmd(&bdev, desc, &ch, &req);
+	CU_ASSERT(rc == SPDK_NVMF_REQUEST_EXEC_STATUS_COMPLETE);
+	CU_ASSERT(rsp.nvme_cpl.status.sc == SPDK_NVME_SC_LBA_OUT_OF_RANGE);
+
+	MOCK_CLEAR(spdk_bdev_io_type_supported);
+}
+
 int main(int argc, char **argv)
 {
 	CU_pSuite	suite = NULL;
@@ -406,6 +690,8 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_get_dif_ctx);
 
 	CU_ADD_TEST(suite, test_spdk_nvmf_bdev_ctrlr_compare_and_write_cmd);
+	CU_ADD_TEST(suite, test_nvmf_bdev_ctrlr_zone_cmds);
+	CU_ADD_TEST(suite, test_nvmf_bdev_ctrlr_copy_cmd);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
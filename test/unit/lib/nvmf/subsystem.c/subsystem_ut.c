@@ -59,6 +59,9 @@ DEFINE_STUB(spdk_bdev_get_md_size, uint32_t,
 DEFINE_STUB(spdk_bdev_is_md_interleaved, bool,
 	    (const struct spdk_bdev *bdev), false);
 
+DEFINE_STUB(spdk_bdev_is_zoned, bool,
+	    (const struct spdk_bdev *bdev), false);
+
 DEFINE_STUB(spdk_nvmf_transport_stop_listen,
 	    int,
 	    (struct spdk_nvmf_transport *transport,
@@ -144,6 +147,20 @@ nvmf_poll_group_resume_subsystem(struct spdk_nvmf_poll_group *group,
 {
 }
 
+void
+nvmf_poll_group_pause_ns(struct spdk_nvmf_poll_group *group,
+			 struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			 spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg)
+{
+}
+
+void
+nvmf_poll_group_resume_ns(struct spdk_nvmf_poll_group *group,
+			  struct spdk_nvmf_subsystem *subsystem, uint32_t nsid,
+			  spdk_nvmf_poll_group_mod_done cb_fn, void *cb_arg)
+{
+}
+
 int
 spdk_nvme_transport_id_parse_trtype(enum spdk_nvme_transport_type *trtype, const char *str)
 {
@@ -310,6 +327,7 @@ test_spdk_nvmf_subsystem_add_ns(void)
 	rc = spdk_nvmf_subsystem_remove_ns(&subsystem, 5);
 	CU_ASSERT(rc == 0);
 
+	spdk_bit_array_free(&subsystem.paused_ns);
 	free(subsystem.ns);
 	free(tgt.subsystems);
 }
@@ -1303,34 +1321,129 @@ test_spdk_nvmf_ns_event(void)
 	/* Add one controller */
 	TAILQ_INIT(&subsystem.ctrlrs);
 	TAILQ_INSERT_TAIL(&subsystem.ctrlrs, &ctrlr, link);
+	TAILQ_INIT(&subsystem.removed_ns);
 
-	/* Namespace resize event */
+	/* Namespace resize event, only the namespace is paused */
 	subsystem.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
 	g_ns_changed_nsid = 0xFFFFFFFF;
 	g_ns_changed_ctrlr = NULL;
 	nvmf_ns_event(SPDK_BDEV_EVENT_RESIZE, bdev, subsystem.ns[0]);
-	CU_ASSERT(SPDK_NVMF_SUBSYSTEM_PAUSING == subsystem.state);
+	CU_ASSERT(SPDK_NVMF_SUBSYSTEM_ACTIVE == subsystem.state);
+	CU_ASSERT(subsystem.changing_state == true);
 
 	poll_threads();
-	CU_ASSERT(1 == g_ns_changed_nsid);
-	CU_ASSERT(&ctrlr == g_ns_changed_ctrlr);
+	/* The poll groups report the change to the controllers on resume */
+	CU_ASSERT(0xFFFFFFFF == g_ns_changed_nsid);
+	CU_ASSERT(subsystem.changing_state == false);
+	CU_ASSERT(!spdk_bit_array_get(subsystem.paused_ns, 0));
 	CU_ASSERT(SPDK_NVMF_SUBSYSTEM_ACTIVE == subsystem.state);
 
 	/* Namespace remove event */
-	subsystem.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
-	g_ns_changed_nsid = 0xFFFFFFFF;
-	g_ns_changed_ctrlr = NULL;
 	nvmf_ns_event(SPDK_BDEV_EVENT_REMOVE, bdev, subsystem.ns[0]);
-	CU_ASSERT(SPDK_NVMF_SUBSYSTEM_PAUSING == subsystem.state);
-	CU_ASSERT(0xFFFFFFFF == g_ns_changed_nsid);
-	CU_ASSERT(NULL == g_ns_changed_ctrlr);
+	CU_ASSERT(SPDK_NVMF_SUBSYSTEM_ACTIVE == subsystem.state);
+	CU_ASSERT(NULL != subsystem.ns[0]);
 
 	poll_threads();
-	CU_ASSERT(1 == g_ns_changed_nsid);
-	CU_ASSERT(&ctrlr == g_ns_changed_ctrlr);
 	CU_ASSERT(NULL == subsystem.ns[0]);
+	CU_ASSERT(TAILQ_EMPTY(&subsystem.removed_ns));
+	CU_ASSERT(!spdk_bit_array_get(subsystem.paused_ns, 0));
 	CU_ASSERT(SPDK_NVMF_SUBSYSTEM_ACTIVE == subsystem.state);
 
+	/* The same notifications reach the controllers when the whole subsystem is paused */
+	nsid = spdk_nvmf_subsystem_add_ns_ext(&subsystem, "bdev1", &ns_opts, sizeof(ns_opts), NULL);
+	CU_ASSERT(nsid == 0);
+	subsystem.state = SPDK_NVMF_SUBSYSTEM_PAUSED;
+	nsid = spdk_nvmf_subsystem_add_ns_ext(&subsystem, "bdev1", &ns_opts, sizeof(ns_opts), NULL);
+	CU_ASSERT(nsid == 1);
+	CU_ASSERT(1 == g_ns_changed_nsid);
+	CU_ASSERT(&ctrlr == g_ns_changed_ctrlr);
+	CU_ASSERT(spdk_nvmf_subsystem_remove_ns(&subsystem, 1) == 0);
+
+	spdk_bit_array_free(&subsystem.paused_ns);
+	free(subsystem.ns);
+	free(tgt.subsystems);
+}
+
+static void
+ns_state_change_done(struct spdk_nvmf_subsystem *subsystem, void *cb_arg, int status)
+{
+	*(int *)cb_arg = status;
+}
+
+static void
+test_spdk_nvmf_subsystem_pause_ns(void)
+{
+	struct spdk_nvmf_tgt tgt = {};
+	struct spdk_nvmf_subsystem subsystem = {
+		.max_nsid = 0,
+		.ns = NULL,
+		.tgt = &tgt
+	};
+	struct spdk_nvmf_ns_opts ns_opts;
+	struct spdk_nvmf_ns *ns;
+	uint32_t nsid;
+	int status;
+
+	tgt.max_subsystems = 1024;
+	tgt.subsystems = calloc(tgt.max_subsystems, sizeof(struct spdk_nvmf_subsystem *));
+	SPDK_CU_ASSERT_FATAL(tgt.subsystems != NULL);
+	TAILQ_INIT(&subsystem.ctrlrs);
+	TAILQ_INIT(&subsystem.removed_ns);
+
+	spdk_nvmf_ns_opts_get_defaults(&ns_opts, sizeof(ns_opts));
+	ns_opts.nsid = 2;
+	nsid = spdk_nvmf_subsystem_add_ns_ext(&subsystem, "bdev1", &ns_opts, sizeof(ns_opts), NULL);
+	CU_ASSERT(nsid == 2);
+	subsystem.state = SPDK_NVMF_SUBSYSTEM_ACTIVE;
+
+	/* A namespace can't be added to a running subsystem without pausing it */
+	ns_opts.nsid = 1;
+	nsid = spdk_nvmf_subsystem_add_ns_ext(&subsystem, "bdev2", &ns_opts, sizeof(ns_opts), NULL);
+	CU_ASSERT(nsid == 0);
+
+	/* Invalid NSIDs */
+	CU_ASSERT(spdk_nvmf_subsystem_pause_ns(&subsystem, 0, NULL, NULL) == -EINVAL);
+	CU_ASSERT(spdk_nvmf_subsystem_pause_ns(&subsystem, 3, NULL, NULL) == -EINVAL);
+
+	/* Pause a free NSID and add a namespace to it */
+	status = -1;
+	CU_ASSERT(spdk_nvmf_subsystem_pause_ns(&subsystem, 1, ns_state_change_done, &status) == 0);
+	CU_ASSERT(spdk_nvmf_subsystem_pause_ns(&subsystem, 2, NULL, NULL) == -EBUSY);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(spdk_nvmf_subsystem_pause_ns(&subsystem, 1, NULL, NULL) == -EBUSY);
+
+	nsid = spdk_nvmf_subsystem_add_ns_ext(&subsystem, "bdev2", &ns_opts, sizeof(ns_opts), NULL);
+	CU_ASSERT(nsid == 1);
+
+	status = -1;
+	CU_ASSERT(spdk_nvmf_subsystem_resume_ns(&subsystem, 1, ns_state_change_done, &status) == 0);
+	poll_threads();
+	CU_ASSERT(status == 0);
+	CU_ASSERT(spdk_nvmf_subsystem_resume_ns(&subsystem, 1, NULL, NULL) == -EINVAL);
+	CU_ASSERT(!nvmf_subsystem_ns_can_change(&subsystem, 1));
+	CU_ASSERT(!nvmf_subsystem_ns_can_change(&subsystem, 2));
+
+	/* Pause and remove the other namespace */
+	CU_ASSERT(spdk_nvmf_subsystem_pause_ns(&subsystem, 2, NULL, NULL) == 0);
+	poll_threads();
+	CU_ASSERT(spdk_nvmf_subsystem_remove_ns(&subsystem, 2) == 0);
+	CU_ASSERT(subsystem.ns[1] == NULL);
+	/* The namespace is only freed once every poll group has resumed it */
+	ns = TAILQ_FIRST(&subsystem.removed_ns);
+	SPDK_CU_ASSERT_FATAL(ns != NULL);
+	CU_ASSERT(ns->nsid == 2);
+	CU_ASSERT(spdk_nvmf_subsystem_resume_ns(&subsystem, 2, NULL, NULL) == 0);
+	CU_ASSERT(TAILQ_FIRST(&subsystem.removed_ns) == ns);
+	poll_threads();
+	CU_ASSERT(TAILQ_EMPTY(&subsystem.removed_ns));
+	CU_ASSERT(subsystem.ns[1] == NULL);
+	CU_ASSERT(subsystem.ns[0] != NULL);
+
+	subsystem.state = SPDK_NVMF_SUBSYSTEM_INACTIVE;
+	CU_ASSERT(spdk_nvmf_subsystem_remove_ns(&subsystem, 1) == 0);
+
+	spdk_bit_array_free(&subsystem.paused_ns);
 	free(subsystem.ns);
 	free(tgt.subsystems);
 }
@@ -1360,6 +1473,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_reservation_clear_notification);
 	CU_ADD_TEST(suite, test_reservation_preempt_notification);
 	CU_ADD_TEST(suite, test_spdk_nvmf_ns_event);
+	CU_ADD_TEST(suite, test_spdk_nvmf_subsystem_pause_ns);
 
 	allocate_threads(1);
 	set_thread(0);
@@ -121,6 +121,11 @@ DEFINE_STUB(nvmf_ctrlr_write_zeroes_supported,
 	    (struct spdk_nvmf_ctrlr *ctrlr),
 	    false);
 
+DEFINE_STUB(nvmf_ctrlr_copy_supported,
+	    bool,
+	    (struct spdk_nvmf_ctrlr *ctrlr),
+	    false);
+
 DEFINE_STUB(nvmf_bdev_ctrlr_read_cmd,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -163,6 +168,33 @@ DEFINE_STUB(nvmf_bdev_ctrlr_dsm_cmd,
 	     struct spdk_nvmf_request *req),
 	    0);
 
+DEFINE_STUB(nvmf_bdev_ctrlr_copy_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB(nvmf_bdev_ctrlr_zone_append_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB(nvmf_bdev_ctrlr_zone_mgmt_send_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB(nvmf_bdev_ctrlr_zone_mgmt_recv_cmd,
+	    int,
+	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
+	     struct spdk_nvmf_request *req),
+	    0);
+
+DEFINE_STUB_V(nvmf_bdev_ctrlr_identify_iocs_zns,
+	      (struct spdk_nvmf_ns *ns, struct spdk_nvme_zns_ns_data *nsdata_zns));
+
 DEFINE_STUB(nvmf_bdev_ctrlr_nvme_passthru_io,
 	    int,
 	    (struct spdk_bdev *bdev, struct spdk_bdev_desc *desc, struct spdk_io_channel *ch,
@@ -204,6 +236,11 @@ DEFINE_STUB(spdk_sock_set_priority,
 	    (struct spdk_sock *sock, int priority),
 	    0);
 
+DEFINE_STUB(spdk_sock_set_recv_hint,
+	    int,
+	    (struct spdk_sock *sock, uint32_t hdr_len, uint32_t payload_len),
+	    0);
+
 DEFINE_STUB_V(nvmf_ns_reservation_request, (void *ctx));
 
 DEFINE_STUB_V(spdk_nvme_trid_populate_transport, (struct spdk_nvme_transport_id *trid,
@@ -707,6 +744,63 @@ test_nvmf_tcp_incapsule_data_handle(void)
 	CU_ASSERT(tqpair.pdu_in_progress.req == (void *)&tcp_req2);
 }
 
+static void
+test_nvmf_tcp_shared_pool(void)
+{
+	struct spdk_nvmf_transport transport = {};
+	struct spdk_nvmf_tcp_qpair tqpair = {};
+	struct spdk_nvmf_tcp_shared_pool *pool;
+	struct spdk_nvmf_tcp_req *tcp_req1, *tcp_req2, *tcp_req3;
+	int rc, i;
+
+	transport.opts.max_queue_depth = UT_MAX_QUEUE_DEPTH;
+	transport.opts.in_capsule_data_size = UT_IN_CAPSULE_DATA_SIZE;
+
+	pool = nvmf_tcp_shared_pool_create(&transport.opts, 2);
+	SPDK_CU_ASSERT_FATAL(pool != NULL);
+
+	tqpair.qpair.transport = &transport;
+	tqpair.shared_pool = pool;
+	for (i = TCP_REQUEST_STATE_FREE; i < TCP_REQUEST_NUM_STATES; i++) {
+		TAILQ_INIT(&tqpair.state_queue[i]);
+	}
+
+	/* The qpair only allocates its mgmt_pdu, the rest comes from the pool */
+	rc = nvmf_tcp_qpair_init_mem_resource(&tqpair);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(tqpair.bufs == NULL);
+	CU_ASSERT(tqpair.mgmt_pdu == &tqpair.pdus[0]);
+	CU_ASSERT(tqpair.reqs[0].pdu == NULL);
+	CU_ASSERT(tqpair.reqs[0].buf == NULL);
+
+	tcp_req1 = nvmf_tcp_req_get(&tqpair);
+	tcp_req2 = nvmf_tcp_req_get(&tqpair);
+	SPDK_CU_ASSERT_FATAL(tcp_req1 != NULL && tcp_req2 != NULL);
+	CU_ASSERT(tcp_req1->pdu != NULL && tcp_req1->buf != NULL);
+	CU_ASSERT(tcp_req2->pdu != NULL && tcp_req2->buf != NULL);
+	CU_ASSERT(tcp_req1->pdu != tcp_req2->pdu);
+	CU_ASSERT(tcp_req1->buf != tcp_req2->buf);
+
+	/* The pool ran out while the qpair still has free requests */
+	CU_ASSERT(nvmf_tcp_req_get(&tqpair) == NULL);
+	CU_ASSERT(tqpair.state_cntr[TCP_REQUEST_STATE_FREE] == UT_MAX_QUEUE_DEPTH - 2);
+
+	/* Freeing a request gives its buffer and pdu back to the pool */
+	nvmf_tcp_req_put_shared(&tqpair, tcp_req1);
+	nvmf_tcp_req_set_state(tcp_req1, TCP_REQUEST_STATE_FREE);
+	CU_ASSERT(tcp_req1->pdu == NULL);
+	CU_ASSERT(tcp_req1->shared_req == NULL);
+
+	tcp_req3 = nvmf_tcp_req_get(&tqpair);
+	SPDK_CU_ASSERT_FATAL(tcp_req3 != NULL);
+	CU_ASSERT(tcp_req3->shared_req != NULL);
+	CU_ASSERT(tcp_req3->pdu != tcp_req2->pdu);
+
+	free(tqpair.reqs);
+	spdk_dma_free(tqpair.pdus);
+	nvmf_tcp_shared_pool_free(pool);
+}
+
 
 int main(int argc, char **argv)
 {
@@ -724,6 +818,7 @@ int main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_nvmf_tcp_send_c2h_data);
 	CU_ADD_TEST(suite, test_nvmf_tcp_h2c_data_hdr_handle);
 	CU_ADD_TEST(suite, test_nvmf_tcp_incapsule_data_handle);
+	CU_ADD_TEST(suite, test_nvmf_tcp_shared_pool);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 	CU_basic_run_tests();
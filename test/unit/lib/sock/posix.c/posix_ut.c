@@ -150,6 +150,75 @@ flush(void)
 	free(req2);
 }
 
+static void
+recv_hint(void)
+{
+	struct spdk_posix_sock psock = {};
+	struct spdk_sock *sock = &psock.base;
+	uint8_t hdr[24], payload[4096], buf[4096];
+	struct iovec iov;
+	int fds[2], rc;
+	ssize_t bytes;
+
+	rc = socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+	psock.fd = fds[0];
+	rc = posix_sock_alloc_pipe(&psock, 8192);
+	SPDK_CU_ASSERT_FATAL(rc == 0);
+
+	memset(hdr, 0xAA, sizeof(hdr));
+	memset(payload, 0x55, sizeof(payload));
+
+	/* Without a hint, reading the first header bytes pulls the payload into the pipe. */
+	CU_ASSERT(write(fds[1], hdr, sizeof(hdr)) == sizeof(hdr));
+	CU_ASSERT(write(fds[1], payload, sizeof(payload)) == sizeof(payload));
+	bytes = posix_sock_recv(sock, buf, 8);
+	CU_ASSERT(bytes == 8);
+	CU_ASSERT(spdk_pipe_reader_bytes_available(psock.recv_pipe) == sizeof(hdr) + sizeof(payload) - 8);
+	iov.iov_base = buf;
+	iov.iov_len = sizeof(buf);
+	while (spdk_pipe_reader_bytes_available(psock.recv_pipe) > 0) {
+		CU_ASSERT(posix_sock_readv(sock, &iov, 1) > 0);
+	}
+
+	/* With a hint, the pipe is only filled up to the end of the header and the
+	 * payload is received directly into the caller's buffer. */
+	CU_ASSERT(write(fds[1], hdr, sizeof(hdr)) == sizeof(hdr));
+	CU_ASSERT(write(fds[1], payload, sizeof(payload)) == sizeof(payload));
+	rc = posix_sock_set_recv_hint(sock, sizeof(hdr), sizeof(payload));
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(psock.recv_hint == sizeof(hdr));
+	bytes = posix_sock_recv(sock, buf, 8);
+	CU_ASSERT(bytes == 8);
+	CU_ASSERT(psock.recv_hint == 0);
+	CU_ASSERT(spdk_pipe_reader_bytes_available(psock.recv_pipe) == sizeof(hdr) - 8);
+	bytes = posix_sock_recv(sock, buf, sizeof(hdr) - 8);
+	CU_ASSERT(bytes == sizeof(hdr) - 8);
+	CU_ASSERT(memcmp(buf, hdr, sizeof(hdr) - 8) == 0);
+	CU_ASSERT(spdk_pipe_reader_bytes_available(psock.recv_pipe) == 0);
+	memset(buf, 0, sizeof(buf));
+	bytes = posix_sock_readv(sock, &iov, 1);
+	CU_ASSERT(bytes == sizeof(payload));
+	CU_ASSERT(memcmp(buf, payload, sizeof(payload)) == 0);
+
+	/* A header that is already buffered leaves nothing to limit. */
+	CU_ASSERT(write(fds[1], hdr, sizeof(hdr)) == sizeof(hdr));
+	bytes = posix_sock_recv(sock, buf, 8);
+	CU_ASSERT(bytes == 8);
+	rc = posix_sock_set_recv_hint(sock, sizeof(hdr) - 8, sizeof(payload));
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(psock.recv_hint == 0);
+
+	/* Payloads too small to be received directly are ignored. */
+	rc = posix_sock_set_recv_hint(sock, 64, MIN_SOCK_PIPE_SIZE - 1);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(psock.recv_hint == 0);
+
+	posix_sock_alloc_pipe(&psock, 0);
+	close(fds[0]);
+	close(fds[1]);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -162,6 +231,7 @@ main(int argc, char **argv)
 	suite = CU_add_suite("posix", NULL, NULL);
 
 	CU_ADD_TEST(suite, flush);
+	CU_ADD_TEST(suite, recv_hint);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 
@@ -40,6 +40,7 @@
 
 #include "sock/sock.c"
 #include "sock/posix/posix.c"
+#include "sock/memory/memory.c"
 
 #define UT_IP	"test_ip"
 #define UT_PORT	1234
@@ -458,6 +459,38 @@ ut_sock(void)
 	_sock(UT_IP, UT_PORT, "ut");
 }
 
+static void
+memory_sock(void)
+{
+	_sock(UT_IP, UT_PORT, "memory");
+}
+
+static void
+memory_sock_opt_in(void)
+{
+	struct spdk_sock *listen_sock, *server_sock, *client_sock;
+	int rc;
+
+	/* Neither the ut nor the posix implementation accept this port */
+	listen_sock = spdk_sock_listen(UT_IP, UT_PORT + 1, "memory");
+	SPDK_CU_ASSERT_FATAL(listen_sock != NULL);
+
+	/* The memory implementation isn't tried unless it's selected */
+	CU_ASSERT(spdk_sock_connect(UT_IP, UT_PORT + 1, NULL) == NULL);
+
+	rc = spdk_sock_set_default_impl("memory");
+	CU_ASSERT(rc == 0);
+	client_sock = spdk_sock_connect(UT_IP, UT_PORT + 1, NULL);
+	SPDK_CU_ASSERT_FATAL(client_sock != NULL);
+	server_sock = spdk_sock_accept(listen_sock);
+	SPDK_CU_ASSERT_FATAL(server_sock != NULL);
+	g_default_impl = NULL;
+
+	CU_ASSERT(spdk_sock_close(&client_sock) == 0);
+	CU_ASSERT(spdk_sock_close(&server_sock) == 0);
+	CU_ASSERT(spdk_sock_close(&listen_sock) == 0);
+}
+
 static void
 read_data(void *cb_arg, struct spdk_sock_group *group, struct spdk_sock *sock)
 {
@@ -578,6 +611,111 @@ ut_sock_group(void)
 	_sock_group(UT_IP, UT_PORT, "ut");
 }
 
+static void
+memory_sock_group(void)
+{
+	_sock_group(UT_IP, UT_PORT, "memory");
+}
+
+static void
+_req_cb(void *cb_arg, int err)
+{
+	*(int *)cb_arg = err;
+}
+
+static void
+memory_sock_zcopy(void)
+{
+	struct spdk_sock_group *group;
+	struct spdk_sock *listen_sock, *server_sock, *client_sock;
+	struct spdk_sock_request *req;
+	char *test_string = "abcdef";
+	char buffer[64] = {};
+	ssize_t bytes_read;
+	int rc, req_err;
+
+	listen_sock = spdk_sock_listen(UT_IP, UT_PORT, "memory");
+	SPDK_CU_ASSERT_FATAL(listen_sock != NULL);
+
+	/* Same name and port can only be used once */
+	CU_ASSERT(spdk_sock_listen(UT_IP, UT_PORT, "memory") == NULL);
+
+	/* Nothing listens on this port */
+	CU_ASSERT(spdk_sock_connect(UT_IP, UT_PORT + 1, "memory") == NULL);
+
+	client_sock = spdk_sock_connect(UT_IP, UT_PORT, "memory");
+	SPDK_CU_ASSERT_FATAL(client_sock != NULL);
+	server_sock = spdk_sock_accept(listen_sock);
+	SPDK_CU_ASSERT_FATAL(server_sock != NULL);
+
+	group = spdk_sock_group_create(NULL);
+	SPDK_CU_ASSERT_FATAL(group != NULL);
+	rc = spdk_sock_group_add_sock(group, client_sock, read_data, client_sock);
+	CU_ASSERT(rc == 0);
+
+	req = calloc(1, sizeof(*req) + 2 * sizeof(struct iovec));
+	SPDK_CU_ASSERT_FATAL(req != NULL);
+	req->iovcnt = 2;
+	SPDK_SOCK_REQUEST_IOV(req, 0)->iov_base = test_string;
+	SPDK_SOCK_REQUEST_IOV(req, 0)->iov_len = 3;
+	SPDK_SOCK_REQUEST_IOV(req, 1)->iov_base = test_string + 3;
+	SPDK_SOCK_REQUEST_IOV(req, 1)->iov_len = 4;
+	req->cb_fn = _req_cb;
+	req->cb_arg = &req_err;
+
+	/* The request is handed to the peer on flush, but only completes
+	 * after the peer has read all of it. */
+	req_err = 1;
+	spdk_sock_writev_async(client_sock, req);
+	rc = spdk_sock_flush(client_sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(req_err == 1);
+	CU_ASSERT(TAILQ_FIRST(&client_sock->pending_reqs) == req);
+
+	bytes_read = spdk_sock_recv(server_sock, buffer, 5);
+	CU_ASSERT(bytes_read == 5);
+	spdk_sock_group_poll(group);
+	CU_ASSERT(req_err == 1);
+
+	bytes_read = spdk_sock_recv(server_sock, buffer + 5, sizeof(buffer) - 5);
+	CU_ASSERT(bytes_read == 2);
+	CU_ASSERT(strncmp(test_string, buffer, 7) == 0);
+	spdk_sock_group_poll(group);
+	CU_ASSERT(req_err == 0);
+	CU_ASSERT(TAILQ_EMPTY(&client_sock->pending_reqs));
+
+	/* Data handed off before the writer leaves its group is still delivered */
+	req_err = 1;
+	spdk_sock_writev_async(client_sock, req);
+	rc = spdk_sock_flush(client_sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(req_err == 1);
+	rc = spdk_sock_group_remove_sock(group, client_sock);
+	CU_ASSERT(rc == 0);
+	CU_ASSERT(req_err == 0);
+
+	rc = spdk_sock_close(&client_sock);
+	CU_ASSERT(rc == 0);
+
+	memset(buffer, 0, sizeof(buffer));
+	bytes_read = spdk_sock_recv(server_sock, buffer, sizeof(buffer));
+	CU_ASSERT(bytes_read == 7);
+	CU_ASSERT(strncmp(test_string, buffer, 7) == 0);
+
+	/* Then the peer sees the end of the stream */
+	bytes_read = spdk_sock_recv(server_sock, buffer, sizeof(buffer));
+	CU_ASSERT(bytes_read == 0);
+	CU_ASSERT(spdk_sock_is_connected(server_sock) == false);
+
+	free(req);
+	rc = spdk_sock_group_close(&group);
+	CU_ASSERT(rc == 0);
+	rc = spdk_sock_close(&server_sock);
+	CU_ASSERT(rc == 0);
+	rc = spdk_sock_close(&listen_sock);
+	CU_ASSERT(rc == 0);
+}
+
 static void
 read_data_fairness(void *cb_arg, struct spdk_sock_group *group, struct spdk_sock *sock)
 {
@@ -891,6 +1029,7 @@ posix_sock_impl_get_set_opts(void)
 	CU_ASSERT(len == sizeof(opts));
 	CU_ASSERT(opts.recv_buf_size == MIN_SO_RCVBUF_SIZE);
 	CU_ASSERT(opts.send_buf_size == MIN_SO_SNDBUF_SIZE);
+	CU_ASSERT(opts.busy_poll_usec == 0);
 
 	/* Try to request more opts */
 	len = sizeof(long_opts);
@@ -950,6 +1089,70 @@ posix_sock_impl_get_set_opts(void)
 	CU_ASSERT(opts.recv_buf_size == 5);
 }
 
+static void
+ut_sock_map(void)
+{
+	struct spdk_sock_group *group_1, *group_2, *test_group;
+	int i, rc;
+
+	group_1 = spdk_sock_group_create(NULL);
+	SPDK_CU_ASSERT_FATAL(group_1 != NULL);
+	group_2 = spdk_sock_group_create(NULL);
+	SPDK_CU_ASSERT_FATAL(group_2 != NULL);
+
+	/* Unknown placement_id */
+	test_group = (struct spdk_sock_group *)0xDEADBEEF;
+	sock_map_lookup(1, &test_group);
+	CU_ASSERT(test_group == NULL);
+
+	rc = sock_map_insert(1, group_1);
+	CU_ASSERT(rc == 0);
+	sock_map_lookup(1, &test_group);
+	CU_ASSERT(test_group == group_1);
+
+	/* A second socket with the same placement_id keeps the first group */
+	rc = sock_map_insert(1, group_2);
+	CU_ASSERT(rc == 0);
+	sock_map_lookup(1, &test_group);
+	CU_ASSERT(test_group == group_1);
+
+	sock_map_release(1);
+	sock_map_release(1);
+	sock_map_lookup(1, &test_group);
+	CU_ASSERT(test_group == group_1);
+
+	/* Fill many colliding slots and make sure each id still finds its group */
+	for (i = 2; i < 2 + SPDK_SOCK_PLACEMENT_MAP_SIZE / 2; i++) {
+		rc = sock_map_insert(i * SPDK_SOCK_PLACEMENT_MAP_SIZE, (i & 1) ? group_1 : group_2);
+		CU_ASSERT(rc == 0);
+	}
+	for (i = 2; i < 2 + SPDK_SOCK_PLACEMENT_MAP_SIZE / 2; i++) {
+		sock_map_lookup(i * SPDK_SOCK_PLACEMENT_MAP_SIZE, &test_group);
+		CU_ASSERT(test_group == ((i & 1) ? group_1 : group_2));
+	}
+
+	/* Closing group_1 drops it from the map, but group_2 entries stay reachable */
+	rc = spdk_sock_group_close(&group_1);
+	CU_ASSERT(rc == 0);
+	sock_map_lookup(1, &test_group);
+	CU_ASSERT(test_group == NULL);
+	for (i = 2; i < 2 + SPDK_SOCK_PLACEMENT_MAP_SIZE / 2; i++) {
+		sock_map_lookup(i * SPDK_SOCK_PLACEMENT_MAP_SIZE, &test_group);
+		CU_ASSERT(test_group == ((i & 1) ? NULL : group_2));
+	}
+
+	/* A released placement_id can be claimed by another group */
+	rc = sock_map_insert(1, group_2);
+	CU_ASSERT(rc == 0);
+	sock_map_lookup(1, &test_group);
+	CU_ASSERT(test_group == group_2);
+
+	rc = spdk_sock_group_close(&group_2);
+	CU_ASSERT(rc == 0);
+	sock_map_lookup(1, &test_group);
+	CU_ASSERT(test_group == NULL);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -970,6 +1173,11 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, sock_get_default_opts);
 	CU_ADD_TEST(suite, ut_sock_impl_get_set_opts);
 	CU_ADD_TEST(suite, posix_sock_impl_get_set_opts);
+	CU_ADD_TEST(suite, ut_sock_map);
+	CU_ADD_TEST(suite, memory_sock);
+	CU_ADD_TEST(suite, memory_sock_group);
+	CU_ADD_TEST(suite, memory_sock_zcopy);
+	CU_ADD_TEST(suite, memory_sock_opt_in);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 
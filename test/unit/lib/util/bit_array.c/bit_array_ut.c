@@ -345,6 +345,69 @@ test_mask_clear(void)
 	spdk_bit_array_free(&ba);
 }
 
+static void
+test_bit_pool(void)
+{
+	struct spdk_bit_pool *pool;
+	uint32_t i, bit, num_bits;
+
+	pool = spdk_bit_pool_create(200);
+	SPDK_CU_ASSERT_FATAL(pool != NULL);
+	CU_ASSERT(spdk_bit_pool_count_free(pool) == 200);
+
+	/* Fill the first two words and part of the third one */
+	for (i = 0; i < 150; i++) {
+		CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == i);
+	}
+	CU_ASSERT(spdk_bit_pool_count_allocated(pool) == 150);
+
+	/* A freed bit in a full word is found again */
+	spdk_bit_pool_free_bit(pool, 10);
+	spdk_bit_pool_free_bit(pool, 100);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 10);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 100);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 150);
+
+	/* A run stops at the next allocated bit */
+	spdk_bit_pool_free_bit(pool, 64);
+	spdk_bit_pool_free_bit(pool, 65);
+	spdk_bit_pool_free_bit(pool, 67);
+	bit = spdk_bit_pool_allocate_bits(pool, 8, &num_bits);
+	CU_ASSERT(bit == 64);
+	CU_ASSERT(num_bits == 2);
+	bit = spdk_bit_pool_allocate_bits(pool, 8, &num_bits);
+	CU_ASSERT(bit == 67);
+	CU_ASSERT(num_bits == 1);
+
+	/* A run crosses word boundaries and stops at the end of the pool */
+	bit = spdk_bit_pool_allocate_bits(pool, 40, &num_bits);
+	CU_ASSERT(bit == 151);
+	CU_ASSERT(num_bits == 40);
+	bit = spdk_bit_pool_allocate_bits(pool, 40, &num_bits);
+	CU_ASSERT(bit == 191);
+	CU_ASSERT(num_bits == 9);
+	CU_ASSERT(spdk_bit_pool_count_free(pool) == 0);
+
+	bit = spdk_bit_pool_allocate_bits(pool, 8, &num_bits);
+	CU_ASSERT(bit == UINT32_MAX);
+	CU_ASSERT(num_bits == 0);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == UINT32_MAX);
+
+	/* Growing the pool makes the new bits available */
+	CU_ASSERT(spdk_bit_pool_resize(&pool, 300) == 0);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 200);
+	spdk_bit_pool_free_bit(pool, 5);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 5);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 201);
+
+	spdk_bit_pool_free_all_bits(pool);
+	CU_ASSERT(spdk_bit_pool_count_free(pool) == 300);
+	CU_ASSERT(spdk_bit_pool_allocate_bit(pool) == 0);
+
+	spdk_bit_pool_free(&pool);
+	CU_ASSERT(pool == NULL);
+}
+
 int
 main(int argc, char **argv)
 {
@@ -364,6 +427,7 @@ main(int argc, char **argv)
 	CU_ADD_TEST(suite, test_count);
 	CU_ADD_TEST(suite, test_mask_store_load);
 	CU_ADD_TEST(suite, test_mask_clear);
+	CU_ADD_TEST(suite, test_bit_pool);
 
 	CU_basic_set_mode(CU_BRM_VERBOSE);
 